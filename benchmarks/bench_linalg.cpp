@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include "nforge/nforge.h"
+
+/// Random symmetric positive definite (n, n) matrix, B @ B^T + n I.
+static Tensor randomSPD(size_t n) {
+	Tensor b({n, n});
+	b.fillUniform(-1.0f, 1.0f, 1);
+	Tensor spd = b.matmul(b.transpose(0, 1));
+	for (size_t i = 0; i < n; i++) spd[i][i] += Tensor((float)n);
+	return spd;
+}
+
+/// Sets the flop rate counter, `flops` per iteration.
+static void setFlops(benchmark::State& state, double flops) {
+	state.counters["flops"] =
+	    benchmark::Counter(flops, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+
+static void BM_Linalg_Cholesky(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor a = randomSPD(n);
+	for (auto _ : state) {
+		auto result = a.cholesky();
+		benchmark::DoNotOptimize(result);
+	}
+	setFlops(state, n * n * (double)n / 3);
+}
+BENCHMARK(BM_Linalg_Cholesky)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+
+static void BM_Linalg_Solve(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor a({n, n}), b({n, 1});
+	a.fillUniform(-1.0f, 1.0f, 2);
+	b.fillUniform(-1.0f, 1.0f, 3);
+	for (auto _ : state) {
+		auto result = a.solve(b);
+		benchmark::DoNotOptimize(result);
+	}
+	setFlops(state, 2 * n * n * (double)n / 3);
+}
+BENCHMARK(BM_Linalg_Solve)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+
+static void BM_Linalg_QR(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor a({2 * n, n});
+	a.fillUniform(-1.0f, 1.0f, 4);
+	for (auto _ : state) {
+		auto result = a.qr();
+		benchmark::DoNotOptimize(result);
+	}
+	// factorization and forming Q, 2 n^2 (m - n / 3) each
+	setFlops(state, 2 * 2 * n * n * (2 * n - n / 3.0));
+}
+BENCHMARK(BM_Linalg_QR)->Arg(128)->Arg(512)->Unit(benchmark::kMillisecond);
+
+
+static void BM_Linalg_SolveTriangular(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor l = randomSPD(n).cholesky();
+	Tensor b({n, n});
+	b.fillUniform(-1.0f, 1.0f, 5);
+	for (auto _ : state) {
+		auto result = l.solveTriangular(b, true);
+		benchmark::DoNotOptimize(result);
+	}
+	setFlops(state, n * n * (double)n);
+}
+BENCHMARK(BM_Linalg_SolveTriangular)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+
+// many small systems run one matrix per thread
+static void BM_Linalg_Cholesky_Batched_32(benchmark::State& state) {
+	size_t batch = state.range(0);
+	Tensor b({batch, 32, 32});
+	b.fillUniform(-1.0f, 1.0f, 6);
+	Tensor a = b.matmul(b.transpose(1, 2));
+	Tensor identity({32, 32});
+	for (size_t i = 0; i < 32; i++) identity[i][i] = 32.0f;
+	a += identity;
+	for (auto _ : state) {
+		auto result = a.cholesky();
+		benchmark::DoNotOptimize(result);
+	}
+	setFlops(state, batch * 32 * 32 * 32 / 3.0);
+}
+BENCHMARK(BM_Linalg_Cholesky_Batched_32)->Arg(1024)->Unit(benchmark::kMillisecond);
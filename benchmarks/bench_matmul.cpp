@@ -57,3 +57,43 @@ static void BM_TensorMatmul_ViewStrided_256_256(benchmark::State& state) {
 	}
 }
 BENCHMARK(BM_TensorMatmul_ViewStrided_256_256)->MinTime(2.0);
+
+
+static void BM_TensorMatmulInt8_256_256(benchmark::State& state) {
+	Tensor a({256, 256}, 1.0f, Backend::CPU);
+	Tensor b({256, 256}, 2.0f, Backend::CPU);
+	Tensor qa = a.quantize(Tensor(0.05f), Tensor(0.0f), DType::UInt8);
+	Tensor qb = b.quantize(Tensor(0.05f), Tensor(0.0f));
+	for (auto _ : state) {
+		auto result = qa.matmulInt8(qb);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_TensorMatmulInt8_256_256)->MinTime(2.0);
+
+
+static void BM_TensorMatmulInt8_512_512(benchmark::State& state) {
+	Tensor a({512, 512}, 1.0f, Backend::CPU);
+	Tensor b({512, 512}, 2.0f, Backend::CPU);
+	Tensor qa = a.quantize(Tensor(0.05f), Tensor(0.0f));
+	Tensor qb = b.quantize(Tensor(0.05f), Tensor(0.0f));
+	for (auto _ : state) {
+		auto result = qa.matmulInt8(qb);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_TensorMatmulInt8_512_512)->MinTime(2.0);
+
+
+static void BM_TensorMatmulInt8Requantize_512_512(benchmark::State& state) {
+	Tensor a({512, 512}, 1.0f, Backend::CPU);
+	Tensor b({512, 512}, 2.0f, Backend::CPU);
+	Tensor qa = a.quantize(Tensor(0.05f), Tensor(0.0f));
+	Tensor qb = b.quantize(Tensor(0.05f), Tensor(0.0f));
+	Tensor multipliers({512}, 0.001f, Backend::CPU);
+	for (auto _ : state) {
+		auto result = qa.matmulInt8(qb, 0, 0, multipliers, 0);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_TensorMatmulInt8Requantize_512_512)->MinTime(2.0);
@@ -91,3 +91,328 @@ static void BM_TensorReduction_Sum_1000_1000(benchmark::State& state) {
 	}
 }
 BENCHMARK(BM_TensorReduction_Sum_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorFillUniform_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	for (auto _ : state) {
+		a.fillUniform(0.0f, 1.0f);
+		benchmark::DoNotOptimize(a);
+	}
+	state.counters["draws/s"] =
+	    benchmark::Counter(state.iterations() * 1e6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TensorFillUniform_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorFillNormal_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	for (auto _ : state) {
+		a.fillNormal(0.0f, 1.0f);
+		benchmark::DoNotOptimize(a);
+	}
+	state.counters["draws/s"] =
+	    benchmark::Counter(state.iterations() * 1e6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TensorFillNormal_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorIsCloseAll_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, 1.0f, Backend::CPU);
+	Tensor b({1000, 1000}, 1.0f, Backend::CPU);
+	for (auto _ : state) {
+		auto result = a.isClose(b).all();
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_TensorIsCloseAll_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorAllClose_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, 1.0f, Backend::CPU);
+	Tensor b({1000, 1000}, 1.0f, Backend::CPU);
+	for (auto _ : state) {
+		bool result = a.allClose(b);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_TensorAllClose_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorAnyNotEqual_EarlyExit_1000_1000(benchmark::State& state) {
+	// the first element differs, the scan stops after one chunk
+	Tensor a({1000, 1000}, 1.0f, Backend::CPU);
+	Tensor b({1000, 1000}, 1.0f, Backend::CPU);
+	b.set({0, 0}, Tensor(2.0f));
+	for (auto _ : state) {
+		bool result = a.any(Predicate::NotEqual, b);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_TensorAnyNotEqual_EarlyExit_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorSoftmax_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-5.0f, 5.0f);
+	for (auto _ : state) {
+		auto result = a.softmax(1);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorSoftmax_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorSoftmax_ViewStrided_1000_1000(benchmark::State& state) {
+	Tensor parent({1000, 2000}, Backend::CPU);
+	parent.fillUniform(-5.0f, 5.0f);
+	Tensor::View view = parent.subsample({1, 2});
+	for (auto _ : state) {
+		auto result = view.softmax(1);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorSoftmax_ViewStrided_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorLogSumExp_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-5.0f, 5.0f);
+	for (auto _ : state) {
+		auto result = a.logSumExp(1);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorLogSumExp_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorExp_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-5.0f, 5.0f);
+	for (auto _ : state) {
+		auto result = a.exp();
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorExp_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorTanh_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-5.0f, 5.0f);
+	for (auto _ : state) {
+		auto result = a.tanh();
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorTanh_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorSin_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-100.0f, 100.0f);
+	for (auto _ : state) {
+		auto result = a.sin();
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorSin_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorSigmoidInplace_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-5.0f, 5.0f);
+	for (auto _ : state) {
+		a.mapInplace(UnaryOp::Sigmoid);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorSigmoidInplace_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorArgmax_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-1.0f, 1.0f);
+	for (auto _ : state) {
+		auto result = a.argmax(1);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorArgmax_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorTopK_100_4000000(benchmark::State& state) {
+	Tensor a({4000000}, Backend::CPU);
+	a.fillUniform(-1.0f, 1.0f);
+	for (auto _ : state) {
+		auto result = a.topk(100);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 4000000);
+}
+BENCHMARK(BM_TensorTopK_100_4000000)->MinTime(2.0);
+
+
+static void BM_TensorSort_4000000(benchmark::State& state) {
+	Tensor a({4000000}, Backend::CPU);
+	a.fillUniform(-1.0f, 1.0f);
+	for (auto _ : state) {
+		auto result = a.sort();
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 4000000);
+}
+BENCHMARK(BM_TensorSort_4000000)->MinTime(2.0);
+
+
+static void BM_TensorSortRows_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-1.0f, 1.0f);
+	for (auto _ : state) {
+		auto result = a.sort(1);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorSortRows_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorArgsort_4000000(benchmark::State& state) {
+	Tensor a({4000000}, Backend::CPU);
+	a.fillUniform(-1.0f, 1.0f);
+	for (auto _ : state) {
+		auto result = a.argsort();
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 4000000);
+}
+BENCHMARK(BM_TensorArgsort_4000000)->MinTime(2.0);
+
+
+static void BM_TensorCumsum_4000000(benchmark::State& state) {
+	Tensor a({4000000}, Backend::CPU);
+	a.fillUniform(-1.0f, 1.0f);
+	for (auto _ : state) {
+		auto result = a.cumsum(0);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 4000000);
+}
+BENCHMARK(BM_TensorCumsum_4000000)->MinTime(2.0);
+
+
+static void BM_TensorCumsumColumns_1000_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, Backend::CPU);
+	a.fillUniform(-1.0f, 1.0f);
+	for (auto _ : state) {
+		auto result = a.cumsum(0);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000 * 1000);
+}
+BENCHMARK(BM_TensorCumsumColumns_1000_1000)->MinTime(2.0);
+
+
+static void BM_TensorIndexSelect_100000_128(benchmark::State& state) {
+	Tensor table({100000, 128}, Backend::CPU);
+	table.fillUniform(-1.0f, 1.0f);
+	Tensor ids({4096}, Backend::CPU);
+	ids.fillUniform(0.0f, 99999.0f);
+	Tensor index = ids.asType(DType::Int64);
+	for (auto _ : state) {
+		auto result = table.indexSelect(0, index);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 4096 * 128);
+}
+BENCHMARK(BM_TensorIndexSelect_100000_128)->MinTime(2.0);
+
+
+static void BM_TensorScatterAdd_1000000_4096(benchmark::State& state) {
+	Tensor grid({4096}, 0.0f, Backend::CPU);
+	Tensor cells({1000000}, Backend::CPU);
+	cells.fillUniform(0.0f, 4095.0f);
+	Tensor index = cells.asType(DType::Int64);
+	Tensor mass({1000000}, Backend::CPU);
+	mass.fillUniform(0.0f, 1.0f);
+	for (auto _ : state) {
+		grid.scatterAdd(0, index, mass);
+		benchmark::DoNotOptimize(grid);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000000);
+}
+BENCHMARK(BM_TensorScatterAdd_1000000_4096)->MinTime(2.0);
+
+
+static void BM_TensorConv1d_5Tap_4_1000000(benchmark::State& state) {
+	Tensor signal({4, 1, 1000000}, Backend::CPU);
+	signal.fillUniform(-1.0f, 1.0f);
+	Tensor taps({1, 1, 5}, 0.2f, Backend::CPU);
+	for (auto _ : state) {
+		auto result = signal.conv1d(taps, 1, 2);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 4 * 1000000);
+}
+BENCHMARK(BM_TensorConv1d_5Tap_4_1000000)->MinTime(2.0);
+
+
+static void BM_TensorConv2d_3x3_1_1024(benchmark::State& state) {
+	Tensor image({1, 1, 1024, 1024}, Backend::CPU);
+	image.fillUniform(0.0f, 1.0f);
+	Tensor kernel({1, 1, 3, 3}, 1.0f / 9.0f, Backend::CPU);
+	for (auto _ : state) {
+		auto result = image.conv2d(kernel, 1, 1);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1024 * 1024);
+}
+BENCHMARK(BM_TensorConv2d_3x3_1_1024)->MinTime(2.0);
+
+
+static void BM_TensorConv2d_3x3_64_64(benchmark::State& state) {
+	Tensor features({1, 64, 64, 64}, Backend::CPU);
+	features.fillUniform(-1.0f, 1.0f);
+	Tensor kernel({64, 64, 3, 3}, Backend::CPU);
+	kernel.fillUniform(-0.1f, 0.1f);
+	for (auto _ : state) {
+		auto result = features.conv2d(kernel, 1, 1);
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 64 * 64 * 64);
+}
+BENCHMARK(BM_TensorConv2d_3x3_64_64)->MinTime(2.0);
+
+
+static void BM_TensorViewCopy_Reshape_1000000_1(benchmark::State& state) {
+	Tensor a({1000000}, 1.0f, Backend::CPU);
+	Tensor::View column = a.reshape({1000000, 1});
+	for (auto _ : state) {
+		auto result = column.contiguous();
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations() * 1000000);
+}
+BENCHMARK(BM_TensorViewCopy_Reshape_1000000_1)->MinTime(2.0);
+
+
+static void BM_TensorStack_4096_128(benchmark::State& state) {
+	Tensor table({100000, 128}, Backend::CPU);
+	table.fillUniform(-1.0f, 1.0f);
+	std::vector<Tensor::View> rows;
+	for (size_t i = 0; i < 4096; i++) rows.push_back(table[(i * 7919) % 100000]);
+	for (auto _ : state) {
+		auto batch = Tensor::stack(rows);
+		benchmark::DoNotOptimize(batch);
+	}
+	state.SetItemsProcessed(state.iterations() * 4096 * 128);
+}
+BENCHMARK(BM_TensorStack_4096_128)->MinTime(2.0);
@@ -3,19 +3,111 @@
 #include "physics/projectile_motion.h"
 #include "physics/sphere_slide.h"
 
+// peak_bytes is the tensor memory high-water mark a run adds on top of what was live before it.
+
 static void BM_Physics_ProjectileMotion(benchmark::State& state) {
 	ProjectileMotionParams params;
+	profiling::PeakMemoryScope peak;
 	for (auto _ : state) {
 		benchmark::DoNotOptimize(simulateProjectileMotion(params));
 	}
+	state.counters["peak_bytes"] = peak.getPeakIncrease();
+	state.counters["sims/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
 }
 BENCHMARK(BM_Physics_ProjectileMotion)->MinTime(2.0);
 
 
 static void BM_Physics_SphereSlide(benchmark::State& state) {
 	SphereSlideParams params;
+	profiling::PeakMemoryScope peak;
 	for (auto _ : state) {
 		benchmark::DoNotOptimize(simulateSphereSlide(params));
 	}
+	state.counters["peak_bytes"] = peak.getPeakIncrease();
+	state.counters["sims/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Physics_SphereSlide)->MinTime(2.0);
+
+
+static void BM_Physics_ProjectileMotionCaptured(benchmark::State& state) {
+	ProjectileMotionParams params;
+	profiling::PeakMemoryScope peak;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(simulateProjectileMotionCaptured(params));
+	}
+	state.counters["peak_bytes"] = peak.getPeakIncrease();
+}
+BENCHMARK(BM_Physics_ProjectileMotionCaptured)->MinTime(2.0);
+
+
+static void BM_Physics_SphereSlideCaptured(benchmark::State& state) {
+	SphereSlideParams params;
+	profiling::PeakMemoryScope peak;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(simulateSphereSlideCaptured(params));
+	}
+	state.counters["peak_bytes"] = peak.getPeakIncrease();
+}
+BENCHMARK(BM_Physics_SphereSlideCaptured)->MinTime(2.0);
+
+
+// Forward and backward pass of one throw, the argument is the number of steps per checkpoint.
+
+static void BM_Physics_ProjectileMotionGradient(benchmark::State& state) {
+	ProjectileMotionParams params;
+	size_t savedBytes = 0;
+	profiling::PeakMemoryScope peak;
+	for (auto _ : state) {
+		ProjectileMotionGradient res = simulateProjectileMotionGradient(params, state.range(0));
+		savedBytes = res.savedBytes;
+		benchmark::DoNotOptimize(res);
+	}
+	state.counters["peak_bytes"] = peak.getPeakIncrease();
+	state.counters["saved_bytes"] = savedBytes;
+	state.counters["sims/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Physics_ProjectileMotionGradient)->Arg(16)->Arg(64)->Arg(4096)->MinTime(2.0);
+
+
+// Batched variants sweep the batch size B, sims/s is comparable with the single lane benchmarks.
+
+static void BM_Physics_ProjectileMotionBatch(benchmark::State& state) {
+	size_t batch = state.range(0);
+
+	// launch angles spread over [10, 80) degrees
+	std::vector<float> angles(batch);
+	for (size_t i = 0; i < batch; i++) angles[i] = 10.0f + 70.0f * i / batch;
+
+	ProjectileMotionBatchParams params(batch);
+	params.angle = makeLaneTensor(angles);
+
+	profiling::PeakMemoryScope peak;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(simulateProjectileMotionBatch(params));
+	}
+	state.counters["peak_bytes"] = peak.getPeakIncrease();
+	state.counters["sims/s"] =
+	    benchmark::Counter(state.iterations() * batch, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Physics_ProjectileMotionBatch)->RangeMultiplier(8)->Range(1, 4096);
+
+
+static void BM_Physics_SphereSlideBatch(benchmark::State& state) {
+	size_t batch = state.range(0);
+
+	// initial speeds spread over [0.001, 0.01)
+	std::vector<float> speeds(batch);
+	for (size_t i = 0; i < batch; i++) speeds[i] = 0.001f + 0.009f * i / batch;
+
+	SphereSlideBatchParams params(batch);
+	params.initalXSpeed = makeLaneTensor(speeds);
+
+	profiling::PeakMemoryScope peak;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(simulateSphereSlideBatch(params));
+	}
+	state.counters["peak_bytes"] = peak.getPeakIncrease();
+	state.counters["sims/s"] =
+	    benchmark::Counter(state.iterations() * batch, benchmark::Counter::kIsRate);
 }
-BENCHMARK(BM_Physics_SphereSlide)->MinTime(2.0);
\ No newline at end of file
+BENCHMARK(BM_Physics_SphereSlideBatch)->RangeMultiplier(8)->Range(1, 4096);
@@ -76,3 +76,35 @@ static void BM_IndexContext_1000(benchmark::State& state) {
 	}
 }
 BENCHMARK(BM_IndexContext_1000)->MinTime(2.0);
+
+
+static void BM_BinaryOpContext_Lookup_Broadcast(benchmark::State& state) {
+	Tensor a({3, 1}, 1.0f, Backend::CPU);
+	Tensor b({1, 4}, 2.0f, Backend::CPU);
+	for (auto _ : state) {
+		auto ctx = semantic::BinaryOpContext::lookup(a, b);
+		benchmark::DoNotOptimize(ctx);
+	}
+}
+BENCHMARK(BM_BinaryOpContext_Lookup_Broadcast)->MinTime(2.0);
+
+
+static void BM_MatmulContext_Lookup_3D_Batched(benchmark::State& state) {
+	Tensor a({5, 100, 200}, 1.0f, Backend::CPU);
+	Tensor b({5, 200, 300}, 2.0f, Backend::CPU);
+	for (auto _ : state) {
+		auto ctx = semantic::MatmulContext::lookup(a, b);
+		benchmark::DoNotOptimize(ctx);
+	}
+}
+BENCHMARK(BM_MatmulContext_Lookup_3D_Batched)->MinTime(2.0);
+
+
+static void BM_ReductionContext_Lookup_1000(benchmark::State& state) {
+	Tensor a({1000, 1000}, 1.0f, Backend::CPU);
+	for (auto _ : state) {
+		auto ctx = semantic::ReductionContext::lookup(a, 1);
+		benchmark::DoNotOptimize(ctx);
+	}
+}
+BENCHMARK(BM_ReductionContext_Lookup_1000)->MinTime(2.0);
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include "nforge/nforge.h"
+
+/// Random (n, n) matrix with about `density` of its elements nonzero.
+static Tensor randomSparseDense(size_t n, float density) {
+	Tensor values({n, n});
+	values.fillUniform(-1.0f, 1.0f, 1);
+	Tensor keep({n, n});
+	keep.fillUniform(0.0f, 1.0f, 2);
+	return values * (keep < Tensor(density));
+}
+
+
+// 99.5% zeros, the sparsity of an interaction matrix
+static void BM_Sparse_SpMV(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor::Sparse a = Tensor::Sparse::fromDense(randomSparseDense(n, 0.005f));
+	Tensor x({n});
+	x.fillUniform(-1.0f, 1.0f, 3);
+	for (auto _ : state) {
+		auto result = a.matmul(x);
+		benchmark::DoNotOptimize(result);
+	}
+	state.counters["nnz"] = (double)a.getNumNonzero();
+	state.counters["bytes"] = (double)a.getNumBytes();
+}
+BENCHMARK(BM_Sparse_SpMV)->Arg(4096)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_Sparse_DenseMV(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor a = randomSparseDense(n, 0.005f);
+	Tensor x({n, 1});
+	x.fillUniform(-1.0f, 1.0f, 3);
+	for (auto _ : state) {
+		auto result = a.matmul(x);
+		benchmark::DoNotOptimize(result);
+	}
+	state.counters["bytes"] = (double)(n * n * sizeof(float));
+}
+BENCHMARK(BM_Sparse_DenseMV)->Arg(4096)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_Sparse_SpMM(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor::Sparse a = Tensor::Sparse::fromDense(randomSparseDense(n, 0.005f));
+	Tensor b({n, 64});
+	b.fillUniform(-1.0f, 1.0f, 4);
+	for (auto _ : state) {
+		auto result = a.matmul(b);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_Sparse_SpMM)->Arg(4096)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_Sparse_DenseMM(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor a = randomSparseDense(n, 0.005f);
+	Tensor b({n, 64});
+	b.fillUniform(-1.0f, 1.0f, 4);
+	for (auto _ : state) {
+		auto result = a.matmul(b);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_Sparse_DenseMM)->Arg(4096)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_Sparse_FromDense(benchmark::State& state) {
+	size_t n = state.range(0);
+	Tensor dense = randomSparseDense(n, 0.005f);
+	for (auto _ : state) {
+		auto result = Tensor::Sparse::fromDense(dense);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_Sparse_FromDense)->Arg(4096)->Unit(benchmark::kMillisecond);
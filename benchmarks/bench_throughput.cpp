@@ -0,0 +1,260 @@
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "backend/cpu/thread_pool.h"
+#include "nforge/core/tensor_layout.h"
+#include "nforge/nforge.h"
+
+// Throughput matrix: every op runs over every layout class, size and thread count. The lhs operand
+// is always a contiguous tensor, the rhs operand is a view of the given layout class with the same
+// shape. Counters report bytes/s and FLOP/s so cases can be placed on a roofline. Bytes are the
+// distinct bytes an op has to move, a broadcast rhs is counted once. The thread count is the
+// number of threads NForge splits every op over, as set by NFORGE_NUM_THREADS, with one benchmark
+// thread issuing the ops. The pool starts with NFORGE_NUM_THREADS or the hardware threads, so
+// counts above that only split the work finer.
+
+namespace {
+
+enum class LayoutClass { Contiguous, Broadcast, Strided, Offset };
+
+const char* nameOf(LayoutClass layout) {
+	switch (layout) {
+		case LayoutClass::Contiguous:
+			return "Contiguous";
+		case LayoutClass::Broadcast:
+			return "Broadcast";
+		case LayoutClass::Strided:
+			return "Strided";
+		case LayoutClass::Offset:
+			return "Offset";
+	}
+	return "";
+}
+
+/// Storage behind an {rows, cols} rhs view of the given layout class.
+Tensor makeStorage(LayoutClass layout, size_t rows, size_t cols) {
+	switch (layout) {
+		case LayoutClass::Contiguous:
+			return Tensor({rows, cols}, 2.0f);
+		case LayoutClass::Broadcast:
+			return Tensor({cols}, 2.0f);
+		case LayoutClass::Strided:
+			return Tensor({rows, 2 * cols}, 2.0f);
+		case LayoutClass::Offset:
+			return Tensor({2, rows, cols}, 2.0f);
+	}
+	return Tensor({rows, cols}, 2.0f);
+}
+
+/// {rows, cols} view of `storage`, built by `makeStorage` for the same layout class.
+Tensor::View makeView(Tensor& storage, LayoutClass layout, size_t rows, size_t cols) {
+	switch (layout) {
+		case LayoutClass::Contiguous:
+			return Tensor::View(storage);
+		case LayoutClass::Broadcast:
+			return Tensor::View(storage, {}, TensorLayout(Tensor::Shape({rows, cols}), {0, 1}, 0));
+		case LayoutClass::Strided:
+			return storage.subsample({1, 2});
+		case LayoutClass::Offset:
+			return storage[1];
+	}
+	return Tensor::View(storage);
+}
+
+/// Bytes of distinct rhs data read by an op over the whole view.
+size_t rhsBytes(LayoutClass layout, size_t rows, size_t cols) {
+	return (layout == LayoutClass::Broadcast ? cols : rows * cols) * sizeof(float);
+}
+
+enum class Op { Add, Less, Sum, Set, Matmul };
+
+const char* nameOf(Op op) {
+	switch (op) {
+		case Op::Add:
+			return "Add";
+		case Op::Less:
+			return "Less";
+		case Op::Sum:
+			return "Sum";
+		case Op::Set:
+			return "Set";
+		case Op::Matmul:
+			return "Matmul";
+	}
+	return "";
+}
+
+void BM_Throughput(benchmark::State& state, Op op, LayoutClass layout) {
+	// elementwise ops run over {size / 64, 64}, matmul over {size, size} @ {size, size}
+	size_t size = state.range(0);
+	size_t rows = op == Op::Matmul ? size : size / 64;
+	size_t cols = op == Op::Matmul ? size : 64;
+	size_t count = rows * cols;
+	cpu::setNumThreads(state.range(1));
+
+	Tensor lhs({rows, cols}, 1.0f);
+	Tensor storage = makeStorage(layout, rows, cols);
+	Tensor::View rhs = makeView(storage, layout, rows, cols);
+
+	double bytes = 0.0, flops = 0.0;
+
+	switch (op) {
+		case Op::Add:
+		case Op::Less:
+			for (auto _ : state) {
+				Tensor result = op == Op::Add ? lhs + rhs : lhs < rhs;
+				benchmark::DoNotOptimize(result);
+			}
+			// comparisons write a Bool mask, one byte per element
+			bytes = count * (sizeof(float) + (op == Op::Add ? sizeof(float) : sizeof(bool))) +
+			        rhsBytes(layout, rows, cols);
+			flops = count;
+			break;
+
+		case Op::Sum:
+			for (auto _ : state) {
+				Tensor result = rhs.sum();
+				benchmark::DoNotOptimize(result);
+			}
+			bytes = rhsBytes(layout, rows, cols);
+			flops = count;
+			break;
+
+		case Op::Set: {
+			Tensor::View target(lhs);
+			for (auto _ : state) {
+				target = rhs;
+				benchmark::ClobberMemory();
+			}
+			bytes = count * sizeof(float) + rhsBytes(layout, rows, cols);
+			break;
+		}
+
+		case Op::Matmul:
+			for (auto _ : state) {
+				Tensor result = lhs.matmul(rhs);
+				benchmark::DoNotOptimize(result);
+			}
+			bytes = 2.0 * count * sizeof(float) + rhsBytes(layout, rows, cols);
+			flops = 2.0 * rows * cols * size;
+			break;
+	}
+
+	state.counters["bytes/s"] =
+	    benchmark::Counter(bytes * state.iterations(), benchmark::Counter::kIsRate);
+	state.counters["FLOP/s"] =
+	    benchmark::Counter(flops * state.iterations(), benchmark::Counter::kIsRate);
+	cpu::setNumThreads(0);
+}
+
+/// `op` on contiguous tensors of `dtype`. Elementwise ops and reductions are bandwidth bound at
+/// large sizes, so narrower dtypes should raise elements/s in proportion to the bytes they save.
+/// 16 bit floats compute in float, matmul converts them while packing its operands.
+void BM_ThroughputDType(benchmark::State& state, Op op, DType dtype) {
+	size_t size = state.range(0);
+	size_t rows = op == Op::Matmul ? size : size / 64;
+	size_t cols = op == Op::Matmul ? size : 64;
+	size_t count = rows * cols;
+	size_t element = getDTypeSize(dtype);
+
+	Tensor lhs({rows, cols}, dtype);
+	Tensor rhs({rows, cols}, dtype);
+	lhs.fillAll(1.0f);
+	rhs.fillAll(2.0f);
+
+	double bytes = 0.0;
+
+	switch (op) {
+		case Op::Add:
+		case Op::Less:
+			for (auto _ : state) {
+				Tensor result = op == Op::Add ? lhs + rhs : lhs < rhs;
+				benchmark::DoNotOptimize(result);
+			}
+			bytes = count * (2 * element + (op == Op::Add ? element : sizeof(bool)));
+			break;
+
+		case Op::Sum:
+			for (auto _ : state) {
+				Tensor result = rhs.sum();
+				benchmark::DoNotOptimize(result);
+			}
+			bytes = count * element;
+			break;
+
+		case Op::Set: {
+			Tensor::View target(lhs);
+			for (auto _ : state) {
+				target = rhs;
+				benchmark::ClobberMemory();
+			}
+			bytes = 2.0 * count * element;
+			break;
+		}
+
+		case Op::Matmul:
+			for (auto _ : state) {
+				Tensor result = lhs.matmul(rhs);
+				benchmark::DoNotOptimize(result);
+			}
+			bytes = 3.0 * count * element;
+			state.counters["FLOP/s"] = benchmark::Counter(2.0 * count * size * state.iterations(),
+			                                              benchmark::Counter::kIsRate);
+			break;
+	}
+
+	state.counters["bytes/s"] =
+	    benchmark::Counter(bytes * state.iterations(), benchmark::Counter::kIsRate);
+	state.SetItemsProcessed(count * state.iterations());
+}
+
+/// Element counts from L1 resident (16 KiB per operand) up to DRAM sized (64 MiB per operand).
+const std::vector<int64_t> ELEMENTWISE_SIZES = {1 << 12, 1 << 15, 1 << 18, 1 << 21, 1 << 24};
+
+/// Square matrix sizes, from all operands in L1 up to operands beyond L2.
+const std::vector<int64_t> MATMUL_SIZES = {16, 64, 256};
+
+const std::vector<int64_t> THREAD_COUNTS = {1, 2, 4};
+
+int registerThroughputBenchmarks() {
+	for (Op op : {Op::Add, Op::Less, Op::Sum, Op::Set, Op::Matmul}) {
+		for (LayoutClass layout : {LayoutClass::Contiguous, LayoutClass::Broadcast,
+		                           LayoutClass::Strided, LayoutClass::Offset}) {
+			std::string name = std::string("BM_Throughput/") + nameOf(op) + "/" + nameOf(layout);
+			auto* bench = benchmark::RegisterBenchmark(name.c_str(), BM_Throughput, op, layout);
+
+			const auto& sizes = op == Op::Matmul ? MATMUL_SIZES : ELEMENTWISE_SIZES;
+			bench->ArgsProduct({sizes, THREAD_COUNTS});
+			bench->ArgNames({"size", "threads"});
+			bench->UseRealTime();
+		}
+	}
+
+	// every dtype for add, the 16 bit floats against Float32 for the other ops
+	for (Op op : {Op::Add, Op::Sum, Op::Set, Op::Matmul}) {
+		std::vector<DType> dtypes = {DType::Float32, DType::Float16, DType::BFloat16};
+		if (op == Op::Add) {
+			dtypes.insert(dtypes.end(), {DType::Float64, DType::Int64, DType::Int32, DType::Int8});
+		}
+
+		for (DType dtype : dtypes) {
+			std::string name =
+			    std::string("BM_ThroughputDType/") + nameOf(op) + "/" + getDTypeName(dtype);
+			auto* bench =
+			    benchmark::RegisterBenchmark(name.c_str(), BM_ThroughputDType, op, dtype);
+
+			for (int64_t size : op == Op::Matmul ? MATMUL_SIZES : ELEMENTWISE_SIZES) {
+				bench->Arg(size);
+			}
+			bench->UseRealTime();
+		}
+	}
+	return 0;
+}
+
+const int registered = registerThroughputBenchmarks();
+
+}  // namespace
@@ -1,3 +1,5 @@
+include(CheckCXXCompilerFlag)
+
 # Helpers to add a CXX flag guarded by compiler, config, and language
 function(nforge_cxx_flag target visibility config flag)
     target_compile_options(${target} ${visibility}
@@ -21,6 +23,12 @@ function(nforge_apply_compiler_flags target)
         nforge_cxx_flag(${target} PRIVATE Release -march=native)
         nforge_cxx_flag(${target} PRIVATE Release -ffast-math)
         nforge_cxx_flag(${target} PRIVATE Release -funroll-loops)
+
+        # -ffast-math lets vectorized division and sqrt use reciprocal estimates, keep them exact
+        check_cxx_compiler_flag(-mno-recip NFORGE_HAS_NO_RECIP)
+        if(NFORGE_HAS_NO_RECIP)
+            nforge_cxx_flag(${target} PRIVATE Release -mno-recip)
+        endif()
     elseif(CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")
         nforge_cxx_flag(${target} PRIVATE Release /arch:AVX2)
         nforge_cxx_flag(${target} PRIVATE Release /fp:fast)
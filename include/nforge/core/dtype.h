@@ -0,0 +1,135 @@
+#ifndef DTYPE_H
+#define DTYPE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// Element type of a tensor.
+enum class DType : uint8_t {
+	/// 32 bit IEEE float, the default.
+	Float32,
+	/// 64 bit IEEE float.
+	Float64,
+	/// 16 bit IEEE half. Storage only, arithmetic is computed in Float32.
+	Float16,
+	/// 16 bit brain float, the upper half of a Float32. Storage only, arithmetic is computed in
+	/// Float32.
+	BFloat16,
+	Int64,
+	Int32,
+	Int8,
+	UInt8,
+	/// One byte per element holding 0 or 1. Produced by comparisons, consumed by logical
+	/// reductions and masked operations.
+	Bool,
+};
+
+/// Size of one element in bytes.
+constexpr size_t getDTypeSize(DType dtype) {
+	switch (dtype) {
+		case DType::Float64:
+		case DType::Int64:
+			return 8;
+		case DType::Float32:
+		case DType::Int32:
+			return 4;
+		case DType::Float16:
+		case DType::BFloat16:
+			return 2;
+		case DType::Int8:
+		case DType::UInt8:
+		case DType::Bool:
+			return 1;
+	}
+	return 0;
+}
+
+/// Returns the lowercase name, e.g. "float32" or "bool".
+constexpr const char* getDTypeName(DType dtype) {
+	switch (dtype) {
+		case DType::Float32:
+			return "float32";
+		case DType::Float64:
+			return "float64";
+		case DType::Float16:
+			return "float16";
+		case DType::BFloat16:
+			return "bfloat16";
+		case DType::Int64:
+			return "int64";
+		case DType::Int32:
+			return "int32";
+		case DType::Int8:
+			return "int8";
+		case DType::UInt8:
+			return "uint8";
+		case DType::Bool:
+			return "bool";
+	}
+	return "unknown";
+}
+
+/// True for Float64, Float32, Float16 and BFloat16.
+constexpr bool isFloatingPoint(DType dtype) {
+	return dtype == DType::Float64 || dtype == DType::Float32 || dtype == DType::Float16 ||
+	       dtype == DType::BFloat16;
+}
+
+/// True for the signed and unsigned integer types, Bool is not integral.
+constexpr bool isIntegral(DType dtype) {
+	return dtype == DType::Int64 || dtype == DType::Int32 || dtype == DType::Int8 ||
+	       dtype == DType::UInt8;
+}
+
+/// Result dtype of a binary operation on `lhs` and `rhs`.
+///
+/// Bool < integers < floating point. Within a category the wider type wins. Int8 with UInt8
+/// becomes Int32, the narrowest type holding both, Float16 with BFloat16 becomes Float32.
+constexpr DType promoteTypes(DType lhs, DType rhs) {
+	if (lhs == rhs || rhs == DType::Bool) {
+		return lhs;
+	}
+	if (lhs == DType::Bool) {
+		return rhs;
+	}
+
+	if (isFloatingPoint(lhs) != isFloatingPoint(rhs)) {
+		return isFloatingPoint(lhs) ? lhs : rhs;
+	}
+
+	if (isFloatingPoint(lhs)) {
+		if (lhs == DType::Float64 || rhs == DType::Float64) {
+			return DType::Float64;
+		}
+		return DType::Float32;
+	}
+
+	if ((lhs == DType::Int8 && rhs == DType::UInt8) ||
+	    (lhs == DType::UInt8 && rhs == DType::Int8)) {
+		return DType::Int32;
+	}
+	return getDTypeSize(lhs) >= getDTypeSize(rhs) ? lhs : rhs;
+}
+
+/// True if values of `from` may be stored into a `to` tensor without leaving its category, e.g.
+/// Float64 into Float16 but not Float32 into Int32. In-place operations require it.
+constexpr bool canCast(DType from, DType to) {
+	if (isFloatingPoint(to)) {
+		return true;
+	}
+	if (isIntegral(to)) {
+		return !isFloatingPoint(from);
+	}
+	return from == DType::Bool;
+}
+
+/// Dtype that sums and products of `dtype` accumulate in and return. Integers and Bool widen to
+/// Int64, 16 bit floats to Float32.
+constexpr DType getAccumulateType(DType dtype) {
+	if (dtype == DType::Float64) {
+		return DType::Float64;
+	}
+	return isFloatingPoint(dtype) ? DType::Float32 : DType::Int64;
+}
+
+#endif  // DTYPE_H
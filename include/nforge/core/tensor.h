@@ -2,17 +2,57 @@
 #define TENSOR_H
 
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "nforge/core/dtype.h"
+
+namespace graph {
+enum class OpType : uint8_t;
+}
+
+namespace autograd {
+class Recorder;
+}
+
+namespace rng {
+struct Distribution;
+}
+
 /// Available backends for tensor storage and operations.
 enum class Backend { CPU, CUDA };
 
+/// Elementwise predicates of the fused `Tensor::all` and `Tensor::any` overloads, matching the
+/// comparison operators and `Tensor::isClose`.
+enum class Predicate { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, IsClose };
+
+/// Elementwise functions of `Tensor::map`. Pow takes its exponent as `alpha`, Clamp its bounds as
+/// `alpha` and `beta`. Float32 and 16 bit floats use polynomial approximations, see
+/// `Tensor::exp` and the following for their error.
+enum class UnaryOp { Exp, Log, Sqrt, Rsqrt, Abs, Tanh, Sigmoid, Sin, Cos, Pow, Clamp };
+
+/// Combining ops of `Tensor::scan`.
+enum class ScanOp { Sum, Prod, Max, Min };
+
+/// Python style `start:stop:step` range of indices along one dim, see `Tensor::slice`. Negative
+/// bounds count from the end of the dim and are clamped to it, missing ones cover the dim in the
+/// direction of `step`. A negative `step` walks the dim backwards.
+struct Slice {
+	std::optional<int64_t> start;
+	std::optional<int64_t> stop;
+	int64_t step = 1;
+};
+
 /// Multi-dimensional array with backend specific implementation.
 ///
-/// A `Tensor` owns a contiguous block of float data managed by a backend specific `Impl` object.
+/// A `Tensor` owns a contiguous block of `DType` elements managed by a backend specific `Impl`
+/// object. Tensors are Float32 unless constructed with another dtype, comparisons produce Bool.
+/// Binary operations promote their operands to a common dtype, see `semantic::resultType`.
 /// Elements can be accessed through `Tensor::View`, which describes a sub region via offset, shape,
 /// and stride layout.
 class Tensor {
@@ -23,6 +63,9 @@ public:
 
 	class View;
 	class Shape;
+	class Graph;
+	class Tape;
+	class Sparse;
 
 public:
 	/// Constructs a tensor with the given shape, zero-initialized.
@@ -31,6 +74,12 @@ public:
 	/// Constructs a tensor with the given shape, zero-initialized.
 	Tensor(const std::initializer_list<size_t>& shape, Backend backend = Backend::CPU);
 
+	/// Constructs a zero-initialized tensor with elements of type `dtype`.
+	Tensor(const Tensor::Shape& shape, DType dtype, Backend backend = Backend::CPU);
+
+	/// Constructs a zero-initialized tensor with elements of type `dtype`.
+	Tensor(const std::initializer_list<size_t>& shape, DType dtype, Backend backend = Backend::CPU);
+
 	/// Constructs a tensor and fills every element with `value`.
 	Tensor(const Tensor::Shape& shape, float value, Backend backend = Backend::CPU);
 
@@ -56,9 +105,26 @@ public:
 	/// Fills all elements with `value`.
 	void fillAll(float value);
 
-	/// Fills all elements with random values in [-1, 1].
+	/// Fills all elements with uniform random values in [-1, 1), drawn from the global generator.
 	void fillRand();
 
+	/// Fills all elements with uniform random values in [low, high).
+	///
+	/// Random fills use a counter based Philox generator. Without `seed` values are drawn from
+	/// the global generator, see `setRandomSeed`. With `seed` the result only depends on the seed
+	/// and the number of elements.
+	void fillUniform(float low, float high, std::optional<uint64_t> seed = std::nullopt);
+
+	/// Fills all elements with normal random values.
+	void fillNormal(float mean, float stddev, std::optional<uint64_t> seed = std::nullopt);
+
+	/// Fills all elements with 1 with probability `p`, else 0.
+	void fillBernoulli(float p, std::optional<uint64_t> seed = std::nullopt);
+
+	/// Seeds the global generator. Fills without a seed are reproducible for a given sequence of
+	/// fills after this call.
+	static void setRandomSeed(uint64_t seed);
+
 	/// Prints the tensor to stdout.
 	void print() const;
 
@@ -74,6 +140,12 @@ public:
 	/// Returns the backend enum.
 	inline Backend getBackend() const { return m_backend; }
 
+	/// Returns the element type.
+	DType getDType() const;
+
+	/// Returns a copy with elements converted to `dtype`. Converting to Bool maps non-zero to 1.
+	Tensor asType(DType dtype) const;
+
 	/// Returns a string representation of the underlying data.
 	std::string getDataString() const;
 
@@ -83,6 +155,13 @@ public:
 	/// Copies all elements into a flat vector (row-major order).
 	std::vector<float> toVector() const;
 
+	/// Copies all elements into a flat vector (row-major order) of their own element type,
+	/// without the rounding of the float overload, e.g. `toVector<int64_t>()` for Int64. `T` is
+	/// one of float, double, int64_t, int32_t, int8_t, uint8_t and bool.
+	/// @throws std::runtime_error  If `T` is not the element type of the dtype.
+	template <typename T>
+	std::vector<T> toVector() const;
+
 	/// Replaces the block starting at `position` with the data from `rhs`.
 	void set(const std::vector<size_t>& position, const Tensor::View& rhs);
 
@@ -101,7 +180,7 @@ public:
 	/// Elementwise multiplication with a tensor or view.
 	Tensor operator*(const Tensor::View& rhs) const;
 
-	/// Elementwise division by a tensor or view.
+	/// Elementwise division by a tensor or view. Integer and Bool operands produce Float32.
 	Tensor operator/(const Tensor::View& rhs) const;
 
 	/// Elementwise addition with a pure float.
@@ -137,13 +216,18 @@ public:
 	/// In-place elementwise multiplication with a tensor or view.
 	void operator*=(const Tensor::View& rhs);
 
-	/// In-place elementwise division by a tensor or view.
+	/// In-place elementwise division by a tensor or view. This tensor must be floating point.
 	void operator/=(const Tensor::View& rhs);
 
+	/// Sets every element where `mask` is non-zero to `value`. `mask` must broadcast to the shape
+	/// of this tensor, a Bool mask from a comparison is read directly.
+	void maskedFill(const Tensor::View& mask, float value);
+
 	/// Reduces dimensions [dim, rank) by averaging. Result shape is shape[0:dim].
 	Tensor mean(size_t dim = 0) const;
 
 	/// Reduces dimensions [dim, rank) by summation. Result shape is shape[0:dim].
+	/// Integers and Bool sum into Int64, 16 bit floats into Float32.
 	Tensor sum(size_t dim = 0) const;
 
 	/// Reduces dimensions [dim, rank) by taking the minimum. Result shape is shape[0:dim].
@@ -153,19 +237,166 @@ public:
 	Tensor max(size_t dim = 0) const;
 
 	/// Reduces dimensions [dim, rank) by taking the product. Result shape is shape[0:dim].
+	/// Result dtype as for `sum`.
 	Tensor prod(size_t dim = 0) const;
 
-	/// L2 norm (scalar tensor equal to `sqrt(sum(x^2))`).
-	Tensor norm() const;
+	/// Reduces dimensions [dim, rank) by taking the L2 norm, `sqrt(sum(x^2))`.
+	/// Result shape is shape[0:dim], the default is a scalar over the whole tensor.
+	Tensor norm(size_t dim = 0) const;
 
 	/// For each block, tests whether all element evaluate to True (non-zero).
 	/// Reduces dimensions [dim, rank) by applying logical AND. Result shape is shape[0:dim].
+	/// Returns a Bool tensor. Contiguous Bool inputs stop scanning a block at its first zero.
 	Tensor all(size_t dim = 0) const;
 
 	/// For each block, tests whether any element evaluate to True (non-zero).
 	/// Reduces dimensions [dim, rank) by applying logical OR. Result shape is shape[0:dim].
+	/// Returns a Bool tensor. Contiguous Bool inputs stop scanning a block at its first one.
 	Tensor any(size_t dim = 0) const;
 
+	/// Counts the non-zero elements of each block. Reduces dimensions [dim, rank), result shape is
+	/// shape[0:dim]. Returns an Int64 tensor.
+	Tensor countNonzero(size_t dim = 0) const;
+
+	/// Index of the first smallest element of each block of dimensions [dim, rank), counted in
+	/// row-major order within the block. Result shape is shape[0:dim]. Returns an Int64 tensor. A
+	/// NaN is taken over any number.
+	Tensor argmin(size_t dim = 0) const;
+
+	/// Index of the first largest element of each block, see `argmin`.
+	Tensor argmax(size_t dim = 0) const;
+
+	/// The `k` largest elements of each block of dimensions [dim, rank), or the `k` smallest if not
+	/// `largest`, and their indices as in `argmin`. Both have shape shape[0:dim] + {k} and are
+	/// ordered from the best, equal values by index. Values keep the dtype, indices are Int64.
+	/// Uses a size `k` heap per block, O(n log k). NaN are not ordered.
+	std::pair<Tensor, Tensor> topk(size_t k, size_t dim = 0, bool largest = true) const;
+
+	/// Each block of dimensions [dim, rank) sorted ascending, or descending if `descending`, in
+	/// row-major order within the block. Keeps the shape and dtype. The sort is stable and NaN
+	/// order above every number. Blocks of 256 elements and more use an LSD radix sort, O(n).
+	Tensor sort(size_t dim = 0, bool descending = false) const;
+
+	/// Indices that sort each block, counted as in `argmin`. Same order as `sort`, so equal values
+	/// keep their order. Returns an Int64 tensor of the same shape.
+	Tensor argsort(size_t dim = 0, bool descending = false) const;
+
+	/// Each block reordered so the element at `kth` is the one `sort` puts there, with no larger
+	/// element before it and no smaller one after, like `std::nth_element`. O(n) on average.
+	Tensor partition(size_t kth, size_t dim = 0) const;
+
+	/// True if `predicate(this, rhs)` holds for every element pair after broadcasting. Evaluated
+	/// in one pass without materializing a mask, stopping at the first pair that fails.
+	/// @param tolerance  Used by Predicate::IsClose, see `isClose`.
+	bool all(Predicate predicate, const Tensor::View& rhs, float tolerance = 1e-5f) const;
+
+	/// True if `predicate(this, rhs)` holds for any element pair, see `all`. Stops at the first
+	/// pair that holds.
+	bool any(Predicate predicate, const Tensor::View& rhs, float tolerance = 1e-5f) const;
+
+	/// True if every element is close to `rhs`, `all(Predicate::IsClose, rhs, tolerance)`.
+	bool allClose(const Tensor::View& rhs, float tolerance = 1e-5f) const;
+
+	/// Softmax over each block of dimensions [dim, rank), `exp(x - max) / sum(exp(x - max))`.
+	/// Result has the shape of this tensor. Floating dtypes are kept, others compute as Float32.
+	Tensor softmax(size_t dim = 0) const;
+
+	/// Log of `softmax`, computed as `x - logSumExp` without forming the quotient.
+	Tensor logSoftmax(size_t dim = 0) const;
+
+	/// `log(sum(exp(x)))` of each block, shifted by the block maximum so it does not overflow.
+	/// Reduces dimensions [dim, rank), result shape is shape[0:dim].
+	Tensor logSumExp(size_t dim = 0) const;
+
+	/// Scan of `op` along dimension `dim`. Element i of each line along `dim` combines elements
+	/// [0, i] of the line, or [0, i) if `exclusive`, with the identity of `op` first. Result has
+	/// the shape of this tensor, Sum and Prod produce the dtype of `sum`, Max and Min keep it.
+	Tensor scan(ScanOp op, size_t dim, bool exclusive = false) const;
+
+	/// Cumulative sum along `dim`, see `scan`. Lines of 2048 elements and more along the last dim
+	/// are scanned in 8 interleaved chunks, so float sums round per chunk rather than strictly
+	/// left to right.
+	Tensor cumsum(size_t dim, bool exclusive = false) const;
+
+	/// Cumulative product along `dim`, see `cumsum`.
+	Tensor cumprod(size_t dim, bool exclusive = false) const;
+
+	/// Running maximum along `dim`, see `scan`.
+	Tensor cummax(size_t dim, bool exclusive = false) const;
+
+	/// Running minimum along `dim`, see `scan`.
+	Tensor cummin(size_t dim, bool exclusive = false) const;
+
+	/// Elements picked along `dim` by the integer tensor `index`, which has the rank of this tensor
+	/// and no other dim longer than it. Position p of the result holds the element at p with
+	/// coordinate `dim` replaced by index[p], e.g. `out[i][j] = this[i][index[i][j]]` for dim 1.
+	/// Result has the shape of `index` and the dtype of this tensor. Indices outside
+	/// [0, shape[dim]) throw std::out_of_range on the CPU and gather 0 on CUDA.
+	Tensor gather(size_t dim, const Tensor::View& index) const;
+
+	/// Slices along `dim` picked by the 1D integer tensor `index`, in its order and with repeats,
+	/// e.g. rows of an embedding table for dim 0. Result has the shape of this tensor with dim
+	/// `dim` as long as `index`. Rows of the inner dims are copied whole, see `gather` for indices
+	/// out of range.
+	Tensor indexSelect(size_t dim, const Tensor::View& index) const;
+
+	/// Inverse of `gather` in place, writes src[p] to the element `gather` reads for position p of
+	/// `index`. `src` broadcasts to the shape of `index` and is converted to the dtype of this
+	/// tensor. Of repeated indices the last one wins on the CPU and any one on CUDA. Indices out
+	/// of range throw std::out_of_range on the CPU before anything is written and are skipped on
+	/// CUDA.
+	void scatter(size_t dim, const Tensor::View& index, const Tensor::View& src);
+
+	/// `scatter` that adds src[p] to the element instead, so repeated indices sum up, e.g.
+	/// particle masses deposited on the cells of a grid.
+	void scatterAdd(size_t dim, const Tensor::View& index, const Tensor::View& src);
+
+	/// Applies `op` elementwise into a new tensor, see `UnaryOp`. Floating dtypes are kept, other
+	/// dtypes compute as Float32 except for Abs and Clamp, which keep them.
+	Tensor map(UnaryOp op, float alpha = 0.0f, float beta = 0.0f) const;
+
+	/// Applies `op` elementwise in place. The result dtype, see `map`, must fit this tensor.
+	void mapInplace(UnaryOp op, float alpha = 0.0f, float beta = 0.0f);
+
+	/// Writes `op` of this tensor into `out` without allocating. This tensor is broadcast to the
+	/// shape of `out` and the result dtype, see `map`, must fit it.
+	void mapInto(const Tensor::View& out, UnaryOp op, float alpha = 0.0f, float beta = 0.0f) const;
+
+	/// Elementwise exp, within 1 ulp in Float32. Results below 2^-126 flush to 2^-126.
+	Tensor exp() const;
+
+	/// Elementwise natural log, within 2 ulp in Float32.
+	Tensor log() const;
+
+	/// Elementwise square root, correctly rounded. Builds with -ffast-math use a reciprocal
+	/// estimate, within 3 ulp in Float32.
+	Tensor sqrt() const;
+
+	/// Elementwise `1 / sqrt(x)`, within 4 ulp in Float32.
+	Tensor rsqrt() const;
+
+	/// Elementwise absolute value, exact.
+	Tensor abs() const;
+
+	/// Elementwise tanh, within 3 ulp in Float32.
+	Tensor tanh() const;
+
+	/// Elementwise `1 / (1 + exp(-x))`, within 4 ulp in Float32 for x >= -87.
+	Tensor sigmoid() const;
+
+	/// Elementwise sin, in Float32 within 2 ulp for |x| <= pi and 1e-7 absolute error for
+	/// |x| <= 8192.
+	Tensor sin() const;
+
+	/// Elementwise cos, with the error of `sin`.
+	Tensor cos() const;
+
+	/// Elementwise `x^exponent`, within 2 ulp in Float32 for |exponent| <= 8.
+	Tensor pow(float exponent) const;
+
+	/// Elementwise clamp to [low, high], exact.
+	Tensor clamp(float low, float high) const;
+
 	/// Matrix multiplication. Inputs must be 2D or 3D tensors.
 	/// 2D: (N, M) @ (M, K) => (N, K).
 	///
@@ -174,6 +405,77 @@ public:
 	/// Batch dims must be broadcastable, match or be 1.
 	Tensor matmul(const Tensor::View& rhs) const;
 
+	/// Int8 matrix multiplication with Int32 accumulation,
+	/// (lhs - lhsZeroPoint) @ (rhs - rhsZeroPoint) as Int32. This tensor is Int8 or UInt8 and
+	/// `rhs` Int8, shapes as for `matmul`. Results outside of Int32 saturate.
+	/// @throws std::runtime_error  If the inner dim is longer than 65793, the largest for which
+	/// the Int32 accumulation is exact.
+	Tensor matmulInt8(const Tensor::View& rhs, int32_t lhsZeroPoint = 0,
+	                  int32_t rhsZeroPoint = 0) const;
+
+	/// Int8 matrix multiplication with a fused requantize epilogue. Each Int32 result `acc` is
+	/// stored as round(acc * multiplier) + outZeroPoint, saturated to `dtype`, without
+	/// materializing the Int32 matrix. `multiplier` has one element, or one per output column for
+	/// per channel scales, and is usually lhsScale * rhsScale / outScale.
+	Tensor matmulInt8(const Tensor::View& rhs, int32_t lhsZeroPoint, int32_t rhsZeroPoint,
+	                  const Tensor::View& multiplier, int32_t outZeroPoint,
+	                  DType dtype = DType::Int8) const;
+
+	/// 1D convolution of a (batch, inChannels, length) tensor with (outChannels, inChannels,
+	/// kernel) weights, as cross-correlation without flipping the kernel. Gives (batch,
+	/// outChannels, outLength) with outLength = (length + 2 * padding - dilation * (kernel - 1) -
+	/// 1) / stride + 1, padding with zeros on both sides. Operands are promoted as for `matmul`.
+	Tensor conv1d(const Tensor::View& weight, size_t stride = 1, size_t padding = 0,
+	              size_t dilation = 1) const;
+
+	/// 2D convolution of a (batch, inChannels, height, width) tensor with (outChannels,
+	/// inChannels, kernelHeight, kernelWidth) weights, see `conv1d`. `stride`, `padding` and
+	/// `dilation` apply to both spatial dims. On the CPU, convolutions with fewer than 64 input
+	/// channels times kernel taps, such as a 3x3 filter on few channels, are computed directly,
+	/// deeper ones lower to im2col and the `matmul` kernel.
+	Tensor conv2d(const Tensor::View& weight, size_t stride = 1, size_t padding = 0,
+	              size_t dilation = 1) const;
+
+	/// Affine quantization to `dtype`, Int8 or UInt8: round(x / scale) + zeroPoint, rounding half
+	/// to even and saturating. `scale` and `zeroPoint` broadcast to the shape of this tensor, a
+	/// scalar quantizes per tensor, shape {n, 1} or {n} per channel along a dim of size n.
+	Tensor quantize(const Tensor::View& scale, const Tensor::View& zeroPoint,
+	                DType dtype = DType::Int8) const;
+
+	/// Inverse of `quantize`, (q - zeroPoint) * scale as Float32.
+	Tensor dequantize(const Tensor::View& scale, const Tensor::View& zeroPoint) const;
+
+	/// Cholesky factor of each symmetric positive definite matrix in the last two dims, the lower
+	/// triangular L with L @ L^T = A. Only the lower triangle of A is read, the upper one of L is
+	/// zero. This and the following factorizations and solves compute in Float64 for Float64
+	/// operands and in Float32 otherwise, and return that dtype. They are blocked so the trailing
+	/// updates run through the `matmul` kernel, and parallel over the matrices of a batch or the
+	/// columns of one large matrix. CUDA tensors are factorized on a host copy.
+	/// @throws std::runtime_error  If a matrix is not positive definite.
+	Tensor cholesky() const;
+
+	/// LU factorization with partial pivoting of each square matrix in the last two dims,
+	/// P @ A = L @ U. Returns the factors packed into one tensor, U on and above the diagonal and
+	/// the unit lower triangular L below it, and the Int64 permutation with shape[0:rank-1]: row
+	/// i of P @ A is row perm[i] of A. Singular matrices give a zero on the diagonal of U.
+	std::pair<Tensor, Tensor> lu() const;
+
+	/// Reduced QR factorization of each (m, n) matrix in the last two dims, m >= n, by Householder
+	/// reflections. Returns Q (..., m, n) with orthonormal columns and the upper triangular R
+	/// (..., n, n), A = Q @ R. Diagonal elements of R may be negative.
+	std::pair<Tensor, Tensor> qr() const;
+
+	/// Solves A @ X = B for X, each A a triangular matrix in the last two dims of this tensor and
+	/// B (..., n, k) from `rhs` with the same leading dims. Reads the lower triangle of A if
+	/// `lower`, else the upper one, and takes its diagonal as ones if `unitDiagonal`.
+	/// @throws std::runtime_error  If a diagonal element is zero and not `unitDiagonal`.
+	Tensor solveTriangular(const Tensor::View& rhs, bool lower, bool unitDiagonal = false) const;
+
+	/// Solves A @ X = B for X, each A a square matrix in the last two dims of this tensor, by `lu`
+	/// and two triangular solves. `rhs` as for `solveTriangular`.
+	/// @throws std::runtime_error  If a matrix is singular, with an exact zero pivot.
+	Tensor solve(const Tensor::View& rhs) const;
+
 	/// Indexes into the first dimension, returning a view of the sub-tensor.
 	Tensor::View operator[](size_t idx) const;
 
@@ -181,6 +483,52 @@ public:
 	/// @param strides Length must match rank of tensor or be scalar 0.
 	Tensor::View subsample(std::vector<size_t> strides) const;
 
+	/// View of the same elements in row-major order as `shape`, nothing is copied. A tensor is
+	/// contiguous, so this only throws if the element counts differ.
+	Tensor::View reshape(const Tensor::Shape& shape) const;
+
+	/// View with dim `d` taken from dim `dims[d]`, `dims` being a permutation of 0..rank-1.
+	Tensor::View permute(const std::vector<size_t>& dims) const;
+
+	/// View with dims `dim0` and `dim1` swapped, see `permute`.
+	Tensor::View transpose(size_t dim0, size_t dim1) const;
+
+	/// View without the size 1 dims, keeping at least one dim.
+	Tensor::View squeeze() const;
+
+	/// View without dim `dim`, which must have size 1.
+	Tensor::View squeeze(size_t dim) const;
+
+	/// View of `ranges[d]` along each dim `d`, dims past the end of `ranges` are kept whole. Only
+	/// the layout changes, so `x.slice({{}, {100, 200}})` is `x[:, 100:200]` in numpy and
+	/// `x.slice({{5, std::nullopt, 3}})` is `x[5::3]`.
+	Tensor::View slice(const std::vector<Slice>& ranges) const;
+
+	/// View of `range` along dim `dim`, see `slice`.
+	Tensor::View slice(size_t dim, const Slice& range) const;
+
+	/// View of every window of `size` elements along dim `dim`, starting `step` apart. Dim `dim`
+	/// becomes the window count and a trailing dim of `size` is appended, windows overlap when
+	/// `step < size`.
+	Tensor::View unfold(size_t dim, size_t size, size_t step) const;
+
+	/// View with a size 1 dim inserted before dim `dim`, `dim` may be the rank to append one.
+	Tensor::View unsqueeze(size_t dim) const;
+
+	/// View repeating the size 1 dims to `shape` with stride 0, new leading dims as well. Every
+	/// repeat reads the same element, so writing through the view writes that element.
+	Tensor::View expand(const Tensor::Shape& shape) const;
+
+	/// `tensors` joined along dim `dim` into one tensor, allocated once. The tensors have the
+	/// same rank and extents except along `dim`, and their dtypes promote to the result dtype.
+	/// Contiguous inputs are copied in whole runs, one per index of the dims before `dim`. On the
+	/// CPU the runs of all inputs are cut into chunks that are copied on every thread.
+	static Tensor concat(const std::vector<Tensor::View>& tensors, size_t dim = 0);
+
+	/// `tensors` of one shape joined along a new dim inserted before `dim`, see `concat`. Stacking
+	/// rows of shape {n} gives a batch of shape {rows, n}.
+	static Tensor stack(const std::vector<Tensor::View>& tensors, size_t dim = 0);
+
 	/// Copies data from another tensor.
 	Tensor& operator=(const Tensor& rhs);
 
@@ -199,46 +547,61 @@ public:
 	/// @note Exact match, which is unstable for floats. Consider using `.isClose()`
 	bool isNotEqual(const Tensor::View& rhs) const;
 
-	/// Elementwise equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise equal. Returns a Bool tensor.
 	Tensor operator==(const Tensor::View& rhs) const;
 
-	/// Elementwise not equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise not equal. Returns a Bool tensor.
 	Tensor operator!=(const Tensor::View& rhs) const;
 
-	/// Elementwise less than. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise less than. Returns a Bool tensor.
 	Tensor operator<(const Tensor::View& rhs) const;
 
-	/// Elementwise less or equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise less or equal. Returns a Bool tensor.
 	Tensor operator<=(const Tensor::View& rhs) const;
 
-	/// Elementwise greater than. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise greater than. Returns a Bool tensor.
 	Tensor operator>(const Tensor::View& rhs) const;
 
-	/// Elementwise greater or equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise greater or equal. Returns a Bool tensor.
 	Tensor operator>=(const Tensor::View& rhs) const;
 
-	/// Elementwise closeness check within `tolerance`. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise closeness check within `tolerance`. Returns a Bool tensor.
 	/// @param tolerance  Maximum absolute or relative difference (default: 1e-5).
 	Tensor isClose(const Tensor::View& rhs, float tolerance = 1e-5f) const;
 
 private:
+	friend class autograd::Recorder;
+
 	Backend m_backend;
 	std::unique_ptr<Impl> m_impl;
 
 	/// Applies `op` element-wise via Impl after broadcasting. Returns a new tensor.
 	/// @tparam BinaryOp  Member function pointer on Impl, e.g. `&Impl::add`.
+	/// @param type  Operation recorded while a graph capture is active.
 	template <typename BinaryOp>
-	Tensor applyBinaryOp(const Tensor::View& rhs, BinaryOp op) const;
+	Tensor applyBinaryOp(const Tensor::View& rhs, BinaryOp op, graph::OpType type) const;
 
 	/// Applies `op` in-place via Impl. The output layout must match `*this`.
 	/// @tparam BinaryOp  Member function pointer on Impl, e.g. `&Impl::iadd`.
+	/// @param type  Operation recorded while a graph capture is active.
 	template <typename BinaryOp>
-	void applyInplaceBinaryOp(const Tensor::View& rhs, BinaryOp op);
+	void applyInplaceBinaryOp(const Tensor::View& rhs, BinaryOp op, graph::OpType type);
 
 	/// Applies reduction `op` along dimensions [dim, rank) via Impl.
 	/// @tparam ReductionOp  Member function pointer on Impl, e.g. `&Impl::sum`.
+	/// @param type  Operation recorded while a graph capture is active.
 	template <typename ReductionOp>
-	Tensor applyReduction(size_t dim, ReductionOp op) const;
+	Tensor applyReduction(size_t dim, ReductionOp op, graph::OpType type) const;
+
+	/// Fills via Impl from the stream of `seed`, or from the global generator without one.
+	/// @param what  Name of the public method, reported if a graph capture is active.
+	void applyRandomFill(const rng::Distribution& dist, std::optional<uint64_t> seed,
+	                     const char* what);
+
+	/// Copies input `tensors[copy.input]` from `copy.source` into `copy.target` of this tensor
+	/// for every copy of `copies`, in one `Impl::setAll`. See `semantic::ConcatContext`.
+	template <typename Copies>
+	void applyCopies(const std::vector<Tensor::View>& tensors, const Copies& copies);
 };
 
 #endif  // TENSOR_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef TENSOR_GRAPH_H
+#define TENSOR_GRAPH_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "nforge/core/tensor.h"
+
+namespace graph {
+struct Program;
+}
+
+/// Recorded sequence of tensor operations that can be replayed without dispatch or allocation.
+///
+/// `capture` runs a body once and records the operations it performs on tensors. Intermediates
+/// are assigned to regions of a single arena, reused once their last reader has run. `replay`
+/// then executes the recorded kernels directly on the bound tensors.
+///
+/// Recorded operations are elementwise arithmetic and comparisons, `map` and the functions built
+/// on it (`exp`, `clamp`, ...), in-place updates and assignments through views, the reductions
+/// `sum`, `min`, `max`, `prod`, `all`, `any` and `norm`, and `matmul`. Every other operation,
+/// e.g. softmax, sort, scan, gather, concat or conv, throws std::runtime_error during a capture.
+///
+/// Bound tensors are the inputs and outputs of the graph, their storage is looked up on every
+/// replay. Any other tensor read by the body is treated as a constant, its value at capture time
+/// is baked into the graph. Host side control flow, e.g. branching on `toVector()`, is not
+/// recorded.
+///
+/// Capture is supported on the CPU backend only. Bound tensors must outlive the graph.
+class Tensor::Graph {
+public:
+	/// Records the operations `body` performs. The body runs once, bound tensors are restored
+	/// afterwards, so capturing has no visible effect on them.
+	/// @param bindings  Tensors read or written by the graph across replays.
+	/// @throws std::runtime_error  If a binding is not on the CPU, bound twice, changes its number
+	/// of elements, or if a capture is already active on this thread.
+	static Tensor::Graph capture(const std::vector<std::reference_wrapper<Tensor>>& bindings,
+	                             const std::function<void()>& body);
+
+	Graph(Graph&& other) noexcept;
+	Graph& operator=(Graph&& other) noexcept;
+	~Graph();
+
+	/// Executes the recorded operations on the current data of the bound tensors.
+	/// @throws std::runtime_error  If a bound tensor changed backend or number of elements.
+	void replay();
+
+	/// Returns the number of recorded operations after dead operation elimination.
+	size_t getNumNodes() const;
+
+	/// Returns the number of distinct arena regions intermediates were assigned to.
+	size_t getNumSlots() const;
+
+	/// Returns the size of the intermediate arena in bytes.
+	size_t getArenaBytes() const;
+
+private:
+	Graph(std::vector<Tensor*> bindings, std::unique_ptr<graph::Program> program);
+
+	std::vector<Tensor*> m_bindings;
+	std::vector<float*> m_bindingData;
+	std::unique_ptr<graph::Program> m_program;
+};
+
+#endif  // TENSOR_GRAPH_H
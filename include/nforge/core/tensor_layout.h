@@ -17,6 +17,8 @@ struct TensorLayout {
 	std::array<size_t, MAX_DIMS> shape;
 
 	/// Stride (element count) per dimension. Only first `rank` entries active.
+	/// A dim walked backwards, see `Tensor::slice`, stores its negative stride modulo 2^64.
+	/// Offsets are summed with unsigned wraparound, so every element offset is still exact.
 	std::array<size_t, MAX_DIMS> strides;
 
 	/// Storage offset before indexing begins.
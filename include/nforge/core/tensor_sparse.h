@@ -0,0 +1,117 @@
+#ifndef TENSOR_SPARSE_H
+#define TENSOR_SPARSE_H
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+
+#include "nforge/core/tensor.h"
+#include "nforge/core/tensor_shape.h"
+#include "nforge/core/tensor_view.h"
+
+/// 2D matrix that stores only its nonzero elements, in compressed sparse row (CSR) form.
+///
+/// The stored elements of row i are entries [offsets[i], offsets[i + 1]) of the column indices
+/// and values, sorted by column. Offsets are Int64, column indices Int32 and values keep the
+/// dtype the matrix was built from, so a Float32 matrix takes 8 bytes per stored element instead
+/// of 4 per element: one with 1% nonzeros needs a fiftieth of the dense memory.
+///
+/// Matrices are built from coordinate (COO) entries with `fromCOO` or from a dense tensor with
+/// `fromDense`. Products and elementwise ops take dense operands and split the rows over threads
+/// by their number of stored elements.
+///
+/// Sparse matrices live on the CPU. Dense operands on another backend are copied to the host and
+/// results are returned to their backend. Sparse ops can not be recorded in a graph capture, and
+/// dense operands must not depend on the parameters of a recording tape.
+class Tensor::Sparse {
+public:
+	/// Builds a matrix from coordinate entries in any order, entry e is `values[e]` at
+	/// (`rowIndices[e]`, `colIndices[e]`). Entries with equal coordinates are summed.
+	/// @param shape  (rows, cols) of the matrix.
+	/// @param rowIndices, colIndices  1D integer tensors, one index per entry.
+	/// @param values  1D tensor, one value per entry. Its dtype is the dtype of the matrix.
+	/// @throws std::runtime_error  If `shape` is not 2D or has more than 2^31 - 1 columns, the
+	/// indices are not integers or the lengths differ.
+	/// @throws std::out_of_range  If an index is outside of `shape`.
+	static Sparse fromCOO(const Tensor::Shape& shape, const Tensor::View& rowIndices,
+	                      const Tensor::View& colIndices, const Tensor::View& values);
+
+	/// Stores the nonzero elements of the 2D `dense`, in its dtype. NaN counts as nonzero.
+	/// @throws std::runtime_error  If `dense` is not 2D or has more than 2^31 - 1 columns.
+	static Sparse fromDense(const Tensor::View& dense);
+
+	/// Copy constructor. Performs a deep copy.
+	Sparse(const Sparse& other);
+	Sparse(Sparse&& other) noexcept;
+	Sparse& operator=(const Sparse& other);
+	Sparse& operator=(Sparse&& other) noexcept;
+	~Sparse();
+
+	/// Returns the dense CPU tensor, zero where nothing is stored.
+	Tensor toDense() const;
+
+	/// Returns the stored elements as coordinate entries in row-major order: row indices, column
+	/// indices, both Int64, and values.
+	std::tuple<Tensor, Tensor, Tensor> toCOO() const;
+
+	/// Matrix product with the dense `rhs`. A (cols) vector gives a (rows) vector (SpMV), a
+	/// (cols, k) matrix a (rows, k) matrix (SpMM). The result has the promoted dtype of both,
+	/// see `promoteTypes`.
+	/// @throws std::runtime_error  If the shapes do not match.
+	Tensor matmul(const Tensor::View& rhs) const;
+
+	/// Elementwise product with the dense `rhs`, broadcast to the shape of the matrix. Only the
+	/// stored elements are computed, so the result stores the same elements, the others stay
+	/// zero even where `rhs` is infinite or NaN.
+	/// @throws std::runtime_error  If `rhs` does not broadcast to the shape of the matrix.
+	Sparse operator*(const Tensor::View& rhs) const;
+
+	/// Elementwise true division by the dense `rhs`, broadcast like `operator*`. Integer and Bool
+	/// operands divide as Float32. Elements that are not stored stay zero, even where `rhs` is
+	/// zero.
+	Sparse operator/(const Tensor::View& rhs) const;
+
+	/// Elementwise sum with the dense `rhs`, broadcast to the shape of the matrix. Returns a
+	/// dense tensor with the promoted dtype of both.
+	/// @throws std::runtime_error  If `rhs` does not broadcast to the shape of the matrix.
+	Tensor operator+(const Tensor::View& rhs) const;
+
+	/// Elementwise difference with the dense `rhs`, see `operator+`.
+	Tensor operator-(const Tensor::View& rhs) const;
+
+	/// Returns (rows, cols).
+	Tensor::Shape getShape() const;
+
+	/// Returns the element type of the values.
+	DType getDType() const;
+
+	/// Returns the number of stored elements. Elements given as zero to `fromCOO` are stored.
+	size_t getNumNonzero() const;
+
+	/// Returns the bytes of the offsets, column indices and values.
+	size_t getNumBytes() const;
+
+private:
+	Sparse(size_t rows, size_t cols, std::unique_ptr<Tensor::Impl> offsets,
+	       std::unique_ptr<Tensor::Impl> columns, std::unique_ptr<Tensor::Impl> values);
+
+	/// Throws if a graph capture is active or `operand` is tracked by a tape, `what` names the op.
+	static void ensureOperand(const Tensor::View& operand, const char* what);
+
+	/// Shared by `operator*` and `operator/`, the result stores the elements of this matrix.
+	template <typename Op>
+	Sparse applyElementwise(const Tensor::View& rhs, DType dtype, Op op, const char* what) const;
+
+	/// Shared by `operator+` and `operator-`.
+	Tensor applyDense(const Tensor::View& rhs, bool subtract, const char* what) const;
+
+	size_t m_rows = 0;
+	size_t m_cols = 0;
+
+	/// CPU tensors of the rows + 1 offsets, and of the columns and values of the stored elements.
+	std::unique_ptr<Tensor> m_offsets;
+	std::unique_ptr<Tensor> m_columns;
+	std::unique_ptr<Tensor> m_values;
+};
+
+#endif  // TENSOR_SPARSE_H
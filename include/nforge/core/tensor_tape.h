@@ -0,0 +1,72 @@
+#ifndef TENSOR_TAPE_H
+#define TENSOR_TAPE_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "nforge/core/tensor.h"
+#include "nforge/core/tensor_shape.h"
+
+namespace autograd {
+class Recorder;
+}
+
+/// Reverse mode automatic differentiation of tensor operations.
+///
+/// While a tape is alive it records every operation on the calling thread that depends on one of
+/// its parameters. `gradient` then runs the recorded operations backwards and returns the
+/// gradient of an output with respect to every parameter.
+///
+/// Elementwise arithmetic, in place updates and assignments through views, `maskedFill`, the sum,
+/// min, max and norm reductions, `matmul`, `map` and its shorthands, `concat` and `stack` are
+/// differentiable. Operations without a backward rule, e.g. `softmax` or `scatter`, throw if they
+/// read a tracked value. Comparisons of tracked values give constant results. Gradients are
+/// Float32, min and max split nothing between tied elements, each of them gets the full gradient.
+///
+/// The tape keeps the operands each backward rule reads alive. Long loops, e.g. the time steps of
+/// a simulation, are wrapped in `checkpoint` to bound that memory.
+class Tensor::Tape {
+public:
+	/// Starts recording on the calling thread.
+	/// @param params  Floating point tensors to take gradients with respect to. Their data at this
+	/// point is what the gradients are taken at, they may be updated by the recorded operations.
+	/// @throws std::runtime_error  If a tape or a graph capture is already active on this thread,
+	/// a parameter is not floating point or bound twice.
+	explicit Tape(const std::vector<std::reference_wrapper<Tensor>>& params);
+
+	Tape(Tape&& other) noexcept;
+	~Tape();
+
+	/// Runs `body`, which updates `state` in place or by assignment, and records it as a single
+	/// operation. Instead of the operands of every operation in the body only a copy of `state`
+	/// is kept, the body runs again from it during `gradient`.
+	///
+	/// The body must be deterministic, every tracked value it reads or leaves behind has to be
+	/// part of `state`. Tensors and variables it refers to must outlive the call to `gradient`.
+	/// Checkpoints nest.
+	/// @throws std::runtime_error  If the tape no longer records, or the body breaks the rules
+	/// above.
+	void checkpoint(const std::vector<std::reference_wrapper<Tensor>>& state,
+	                const std::function<void()>& body);
+
+	/// Stops recording and returns the gradient of the sum of `output` with respect to every
+	/// parameter, in order, with the shape of the parameter. Parameters `output` does not depend
+	/// on get zeros.
+	/// @throws std::runtime_error  If called a second time.
+	std::vector<Tensor> gradient(const Tensor& output);
+
+	/// Returns the number of recorded operations, a checkpoint counts as one.
+	size_t getNumNodes() const;
+
+	/// Returns the bytes of tensor data the tape holds on its own: checkpointed state, operands
+	/// that were overwritten or destroyed after an operation read them.
+	size_t getSavedBytes() const;
+
+private:
+	Backend m_backend = Backend::CPU;
+	std::vector<Tensor::Shape> m_shapes;
+	std::unique_ptr<autograd::Recorder> m_recorder;
+};
+
+#endif  // TENSOR_TAPE_H
@@ -58,12 +58,22 @@ public:
 	/// Returns the backend enum.
 	inline Backend getBackend() const { return m_parent.getBackend(); }
 
+	/// Returns the element type of the parent.
+	inline DType getDType() const { return m_parent.getDType(); }
+
 	/// Deep copies the viewed region into a new tensor.
 	Tensor copy() const;
 
 	/// Copies the viewd elements into a flat vector
 	std::vector<float> toVector() const;
 
+	/// Copies the viewed elements into a flat vector of their own element type, see
+	/// `Tensor::toVector<T>`.
+	template <typename T>
+	std::vector<T> toVector() const {
+		return copy().toVector<T>();
+	}
+
 	/// Elementwise addition with a tensor or view. Copies then computes.
 	Tensor operator+(const Tensor::View& rhs) const;
 
@@ -103,8 +113,52 @@ public:
 	/// Reduces dimensions [dim, rank) by taking the product. Result shape is shape[0:dim].
 	Tensor prod(size_t dim = 0) const;
 
-	/// L2 norm (scalar tensor equal to `sqrt(sum(x^2))`).
-	Tensor norm() const;
+	/// Reduces dimensions [dim, rank) by taking the L2 norm, `sqrt(sum(x^2))`.
+	/// Result shape is shape[0:dim], the default is a scalar over the whole view.
+	Tensor norm(size_t dim = 0) const;
+
+	/// Softmax over each block of dimensions [dim, rank), see `Tensor::softmax`. Reads the view
+	/// in place, strided views are not copied first.
+	Tensor softmax(size_t dim = 0) const;
+
+	/// Log softmax over each block of dimensions [dim, rank), see `Tensor::logSoftmax`.
+	Tensor logSoftmax(size_t dim = 0) const;
+
+	/// `log(sum(exp(x)))` of each block of dimensions [dim, rank), see `Tensor::logSumExp`.
+	Tensor logSumExp(size_t dim = 0) const;
+
+	/// Each block of dimensions [dim, rank) sorted, see `Tensor::sort`. Reads the view in place.
+	Tensor sort(size_t dim = 0, bool descending = false) const;
+
+	/// Indices that sort each block, see `Tensor::argsort`.
+	Tensor argsort(size_t dim = 0, bool descending = false) const;
+
+	/// Each block partitioned around its `kth` element, see `Tensor::partition`.
+	Tensor partition(size_t kth, size_t dim = 0) const;
+
+	/// Scan of `op` along dimension `dim`, see `Tensor::scan`. Reads the view in place.
+	Tensor scan(ScanOp op, size_t dim, bool exclusive = false) const;
+
+	/// Elements picked along `dim` by `index`, see `Tensor::gather`. Reads the view in place.
+	Tensor gather(size_t dim, const Tensor::View& index) const;
+
+	/// Slices along `dim` picked by the 1D `index`, see `Tensor::indexSelect`.
+	Tensor indexSelect(size_t dim, const Tensor::View& index) const;
+
+	/// Writes `src` to the referenced elements picked by `index`, see `Tensor::scatter`.
+	void scatter(size_t dim, const Tensor::View& index, const Tensor::View& src);
+
+	/// Adds `src` to the referenced elements picked by `index`, see `Tensor::scatterAdd`.
+	void scatterAdd(size_t dim, const Tensor::View& index, const Tensor::View& src);
+
+	/// Applies `op` elementwise into a new tensor, see `Tensor::map`. Reads the view in place.
+	Tensor map(UnaryOp op, float alpha = 0.0f, float beta = 0.0f) const;
+
+	/// Applies `op` elementwise to the referenced elements in place, see `Tensor::mapInplace`.
+	void mapInplace(UnaryOp op, float alpha = 0.0f, float beta = 0.0f);
+
+	/// Writes `op` of this view into `out`, see `Tensor::mapInto`.
+	void mapInto(const Tensor::View& out, UnaryOp op, float alpha = 0.0f, float beta = 0.0f) const;
 
 	/// Copies data from a tensor into the referenced position of this view.
 	Tensor::View operator=(const Tensor& rhs);
@@ -130,6 +184,45 @@ public:
 	/// Strided subsampling view. Views every `strides[i]`-th element along dim `i`.
 	Tensor::View subsample(std::vector<size_t> strides) const;
 
+	/// View of the same elements as `shape`, see `Tensor::reshape`. Throws if the strides of this
+	/// view can not express `shape`, such as merging dims of a transposed view, in that case
+	/// `contiguous()` copies first.
+	Tensor::View reshape(const Tensor::Shape& shape) const;
+
+	/// View with dim `d` taken from dim `dims[d]`, see `Tensor::permute`.
+	Tensor::View permute(const std::vector<size_t>& dims) const;
+
+	/// View with dims `dim0` and `dim1` swapped, see `Tensor::transpose`.
+	Tensor::View transpose(size_t dim0, size_t dim1) const;
+
+	/// View without the size 1 dims, see `Tensor::squeeze`.
+	Tensor::View squeeze() const;
+
+	/// View without the size 1 dim `dim`, see `Tensor::squeeze`.
+	Tensor::View squeeze(size_t dim) const;
+
+	/// View of `ranges[d]` along each dim `d`, see `Tensor::slice`.
+	Tensor::View slice(const std::vector<Slice>& ranges) const;
+
+	/// View of `range` along dim `dim`, see `Tensor::slice`.
+	Tensor::View slice(size_t dim, const Slice& range) const;
+
+	/// View of the windows of `size` along dim `dim`, see `Tensor::unfold`.
+	Tensor::View unfold(size_t dim, size_t size, size_t step) const;
+
+	/// View with a size 1 dim inserted before dim `dim`, see `Tensor::unsqueeze`.
+	Tensor::View unsqueeze(size_t dim) const;
+
+	/// View repeating the size 1 dims to `shape`, see `Tensor::expand`.
+	Tensor::View expand(const Tensor::Shape& shape) const;
+
+	/// True if the view reads a dense row-major block of its parent, size 1 dims ignored.
+	bool isContiguous() const;
+
+	/// The viewed elements as a new row-major tensor. A view can not own storage, so this copies,
+	/// but a contiguous view copies as one flat block, see `isContiguous`.
+	Tensor contiguous() const;
+
 	/// Returns true if shape and every element matches `rhs`.
 	/// @note Exact match, which is unstable for floats. Consider using `.isClose()`
 	bool isEqual(const Tensor& rhs) const;
@@ -146,25 +239,25 @@ public:
 	/// @note Exact match, which is unstable for floats. Consider using `.isClose()`
 	bool isNotEqual(const Tensor::View& rhs) const;
 
-	/// Elementwise equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise equal. Returns a Bool tensor.
 	Tensor operator==(const Tensor::View& rhs) const;
 
-	/// Elementwise not equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise not equal. Returns a Bool tensor.
 	Tensor operator!=(const Tensor::View& rhs) const;
 
-	/// Elementwise less than. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise less than. Returns a Bool tensor.
 	Tensor operator<(const Tensor::View& rhs) const;
 
-	/// Elementwise less or equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise less or equal. Returns a Bool tensor.
 	Tensor operator<=(const Tensor::View& rhs) const;
 
-	/// Elementwise greater than. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise greater than. Returns a Bool tensor.
 	Tensor operator>(const Tensor::View& rhs) const;
 
-	/// Elementwise greater or equal. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise greater or equal. Returns a Bool tensor.
 	Tensor operator>=(const Tensor::View& rhs) const;
 
-	/// Elementwise closeness check within `tolerance`. Returns a tensor of 0.0 / 1.0.
+	/// Elementwise closeness check within `tolerance`. Returns a Bool tensor.
 	/// @param tolerance Maximum absolute difference (default: 1e-5).
 	Tensor isClose(const Tensor::View& rhs, float tolerance = 1e-5f) const;
 
@@ -172,6 +265,10 @@ private:
 	// Differentiates the broadcast constructor from public constructors.
 	struct BroadcastTag {};
 
+	// Shared by scatter() and scatterAdd(), `what` names the caller in errors.
+	void scatter(size_t dim, const Tensor::View& index, const Tensor::View& src, bool accumulate,
+	             const char* what);
+
 	// Constructs a view with explicit stride and shape. Used by broadcast().
 	View(Tensor& parent, const std::vector<size_t>& stride, const Tensor::Shape& shape,
 	     BroadcastTag);
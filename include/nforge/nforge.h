@@ -2,7 +2,12 @@
 #define NFORGE_H
 
 #include "nforge/core/tensor.h"
+#include "nforge/core/tensor_graph.h"
 #include "nforge/core/tensor_shape.h"
+#include "nforge/core/tensor_sparse.h"
+#include "nforge/core/tensor_tape.h"
 #include "nforge/core/tensor_view.h"
+#include "nforge/profiling/memory_stats.h"
+#include "nforge/profiling/op_stats.h"
 
 #endif
\ No newline at end of file
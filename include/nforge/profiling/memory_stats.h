@@ -0,0 +1,68 @@
+#ifndef NFORGE_MEMORY_STATS_H
+#define NFORGE_MEMORY_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "nforge/core/tensor.h"
+
+namespace profiling {
+
+/// Tensor data held by one backend, summed over all threads.
+struct MemoryStats {
+	/// Bytes currently held by live tensors.
+	uint64_t liveBytes = 0;
+
+	/// Highest `liveBytes` since start or the last `resetPeakMemory`.
+	uint64_t peakBytes = 0;
+
+	/// Number of tensor buffers allocated since start.
+	uint64_t numAllocations = 0;
+};
+
+/// Returns the current counters of `backend`.
+MemoryStats getMemoryStats(Backend backend);
+
+/// Sets the peak of `backend` to its current live bytes.
+void resetPeakMemory(Backend backend);
+
+/// Allocations that would bring the live bytes of `backend` above `bytes` throw
+/// std::runtime_error before any memory is allocated. 0 removes the limit, the default.
+void setMemoryLimit(Backend backend, uint64_t bytes);
+
+/// Returns the limit of `backend`, 0 if there is none.
+uint64_t getMemoryLimit(Backend backend);
+
+/// Measures the memory high-water mark of `backend` while in scope.
+///
+/// Every scope keeps its own mark, so scopes may nest, overlap and end in any order, on any
+/// thread, and the global peak is left alone. Like the global stats the mark counts the
+/// allocations of all threads.
+class PeakMemoryScope {
+public:
+	explicit PeakMemoryScope(Backend backend = Backend::CPU);
+	~PeakMemoryScope();
+
+	PeakMemoryScope(const PeakMemoryScope&) = delete;
+	PeakMemoryScope& operator=(const PeakMemoryScope&) = delete;
+
+	/// Highest live bytes of the backend since construction.
+	uint64_t getPeakBytes() const;
+
+	/// `getPeakBytes` minus the live bytes at construction, the memory the scope added at most.
+	uint64_t getPeakIncrease() const;
+
+	/// Number of allocations since construction.
+	uint64_t getNumAllocations() const;
+
+private:
+	Backend m_backend;
+	uint64_t m_startLive;
+	uint64_t m_startAllocations;
+	/// Raised by every allocation while the scope is registered with its backend.
+	std::atomic<uint64_t> m_peakBytes;
+};
+
+}  // namespace profiling
+
+#endif  // NFORGE_MEMORY_STATS_H
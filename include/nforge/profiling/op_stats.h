@@ -0,0 +1,48 @@
+#ifndef NFORGE_OP_STATS_H
+#define NFORGE_OP_STATS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace profiling {
+
+/// Counters of one `Tensor::Impl` operation, summed over all threads.
+///
+/// `elements` counts the iteration space of the op: output elements for elementwise ops, input
+/// elements for reductions, multiply-adds for matmul and tensor elements for fills and copies.
+/// Allocations are attributed to the op that made them, frees to the op that made the freed
+/// allocation. Allocations made outside of any op, e.g. by Tensor constructors, are reported
+/// under "construct". `nanoseconds` is wall time and includes nested ops.
+struct OpStats {
+	uint64_t calls = 0;
+	uint64_t elements = 0;
+	uint64_t bytesAllocated = 0;
+	uint64_t bytesFreed = 0;
+	uint64_t nanoseconds = 0;
+};
+
+/// Op name to counters. Ops without any activity are left out.
+using OpStatsSnapshot = std::map<std::string, OpStats>;
+
+/// True if NForge was built with NFORGE_ENABLE_STATS. Otherwise nothing is ever recorded.
+bool isOpStatsAvailable();
+
+/// Enables or disables recording at runtime, enabled by default when available.
+void setOpStatsEnabled(bool enabled);
+
+/// True if ops are currently recorded.
+bool isOpStatsEnabled();
+
+/// Returns the current counters.
+OpStatsSnapshot getOpStats();
+
+/// Sets all counters to zero.
+void resetOpStats();
+
+/// Formats `stats` as a JSON object keyed by op name.
+std::string toJson(const OpStatsSnapshot& stats);
+
+}  // namespace profiling
+
+#endif  // NFORGE_OP_STATS_H
@@ -0,0 +1,33 @@
+#ifndef PHYSICS_BATCH_H
+#define PHYSICS_BATCH_H
+
+#include <vector>
+
+#include "nforge/nforge.h"
+
+// Helpers for batched scenarios. Every simulation is a lane: per lane parameters are {B} tensors
+// and per lane state is stored as {B, N} tensors, one row per lane.
+
+/// Builds a {B} tensor from host values, one per lane.
+inline Tensor makeLaneTensor(const std::vector<float>& values) {
+	Tensor lanes({values.size()}, 0.0f);
+	for (size_t i = 0; i < values.size(); i++) {
+		lanes[i] = Tensor(values[i]);
+	}
+	return lanes;
+}
+
+/// {B} view of column `col` of the {B, N} tensor `state`.
+inline Tensor::View laneColumn(Tensor& state, size_t col) {
+	Tensor::Shape shape = state.getShape();
+	TensorLayout layout(Tensor::Shape({shape.getDim(0)}), {shape.getDim(1)}, col);
+	return Tensor::View(state, {}, layout);
+}
+
+/// {B, 1} view of the {B} tensor `lanes`, broadcasts one value per lane over a row of state.
+inline Tensor::View laneBroadcast(Tensor& lanes) {
+	TensorLayout layout(Tensor::Shape({lanes.getNumElements(), 1}), {1, 0}, 0);
+	return Tensor::View(lanes, {}, layout);
+}
+
+#endif  // PHYSICS_BATCH_H
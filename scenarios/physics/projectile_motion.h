@@ -1,6 +1,7 @@
 #include <cmath>
 #include <iostream>
 
+#include "batch.h"
 #include "nforge/nforge.h"
 
 constexpr double PI = 3.14159265358979323846;
@@ -40,3 +41,130 @@ ProjectileMotionResults simulateProjectileMotion(ProjectileMotionParams params)
 	ProjectileMotionResults res(s, v, t);
 	return res;
 }
+
+/// Same simulation as `simulateProjectileMotion`, with the step recorded once and replayed.
+ProjectileMotionResults simulateProjectileMotionCaptured(ProjectileMotionParams params) {
+	Tensor s({2}, 0.0f), v({2}, 0.0f), a({2}, 0.0f);
+
+	float angleRad = params.angle * PI / 180.0;
+	v[0] = params.initialSpeed * std::cos(angleRad);
+	v[1] = params.initialSpeed * std::sin(angleRad);
+
+	a[1] = -params.grav;
+
+	Tensor::Graph step = Tensor::Graph::capture({s, v}, [&]() {
+		v += a * params.dt;
+		s += v * params.dt;
+	});
+
+	float t = 0;
+	while (s.toVector()[1] >= 0) {
+		step.replay();
+		t += params.dt;
+	}
+
+	ProjectileMotionResults res(s, v, t);
+	return res;
+}
+
+/// Per lane parameters of `simulateProjectileMotionBatch`, {B} tensors.
+/// All lanes advance in lockstep with the shared `dt`.
+struct ProjectileMotionBatchParams {
+	float dt = 0.001;
+	Tensor grav;
+	Tensor initialSpeed;
+	Tensor angle;  // degrees
+
+	/// `batch` lanes with the defaults of `ProjectileMotionParams`.
+	ProjectileMotionBatchParams(size_t batch)
+	    : grav({batch}, 9.81f), initialSpeed({batch}, 10.0f), angle({batch}, 10.0f) {}
+};
+
+struct ProjectileMotionBatchResults {
+	Tensor position;  // {B, 2}
+	Tensor speed;     // {B, 2}
+	Tensor t;         // {B}
+};
+
+/// Runs B independent `simulateProjectileMotion`s as one tensor program.
+/// A lane stops once it hits the ground, its state is frozen by masking the updates.
+ProjectileMotionBatchResults simulateProjectileMotionBatch(ProjectileMotionBatchParams params) {
+	size_t batch = params.angle.getNumElements();
+
+	std::vector<float> speed = params.initialSpeed.toVector();
+	std::vector<float> angle = params.angle.toVector();
+	std::vector<float> vx(batch), vy(batch);
+	for (size_t i = 0; i < batch; i++) {
+		float angleRad = angle[i] * PI / 180.0;
+		vx[i] = speed[i] * std::cos(angleRad);
+		vy[i] = speed[i] * std::sin(angleRad);
+	}
+
+	Tensor s({batch, 2}, 0.0f), v({batch, 2}, 0.0f), a({batch, 2}, 0.0f);
+	laneColumn(v, 0) = makeLaneTensor(vx);
+	laneColumn(v, 1) = makeLaneTensor(vy);
+
+	laneColumn(a, 1) = 0.0f - params.grav;
+
+	Tensor t({batch}, 0.0f);
+
+	// 1 while the lane is in the air
+	Tensor active = laneColumn(s, 1) >= Tensor(0.0f);
+	Tensor::View mask = laneBroadcast(active);
+
+	while (active.any().toVector()[0]) {
+		v += a * params.dt * mask;
+		s += v * params.dt * mask;
+		t += active * params.dt;
+
+		active = laneColumn(s, 1) >= Tensor(0.0f);
+	}
+
+	return ProjectileMotionBatchResults{s, v, t};
+}
+
+/// Landing distance of `simulateProjectileMotion` and its gradient with respect to the launch
+/// parameters, e.g. to fit the angle that reaches a target.
+struct ProjectileMotionGradient {
+	float distance;  // x where the path crosses y = 0, interpolated within the last step
+	float dAngle;    // per degree
+	float dInitialSpeed;
+	float dGrav;
+	size_t savedBytes;  // memory the tape held for the backward pass
+};
+
+/// Same simulation as `simulateProjectileMotion`, recorded on a tape. Every `stepsPerCheckpoint`
+/// steps form one checkpoint, so the tape only keeps the state between them and the memory of
+/// the backward pass does not grow with every step.
+ProjectileMotionGradient simulateProjectileMotionGradient(ProjectileMotionParams params,
+                                                          size_t stepsPerCheckpoint = 64) {
+	Tensor angle(params.angle), initialSpeed(params.initialSpeed), grav(params.grav);
+	Tensor::Tape tape({angle, initialSpeed, grav});
+
+	Tensor s({2}, 0.0f), v({2}, 0.0f), a({2}, 0.0f);
+
+	Tensor angleRad = angle * (float)(PI / 180.0);
+	v[0] = initialSpeed * angleRad.cos();
+	v[1] = initialSpeed * angleRad.sin();
+
+	a[1] = 0.0f - grav;
+
+	bool inAir = true;
+	while (inAir) {
+		tape.checkpoint({s, v, a}, [&]() {
+			for (size_t i = 0; i < stepsPerCheckpoint && s.toVector()[1] >= 0; i++) {
+				v += a * params.dt;
+				s += v * params.dt;
+			}
+		});
+		inAir = s.toVector()[1] >= 0;
+	}
+
+	// back along the last step to y = 0
+	Tensor distance = s[0] - s[1] * v[0] / v[1];
+	size_t savedBytes = tape.getSavedBytes();
+
+	std::vector<Tensor> grads = tape.gradient(distance);
+	return ProjectileMotionGradient{distance.toVector()[0], grads[0].toVector()[0],
+	                                grads[1].toVector()[0], grads[2].toVector()[0], savedBytes};
+}
@@ -1,6 +1,7 @@
 #include <cmath>
 #include <iostream>
 
+#include "batch.h"
 #include "nforge/nforge.h"
 
 struct SphereSlideParams {
@@ -55,3 +56,119 @@ SphereSlideResults simulateSphereSlide(SphereSlideParams params) {
 	SphereSlideResults res{s, v, t};
 	return res;
 }
+
+/// Same simulation as `simulateSphereSlide`, with the loop body recorded once and replayed.
+/// The body is split in two graphs around the host side exit check.
+SphereSlideResults simulateSphereSlideCaptured(SphereSlideParams params) {
+	Tensor s({2}, 0);
+	s[1] = params.radius;
+
+	Tensor v({2}, 0);
+	v[0] = params.initalXSpeed;
+
+	Tensor G({2}, 0);
+	G[1] = -params.mass * params.grav;
+
+	Tensor a = G / params.mass;
+
+	Tensor position({2}, 0);
+	Tensor dist(0.0f);
+
+	Tensor::Graph predict = Tensor::Graph::capture({s, v, position, dist}, [&]() {
+		// p = s + v * dt + a/2 * dt^2
+		position = s + v * params.dt + a * 0.5 * params.dt * params.dt;
+		dist = position.norm();
+	});
+
+	Tensor::Graph project = Tensor::Graph::capture({s, v, position, dist}, [&]() {
+		// Position mapped to sphere
+		position *= params.radius / dist;
+
+		v = (position - s) * (1 / params.dt);
+		s = position;
+	});
+
+	float t = 0;
+
+	while (true) {
+		predict.replay();
+		if (dist.toVector()[0] >= params.radius) {  // does not fall into the sphere
+			break;
+		}
+
+		project.replay();
+
+		t += params.dt;
+	}
+
+	SphereSlideResults res{s, v, t};
+	return res;
+}
+
+/// Per lane parameters of `simulateSphereSlideBatch`, {B} tensors.
+/// All lanes advance in lockstep with the shared `dt`.
+struct SphereSlideBatchParams {
+	float dt = 0.001;
+	Tensor grav;
+	Tensor mass;
+	Tensor radius;
+	Tensor initalXSpeed;
+
+	/// `batch` lanes with the defaults of `SphereSlideParams`.
+	SphereSlideBatchParams(size_t batch)
+	    : grav({batch}, 9.81f), mass({batch}, 1.0f), radius({batch}, 1.0f),
+	      initalXSpeed({batch}, 0.001f) {}
+};
+
+struct SphereSlideBatchResults {
+	Tensor position;  // {B, 2}
+	Tensor speed;     // {B, 2}
+	Tensor t;         // {B}
+};
+
+/// Runs B independent `simulateSphereSlide`s as one tensor program.
+/// A lane stops once it leaves the sphere, its state is frozen by masking the updates.
+SphereSlideBatchResults simulateSphereSlideBatch(SphereSlideBatchParams params) {
+	size_t batch = params.radius.getNumElements();
+
+	Tensor s({batch, 2}, 0.0f);
+	laneColumn(s, 1) = params.radius;
+
+	Tensor v({batch, 2}, 0.0f);
+	laneColumn(v, 0) = params.initalXSpeed;
+
+	Tensor G({batch, 2}, 0.0f);
+	laneColumn(G, 1) = 0.0f - params.mass * params.grav;
+
+	Tensor a = G / laneBroadcast(params.mass);
+
+	Tensor t({batch}, 0.0f);
+
+	// 1 while the lane is on the sphere
+	Tensor active({batch}, 1.0f);
+	Tensor::View mask = laneBroadcast(active);
+
+	while (true) {
+		// p = s + v * dt + a/2 * dt^2
+		Tensor position = s + v * params.dt + a * 0.5 * params.dt * params.dt;
+
+		Tensor dist = position.norm(1);
+		active *= dist < params.radius;  // does not fall into the sphere
+		if (!active.any().toVector()[0]) {
+			break;
+		}
+
+		// Position mapped to sphere
+		Tensor scale = params.radius / dist;
+		position *= laneBroadcast(scale);
+
+		// keep the state of stopped lanes
+		Tensor inactive = 1.0f - active;
+		v = (position - s) * (1 / params.dt) * mask + v * laneBroadcast(inactive);
+		s = position * mask + s * laneBroadcast(inactive);
+
+		t += active * params.dt;
+	}
+
+	return SphereSlideBatchResults{s, v, t};
+}
@@ -0,0 +1,948 @@
+#include "autograd/recorder.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "backend/tensor_impl.h"
+#include "graph/program.h"
+
+namespace autograd {
+
+using graph::OpType;
+
+/// Released gradient buffers kept for reuse, older ones are freed.
+constexpr size_t MAX_POOLED = 16;
+
+/// Contiguous layout from offset 0 with the shape of `layout`.
+static TensorLayout dense(const TensorLayout& layout) {
+	TensorLayout result(layout.shape, {}, 0, layout.rank);
+	size_t stride = 1;
+	for (size_t d = layout.rank; d-- > 0;) {
+		result.strides[d] = stride;
+		stride *= layout.shape[d];
+	}
+	return result;
+}
+
+/// Layout with the shape of `layout` that reads the element at offset 0 everywhere.
+static TensorLayout broadcastScalar(const TensorLayout& layout) {
+	return TensorLayout(layout.shape, {}, 0, layout.rank);
+}
+
+static size_t getNumElements(const TensorLayout& layout) {
+	size_t count = 1;
+	for (size_t d = 0; d < layout.rank; d++) count *= layout.shape[d];
+	return count;
+}
+
+static size_t getBytes(const Tensor::Impl* impl) {
+	return impl->getNumElements() * getDTypeSize(impl->getDType());
+}
+
+/// True if ops of `type` have a backward rule. Comparisons are piecewise constant, their
+/// results do not depend on the operands.
+static bool isDifferentiable(OpType type) {
+	switch (type) {
+		case OpType::Add:
+		case OpType::Sub:
+		case OpType::Mul:
+		case OpType::Div:
+		case OpType::IAdd:
+		case OpType::ISub:
+		case OpType::IMul:
+		case OpType::IDiv:
+		case OpType::Set:
+		case OpType::MaskedFill:
+		case OpType::Sum:
+		case OpType::Min:
+		case OpType::Max:
+		case OpType::Norm:
+		case OpType::Matmul:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/// True if the backward rule of `op` reads the input of the map, else it reads the output.
+static bool readsInput(UnaryOp op) {
+	switch (op) {
+		case UnaryOp::Exp:
+		case UnaryOp::Sqrt:
+		case UnaryOp::Rsqrt:
+		case UnaryOp::Tanh:
+		case UnaryOp::Sigmoid:
+			return false;
+		default:
+			return true;
+	}
+}
+
+Recorder::Recorder(const std::vector<const Tensor::Impl*>& params, Backend backend,
+                   Recorder* outer)
+    : m_backend(backend), m_outer(outer) {
+	for (const Tensor::Impl* param : params) {
+		m_params.push_back(define(param, param->getShape().toContiguousLayout()));
+	}
+}
+
+Recorder::~Recorder() = default;
+
+void Recorder::ensureUntracked(const Tensor::Impl* impl, const char* what) {
+	Recorder* recorder = active();
+	if (recorder != nullptr && recorder->read(impl) != NO_VALUE) {
+		throw std::runtime_error(std::string(what) + "() can not be differentiated on a tape");
+	}
+}
+
+void Recorder::ensureUntrackedWrite(const Tensor::Impl* impl, const char* what) {
+	ensureUntracked(impl, what);
+	if (Recorder* recorder = active()) {
+		recorder->prepareWrite(impl);
+	}
+}
+
+void Recorder::recordBinary(OpType type, const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+                            const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+                            const Tensor::Impl* out, const TensorLayout& outLayout) {
+	size_t lhsValue = read(lhs);
+	size_t rhsValue = read(rhs);
+	if ((lhsValue == NO_VALUE && rhsValue == NO_VALUE) || !isDifferentiable(type)) {
+		return;
+	}
+
+	Node node;
+	node.kind = NodeKind::Binary;
+	node.type = type;
+	node.lhs = lhsValue;
+	node.rhs = rhsValue;
+	node.lhsLayout = lhsLayout;
+	node.rhsLayout = rhsLayout;
+	node.outLayout = outLayout;
+
+	// a product reads the other operand, a quotient the divisor and, for the divisor, both
+	if (type == OpType::Mul || type == OpType::Div) {
+		if (rhsValue != NO_VALUE) {
+			node.savedLhs = save(lhs);
+		}
+		if (lhsValue != NO_VALUE || type == OpType::Div) {
+			node.savedRhs = save(rhs);
+		}
+	}
+
+	node.out = define(out, outLayout);
+	m_nodes.push_back(node);
+}
+
+void Recorder::recordInplace(OpType type, const Tensor::Impl* target,
+                             const TensorLayout& targetLayout, const Tensor::Impl* rhs,
+                             const TensorLayout& rhsLayout) {
+	// integral data has no gradient, writing it cuts the dependence on the parameters
+	if (!isFloatingPoint(target->getDType())) {
+		recordOpaqueWrite(target);
+		return;
+	}
+
+	size_t targetValue = read(target);
+	size_t rhsValue = type == OpType::MaskedFill ? NO_VALUE : read(rhs);
+	bool recorded = targetValue != NO_VALUE || rhsValue != NO_VALUE;
+
+	Node node;
+	node.kind = NodeKind::Inplace;
+	node.type = type;
+	node.lhs = targetValue;
+	node.rhs = rhsValue;
+	node.lhsLayout = targetLayout;
+	node.rhsLayout = rhsLayout;
+
+	if (recorded && (type == OpType::IMul || type == OpType::IDiv)) {
+		if (rhsValue != NO_VALUE) {
+			node.savedLhs = save(target);
+		}
+		if (targetValue != NO_VALUE || type == OpType::IDiv) {
+			node.savedRhs = save(rhs);
+		}
+	}
+	if (recorded && type == OpType::MaskedFill) {
+		node.savedRhs = save(rhs);
+	}
+
+	// saves of the target, including the one above, keep the data from before the write
+	prepareWrite(target);
+
+	if (!recorded) {
+		return;
+	}
+
+	TensorLayout layout =
+	    targetValue != NO_VALUE ? m_values[targetValue] : target->getShape().toContiguousLayout();
+	node.out = define(target, layout);
+	m_nodes.push_back(node);
+}
+
+void Recorder::recordReduction(OpType type, const Tensor::Impl* in, const TensorLayout& layout,
+                               const TensorLayout& blockLayout, const Tensor::Impl* out,
+                               const TensorLayout& outLayout) {
+	size_t value = read(in);
+	if (value == NO_VALUE) {
+		return;
+	}
+	if (type == OpType::Prod) {
+		throw std::runtime_error("prod() can not be differentiated on a tape");
+	}
+	if (!isDifferentiable(type)) {
+		return;
+	}
+
+	Node node;
+	node.kind = NodeKind::Reduction;
+	node.type = type;
+	node.lhs = value;
+	node.lhsLayout = layout;
+	node.blockLayout = blockLayout;
+	node.outLayout = outLayout;
+
+	if (type != OpType::Sum) {
+		node.savedLhs = save(in);
+		node.savedOut = save(out);
+	}
+
+	node.out = define(out, outLayout);
+	m_nodes.push_back(node);
+}
+
+void Recorder::recordMatmul(const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+                            const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+                            const Tensor::Impl* out, const TensorLayout& outLayout, size_t batch,
+                            size_t m, size_t k, size_t p) {
+	size_t lhsValue = read(lhs);
+	size_t rhsValue = read(rhs);
+	if (lhsValue == NO_VALUE && rhsValue == NO_VALUE) {
+		return;
+	}
+
+	Node node;
+	node.kind = NodeKind::Matmul;
+	node.type = OpType::Matmul;
+	node.lhs = lhsValue;
+	node.rhs = rhsValue;
+	node.lhsLayout = lhsLayout;
+	node.rhsLayout = rhsLayout;
+	node.outLayout = outLayout;
+	node.batch = batch;
+	node.m = m;
+	node.k = k;
+	node.p = p;
+
+	if (rhsValue != NO_VALUE) {
+		node.savedLhs = save(lhs);
+	}
+	if (lhsValue != NO_VALUE) {
+		node.savedRhs = save(rhs);
+	}
+
+	node.out = define(out, outLayout);
+	m_nodes.push_back(node);
+}
+
+void Recorder::recordMap(UnaryOp op, float alpha, float beta, const Tensor::Impl* in,
+                         const TensorLayout& layout, const Tensor::Impl* out) {
+	size_t value = read(in);
+	if (value == NO_VALUE) {
+		return;
+	}
+
+	Node node;
+	node.kind = NodeKind::Map;
+	node.unary = op;
+	node.lhs = value;
+	node.lhsLayout = layout;
+	node.alpha = alpha;
+	node.beta = beta;
+
+	if (readsInput(op)) {
+		node.savedLhs = save(in);
+	} else {
+		node.savedOut = save(out);
+	}
+
+	node.out = define(out, dense(layout));
+	m_nodes.push_back(node);
+}
+
+void Recorder::recordCopy(const Tensor::Impl* src, const Tensor::Impl* copy) {
+	// values never change, so the copy shares the value of its source
+	size_t value = read(src);
+	if (value != NO_VALUE) {
+		m_valueOf[copy] = value;
+	}
+}
+
+void Recorder::recordOpaqueWrite(const Tensor::Impl* impl) {
+	prepareWrite(impl);
+	m_valueOf.erase(impl);
+}
+
+void Recorder::release(std::unique_ptr<Tensor::Impl>& impl) {
+	const Tensor::Impl* ptr = impl.get();
+	if (ptr == nullptr) {
+		return;
+	}
+
+	m_valueOf.erase(ptr);
+
+	// an enclosing recorder outlives this one, so it takes ownership first
+	if (m_outer != nullptr) {
+		m_outer->release(impl);
+	}
+	detach(ptr, &impl);
+}
+
+void Recorder::checkpoint(const std::vector<Tensor*>& state, const std::function<void()>& body) {
+	Segment segment;
+	segment.state = state;
+	segment.body = body;
+
+	std::vector<const Tensor::Impl*> params;
+	for (Tensor* tensor : state) {
+		const Tensor::Impl* impl = tensor->m_impl.get();
+		size_t value = read(impl);
+		segment.inputs.push_back(value);
+		if (value != NO_VALUE) {
+			params.push_back(impl);
+		}
+	}
+
+	bool recorded = !params.empty();
+	if (recorded) {
+		for (Tensor* tensor : state) {
+			segment.initial.push_back(tensor->m_impl->clone());
+			m_savedBytes += getBytes(segment.initial.back().get());
+		}
+	}
+
+	// the segment is recorded in full once to find its outputs, then only its state is kept
+	Recorder inner(params, m_backend, this);
+	active() = &inner;
+	try {
+		body();
+	} catch (...) {
+		active() = this;
+		throw;
+	}
+	active() = this;
+
+	for (Tensor* tensor : state) {
+		const Tensor::Impl* impl = tensor->m_impl.get();
+		auto it = inner.m_valueOf.find(impl);
+		if (it == inner.m_valueOf.end()) {
+			m_valueOf.erase(impl);
+			segment.outputs.push_back(NO_VALUE);
+		} else {
+			segment.outputs.push_back(define(impl, inner.m_values[it->second]));
+		}
+	}
+
+	for (const auto& [impl, value] : inner.m_valueOf) {
+		bool inState = false;
+		for (Tensor* tensor : state) inState = inState || tensor->m_impl.get() == impl;
+		if (!inState) {
+			throw std::runtime_error("checkpoint(): the body leaves a tensor that depends on a "
+			                         "parameter outside of its state");
+		}
+	}
+
+	if (!recorded) {
+		return;
+	}
+
+	Node node;
+	node.kind = NodeKind::Checkpoint;
+	node.segment = m_segments.size();
+	m_segments.push_back(std::move(segment));
+	m_nodes.push_back(node);
+}
+
+std::vector<std::unique_ptr<Tensor::Impl>> Recorder::backward(
+    const std::vector<const Tensor::Impl*>& outputs,
+    std::vector<std::unique_ptr<Tensor::Impl>> seeds) {
+	m_grads.clear();
+	m_grads.resize(m_values.size());
+
+	for (size_t i = 0; i < outputs.size(); i++) {
+		size_t value = read(outputs[i]);
+		if (value != NO_VALUE) {
+			accumulate(value, std::move(seeds[i]), m_values[value], m_values[value]);
+		}
+	}
+
+	for (size_t n = m_nodes.size(); n-- > 0;) {
+		const Node& node = m_nodes[n];
+		if (node.kind == NodeKind::Checkpoint) {
+			backwardCheckpoint(node);
+			continue;
+		}
+
+		std::unique_ptr<Tensor::Impl> grad = std::move(m_grads[node.out]);
+		if (grad == nullptr) {
+			continue;
+		}
+
+		switch (node.kind) {
+			case NodeKind::Binary:
+				backwardBinary(node, grad);
+				break;
+			case NodeKind::Inplace:
+				backwardInplace(node, grad);
+				break;
+			case NodeKind::Reduction:
+				backwardReduction(node, grad);
+				break;
+			case NodeKind::Matmul:
+				backwardMatmul(node, grad);
+				break;
+			case NodeKind::Map:
+				backwardMap(node, grad);
+				break;
+			case NodeKind::Checkpoint:
+				break;
+		}
+
+		if (grad != nullptr) {
+			recycle(std::move(grad));
+		}
+	}
+
+	std::vector<std::unique_ptr<Tensor::Impl>> result;
+	for (size_t param : m_params) {
+		std::unique_ptr<Tensor::Impl> grad = std::move(m_grads[param]);
+
+		// adopted buffers have the element count, but not always the shape, of the value
+		if (grad != nullptr && grad->getShape() != Tensor::Shape(m_values[param])) {
+			auto shaped = zeros(m_values[param]);
+			shaped->set(m_values[param], grad.get(), m_values[param]);
+			grad = std::move(shaped);
+		}
+		result.push_back(std::move(grad));
+	}
+
+	m_nodes.clear();
+	m_segments.clear();
+	m_saved.clear();
+	m_savedOf.clear();
+	m_grads.clear();
+	m_pool.clear();
+	m_savedBytes = 0;
+	return result;
+}
+
+bool Recorder::isTracked(const Tensor::Impl* impl) const {
+	return m_valueOf.count(impl) != 0 || (m_outer != nullptr && m_outer->isTracked(impl));
+}
+
+size_t Recorder::read(const Tensor::Impl* impl) const {
+	auto it = m_valueOf.find(impl);
+	if (it != m_valueOf.end()) {
+		return it->second;
+	}
+
+	if (m_outer != nullptr && m_outer->isTracked(impl)) {
+		throw std::runtime_error("checkpoint(): the body reads a tensor that depends on a "
+		                         "parameter but is not part of its state");
+	}
+	return NO_VALUE;
+}
+
+size_t Recorder::define(const Tensor::Impl* impl, const TensorLayout& layout) {
+	m_values.push_back(dense(layout));
+	m_valueOf[impl] = m_values.size() - 1;
+	return m_values.size() - 1;
+}
+
+size_t Recorder::save(const Tensor::Impl* impl) {
+	auto [it, inserted] = m_savedOf.try_emplace(impl, m_saved.size());
+	if (inserted) {
+		m_saved.push_back({impl, nullptr});
+	}
+	return it->second;
+}
+
+void Recorder::detach(const Tensor::Impl* impl, std::unique_ptr<Tensor::Impl>* owner) {
+	auto it = m_savedOf.find(impl);
+	if (it == m_savedOf.end()) {
+		return;
+	}
+
+	Saved& saved = m_saved[it->second];
+	if (owner != nullptr && *owner != nullptr) {
+		saved.owned = std::move(*owner);
+	} else {
+		saved.owned = impl->clone();
+	}
+	saved.impl = saved.owned.get();
+	m_savedBytes += getBytes(saved.impl);
+
+	m_savedOf.erase(it);
+}
+
+void Recorder::prepareWrite(const Tensor::Impl* impl) {
+	detach(impl, nullptr);
+	if (m_outer != nullptr) {
+		m_outer->prepareWrite(impl);
+	}
+}
+
+void Recorder::backwardBinary(const Node& node, std::unique_ptr<Tensor::Impl>& grad) {
+	const TensorLayout& layout = m_values[node.out];
+
+	switch (node.type) {
+		case OpType::Add:
+		case OpType::Sub:
+			if (node.rhs == NO_VALUE) {
+				accumulate(node.lhs, std::move(grad), layout, node.lhsLayout);
+				break;
+			}
+			accumulate(node.lhs, grad.get(), layout, node.lhsLayout);
+			if (node.type == OpType::Add) {
+				accumulate(node.rhs, std::move(grad), layout, node.rhsLayout);
+			} else {
+				accumulate(node.rhs, grad.get(), layout, node.rhsLayout, true);
+			}
+			break;
+
+		case OpType::Mul:
+			if (node.lhs != NO_VALUE) {
+				accumulate(node.lhs,
+				           grad->mul(layout, saved(node.savedRhs), node.rhsLayout, layout,
+				                     DType::Float32),
+				           layout, node.lhsLayout);
+			}
+			if (node.rhs != NO_VALUE) {
+				accumulate(node.rhs,
+				           grad->mul(layout, saved(node.savedLhs), node.lhsLayout, layout,
+				                     DType::Float32),
+				           layout, node.rhsLayout);
+			}
+			break;
+
+		case OpType::Div: {
+			const Tensor::Impl* rhs = saved(node.savedRhs);
+			if (node.lhs != NO_VALUE) {
+				accumulate(node.lhs, grad->div(layout, rhs, node.rhsLayout, layout, DType::Float32),
+				           layout, node.lhsLayout);
+			}
+			if (node.rhs != NO_VALUE) {
+				// d(l / r) / dr = -l / r^2
+				auto scaled = grad->mul(layout, saved(node.savedLhs), node.lhsLayout, layout,
+				                        DType::Float32);
+				scaled->idiv(layout, rhs, node.rhsLayout);
+				scaled->idiv(layout, rhs, node.rhsLayout);
+				accumulate(node.rhs, scaled.get(), layout, node.rhsLayout, true);
+				recycle(std::move(scaled));
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void Recorder::backwardInplace(const Node& node, std::unique_ptr<Tensor::Impl>& grad) {
+	// the gradient of the target is laid out like the target, so the region indexes both
+	const TensorLayout& region = node.lhsLayout;
+	TensorLayout regionDense = dense(region);
+
+	switch (node.type) {
+		case OpType::IAdd:
+		case OpType::ISub:
+			accumulate(node.rhs, grad.get(), region, node.rhsLayout, node.type == OpType::ISub);
+			break;
+
+		case OpType::IMul:
+			if (node.rhs != NO_VALUE) {
+				accumulate(node.rhs,
+				           grad->mul(region, saved(node.savedLhs), region, regionDense,
+				                     DType::Float32),
+				           regionDense, node.rhsLayout);
+			}
+			if (node.lhs != NO_VALUE) {
+				grad->imul(region, saved(node.savedRhs), node.rhsLayout);
+			}
+			break;
+
+		case OpType::IDiv: {
+			const Tensor::Impl* rhs = saved(node.savedRhs);
+			if (node.rhs != NO_VALUE) {
+				auto scaled = grad->mul(region, saved(node.savedLhs), region, regionDense,
+				                        DType::Float32);
+				scaled->idiv(regionDense, rhs, node.rhsLayout);
+				scaled->idiv(regionDense, rhs, node.rhsLayout);
+				accumulate(node.rhs, scaled.get(), regionDense, node.rhsLayout, true);
+				recycle(std::move(scaled));
+			}
+			if (node.lhs != NO_VALUE) {
+				grad->idiv(region, rhs, node.rhsLayout);
+			}
+			break;
+		}
+
+		case OpType::Set: {
+			accumulate(node.rhs, grad.get(), region, node.rhsLayout);
+			auto zero = scalar(0.0f);
+			grad->set(region, zero.get(), broadcastScalar(region));
+			break;
+		}
+
+		case OpType::MaskedFill:
+			grad->maskedFill(region, saved(node.savedRhs), node.rhsLayout, 0.0f);
+			break;
+
+		default:
+			break;
+	}
+
+	// the rest flows to the target as it was before the op, in the same buffer
+	if (node.lhs != NO_VALUE) {
+		accumulate(node.lhs, std::move(grad), m_values[node.out], m_values[node.out]);
+	}
+}
+
+void Recorder::backwardReduction(const Node& node, std::unique_ptr<Tensor::Impl>& grad) {
+	const TensorLayout& layout = node.lhsLayout;
+
+	// the gradient of every output element, repeated across its block
+	const TensorLayout& out = m_values[node.out];
+	TensorLayout spread(layout.shape, {}, 0, layout.rank);
+	for (size_t d = 0; d < out.rank; d++) spread.strides[d] = out.strides[d];
+
+	if (node.type == OpType::Sum) {
+		accumulate(node.lhs, grad.get(), spread, layout);
+		return;
+	}
+
+	const Tensor::Impl* in = saved(node.savedLhs);
+	const Tensor::Impl* result = saved(node.savedOut);
+	TensorLayout inDense = dense(layout);
+	std::unique_ptr<Tensor::Impl> contribution;
+
+	if (node.type == OpType::Norm) {
+		// d|x| / dx = x / |x|
+		contribution = grad->mul(spread, in, layout, inDense, DType::Float32);
+		contribution->idiv(inDense, result, spread);
+	} else {
+		// every element equal to the min or max gets the gradient of its block
+		auto hits = in->equal(layout, result, spread, inDense, in->getDType());
+		contribution = grad->mul(spread, hits.get(), inDense, inDense, DType::Float32);
+	}
+
+	accumulate(node.lhs, std::move(contribution), inDense, layout);
+}
+
+void Recorder::backwardMatmul(const Node& node, std::unique_ptr<Tensor::Impl>& grad) {
+	size_t batch = node.batch;
+
+	// operands as (batch, rows, cols), an operand without a batch of its own repeats with stride 0
+	auto batched = [batch](const TensorLayout& layout) {
+		size_t rank = layout.rank;
+		size_t batchStride = rank == 3 && layout.shape[0] > 1 ? layout.strides[0] : 0;
+		return TensorLayout({batch, layout.shape[rank - 2], layout.shape[rank - 1]},
+		                    {batchStride, layout.strides[rank - 2], layout.strides[rank - 1]},
+		                    layout.offset, 3);
+	};
+	auto transposed = [](TensorLayout layout) {
+		std::swap(layout.shape[1], layout.shape[2]);
+		std::swap(layout.strides[1], layout.strides[2]);
+		return layout;
+	};
+
+	TensorLayout lhs = batched(node.lhsLayout);
+	TensorLayout rhs = batched(node.rhsLayout);
+	TensorLayout out = batched(m_values[node.out]);
+
+	if (node.lhs != NO_VALUE) {
+		// dL = G @ R^T
+		TensorLayout result = dense(TensorLayout({batch, node.m, node.k}, {}, 0, 3));
+		auto contribution = grad->matmul(out, saved(node.savedRhs), transposed(rhs), result,
+		                                 batch, node.m, node.p, node.k, DType::Float32);
+		accumulate(node.lhs, std::move(contribution), result, lhs);
+	}
+	if (node.rhs != NO_VALUE) {
+		// dR = L^T @ G
+		TensorLayout result = dense(TensorLayout({batch, node.k, node.p}, {}, 0, 3));
+		auto contribution = saved(node.savedLhs)->matmul(transposed(lhs), grad.get(), out, result,
+		                                                 batch, node.k, node.m, node.p,
+		                                                 DType::Float32);
+		accumulate(node.rhs, std::move(contribution), result, rhs);
+	}
+}
+
+void Recorder::backwardMap(const Node& node, std::unique_ptr<Tensor::Impl>& grad) {
+	const TensorLayout& layout = node.lhsLayout;
+	TensorLayout D = dense(layout);
+	TensorLayout single = broadcastScalar(layout);
+
+	const Tensor::Impl* in = node.savedLhs != NO_VALUE ? saved(node.savedLhs) : nullptr;
+	const Tensor::Impl* out = node.savedOut != NO_VALUE ? saved(node.savedOut) : nullptr;
+	DType dtype = in != nullptr ? in->getDType() : DType::Float32;
+	constexpr DType F32 = DType::Float32;
+
+	std::unique_ptr<Tensor::Impl> c;
+	bool negate = false;
+
+	switch (node.unary) {
+		case UnaryOp::Exp:
+			c = grad->mul(D, out, D, D, F32);
+			break;
+		case UnaryOp::Log:
+			c = grad->div(D, in, layout, D, F32);
+			break;
+		case UnaryOp::Sqrt:
+			// 1 / (2 sqrt(x))
+			c = grad->div(D, out, D, D, F32);
+			c->imul(D, scalar(0.5f).get(), single);
+			break;
+		case UnaryOp::Rsqrt:
+			// -rsqrt(x)^3 / 2
+			c = grad->mul(D, out, D, D, F32);
+			c->imul(D, out, D);
+			c->imul(D, out, D);
+			c->imul(D, scalar(-0.5f).get(), single);
+			break;
+		case UnaryOp::Abs: {
+			auto zero = scalar(0.0f);
+			auto positive = in->greater(layout, zero.get(), single, D, dtype);
+			auto negative = in->less(layout, zero.get(), single, D, dtype);
+			c = grad->mul(D, positive.get(), D, D, F32);
+			auto flipped = grad->mul(D, negative.get(), D, D, F32);
+			c->isub(D, flipped.get(), D);
+			break;
+		}
+		case UnaryOp::Tanh: {
+			// 1 - tanh(x)^2
+			auto square = out->mul(D, out, D, D, F32);
+			c = scalar(1.0f)->sub(single, square.get(), D, D, F32);
+			c->imul(D, grad.get(), D);
+			break;
+		}
+		case UnaryOp::Sigmoid:
+			// s (1 - s)
+			c = scalar(1.0f)->sub(single, out, D, D, F32);
+			c->imul(D, out, D);
+			c->imul(D, grad.get(), D);
+			break;
+		case UnaryOp::Sin:
+			c = in->map(layout, UnaryOp::Cos, 0.0f, 0.0f, F32);
+			c->imul(D, grad.get(), D);
+			break;
+		case UnaryOp::Cos:
+			c = in->map(layout, UnaryOp::Sin, 0.0f, 0.0f, F32);
+			c->imul(D, grad.get(), D);
+			negate = true;
+			break;
+		case UnaryOp::Pow:
+			// p x^(p - 1)
+			c = in->map(layout, UnaryOp::Pow, node.alpha - 1.0f, 0.0f, F32);
+			c->imul(D, grad.get(), D);
+			c->imul(D, scalar(node.alpha).get(), single);
+			break;
+		case UnaryOp::Clamp: {
+			// 1 inside [alpha, beta]
+			auto low = in->greaterEqual(layout, scalar(node.alpha).get(), single, D, dtype);
+			auto high = in->lessEqual(layout, scalar(node.beta).get(), single, D, dtype);
+			c = grad->mul(D, low.get(), D, D, F32);
+			c->imul(D, high.get(), D);
+			break;
+		}
+	}
+
+	if (negate) {
+		accumulate(node.lhs, c.get(), D, layout, true);
+		recycle(std::move(c));
+	} else {
+		accumulate(node.lhs, std::move(c), D, layout);
+	}
+}
+
+void Recorder::backwardCheckpoint(const Node& node) {
+	Segment& segment = m_segments[node.segment];
+
+	bool reached = false;
+	for (size_t value : segment.outputs) {
+		reached = reached || (value != NO_VALUE && m_grads[value] != nullptr);
+	}
+	if (!reached) {
+		return;
+	}
+
+	// run the body again from the state it started from, with the current data set aside
+	size_t count = segment.state.size();
+	std::vector<std::unique_ptr<Tensor::Impl>> current(count);
+	std::vector<const Tensor::Impl*> params;
+	for (size_t i = 0; i < count; i++) {
+		Tensor* tensor = segment.state[i];
+		current[i] = std::move(tensor->m_impl);
+		tensor->m_impl = std::move(segment.initial[i]);
+		if (segment.inputs[i] != NO_VALUE) {
+			params.push_back(tensor->m_impl.get());
+		}
+	}
+
+	auto restore = [&]() {
+		for (size_t i = 0; i < count; i++) segment.state[i]->m_impl = std::move(current[i]);
+	};
+
+	Recorder inner(params, m_backend);
+	std::vector<std::unique_ptr<Tensor::Impl>> grads;
+	active() = &inner;
+	try {
+		segment.body();
+		active() = nullptr;
+
+		std::vector<const Tensor::Impl*> outputs;
+		std::vector<std::unique_ptr<Tensor::Impl>> seeds;
+		for (size_t i = 0; i < count; i++) {
+			size_t value = segment.outputs[i];
+			if (value != NO_VALUE && m_grads[value] != nullptr) {
+				outputs.push_back(segment.state[i]->m_impl.get());
+				seeds.push_back(std::move(m_grads[value]));
+			}
+		}
+		grads = inner.backward(outputs, std::move(seeds));
+	} catch (...) {
+		active() = nullptr;
+		restore();
+		throw;
+	}
+	restore();
+
+	size_t param = 0;
+	for (size_t i = 0; i < count; i++) {
+		size_t value = segment.inputs[i];
+		if (value == NO_VALUE) {
+			continue;
+		}
+		if (grads[param] != nullptr) {
+			accumulate(value, std::move(grads[param]), m_values[value], m_values[value]);
+		}
+		param++;
+	}
+}
+
+void Recorder::accumulate(size_t value, const Tensor::Impl* grad, const TensorLayout& gradLayout,
+                          const TensorLayout& target, bool negate) {
+	if (value == NO_VALUE) {
+		return;
+	}
+
+	TensorLayout source = gradLayout;
+	TensorLayout destination = target;
+	std::unique_ptr<Tensor::Impl> reduced;
+
+	// dims the target broadcasts read one element many times, their gradients are summed
+	size_t rank = target.rank;
+	size_t kept = 0;
+	std::array<size_t, MAX_DIMS> order{};
+	for (size_t d = 0; d < rank; d++) {
+		if (target.strides[d] != 0 || target.shape[d] <= 1) order[kept++] = d;
+	}
+
+	if (kept < rank) {
+		TensorLayout permuted(source.shape, source.strides, source.offset, rank);
+		TensorLayout block({}, {}, 0, rank - kept);
+		TensorLayout sums({}, {}, 0, kept);
+		for (size_t d = 0, b = kept; d < rank; d++) {
+			bool summed = target.strides[d] == 0 && target.shape[d] > 1;
+			if (summed) {
+				order[b++] = d;
+			}
+		}
+		for (size_t i = 0; i < rank; i++) {
+			permuted.shape[i] = source.shape[order[i]];
+			permuted.strides[i] = source.strides[order[i]];
+			if (i < kept) {
+				sums.shape[i] = source.shape[order[i]];
+			} else {
+				block.shape[i - kept] = source.shape[order[i]];
+			}
+		}
+		sums = dense(sums);
+		block = dense(block);
+
+		reduced = grad->sum(permuted, block, sums);
+		grad = reduced.get();
+
+		// the sums read back in the original dim order, with the summed dims of size 1
+		source = TensorLayout(target.shape, {}, 0, rank);
+		for (size_t i = 0; i < kept; i++) source.strides[order[i]] = sums.strides[i];
+		for (size_t i = kept; i < rank; i++) {
+			source.shape[order[i]] = 1;
+			destination.shape[order[i]] = 1;
+		}
+	}
+
+	std::unique_ptr<Tensor::Impl>& buffer = m_grads[value];
+	if (buffer == nullptr) {
+		buffer = zeros(m_values[value]);
+	}
+
+	if (negate) {
+		buffer->isub(destination, grad, source);
+	} else {
+		buffer->iadd(destination, grad, source);
+	}
+
+	if (reduced != nullptr) {
+		recycle(std::move(reduced));
+	}
+}
+
+void Recorder::accumulate(size_t value, std::unique_ptr<Tensor::Impl> grad,
+                          const TensorLayout& gradLayout, const TensorLayout& target) {
+	if (value == NO_VALUE) {
+		recycle(std::move(grad));
+		return;
+	}
+
+	const TensorLayout& whole = m_values[value];
+	if (m_grads[value] == nullptr && gradLayout == whole && target == whole &&
+	    grad->getNumElements() == getNumElements(whole)) {
+		m_grads[value] = std::move(grad);
+		return;
+	}
+
+	accumulate(value, grad.get(), gradLayout, target);
+	recycle(std::move(grad));
+}
+
+std::unique_ptr<Tensor::Impl> Recorder::zeros(const TensorLayout& layout) {
+	Tensor::Shape shape(layout);
+	for (size_t i = m_pool.size(); i-- > 0;) {
+		if (m_pool[i]->getShape() == shape) {
+			std::unique_ptr<Tensor::Impl> buffer = std::move(m_pool[i]);
+			m_pool.erase(m_pool.begin() + i);
+			buffer->fillAll(0.0f);
+			return buffer;
+		}
+	}
+
+	Tensor tensor(shape, m_backend);
+	return std::move(tensor.m_impl);
+}
+
+std::unique_ptr<Tensor::Impl> Recorder::scalar(float value) const {
+	Tensor tensor(value, m_backend);
+	return std::move(tensor.m_impl);
+}
+
+void Recorder::recycle(std::unique_ptr<Tensor::Impl> grad) {
+	if (grad == nullptr || grad->getDType() != DType::Float32) {
+		return;
+	}
+	if (m_pool.size() == MAX_POOLED) {
+		m_pool.erase(m_pool.begin());
+	}
+	m_pool.push_back(std::move(grad));
+}
+
+}  // namespace autograd
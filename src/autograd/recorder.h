@@ -0,0 +1,232 @@
+#ifndef AUTOGRAD_RECORDER_H
+#define AUTOGRAD_RECORDER_H
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "nforge/core/tensor.h"
+#include "nforge/core/tensor_layout.h"
+
+namespace graph {
+enum class OpType : uint8_t;
+}
+
+namespace autograd {
+
+constexpr size_t NO_VALUE = std::numeric_limits<size_t>::max();
+
+/// Kinds of recorded operations, the op within a kind is `Node::type` or `Node::unary`.
+enum class NodeKind : uint8_t { Binary, Inplace, Reduction, Matmul, Map, Checkpoint };
+
+/// One recorded operation. Value ids index into the values of the `Recorder`, saved ids into
+/// the operands it keeps for the backward pass.
+struct Node {
+	NodeKind kind;
+	graph::OpType type;
+	UnaryOp unary = UnaryOp::Exp;
+
+	/// Value produced. In-place ops produce a new value of their target.
+	size_t out = NO_VALUE;
+	/// Value read as lhs, or the target before an in-place op.
+	size_t lhs = NO_VALUE;
+	size_t rhs = NO_VALUE;
+
+	size_t savedLhs = NO_VALUE;
+	size_t savedRhs = NO_VALUE;
+	size_t savedOut = NO_VALUE;
+
+	/// Region written by an in-place op is `lhsLayout`.
+	TensorLayout outLayout;
+	TensorLayout lhsLayout;
+	TensorLayout rhsLayout;
+	TensorLayout blockLayout;
+
+	size_t batch = 0;
+	size_t m = 0;
+	size_t k = 0;
+	size_t p = 0;
+
+	float alpha = 0.0f;
+	float beta = 0.0f;
+
+	/// Index into the checkpointed segments.
+	size_t segment = NO_VALUE;
+};
+
+/// Records differentiable Tensor operations while a `Tensor::Tape` is active, and runs them
+/// backwards.
+///
+/// Data is tracked per `Tensor::Impl` like in `graph::Recorder`. An impl either holds a value
+/// that depends on a parameter, or it is untracked and read as a constant. Every write creates a
+/// new value, so values never change once recorded. Operations without tracked inputs are not
+/// recorded and their outputs stay untracked.
+///
+/// Operands a backward rule reads are saved by reference. Before a saved impl is written in
+/// place it is copied, and when it is released the recorder takes ownership of it, so data is
+/// only duplicated when it would otherwise be lost.
+///
+/// Hooks that write in place must be called before the operation executes, everything else after.
+class Recorder {
+public:
+	/// `params[i]` are the values gradients are taken with respect to, on `backend`.
+	/// @param outer  Recorder of an enclosing tape while a checkpointed segment runs, reads of
+	/// values it tracks that were not passed as `params` throw.
+	Recorder(const std::vector<const Tensor::Impl*>& params, Backend backend,
+	         Recorder* outer = nullptr);
+	~Recorder();
+
+	/// Returns the recorder of the calling thread, or nullptr if no tape is recording.
+	static Recorder*& active() {
+		thread_local Recorder* recorder = nullptr;
+		return recorder;
+	}
+
+	/// Throws if `impl` holds a tracked value, `what` names an operation that has no backward
+	/// rule.
+	static void ensureUntracked(const Tensor::Impl* impl, const char* what);
+
+	/// `ensureUntracked` for an impl that `what` is about to write in place. Data saved from it
+	/// is detached first, as in `recordOpaqueWrite`.
+	static void ensureUntrackedWrite(const Tensor::Impl* impl, const char* what);
+
+	/// out = lhs op rhs.
+	void recordBinary(graph::OpType type, const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+	                  const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+	                  const Tensor::Impl* out, const TensorLayout& outLayout);
+
+	/// target = target op rhs, `type` is one of the in-place ops, Set or MaskedFill.
+	void recordInplace(graph::OpType type, const Tensor::Impl* target,
+	                   const TensorLayout& targetLayout, const Tensor::Impl* rhs,
+	                   const TensorLayout& rhsLayout);
+
+	/// out = reduce(in).
+	void recordReduction(graph::OpType type, const Tensor::Impl* in, const TensorLayout& layout,
+	                     const TensorLayout& blockLayout, const Tensor::Impl* out,
+	                     const TensorLayout& outLayout);
+
+	/// out = lhs @ rhs.
+	void recordMatmul(const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+	                  const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+	                  const Tensor::Impl* out, const TensorLayout& outLayout, size_t batch,
+	                  size_t m, size_t k, size_t p);
+
+	/// out = op(in), contiguous with the shape of `layout`.
+	void recordMap(UnaryOp op, float alpha, float beta, const Tensor::Impl* in,
+	               const TensorLayout& layout, const Tensor::Impl* out);
+
+	/// `copy` is a fresh deep copy of `src`.
+	void recordCopy(const Tensor::Impl* src, const Tensor::Impl* copy);
+
+	/// `impl` is about to be overwritten with data that does not depend on any parameter, e.g. by
+	/// `fillAll`. It is untracked afterwards.
+	void recordOpaqueWrite(const Tensor::Impl* impl);
+
+	/// `impl` is about to be destroyed. The recorder takes ownership if it still reads its data.
+	void release(std::unique_ptr<Tensor::Impl>& impl);
+
+	/// Runs `body`, which updates `state` in place, recording it as a single node that keeps a
+	/// copy of the state it started from instead of the operands of every operation in it.
+	void checkpoint(const std::vector<Tensor*>& state, const std::function<void()>& body);
+
+	/// Gradients of the sum of `seeds[i]` times `outputs[i]` with respect to every parameter, in
+	/// order. Parameters the outputs do not depend on get nullptr. The recorder is consumed.
+	/// @param seeds  Float32, contiguous with the shape of their output.
+	std::vector<std::unique_ptr<Tensor::Impl>> backward(
+	    const std::vector<const Tensor::Impl*>& outputs,
+	    std::vector<std::unique_ptr<Tensor::Impl>> seeds);
+
+	/// True if `impl` holds a value tracked here or by an outer recorder.
+	bool isTracked(const Tensor::Impl* impl) const;
+
+	/// Returns the number of recorded operations.
+	size_t getNumNodes() const { return m_nodes.size(); }
+
+	/// Returns the bytes of operand copies owned by the recorder.
+	size_t getSavedBytes() const { return m_savedBytes; }
+
+private:
+	/// Operand data read by a backward rule. `impl` points to live data until it is written or
+	/// released, then to `owned`.
+	struct Saved {
+		const Tensor::Impl* impl;
+		std::unique_ptr<Tensor::Impl> owned;
+	};
+
+	/// A checkpointed run of `body`, see `checkpoint`.
+	struct Segment {
+		std::vector<Tensor*> state;
+		std::vector<std::unique_ptr<Tensor::Impl>> initial;
+		std::vector<size_t> inputs;
+		std::vector<size_t> outputs;
+		std::function<void()> body;
+	};
+
+	Backend m_backend;
+	Recorder* m_outer;
+	std::vector<size_t> m_params;
+
+	std::vector<TensorLayout> m_values;
+	std::vector<Node> m_nodes;
+	std::vector<Segment> m_segments;
+	std::unordered_map<const Tensor::Impl*, size_t> m_valueOf;
+
+	std::vector<Saved> m_saved;
+	std::unordered_map<const Tensor::Impl*, size_t> m_savedOf;
+	size_t m_savedBytes = 0;
+
+	/// Gradient buffers during `backward`, per value, and released buffers ready for reuse.
+	std::vector<std::unique_ptr<Tensor::Impl>> m_grads;
+	std::vector<std::unique_ptr<Tensor::Impl>> m_pool;
+
+	/// Value held by `impl`, or NO_VALUE. Throws on values of the outer recorder.
+	size_t read(const Tensor::Impl* impl) const;
+
+	/// Maps `impl` to a new value with the shape of `layout`.
+	size_t define(const Tensor::Impl* impl, const TensorLayout& layout);
+
+	/// Saves `impl` by reference for the backward pass.
+	size_t save(const Tensor::Impl* impl);
+
+	/// Copies or, if `owner` still holds it, takes `impl` for every save that references it.
+	void detach(const Tensor::Impl* impl, std::unique_ptr<Tensor::Impl>* owner);
+
+	/// `impl` is about to be written in place, detaches its saves here and in outer recorders.
+	void prepareWrite(const Tensor::Impl* impl);
+
+	const Tensor::Impl* saved(size_t id) const { return m_saved[id].impl; }
+
+	/// Backward rules, `grad` is the gradient of `node.out`. Rules may take the buffer over, if
+	/// they leave it the caller returns it to the pool.
+	void backwardBinary(const Node& node, std::unique_ptr<Tensor::Impl>& grad);
+	void backwardInplace(const Node& node, std::unique_ptr<Tensor::Impl>& grad);
+	void backwardReduction(const Node& node, std::unique_ptr<Tensor::Impl>& grad);
+	void backwardMatmul(const Node& node, std::unique_ptr<Tensor::Impl>& grad);
+	void backwardMap(const Node& node, std::unique_ptr<Tensor::Impl>& grad);
+	void backwardCheckpoint(const Node& node);
+
+	/// grad(value)[target] += grad[gradLayout], or -= if `negate`. Dims `target` broadcasts
+	/// with stride 0 are summed first.
+	void accumulate(size_t value, const Tensor::Impl* grad, const TensorLayout& gradLayout,
+	                const TensorLayout& target, bool negate = false);
+
+	/// Same as above, adopting `grad` as the gradient buffer of `value` if it has none yet and
+	/// both layouts cover the whole value.
+	void accumulate(size_t value, std::unique_ptr<Tensor::Impl> grad,
+	                const TensorLayout& gradLayout, const TensorLayout& target);
+
+	/// Zero filled Float32 buffer with the shape of `layout`, reusing a released one if possible.
+	std::unique_ptr<Tensor::Impl> zeros(const TensorLayout& layout);
+
+	/// Scalar Float32 constant.
+	std::unique_ptr<Tensor::Impl> scalar(float value) const;
+
+	/// Returns a Float32 buffer to the pool, `grad` may be nullptr.
+	void recycle(std::unique_ptr<Tensor::Impl> grad);
+};
+
+}  // namespace autograd
+
+#endif  // AUTOGRAD_RECORDER_H
@@ -0,0 +1,3058 @@
+#ifndef KERNELS_CPU_H
+#define KERNELS_CPU_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "backend/cpu/thread_pool.h"
+#include "backend/half.h"
+#include "backend/tensor_impl.h"
+#include "nforge/core/tensor_layout.h"
+
+/// Raw pointer CPU kernels, shared by `Tensor::CPUImpl` and graph replay.
+///
+/// Every kernel walks its operands through `TensorLayout` descriptors and trusts them, see
+/// Tensor::Impl for the layout contract.
+namespace cpu {
+
+/// Number of elements described by the active dims of `layout`.
+inline size_t getNumElements(const TensorLayout& layout) {
+	size_t count = 1;
+	for (size_t d = 0; d < layout.rank; d++) count *= layout.shape[d];
+	return count;
+}
+
+/// `offset` elements from a pointer into a row. Offsets along dims walked backwards wrap around,
+/// see `TensorLayout::strides`, so they are applied signed to keep the pointer arithmetic in
+/// range.
+inline ptrdiff_t signedOffset(size_t offset) { return static_cast<ptrdiff_t>(offset); }
+
+/// Walks `layouts` in row-major logical order, one innermost row at a time.
+///
+/// `visit(offsets, strides, length)` is called per row with the physical offset of the row start
+/// and the innermost stride of every layout. Outer dims advance like an odometer, so there are no
+/// per element divisions as with `physicalOffset`. All layouts must have the shape of the first.
+/// If `visit` returns bool, the walk stops after the first row it returns false for.
+///
+/// Only rows [firstRow, lastRow) are visited, so ranges of rows can be walked on separate threads.
+template <size_t N, typename Visit>
+inline void forEachRow(const std::array<const TensorLayout*, N>& layouts, size_t firstRow,
+                       size_t lastRow, Visit visit) {
+	const TensorLayout& first = *layouts[0];
+	size_t rank = first.rank;
+
+	std::array<size_t, N> offsets;
+	std::array<size_t, N> strides;
+	for (size_t n = 0; n < N; n++) {
+		offsets[n] = layouts[n]->offset;
+		strides[n] = rank > 0 ? layouts[n]->strides[rank - 1] : 0;
+	}
+
+	size_t length = rank > 0 ? first.shape[rank - 1] : 1;
+	size_t rows = length > 0 ? getNumElements(first) / length : 0;
+	size_t outerRank = rank > 0 ? rank - 1 : 0;
+
+	lastRow = std::min(lastRow, rows);
+	if (firstRow >= lastRow) {
+		return;
+	}
+
+	// start the odometer at the first row
+	std::array<size_t, MAX_DIMS> index{};
+	size_t rest = firstRow;
+	for (size_t d = outerRank; d-- > 0;) {
+		index[d] = rest % first.shape[d];
+		rest /= first.shape[d];
+		for (size_t n = 0; n < N; n++) offsets[n] += index[d] * layouts[n]->strides[d];
+	}
+
+	for (size_t row = firstRow; row < lastRow; row++) {
+		if constexpr (std::is_same_v<decltype(visit(offsets, strides, length)), bool>) {
+			if (!visit(offsets, strides, length)) {
+				return;
+			}
+		} else {
+			visit(offsets, strides, length);
+		}
+
+		for (size_t d = outerRank; d-- > 0;) {
+			for (size_t n = 0; n < N; n++) offsets[n] += layouts[n]->strides[d];
+
+			if (++index[d] < first.shape[d]) {
+				break;
+			}
+
+			for (size_t n = 0; n < N; n++) offsets[n] -= layouts[n]->strides[d] * first.shape[d];
+			index[d] = 0;
+		}
+	}
+}
+
+template <size_t N, typename Visit>
+inline void forEachRow(const std::array<const TensorLayout*, N>& layouts, Visit visit) {
+	forEachRow<N>(layouts, 0, std::numeric_limits<size_t>::max(), visit);
+}
+
+// Element types
+//
+// Kernels load every operand into a compute type, apply the functor there and convert the result
+// to the element type of the output. 16 bit floats compute in float, all other types in
+// themselves. Reductions and matmul accumulate in a wider type.
+
+template <typename T>
+struct Compute {
+	using type = T;
+};
+
+template <>
+struct Compute<Float16> {
+	using type = float;
+};
+
+template <>
+struct Compute<BFloat16> {
+	using type = float;
+};
+
+/// Type an elementwise op on `L` and `R` computes in.
+template <typename L, typename R = L>
+using ComputeType = std::common_type_t<typename Compute<L>::type, typename Compute<R>::type>;
+
+/// Type reductions of `T` accumulate in: double for double, float for the other floats and
+/// int64_t for integers and bool.
+template <typename T>
+using AccumulateType =
+    std::conditional_t<std::is_same_v<T, double>, double,
+                       std::conditional_t<std::is_floating_point_v<typename Compute<T>::type>,
+                                          float, int64_t>>;
+
+/// Unsigned integer with the bits of the compute type `C`.
+template <typename C>
+using BitsOf = std::conditional_t<sizeof(C) == 8, uint64_t, uint32_t>;
+
+/// True if `x` is NaN. Tested on the bits, -ffast-math folds x != x to false.
+template <typename C>
+inline bool isNaN(C x) {
+	if constexpr (std::is_floating_point_v<C>) {
+		using K = BitsOf<C>;
+		constexpr K MAGNITUDE = ~K(0) >> 1;
+		const C infinity = std::numeric_limits<C>::infinity();
+
+		K bits, inf;
+		std::memcpy(&bits, &x, sizeof(K));
+		std::memcpy(&inf, &infinity, sizeof(K));
+		return (bits & MAGNITUDE) > inf;
+	} else {
+		return false;
+	}
+}
+
+/// True if `x` is not zero, NaN included. Tested on the bits, -ffast-math may compare NaN equal
+/// to zero.
+template <typename C>
+inline bool isNonzero(C x) {
+	if constexpr (std::is_floating_point_v<C>) {
+		using K = BitsOf<C>;
+		constexpr K MAGNITUDE = ~K(0) >> 1;
+
+		K bits;
+		std::memcpy(&bits, &x, sizeof(K));
+		return (bits & MAGNITUDE) != 0;
+	} else {
+		return x != C(0);
+	}
+}
+
+// Result element types of ops, as a function of the element type they compute on
+
+template <typename T>
+using SameType = T;
+
+template <typename T>
+using BoolType = bool;
+
+/// L2 norms are double for double and float otherwise.
+template <typename T>
+using NormType = std::conditional_t<std::is_same_v<T, double>, double, float>;
+
+// Elementary functions
+//
+// Float versions are polynomial approximations without branches or calls, so loops over them
+// vectorize. std::exp and friends only do with vector variants from the C library. Error bounds
+// are measured against double over the stated ranges and hold with -ffast-math. The double
+// versions call the C library.
+
+/// exp(r) for |r| <= ln(2) / 2, a minimax polynomial.
+inline float expReduced(float r) {
+	float p = 1.9875691500e-4f;
+	p = p * r + 1.3981999507e-3f;
+	p = p * r + 8.3334519073e-3f;
+	p = p * r + 4.1665795894e-2f;
+	p = p * r + 1.6666665459e-1f;
+	p = p * r + 5.0000001201e-1f;
+	return p * r * r + r + 1.0f;
+}
+
+/// 2^n for integer n in [-126, 127], assembled in the exponent bits.
+inline float exp2Int(int32_t n) { return detail::bitsFloat(static_cast<uint32_t>(n + 127) << 23); }
+
+/// p * 2^n for p in [0.5, 2) and n in [-126, 128], so n = 128 stays finite until the product
+/// overflows. Half of n is added to the exponent bits of p, a product of two powers of two could
+/// be folded into an infinite constant by -ffast-math.
+inline float scaleExp2(float p, int32_t n) {
+	int32_t half = n / 2;
+	uint32_t bits = detail::floatBits(p) + (static_cast<uint32_t>(n - half) << 23);
+	return detail::bitsFloat(bits) * exp2Int(half);
+}
+
+/// exp(x) for float, within 1 ulp for results in the normal range. Inputs are clamped to
+/// [-87.3, 88.8], so results past the float range are infinity and those below 2^-126 flush to
+/// 2^-126.
+inline float fastExp(float x) {
+	constexpr float LOG2E = 1.44269504088896341f;
+	// ln(2) split in a part exact in float and the remainder
+	constexpr float LN2_HIGH = 0.693359375f;
+	constexpr float LN2_LOW = -2.12194440e-4f;
+
+	x = std::min(std::max(x, -87.3f), 88.8f);
+
+	// x = n * ln(2) + r with |r| <= ln(2) / 2. The steps are fused, -ffast-math would otherwise
+	// reassociate the split constant back into one.
+	float n = std::floor(x * LOG2E + 0.5f);
+	float r = std::fma(-n, LN2_LOW, std::fma(-n, LN2_HIGH, x));
+	return scaleExp2(expReduced(r), static_cast<int32_t>(n));
+}
+
+/// Splits positive finite x = m * 2^e with m in [sqrt(0.5), sqrt(2)). Returns f = m - 1 and sets
+/// `e` and `tail` such that ln(m) = f + tail.
+inline float logReduced(float x, int32_t& e, float& tail) {
+	constexpr float SQRT_HALF = 0.707106781186547524f;
+
+	// subnormals are scaled into the normal range
+	bool subnormal = x < std::numeric_limits<float>::min();
+	float scaled = subnormal ? x * 8388608.0f : x;
+
+	uint32_t bits = detail::floatBits(scaled);
+	e = static_cast<int32_t>((bits >> 23) & 0xffu) - 126 - (subnormal ? 23 : 0);
+	float m = detail::bitsFloat((bits & 0x007fffffu) | 0x3f000000u);
+	bool low = m < SQRT_HALF;
+	e -= low ? 1 : 0;
+	float f = low ? m + m - 1.0f : m - 1.0f;
+
+	float z = f * f;
+	float p = 7.0376836292e-2f;
+	p = p * f - 1.1514610310e-1f;
+	p = p * f + 1.1676998740e-1f;
+	p = p * f - 1.2420140846e-1f;
+	p = p * f + 1.4249322787e-1f;
+	p = p * f - 1.6668057665e-1f;
+	p = p * f + 2.0000714765e-1f;
+	p = p * f - 2.4999993993e-1f;
+	p = p * f + 3.3333331174e-1f;
+
+	tail = p * f * z - 0.5f * z;
+	return f;
+}
+
+/// log(x) for float, within 2 ulp for positive normal and subnormal x. Zero gives -infinity and
+/// negative x NaN, infinity and NaN inputs are not handled.
+inline float fastLog(float x) {
+	constexpr float LN2_HIGH = 0.693359375f;
+	constexpr float LN2_LOW = -2.12194440e-4f;
+
+	int32_t e;
+	float tail;
+	float f = logReduced(x, e, tail);
+
+	float n = static_cast<float>(e);
+	float result = f + (tail + n * LN2_LOW) + n * LN2_HIGH;
+
+	result = x == 0.0f ? -std::numeric_limits<float>::infinity() : result;
+	return x < 0.0f ? std::numeric_limits<float>::quiet_NaN() : result;
+}
+
+/// x^p for positive finite float x, within 2 ulp for |p| <= 8 and results in the normal range.
+/// p * ln(x) is formed in double, in float its rounding error would be scaled up by exp.
+inline float fastPow(float x, float p) {
+	constexpr double LN2 = 0.693147180559945309;
+	constexpr double LOG2E = 1.44269504088896341;
+
+	int32_t e;
+	float tail;
+	float f = logReduced(x, e, tail);
+
+	double t = static_cast<double>(p) * (e * LN2 + (static_cast<double>(f) + tail));
+	t = std::min(std::max(t, -87.3), 88.8);
+
+	double n = std::floor(t * LOG2E + 0.5);
+	float r = static_cast<float>(t - n * LN2);
+	return scaleExp2(expReduced(r), static_cast<int32_t>(n));
+}
+
+/// sin(r) for odd `q` and cos(r) for even `q`, negated if bit 1 of `q` is set, for |r| <= pi / 4.
+/// This is sin(r + q * pi / 2).
+inline float sinQuadrant(float r, int32_t q) {
+	float z = r * r;
+	float s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+	float c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) *
+	              z * z -
+	          0.5f * z + 1.0f;
+	float v = (q & 1) ? c : s;
+	return (q & 2) ? -v : v;
+}
+
+/// Splits x = r + q * pi / 2 with |r| <= pi / 4 and returns q.
+inline int32_t reduceQuadrant(float x, float& r) {
+	constexpr float TWO_OVER_PI = 0.636619772367581343f;
+	// pi / 2 in three parts, the products of the first two with q are exact for |q| < 2^15
+	constexpr float PIO2_HIGH = 1.5703125f;
+	constexpr float PIO2_MID = 4.837512969970703125e-4f;
+	constexpr float PIO2_LOW = 7.54978995489188216e-8f;
+
+	// fused for the same reason as in `fastExp`
+	float q = std::floor(x * TWO_OVER_PI + 0.5f);
+	r = std::fma(-q, PIO2_HIGH, x);
+	r = std::fma(-q, PIO2_MID, r);
+	r = std::fma(-q, PIO2_LOW, r);
+	return static_cast<int32_t>(q);
+}
+
+/// sin(x) for float, within 2 ulp for |x| <= pi and 1e-7 absolute error for |x| <= 8192.
+inline float fastSin(float x) {
+	float r;
+	int32_t q = reduceQuadrant(x, r);
+	return sinQuadrant(r, q);
+}
+
+/// cos(x) for float, within 2 ulp for |x| <= pi and 1e-7 absolute error for |x| <= 8192.
+inline float fastCos(float x) {
+	float r;
+	int32_t q = reduceQuadrant(x, r);
+	return sinQuadrant(r, q + 1);
+}
+
+/// tanh(x) for float, within 3 ulp. A polynomial below |x| = 0.625, where 1 - 2 / (exp(2x) + 1)
+/// would cancel, and that formula above.
+inline float fastTanh(float x) {
+	float z = x * x;
+	float p = -5.70498872745e-3f;
+	p = p * z + 2.06390887954e-2f;
+	p = p * z - 5.37397155531e-2f;
+	p = p * z + 1.33314422036e-1f;
+	p = p * z - 3.33332819422e-1f;
+	float small = p * z * x + x;
+
+	float a = std::abs(x);
+	// tanh rounds to 1 from a = 9 on, the cap keeps exp finite
+	float large = 1.0f - 2.0f / (fastExp(std::min(2.0f * a, 20.0f)) + 1.0f);
+	large = x < 0.0f ? -large : large;
+	return a < 0.625f ? small : large;
+}
+
+inline double fastExp(double x) { return std::exp(x); }
+
+inline double fastLog(double x) { return std::log(x); }
+
+inline double fastPow(double x, double p) { return std::pow(x, p); }
+
+inline double fastSin(double x) { return std::sin(x); }
+
+inline double fastCos(double x) { return std::cos(x); }
+
+inline double fastTanh(double x) { return std::tanh(x); }
+
+// Elementwise functors
+
+struct Add {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return a + b;
+	}
+};
+
+struct Sub {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return a - b;
+	}
+};
+
+struct Mul {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return a * b;
+	}
+
+	/// Bool products are logical and.
+	bool operator()(bool a, bool b) const { return a && b; }
+};
+
+struct Div {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return a / b;
+	}
+};
+
+struct Min {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return std::min(a, b);
+	}
+};
+
+struct Max {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return std::max(a, b);
+	}
+};
+
+/// Keeps the rhs, used for assignment.
+struct Assign {
+	template <typename T>
+	T operator()(T, T b) const {
+		return b;
+	}
+};
+
+struct Equal {
+	template <typename T>
+	bool operator()(T a, T b) const {
+		return a == b;
+	}
+};
+
+struct NotEqual {
+	template <typename T>
+	bool operator()(T a, T b) const {
+		return a != b;
+	}
+};
+
+struct Less {
+	template <typename T>
+	bool operator()(T a, T b) const {
+		return a < b;
+	}
+};
+
+struct LessEqual {
+	template <typename T>
+	bool operator()(T a, T b) const {
+		return a <= b;
+	}
+};
+
+struct Greater {
+	template <typename T>
+	bool operator()(T a, T b) const {
+		return a > b;
+	}
+};
+
+struct GreaterEqual {
+	template <typename T>
+	bool operator()(T a, T b) const {
+		return a >= b;
+	}
+};
+
+/// Relative difference within `tolerance`, computed in double for double and float otherwise.
+struct IsClose {
+	float tolerance;
+
+	template <typename T>
+	bool operator()(T a, T b) const {
+		using F = std::conditional_t<std::is_same_v<T, double>, double, float>;
+		F absDiff = std::abs(static_cast<F>(a) - static_cast<F>(b));
+		F denom = std::max(F(1), std::abs(static_cast<F>(b)));
+		return absDiff / denom <= tolerance;
+	}
+};
+
+/// Replaces elements where the rhs mask is set by `value`.
+struct MaskedFill {
+	float value;
+
+	template <typename T>
+	T operator()(T x, T mask) const {
+		return mask != T(0) ? static_cast<T>(value) : x;
+	}
+};
+
+struct LogicalAnd {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return a != T(0) && b != T(0);
+	}
+};
+
+struct LogicalOr {
+	template <typename T>
+	T operator()(T a, T b) const {
+		return a != T(0) || b != T(0);
+	}
+};
+
+// Unary functors, see `unary`. They run on float and double, Abs and Clamp also on integers.
+
+struct Exp {
+	template <typename T>
+	T operator()(T x) const {
+		return fastExp(x);
+	}
+};
+
+struct Log {
+	template <typename T>
+	T operator()(T x) const {
+		return fastLog(x);
+	}
+};
+
+/// sqrt(x), correctly rounded. With -ffast-math this becomes the same estimate as `Rsqrt`
+/// times x, within 3 ulp.
+struct Sqrt {
+	template <typename T>
+	T operator()(T x) const {
+		return std::sqrt(x);
+	}
+};
+
+/// 1 / sqrt(x). With -ffast-math this becomes the hardware estimate and a Newton step, within
+/// 4 ulp.
+struct Rsqrt {
+	template <typename T>
+	T operator()(T x) const {
+		return T(1) / std::sqrt(x);
+	}
+};
+
+/// |x|. The lowest value of a signed integer type wraps to itself.
+struct Abs {
+	template <typename T>
+	T operator()(T x) const {
+		if constexpr (std::is_unsigned_v<T>) {
+			return x;
+		} else if constexpr (std::is_integral_v<T>) {
+			using U = std::make_unsigned_t<T>;
+			return x < T(0) ? static_cast<T>(U(0) - static_cast<U>(x)) : x;
+		} else {
+			return x < T(0) ? -x : x;
+		}
+	}
+};
+
+struct Tanh {
+	template <typename T>
+	T operator()(T x) const {
+		return fastTanh(x);
+	}
+};
+
+/// 1 / (1 + exp(-x)), within 4 ulp for x >= -87 and flushing to 2^-126 below.
+struct Sigmoid {
+	template <typename T>
+	T operator()(T x) const {
+		return T(1) / (T(1) + fastExp(-x));
+	}
+};
+
+struct Sin {
+	template <typename T>
+	T operator()(T x) const {
+		return fastSin(x);
+	}
+};
+
+struct Cos {
+	template <typename T>
+	T operator()(T x) const {
+		return fastCos(x);
+	}
+};
+
+/// x^exponent. Negative x give NaN unless the exponent is an integer, zero gives 0, 1 or
+/// infinity by the sign of the exponent.
+struct Pow {
+	float exponent;
+
+	template <typename T>
+	T operator()(T x) const {
+		T p = static_cast<T>(exponent);
+		T a = x < T(0) ? -x : x;
+		T result = fastPow(a > T(0) ? a : T(1), p);
+
+		bool integer = std::floor(p) == p;
+		bool odd = integer && std::fmod(p, T(2)) != T(0);
+		T zero = p > T(0) ? T(0) : p == T(0) ? T(1) : std::numeric_limits<T>::infinity();
+
+		result = x < T(0) && odd ? -result : result;
+		result = x < T(0) && !integer ? std::numeric_limits<T>::quiet_NaN() : result;
+		return a == T(0) ? zero : result;
+	}
+};
+
+/// Limits x to [low, high]. Integer types round the bounds inwards and saturate them to their
+/// range, so they convert without overflow.
+struct Clamp {
+	float low;
+	float high;
+
+	template <typename T>
+	T operator()(T x) const {
+		if constexpr (std::is_floating_point_v<T>) {
+			return std::min(std::max(x, static_cast<T>(low)), static_cast<T>(high));
+		} else {
+			// the largest double below 2^63 for int64_t, the exact maximum otherwise
+			constexpr double MAX = std::is_same_v<T, int64_t>
+			                           ? 9223372036854774784.0
+			                           : static_cast<double>(std::numeric_limits<T>::max());
+			constexpr double MIN = static_cast<double>(std::numeric_limits<T>::lowest());
+
+			T lo = static_cast<T>(std::min(std::max(std::ceil(double(low)), MIN), MAX));
+			T hi = static_cast<T>(std::min(std::max(std::floor(double(high)), MIN), MAX));
+			return std::min(std::max(x, lo), hi);
+		}
+	}
+};
+
+// Quantization functors, see `ternary`
+
+/// Rounds `value` half to even and saturates it to the range of the integer type `Q`.
+template <typename Q>
+inline Q saturate(float value) {
+	constexpr float LOW = static_cast<float>(std::numeric_limits<Q>::lowest());
+	constexpr float HIGH = static_cast<float>(std::numeric_limits<Q>::max());
+	return static_cast<Q>(std::fmin(std::fmax(std::nearbyint(value), LOW), HIGH));
+}
+
+/// Affine quantization to `Q`, round(x / scale) + zeroPoint.
+template <typename Q>
+struct Quantize {
+	Q operator()(float x, float scale, float zeroPoint) const {
+		return saturate<Q>(x / scale + zeroPoint);
+	}
+};
+
+/// Inverse of `Quantize`, (q - zeroPoint) * scale.
+struct Dequantize {
+	float operator()(float q, float scale, float zeroPoint) const {
+		return (q - zeroPoint) * scale;
+	}
+};
+
+// Reduction transforms, applied to the first element of each block
+
+struct Identity {
+	template <typename T>
+	constexpr T&& operator()(T&& t) const noexcept {
+		return std::forward<T>(t);
+	}
+};
+
+struct NonZero {
+	template <typename T>
+	T operator()(T x) const {
+		return x != T(0);
+	}
+};
+
+struct Square {
+	template <typename T>
+	T operator()(T x) const {
+		return x * x;
+	}
+};
+
+/// Accumulates squares, paired with `Square` as transform.
+struct SquareSum {
+	template <typename T>
+	T operator()(T acc, T x) const {
+		return acc + x * x;
+	}
+};
+
+// Kernels
+//
+// Kernels are templated on the element type of every operand, see `ComputeType` and
+// `AccumulateType` for the types they compute in.
+
+/// out = op(lhs, rhs), iterating `outLayout`. All layouts must have the same shape.
+template <typename L, typename R, typename O, typename BinaryOp>
+inline void binary(const L* lhs, const TensorLayout& lhsLayout, const R* rhs,
+                   const TensorLayout& rhsLayout, O* out, const TensorLayout& outLayout,
+                   BinaryOp op) {
+	forEachRow<3>({&outLayout, &lhsLayout, &rhsLayout}, [&](const auto& offsets,
+	                                                        const auto& strides, size_t length) {
+		using C = ComputeType<L, R>;
+
+		O* o = out + offsets[0];
+		const L* l = lhs + offsets[1];
+		const R* r = rhs + offsets[2];
+
+		if (strides[0] == 1 && strides[1] == 1 && strides[2] == 1) {
+			for (size_t j = 0; j < length; j++) {
+				o[j] = static_cast<O>(op(static_cast<C>(l[j]), static_cast<C>(r[j])));
+			}
+		} else {
+			for (size_t j = 0; j < length; j++) {
+				C a = static_cast<C>(l[signedOffset(j * strides[1])]);
+				C b = static_cast<C>(r[signedOffset(j * strides[2])]);
+				o[signedOffset(j * strides[0])] = static_cast<O>(op(a, b));
+			}
+		}
+	});
+}
+
+/// out = op(in) computed in `Compute<O>`, iterating `outLayout`. Both layouts must have the same
+/// shape. `in` may alias `out` with the same layout.
+template <typename I, typename O, typename UnaryOp>
+inline void unary(const I* in, const TensorLayout& inLayout, O* out, const TensorLayout& outLayout,
+                  UnaryOp op) {
+	forEachRow<2>({&outLayout, &inLayout}, [&](const auto& offsets, const auto& strides,
+	                                           size_t length) {
+		using C = typename Compute<O>::type;
+
+		O* o = out + offsets[0];
+		const I* x = in + offsets[1];
+
+		if (strides[0] == 1 && strides[1] == 1) {
+			for (size_t j = 0; j < length; j++) {
+				o[j] = static_cast<O>(op(static_cast<C>(x[j])));
+			}
+		} else {
+			for (size_t j = 0; j < length; j++) {
+				C a = static_cast<C>(x[signedOffset(j * strides[1])]);
+				o[signedOffset(j * strides[0])] = static_cast<O>(op(a));
+			}
+		}
+	});
+}
+
+/// out = op(a, b, c) computed in float, iterating `outLayout`. All layouts must have the same
+/// shape.
+template <typename A, typename B, typename C, typename O, typename TernaryOp>
+inline void ternary(const A* a, const TensorLayout& aLayout, const B* b,
+                    const TensorLayout& bLayout, const C* c, const TensorLayout& cLayout, O* out,
+                    const TensorLayout& outLayout, TernaryOp op) {
+	forEachRow<4>({&outLayout, &aLayout, &bLayout, &cLayout}, [&](const auto& offsets,
+	                                                             const auto& strides,
+	                                                             size_t length) {
+		O* o = out + offsets[0];
+		const A* x = a + offsets[1];
+		const B* y = b + offsets[2];
+		const C* z = c + offsets[3];
+
+		for (size_t j = 0; j < length; j++) {
+			float first = static_cast<float>(x[signedOffset(j * strides[1])]);
+			float second = static_cast<float>(y[signedOffset(j * strides[2])]);
+			float third = static_cast<float>(z[signedOffset(j * strides[3])]);
+			o[signedOffset(j * strides[0])] = op(first, second, third);
+		}
+	});
+}
+
+/// lhs = op(lhs, rhs), iterating `lhsLayout`. Both layouts must have the same shape.
+template <typename L, typename R, typename BinaryOp>
+inline void inplaceBinary(L* lhs, const TensorLayout& lhsLayout, const R* rhs,
+                          const TensorLayout& rhsLayout, BinaryOp op) {
+	forEachRow<2>({&lhsLayout, &rhsLayout}, [&](const auto& offsets, const auto& strides,
+	                                            size_t length) {
+		using C = ComputeType<L, R>;
+
+		L* l = lhs + offsets[0];
+		const R* r = rhs + offsets[1];
+
+		if (strides[0] == 1 && strides[1] == 1) {
+			for (size_t j = 0; j < length; j++) {
+				l[j] = static_cast<L>(op(static_cast<C>(l[j]), static_cast<C>(r[j])));
+			}
+		} else {
+			for (size_t j = 0; j < length; j++) {
+				C a = static_cast<C>(l[signedOffset(j * strides[0])]);
+				C b = static_cast<C>(r[signedOffset(j * strides[1])]);
+				l[signedOffset(j * strides[0])] = static_cast<L>(op(a, b));
+			}
+		}
+	});
+}
+
+/// lhs = rhs for operands of the same element type, iterating `lhsLayout`. Copies elements
+/// without the round trip through the compute type `inplaceBinary` would take.
+template <typename T>
+inline void copy(T* lhs, const TensorLayout& lhsLayout, const T* rhs,
+                 const TensorLayout& rhsLayout) {
+	forEachRow<2>({&lhsLayout, &rhsLayout}, [&](const auto& offsets, const auto& strides,
+	                                            size_t length) {
+		T* l = lhs + offsets[0];
+		const T* r = rhs + offsets[1];
+
+		if (strides[0] == 1 && strides[1] == 1) {
+			std::copy(r, r + length, l);
+		} else {
+			for (size_t j = 0; j < length; j++) {
+				l[signedOffset(j * strides[0])] = r[signedOffset(j * strides[1])];
+			}
+		}
+	});
+}
+
+/// True if `layout` covers `getNumElements(layout)` consecutive elements from its offset, in
+/// row-major order.
+inline bool isContiguous(const TensorLayout& layout) {
+	size_t expected = 1;
+	for (size_t d = layout.rank; d-- > 0;) {
+		if (layout.shape[d] != 1 && layout.strides[d] != expected) {
+			return false;
+		}
+		expected *= layout.shape[d];
+	}
+	return true;
+}
+
+/// True if all `count` elements of a dense mask are set. Reads 32 bytes per step and returns at
+/// the first step holding a zero. Mask bytes are 0 or 1, so the AND of the words is all ones
+/// exactly when every byte is set.
+inline bool maskAll(const bool* mask, size_t count) {
+	constexpr uint64_t ONES = 0x0101010101010101ull;
+
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32) {
+		uint64_t words[4];
+		std::memcpy(words, mask + i, sizeof(words));
+		if ((words[0] & words[1] & words[2] & words[3]) != ONES) {
+			return false;
+		}
+	}
+	for (; i < count; i++) {
+		if (!mask[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// True if any of the `count` elements of a dense mask is set, see `maskAll`.
+inline bool maskAny(const bool* mask, size_t count) {
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32) {
+		uint64_t words[4];
+		std::memcpy(words, mask + i, sizeof(words));
+		if ((words[0] | words[1] | words[2] | words[3]) != 0) {
+			return true;
+		}
+	}
+	for (; i < count; i++) {
+		if (mask[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Number of set elements of a dense mask. Mask bytes are 0 or 1, so multiplying a word by
+/// 0x0101010101010101 sums its eight bytes into the top byte.
+inline size_t maskCount(const bool* mask, size_t count) {
+	constexpr uint64_t ONES = 0x0101010101010101ull;
+
+	size_t total = 0;
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, mask + i, sizeof(word));
+		total += (word * ONES) >> 56;
+	}
+	for (; i < count; i++) total += mask[i];
+	return total;
+}
+
+/// Walks blocks [firstBlock, lastBlock) of `layout` in row-major logical order in runs that stay
+/// inside one block of `blockCount` consecutive elements. `visit(run, stride, length, block, first,
+/// last)` gets the first element and innermost stride of each run, the block index and whether
+/// the run starts or ends it.
+template <typename T, typename Visit>
+inline void forEachBlockRun(T* data, const TensorLayout& layout, size_t blockCount,
+                            size_t firstBlock, size_t lastBlock, Visit visit) {
+	size_t rowLength = layout.rank > 0 ? layout.shape[layout.rank - 1] : 1;
+	if (blockCount == 0 || rowLength == 0 || firstBlock >= lastBlock) {
+		return;
+	}
+
+	size_t begin = firstBlock * blockCount;
+	size_t end = lastBlock * blockCount;
+	size_t skip = begin % rowLength;
+
+	size_t block = firstBlock;
+	size_t pos = 0;
+
+	size_t firstRow = begin / rowLength;
+	size_t lastRow = (end + rowLength - 1) / rowLength;
+	forEachRow<1>({&layout}, firstRow, lastRow, [&](const auto& offsets, const auto& strides,
+	                                                size_t length) {
+		T* row = data + offsets[0];
+		size_t j = skip;
+		skip = 0;
+		while (j < length && block < lastBlock) {
+			size_t n = std::min(length - j, blockCount - pos);
+			bool first = pos == 0;
+			pos += n;
+			bool last = pos == blockCount;
+
+			visit(row + signedOffset(j * strides[0]), strides[0], n, block, first, last);
+
+			j += n;
+			if (last) {
+				block++;
+				pos = 0;
+			}
+		}
+	});
+}
+
+template <typename T, typename Visit>
+inline void forEachBlockRun(T* data, const TensorLayout& layout, size_t blockCount, Visit visit) {
+	size_t numBlocks = blockCount > 0 ? getNumElements(layout) / blockCount : 0;
+	forEachBlockRun(data, layout, blockCount, 0, numBlocks, visit);
+}
+
+/// Calls `process(x, block)` for blocks [firstBlock, lastBlock) of `blockCount` consecutive
+/// elements of `layout`, with `x` the block as a contiguous array of `C`. Contiguous input of type
+/// `C` is passed in place, anything else is converted into a buffer first.
+template <typename C, typename In, typename Process>
+inline void forEachBlock(const In* in, const TensorLayout& layout, size_t blockCount,
+                         size_t firstBlock, size_t lastBlock, Process process) {
+	if (blockCount == 0 || firstBlock >= lastBlock) {
+		return;
+	}
+
+	if constexpr (std::is_same_v<In, C>) {
+		if (isContiguous(layout)) {
+			for (size_t block = firstBlock; block < lastBlock; block++) {
+				process(in + layout.offset + block * blockCount, block);
+			}
+			return;
+		}
+	}
+
+	// not a vector, which packs bool
+	std::unique_ptr<C[]> buffer(new C[blockCount]);
+	size_t pos = 0;
+	forEachBlockRun(in, layout, blockCount, firstBlock, lastBlock, [&](const In* run, size_t stride,
+	                                                                   size_t length, size_t block,
+	                                                                   bool first, bool last) {
+		if (first) {
+			pos = 0;
+		}
+		for (size_t t = 0; t < length; t++) {
+			buffer[pos + t] = static_cast<C>(run[signedOffset(t * stride)]);
+		}
+		pos += length;
+
+		if (last) {
+			process(static_cast<const C*>(buffer.get()), block);
+		}
+	});
+}
+
+/// `forEachBlock` over every block of `layout`.
+template <typename C, typename In, typename Process>
+inline void forEachBlock(const In* in, const TensorLayout& layout, size_t blockCount,
+                         Process process) {
+	size_t numBlocks = blockCount > 0 ? getNumElements(layout) / blockCount : 0;
+	forEachBlock<C>(in, layout, blockCount, 0, numBlocks, process);
+}
+
+/// Elements a range of blocks should hold before it is worth its own `parallelFor` range.
+constexpr size_t BLOCK_PARALLEL_WORK = size_t{1} << 14;
+
+/// `parallelFor` grain, in blocks of `blockCount` elements, for kernels split by block.
+inline size_t getBlockGrain(size_t blockCount) {
+	return std::max<size_t>(1, BLOCK_PARALLEL_WORK / std::max<size_t>(blockCount, 1));
+}
+
+/// Elements per chunk of `copyChunks`.
+constexpr size_t COPY_CHUNK = BLOCK_PARALLEL_WORK;
+
+/// Number of chunks `copyChunks` cuts `layout` into, each row into pieces of at most
+/// `COPY_CHUNK` elements.
+inline size_t getNumCopyChunks(const TensorLayout& layout) {
+	size_t rowLength = layout.rank > 0 ? layout.shape[layout.rank - 1] : 1;
+	if (rowLength == 0) {
+		return 0;
+	}
+	return getNumElements(layout) / rowLength * ((rowLength + COPY_CHUNK - 1) / COPY_CHUNK);
+}
+
+/// lhs = rhs converted to `L`, for chunks [firstChunk, lastChunk) of `lhsLayout`, see
+/// `getNumCopyChunks`. Both layouts have the same shape. Runs contiguous in both are copied
+/// without the round trip through the compute type, so ranges of chunks split any copy, from
+/// one long run to many short rows, over threads.
+template <typename L, typename R>
+inline void copyChunks(L* lhs, const TensorLayout& lhsLayout, const R* rhs,
+                       const TensorLayout& rhsLayout, size_t firstChunk, size_t lastChunk) {
+	using C = ComputeType<L, R>;
+
+	size_t rowLength = lhsLayout.rank > 0 ? lhsLayout.shape[lhsLayout.rank - 1] : 1;
+	size_t chunksPerRow = (rowLength + COPY_CHUNK - 1) / COPY_CHUNK;
+	if (chunksPerRow == 0) {
+		return;
+	}
+	size_t row = firstChunk / chunksPerRow;
+	size_t lastRow = (lastChunk + chunksPerRow - 1) / chunksPerRow;
+
+	forEachRow<2>({&lhsLayout, &rhsLayout}, row, lastRow, [&](const auto& offsets,
+	                                                         const auto& strides,
+	                                                         size_t length) {
+		L* l = lhs + offsets[0];
+		const R* r = rhs + offsets[1];
+
+		// the range may start and end inside a row
+		size_t rowStart = row * chunksPerRow;
+		size_t first = firstChunk > rowStart ? (firstChunk - rowStart) * COPY_CHUNK : 0;
+		size_t last = std::min(length, (lastChunk - rowStart) * COPY_CHUNK);
+		row++;
+
+		if constexpr (std::is_same_v<L, R>) {
+			if (strides[0] == 1 && strides[1] == 1) {
+				std::copy(r + first, r + last, l + first);
+				return;
+			}
+		}
+		for (size_t j = first; j < last; j++) {
+			C value = static_cast<C>(r[signedOffset(j * strides[1])]);
+			l[signedOffset(j * strides[0])] = static_cast<L>(value);
+		}
+	});
+}
+
+/// Reduces each block of `blockLayout` elements of `in` into one element of `out`, accumulating
+/// in `AccumulateType<In>`. `op` must be associative, and `transform(x) = op(x)` must hold for the
+/// first element.
+template <typename In, typename Out, typename ReductionOp, typename Transform = Identity>
+inline void reduce(const In* in, const TensorLayout& layout, const TensorLayout& blockLayout,
+                   Out* out, const TensorLayout& outLayout, ReductionOp op,
+                   Transform transform = {}) {
+	using A = AccumulateType<In>;
+	A res{};
+
+	forEachBlockRun(in, layout, getNumElements(blockLayout), [&](const In* run, size_t stride,
+	                                                             size_t length, size_t block,
+	                                                             bool first, bool last) {
+		size_t t = 0;
+		if (first) {
+			res = transform(static_cast<A>(run[0]));
+			t = 1;
+		}
+
+		// a plain loop over the run, which the compiler can vectorize
+		A acc = res;
+		if (stride == 1) {
+			for (; t < length; t++) acc = op(acc, static_cast<A>(run[t]));
+		} else {
+			for (; t < length; t++) acc = op(acc, static_cast<A>(run[signedOffset(t * stride)]));
+		}
+		res = acc;
+
+		if (last) {
+			out[physicalOffset(block, outLayout)] = static_cast<Out>(res);
+		}
+	});
+}
+
+/// Number of non-zero elements in each block of `blockLayout` elements of `in`, see `reduce`.
+/// NaN counts as nonzero. Contiguous Bool runs are counted 8 bytes at a time, see `maskCount`.
+template <typename In>
+inline void countNonzero(const In* in, const TensorLayout& layout,
+                         const TensorLayout& blockLayout, int64_t* out,
+                         const TensorLayout& outLayout) {
+	using C = typename Compute<In>::type;
+	int64_t count = 0;
+
+	forEachBlockRun(in, layout, getNumElements(blockLayout), [&](const In* run, size_t stride,
+	                                                             size_t length, size_t block,
+	                                                             bool first, bool last) {
+		if (first) {
+			count = 0;
+		}
+
+		if constexpr (std::is_same_v<In, bool>) {
+			if (stride == 1) {
+				count += maskCount(run, length);
+			} else {
+				for (size_t t = 0; t < length; t++) count += run[signedOffset(t * stride)];
+			}
+		} else {
+			for (size_t t = 0; t < length; t++) {
+				count += isNonzero(static_cast<C>(run[signedOffset(t * stride)]));
+			}
+		}
+
+		if (last) {
+			out[physicalOffset(block, outLayout)] = count;
+		}
+	});
+}
+
+/// True if `predicate(lhs, rhs)` equals `target` for any element, iterating `lhsLayout`. Both
+/// layouts must have the same shape. A fused `any` is a search for true, a fused `all` the
+/// negated search for false. Rows are tested in chunks without branches and the walk stops after
+/// the first chunk holding a match, so no mask is materialized and decided scans end early.
+///
+/// The chunks of all rows are split over `parallelFor`, so long rows split as well as many short
+/// ones. A match sets a shared flag that every thread checks before its next chunk.
+template <typename L, typename R, typename Predicate>
+inline bool findAny(const L* lhs, const TensorLayout& lhsLayout, const R* rhs,
+                    const TensorLayout& rhsLayout, Predicate predicate, bool target) {
+	constexpr size_t CHUNK = 256;
+	using C = ComputeType<L, R>;
+
+	size_t rank = lhsLayout.rank;
+	size_t rowLength = rank > 0 ? lhsLayout.shape[rank - 1] : 1;
+	size_t rows = rowLength > 0 ? getNumElements(lhsLayout) / rowLength : 0;
+	size_t chunksPerRow = (rowLength + CHUNK - 1) / CHUNK;
+
+	// matches are counted as integers, a bool accumulator keeps the chunk loop scalar
+	unsigned flip = target ? 0u : 1u;
+	std::atomic<bool> found{false};
+
+	parallelFor(rows * chunksPerRow, getBlockGrain(CHUNK), [&](size_t begin, size_t end) {
+		size_t row = begin / chunksPerRow;
+		size_t lastRow = (end + chunksPerRow - 1) / chunksPerRow;
+
+		forEachRow<2>({&lhsLayout, &rhsLayout}, row, lastRow, [&](const auto& offsets,
+		                                                         const auto& strides,
+		                                                         size_t length) {
+			const L* l = lhs + offsets[0];
+			const R* r = rhs + offsets[1];
+
+			// the range may start and end inside a row
+			size_t rowStart = row * chunksPerRow;
+			size_t firstChunk = begin > rowStart ? begin - rowStart : 0;
+			size_t lastChunk = std::min(chunksPerRow, end - rowStart);
+			row++;
+
+			for (size_t c = firstChunk; c < lastChunk; c++) {
+				if (found.load(std::memory_order_relaxed)) {
+					return false;
+				}
+
+				size_t j = c * CHUNK;
+				size_t stop = std::min(length, j + CHUNK);
+				unsigned hits = 0;
+				if (strides[0] == 1 && strides[1] == 1) {
+					for (size_t t = j; t < stop; t++) {
+						bool holds = predicate(static_cast<C>(l[t]), static_cast<C>(r[t]));
+						hits += static_cast<unsigned>(holds) ^ flip;
+					}
+				} else {
+					for (size_t t = j; t < stop; t++) {
+						C a = static_cast<C>(l[signedOffset(t * strides[0])]);
+						C b = static_cast<C>(r[signedOffset(t * strides[1])]);
+						hits += static_cast<unsigned>(predicate(a, b)) ^ flip;
+					}
+				}
+
+				if (hits != 0) {
+					found.store(true, std::memory_order_relaxed);
+					return false;
+				}
+			}
+			return true;
+		});
+	});
+	return found.load(std::memory_order_relaxed);
+}
+
+/// Maximum and sum of exp(x - max) over a sequence of values, accumulated in one pass.
+///
+/// Values are added in chunks. Each chunk first takes its maximum, rescales the running sum if the
+/// maximum grew, then adds exp(x - max). There is one exp per element and the chunk loops
+/// vectorize. `C` is float or double.
+template <typename C>
+struct ExpSum {
+	static constexpr size_t CHUNK = 256;
+
+	C max = std::numeric_limits<C>::lowest();
+	C sum = 0;
+
+	/// Adds `count <= CHUNK` contiguous values. If `exps` is not null exp(x - max) is stored to it
+	/// for the max after this chunk, which is returned. Later chunks rescale by
+	/// exp(returned - max).
+	C add(const C* x, size_t count, C* exps) {
+		C chunkMax = max;
+		for (size_t t = 0; t < count; t++) chunkMax = std::max(chunkMax, x[t]);
+		if (chunkMax > max) {
+			sum *= fastExp(max - chunkMax);
+			max = chunkMax;
+		}
+
+		C chunkSum = 0;
+		if (exps) {
+			for (size_t t = 0; t < count; t++) {
+				exps[t] = fastExp(x[t] - max);
+				chunkSum += exps[t];
+			}
+		} else {
+			for (size_t t = 0; t < count; t++) chunkSum += fastExp(x[t] - max);
+		}
+		sum += chunkSum;
+		return max;
+	}
+
+	/// log(sum(exp(x))) of all values added.
+	C logSumExp() const { return max + std::log(sum); }
+};
+
+/// What `softmax` writes for each block.
+enum class SoftmaxOutput { Softmax, LogSoftmax, LogSumExp };
+
+/// Softmax, log softmax or logsumexp of each block of `blockCount` elements of `in`, the block
+/// being the trailing dims of `layout`. Blocks are computed in `Compute<In>`, see `forEachBlock`.
+/// Softmax and log softmax write `out` contiguous in the shape of `layout`, logsumexp one element
+/// per block.
+///
+/// Softmax stores exp(x - running max) in the first pass and rescales by chunk in the second, so
+/// the input is read once and exp runs once per element. Ranges of blocks run on separate
+/// threads, see `getBlockGrain`.
+template <SoftmaxOutput Kind, typename In, typename Out>
+inline void softmax(const In* in, const TensorLayout& layout, size_t blockCount, Out* out) {
+	using C = typename Compute<In>::type;
+	constexpr size_t CHUNK = ExpSum<C>::CHUNK;
+
+	if (blockCount == 0) {
+		return;
+	}
+
+	size_t numChunks = (blockCount + CHUNK - 1) / CHUNK;
+	size_t numBlocks = getNumElements(layout) / blockCount;
+
+	// blocks are independent, each range of them gets its own scratch
+	parallelFor(numBlocks, getBlockGrain(blockCount), [&](size_t firstBlock, size_t lastBlock) {
+		std::vector<C> chunkMax(numChunks);
+		std::vector<C> exps;
+		if constexpr (Kind == SoftmaxOutput::Softmax && !std::is_same_v<Out, C>) {
+			exps.resize(blockCount);
+		}
+
+		auto process = [&](const C* x, size_t block) {
+			ExpSum<C> acc;
+			Out* row = out + block * blockCount;
+			C* e = nullptr;
+			if constexpr (Kind == SoftmaxOutput::Softmax) {
+				if constexpr (std::is_same_v<Out, C>) {
+					e = row;
+				} else {
+					e = exps.data();
+				}
+			}
+
+			for (size_t c = 0; c < numChunks; c++) {
+				size_t begin = c * CHUNK;
+				size_t count = std::min(CHUNK, blockCount - begin);
+				chunkMax[c] = acc.add(x + begin, count, e ? e + begin : nullptr);
+			}
+
+			if constexpr (Kind == SoftmaxOutput::LogSumExp) {
+				out[block] = static_cast<Out>(acc.logSumExp());
+			} else if constexpr (Kind == SoftmaxOutput::LogSoftmax) {
+				C shift = acc.logSumExp();
+				for (size_t t = 0; t < blockCount; t++) row[t] = static_cast<Out>(x[t] - shift);
+			} else {
+				C inverse = C(1) / acc.sum;
+				for (size_t c = 0; c < numChunks; c++) {
+					size_t begin = c * CHUNK;
+					size_t end = std::min(blockCount, begin + CHUNK);
+					C scale = fastExp(chunkMax[c] - acc.max) * inverse;
+					for (size_t t = begin; t < end; t++) row[t] = static_cast<Out>(e[t] * scale);
+				}
+			}
+		};
+
+		forEachBlock<C>(in, layout, blockCount, firstBlock, lastBlock, process);
+	});
+}
+
+/// L2 norm of each block of `blockLayout` elements of `in`, see `reduce`. `Out` is float or double.
+template <typename In, typename Out>
+inline void norm(const In* in, const TensorLayout& layout, const TensorLayout& blockLayout,
+                 Out* out, const TensorLayout& outLayout) {
+	reduce(in, layout, blockLayout, out, outLayout, SquareSum{}, Square{});
+
+	size_t outCount = getNumElements(outLayout);
+	for (size_t i = 0; i < outCount; i++) {
+		Out& element = out[physicalOffset(i, outLayout)];
+		element = std::sqrt(element);
+	}
+}
+
+/// Index of the first largest element of each block of `blockCount` elements of `in` if `MAX`, of
+/// the first smallest otherwise, written to the contiguous `out`. A NaN wins over any number.
+///
+/// The extreme is found by a branchless pass that vectorizes, its position by a second pass that
+/// stops there.
+template <bool MAX, typename In>
+inline void argExtreme(const In* in, const TensorLayout& layout, size_t blockCount,
+                       int64_t* out) {
+	using C = typename Compute<In>::type;
+
+	forEachBlock<C>(in, layout, blockCount, [&](const C* x, size_t block) {
+		C best = x[0];
+		unsigned nans = isNaN(x[0]);
+		for (size_t t = 1; t < blockCount; t++) {
+			best = (MAX ? x[t] > best : x[t] < best) ? x[t] : best;
+			nans += isNaN(x[t]);
+		}
+
+		// with a NaN `best` is meaningless, the first NaN is the result
+		size_t index = 0;
+		while (index + 1 < blockCount && (nans ? !isNaN(x[index]) : x[index] != best)) {
+			index++;
+		}
+		out[block] = static_cast<int64_t>(index);
+	});
+}
+
+/// The `k` largest elements of each block of `blockCount` elements of `in`, or the `k` smallest
+/// if not `largest`, with their indices in the block. Both outputs hold `k` contiguous elements
+/// per block, ordered from the best, equal values by index. NaN are not ordered.
+///
+/// A heap keeps the best `k` so far with the weakest at its root. Most elements lose against the
+/// root after one compare, the others cost O(log k), so a block costs O(n log k) at worst. Ranges
+/// of blocks run on separate threads, each with its own heap.
+template <typename In, typename Out>
+inline void topk(const In* in, const TensorLayout& layout, size_t blockCount, size_t k,
+                 bool largest, Out* values, int64_t* indices) {
+	using C = typename Compute<In>::type;
+	using Entry = std::pair<C, int64_t>;
+
+	if (k == 0) {
+		return;
+	}
+
+	size_t numBlocks = getNumElements(layout) / blockCount;
+
+	auto select = [&](auto better) {
+		// orders the heap, earlier indices win ties
+		auto before = [&](const Entry& a, const Entry& b) {
+			return better(a.first, b.first) || (!better(b.first, a.first) && a.second < b.second);
+		};
+
+		parallelFor(numBlocks, getBlockGrain(blockCount), [&](size_t firstBlock,
+		                                                      size_t lastBlock) {
+			std::vector<Entry> heap(k);
+
+			forEachBlock<C>(in, layout, blockCount, firstBlock, lastBlock, [&](const C* x,
+			                                                                   size_t block) {
+				for (size_t t = 0; t < k; t++) heap[t] = {x[t], static_cast<int64_t>(t)};
+				std::make_heap(heap.begin(), heap.end(), before);
+
+				// later elements have larger indices, so only strictly better ones enter
+				C weakest = heap.front().first;
+				for (size_t t = k; t < blockCount; t++) {
+					if (better(x[t], weakest)) {
+						std::pop_heap(heap.begin(), heap.end(), before);
+						heap.back() = {x[t], static_cast<int64_t>(t)};
+						std::push_heap(heap.begin(), heap.end(), before);
+						weakest = heap.front().first;
+					}
+				}
+
+				std::sort_heap(heap.begin(), heap.end(), before);
+				for (size_t i = 0; i < k; i++) {
+					values[block * k + i] = static_cast<Out>(heap[i].first);
+					indices[block * k + i] = heap[i].second;
+				}
+			});
+		});
+	};
+
+	if (largest) {
+		select(Greater{});
+	} else {
+		select(Less{});
+	}
+}
+
+/// Unsigned key that orders like `C`: 32 bits wide, 64 for 8 byte types.
+template <typename C>
+using RadixKey = BitsOf<C>;
+
+/// Maps `x` to a key whose unsigned order is the order of `x`. Floats flip the magnitude of
+/// negatives and set the sign bit of positives, every NaN maps to the largest key.
+template <typename C>
+inline RadixKey<C> radixKey(C x) {
+	using K = RadixKey<C>;
+	constexpr K SIGN = K(1) << (8 * sizeof(K) - 1);
+
+	if constexpr (std::is_floating_point_v<C>) {
+		K bits;
+		std::memcpy(&bits, &x, sizeof(K));
+		K key = (bits & SIGN) ? ~bits : bits | SIGN;
+		return isNaN(x) ? ~K(0) : key;
+	} else if constexpr (std::is_signed_v<C>) {
+		return static_cast<K>(static_cast<std::make_signed_t<K>>(x)) ^ SIGN;
+	} else {
+		return static_cast<K>(x);
+	}
+}
+
+/// Inverse of `radixKey`. NaN come back as one NaN pattern.
+template <typename C>
+inline C fromRadixKey(RadixKey<C> key) {
+	using K = RadixKey<C>;
+	constexpr K SIGN = K(1) << (8 * sizeof(K) - 1);
+
+	if constexpr (std::is_floating_point_v<C>) {
+		K bits = (key & SIGN) ? key & ~SIGN : ~key;
+		C x;
+		std::memcpy(&x, &bits, sizeof(K));
+		return x;
+	} else if constexpr (std::is_signed_v<C>) {
+		return static_cast<C>(static_cast<std::make_signed_t<K>>(key ^ SIGN));
+	} else {
+		return static_cast<C>(key);
+	}
+}
+
+/// Blocks shorter than this are sorted by comparison, the radix passes do not pay off there.
+constexpr size_t RADIX_SORT_MIN_COUNT = 256;
+
+/// Blocks at least this long are split over the threads inside the radix passes when there are
+/// fewer blocks than threads. More blocks are split over the threads by block.
+constexpr size_t RADIX_SORT_PARALLEL_COUNT = size_t{1} << 17;
+
+/// Keys per tile of `parallelRadixSort`, each tile is counted and scattered by one thread.
+constexpr size_t RADIX_SORT_TILE = size_t{1} << 15;
+
+/// Sorts `keys` ascending with one stable LSD pass per key byte, skipping the bytes every key
+/// shares. `order` is permuted along if it is not empty. The scratch vectors have the sizes of
+/// `keys` and `order`.
+template <typename K>
+inline void radixSort(std::vector<K>& keys, std::vector<K>& keyScratch,
+                      std::vector<int64_t>& order, std::vector<int64_t>& orderScratch) {
+	constexpr size_t PASSES = sizeof(K);
+	size_t count = keys.size();
+	bool withOrder = !order.empty();
+
+	std::array<std::array<size_t, 256>, PASSES> counts{};
+	for (size_t t = 0; t < count; t++) {
+		for (size_t p = 0; p < PASSES; p++) counts[p][(keys[t] >> (8 * p)) & 0xFF]++;
+	}
+
+	for (size_t p = 0; p < PASSES; p++) {
+		std::array<size_t, 256>& offsets = counts[p];
+		if (offsets[(keys[0] >> (8 * p)) & 0xFF] == count) {
+			continue;
+		}
+
+		size_t total = 0;
+		for (size_t& offset : offsets) {
+			size_t digits = offset;
+			offset = total;
+			total += digits;
+		}
+
+		for (size_t t = 0; t < count; t++) {
+			size_t pos = offsets[(keys[t] >> (8 * p)) & 0xFF]++;
+			keyScratch[pos] = keys[t];
+			if (withOrder) {
+				orderScratch[pos] = order[t];
+			}
+		}
+		keys.swap(keyScratch);
+		order.swap(orderScratch);
+	}
+}
+
+/// `radixSort` of one long run of keys on every thread of `parallelFor`. The keys are cut into
+/// tiles of `RADIX_SORT_TILE`. Each pass counts the digits of every tile in parallel, turns the
+/// counts into offsets, digit by digit and tile by tile, and scatters the tiles in parallel.
+/// Every tile writes its own slots, so the passes stay stable.
+template <typename K>
+inline void parallelRadixSort(std::vector<K>& keys, std::vector<K>& keyScratch,
+                              std::vector<int64_t>& order, std::vector<int64_t>& orderScratch) {
+	constexpr size_t PASSES = sizeof(K);
+	size_t count = keys.size();
+	size_t numTiles = (count + RADIX_SORT_TILE - 1) / RADIX_SORT_TILE;
+	bool withOrder = !order.empty();
+
+	auto forEachTile = [&](auto visit) {
+		parallelFor(numTiles, 1, [&](size_t firstTile, size_t lastTile) {
+			for (size_t tile = firstTile; tile < lastTile; tile++) {
+				visit(tile, tile * RADIX_SORT_TILE, std::min(count, (tile + 1) * RADIX_SORT_TILE));
+			}
+		});
+	};
+
+	// bits where any key differs from the first, bytes without any are skipped
+	std::vector<K> tileDiffs(numTiles);
+	forEachTile([&](size_t tile, size_t begin, size_t end) {
+		K diff = 0;
+		for (size_t t = begin; t < end; t++) diff |= keys[t] ^ keys[0];
+		tileDiffs[tile] = diff;
+	});
+	K diff = 0;
+	for (K tileDiff : tileDiffs) diff |= tileDiff;
+
+	// digit counts of each tile, recounted every pass as the keys move between tiles
+	std::vector<std::array<size_t, 256>> offsets(numTiles);
+
+	for (size_t p = 0; p < PASSES; p++) {
+		if (((diff >> (8 * p)) & 0xFF) == 0) {
+			continue;
+		}
+
+		forEachTile([&](size_t tile, size_t begin, size_t end) {
+			std::array<size_t, 256>& counts = offsets[tile];
+			counts.fill(0);
+			for (size_t t = begin; t < end; t++) counts[(keys[t] >> (8 * p)) & 0xFF]++;
+		});
+
+		size_t total = 0;
+		for (size_t digit = 0; digit < 256; digit++) {
+			for (size_t tile = 0; tile < numTiles; tile++) {
+				size_t digits = offsets[tile][digit];
+				offsets[tile][digit] = total;
+				total += digits;
+			}
+		}
+
+		forEachTile([&](size_t tile, size_t begin, size_t end) {
+			std::array<size_t, 256>& next = offsets[tile];
+			for (size_t t = begin; t < end; t++) {
+				size_t pos = next[(keys[t] >> (8 * p)) & 0xFF]++;
+				keyScratch[pos] = keys[t];
+				if (withOrder) {
+					orderScratch[pos] = order[t];
+				}
+			}
+		});
+		keys.swap(keyScratch);
+		order.swap(orderScratch);
+	}
+}
+
+/// Sorts each block of `blockCount` elements of `in` ascending, or descending if `descending`.
+/// Writes the sorted values to `values` and the index of each in its block to `indices`, either
+/// may be null. Both are contiguous in the shape of `layout`. The sort is stable and NaN order
+/// above every number.
+///
+/// Elements are sorted as `radixKey`, so long blocks take one LSD radix pass per key byte, O(n),
+/// skipping the bytes every key shares. Ranges of blocks run on separate threads, each reusing
+/// its key and index buffers across blocks. When there are fewer blocks than threads, blocks of
+/// `RADIX_SORT_PARALLEL_COUNT` and more are instead sorted one after the other, each split over
+/// all threads by `parallelRadixSort`.
+template <typename In>
+inline void sort(const In* in, const TensorLayout& layout, size_t blockCount, bool descending,
+                 In* values, int64_t* indices) {
+	using C = typename Compute<In>::type;
+	using K = RadixKey<C>;
+
+	if (blockCount == 0) {
+		return;
+	}
+
+	bool radix = blockCount >= RADIX_SORT_MIN_COUNT;
+	const K flip = descending ? ~K(0) : K(0);
+
+	size_t numBlocks = getNumElements(layout) / blockCount;
+	bool splitBlocks = !radix || blockCount < RADIX_SORT_PARALLEL_COUNT ||
+	                   numBlocks >= getNumThreads();
+
+	// the linear loops of a block sorted by all threads are split as well
+	auto forEachRange = [&](size_t count, auto visit) {
+		if (splitBlocks) {
+			visit(size_t{0}, count);
+		} else {
+			parallelFor(count, RADIX_SORT_TILE, visit);
+		}
+	};
+
+	auto sortBlocks = [&](size_t firstBlock, size_t lastBlock) {
+		std::vector<K> keys(blockCount);
+		std::vector<K> keyScratch(radix ? blockCount : 0);
+		std::vector<int64_t> order(indices != nullptr ? blockCount : 0);
+		std::vector<int64_t> orderScratch(radix && indices != nullptr ? blockCount : 0);
+		std::vector<std::pair<K, int64_t>> pairs(!radix && indices != nullptr ? blockCount : 0);
+
+		forEachBlock<C>(in, layout, blockCount, firstBlock, lastBlock, [&](const C* x,
+		                                                                   size_t block) {
+			forEachRange(blockCount, [&](size_t begin, size_t end) {
+				for (size_t t = begin; t < end; t++) keys[t] = radixKey(x[t]) ^ flip;
+				for (size_t t = begin; t < std::min(end, order.size()); t++) {
+					order[t] = static_cast<int64_t>(t);
+				}
+			});
+
+			if (!radix && indices == nullptr) {
+				// equal keys are equal values, so stability is free
+				std::sort(keys.begin(), keys.end());
+			} else if (!radix) {
+				for (size_t t = 0; t < blockCount; t++) pairs[t] = {keys[t], order[t]};
+				std::sort(pairs.begin(), pairs.end());
+				for (size_t t = 0; t < blockCount; t++) {
+					keys[t] = pairs[t].first;
+					order[t] = pairs[t].second;
+				}
+			} else if (splitBlocks) {
+				radixSort(keys, keyScratch, order, orderScratch);
+			} else {
+				parallelRadixSort(keys, keyScratch, order, orderScratch);
+			}
+
+			forEachRange(blockCount, [&](size_t begin, size_t end) {
+				if (values != nullptr) {
+					In* out = values + block * blockCount;
+					for (size_t t = begin; t < end; t++) {
+						out[t] = static_cast<In>(fromRadixKey<C>(keys[t] ^ flip));
+					}
+				}
+				if (indices != nullptr) {
+					std::copy(order.begin() + begin, order.begin() + end,
+					          indices + block * blockCount + begin);
+				}
+			});
+		});
+	};
+
+	if (splitBlocks) {
+		parallelFor(numBlocks, getBlockGrain(blockCount), sortBlocks);
+	} else {
+		sortBlocks(0, numBlocks);
+	}
+}
+
+/// Reorders each block of `blockCount` elements of `in` into the contiguous `values` so the
+/// element at `kth` is the one `sort` puts there, none before it larger and none after smaller.
+/// Selects on `radixKey` with `std::nth_element`, O(n) on average. Ranges of blocks run on
+/// separate threads, each reusing its own key buffer.
+template <typename In>
+inline void partition(const In* in, const TensorLayout& layout, size_t blockCount, size_t kth,
+                      In* values) {
+	using C = typename Compute<In>::type;
+	using K = RadixKey<C>;
+
+	if (blockCount == 0) {
+		return;
+	}
+
+	size_t numBlocks = getNumElements(layout) / blockCount;
+	parallelFor(numBlocks, getBlockGrain(blockCount), [&](size_t firstBlock, size_t lastBlock) {
+		std::vector<K> keys(blockCount);
+		forEachBlock<C>(in, layout, blockCount, firstBlock, lastBlock, [&](const C* x,
+		                                                                   size_t block) {
+			for (size_t t = 0; t < blockCount; t++) keys[t] = radixKey(x[t]);
+			std::nth_element(keys.begin(), keys.begin() + kth, keys.end());
+
+			In* out = values + block * blockCount;
+			for (size_t t = 0; t < blockCount; t++) {
+				out[t] = static_cast<In>(fromRadixKey<C>(keys[t]));
+			}
+		});
+	});
+}
+
+/// Lanes of the blocked scan of long rows, see `scanRow`.
+constexpr size_t SCAN_LANES = 8;
+
+/// Rows shorter than this many elements per lane are scanned in one chain.
+constexpr size_t SCAN_MIN_LANE_LENGTH = 256;
+
+/// Inclusive scan of `op` over the contiguous `x[0, count)` into `out`, which may be `x`.
+///
+/// A single chain waits on the latency of `op` for every element. Long rows are split into
+/// `SCAN_LANES` chunks that are scanned together, so the chains overlap, then the total of each
+/// chunk is carried into the ones after it by a loop that vectorizes. Float sums round in that
+/// order rather than strictly left to right.
+template <typename T, typename ScanOp>
+inline void scanRow(const T* x, T* out, size_t count, ScanOp op) {
+	if (count == 0) {
+		return;
+	}
+	if (count < SCAN_LANES * SCAN_MIN_LANE_LENGTH) {
+		T acc = x[0];
+		out[0] = acc;
+		for (size_t t = 1; t < count; t++) out[t] = acc = op(acc, x[t]);
+		return;
+	}
+
+	// the last chunk also takes the remainder
+	size_t chunk = count / SCAN_LANES;
+	T acc[SCAN_LANES];
+	for (size_t c = 0; c < SCAN_LANES; c++) out[c * chunk] = acc[c] = x[c * chunk];
+	for (size_t t = 1; t < chunk; t++) {
+		for (size_t c = 0; c < SCAN_LANES; c++) {
+			acc[c] = op(acc[c], x[c * chunk + t]);
+			out[c * chunk + t] = acc[c];
+		}
+	}
+	for (size_t t = SCAN_LANES * chunk; t < count; t++) out[t] = op(out[t - 1], x[t]);
+
+	T carry = out[chunk - 1];
+	for (size_t c = 1; c < SCAN_LANES; c++) {
+		size_t end = c + 1 == SCAN_LANES ? count : (c + 1) * chunk;
+		for (size_t t = c * chunk; t < end; t++) out[t] = op(carry, out[t]);
+		carry = out[end - 1];
+	}
+}
+
+/// Rows shorter than this are scanned by one thread, longer rows are split by `parallelScanRow`
+/// when there are fewer of them than threads.
+constexpr size_t SCAN_PARALLEL_LENGTH = size_t{1} << 16;
+
+/// Elements per tile of `parallelScanRow`.
+constexpr size_t SCAN_TILE = size_t{1} << 14;
+
+/// Columns per range of a scan along an outer dim.
+constexpr size_t SCAN_COLUMN_TILE = 1024;
+
+/// `scanRow` of one long row on every thread of `parallelFor`, in two passes. The first scans
+/// each tile of `SCAN_TILE` elements on its own, the totals of the tiles are then combined into
+/// the carry of each, and the second pass combines every tile with its carry.
+template <typename T, typename ScanOp>
+inline void parallelScanRow(const T* x, T* out, size_t count, ScanOp op) {
+	size_t numTiles = (count + SCAN_TILE - 1) / SCAN_TILE;
+	auto tileEnd = [&](size_t tile) { return std::min(count, (tile + 1) * SCAN_TILE); };
+
+	parallelFor(numTiles, 1, [&](size_t firstTile, size_t lastTile) {
+		for (size_t tile = firstTile; tile < lastTile; tile++) {
+			size_t begin = tile * SCAN_TILE;
+			scanRow(x + begin, out + begin, tileEnd(tile) - begin, op);
+		}
+	});
+
+	// carry of tile i is the total of tiles [0, i)
+	std::unique_ptr<T[]> carries(new T[numTiles]);
+	T carry = out[tileEnd(0) - 1];
+	for (size_t tile = 1; tile < numTiles; tile++) {
+		carries[tile] = carry;
+		carry = op(carry, out[tileEnd(tile) - 1]);
+	}
+
+	parallelFor(numTiles - 1, 1, [&](size_t firstTile, size_t lastTile) {
+		for (size_t tile = firstTile + 1; tile <= lastTile; tile++) {
+			T carry = carries[tile];
+			for (size_t t = tile * SCAN_TILE; t < tileEnd(tile); t++) out[t] = op(carry, out[t]);
+		}
+	});
+}
+
+/// Scan of `op` along dim `axis` of `layout`, inclusive or, if `exclusive`, shifted by one with
+/// `identity` first. Writes `out` contiguous in the shape of `layout`, computing in `Out`.
+///
+/// Contiguous input of type `Out` is read in place, anything else is converted into `out` first
+/// and scanned there. Along the last dim every row is a `scanRow`, ranges of rows run on separate
+/// threads, and rows of `SCAN_PARALLEL_LENGTH` and more are each split by `parallelScanRow` when
+/// there are fewer rows than threads. Along an outer dim a whole slice of the inner dims is
+/// combined with the previous one per step, a batch of independent rows that vectorizes, and
+/// ranges of `SCAN_COLUMN_TILE` columns run on separate threads.
+template <typename In, typename Out, typename ScanOp>
+inline void scan(const In* in, const TensorLayout& layout, size_t axis, Out* out, ScanOp op,
+                 Out identity, bool exclusive) {
+	const Out* x = out;
+	bool inPlace = false;
+	if constexpr (std::is_same_v<In, Out>) {
+		inPlace = isContiguous(layout);
+		x = in + layout.offset;
+	}
+	if (!inPlace) {
+		TensorLayout dense{Tensor::Shape(layout)};
+		unary(in, layout, out, dense, Identity{});
+		x = out;
+	}
+
+	size_t outer = 1;
+	for (size_t d = 0; d < axis; d++) outer *= layout.shape[d];
+	size_t inner = 1;
+	for (size_t d = axis + 1; d < layout.rank; d++) inner *= layout.shape[d];
+	size_t length = layout.shape[axis];
+	if (length == 0 || inner == 0) {
+		return;
+	}
+
+	if (inner == 1) {
+		auto shift = [&](Out* row) {
+			if (exclusive) {
+				std::copy_backward(row, row + length - 1, row + length);
+				row[0] = identity;
+			}
+		};
+
+		if (length < SCAN_PARALLEL_LENGTH || outer >= getNumThreads()) {
+			parallelFor(outer, getBlockGrain(length), [&](size_t firstRow, size_t lastRow) {
+				for (size_t o = firstRow; o < lastRow; o++) {
+					scanRow(x + o * length, out + o * length, length, op);
+					shift(out + o * length);
+				}
+			});
+		} else {
+			for (size_t o = 0; o < outer; o++) {
+				parallelScanRow(x + o * length, out + o * length, length, op);
+				shift(out + o * length);
+			}
+		}
+		return;
+	}
+
+	// columns [begin, end) of every step of one outer index are independent of the others
+	size_t columnTiles = (inner + SCAN_COLUMN_TILE - 1) / SCAN_COLUMN_TILE;
+	size_t grain = getBlockGrain(length * std::min(inner, SCAN_COLUMN_TILE));
+	parallelFor(outer * columnTiles, grain, [&](size_t first, size_t last) {
+		for (size_t unit = first; unit < last; unit++) {
+			size_t o = unit / columnTiles;
+			size_t begin = unit % columnTiles * SCAN_COLUMN_TILE;
+			size_t end = std::min(inner, begin + SCAN_COLUMN_TILE);
+			const Out* src = x + o * length * inner;
+			Out* base = out + o * length * inner;
+
+			std::copy(src + begin, src + end, base + begin);
+			for (size_t t = 1; t < length; t++) {
+				const Out* previous = base + (t - 1) * inner;
+				const Out* row = src + t * inner;
+				Out* result = base + t * inner;
+				for (size_t j = begin; j < end; j++) result[j] = op(previous[j], row[j]);
+			}
+
+			if (exclusive) {
+				for (size_t t = length - 1; t > 0; t--) {
+					std::copy(base + (t - 1) * inner + begin, base + (t - 1) * inner + end,
+					          base + t * inner + begin);
+				}
+				std::fill(base + begin, base + end, identity);
+			}
+		}
+	});
+}
+
+/// Index of the first element of `index` outside [0, size), or -1 if there is none. Returns the
+/// linear position in `layout`.
+inline int64_t findIndexOutOfRange(const int64_t* index, const TensorLayout& layout, size_t size) {
+	int64_t position = -1;
+	size_t row = 0;
+	forEachRow<1>({&layout}, [&](const auto& offsets, const auto& strides, size_t length) {
+		const int64_t* x = index + offsets[0];
+		for (size_t j = 0; j < length; j++) {
+			// negative indices wrap to large unsigned values
+			if (static_cast<uint64_t>(x[signedOffset(j * strides[0])]) >= size) {
+				position = static_cast<int64_t>(row * length + j);
+				return false;
+			}
+		}
+		row++;
+		return true;
+	});
+	return position;
+}
+
+/// `layout` with the shape of `indexLayout` and stride 0 along `dim`, so walking it alongside
+/// `indexLayout` gives the offset of each gathered element before its index is applied.
+inline TensorLayout gatherBase(const TensorLayout& layout, size_t dim,
+                               const TensorLayout& indexLayout) {
+	TensorLayout base = layout;
+	base.shape = indexLayout.shape;
+	base.strides[dim] = 0;
+	return base;
+}
+
+/// out = in with coordinate `dim` taken from `index`, iterating the shape of `indexLayout`.
+/// `out` is contiguous. The indices must be in range for dim `dim` of `layout`.
+///
+/// Rows along which the index does not change, as for an index broadcast over the inner dims,
+/// read the index once and copy the row.
+template <typename T>
+inline void gather(const T* in, const TensorLayout& layout, size_t dim, const int64_t* index,
+                   const TensorLayout& indexLayout, T* out) {
+	TensorLayout base = gatherBase(layout, dim, indexLayout);
+	TensorLayout dense{Tensor::Shape(indexLayout)};
+	size_t step = layout.strides[dim];
+
+	forEachRow<3>({&indexLayout, &base, &dense}, [&](const auto& offsets, const auto& strides,
+	                                                 size_t length) {
+		const int64_t* i = index + offsets[0];
+		const T* x = in + offsets[1];
+		T* o = out + offsets[2];
+
+		if (strides[0] == 0) {
+			x += i[0] * step;
+			if (strides[1] == 1) {
+				std::copy(x, x + length, o);
+			} else {
+				for (size_t j = 0; j < length; j++) o[j] = x[signedOffset(j * strides[1])];
+			}
+		} else {
+			for (size_t j = 0; j < length; j++) {
+				o[j] = x[signedOffset(j * strides[1] + i[signedOffset(j * strides[0])] * step)];
+			}
+		}
+	});
+}
+
+/// out = op(out, src) at the element `gather` reads for each position of `indexLayout`, computed
+/// in `ComputeType<T, S>`. `srcLayout` has the shape of `indexLayout`. Elements hit by several
+/// indices are updated in index order, so with `Assign` the last one wins. Single threaded, see
+/// `scatterAdd` for accumulation on several threads.
+template <typename T, typename S, typename BinaryOp>
+inline void scatter(T* out, const TensorLayout& layout, size_t dim, const int64_t* index,
+                    const TensorLayout& indexLayout, const S* src, const TensorLayout& srcLayout,
+                    BinaryOp op) {
+	using C = ComputeType<T, S>;
+
+	TensorLayout base = gatherBase(layout, dim, indexLayout);
+	size_t step = layout.strides[dim];
+
+	forEachRow<3>({&indexLayout, &base, &srcLayout}, [&](const auto& offsets, const auto& strides,
+	                                                     size_t length) {
+		const int64_t* i = index + offsets[0];
+		T* o = out + offsets[1];
+		const S* s = src + offsets[2];
+
+		for (size_t j = 0; j < length; j++) {
+			T& target = o[signedOffset(j * strides[1] + i[signedOffset(j * strides[0])] * step)];
+			C value = static_cast<C>(s[signedOffset(j * strides[2])]);
+			target = static_cast<T>(op(static_cast<C>(target), value));
+		}
+	});
+}
+
+/// Updates each private accumulator of `scatterAdd` should take at least, and at least as many
+/// as the target has elements.
+constexpr size_t SCATTER_MIN_UPDATES = size_t{1} << 14;
+
+/// `scatter` with `Add`, split over the threads of `parallelFor`.
+///
+/// Repeated indices would race, so the index is cut into one range per thread and each range
+/// accumulates into its own zeroed dense copy of the target in `ComputeType<T, S>`. The copies
+/// are then added into `out` in range order, so float sums round differently than one pass in
+/// index order. The copies cost memory and a merge pass in the size of the target, so the split
+/// only happens when every copy takes `SCATTER_MIN_UPDATES` updates and at least as many as the
+/// target has elements, anything smaller runs `scatter`.
+template <typename T, typename S>
+inline void scatterAdd(T* out, const TensorLayout& layout, size_t dim, const int64_t* index,
+                       const TensorLayout& indexLayout, const S* src,
+                       const TensorLayout& srcLayout) {
+	constexpr size_t CHUNK = 256;
+	using C = ComputeType<T, S>;
+
+	size_t count = getNumElements(indexLayout);
+	size_t targetCount = getNumElements(layout);
+	size_t numCopies =
+	    std::min(getNumThreads(), count / std::max(targetCount, SCATTER_MIN_UPDATES));
+	if (numCopies < 2) {
+		scatter(out, layout, dim, index, indexLayout, src, srcLayout, Add{});
+		return;
+	}
+
+	TensorLayout dense{Tensor::Shape(layout)};
+	TensorLayout denseBase = gatherBase(dense, dim, indexLayout);
+	size_t denseStep = dense.strides[dim];
+
+	// each copy takes a range of chunks, which may start and end inside an index row
+	size_t rank = indexLayout.rank;
+	size_t rowLength = indexLayout.shape[rank - 1];
+	size_t chunksPerRow = (rowLength + CHUNK - 1) / CHUNK;
+	size_t numChunks = count / rowLength * chunksPerRow;
+
+	std::vector<std::unique_ptr<C[]>> copies(numCopies);
+	parallelFor(numCopies, 1, [&](size_t firstCopy, size_t lastCopy) {
+		for (size_t copy = firstCopy; copy < lastCopy; copy++) {
+			copies[copy].reset(new C[targetCount]());
+			C* acc = copies[copy].get();
+
+			size_t begin = copy * numChunks / numCopies;
+			size_t end = (copy + 1) * numChunks / numCopies;
+			size_t row = begin / chunksPerRow;
+			size_t lastRow = (end + chunksPerRow - 1) / chunksPerRow;
+
+			forEachRow<3>({&indexLayout, &denseBase, &srcLayout}, row, lastRow,
+			              [&](const auto& offsets, const auto& strides, size_t length) {
+				const int64_t* i = index + offsets[0];
+				C* a = acc + offsets[1];
+				const S* x = src + offsets[2];
+
+				size_t rowStart = row * chunksPerRow;
+				size_t first = begin > rowStart ? (begin - rowStart) * CHUNK : 0;
+				size_t last = std::min(length, (end - rowStart) * CHUNK);
+				row++;
+
+				for (size_t j = first; j < last; j++) {
+					size_t position = j * strides[1] + i[signedOffset(j * strides[0])] * denseStep;
+					C& target = a[signedOffset(position)];
+					target = Add{}(target, static_cast<C>(x[signedOffset(j * strides[2])]));
+				}
+			});
+		}
+	});
+
+	size_t targetRowLength = layout.shape[layout.rank - 1];
+	size_t targetRows = targetRowLength > 0 ? targetCount / targetRowLength : 0;
+	parallelFor(targetRows, getBlockGrain(targetRowLength * numCopies),
+	            [&](size_t firstRow, size_t lastRow) {
+		forEachRow<2>({&layout, &dense}, firstRow, lastRow,
+		              [&](const auto& offsets, const auto& strides, size_t length) {
+			T* o = out + offsets[0];
+			for (size_t j = 0; j < length; j++) {
+				T& target = o[signedOffset(j * strides[0])];
+				C sum = static_cast<C>(target);
+				for (const auto& copy : copies) sum = Add{}(sum, copy[offsets[1] + j]);
+				target = static_cast<T>(sum);
+			}
+		});
+	});
+}
+
+/// Batch, row and column stride of a 2D or 3D matmul operand. A missing or size 1 batch dim
+/// has stride 0, so it is reused for every batch.
+inline std::array<size_t, 3> getMatrixStrides(const TensorLayout& layout) {
+	size_t rank = layout.rank;
+	size_t batch = rank == 3 && layout.shape[0] > 1 ? layout.strides[0] : 0;
+	return {batch, layout.strides[rank - 2], layout.strides[rank - 1]};
+}
+
+/// `ROWS` rows of `a`, each `k` long, times a packed panel of `k` rows of `TILE` columns, into
+/// `acc`. The accumulator tile is sized to stay in vector registers.
+template <size_t ROWS, size_t TILE, typename A>
+inline void matmulTile(const A* a, const A* panel, size_t k, A (&acc)[ROWS][TILE]) {
+	for (size_t r = 0; r < ROWS; r++) {
+		for (size_t j = 0; j < TILE; j++) acc[r][j] = 0;
+	}
+	for (size_t kk = 0; kk < k; kk++) {
+		const A* b = panel + kk * TILE;
+		for (size_t r = 0; r < ROWS; r++) {
+			A x = a[r * k + kk];
+			for (size_t j = 0; j < TILE; j++) acc[r][j] += x * b[j];
+		}
+	}
+}
+
+/// Batched matrix multiplication, (batch, m, k) @ (batch, k, p) => (batch, m, p). Products are
+/// accumulated in the wider `AccumulateType` of the operands.
+///
+/// Both operands are converted to the accumulate type while they are packed, so 16 bit floats
+/// are read once at half the bytes and computed in float. The lhs is packed row-major, the rhs
+/// into panels of `TILE` columns that stay in L2 while every group of rows passes over them.
+template <typename L, typename R, typename O>
+inline void matmul(const L* lhs, const TensorLayout& lhsLayout, const R* rhs,
+                   const TensorLayout& rhsLayout, O* out, const TensorLayout& outLayout,
+                   size_t batch, size_t m, size_t k, size_t p) {
+	using A = std::common_type_t<AccumulateType<L>, AccumulateType<R>>;
+
+	// 4 rows of 256 bytes of accumulators, 16 AVX-512 registers
+	constexpr size_t ROWS = 4;
+	constexpr size_t TILE = 256 / sizeof(A);
+
+	auto lhsStrides = getMatrixStrides(lhsLayout);
+	auto rhsStrides = getMatrixStrides(rhsLayout);
+	auto outStrides = getMatrixStrides(outLayout);
+
+	std::vector<A> packedLhs(m * k);
+	std::vector<A> panel(k * TILE);
+
+	for (size_t bat = 0; bat < batch; bat++) {
+		if (bat == 0 || lhsStrides[0] != 0) {
+			const L* base = lhs + (lhsLayout.offset + bat * lhsStrides[0]);
+			for (size_t i = 0; i < m; i++) {
+				for (size_t kk = 0; kk < k; kk++) {
+					packedLhs[i * k + kk] =
+					    static_cast<A>(base[signedOffset(i * lhsStrides[1] + kk * lhsStrides[2])]);
+				}
+			}
+		}
+
+		const R* rhsBase = rhs + (rhsLayout.offset + bat * rhsStrides[0]);
+		O* outBase = out + (outLayout.offset + bat * outStrides[0]);
+
+		for (size_t col = 0; col < p; col += TILE) {
+			size_t width = std::min(TILE, p - col);
+
+			// columns past `width` stay zero and are computed but never stored
+			for (size_t kk = 0; kk < k; kk++) {
+				const R* row = rhsBase + signedOffset(kk * rhsStrides[1] + col * rhsStrides[2]);
+				for (size_t j = 0; j < width; j++) {
+					panel[kk * TILE + j] = static_cast<A>(row[signedOffset(j * rhsStrides[2])]);
+				}
+				std::fill(panel.begin() + kk * TILE + width, panel.begin() + (kk + 1) * TILE, A{});
+			}
+
+			auto store = [&](size_t i, const A* acc) {
+				O* row = outBase + signedOffset(i * outStrides[1] + col * outStrides[2]);
+				for (size_t j = 0; j < width; j++) {
+					row[signedOffset(j * outStrides[2])] = static_cast<O>(acc[j]);
+				}
+			};
+
+			size_t i = 0;
+			for (; i + ROWS <= m; i += ROWS) {
+				A acc[ROWS][TILE];
+				matmulTile(packedLhs.data() + i * k, panel.data(), k, acc);
+				for (size_t r = 0; r < ROWS; r++) store(i + r, acc[r]);
+			}
+			for (; i < m; i++) {
+				A acc[1][TILE];
+				matmulTile(packedLhs.data() + i * k, panel.data(), k, acc);
+				store(i, acc[0]);
+			}
+		}
+	}
+}
+
+// Convolution
+
+/// Input channels times kernel taps from which `conv2d` lowers to im2col and `matmul`. Below it
+/// the direct path does fewer operations per output than a matmul tile could save.
+constexpr size_t CONV_GEMM_MIN_DEPTH = 64;
+
+/// Output positions the direct path accumulates at a time, their accumulators stay in L1.
+constexpr size_t CONV_DIRECT_BLOCK = 512;
+
+/// Bytes of the im2col matrix built per matmul, output positions are processed in chunks that
+/// fit.
+constexpr size_t CONV_COLUMNS_BYTES = size_t(4) << 20;
+
+/// Copies sample `n` of the 4D `layout` into `padded`, its channels of
+/// (height + 2 * padding[0]) x (width + 2 * padding[1]) elements of type `A` with zero borders.
+template <typename I, typename A>
+inline void padConvInput(const I* in, const TensorLayout& layout, size_t n,
+                         const Tensor::Impl::Convolution& conv, A* padded) {
+	size_t paddedHeight = conv.height + 2 * conv.padding[0];
+	size_t paddedWidth = conv.width + 2 * conv.padding[1];
+	std::fill(padded, padded + conv.inChannels * paddedHeight * paddedWidth, A{});
+
+	for (size_t c = 0; c < conv.inChannels; c++) {
+		for (size_t y = 0; y < conv.height; y++) {
+			const I* row = in + (layout.offset + n * layout.strides[0] + c * layout.strides[1] +
+			                     y * layout.strides[2]);
+			A* target = padded + (c * paddedHeight + y + conv.padding[0]) * paddedWidth +
+			            conv.padding[1];
+			for (size_t x = 0; x < conv.width; x++) {
+				target[x] = static_cast<A>(row[signedOffset(x * layout.strides[3])]);
+			}
+		}
+	}
+}
+
+/// Direct convolution of one padded sample into the (outChannels, outHeight, outWidth) `out`.
+///
+/// Each block of `CONV_DIRECT_BLOCK` outputs of a row accumulates every tap before it is
+/// stored, so the input is read once per tap from L1 instead of once per tap from memory. With
+/// stride 1 the tap loop is a contiguous multiply add that vectorizes.
+template <typename A, typename O>
+inline void convDirect(const A* padded, const A* weight, O* out,
+                       const Tensor::Impl::Convolution& conv) {
+	size_t paddedHeight = conv.height + 2 * conv.padding[0];
+	size_t paddedWidth = conv.width + 2 * conv.padding[1];
+	size_t taps = conv.kernelHeight * conv.kernelWidth;
+	size_t strideX = conv.stride[1];
+
+	A acc[CONV_DIRECT_BLOCK];
+	for (size_t o = 0; o < conv.outChannels; o++) {
+		for (size_t oy = 0; oy < conv.outHeight; oy++) {
+			O* row = out + (o * conv.outHeight + oy) * conv.outWidth;
+
+			for (size_t x0 = 0; x0 < conv.outWidth; x0 += CONV_DIRECT_BLOCK) {
+				size_t count = std::min(CONV_DIRECT_BLOCK, conv.outWidth - x0);
+				std::fill(acc, acc + count, A{});
+
+				for (size_t c = 0; c < conv.inChannels; c++) {
+					const A* w = weight + (o * conv.inChannels + c) * taps;
+					for (size_t ky = 0; ky < conv.kernelHeight; ky++) {
+						size_t y = oy * conv.stride[0] + ky * conv.dilation[0];
+						const A* line = padded + (c * paddedHeight + y) * paddedWidth;
+						line += x0 * strideX;
+						for (size_t kx = 0; kx < conv.kernelWidth; kx++) {
+							A tap = w[ky * conv.kernelWidth + kx];
+							const A* x = line + kx * conv.dilation[1];
+							if (strideX == 1) {
+								for (size_t j = 0; j < count; j++) acc[j] += tap * x[j];
+							} else {
+								for (size_t j = 0; j < count; j++) acc[j] += tap * x[j * strideX];
+							}
+						}
+					}
+				}
+
+				for (size_t j = 0; j < count; j++) row[x0 + j] = static_cast<O>(acc[j]);
+			}
+		}
+	}
+}
+
+/// Convolution of one padded sample as a matmul, (outChannels, depth) weights @ (depth,
+/// positions) im2col columns, with depth = inChannels * taps. Output positions are processed in
+/// chunks so the columns stay within `CONV_COLUMNS_BYTES`.
+template <typename A, typename O>
+inline void convGemm(const A* padded, const A* weight, O* out,
+                     const Tensor::Impl::Convolution& conv) {
+	size_t paddedHeight = conv.height + 2 * conv.padding[0];
+	size_t paddedWidth = conv.width + 2 * conv.padding[1];
+	size_t depth = conv.inChannels * conv.kernelHeight * conv.kernelWidth;
+	size_t positions = conv.outHeight * conv.outWidth;
+	size_t chunk = std::max<size_t>(64, CONV_COLUMNS_BYTES / (depth * sizeof(A)));
+	chunk = std::min(chunk, positions);
+
+	TensorLayout weightLayout{Tensor::Shape({conv.outChannels, depth})};
+	std::vector<A> columns(depth * chunk);
+
+	for (size_t p0 = 0; p0 < positions; p0 += chunk) {
+		size_t width = std::min(chunk, positions - p0);
+
+		// row (c, ky, kx) of the columns holds that tap for every position of the chunk
+		for (size_t c = 0; c < conv.inChannels; c++) {
+			for (size_t ky = 0; ky < conv.kernelHeight; ky++) {
+				for (size_t kx = 0; kx < conv.kernelWidth; kx++) {
+					size_t r = (c * conv.kernelHeight + ky) * conv.kernelWidth + kx;
+					A* target = columns.data() + r * width;
+
+					size_t oy = p0 / conv.outWidth;
+					size_t ox = p0 % conv.outWidth;
+					for (size_t q = 0; q < width; q++) {
+						size_t y = oy * conv.stride[0] + ky * conv.dilation[0];
+						size_t x = ox * conv.stride[1] + kx * conv.dilation[1];
+						target[q] = padded[(c * paddedHeight + y) * paddedWidth + x];
+						if (++ox == conv.outWidth) {
+							ox = 0;
+							oy++;
+						}
+					}
+				}
+			}
+		}
+
+		TensorLayout columnsLayout{Tensor::Shape({depth, width})};
+		TensorLayout outLayout(Tensor::Shape({conv.outChannels, width}), {positions, 1}, p0);
+		matmul(weight, weightLayout, columns.data(), columnsLayout, out, outLayout, 1,
+		       conv.outChannels, depth, width);
+	}
+}
+
+/// 2D convolution of the 4D `layout` with the 4D `weightLayout` into the contiguous `out`, see
+/// `Tensor::Impl::Convolution`. Accumulates in the wider `AccumulateType` of the operands.
+///
+/// Weights are packed once and every sample is copied into a zero padded buffer, so neither path
+/// checks bounds. Deep convolutions, many channels times taps, lower to im2col and the blocked
+/// `matmul`, shallow ones such as a single channel 3x3 or 5 tap filter take the direct path.
+template <typename I, typename W, typename O>
+inline void conv2d(const I* in, const TensorLayout& layout, const W* weight,
+                   const TensorLayout& weightLayout, O* out,
+                   const Tensor::Impl::Convolution& conv) {
+	using A = std::common_type_t<AccumulateType<I>, AccumulateType<W>>;
+
+	size_t taps = conv.kernelHeight * conv.kernelWidth;
+	size_t depth = conv.inChannels * taps;
+
+	// row-major (outChannels, inChannels, kernelHeight, kernelWidth)
+	std::vector<A> packedWeight(conv.outChannels * depth);
+	TensorLayout packedLayout{Tensor::Shape(weightLayout)};
+	unary(weight, weightLayout, packedWeight.data(), packedLayout, Identity{});
+
+	size_t paddedSize = conv.inChannels * (conv.height + 2 * conv.padding[0]) *
+	                    (conv.width + 2 * conv.padding[1]);
+	std::vector<A> padded(paddedSize);
+	size_t sampleSize = conv.outChannels * conv.outHeight * conv.outWidth;
+
+	for (size_t n = 0; n < conv.batch; n++) {
+		padConvInput(in, layout, n, conv, padded.data());
+		if (depth >= CONV_GEMM_MIN_DEPTH) {
+			convGemm(padded.data(), packedWeight.data(), out + n * sampleSize, conv);
+		} else {
+			convDirect(padded.data(), packedWeight.data(), out + n * sampleSize, conv);
+		}
+	}
+}
+
+// Int8 matmul epilogues, called with the int32 result of output column `col`
+
+/// Stores the int32 result.
+struct StoreInt32 {
+	int32_t operator()(int32_t acc, size_t) const { return acc; }
+};
+
+/// Requantizes to `Q`, round(acc * multiplier) + zeroPoint. `stride` is 0 for one multiplier
+/// and 1 for one per column.
+template <typename Q>
+struct Requantize {
+	const float* multiplier;
+	size_t stride;
+	float zeroPoint;
+
+	Q operator()(int32_t acc, size_t col) const {
+		return saturate<Q>(static_cast<float>(acc) * multiplier[col * stride] + zeroPoint);
+	}
+};
+
+/// Dot products of `a` with the `N` rows of `b` starting at `b`, each `k` long and `stride`
+/// apart. Unsigned times signed bytes into int32 is the pattern compilers map to VNNI
+/// `vpdpbusd`, or to `pmaddubsw` class instructions without it.
+template <size_t N>
+inline void dotInt8(const uint8_t* a, const int8_t* b, size_t stride, size_t k, int32_t* out) {
+	std::array<int32_t, N> sums{};
+	for (size_t kk = 0; kk < k; kk++) {
+		int32_t x = a[kk];
+		for (size_t n = 0; n < N; n++) sums[n] += x * b[n * stride + kk];
+	}
+	for (size_t n = 0; n < N; n++) out[n] = sums[n];
+}
+
+/// Batched int8 matrix multiplication, (batch, m, k) @ (batch, k, p) => (batch, m, p), computing
+/// (lhs - lhsZeroPoint) @ (rhs - rhsZeroPoint) with int32 accumulation. `L` is int8_t or
+/// uint8_t. Each result passes through `epilogue(acc, col)` on its way to `out`.
+///
+/// The rhs is packed transposed so every column is a contiguous run of k bytes, and the lhs rows
+/// are packed as unsigned bytes, int8 shifted by 128. Raw dot products of the packed bytes are
+/// corrected for both zero points afterwards from row and column sums:
+///
+///   sum (a - za)(b - zb) = sum ab - za sum b - zb sum a + k za zb
+///
+/// Products are exact as long as k * 255 * 128 fits int32, k <= 65793, which the caller checks.
+/// Corrected results outside of int32 saturate.
+template <typename L, typename O, typename Epilogue>
+inline void matmulInt8(const L* lhs, const TensorLayout& lhsLayout, const int8_t* rhs,
+                       const TensorLayout& rhsLayout, O* out, const TensorLayout& outLayout,
+                       size_t batch, size_t m, size_t k, size_t p, int32_t lhsZeroPoint,
+                       int32_t rhsZeroPoint, Epilogue epilogue) {
+	static_assert(std::is_same_v<L, int8_t> || std::is_same_v<L, uint8_t>);
+
+	// columns per block of the packed rhs, sized to stay in L2 while every row passes over it
+	constexpr size_t BLOCK_BYTES = 256 * 1024;
+	constexpr size_t COLUMNS = 4;
+
+	auto lhsStrides = getMatrixStrides(lhsLayout);
+	auto rhsStrides = getMatrixStrides(rhsLayout);
+	auto outStrides = getMatrixStrides(outLayout);
+
+	constexpr int32_t SHIFT = std::is_same_v<L, int8_t> ? 128 : 0;
+	int64_t zeroA = static_cast<int64_t>(lhsZeroPoint) + SHIFT;
+	int64_t zeroB = rhsZeroPoint;
+
+	std::vector<uint8_t> packedLhs(m * k);
+	std::vector<int64_t> rowSums(m);
+	std::vector<int8_t> packedRhs(p * k);
+	std::vector<int64_t> colSums(p);
+
+	size_t blockColumns = std::max<size_t>(COLUMNS, BLOCK_BYTES / std::max<size_t>(k, 1));
+
+	for (size_t bat = 0; bat < batch; bat++) {
+		if (bat == 0 || lhsStrides[0] != 0) {
+			const L* base = lhs + (lhsLayout.offset + bat * lhsStrides[0]);
+			for (size_t i = 0; i < m; i++) {
+				int64_t sum = 0;
+				for (size_t kk = 0; kk < k; kk++) {
+					L x = base[signedOffset(i * lhsStrides[1] + kk * lhsStrides[2])];
+					uint8_t value = static_cast<uint8_t>(static_cast<int32_t>(x) + SHIFT);
+					packedLhs[i * k + kk] = value;
+					sum += value;
+				}
+				rowSums[i] = sum;
+			}
+		}
+
+		if (bat == 0 || rhsStrides[0] != 0) {
+			const int8_t* base = rhs + (rhsLayout.offset + bat * rhsStrides[0]);
+			std::fill(colSums.begin(), colSums.end(), 0);
+			for (size_t kk = 0; kk < k; kk++) {
+				for (size_t j = 0; j < p; j++) {
+					int8_t value = base[signedOffset(kk * rhsStrides[1] + j * rhsStrides[2])];
+					packedRhs[j * k + kk] = value;
+					colSums[j] += value;
+				}
+			}
+		}
+
+		O* outBase = out + (outLayout.offset + bat * outStrides[0]);
+		auto store = [&](size_t i, size_t j, int32_t dot) {
+			int64_t acc = dot - zeroA * colSums[j] - zeroB * rowSums[i] +
+			              static_cast<int64_t>(k) * zeroA * zeroB;
+			acc = std::clamp<int64_t>(acc, std::numeric_limits<int32_t>::min(),
+			                          std::numeric_limits<int32_t>::max());
+			outBase[signedOffset(i * outStrides[1] + j * outStrides[2])] =
+			    epilogue(static_cast<int32_t>(acc), j);
+		};
+
+		for (size_t blockStart = 0; blockStart < p; blockStart += blockColumns) {
+			size_t blockEnd = std::min(p, blockStart + blockColumns);
+
+			for (size_t i = 0; i < m; i++) {
+				const uint8_t* a = packedLhs.data() + i * k;
+
+				size_t j = blockStart;
+				for (; j + COLUMNS <= blockEnd; j += COLUMNS) {
+					int32_t dots[COLUMNS];
+					dotInt8<COLUMNS>(a, packedRhs.data() + j * k, k, k, dots);
+					for (size_t c = 0; c < COLUMNS; c++) store(i, j + c, dots[c]);
+				}
+				for (; j < blockEnd; j++) {
+					int32_t dot;
+					dotInt8<1>(a, packedRhs.data() + j * k, k, k, &dot);
+					store(i, j, dot);
+				}
+			}
+		}
+	}
+}
+
+// Linear algebra
+//
+// Factorizations and solves of contiguous row-major matrices in float or double. They are
+// blocked by `LINALG_BLOCK` columns: each panel is factorized by scalar loops, the trailing
+// matrix is updated by `matmul`, split over the threads of `parallelFor`. Batches of small
+// matrices run one matrix per thread instead.
+
+/// Columns per panel of the blocked factorizations and rows per block of triangular solves.
+constexpr size_t LINALG_BLOCK = 64;
+
+/// Multiply-adds of an update below which it stays on the calling thread.
+constexpr size_t LINALG_PARALLEL_WORK = size_t{1} << 18;
+
+/// Matrix with element (i, j) at `data[i * rowStride + j * colStride]`, swapping the strides
+/// transposes it.
+template <typename T>
+struct MatrixRef {
+	T* data;
+	size_t rowStride;
+	size_t colStride = 1;
+
+	T& operator()(size_t i, size_t j) const { return data[i * rowStride + j * colStride]; }
+
+	/// Sub matrix starting at element (i, j).
+	MatrixRef block(size_t i, size_t j) const { return {&(*this)(i, j), rowStride, colStride}; }
+
+	MatrixRef transposed() const { return {data, colStride, rowStride}; }
+
+	/// Layout of its first `rows` x `cols` elements for `matmul`.
+	TensorLayout layout(size_t rows, size_t cols) const {
+		return TensorLayout({rows, cols}, {rowStride, colStride}, 0, 2);
+	}
+};
+
+/// c = a @ b, or c -= a @ b if `subtract`, for (m, k) @ (k, n). Large products split the longer
+/// side of `c` over threads.
+template <typename T>
+inline void gemm(MatrixRef<T> c, MatrixRef<T> a, MatrixRef<T> b, size_t m, size_t k, size_t n,
+                 bool subtract) {
+	if (m == 0 || n == 0 || (k == 0 && subtract)) {
+		return;
+	}
+
+	bool byColumns = n >= m;
+	size_t length = byColumns ? n : m;
+	size_t grain = m * k * n < LINALG_PARALLEL_WORK ? length : LINALG_BLOCK;
+
+	parallelFor(length, grain, [&](size_t begin, size_t end) {
+		size_t rows = byColumns ? m : end - begin;
+		size_t cols = byColumns ? end - begin : n;
+		MatrixRef<T> lhs = byColumns ? a : a.block(begin, 0);
+		MatrixRef<T> rhs = byColumns ? b.block(0, begin) : b;
+		MatrixRef<T> out = byColumns ? c.block(0, begin) : c.block(begin, 0);
+
+		if (!subtract) {
+			matmul(lhs.data, lhs.layout(rows, k), rhs.data, rhs.layout(k, cols), out.data,
+			       out.layout(rows, cols), 1, rows, k, cols);
+			return;
+		}
+
+		std::vector<T> product(rows * cols);
+		MatrixRef<T> result{product.data(), cols};
+		matmul(lhs.data, lhs.layout(rows, k), rhs.data, rhs.layout(k, cols), result.data,
+		       result.layout(rows, cols), 1, rows, k, cols);
+		for (size_t i = 0; i < rows; i++) {
+			for (size_t j = 0; j < cols; j++) out(i, j) -= result(i, j);
+		}
+	});
+}
+
+/// Calls `factor(b)` for every matrix b of `batch`, each `size` rows long. Batches of at least
+/// one matrix per thread, or of matrices within one block, run a matrix per thread, otherwise
+/// the matrices run in order and parallelize their updates.
+template <typename Factor>
+inline void forEachMatrix(size_t batch, size_t size, Factor factor) {
+	if (batch < getNumThreads() && size > LINALG_BLOCK) {
+		for (size_t b = 0; b < batch; b++) factor(b);
+		return;
+	}
+	parallelFor(batch, 1, [&](size_t begin, size_t end) {
+		for (size_t b = begin; b < end; b++) factor(b);
+	});
+}
+
+/// Lower Cholesky factor of the symmetric positive definite (n, n) `a` in place, reading its
+/// lower triangle and zeroing the upper one. Returns false, leaving `a` partly factorized, at
+/// the first pivot that is not positive.
+template <typename T>
+inline bool choleskyMatrix(MatrixRef<T> a, size_t n) {
+	for (size_t j0 = 0; j0 < n; j0 += LINALG_BLOCK) {
+		size_t jb = std::min(LINALG_BLOCK, n - j0);
+
+		// diagonal block, the columns left of it are already subtracted
+		for (size_t j = j0; j < j0 + jb; j++) {
+			T d = a(j, j);
+			for (size_t p = j0; p < j; p++) d -= a(j, p) * a(j, p);
+			if (!(d > 0)) {
+				return false;
+			}
+			d = std::sqrt(d);
+			a(j, j) = d;
+
+			for (size_t i = j + 1; i < j0 + jb; i++) {
+				T s = a(i, j);
+				for (size_t p = j0; p < j; p++) s -= a(i, p) * a(j, p);
+				a(i, j) = s / d;
+			}
+		}
+
+		size_t rest = n - j0 - jb;
+		if (rest == 0) {
+			break;
+		}
+
+		// panel below the diagonal block, L21 = A21 L11^-T row by row
+		size_t panelGrain = rest * jb * jb < LINALG_PARALLEL_WORK ? rest : LINALG_BLOCK;
+		parallelFor(rest, panelGrain, [&](size_t begin, size_t end) {
+			for (size_t i = j0 + jb + begin; i < j0 + jb + end; i++) {
+				for (size_t j = j0; j < j0 + jb; j++) {
+					T s = a(i, j);
+					for (size_t p = j0; p < j; p++) s -= a(i, p) * a(j, p);
+					a(i, j) = s / a(j, j);
+				}
+			}
+		});
+
+		// lower triangle of A22 -= L21 L21^T, one block column at a time
+		MatrixRef<T> panel = a.block(j0 + jb, j0);
+		size_t numBlocks = (rest + LINALG_BLOCK - 1) / LINALG_BLOCK;
+		size_t updateGrain = rest * rest * jb / 2 < LINALG_PARALLEL_WORK ? numBlocks : 1;
+		parallelFor(numBlocks, updateGrain, [&](size_t begin, size_t end) {
+			for (size_t blk = begin; blk < end; blk++) {
+				size_t c0 = blk * LINALG_BLOCK;
+				size_t cb = std::min(LINALG_BLOCK, rest - c0);
+				gemm(a.block(j0 + jb + c0, j0 + jb + c0), panel.block(c0, 0),
+				     panel.block(c0, 0).transposed(), rest - c0, jb, cb, true);
+			}
+		});
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = i + 1; j < n; j++) a(i, j) = 0;
+	}
+	return true;
+}
+
+/// Cholesky factors of `batch` contiguous (n, n) matrices in place, see `choleskyMatrix`.
+/// Returns false if any matrix is not positive definite.
+template <typename T>
+inline bool cholesky(T* data, size_t batch, size_t n) {
+	std::atomic<bool> positive{true};
+	forEachMatrix(batch, n, [&](size_t b) {
+		if (!choleskyMatrix(MatrixRef<T>{data + b * n * n, n}, n)) {
+			positive.store(false, std::memory_order_relaxed);
+		}
+	});
+	return positive.load();
+}
+
+/// LU factorization with partial pivoting of the (n, n) `a` in place, P a = L U with the unit
+/// lower triangular L below the diagonal and U on and above it. Row i of P a is row `perm[i]`
+/// of `a`. A column without a non-zero pivot is skipped, leaving a zero on the diagonal of U.
+template <typename T>
+inline void luMatrix(MatrixRef<T> a, int64_t* perm, size_t n) {
+	for (size_t i = 0; i < n; i++) perm[i] = static_cast<int64_t>(i);
+
+	for (size_t j0 = 0; j0 < n; j0 += LINALG_BLOCK) {
+		size_t jb = std::min(LINALG_BLOCK, n - j0);
+
+		// panel of columns [j0, j0 + jb), rows are swapped whole
+		for (size_t j = j0; j < j0 + jb; j++) {
+			size_t pivot = j;
+			T largest = std::abs(a(j, j));
+			for (size_t i = j + 1; i < n; i++) {
+				if (std::abs(a(i, j)) > largest) {
+					largest = std::abs(a(i, j));
+					pivot = i;
+				}
+			}
+			if (pivot != j) {
+				for (size_t c = 0; c < n; c++) std::swap(a(j, c), a(pivot, c));
+				std::swap(perm[j], perm[pivot]);
+			}
+
+			T d = a(j, j);
+			if (d == 0) {
+				continue;
+			}
+			for (size_t i = j + 1; i < n; i++) {
+				T l = a(i, j) / d;
+				a(i, j) = l;
+				for (size_t c = j + 1; c < j0 + jb; c++) a(i, c) -= l * a(j, c);
+			}
+		}
+
+		size_t rest = n - j0 - jb;
+		if (rest == 0) {
+			break;
+		}
+
+		// per range of trailing columns, U12 = L11^-1 A12, then A22 -= L21 U12
+		size_t grain = rest * rest * jb < LINALG_PARALLEL_WORK ? rest : LINALG_BLOCK;
+		parallelFor(rest, grain, [&](size_t begin, size_t end) {
+			size_t c0 = j0 + jb + begin;
+			size_t c1 = j0 + jb + end;
+			for (size_t r = j0 + 1; r < j0 + jb; r++) {
+				for (size_t p = j0; p < r; p++) {
+					T l = a(r, p);
+					for (size_t c = c0; c < c1; c++) a(r, c) -= l * a(p, c);
+				}
+			}
+			gemm(a.block(j0 + jb, c0), a.block(j0 + jb, j0), a.block(j0, c0), rest, jb, c1 - c0,
+			     true);
+		});
+	}
+}
+
+/// LU factorizations of `batch` contiguous (n, n) matrices in place, see `luMatrix`. `perm`
+/// holds n indices per matrix.
+template <typename T>
+inline void lu(T* data, int64_t* perm, size_t batch, size_t n) {
+	forEachMatrix(batch, n,
+	              [&](size_t b) { luMatrix(MatrixRef<T>{data + b * n * n, n}, perm + b * n, n); });
+}
+
+/// Solves a x = b for the triangular (n, n) `a`, overwriting the (n, k) `b` with x. Reads the
+/// lower triangle if `lower`, else the upper one, and takes its diagonal as ones if
+/// `unitDiagonal`.
+template <typename T>
+inline void solveTriangularMatrix(MatrixRef<T> a, MatrixRef<T> b, size_t n, size_t k, bool lower,
+                                  bool unitDiagonal) {
+	size_t numBlocks = (n + LINALG_BLOCK - 1) / LINALG_BLOCK;
+
+	for (size_t step = 0; step < numBlocks; step++) {
+		size_t i0 = (lower ? step : numBlocks - 1 - step) * LINALG_BLOCK;
+		size_t ib = std::min(LINALG_BLOCK, n - i0);
+
+		// rows of the diagonal block, in the order they resolve
+		for (size_t s = 0; s < ib; s++) {
+			size_t i = lower ? i0 + s : i0 + ib - 1 - s;
+			size_t first = lower ? i0 : i + 1;
+			size_t last = lower ? i : i0 + ib;
+			for (size_t p = first; p < last; p++) {
+				T l = a(i, p);
+				for (size_t c = 0; c < k; c++) b(i, c) -= l * b(p, c);
+			}
+			if (!unitDiagonal) {
+				T d = a(i, i);
+				for (size_t c = 0; c < k; c++) b(i, c) /= d;
+			}
+		}
+
+		// the solved rows leave the ones still to solve
+		if (lower) {
+			gemm(b.block(i0 + ib, 0), a.block(i0 + ib, i0), b.block(i0, 0), n - i0 - ib, ib, k,
+			     true);
+		} else {
+			gemm(b, a.block(0, i0), b.block(i0, 0), i0, ib, k, true);
+		}
+	}
+}
+
+/// Triangular solves of `batch` contiguous (n, n) matrices `a` against contiguous (n, k)
+/// matrices `b` in place, see `solveTriangularMatrix`. Returns false without solving anything if
+/// a diagonal element is zero and not `unitDiagonal`.
+template <typename T>
+inline bool solveTriangular(const T* a, T* b, size_t batch, size_t n, size_t k, bool lower,
+                            bool unitDiagonal) {
+	if (!unitDiagonal) {
+		for (size_t i = 0; i < batch * n; i++) {
+			if (a[(i / n) * n * n + (i % n) * (n + 1)] == 0) {
+				return false;
+			}
+		}
+	}
+
+	forEachMatrix(batch, n, [&](size_t m) {
+		MatrixRef<T> lhs{const_cast<T*>(a) + m * n * n, n};
+		solveTriangularMatrix(lhs, MatrixRef<T>{b + m * n * k, k}, n, k, lower, unitDiagonal);
+	});
+	return true;
+}
+
+/// Householder QR of the (rows, cols) panel `p` in place, rows >= cols. Reflector j is
+/// I - tau[j] v v^T with v = (1, p(j + 1:, j)), R ends up on and above the diagonal.
+template <typename T>
+inline void householderPanel(MatrixRef<T> p, T* tau, size_t rows, size_t cols) {
+	std::vector<T> w(cols);
+
+	for (size_t j = 0; j < cols; j++) {
+		T alpha = p(j, j);
+		T sigma = 0;
+		for (size_t i = j + 1; i < rows; i++) sigma += p(i, j) * p(i, j);
+		if (sigma == 0) {
+			tau[j] = 0;
+			continue;
+		}
+
+		// beta takes the sign opposite to alpha, so alpha - beta does not cancel
+		T norm = std::sqrt(alpha * alpha + sigma);
+		T beta = alpha >= 0 ? -norm : norm;
+		tau[j] = (beta - alpha) / beta;
+		T scale = 1 / (alpha - beta);
+		for (size_t i = j + 1; i < rows; i++) p(i, j) *= scale;
+		p(j, j) = beta;
+
+		// remaining panel columns, w = tau v^T p then p -= v w
+		for (size_t c = j + 1; c < cols; c++) w[c] = p(j, c);
+		for (size_t i = j + 1; i < rows; i++) {
+			T v = p(i, j);
+			for (size_t c = j + 1; c < cols; c++) w[c] += v * p(i, c);
+		}
+		for (size_t c = j + 1; c < cols; c++) {
+			w[c] *= tau[j];
+			p(j, c) -= w[c];
+		}
+		for (size_t i = j + 1; i < rows; i++) {
+			T v = p(i, j);
+			for (size_t c = j + 1; c < cols; c++) p(i, c) -= v * w[c];
+		}
+	}
+}
+
+/// Applies the product H_0 ... H_{jb - 1} of the reflectors `householderPanel` left in the
+/// (rows, jb) `reflectors` to the (rows, cols) `c`, or its transpose if `transpose`. The product
+/// is I - V T V^T with V the unit lower trapezoidal vectors and T upper triangular, so it takes
+/// two `gemm` calls.
+template <typename T>
+inline void applyReflectors(MatrixRef<T> reflectors, const T* tau, size_t rows, size_t jb,
+                            MatrixRef<T> c, size_t cols, bool transpose) {
+	if (cols == 0) {
+		return;
+	}
+
+	std::vector<T> vData(rows * jb);
+	MatrixRef<T> v{vData.data(), jb};
+	for (size_t i = 0; i < rows; i++) {
+		for (size_t j = 0; j < jb; j++) {
+			v(i, j) = i > j ? reflectors(i, j) : T(i == j ? 1 : 0);
+		}
+	}
+
+	// T(0:i, i) = -tau[i] T(0:i, 0:i) V(:, 0:i)^T v_i, the dot products come from V^T V
+	std::vector<T> gramData(jb * jb);
+	MatrixRef<T> gram{gramData.data(), jb};
+	gemm(gram, v.transposed(), v, jb, rows, jb, false);
+
+	std::vector<T> tData(jb * jb, T(0));
+	MatrixRef<T> t{tData.data(), jb};
+	for (size_t i = 0; i < jb; i++) {
+		t(i, i) = tau[i];
+		for (size_t r = 0; r < i; r++) {
+			T s = 0;
+			for (size_t q = r; q < i; q++) s += t(r, q) * gram(q, i);
+			t(r, i) = -tau[i] * s;
+		}
+	}
+
+	// w = V^T c, w = T w or T^T w, c -= V w
+	std::vector<T> wData(jb * cols);
+	MatrixRef<T> w{wData.data(), cols};
+	gemm(w, v.transposed(), c, jb, rows, cols, false);
+
+	std::vector<T> row(cols);
+	if (transpose) {
+		for (size_t i = jb; i-- > 0;) {
+			std::fill(row.begin(), row.end(), T(0));
+			for (size_t q = 0; q <= i; q++) {
+				for (size_t col = 0; col < cols; col++) row[col] += t(q, i) * w(q, col);
+			}
+			std::copy(row.begin(), row.end(), &w(i, 0));
+		}
+	} else {
+		for (size_t i = 0; i < jb; i++) {
+			std::fill(row.begin(), row.end(), T(0));
+			for (size_t q = i; q < jb; q++) {
+				for (size_t col = 0; col < cols; col++) row[col] += t(i, q) * w(q, col);
+			}
+			std::copy(row.begin(), row.end(), &w(i, 0));
+		}
+	}
+
+	gemm(c, v, w, rows, jb, cols, true);
+}
+
+/// Reduced QR factorization of the (m, n) `a`, m >= n, by blocked Householder reflections.
+/// Writes the orthonormal columns of Q to the (m, n) `q` and the upper triangular R to the
+/// (n, n) `r`, `a` is overwritten by the reflectors.
+template <typename T>
+inline void qrMatrix(MatrixRef<T> a, MatrixRef<T> q, MatrixRef<T> r, size_t m, size_t n) {
+	std::vector<T> tau(n);
+
+	for (size_t j0 = 0; j0 < n; j0 += LINALG_BLOCK) {
+		size_t jb = std::min(LINALG_BLOCK, n - j0);
+		householderPanel(a.block(j0, j0), tau.data() + j0, m - j0, jb);
+		applyReflectors(a.block(j0, j0), tau.data() + j0, m - j0, jb, a.block(j0, j0 + jb),
+		                n - j0 - jb, true);
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j < n; j++) r(i, j) = j >= i ? a(i, j) : T(0);
+	}
+
+	// Q is the reflectors applied to the first n columns of the identity, the last block first
+	// so each block only touches the columns from its own on
+	for (size_t i = 0; i < m; i++) {
+		for (size_t j = 0; j < n; j++) q(i, j) = T(i == j ? 1 : 0);
+	}
+	size_t numBlocks = (n + LINALG_BLOCK - 1) / LINALG_BLOCK;
+	for (size_t blk = numBlocks; blk-- > 0;) {
+		size_t j0 = blk * LINALG_BLOCK;
+		size_t jb = std::min(LINALG_BLOCK, n - j0);
+		applyReflectors(a.block(j0, j0), tau.data() + j0, m - j0, jb, q.block(j0, j0), n - j0,
+		                false);
+	}
+}
+
+/// QR factorizations of `batch` contiguous (m, n) matrices, see `qrMatrix`. `q` and `r` hold
+/// contiguous (m, n) and (n, n) matrices.
+template <typename T>
+inline void qr(T* data, T* q, T* r, size_t batch, size_t m, size_t n) {
+	forEachMatrix(batch, n, [&](size_t b) {
+		qrMatrix(MatrixRef<T>{data + b * m * n, n}, MatrixRef<T>{q + b * m * n, n},
+		         MatrixRef<T>{r + b * n * n, n}, m, n);
+	});
+}
+
+// Sparse matrices
+//
+// Kernels on (rows, cols) matrices in compressed sparse row (CSR) form: row i stores entries
+// [offsets[i], offsets[i + 1]) of `columns` and `values`, sorted by column. Rows are split over
+// threads into ranges of about the same number of stored elements rather than of rows, so a few
+// dense rows do not leave the other threads idle.
+
+/// Stored elements times their work below which a sparse kernel stays on the calling thread.
+constexpr size_t SPARSE_PARALLEL_WORK = size_t{1} << 16;
+
+/// First of the `rows` rows whose stored elements start at or after element `target`.
+inline size_t findSparseRow(const int64_t* offsets, size_t rows, size_t target) {
+	return std::lower_bound(offsets, offsets + rows, static_cast<int64_t>(target)) - offsets;
+}
+
+/// Calls `f(begin, end)` for ranges of rows covering [0, rows) on the threads of `parallelFor`,
+/// each holding about the same number of stored elements. `work` is the cost of one of them.
+template <typename F>
+inline void forEachSparseRows(const int64_t* offsets, size_t rows, size_t work, F f) {
+	size_t stored = static_cast<size_t>(offsets[rows]);
+	size_t numRanges = (stored + rows) * work < SPARSE_PARALLEL_WORK ? 1 : 4 * getNumThreads();
+
+	parallelFor(numRanges, 1, [&](size_t begin, size_t end) {
+		for (size_t r = begin; r < end; r++) {
+			size_t first = findSparseRow(offsets, rows, stored * r / numRanges);
+			size_t last = r + 1 == numRanges
+			                  ? rows
+			                  : findSparseRow(offsets, rows, stored * (r + 1) / numRanges);
+			if (first < last) {
+				f(first, last);
+			}
+		}
+	});
+}
+
+/// Sorts the `count` entries (rowIndices[e], colIndices[e], in[e]) of a matrix with `rows` rows
+/// into the CSR `offsets`, `columns` and `values`, summing entries with equal coordinates in
+/// the order they are given. Indices must be in range, `columns` and `values` need room for
+/// `count` elements. Returns the number of stored elements.
+template <typename T>
+inline size_t sparseFromCOO(const int64_t* rowIndices, const int64_t* colIndices, const T* in,
+                            size_t count, size_t rows, int64_t* offsets, int32_t* columns,
+                            T* values) {
+	using A = AccumulateType<T>;
+
+	// counting sort by row, stable so duplicates keep their order
+	std::fill(offsets, offsets + rows + 1, int64_t{0});
+	for (size_t e = 0; e < count; e++) offsets[rowIndices[e] + 1]++;
+	std::partial_sum(offsets, offsets + rows + 1, offsets);
+
+	std::vector<size_t> order(count);
+	std::vector<int64_t> next(offsets, offsets + rows);
+	for (size_t e = 0; e < count; e++) order[next[rowIndices[e]]++] = e;
+
+	// offsets[i] is rewritten once row i is read, the next row still finds its end
+	size_t stored = 0;
+	size_t* first = order.data();
+	for (size_t i = 0; i < rows; i++) {
+		size_t* last = order.data() + offsets[i + 1];
+		std::stable_sort(first, last,
+		                 [&](size_t x, size_t y) { return colIndices[x] < colIndices[y]; });
+
+		offsets[i] = static_cast<int64_t>(stored);
+		while (first < last) {
+			int64_t col = colIndices[*first];
+			A sum = A{};
+			for (; first < last && colIndices[*first] == col; first++) {
+				sum += static_cast<A>(in[*first]);
+			}
+			columns[stored] = static_cast<int32_t>(col);
+			values[stored] = static_cast<T>(sum);
+			stored++;
+		}
+	}
+	offsets[rows] = static_cast<int64_t>(stored);
+	return stored;
+}
+
+/// Writes the `rows + 1` CSR offsets of the nonzero elements of the dense (rows, cols) `a`. NaN
+/// counts as nonzero.
+template <typename T>
+inline void sparseRowOffsets(const T* a, const TensorLayout& layout, int64_t* offsets) {
+	using C = typename Compute<T>::type;
+	size_t rows = layout.shape[0], cols = layout.shape[1];
+	const T* base = a + layout.offset;
+
+	size_t grain = SPARSE_PARALLEL_WORK / std::max(cols, size_t{1});
+
+	offsets[0] = 0;
+	parallelFor(rows, grain, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const T* row = base + signedOffset(i * layout.strides[0]);
+			int64_t count = 0;
+			for (size_t j = 0; j < cols; j++) {
+				count += isNonzero(static_cast<C>(row[signedOffset(j * layout.strides[1])]));
+			}
+			offsets[i + 1] = count;
+		}
+	});
+	std::partial_sum(offsets, offsets + rows + 1, offsets);
+}
+
+/// Writes the columns and values of the nonzero elements of the dense (rows, cols) `a` at the
+/// `offsets` from `sparseRowOffsets`.
+template <typename T>
+inline void sparseFromDense(const T* a, const TensorLayout& layout, const int64_t* offsets,
+                            int32_t* columns, T* values) {
+	using C = typename Compute<T>::type;
+	size_t rows = layout.shape[0], cols = layout.shape[1];
+	const T* base = a + layout.offset;
+
+	forEachSparseRows(offsets, rows, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const T* row = base + signedOffset(i * layout.strides[0]);
+			int64_t e = offsets[i];
+			for (size_t j = 0; j < cols; j++) {
+				T x = row[signedOffset(j * layout.strides[1])];
+				if (isNonzero(static_cast<C>(x))) {
+					columns[e] = static_cast<int32_t>(j);
+					values[e++] = x;
+				}
+			}
+		}
+	});
+}
+
+/// Writes the row and column of every stored element of the CSR `a` with `rows` rows.
+inline void sparseToCOO(const int64_t* offsets, const int32_t* columns, size_t rows,
+                        int64_t* rowIndices, int64_t* colIndices) {
+	forEachSparseRows(offsets, rows, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			for (int64_t e = offsets[i]; e < offsets[i + 1]; e++) {
+				rowIndices[e] = static_cast<int64_t>(i);
+				colIndices[e] = columns[e];
+			}
+		}
+	});
+}
+
+/// Adds the stored elements of the CSR `a` to the contiguous (rows, cols) `out`, which is
+/// negated first if `negate`, so it becomes a - out.
+template <typename T>
+inline void sparseAddTo(const int64_t* offsets, const int32_t* columns, const T* values, T* out,
+                        size_t rows, size_t cols, bool negate) {
+	using C = ComputeType<T>;
+
+	forEachSparseRows(offsets, rows, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			T* row = out + i * cols;
+			if (negate) {
+				for (size_t j = 0; j < cols; j++) {
+					row[j] = static_cast<T>(C{} - static_cast<C>(row[j]));
+				}
+			}
+			for (int64_t e = offsets[i]; e < offsets[i + 1]; e++) {
+				T& x = row[columns[e]];
+				x = static_cast<T>(static_cast<C>(x) + static_cast<C>(values[e]));
+			}
+		}
+	});
+}
+
+/// out[e] = op(values[e], b(i, columns[e])) for every element e stored in row i of the CSR `a`,
+/// so the result stores the elements of `a`. The dense `bLayout` is (rows, cols) and may
+/// broadcast.
+template <typename T, typename Op>
+inline void sparseElementwise(const int64_t* offsets, const int32_t* columns, const T* values,
+                              const T* b, const TensorLayout& bLayout, T* out, size_t rows,
+                              Op op) {
+	using C = ComputeType<T>;
+	const T* base = b + bLayout.offset;
+
+	forEachSparseRows(offsets, rows, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const T* row = base + signedOffset(i * bLayout.strides[0]);
+			for (int64_t e = offsets[i]; e < offsets[i + 1]; e++) {
+				C x = static_cast<C>(row[signedOffset(columns[e] * bLayout.strides[1])]);
+				out[e] = static_cast<T>(op(static_cast<C>(values[e]), x));
+			}
+		}
+	});
+}
+
+/// out = a @ b for the CSR (rows, cols) `a` and the dense (cols, k) `b`, into the contiguous
+/// (rows, k) `out`. Products accumulate in `AccumulateType<T>`, a row of `a` is streamed once
+/// and reads a row of `b` per stored element.
+template <typename T>
+inline void sparseMatmul(const int64_t* offsets, const int32_t* columns, const T* values,
+                         const T* b, const TensorLayout& bLayout, T* out, size_t rows, size_t k) {
+	using A = AccumulateType<T>;
+	const T* base = b + bLayout.offset;
+	size_t rowStride = bLayout.strides[0], colStride = bLayout.strides[1];
+
+	forEachSparseRows(offsets, rows, k, [&](size_t begin, size_t end) {
+		if (k == 1) {
+			for (size_t i = begin; i < end; i++) {
+				A sum = A{};
+				for (int64_t e = offsets[i]; e < offsets[i + 1]; e++) {
+					sum += static_cast<A>(values[e]) *
+					       static_cast<A>(base[signedOffset(columns[e] * rowStride)]);
+				}
+				out[i] = static_cast<T>(sum);
+			}
+			return;
+		}
+
+		std::vector<A> acc(k);
+		for (size_t i = begin; i < end; i++) {
+			std::fill(acc.begin(), acc.end(), A{});
+			for (int64_t e = offsets[i]; e < offsets[i + 1]; e++) {
+				A value = static_cast<A>(values[e]);
+				const T* row = base + signedOffset(columns[e] * rowStride);
+				if (colStride == 1) {
+					for (size_t j = 0; j < k; j++) acc[j] += value * static_cast<A>(row[j]);
+				} else {
+					for (size_t j = 0; j < k; j++) {
+						acc[j] += value * static_cast<A>(row[signedOffset(j * colStride)]);
+					}
+				}
+			}
+			for (size_t j = 0; j < k; j++) out[i * k + j] = static_cast<T>(acc[j]);
+		}
+	});
+}
+
+}  // namespace cpu
+
+#endif  // KERNELS_CPU_H
@@ -2,16 +2,108 @@
 
 #include <algorithm>
 #include <cmath>
-#include <random>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
+#include "backend/cpu/kernels_CPU.h"
 #include "nforge/core/tensor.h"
+#include "profiling/op_scope.h"
 
-Tensor::CPUImpl::CPUImpl(const Tensor::Shape& shape) : m_shape(shape) {
-	m_data.assign(m_shape.getNumElements(), 0.0f);
+/// Calls `f` with a typed null pointer for the dtype of `impl`, see `dispatchDType`.
+template <typename F>
+static decltype(auto) dispatch(const Tensor::Impl* impl, F&& f) {
+	return dispatchDType(impl->getDType(), std::forward<F>(f));
 }
 
-Tensor::CPUImpl::CPUImpl(const Tensor::Shape& shape, float value) : m_shape(shape) {
-	m_data.assign(m_shape.getNumElements(), value);
+template <typename Tag>
+using Element = std::remove_pointer_t<Tag>;
+
+/// Calls `f` with a typed null pointer for the elements of `impl`, which must be `T` or Bool.
+template <typename T, typename F>
+static decltype(auto) dispatchOperand(const Tensor::Impl* impl, F&& f) {
+	if (impl->getDType() == DType::Bool) {
+		return f(static_cast<bool*>(nullptr));
+	}
+	assert(impl->getDType() == dtypeOf<T>());
+	return f(static_cast<T*>(nullptr));
+}
+
+/// Converts all elements of `src` into `dst`, which must have the same number of elements.
+static void convert(const Tensor::CPUImpl* src, Tensor::CPUImpl* dst) {
+	size_t count = src->getNumElements();
+
+	dispatch(src, [&](auto* srcTag) {
+		dispatch(dst, [&](auto* dstTag) {
+			using S = Element<decltype(srcTag)>;
+			using D = Element<decltype(dstTag)>;
+			const S* in = src->data<S>();
+			std::transform(in, in + count, dst->data<D>(),
+			               [](S value) { return static_cast<D>(value); });
+		});
+	});
+}
+
+/// Returns `impl` if kernels computing in `dtype` can read it directly, which holds for `dtype`
+/// itself and Bool. Otherwise converts it into `staging` and returns that.
+static const Tensor::CPUImpl* operandAs(const Tensor::Impl* impl, DType dtype,
+                                        std::unique_ptr<Tensor::CPUImpl>& staging) {
+	const auto* cpuImpl = static_cast<const Tensor::CPUImpl*>(impl);
+	if (impl->getDType() == dtype || impl->getDType() == DType::Bool) {
+		return cpuImpl;
+	}
+
+	staging = std::make_unique<Tensor::CPUImpl>(impl->getShape(), dtype);
+	convert(cpuImpl, staging.get());
+	return staging.get();
+}
+
+/// out = op(x, scale, zeroPoint) for `x` with the elements of `impl`. Scales and zero points are
+/// read as Float32.
+template <typename O, typename TernaryOp>
+static void applyAffine(const Tensor::CPUImpl* impl, const TensorLayout& layout,
+                        const Tensor::Impl* scaleImpl, const TensorLayout& scaleLayout,
+                        const Tensor::Impl* zeroPointImpl, const TensorLayout& zeroPointLayout,
+                        O* out, const TensorLayout& outLayout, TernaryOp op) {
+	std::unique_ptr<Tensor::CPUImpl> scaleStaging, zeroPointStaging;
+	const auto* scale = operandAs(scaleImpl, DType::Float32, scaleStaging);
+	const auto* zeroPoint = operandAs(zeroPointImpl, DType::Float32, zeroPointStaging);
+
+	dispatch(impl, [&](auto* tag) {
+		dispatchOperand<float>(scale, [&](auto* scaleTag) {
+			dispatchOperand<float>(zeroPoint, [&](auto* zeroPointTag) {
+				cpu::ternary(impl->template data<Element<decltype(tag)>>(), layout,
+				             scale->template data<Element<decltype(scaleTag)>>(), scaleLayout,
+				             zeroPoint->template data<Element<decltype(zeroPointTag)>>(),
+				             zeroPointLayout, out, outLayout, op);
+			});
+		});
+	});
+}
+
+/// String of one element, integers without a fraction and Bool as true / false.
+template <typename T>
+static std::string elementToString(T value) {
+	if constexpr (std::is_same_v<T, bool>) {
+		return value ? "true" : "false";
+	} else if constexpr (std::is_integral_v<T>) {
+		return std::to_string(value);
+	} else {
+		return std::to_string(static_cast<typename cpu::Compute<T>::type>(value));
+	}
+}
+
+Tensor::CPUImpl::CPUImpl(const Tensor::Shape& shape, DType dtype)
+    : m_shape(shape),
+      m_dtype(dtype),
+      m_allocation(Backend::CPU, shape.getNumElements() * getDTypeSize(dtype)) {
+	m_data.assign(m_shape.getNumElements() * getDTypeSize(dtype), 0);
+}
+
+Tensor::CPUImpl::CPUImpl(const Tensor::Shape& shape, float value) : CPUImpl(shape) {
+	std::fill_n(data<float>(), m_shape.getNumElements(), value);
 }
 
 Tensor::CPUImpl::~CPUImpl() {
@@ -19,18 +111,49 @@ Tensor::CPUImpl::~CPUImpl() {
 	m_data.shrink_to_fit();
 }
 
-void Tensor::CPUImpl::fillAll(float value) { m_data.assign(m_data.size(), value); }
-
-void Tensor::CPUImpl::fillRand() {
-	static std::mt19937 engine(std::random_device{}());
-	static std::uniform_real_distribution<double> dist(-1.0, 1.0);
+void Tensor::CPUImpl::fillAll(float value) {
+	NFORGE_OP_SCOPE(FillAll, getNumElements());
 
-	auto gen = [&]() { return dist(engine); };
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		std::fill_n(data<T>(), getNumElements(), static_cast<T>(value));
+	});
+}
 
-	std::generate(m_data.begin(), m_data.end(), gen);
+void Tensor::CPUImpl::fillRandom(const rng::Distribution& dist, const rng::Stream& stream) {
+	NFORGE_OP_SCOPE(FillRandom, getNumElements());
+
+	// ranges start on whole chunks of `rng::fill` and element i always comes from block i / 4 of
+	// the stream, so the values do not depend on the split
+	constexpr size_t CHUNK = rng::FILL_LANES * rng::ELEMENTS_PER_BLOCK;
+	size_t count = getNumElements();
+	size_t numChunks = (count + CHUNK - 1) / CHUNK;
+
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+
+		cpu::parallelFor(numChunks, cpu::getBlockGrain(CHUNK), [&](size_t begin, size_t end) {
+			size_t first = begin * CHUNK;
+			size_t length = std::min(count, end * CHUNK) - first;
+			rng::Stream part{stream.seed, stream.offset + first / rng::ELEMENTS_PER_BLOCK};
+
+			if constexpr (std::is_same_v<T, float>) {
+				rng::fill(data<float>() + first, length, dist, part);
+			} else {
+				std::vector<float> values(length);
+				rng::fill(values.data(), length, dist, part);
+				std::transform(values.begin(), values.end(), data<T>() + first,
+				               [](float value) { return static_cast<T>(value); });
+			}
+		});
+	});
 }
 
 void Tensor::CPUImpl::print() const {
+	NFORGE_OP_SCOPE(Print, getNumElements());
+
+	std::vector<float> values = toVector();
+
 	std::cout << "====================\n";
 	std::cout << "Tensor[CPU], Data:\n";
 
@@ -42,13 +165,13 @@ void Tensor::CPUImpl::print() const {
 		}
 	}
 
-	for (size_t i = 0; i < m_data.size(); i++) {
-		std::cout << m_data[i] << " ";
+	for (size_t i = 0; i < values.size(); i++) {
+		std::cout << values[i] << " ";
 		for (size_t j = 0; j < m_shape.getNumDims(); j++) {
 			// if element count of the block represented by suffix starting at j, divides i, then
 			// print a new line
 			if (i % numElementsInDimsCurAndBelow[j] == numElementsInDimsCurAndBelow[j] - 1 &&
-			    i != m_data.size() - 1) {
+			    i != values.size() - 1) {
 				std::cout << "\n";
 			}
 		}
@@ -59,6 +182,10 @@ void Tensor::CPUImpl::print() const {
 }
 
 void Tensor::CPUImpl::print(const std::vector<size_t>& position) const {
+	NFORGE_OP_SCOPE(Print, getNumElements());
+
+	std::vector<float> values = toVector();
+
 	std::cout << "====================\n";
 	std::cout << "Tensor[CPU], Data:\n";
 
@@ -83,7 +210,7 @@ void Tensor::CPUImpl::print(const std::vector<size_t>& position) const {
 	}
 
 	for (size_t i = offsetCount; i < offsetCount + blockSize; i++) {
-		std::cout << m_data[i] << " ";
+		std::cout << values[i] << " ";
 		for (size_t j = 0; j < m_shape.getNumDims(); j++) {
 			if (i % numElementsInDimsCurAndBelow[j] == numElementsInDimsCurAndBelow[j] - 1 &&
 			    i != offsetCount + blockSize - 1) {
@@ -100,13 +227,21 @@ void Tensor::CPUImpl::print(const std::vector<size_t>& position) const {
 
 Tensor::Shape Tensor::CPUImpl::getShape() const { return m_shape; }
 
+DType Tensor::CPUImpl::getDType() const { return m_dtype; }
+
 std::string Tensor::CPUImpl::toString() const {
+	NFORGE_OP_SCOPE(ToString, getNumElements());
+
 	std::string out;
 
 	out += "{ ";
-	for (float element : m_data) {
-		out += std::to_string(element) + " ";
-	}
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		const T* values = data<T>();
+		for (size_t i = 0; i < getNumElements(); i++) {
+			out += elementToString(values[i]) + " ";
+		}
+	});
 	out += "}";
 
 	return out;
@@ -114,340 +249,1040 @@ std::string Tensor::CPUImpl::toString() const {
 
 size_t Tensor::CPUImpl::getNumElements() const {
 	size_t numImpliedByShape = m_shape.getNumElements();
-	size_t numInContainer = m_data.size();
+	size_t numInContainer = m_data.size() / getDTypeSize(m_dtype);
 
 	assert(numImpliedByShape == numInContainer);
 
 	return numInContainer;
 }
 
-std::vector<float> Tensor::CPUImpl::toVector() const { return m_data; }
+std::vector<float> Tensor::CPUImpl::toVector() const {
+	NFORGE_OP_SCOPE(ToVector, getNumElements());
+
+	return dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		const T* begin = data<T>();
+		std::vector<float> values(getNumElements());
+		std::transform(begin, begin + values.size(), values.begin(),
+		               [](T value) { return static_cast<float>(value); });
+		return values;
+	});
+}
+
+void Tensor::CPUImpl::copyToHost(void* values) const {
+	NFORGE_OP_SCOPE(ToVector, getNumElements());
 
-void Tensor::CPUImpl::copyFromHost(const float* data, size_t count) {
-	std::copy(data, data + count, m_data.begin());
+	std::memcpy(values, m_data.data(), getNumElements() * getDTypeSize(m_dtype));
 }
 
-float* Tensor::CPUImpl::dataPtr() const { return (float*)m_data.data(); }
+void Tensor::CPUImpl::copyFromHost(const float* values, size_t count) {
+	NFORGE_OP_SCOPE(CopyFromHost, count);
+
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		std::transform(values, values + count, data<T>(),
+		               [](float value) { return static_cast<T>(value); });
+	});
+}
+
+void Tensor::CPUImpl::copyFromHost(const void* values) {
+	NFORGE_OP_SCOPE(CopyFromHost, getNumElements());
+
+	std::memcpy(m_data.data(), values, getNumElements() * getDTypeSize(m_dtype));
+}
+
+float* Tensor::CPUImpl::dataPtr() const { return data<float>(); }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::clone() const {
+	NFORGE_OP_SCOPE(Clone, getNumElements());
+
 	return std::make_unique<CPUImpl>(*this);
 }
 
 void Tensor::CPUImpl::set(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                           const TensorLayout& rhsLayout) {
+	NFORGE_OP_SCOPE(Set, cpu::getNumElements(rhsLayout));
+
+	// set is the conversion between dtypes, so every pair gets its own kernel
 	const auto* rhs = static_cast<const Tensor::CPUImpl*>(rhsImpl);
 
-	float* a = dataPtr();
-	const float* b = rhs->dataPtr();
+	dispatch(this, [&](auto* lhsTag) {
+		dispatch(rhs, [&](auto* rhsTag) {
+			using L = Element<decltype(lhsTag)>;
+			using R = Element<decltype(rhsTag)>;
 
-	size_t count = 1;
-	for (size_t d = 0; d < lhsLayout.rank; d++) count *= lhsLayout.shape[d];
+			if constexpr (std::is_same_v<L, R>) {
+				cpu::copy(data<L>(), lhsLayout, rhs->template data<R>(), rhsLayout);
+			} else {
+				cpu::inplaceBinary(data<L>(), lhsLayout, rhs->template data<R>(), rhsLayout,
+				                   cpu::Assign{});
+			}
+		});
+	});
+}
 
-	for (size_t i = 0; i < count; i++) {
-		a[physicalOffset(i, lhsLayout)] = b[physicalOffset(i, rhsLayout)];
+void Tensor::CPUImpl::setAll(const std::vector<SetCopy>& copies) {
+	// the chunks of every copy are numbered one after the other, see `cpu::copyChunks`
+	std::vector<size_t> firstChunk(copies.size() + 1, 0);
+	size_t count = 0;
+	for (size_t c = 0; c < copies.size(); c++) {
+		firstChunk[c + 1] = firstChunk[c] + cpu::getNumCopyChunks(copies[c].targetLayout);
+		count += cpu::getNumElements(copies[c].targetLayout);
 	}
+	NFORGE_OP_SCOPE(Set, count);
+
+	// many small inputs group into one range, a large one splits into several
+	size_t numChunks = firstChunk.back();
+	size_t grain = cpu::getBlockGrain(count / std::max<size_t>(numChunks, 1));
+
+	cpu::parallelFor(numChunks, grain, [&](size_t begin, size_t end) {
+		size_t c = std::upper_bound(firstChunk.begin(), firstChunk.end(), begin) -
+		           firstChunk.begin() - 1;
+		for (; c < copies.size() && firstChunk[c] < end; c++) {
+			const SetCopy& copy = copies[c];
+			const auto* source = static_cast<const Tensor::CPUImpl*>(copy.source);
+			size_t first = std::max(begin, firstChunk[c]) - firstChunk[c];
+			size_t last = std::min(end, firstChunk[c + 1]) - firstChunk[c];
+
+			dispatch(this, [&](auto* lhsTag) {
+				dispatch(source, [&](auto* rhsTag) {
+					cpu::copyChunks(data<Element<decltype(lhsTag)>>(), copy.targetLayout,
+					                source->template data<Element<decltype(rhsTag)>>(),
+					                copy.sourceLayout, first, last);
+				});
+			});
+		}
+	});
 }
 
 bool Tensor::CPUImpl::compare(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                               const TensorLayout& rhsLayout) const {
-	const auto* rhs = static_cast<const Tensor::CPUImpl*>(rhsImpl);
+	NFORGE_OP_SCOPE(Compare, cpu::getNumElements(lhsLayout));
 
-	const float* a = dataPtr();
-	const float* b = rhs->dataPtr();
+	const auto* rhs = static_cast<const Tensor::CPUImpl*>(rhsImpl);
 
 	size_t count = 1;
 	for (size_t d = 0; d < lhsLayout.rank; d++) count *= lhsLayout.shape[d];
 
-	for (size_t i = 0; i < count; i++) {
-		if (a[physicalOffset(i, lhsLayout)] != b[physicalOffset(i, rhsLayout)])
-			return false;
-	}
+	return dispatch(this, [&](auto* lhsTag) {
+		return dispatch(rhs, [&](auto* rhsTag) {
+			using L = Element<decltype(lhsTag)>;
+			using R = Element<decltype(rhsTag)>;
+			using C = cpu::ComputeType<L, R>;
 
-	return true;
+			const L* a = data<L>();
+			const R* b = rhs->template data<R>();
+
+			for (size_t i = 0; i < count; i++) {
+				if (static_cast<C>(a[physicalOffset(i, lhsLayout)]) !=
+				    static_cast<C>(b[physicalOffset(i, rhsLayout)]))
+					return false;
+			}
+			return true;
+		});
+	});
 }
 
 ///////////////////////////////////////////
 // Element wise binary tensor operations //
 ///////////////////////////////////////////
 
-template <typename BinaryOp>
+template <template <typename> class Out, typename BinaryOp>
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::applyBinaryOp(const TensorLayout& lhsLayout,
                                                              const Tensor::Impl* rhsImpl,
                                                              const TensorLayout& rhsLayout,
                                                              const TensorLayout& outLayout,
-                                                             BinaryOp op) const {
-	auto outShape = Tensor::Shape(outLayout);
-
-	auto* result = new Tensor::CPUImpl(outShape);
-	const auto* rhs = static_cast<const Tensor::CPUImpl*>(rhsImpl);
-
-	const float* a = dataPtr();
-	const float* b = rhs->dataPtr();
-	auto& c = result->m_data;
-
-	size_t count = 1;
-	for (size_t d = 0; d < outLayout.rank; d++) count *= outLayout.shape[d];
-
-	for (size_t i = 0; i < count; i++) {
-		c[physicalOffset(i, outLayout)] =
-		    op(a[physicalOffset(i, lhsLayout)], b[physicalOffset(i, rhsLayout)]);
-	}
-	return std::unique_ptr<Tensor::Impl>(result);
+                                                             DType dtype, BinaryOp op) const {
+	// operands are read as `dtype` or Bool, anything else is converted first. This keeps the
+	// kernel count linear in the number of dtypes.
+	std::unique_ptr<Tensor::CPUImpl> lhsStaging, rhsStaging;
+	const auto* lhs = operandAs(this, dtype, lhsStaging);
+	const auto* rhs = operandAs(rhsImpl, dtype, rhsStaging);
+
+	return dispatchDType(dtype, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+
+		auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), dtypeOf<Out<T>>());
+
+		dispatchOperand<T>(lhs, [&](auto* lhsTag) {
+			dispatchOperand<T>(rhs, [&](auto* rhsTag) {
+				cpu::binary(lhs->template data<Element<decltype(lhsTag)>>(), lhsLayout,
+				            rhs->template data<Element<decltype(rhsTag)>>(), rhsLayout,
+				            result->template data<Out<T>>(), outLayout, op);
+			});
+		});
+
+		return std::unique_ptr<Tensor::Impl>(result);
+	});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::add(const TensorLayout& lhsLayout,
                                                    const Tensor::Impl* rhsImpl,
                                                    const TensorLayout& rhsLayout,
-                                                   const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a + b; });
+                                                   const TensorLayout& outLayout,
+                                                   DType dtype) const {
+	NFORGE_OP_SCOPE(Add, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::SameType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::Add{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::sub(const TensorLayout& lhsLayout,
                                                    const Tensor::Impl* rhsImpl,
                                                    const TensorLayout& rhsLayout,
-                                                   const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a - b; });
+                                                   const TensorLayout& outLayout,
+                                                   DType dtype) const {
+	NFORGE_OP_SCOPE(Sub, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::SameType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::Sub{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::mul(const TensorLayout& lhsLayout,
                                                    const Tensor::Impl* rhsImpl,
                                                    const TensorLayout& rhsLayout,
-                                                   const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a * b; });
+                                                   const TensorLayout& outLayout,
+                                                   DType dtype) const {
+	NFORGE_OP_SCOPE(Mul, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::SameType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::Mul{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::div(const TensorLayout& lhsLayout,
                                                    const Tensor::Impl* rhsImpl,
                                                    const TensorLayout& rhsLayout,
-                                                   const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a / b; });
+                                                   const TensorLayout& outLayout,
+                                                   DType dtype) const {
+	NFORGE_OP_SCOPE(Div, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::SameType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::Div{});
 }
 
 template <typename BinaryOp>
 void Tensor::CPUImpl::applyInplaceBinaryOp(const TensorLayout& lhsLayout,
                                            const Tensor::Impl* rhsImpl,
                                            const TensorLayout& rhsLayout, BinaryOp op) {
-	const auto* rhs = static_cast<const Tensor::CPUImpl*>(rhsImpl);
-
-	float* a = dataPtr();
-	const float* b = rhs->dataPtr();
+	std::unique_ptr<Tensor::CPUImpl> rhsStaging;
+	const auto* rhs = operandAs(rhsImpl, m_dtype, rhsStaging);
 
-	size_t count = 1;
-	for (size_t d = 0; d < lhsLayout.rank; d++) count *= lhsLayout.shape[d];
+	dispatch(this, [&](auto* lhsTag) {
+		using T = Element<decltype(lhsTag)>;
 
-	for (size_t i = 0; i < count; i++) {
-		a[physicalOffset(i, lhsLayout)] =
-		    op(a[physicalOffset(i, lhsLayout)], b[physicalOffset(i, rhsLayout)]);
-	}
+		dispatchOperand<T>(rhs, [&](auto* rhsTag) {
+			cpu::inplaceBinary(data<T>(), lhsLayout,
+			                   rhs->template data<Element<decltype(rhsTag)>>(), rhsLayout, op);
+		});
+	});
 }
 
 void Tensor::CPUImpl::iadd(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                            const TensorLayout& rhsLayout) {
-	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, [](float a, float b) { return a + b; });
+	NFORGE_OP_SCOPE(IAdd, cpu::getNumElements(lhsLayout));
+
+	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, cpu::Add{});
 }
 
 void Tensor::CPUImpl::isub(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                            const TensorLayout& rhsLayout) {
-	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, [](float a, float b) { return a - b; });
+	NFORGE_OP_SCOPE(ISub, cpu::getNumElements(lhsLayout));
+
+	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, cpu::Sub{});
 }
 
 void Tensor::CPUImpl::imul(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                            const TensorLayout& rhsLayout) {
-	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, [](float a, float b) { return a * b; });
+	NFORGE_OP_SCOPE(IMul, cpu::getNumElements(lhsLayout));
+
+	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, cpu::Mul{});
 }
 
 void Tensor::CPUImpl::idiv(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                            const TensorLayout& rhsLayout) {
-	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, [](float a, float b) { return a / b; });
+	NFORGE_OP_SCOPE(IDiv, cpu::getNumElements(lhsLayout));
+
+	applyInplaceBinaryOp(lhsLayout, rhsImpl, rhsLayout, cpu::Div{});
+}
+
+void Tensor::CPUImpl::maskedFill(const TensorLayout& lhsLayout, const Tensor::Impl* maskImpl,
+                                 const TensorLayout& maskLayout, float value) {
+	NFORGE_OP_SCOPE(MaskedFill, cpu::getNumElements(lhsLayout));
+
+	applyInplaceBinaryOp(lhsLayout, maskImpl, maskLayout, cpu::MaskedFill{value});
 }
 
-template <typename ReductionOp, typename Transform>
+template <template <typename> class Out, typename ReductionOp, typename Transform>
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::applyReductionOp(const TensorLayout& layout,
                                                                 const TensorLayout& blockLayout,
                                                                 const TensorLayout& outLayout,
                                                                 ReductionOp op,
                                                                 Transform transform) const {
-	auto outShape = Tensor::Shape(outLayout);
+	return dispatch(this, [&](auto* tag) {
+		using In = Element<decltype(tag)>;
 
-	auto* result = new Tensor::CPUImpl(outShape);
+		auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), dtypeOf<Out<In>>());
+		cpu::reduce(data<In>(), layout, blockLayout, result->template data<Out<In>>(), outLayout,
+		            op, transform);
 
-	const float* a = dataPtr();
-	auto& b = result->m_data;
-
-	size_t outCount = 1;
-	for (size_t d = 0; d < outLayout.rank; d++) outCount *= outLayout.shape[d];
+		return std::unique_ptr<Tensor::Impl>(result);
+	});
+}
 
-	size_t blockCount = 1;
-	for (size_t d = 0; d < blockLayout.rank; d++) blockCount *= blockLayout.shape[d];
+/// `all` or `any` of a dense Bool mask, `scan` is `cpu::maskAll` or `cpu::maskAny`.
+static std::unique_ptr<Tensor::Impl> scanMask(const bool* mask, const TensorLayout& layout,
+                                              const TensorLayout& blockLayout,
+                                              const TensorLayout& outLayout,
+                                              bool (*scan)(const bool*, size_t)) {
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), DType::Bool);
+	bool* out = result->data<bool>();
 
-	for (size_t i = 0; i < outCount; i++) {
-		float res = transform(a[physicalOffset(i * blockCount, layout)]);
+	size_t blockCount = cpu::getNumElements(blockLayout);
+	size_t outCount = cpu::getNumElements(outLayout);
 
-		for (size_t j = 1; j < blockCount; j++) {
-			res = op(res, a[physicalOffset(i * blockCount + j, layout)]);
-		}
-
-		b[physicalOffset(i, outLayout)] = res;
+	const bool* block = mask + layout.offset;
+	for (size_t i = 0; i < outCount; i++, block += blockCount) {
+		out[physicalOffset(i, outLayout)] = scan(block, blockCount);
 	}
+
 	return std::unique_ptr<Tensor::Impl>(result);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::sum(const TensorLayout& layout,
                                                    const TensorLayout& blockLayout,
                                                    const TensorLayout& outLayout) const {
-	return applyReductionOp(layout, blockLayout, outLayout, [](float a, float b) { return a + b; });
+	NFORGE_OP_SCOPE(Sum, cpu::getNumElements(layout));
+
+	return applyReductionOp<cpu::AccumulateType>(layout, blockLayout, outLayout, cpu::Add{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::min(const TensorLayout& layout,
                                                    const TensorLayout& blockLayout,
                                                    const TensorLayout& outLayout) const {
-	return applyReductionOp(layout, blockLayout, outLayout,
-	                        [](float a, float b) { return std::min(a, b); });
+	NFORGE_OP_SCOPE(Min, cpu::getNumElements(layout));
+
+	return applyReductionOp<cpu::SameType>(layout, blockLayout, outLayout, cpu::Min{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::max(const TensorLayout& layout,
                                                    const TensorLayout& blockLayout,
                                                    const TensorLayout& outLayout) const {
-	return applyReductionOp(layout, blockLayout, outLayout,
-	                        [](float a, float b) { return std::max(a, b); });
+	NFORGE_OP_SCOPE(Max, cpu::getNumElements(layout));
+
+	return applyReductionOp<cpu::SameType>(layout, blockLayout, outLayout, cpu::Max{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::prod(const TensorLayout& layout,
                                                     const TensorLayout& blockLayout,
                                                     const TensorLayout& outLayout) const {
-	return applyReductionOp(layout, blockLayout, outLayout, [](float a, float b) { return a * b; });
-}
+	NFORGE_OP_SCOPE(Prod, cpu::getNumElements(layout));
 
-std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::norm(const TensorLayout& layout) const {
-	const float* a = dataPtr();
-	float sum = 0;
+	return applyReductionOp<cpu::AccumulateType>(layout, blockLayout, outLayout, cpu::Mul{});
+}
 
-	size_t count = 1;
-	for (size_t d = 0; d < layout.rank; d++) count *= layout.shape[d];
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::norm(const TensorLayout& layout,
+                                                    const TensorLayout& blockLayout,
+                                                    const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(Norm, cpu::getNumElements(layout));
 
-	for (size_t i = 0; i < count; i++) {
-		float element = a[physicalOffset(i, layout)];
-		sum += element * element;
-	}
-	float norm = std::sqrt(sum);
+	return dispatch(this, [&](auto* tag) {
+		using In = Element<decltype(tag)>;
+		using Out = cpu::NormType<In>;
 
-	auto* result = new Tensor::CPUImpl(Tensor::Shape({}));
-	result->m_data[0] = norm;
+		auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), dtypeOf<Out>());
+		cpu::norm(data<In>(), layout, blockLayout, result->template data<Out>(), outLayout);
 
-	return std::unique_ptr<Tensor::Impl>(result);
+		return std::unique_ptr<Tensor::Impl>(result);
+	});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::all(const TensorLayout& layout,
                                                    const TensorLayout& blockLayout,
                                                    const TensorLayout& outLayout) const {
-	return applyReductionOp(
-	    layout, blockLayout, outLayout,
-	    [](float a, float b) { return (a != 0.0f && b != 0.0f) ? 1.0f : 0.0f; },
-	    [](float x) { return x != 0.0; });
+	NFORGE_OP_SCOPE(All, cpu::getNumElements(layout));
+
+	if (m_dtype == DType::Bool && cpu::isContiguous(layout)) {
+		return scanMask(data<bool>(), layout, blockLayout, outLayout, cpu::maskAll);
+	}
+
+	return applyReductionOp<cpu::BoolType>(layout, blockLayout, outLayout, cpu::LogicalAnd{},
+	                                        cpu::NonZero{});
 }
 
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::any(const TensorLayout& layout,
                                                    const TensorLayout& blockLayout,
                                                    const TensorLayout& outLayout) const {
-	return applyReductionOp(
-	    layout, blockLayout, outLayout,
-	    [](float a, float b) { return (a != 0.0f || b != 0.0f) ? 1.0f : 0.0f; },
-	    [](float x) { return x != 0.0; });
+	NFORGE_OP_SCOPE(Any, cpu::getNumElements(layout));
+
+	if (m_dtype == DType::Bool && cpu::isContiguous(layout)) {
+		return scanMask(data<bool>(), layout, blockLayout, outLayout, cpu::maskAny);
+	}
+
+	return applyReductionOp<cpu::BoolType>(layout, blockLayout, outLayout, cpu::LogicalOr{},
+	                                        cpu::NonZero{});
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::countNonzero(const TensorLayout& layout,
+                                                            const TensorLayout& blockLayout,
+                                                            const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(CountNonzero, cpu::getNumElements(layout));
+
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), DType::Int64);
+
+	dispatch(this, [&](auto* tag) {
+		using In = Element<decltype(tag)>;
+		cpu::countNonzero(data<In>(), layout, blockLayout, result->data<int64_t>(), outLayout);
+	});
+
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::argmin(const TensorLayout& layout,
+                                                      const TensorLayout& blockLayout,
+                                                      const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(ArgMin, cpu::getNumElements(layout));
+
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), DType::Int64);
+
+	dispatch(this, [&](auto* tag) {
+		using In = Element<decltype(tag)>;
+		cpu::argExtreme<false>(data<In>(), layout, cpu::getNumElements(blockLayout),
+		                       result->data<int64_t>());
+	});
+
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::argmax(const TensorLayout& layout,
+                                                      const TensorLayout& blockLayout,
+                                                      const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(ArgMax, cpu::getNumElements(layout));
+
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), DType::Int64);
+
+	dispatch(this, [&](auto* tag) {
+		using In = Element<decltype(tag)>;
+		cpu::argExtreme<true>(data<In>(), layout, cpu::getNumElements(blockLayout),
+		                      result->data<int64_t>());
+	});
+
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+void Tensor::CPUImpl::topk(const TensorLayout& layout, const TensorLayout& blockLayout, size_t k,
+                           bool largest, Tensor::Impl* valuesImpl,
+                           Tensor::Impl* indicesImpl) const {
+	NFORGE_OP_SCOPE(TopK, cpu::getNumElements(layout));
+
+	auto* values = static_cast<Tensor::CPUImpl*>(valuesImpl);
+	auto* indices = static_cast<Tensor::CPUImpl*>(indicesImpl);
+
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		cpu::topk(data<T>(), layout, cpu::getNumElements(blockLayout), k, largest,
+		          values->data<T>(), indices->data<int64_t>());
+	});
+}
+
+void Tensor::CPUImpl::sort(const TensorLayout& layout, const TensorLayout& blockLayout,
+                           bool descending, Tensor::Impl* valuesImpl,
+                           Tensor::Impl* indicesImpl) const {
+	NFORGE_OP_SCOPE(Sort, cpu::getNumElements(layout));
+
+	auto* values = static_cast<Tensor::CPUImpl*>(valuesImpl);
+	auto* indices = static_cast<Tensor::CPUImpl*>(indicesImpl);
+
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		cpu::sort(data<T>(), layout, cpu::getNumElements(blockLayout), descending,
+		          values == nullptr ? nullptr : values->data<T>(),
+		          indices == nullptr ? nullptr : indices->data<int64_t>());
+	});
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::partition(const TensorLayout& layout,
+                                                         const TensorLayout& blockLayout,
+                                                         size_t kth) const {
+	NFORGE_OP_SCOPE(Partition, cpu::getNumElements(layout));
+
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(layout), m_dtype);
+
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		cpu::partition(data<T>(), layout, cpu::getNumElements(blockLayout), kth,
+		               result->data<T>());
+	});
+
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+/// Scan of `op` over `in` into a new tensor of element type `Out`, see `cpu::scan`.
+template <typename Out, typename In, typename Op>
+static std::unique_ptr<Tensor::Impl> scanAs(const In* in, const TensorLayout& layout, size_t dim,
+                                            Op op, Out identity, bool exclusive) {
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(layout), dtypeOf<Out>());
+	cpu::scan(in, layout, dim, result->data<Out>(), op, identity, exclusive);
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+/// Identity of a running max of `T`, -inf for floats.
+template <typename T>
+static T lowestOf() {
+	if constexpr (std::is_integral_v<T>) {
+		return std::numeric_limits<T>::lowest();
+	} else {
+		return static_cast<T>(-std::numeric_limits<float>::infinity());
+	}
+}
+
+/// Identity of a running min of `T`, +inf for floats.
+template <typename T>
+static T highestOf() {
+	if constexpr (std::is_integral_v<T>) {
+		return std::numeric_limits<T>::max();
+	} else {
+		return static_cast<T>(std::numeric_limits<float>::infinity());
+	}
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::scan(const TensorLayout& layout, size_t dim,
+                                                    ScanOp op, bool exclusive) const {
+	NFORGE_OP_SCOPE(Scan, cpu::getNumElements(layout));
+
+	return dispatch(this, [&](auto* tag) {
+		using In = Element<decltype(tag)>;
+		using Acc = cpu::AccumulateType<In>;
+		const In* in = data<In>();
+
+		switch (op) {
+			case ScanOp::Sum:
+				return scanAs<Acc>(in, layout, dim, cpu::Add{}, Acc(0), exclusive);
+			case ScanOp::Prod:
+				return scanAs<Acc>(in, layout, dim, cpu::Mul{}, Acc(1), exclusive);
+			case ScanOp::Max:
+				return scanAs<In>(in, layout, dim, cpu::Max{}, lowestOf<In>(), exclusive);
+			default:
+				return scanAs<In>(in, layout, dim, cpu::Min{}, highestOf<In>(), exclusive);
+		}
+	});
+}
+
+/// Reads `indexImpl` as Int64, converting it into `staging` if needed, and throws
+/// std::out_of_range naming `what` if an index with `indexLayout` is outside [0, size).
+static const int64_t* indicesInRange(const Tensor::Impl* indexImpl,
+                                     const TensorLayout& indexLayout, size_t size,
+                                     std::unique_ptr<Tensor::CPUImpl>& staging, const char* what) {
+	const int64_t* index = operandAs(indexImpl, DType::Int64, staging)->data<int64_t>();
+
+	int64_t position = cpu::findIndexOutOfRange(index, indexLayout, size);
+	if (position >= 0) {
+		int64_t value = index[physicalOffset(position, indexLayout)];
+		throw std::out_of_range(std::string(what) + "() index " + std::to_string(value) +
+		                        " is out of range for a dimension of size " +
+		                        std::to_string(size));
+	}
+	return index;
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::gather(const TensorLayout& layout, size_t dim,
+                                                      const Tensor::Impl* indexImpl,
+                                                      const TensorLayout& indexLayout) const {
+	NFORGE_OP_SCOPE(Gather, cpu::getNumElements(indexLayout));
+
+	std::unique_ptr<Tensor::CPUImpl> indexStaging;
+	const int64_t* index =
+	    indicesInRange(indexImpl, indexLayout, layout.shape[dim], indexStaging, "gather");
+
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(indexLayout), m_dtype);
+
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		cpu::gather(data<T>(), layout, dim, index, indexLayout, result->data<T>());
+	});
+
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+void Tensor::CPUImpl::scatter(const TensorLayout& layout, size_t dim,
+                              const Tensor::Impl* indexImpl, const TensorLayout& indexLayout,
+                              const Tensor::Impl* srcImpl, const TensorLayout& srcLayout,
+                              bool accumulate) {
+	NFORGE_OP_SCOPE(Scatter, cpu::getNumElements(indexLayout));
+
+	// checked before the first write, so a bad index leaves this tensor unchanged
+	std::unique_ptr<Tensor::CPUImpl> indexStaging, srcStaging;
+	const int64_t* index =
+	    indicesInRange(indexImpl, indexLayout, layout.shape[dim], indexStaging, "scatter");
+	const auto* src = operandAs(srcImpl, m_dtype, srcStaging);
+
+	dispatch(this, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+
+		dispatchOperand<T>(src, [&](auto* srcTag) {
+			const auto* values = src->template data<Element<decltype(srcTag)>>();
+			if (accumulate) {
+				cpu::scatterAdd(data<T>(), layout, dim, index, indexLayout, values, srcLayout);
+			} else {
+				cpu::scatter(data<T>(), layout, dim, index, indexLayout, values, srcLayout,
+				             cpu::Assign{});
+			}
+		});
+	});
+}
+
+bool Tensor::CPUImpl::reducePredicate(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
+                                      const TensorLayout& rhsLayout, Predicate predicate,
+                                      float tolerance, bool all, DType dtype) const {
+	NFORGE_OP_SCOPE(ReducePredicate, cpu::getNumElements(lhsLayout));
+
+	// operands are read as `dtype` or Bool, as in applyBinaryOp
+	std::unique_ptr<Tensor::CPUImpl> lhsStaging, rhsStaging;
+	const auto* lhs = operandAs(this, dtype, lhsStaging);
+	const auto* rhs = operandAs(rhsImpl, dtype, rhsStaging);
+
+	// all holds if no element fails, any if some element holds
+	auto find = [&](auto op) {
+		return dispatchDType(dtype, [&](auto* tag) {
+			using T = Element<decltype(tag)>;
+			return dispatchOperand<T>(lhs, [&](auto* lhsTag) {
+				return dispatchOperand<T>(rhs, [&](auto* rhsTag) {
+					return cpu::findAny(lhs->template data<Element<decltype(lhsTag)>>(), lhsLayout,
+					                    rhs->template data<Element<decltype(rhsTag)>>(), rhsLayout,
+					                    op, !all);
+				});
+			});
+		});
+	};
+
+	bool found = false;
+	switch (predicate) {
+		case Predicate::Equal:
+			found = find(cpu::Equal{});
+			break;
+		case Predicate::NotEqual:
+			found = find(cpu::NotEqual{});
+			break;
+		case Predicate::Less:
+			found = find(cpu::Less{});
+			break;
+		case Predicate::LessEqual:
+			found = find(cpu::LessEqual{});
+			break;
+		case Predicate::Greater:
+			found = find(cpu::Greater{});
+			break;
+		case Predicate::GreaterEqual:
+			found = find(cpu::GreaterEqual{});
+			break;
+		case Predicate::IsClose:
+			found = find(cpu::IsClose{tolerance});
+			break;
+	}
+	return all ? !found : found;
+}
+
+/// Runs `cpu::softmax` on `impl` into a new tensor of shape `outShape`. Floating dtypes are read
+/// directly and kept, others are converted to Float32 first.
+template <cpu::SoftmaxOutput Kind>
+static std::unique_ptr<Tensor::Impl> applySoftmax(const Tensor::CPUImpl* impl,
+                                                  const TensorLayout& layout,
+                                                  const TensorLayout& blockLayout,
+                                                  const Tensor::Shape& outShape) {
+	std::unique_ptr<Tensor::CPUImpl> staging;
+	const auto* in = impl;
+	if (!isFloatingPoint(impl->getDType())) {
+		in = operandAs(impl, DType::Float32, staging);
+	}
+
+	return dispatch(in, [&](auto* tag) -> std::unique_ptr<Tensor::Impl> {
+		using T = Element<decltype(tag)>;
+		auto* result = new Tensor::CPUImpl(outShape, in->getDType());
+
+		if constexpr (std::is_floating_point_v<typename cpu::Compute<T>::type>) {
+			cpu::softmax<Kind>(in->template data<T>(), layout, cpu::getNumElements(blockLayout),
+			                   result->template data<T>());
+		}
+		return std::unique_ptr<Tensor::Impl>(result);
+	});
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::softmax(const TensorLayout& layout,
+                                                       const TensorLayout& blockLayout,
+                                                       bool log) const {
+	if (log) {
+		NFORGE_OP_SCOPE(LogSoftmax, cpu::getNumElements(layout));
+		return applySoftmax<cpu::SoftmaxOutput::LogSoftmax>(this, layout, blockLayout,
+		                                                     Tensor::Shape(layout));
+	}
+
+	NFORGE_OP_SCOPE(Softmax, cpu::getNumElements(layout));
+	return applySoftmax<cpu::SoftmaxOutput::Softmax>(this, layout, blockLayout,
+	                                                 Tensor::Shape(layout));
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::logSumExp(const TensorLayout& layout,
+                                                         const TensorLayout& blockLayout,
+                                                         const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(LogSumExp, cpu::getNumElements(layout));
+
+	return applySoftmax<cpu::SoftmaxOutput::LogSumExp>(this, layout, blockLayout,
+	                                                   Tensor::Shape(outLayout));
+}
+
+/// Runs `cpu::unary` with `op` from `in` into `out`. `in` must have the elements of `out` or be
+/// Bool. Integer outputs only support Abs and Clamp, see `Tensor::map`.
+static void applyUnary(const Tensor::CPUImpl* in, const TensorLayout& inLayout,
+                       Tensor::CPUImpl* out, const TensorLayout& outLayout, UnaryOp op,
+                       float alpha, float beta) {
+	dispatch(out, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		constexpr bool FLOATING = std::is_floating_point_v<typename cpu::Compute<T>::type>;
+
+		dispatchOperand<T>(in, [&](auto* inTag) {
+			const auto* x = in->template data<Element<decltype(inTag)>>();
+
+			auto run = [&](auto functor) {
+				using F = decltype(functor);
+				if constexpr (FLOATING || std::is_same_v<F, cpu::Abs> ||
+				              std::is_same_v<F, cpu::Clamp>) {
+					cpu::unary(x, inLayout, out->template data<T>(), outLayout, functor);
+				}
+			};
+
+			switch (op) {
+				case UnaryOp::Exp:
+					run(cpu::Exp{});
+					break;
+				case UnaryOp::Log:
+					run(cpu::Log{});
+					break;
+				case UnaryOp::Sqrt:
+					run(cpu::Sqrt{});
+					break;
+				case UnaryOp::Rsqrt:
+					run(cpu::Rsqrt{});
+					break;
+				case UnaryOp::Abs:
+					run(cpu::Abs{});
+					break;
+				case UnaryOp::Tanh:
+					run(cpu::Tanh{});
+					break;
+				case UnaryOp::Sigmoid:
+					run(cpu::Sigmoid{});
+					break;
+				case UnaryOp::Sin:
+					run(cpu::Sin{});
+					break;
+				case UnaryOp::Cos:
+					run(cpu::Cos{});
+					break;
+				case UnaryOp::Pow:
+					// squares are correctly rounded in one multiplication
+					if (alpha == 2.0f) {
+						run(cpu::Square{});
+					} else {
+						run(cpu::Pow{alpha});
+					}
+					break;
+				case UnaryOp::Clamp:
+					run(cpu::Clamp{alpha, beta});
+					break;
+			}
+		});
+	});
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::map(const TensorLayout& layout, UnaryOp op,
+                                                   float alpha, float beta, DType dtype) const {
+	NFORGE_UNARY_OP_SCOPE(op, cpu::getNumElements(layout));
+
+	std::unique_ptr<Tensor::CPUImpl> staging;
+	const auto* in = operandAs(this, dtype, staging);
+
+	Tensor::Shape shape(layout);
+	auto* result = new Tensor::CPUImpl(shape, dtype);
+	applyUnary(in, layout, result, TensorLayout(shape), op, alpha, beta);
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+void Tensor::CPUImpl::mapInto(const TensorLayout& layout, const Tensor::Impl* srcImpl,
+                              const TensorLayout& srcLayout, UnaryOp op, float alpha, float beta,
+                              DType dtype) {
+	if (m_dtype != dtype) {
+		// e.g. a Float32 result into Float16, convert through a temporary
+		auto result = srcImpl->map(srcLayout, op, alpha, beta, dtype);
+		set(layout, result.get(), TensorLayout(result->getShape()));
+		return;
+	}
+
+	NFORGE_UNARY_OP_SCOPE(op, cpu::getNumElements(layout));
+
+	std::unique_ptr<Tensor::CPUImpl> staging;
+	const auto* in = operandAs(srcImpl, dtype, staging);
+	applyUnary(in, srcLayout, this, layout, op, alpha, beta);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::matmul(const TensorLayout& lhsLayout,
                                                       const Tensor::Impl* rhsImpl,
                                                       const TensorLayout& rhsLayout,
                                                       const TensorLayout& outLayout, size_t batch,
-                                                      size_t m, size_t k, size_t p) const {
-	auto outShape = Tensor::Shape(outLayout);
-	auto* result = new Tensor::CPUImpl(outShape);
+                                                      size_t m, size_t k, size_t p,
+                                                      DType dtype) const {
+	NFORGE_OP_SCOPE(Matmul, batch * m * k * p);
 
-	const auto* rhs = static_cast<const Tensor::CPUImpl*>(rhsImpl);
+	std::unique_ptr<Tensor::CPUImpl> lhsStaging, rhsStaging;
+	const auto* lhs = operandAs(this, dtype, lhsStaging);
+	const auto* rhs = operandAs(rhsImpl, dtype, rhsStaging);
 
-	const float* a = dataPtr();
-	const float* b = rhs->dataPtr();
-	auto& c = result->m_data;
-
-	for (size_t bat = 0; bat < batch; bat++) {
-		for (size_t i = 0; i < m; i++) {
-			for (size_t j = 0; j < p; j++) {
-				float sum = 0.0f;
-				for (size_t kk = 0; kk < k; kk++) {
-					size_t lhsIdx = bat * (m * k) + i * k + kk;
-					size_t rhsIdx = bat * (k * p) + kk * p + j;
-					sum +=
-					    a[physicalOffset(lhsIdx, lhsLayout)] * b[physicalOffset(rhsIdx, rhsLayout)];
-				}
-				size_t outIdx = bat * (m * p) + i * p + j;
-				c[physicalOffset(outIdx, outLayout)] = sum;
-			}
+	return dispatchDType(dtype, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+
+		auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), dtype);
+
+		dispatchOperand<T>(lhs, [&](auto* lhsTag) {
+			dispatchOperand<T>(rhs, [&](auto* rhsTag) {
+				cpu::matmul(lhs->template data<Element<decltype(lhsTag)>>(), lhsLayout,
+				            rhs->template data<Element<decltype(rhsTag)>>(), rhsLayout,
+				            result->template data<T>(), outLayout, batch, m, k, p);
+			});
+		});
+
+		return std::unique_ptr<Tensor::Impl>(result);
+	});
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::matmulInt8(
+    const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl, const TensorLayout& rhsLayout,
+    const TensorLayout& outLayout, size_t batch, size_t m, size_t k, size_t p,
+    int32_t lhsZeroPoint, int32_t rhsZeroPoint, const Requantize* requantize) const {
+	NFORGE_OP_SCOPE(MatmulInt8, batch * m * k * p);
+
+	const int8_t* rhs = static_cast<const Tensor::CPUImpl*>(rhsImpl)->data<int8_t>();
+	DType outType = requantize != nullptr ? requantize->dtype : DType::Int32;
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), outType);
+
+	auto run = [&](const auto* lhs) {
+		if (requantize == nullptr) {
+			cpu::matmulInt8(lhs, lhsLayout, rhs, rhsLayout, result->data<int32_t>(), outLayout,
+			                batch, m, k, p, lhsZeroPoint, rhsZeroPoint, cpu::StoreInt32{});
+			return;
 		}
+
+		const auto* multiplier = static_cast<const Tensor::CPUImpl*>(requantize->multiplier);
+		size_t stride = multiplier->getNumElements() == 1 ? 0 : 1;
+		float zeroPoint = static_cast<float>(requantize->zeroPoint);
+
+		if (outType == DType::Int8) {
+			cpu::Requantize<int8_t> epilogue{multiplier->data<float>(), stride, zeroPoint};
+			cpu::matmulInt8(lhs, lhsLayout, rhs, rhsLayout, result->data<int8_t>(), outLayout,
+			                batch, m, k, p, lhsZeroPoint, rhsZeroPoint, epilogue);
+		} else {
+			cpu::Requantize<uint8_t> epilogue{multiplier->data<float>(), stride, zeroPoint};
+			cpu::matmulInt8(lhs, lhsLayout, rhs, rhsLayout, result->data<uint8_t>(), outLayout,
+			                batch, m, k, p, lhsZeroPoint, rhsZeroPoint, epilogue);
+		}
+	};
+
+	if (m_dtype == DType::Int8) {
+		run(data<int8_t>());
+	} else {
+		run(data<uint8_t>());
 	}
 
 	return std::unique_ptr<Tensor::Impl>(result);
 }
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::conv(const TensorLayout& layout,
+                                                    const Tensor::Impl* weightImpl,
+                                                    const TensorLayout& weightLayout,
+                                                    const TensorLayout& outLayout,
+                                                    const Convolution& geometry,
+                                                    DType dtype) const {
+	NFORGE_OP_SCOPE(Conv, cpu::getNumElements(outLayout) * geometry.inChannels *
+	                          geometry.kernelHeight * geometry.kernelWidth);
+
+	std::unique_ptr<Tensor::CPUImpl> inStaging, weightStaging;
+	const auto* in = operandAs(this, dtype, inStaging);
+	const auto* weight = operandAs(weightImpl, dtype, weightStaging);
+
+	return dispatchDType(dtype, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+
+		auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), dtype);
+
+		dispatchOperand<T>(in, [&](auto* inTag) {
+			dispatchOperand<T>(weight, [&](auto* weightTag) {
+				cpu::conv2d(in->template data<Element<decltype(inTag)>>(), layout,
+				            weight->template data<Element<decltype(weightTag)>>(), weightLayout,
+				            result->template data<T>(), geometry);
+			});
+		});
+
+		return std::unique_ptr<Tensor::Impl>(result);
+	});
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::quantize(const TensorLayout& layout,
+                                                        const Tensor::Impl* scaleImpl,
+                                                        const TensorLayout& scaleLayout,
+                                                        const Tensor::Impl* zeroPointImpl,
+                                                        const TensorLayout& zeroPointLayout,
+                                                        const TensorLayout& outLayout,
+                                                        DType dtype) const {
+	NFORGE_OP_SCOPE(Quantize, cpu::getNumElements(outLayout));
+
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout), dtype);
+	if (dtype == DType::Int8) {
+		applyAffine(this, layout, scaleImpl, scaleLayout, zeroPointImpl, zeroPointLayout,
+		            result->data<int8_t>(), outLayout, cpu::Quantize<int8_t>{});
+	} else {
+		applyAffine(this, layout, scaleImpl, scaleLayout, zeroPointImpl, zeroPointLayout,
+		            result->data<uint8_t>(), outLayout, cpu::Quantize<uint8_t>{});
+	}
+
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::dequantize(const TensorLayout& layout,
+                                                          const Tensor::Impl* scaleImpl,
+                                                          const TensorLayout& scaleLayout,
+                                                          const Tensor::Impl* zeroPointImpl,
+                                                          const TensorLayout& zeroPointLayout,
+                                                          const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(Dequantize, cpu::getNumElements(outLayout));
+
+	auto* result = new Tensor::CPUImpl(Tensor::Shape(outLayout));
+	applyAffine(this, layout, scaleImpl, scaleLayout, zeroPointImpl, zeroPointLayout,
+	            result->data<float>(), outLayout, cpu::Dequantize{});
+
+	return std::unique_ptr<Tensor::Impl>(result);
+}
+
+/// Calls `f` with a null pointer to the element type of a linear algebra operand, double for
+/// Float64 and float for Float32.
+template <typename F>
+static decltype(auto) dispatchReal(DType dtype, F&& f) {
+	if (dtype == DType::Float64) {
+		return f(static_cast<double*>(nullptr));
+	}
+	return f(static_cast<float*>(nullptr));
+}
+
+bool Tensor::CPUImpl::cholesky(size_t batch, size_t n) {
+	NFORGE_OP_SCOPE(Cholesky, batch * n * n);
+
+	return dispatchReal(m_dtype, [&](auto* tag) {
+		return cpu::cholesky(data<Element<decltype(tag)>>(), batch, n);
+	});
+}
+
+void Tensor::CPUImpl::lu(size_t batch, size_t n, Tensor::Impl* permutationImpl) {
+	NFORGE_OP_SCOPE(LU, batch * n * n);
+
+	auto* permutation = static_cast<Tensor::CPUImpl*>(permutationImpl);
+	dispatchReal(m_dtype, [&](auto* tag) {
+		cpu::lu(data<Element<decltype(tag)>>(), permutation->data<int64_t>(), batch, n);
+	});
+}
+
+void Tensor::CPUImpl::qr(size_t batch, size_t m, size_t n, Tensor::Impl* qImpl,
+                         Tensor::Impl* rImpl) {
+	NFORGE_OP_SCOPE(QR, batch * m * n);
+
+	auto* q = static_cast<Tensor::CPUImpl*>(qImpl);
+	auto* r = static_cast<Tensor::CPUImpl*>(rImpl);
+	dispatchReal(m_dtype, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		cpu::qr(data<T>(), q->data<T>(), r->data<T>(), batch, m, n);
+	});
+}
+
+bool Tensor::CPUImpl::solveTriangular(size_t batch, size_t n, size_t k, Tensor::Impl* rhsImpl,
+                                      bool lower, bool unitDiagonal) const {
+	NFORGE_OP_SCOPE(SolveTriangular, batch * n * k);
+
+	auto* rhs = static_cast<Tensor::CPUImpl*>(rhsImpl);
+	return dispatchReal(m_dtype, [&](auto* tag) {
+		using T = Element<decltype(tag)>;
+		return cpu::solveTriangular(data<T>(), rhs->data<T>(), batch, n, k, lower, unitDiagonal);
+	});
+}
+
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::equal(const TensorLayout& lhsLayout,
                                                      const Tensor::Impl* rhsImpl,
                                                      const TensorLayout& rhsLayout,
-                                                     const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a == b ? 1.0f : 0.0f; });
+                                                     const TensorLayout& outLayout,
+                                                     DType dtype) const {
+	NFORGE_OP_SCOPE(Equal, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::BoolType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::Equal{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::notEqual(const TensorLayout& lhsLayout,
                                                         const Tensor::Impl* rhsImpl,
                                                         const TensorLayout& rhsLayout,
-                                                        const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a != b ? 1.0f : 0.0f; });
+                                                        const TensorLayout& outLayout,
+                                                        DType dtype) const {
+	NFORGE_OP_SCOPE(NotEqual, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::BoolType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::NotEqual{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::less(const TensorLayout& lhsLayout,
                                                     const Tensor::Impl* rhsImpl,
                                                     const TensorLayout& rhsLayout,
-                                                    const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a < b ? 1.0f : 0.0f; });
+                                                    const TensorLayout& outLayout,
+                                                    DType dtype) const {
+	NFORGE_OP_SCOPE(Less, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::BoolType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::Less{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::lessEqual(const TensorLayout& lhsLayout,
                                                          const Tensor::Impl* rhsImpl,
                                                          const TensorLayout& rhsLayout,
-                                                         const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a <= b ? 1.0f : 0.0f; });
+                                                         const TensorLayout& outLayout,
+                                                         DType dtype) const {
+	NFORGE_OP_SCOPE(LessEqual, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::BoolType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::LessEqual{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::greater(const TensorLayout& lhsLayout,
                                                        const Tensor::Impl* rhsImpl,
                                                        const TensorLayout& rhsLayout,
-                                                       const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a > b ? 1.0f : 0.0f; });
+                                                       const TensorLayout& outLayout,
+                                                       DType dtype) const {
+	NFORGE_OP_SCOPE(Greater, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::BoolType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::Greater{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::greaterEqual(const TensorLayout& lhsLayout,
                                                             const Tensor::Impl* rhsImpl,
                                                             const TensorLayout& rhsLayout,
-                                                            const TensorLayout& outLayout) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout,
-	                     [](float a, float b) { return a >= b ? 1.0f : 0.0f; });
+                                                            const TensorLayout& outLayout,
+                                                            DType dtype) const {
+	NFORGE_OP_SCOPE(GreaterEqual, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::BoolType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::GreaterEqual{});
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CPUImpl::isClose(const TensorLayout& lhsLayout,
                                                        const Tensor::Impl* rhsImpl,
                                                        const TensorLayout& rhsLayout,
                                                        const TensorLayout& outLayout,
-                                                       float tolerance) const {
-	return applyBinaryOp(lhsLayout, rhsImpl, rhsLayout, outLayout, [tolerance](float a, float b) {
-		float absDiff = std::abs(a - b);
-		float denom = std::max(1.00f, std::abs(b));
-		return (absDiff / denom <= tolerance) ? 1.0f : 0.0f;
-	});
+                                                       float tolerance, DType dtype) const {
+	NFORGE_OP_SCOPE(IsClose, cpu::getNumElements(outLayout));
+
+	return applyBinaryOp<cpu::BoolType>(lhsLayout, rhsImpl, rhsLayout, outLayout, dtype,
+	                                     cpu::IsClose{tolerance});
 }
\ No newline at end of file
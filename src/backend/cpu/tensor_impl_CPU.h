@@ -2,10 +2,13 @@
 #define TENSOR_IMPL_CPU_H
 
 #include "../tensor_impl.h"
+#include "backend/cpu/kernels_CPU.h"
+#include "backend/dtype_dispatch.h"
 #include "nforge/core/tensor_layout.h"
 #include "nforge/core/tensor_shape.h"
+#include "profiling/memory.h"
 
-/// CPU implementation of Tensor::Impl, backed by std::vector<float>.
+/// CPU implementation of Tensor::Impl, backed by a byte buffer of `getDType()` elements.
 ///
 /// All operations iterate over the data using TensorLayout descriptors.
 /// The caller is responsible for layout validity, see Tensor::Impl.
@@ -13,49 +16,63 @@
 /// Overridden methods follow the same semantics documented in Tensor::Impl.
 class Tensor::CPUImpl : public Tensor::Impl {
 public:
-	CPUImpl(const Tensor::Shape& shape);
+	CPUImpl(const Tensor::Shape& shape, DType dtype = DType::Float32);
 	CPUImpl(const Tensor::Shape& shape, float value);
 	~CPUImpl();
 
 	void fillAll(float value) override;
-	void fillRand() override;
+	void fillRandom(const rng::Distribution& dist, const rng::Stream& stream) override;
 
 	void print() const override;
 	void print(const std::vector<size_t>& position) const override;
 
 	size_t getNumElements() const override;
 	Tensor::Shape getShape() const override;
+	DType getDType() const override;
 
 	/// Returns a raw pointer to the internal data buffer.
+	/// @pre The dtype is Float32.
 	float* dataPtr() const;
+
+	/// Returns the internal data buffer as elements of type `T`.
+	/// @pre `T` is the element type of the dtype, see `ElementType`.
+	template <typename T>
+	T* data() const {
+		assert(dtypeOf<T>() == m_dtype);
+		return reinterpret_cast<T*>(const_cast<uint8_t*>(m_data.data()));
+	}
+
 	std::vector<float> toVector() const override;
+	void copyToHost(void* data) const override;
 	std::string toString() const override;
 
 	std::unique_ptr<Tensor::Impl> clone() const override;
 
 	void copyFromHost(const float* data, size_t count) override;
+	void copyFromHost(const void* data) override;
 
 	void set(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	         const TensorLayout& rhsLayout) override;
+	void setAll(const std::vector<SetCopy>& copies) override;
 
 	bool compare(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	             const TensorLayout& rhsLayout) const override;
 
 	std::unique_ptr<Tensor::Impl> add(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> sub(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> mul(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> div(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	void iadd(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	          const TensorLayout& rhsLayout) override;
@@ -69,6 +86,9 @@ public:
 	void idiv(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	          const TensorLayout& rhsLayout) override;
 
+	void maskedFill(const TensorLayout& lhsLayout, const Tensor::Impl* maskImpl,
+	                const TensorLayout& maskLayout, float value) override;
+
 	std::unique_ptr<Tensor::Impl> sum(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                  const TensorLayout& outLayout) const override;
 
@@ -81,7 +101,8 @@ public:
 	std::unique_ptr<Tensor::Impl> prod(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                   const TensorLayout& outLayout) const override;
 
-	std::unique_ptr<Tensor::Impl> norm(const TensorLayout& layout) const override;
+	std::unique_ptr<Tensor::Impl> norm(const TensorLayout& layout, const TensorLayout& blockLayout,
+	                                   const TensorLayout& outLayout) const override;
 
 	std::unique_ptr<Tensor::Impl> all(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                  const TensorLayout& outLayout) const override;
@@ -89,73 +110,167 @@ public:
 	std::unique_ptr<Tensor::Impl> any(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                  const TensorLayout& outLayout) const override;
 
+	std::unique_ptr<Tensor::Impl> countNonzero(const TensorLayout& layout,
+	                                           const TensorLayout& blockLayout,
+	                                           const TensorLayout& outLayout) const override;
+
+	std::unique_ptr<Tensor::Impl> argmin(const TensorLayout& layout,
+	                                     const TensorLayout& blockLayout,
+	                                     const TensorLayout& outLayout) const override;
+
+	std::unique_ptr<Tensor::Impl> argmax(const TensorLayout& layout,
+	                                     const TensorLayout& blockLayout,
+	                                     const TensorLayout& outLayout) const override;
+
+	void topk(const TensorLayout& layout, const TensorLayout& blockLayout, size_t k, bool largest,
+	          Tensor::Impl* valuesImpl, Tensor::Impl* indicesImpl) const override;
+
+	void sort(const TensorLayout& layout, const TensorLayout& blockLayout, bool descending,
+	          Tensor::Impl* valuesImpl, Tensor::Impl* indicesImpl) const override;
+
+	std::unique_ptr<Tensor::Impl> partition(const TensorLayout& layout,
+	                                        const TensorLayout& blockLayout,
+	                                        size_t kth) const override;
+
+	std::unique_ptr<Tensor::Impl> scan(const TensorLayout& layout, size_t dim, ScanOp op,
+	                                   bool exclusive) const override;
+
+	std::unique_ptr<Tensor::Impl> gather(const TensorLayout& layout, size_t dim,
+	                                     const Tensor::Impl* indexImpl,
+	                                     const TensorLayout& indexLayout) const override;
+
+	void scatter(const TensorLayout& layout, size_t dim, const Tensor::Impl* indexImpl,
+	             const TensorLayout& indexLayout, const Tensor::Impl* srcImpl,
+	             const TensorLayout& srcLayout, bool accumulate) override;
+
+	bool reducePredicate(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
+	                     const TensorLayout& rhsLayout, Predicate predicate, float tolerance,
+	                     bool all, DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> map(const TensorLayout& layout, UnaryOp op, float alpha,
+	                                  float beta, DType dtype) const override;
+
+	void mapInto(const TensorLayout& layout, const Tensor::Impl* srcImpl,
+	             const TensorLayout& srcLayout, UnaryOp op, float alpha, float beta,
+	             DType dtype) override;
+
+	std::unique_ptr<Tensor::Impl> softmax(const TensorLayout& layout,
+	                                      const TensorLayout& blockLayout,
+	                                      bool log) const override;
+
+	std::unique_ptr<Tensor::Impl> logSumExp(const TensorLayout& layout,
+	                                        const TensorLayout& blockLayout,
+	                                        const TensorLayout& outLayout) const override;
+
 
 	std::unique_ptr<Tensor::Impl> matmul(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                     const TensorLayout& rhsLayout,
 	                                     const TensorLayout& outLayout, size_t batch, size_t m,
-	                                     size_t k, size_t p) const override;
+	                                     size_t k, size_t p, DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> matmulInt8(const TensorLayout& lhsLayout,
+	                                         const Tensor::Impl* rhsImpl,
+	                                         const TensorLayout& rhsLayout,
+	                                         const TensorLayout& outLayout, size_t batch, size_t m,
+	                                         size_t k, size_t p, int32_t lhsZeroPoint,
+	                                         int32_t rhsZeroPoint,
+	                                         const Requantize* requantize) const override;
+
+	std::unique_ptr<Tensor::Impl> conv(const TensorLayout& layout, const Tensor::Impl* weightImpl,
+	                                   const TensorLayout& weightLayout,
+	                                   const TensorLayout& outLayout, const Convolution& geometry,
+	                                   DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> quantize(const TensorLayout& layout,
+	                                       const Tensor::Impl* scaleImpl,
+	                                       const TensorLayout& scaleLayout,
+	                                       const Tensor::Impl* zeroPointImpl,
+	                                       const TensorLayout& zeroPointLayout,
+	                                       const TensorLayout& outLayout,
+	                                       DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> dequantize(const TensorLayout& layout,
+	                                         const Tensor::Impl* scaleImpl,
+	                                         const TensorLayout& scaleLayout,
+	                                         const Tensor::Impl* zeroPointImpl,
+	                                         const TensorLayout& zeroPointLayout,
+	                                         const TensorLayout& outLayout) const override;
+
+	bool cholesky(size_t batch, size_t n) override;
+
+	void lu(size_t batch, size_t n, Tensor::Impl* permutationImpl) override;
+
+	void qr(size_t batch, size_t m, size_t n, Tensor::Impl* qImpl, Tensor::Impl* rImpl) override;
+
+	bool solveTriangular(size_t batch, size_t n, size_t k, Tensor::Impl* rhsImpl, bool lower,
+	                     bool unitDiagonal) const override;
 
 
 	std::unique_ptr<Tensor::Impl> equal(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                    const TensorLayout& rhsLayout,
-	                                    const TensorLayout& outLayout) const override;
+	                                    const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> notEqual(const TensorLayout& lhsLayout,
 	                                       const Tensor::Impl* rhsImpl,
 	                                       const TensorLayout& rhsLayout,
-	                                       const TensorLayout& outLayout) const override;
+	                                       const TensorLayout& outLayout,
+	                                       DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> less(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                   const TensorLayout& rhsLayout,
-	                                   const TensorLayout& outLayout) const override;
+	                                   const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> lessEqual(const TensorLayout& lhsLayout,
 	                                        const Tensor::Impl* rhsImpl,
 	                                        const TensorLayout& rhsLayout,
-	                                        const TensorLayout& outLayout) const override;
+	                                        const TensorLayout& outLayout,
+	                                        DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> greater(const TensorLayout& lhsLayout,
 	                                      const Tensor::Impl* rhsImpl,
 	                                      const TensorLayout& rhsLayout,
-	                                      const TensorLayout& outLayout) const override;
+	                                      const TensorLayout& outLayout,
+	                                      DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> greaterEqual(const TensorLayout& lhsLayout,
 	                                           const Tensor::Impl* rhsImpl,
 	                                           const TensorLayout& rhsLayout,
-	                                           const TensorLayout& outLayout) const override;
+	                                           const TensorLayout& outLayout,
+	                                           DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> isClose(const TensorLayout& lhsLayout,
 	                                      const Tensor::Impl* rhsImpl,
 	                                      const TensorLayout& rhsLayout,
 	                                      const TensorLayout& outLayout,
-	                                      float tolerance) const override;
+	                                      float tolerance, DType dtype) const override;
 
 private:
 	Tensor::Shape m_shape;
-	std::vector<float> m_data;
+	DType m_dtype;
+	profiling::detail::TrackedAllocation m_allocation;
+	std::vector<uint8_t> m_data;
 
-	template <typename BinaryOp>
+	/// Computes in `dtype`, the result has element type `Out<T>` for the element type `T` of
+	/// `dtype`, see `cpu::SameType` and `cpu::BoolType`.
+	template <template <typename> class Out, typename BinaryOp>
 	std::unique_ptr<Tensor::Impl> applyBinaryOp(const TensorLayout& lhsLayout,
 	                                            const Tensor::Impl* rhsImpl,
 	                                            const TensorLayout& rhsLayout,
-	                                            const TensorLayout& outLayout, BinaryOp op) const;
+	                                            const TensorLayout& outLayout, DType dtype,
+	                                            BinaryOp op) const;
 
+	/// Converts the rhs to the dtype of this first, unless it is Bool.
 	template <typename BinaryOp>
 	void applyInplaceBinaryOp(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                          const TensorLayout& rhsLayout, BinaryOp op);
 
 
-	struct Identity {
-		template <typename T>
-		constexpr T&& operator()(T&& t) const noexcept {
-			return std::forward<T>(t);
-		}
-	};
-
 	// reduction must be associative
 	// x = f(x) must be true.
 	// transform is applied to the first element, so transform(x) = f(x) must be true.
-	template <typename ReductionOp, typename Transform = Identity>
+	// Result has element type `Out<In>` for the element type `In` of this.
+	template <template <typename> class Out, typename ReductionOp,
+	          typename Transform = cpu::Identity>
 	std::unique_ptr<Tensor::Impl> applyReductionOp(const TensorLayout& layout,
 	                                               const TensorLayout& blockLayout,
 	                                               const TensorLayout& outLayout, ReductionOp op,
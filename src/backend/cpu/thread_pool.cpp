@@ -0,0 +1,195 @@
+#include "backend/cpu/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cpu {
+
+namespace {
+
+/// Set on threads that are running ranges of a `parallelFor`.
+thread_local bool t_inParallelFor = false;
+
+/// Threads set by `setNumThreads`, 0 if unset.
+std::atomic<size_t> g_numThreads{0};
+
+/// NFORGE_NUM_THREADS, the hardware concurrency if it is unset.
+size_t getDefaultNumThreads() {
+	static const size_t numThreads = []() -> size_t {
+		if (const char* value = std::getenv("NFORGE_NUM_THREADS")) {
+			long parsed = std::strtol(value, nullptr, 10);
+			if (parsed > 0) {
+				return static_cast<size_t>(parsed);
+			}
+		}
+		return std::max(1u, std::thread::hardware_concurrency());
+	}();
+	return numThreads;
+}
+
+/// Workers that sleep until `run` hands them a job. One job runs at a time, its ranges are
+/// claimed through an atomic counter by the workers and the calling thread alike.
+class ThreadPool {
+public:
+	explicit ThreadPool(size_t numWorkers) {
+		m_workers.reserve(numWorkers);
+		for (size_t i = 0; i < numWorkers; i++) {
+			m_workers.emplace_back([this]() { work(); });
+		}
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for (std::thread& worker : m_workers) worker.join();
+	}
+
+	/// Runs `numRanges` ranges of `chunk` items on the calling thread and at most `numWorkers`
+	/// workers, false if another thread holds the pool.
+	bool run(size_t count, size_t chunk, size_t numRanges, size_t numWorkers,
+	         const std::function<void(size_t, size_t)>& job) {
+		std::unique_lock<std::mutex> running(m_running, std::try_to_lock);
+		if (!running.owns_lock()) {
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = &job;
+			m_count = count;
+			m_chunk = chunk;
+			m_numRanges = numRanges;
+			m_numJoining = numWorkers;
+			m_next.store(0, std::memory_order_relaxed);
+			m_joined.store(0, std::memory_order_relaxed);
+			m_error = nullptr;
+			m_busy = m_workers.size();
+			m_generation++;
+		}
+		m_wake.notify_all();
+
+		runRanges();
+
+		std::exception_ptr error;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [this]() { return m_busy == 0; });
+			error = m_error;
+			m_job = nullptr;
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+		return true;
+	}
+
+private:
+	std::vector<std::thread> m_workers;
+
+	/// Held by the thread that runs the current job.
+	std::mutex m_running;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	bool m_stop = false;
+	size_t m_generation = 0;
+	size_t m_busy = 0;
+
+	const std::function<void(size_t, size_t)>* m_job = nullptr;
+	size_t m_count = 0;
+	size_t m_chunk = 0;
+	size_t m_numRanges = 0;
+	/// Workers that may take ranges of the current job, the others go back to sleep.
+	size_t m_numJoining = 0;
+	std::atomic<size_t> m_joined{0};
+	std::atomic<size_t> m_next{0};
+	std::exception_ptr m_error;
+
+	void work() {
+		size_t seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+				if (m_stop) {
+					return;
+				}
+				seen = m_generation;
+			}
+
+			if (m_joined.fetch_add(1, std::memory_order_relaxed) < m_numJoining) {
+				runRanges();
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_busy == 0) {
+				m_done.notify_one();
+			}
+		}
+	}
+
+	void runRanges() {
+		t_inParallelFor = true;
+		while (true) {
+			size_t range = m_next.fetch_add(1, std::memory_order_relaxed);
+			if (range >= m_numRanges) {
+				break;
+			}
+
+			size_t begin = range * m_chunk;
+			try {
+				(*m_job)(begin, std::min(begin + m_chunk, m_count));
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_error) {
+					m_error = std::current_exception();
+				}
+			}
+		}
+		t_inParallelFor = false;
+	}
+};
+
+ThreadPool& getPool() {
+	static ThreadPool pool(getDefaultNumThreads() - 1);
+	return pool;
+}
+
+}  // namespace
+
+size_t getNumThreads() {
+	size_t numThreads = g_numThreads.load(std::memory_order_relaxed);
+	return numThreads > 0 ? numThreads : getDefaultNumThreads();
+}
+
+void setNumThreads(size_t numThreads) {
+	g_numThreads.store(numThreads, std::memory_order_relaxed);
+}
+
+void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& job) {
+	if (count == 0) {
+		return;
+	}
+
+	// a few ranges per thread so uneven ranges still balance
+	size_t numThreads = getNumThreads();
+	size_t chunk = std::max({grain, size_t{1}, (count + 4 * numThreads - 1) / (4 * numThreads)});
+	size_t numRanges = (count + chunk - 1) / chunk;
+
+	if (numThreads == 1 || numRanges == 1 || t_inParallelFor ||
+	    !getPool().run(count, chunk, numRanges, numThreads - 1, job)) {
+		job(0, count);
+	}
+}
+
+}  // namespace cpu
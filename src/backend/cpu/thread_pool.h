@@ -0,0 +1,29 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace cpu {
+
+/// Returns the number of threads `parallelFor` runs on at most, the calling thread included. Set
+/// by `setNumThreads`, else by the NFORGE_NUM_THREADS environment variable, the hardware
+/// concurrency if it is unset.
+size_t getNumThreads();
+
+/// Overrides `getNumThreads`, 0 restores the default. Fewer threads leave the other workers of
+/// the pool asleep. The pool keeps the workers it was started with, so more threads than
+/// NFORGE_NUM_THREADS or the hardware split the work finer without running on more threads.
+void setNumThreads(size_t numThreads);
+
+/// Calls `job(begin, end)` for ranges covering [0, count), each at least `grain` long except for
+/// the last, on the calling thread and the workers of a shared pool. Returns when every range is
+/// done and rethrows the first exception a job threw.
+///
+/// Calls from inside a job, or from a second thread while the pool is busy, run every range on
+/// the calling thread, so nested kernels never wait on the pool.
+void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& job);
+
+}  // namespace cpu
+
+#endif  // THREAD_POOL_H
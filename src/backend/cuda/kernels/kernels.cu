@@ -1,5 +1,7 @@
 #include "backend/cuda/kernels/kernels.cuh"
 
+#include <cfloat>
+
 __device__ __forceinline__ size_t physicalOffsetCUDA(size_t linear, const TensorLayout& L) {
 	size_t off = L.offset;
 	for (int d = (int)L.rank - 1; d >= 0; d--) {
@@ -76,6 +78,21 @@ __global__ void fillKernel(float* __restrict__ data, float value, size_t count)
 		data[i] = value;
 }
 
+__global__ void fillRandomKernel(float* __restrict__ data, size_t count,
+                                 const rng::Distribution dist, const rng::Stream stream) {
+	size_t index = blockIdx.x * blockDim.x + threadIdx.x;
+	size_t first = index * rng::ELEMENTS_PER_BLOCK;
+	if (first >= count)
+		return;
+
+	float block[rng::ELEMENTS_PER_BLOCK];
+	rng::generateBlock(stream, dist, index, block);
+
+	for (size_t i = 0; i < rng::ELEMENTS_PER_BLOCK && first + i < count; i++) {
+		data[first + i] = block[i];
+	}
+}
+
 __global__ void setKernel(float* __restrict__ dst, const TensorLayout dstLayout,
                           const float* __restrict__ src, const TensorLayout srcLayout,
                           size_t count) {
@@ -265,22 +282,39 @@ __global__ void idivKernel(float* __restrict__ lhs, const TensorLayout lhsLayout
 	lhs[lhsIdx] /= rhs[rhsIdx];
 }
 
-__global__ void isqrtKernel(float* __restrict__ data, size_t count) {
+__global__ void maskedFillKernel(float* __restrict__ lhs, const TensorLayout lhsLayout,
+                                 const float* __restrict__ mask, const TensorLayout maskLayout,
+                                 float value, size_t count) {
 	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
 
 	if (i >= count)
 		return;
-	data[i] = sqrt(data[i]);
+
+	size_t lhsIdx = physicalOffsetCUDA(i, lhsLayout);
+	size_t maskIdx = physicalOffsetCUDA(i, maskLayout);
+	if (mask[maskIdx] != 0.0f)
+		lhs[lhsIdx] = value;
 }
 
-__global__ void squareSumKernel(const float* __restrict__ data, float* result, size_t count) {
+__global__ void isqrtKernel(float* __restrict__ data, size_t count) {
 	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
 
 	if (i >= count)
 		return;
-	float x = data[i] * data[i];
+	data[i] = sqrt(data[i]);
+}
 
-	atomicAdd(result, x);
+__global__ void squareSumReductionKernel(const float* __restrict__ data, float* result,
+                                         const TensorLayout layout, size_t blockCount,
+                                         const TensorLayout outLayout, size_t outCount) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= blockCount * outCount)
+		return;
+
+	size_t outIdx = physicalOffsetCUDA(i / blockCount, outLayout);
+	float x = data[physicalOffsetCUDA(i, layout)];
+
+	atomicAdd(&result[outIdx], x * x);
 }
 
 __device__ static float atomicMin(float* address, float val) {
@@ -429,6 +463,357 @@ __global__ void anyReductionKernel(const float* __restrict__ data, float* result
 	atomicORFloat(&result[outIdx], data[dataIdx]);
 }
 
+__global__ void countNonzeroReductionKernel(const float* __restrict__ data, float* result,
+                                            const TensorLayout layout, size_t blockCount,
+                                            const TensorLayout outLayout, size_t outCount) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= blockCount * outCount)
+		return;
+
+	size_t outIdx = physicalOffsetCUDA(i / blockCount, outLayout);
+	size_t dataIdx = physicalOffsetCUDA(i, layout);
+
+	if (data[dataIdx] != 0.0f) {
+		atomicAdd(&result[outIdx], 1.0f);
+	}
+}
+
+__global__ void argExtremeKernel(const float* __restrict__ in, const TensorLayout layout,
+                                 int64_t* __restrict__ out, size_t blockCount, size_t numBlocks,
+                                 bool max) {
+	size_t block = blockIdx.x * blockDim.x + threadIdx.x;
+	if (block >= numBlocks)
+		return;
+
+	size_t base = block * blockCount;
+	float best = in[physicalOffsetCUDA(base, layout)];
+	size_t index = 0;
+	for (size_t j = 1; j < blockCount && !isnan(best); j++) {
+		float x = in[physicalOffsetCUDA(base + j, layout)];
+		if (isnan(x) || (max ? x > best : x < best)) {
+			best = x;
+			index = j;
+		}
+	}
+	out[block] = (int64_t)index;
+}
+
+// true if entry a is selected before entry b, earlier indices win ties
+__device__ static bool topkBefore(float a, int64_t ia, float b, int64_t ib, bool largest) {
+	bool better = largest ? a > b : a < b;
+	bool worse = largest ? a < b : a > b;
+	return better || (!worse && ia < ib);
+}
+
+// restores the heap of `n` entries below `i`, the weakest entry at the root
+__device__ static void topkSiftDown(float* values, int64_t* indices, size_t i, size_t n,
+                                    bool largest) {
+	while (true) {
+		size_t weakest = i;
+		size_t left = 2 * i + 1;
+		size_t right = left + 1;
+		if (left < n && topkBefore(values[weakest], indices[weakest], values[left], indices[left],
+		                           largest))
+			weakest = left;
+		if (right < n && topkBefore(values[weakest], indices[weakest], values[right],
+		                            indices[right], largest))
+			weakest = right;
+		if (weakest == i)
+			return;
+
+		float value = values[i];
+		values[i] = values[weakest];
+		values[weakest] = value;
+		int64_t index = indices[i];
+		indices[i] = indices[weakest];
+		indices[weakest] = index;
+		i = weakest;
+	}
+}
+
+__global__ void topkKernel(const float* __restrict__ in, const TensorLayout layout,
+                           float* __restrict__ values, int64_t* __restrict__ indices,
+                           size_t blockCount, size_t numBlocks, size_t k, bool largest) {
+	size_t block = blockIdx.x * blockDim.x + threadIdx.x;
+	if (block >= numBlocks || k == 0)
+		return;
+
+	size_t base = block * blockCount;
+	float* v = values + block * k;
+	int64_t* idx = indices + block * k;
+
+	for (size_t j = 0; j < k; j++) {
+		v[j] = in[physicalOffsetCUDA(base + j, layout)];
+		idx[j] = (int64_t)j;
+	}
+	for (size_t i = k / 2; i-- > 0;) topkSiftDown(v, idx, i, k, largest);
+
+	// later elements only enter when strictly better than the root
+	for (size_t j = k; j < blockCount; j++) {
+		float x = in[physicalOffsetCUDA(base + j, layout)];
+		if (largest ? x > v[0] : x < v[0]) {
+			v[0] = x;
+			idx[0] = (int64_t)j;
+			topkSiftDown(v, idx, 0, k, largest);
+		}
+	}
+
+	// heap sort, the weakest entries move to the back
+	for (size_t n = k; n > 1; n--) {
+		float value = v[0];
+		v[0] = v[n - 1];
+		v[n - 1] = value;
+		int64_t index = idx[0];
+		idx[0] = idx[n - 1];
+		idx[n - 1] = index;
+		topkSiftDown(v, idx, 0, n - 1, largest);
+	}
+}
+
+// unsigned key ordering like `x`, every NaN maps to the largest key
+__device__ static uint32_t sortKey(float x) {
+	uint32_t bits = __float_as_uint(x);
+	if (isnan(x))
+		return 0xFFFFFFFFu;
+	return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+// true if entry a sorts before entry b, earlier indices first among equal keys
+__device__ static bool sortBefore(const uint32_t* keys, const int64_t* indices, size_t a,
+                                  size_t b) {
+	return keys[a] < keys[b] ||
+	       (indices != nullptr && keys[a] == keys[b] && indices[a] < indices[b]);
+}
+
+// restores the heap of `n` entries below `i`, the last in sort order at the root
+__device__ static void sortSiftDown(uint32_t* keys, int64_t* indices, size_t i, size_t n) {
+	while (true) {
+		size_t last = i;
+		size_t left = 2 * i + 1;
+		size_t right = left + 1;
+		if (left < n && sortBefore(keys, indices, last, left))
+			last = left;
+		if (right < n && sortBefore(keys, indices, last, right))
+			last = right;
+		if (last == i)
+			return;
+
+		uint32_t key = keys[i];
+		keys[i] = keys[last];
+		keys[last] = key;
+		if (indices != nullptr) {
+			int64_t index = indices[i];
+			indices[i] = indices[last];
+			indices[last] = index;
+		}
+		i = last;
+	}
+}
+
+__global__ void sortKernel(const float* __restrict__ in, const TensorLayout layout,
+                           float* __restrict__ values, int64_t* __restrict__ indices,
+                           size_t blockCount, size_t numBlocks, bool descending) {
+	size_t block = blockIdx.x * blockDim.x + threadIdx.x;
+	if (block >= numBlocks)
+		return;
+
+	size_t base = block * blockCount;
+	uint32_t* keys = reinterpret_cast<uint32_t*>(values) + base;
+	int64_t* idx = indices == nullptr ? nullptr : indices + base;
+	uint32_t flip = descending ? 0xFFFFFFFFu : 0u;
+
+	for (size_t j = 0; j < blockCount; j++) {
+		keys[j] = sortKey(in[physicalOffsetCUDA(base + j, layout)]) ^ flip;
+		if (idx != nullptr)
+			idx[j] = (int64_t)j;
+	}
+
+	for (size_t i = blockCount / 2; i-- > 0;) sortSiftDown(keys, idx, i, blockCount);
+	for (size_t n = blockCount; n > 1; n--) {
+		uint32_t key = keys[0];
+		keys[0] = keys[n - 1];
+		keys[n - 1] = key;
+		if (idx != nullptr) {
+			int64_t index = idx[0];
+			idx[0] = idx[n - 1];
+			idx[n - 1] = index;
+		}
+		sortSiftDown(keys, idx, 0, n - 1);
+	}
+
+	// keys back to values in place
+	for (size_t j = 0; j < blockCount; j++) {
+		uint32_t key = keys[j] ^ flip;
+		values[base + j] = __uint_as_float((key & 0x80000000u) ? key & 0x7FFFFFFFu : ~key);
+	}
+}
+
+__global__ void scanKernel(const float* __restrict__ in, const TensorLayout layout,
+                           float* __restrict__ out, size_t length, size_t inner, size_t numLines,
+                           ScanOp op, bool exclusive) {
+	size_t line = blockIdx.x * blockDim.x + threadIdx.x;
+	if (line >= numLines)
+		return;
+
+	size_t base = (line / inner) * length * inner + line % inner;
+
+	float acc = op == ScanOp::Sum ? 0.0f : op == ScanOp::Prod ? 1.0f
+	          : op == ScanOp::Max ? -INFINITY : INFINITY;
+	for (size_t t = 0; t < length; t++) {
+		size_t pos = base + t * inner;
+		float x = in[physicalOffsetCUDA(pos, layout)];
+		if (exclusive)
+			out[pos] = acc;
+
+		switch (op) {
+			case ScanOp::Sum:
+				acc += x;
+				break;
+			case ScanOp::Prod:
+				acc *= x;
+				break;
+			case ScanOp::Max:
+				acc = fmaxf(acc, x);
+				break;
+			case ScanOp::Min:
+				acc = fminf(acc, x);
+				break;
+		}
+
+		if (!exclusive)
+			out[pos] = acc;
+	}
+}
+
+// offset in `layout` of the element at linear position `i` of `indexLayout`, with coordinate
+// `dim` replaced by `idx`
+__device__ __forceinline__ size_t gatherOffset(size_t i, const TensorLayout& layout, size_t dim,
+                                               const TensorLayout& indexLayout, size_t idx) {
+	size_t offset = layout.offset;
+	for (int d = indexLayout.rank - 1; d >= 0; d--) {
+		size_t coord = i % indexLayout.shape[d];
+		i /= indexLayout.shape[d];
+		offset += ((size_t)d == dim ? idx : coord) * layout.strides[d];
+	}
+	return offset;
+}
+
+__global__ void gatherKernel(const float* __restrict__ in, const TensorLayout layout, size_t dim,
+                             const float* __restrict__ index, const TensorLayout indexLayout,
+                             float* __restrict__ out, size_t count) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= count)
+		return;
+
+	float idx = index[physicalOffsetCUDA(i, indexLayout)];
+	if (idx < 0.0f || idx >= (float)layout.shape[dim]) {
+		out[i] = 0.0f;
+		return;
+	}
+	out[i] = in[gatherOffset(i, layout, dim, indexLayout, (size_t)idx)];
+}
+
+__global__ void scatterKernel(float* __restrict__ out, const TensorLayout layout, size_t dim,
+                              const float* __restrict__ index, const TensorLayout indexLayout,
+                              const float* __restrict__ src, const TensorLayout srcLayout,
+                              bool accumulate, size_t count) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= count)
+		return;
+
+	float idx = index[physicalOffsetCUDA(i, indexLayout)];
+	if (idx < 0.0f || idx >= (float)layout.shape[dim])
+		return;
+
+	size_t offset = gatherOffset(i, layout, dim, indexLayout, (size_t)idx);
+	float value = src[physicalOffsetCUDA(i, srcLayout)];
+	if (accumulate)
+		atomicAdd(out + offset, value);
+	else
+		out[offset] = value;
+}
+
+__global__ void softmaxKernel(const float* __restrict__ in, const TensorLayout layout,
+                              float* __restrict__ out, size_t blockCount, size_t numBlocks,
+                              SoftmaxMode mode) {
+	size_t block = blockIdx.x * blockDim.x + threadIdx.x;
+	if (block >= numBlocks)
+		return;
+
+	size_t base = block * blockCount;
+
+	// online max and sum, the sum is rescaled whenever the max grows
+	float max = -FLT_MAX;
+	float sum = 0.0f;
+	for (size_t j = 0; j < blockCount; j++) {
+		float x = in[physicalOffsetCUDA(base + j, layout)];
+		if (x > max) {
+			sum *= expf(max - x);
+			max = x;
+		}
+		sum += expf(x - max);
+	}
+
+	float shift = max + logf(sum);
+	if (mode == SoftmaxMode::LogSumExp) {
+		out[block] = shift;
+		return;
+	}
+
+	for (size_t j = 0; j < blockCount; j++) {
+		float x = in[physicalOffsetCUDA(base + j, layout)];
+		out[base + j] = mode == SoftmaxMode::LogSoftmax ? x - shift : expf(x - shift);
+	}
+}
+
+__global__ void unaryKernel(const float* __restrict__ in, const TensorLayout inLayout, float* out,
+                            const TensorLayout outLayout, size_t count, UnaryOp op, float alpha,
+                            float beta) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= count)
+		return;
+
+	// CUDA math library functions, their error bounds are listed in the CUDA programming guide
+	float x = in[physicalOffsetCUDA(i, inLayout)];
+	float y = x;
+	switch (op) {
+		case UnaryOp::Exp:
+			y = expf(x);
+			break;
+		case UnaryOp::Log:
+			y = logf(x);
+			break;
+		case UnaryOp::Sqrt:
+			y = sqrtf(x);
+			break;
+		case UnaryOp::Rsqrt:
+			y = rsqrtf(x);
+			break;
+		case UnaryOp::Abs:
+			y = fabsf(x);
+			break;
+		case UnaryOp::Tanh:
+			y = tanhf(x);
+			break;
+		case UnaryOp::Sigmoid:
+			y = 1.0f / (1.0f + expf(-x));
+			break;
+		case UnaryOp::Sin:
+			y = sinf(x);
+			break;
+		case UnaryOp::Cos:
+			y = cosf(x);
+			break;
+		case UnaryOp::Pow:
+			y = powf(x, alpha);
+			break;
+		case UnaryOp::Clamp:
+			y = fminf(fmaxf(x, alpha), beta);
+			break;
+	}
+	out[physicalOffsetCUDA(i, outLayout)] = y;
+}
+
 __global__ void matmulKernel(const float* __restrict__ lhs, const TensorLayout lhsLayout,
                              const float* __restrict__ rhs, const TensorLayout rhsLayout,
                              float* __restrict__ out, const TensorLayout outLayout, size_t batch,
@@ -454,4 +839,132 @@ __global__ void matmulKernel(const float* __restrict__ lhs, const TensorLayout l
 
 	size_t outIdx = bat * (m * p) + row * p + col;
 	out[physicalOffsetCUDA(outIdx, outLayout)] = sum;
-}
\ No newline at end of file
+}
+
+__global__ void quantizeKernel(const float* __restrict__ in, const TensorLayout inLayout,
+                               const float* __restrict__ scale, const TensorLayout scaleLayout,
+                               const float* __restrict__ zeroPoint,
+                               const TensorLayout zeroPointLayout, float* __restrict__ out,
+                               const TensorLayout outLayout, size_t count, float low, float high) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= count)
+		return;
+
+	float x = in[physicalOffsetCUDA(i, inLayout)];
+	float s = scale[physicalOffsetCUDA(i, scaleLayout)];
+	float z = zeroPoint[physicalOffsetCUDA(i, zeroPointLayout)];
+
+	// rintf rounds half to even like the CPU backend
+	out[physicalOffsetCUDA(i, outLayout)] = fminf(fmaxf(rintf(x / s + z), low), high);
+}
+
+__global__ void dequantizeKernel(const float* __restrict__ in, const TensorLayout inLayout,
+                                 const float* __restrict__ scale, const TensorLayout scaleLayout,
+                                 const float* __restrict__ zeroPoint,
+                                 const TensorLayout zeroPointLayout, float* __restrict__ out,
+                                 const TensorLayout outLayout, size_t count) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= count)
+		return;
+
+	float q = in[physicalOffsetCUDA(i, inLayout)];
+	float s = scale[physicalOffsetCUDA(i, scaleLayout)];
+	float z = zeroPoint[physicalOffsetCUDA(i, zeroPointLayout)];
+
+	out[physicalOffsetCUDA(i, outLayout)] = (q - z) * s;
+}
+
+template <typename L>
+__device__ __forceinline__ void matmulInt8Element(const L* __restrict__ lhs,
+                                                  const TensorLayout& lhsLayout,
+                                                  const int8_t* __restrict__ rhs,
+                                                  const TensorLayout& rhsLayout,
+                                                  int32_t* __restrict__ out, size_t batch,
+                                                  size_t m, size_t k, size_t p,
+                                                  int32_t lhsZeroPoint, int32_t rhsZeroPoint) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= batch * m * p)
+		return;
+
+	size_t bat = i / (m * p);
+	size_t row = (i % (m * p)) / p;
+	size_t col = i % p;
+
+	// int64, zero points can take the sum past int32 before it saturates
+	int64_t sum = 0;
+	for (size_t kk = 0; kk < k; kk++) {
+		size_t lhsIdx = bat * (m * k) + row * k + kk;
+		size_t rhsIdx = bat * (k * p) + kk * p + col;
+		int64_t a = static_cast<int64_t>(lhs[physicalOffsetCUDA(lhsIdx, lhsLayout)]) - lhsZeroPoint;
+		int64_t b = static_cast<int64_t>(rhs[physicalOffsetCUDA(rhsIdx, rhsLayout)]) - rhsZeroPoint;
+		sum += a * b;
+	}
+	sum = max(sum, static_cast<int64_t>(INT32_MIN));
+	out[i] = static_cast<int32_t>(min(sum, static_cast<int64_t>(INT32_MAX)));
+}
+
+__global__ void convKernel(const float* __restrict__ in, const TensorLayout layout,
+                           const float* __restrict__ weight, const TensorLayout weightLayout,
+                           float* __restrict__ out, const Tensor::Impl::Convolution conv,
+                           size_t count) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= count)
+		return;
+
+	size_t ox = i % conv.outWidth;
+	size_t oy = (i / conv.outWidth) % conv.outHeight;
+	size_t o = (i / (conv.outWidth * conv.outHeight)) % conv.outChannels;
+	size_t n = i / (conv.outWidth * conv.outHeight * conv.outChannels);
+
+	float acc = 0.0f;
+	for (size_t c = 0; c < conv.inChannels; c++) {
+		for (size_t ky = 0; ky < conv.kernelHeight; ky++) {
+			// padded coordinates, the padding reads as zero
+			size_t y = oy * conv.stride[0] + ky * conv.dilation[0];
+			if (y < conv.padding[0] || y - conv.padding[0] >= conv.height)
+				continue;
+
+			for (size_t kx = 0; kx < conv.kernelWidth; kx++) {
+				size_t x = ox * conv.stride[1] + kx * conv.dilation[1];
+				if (x < conv.padding[1] || x - conv.padding[1] >= conv.width)
+					continue;
+
+				size_t inIdx = layout.offset + n * layout.strides[0] + c * layout.strides[1] +
+				               (y - conv.padding[0]) * layout.strides[2] +
+				               (x - conv.padding[1]) * layout.strides[3];
+				size_t weightIdx = weightLayout.offset + o * weightLayout.strides[0] +
+				                   c * weightLayout.strides[1] + ky * weightLayout.strides[2] +
+				                   kx * weightLayout.strides[3];
+				acc += in[inIdx] * weight[weightIdx];
+			}
+		}
+	}
+	out[i] = acc;
+}
+
+__global__ void matmulInt8Kernel(const int8_t* __restrict__ lhs, const TensorLayout lhsLayout,
+                                 const int8_t* __restrict__ rhs, const TensorLayout rhsLayout,
+                                 int32_t* __restrict__ out, size_t batch, size_t m, size_t k,
+                                 size_t p, int32_t lhsZeroPoint, int32_t rhsZeroPoint) {
+	matmulInt8Element(lhs, lhsLayout, rhs, rhsLayout, out, batch, m, k, p, lhsZeroPoint,
+	                  rhsZeroPoint);
+}
+
+__global__ void matmulInt8Kernel(const uint8_t* __restrict__ lhs, const TensorLayout lhsLayout,
+                                 const int8_t* __restrict__ rhs, const TensorLayout rhsLayout,
+                                 int32_t* __restrict__ out, size_t batch, size_t m, size_t k,
+                                 size_t p, int32_t lhsZeroPoint, int32_t rhsZeroPoint) {
+	matmulInt8Element(lhs, lhsLayout, rhs, rhsLayout, out, batch, m, k, p, lhsZeroPoint,
+	                  rhsZeroPoint);
+}
+
+__global__ void requantizeKernel(const int32_t* __restrict__ acc, float* __restrict__ out,
+                                 size_t count, size_t p, const float* __restrict__ multiplier,
+                                 size_t multiplierStride, float zeroPoint, float low, float high) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i >= count)
+		return;
+
+	float value = static_cast<float>(acc[i]) * multiplier[(i % p) * multiplierStride] + zeroPoint;
+	out[i] = fminf(fmaxf(rintf(value), low), high);
+}
@@ -2,7 +2,10 @@
 #define KERNELS_CUH
 
 #include "backend/cuda/utils/cuda_utils.h"
+#include "backend/tensor_impl.h"
+#include "nforge/core/tensor.h"
 #include "nforge/core/tensor_layout.h"
+#include "rng/philox.h"
 
 __device__ __forceinline__ size_t physicalOffsetCUDA(size_t linear, const TensorLayout& L);
 
@@ -25,6 +28,18 @@ __global__ void divKernel(const float* __restrict__ lhs, const TensorLayout lhsL
 
 __global__ void fillKernel(float* __restrict__ data, float value, size_t count);
 
+// elementwise dtype conversion, conversion to bool maps non-zero to 1
+template <typename Dst, typename Src>
+__global__ void convertKernel(Dst* __restrict__ dst, const Src* __restrict__ src, size_t count) {
+	size_t i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i < count)
+		dst[i] = static_cast<Dst>(src[i]);
+}
+
+// one thread per Philox block of rng::ELEMENTS_PER_BLOCK elements
+__global__ void fillRandomKernel(float* __restrict__ data, size_t count,
+                                 const rng::Distribution dist, const rng::Stream stream);
+
 __global__ void setKernel(float* __restrict__ dst, const TensorLayout dstLayout,
                           const float* __restrict__ src, const TensorLayout srcLayout,
                           size_t count);
@@ -82,10 +97,16 @@ __global__ void idivKernel(float* __restrict__ lhs, const TensorLayout lhsLayout
                            const float* __restrict__ rhs, const TensorLayout rhsLayout,
                            size_t count);
 
+__global__ void maskedFillKernel(float* __restrict__ lhs, const TensorLayout lhsLayout,
+                                 const float* __restrict__ mask, const TensorLayout maskLayout,
+                                 float value, size_t count);
+
 __global__ void isqrtKernel(float* __restrict__ data, size_t count);
 
 // reduction kernels
-__global__ void squareSumKernel(const float* __restrict__ data, float* result, size_t count);
+__global__ void squareSumReductionKernel(const float* __restrict__ data, float* result,
+                                         const TensorLayout layout, size_t blockCount,
+                                         const TensorLayout outLayout, size_t outCount);
 
 __global__ void sumReductionKernel(const float* __restrict__ data, float* result,
                                    const TensorLayout layout, size_t blockCount,
@@ -111,10 +132,103 @@ __global__ void anyReductionKernel(const float* __restrict__ data, float* result
                                    const TensorLayout layout, size_t blockCount,
                                    const TensorLayout outLayout, size_t outCount);
 
+__global__ void countNonzeroReductionKernel(const float* __restrict__ data, float* result,
+                                            const TensorLayout layout, size_t blockCount,
+                                            const TensorLayout outLayout, size_t outCount);
+
+// selection kernels, one thread per block of `blockCount` elements
+
+// index of the first largest element of each block if `max`, else of the first smallest, NaN first
+__global__ void argExtremeKernel(const float* __restrict__ in, const TensorLayout layout,
+                                 int64_t* __restrict__ out, size_t blockCount, size_t numBlocks,
+                                 bool max);
+
+// `k` best elements of each block and their indices, ordered from the best. The outputs hold the
+// heap of each block while it is scanned.
+__global__ void topkKernel(const float* __restrict__ in, const TensorLayout layout,
+                           float* __restrict__ values, int64_t* __restrict__ indices,
+                           size_t blockCount, size_t numBlocks, size_t k, bool largest);
+
+// each block sorted ascending or descending into the contiguous `values`, stable and NaN above
+// every number. `indices` may be null, else it receives the index of each value in its block.
+// `values` holds the order keys of each block while it is heap sorted.
+__global__ void sortKernel(const float* __restrict__ in, const TensorLayout layout,
+                           float* __restrict__ values, int64_t* __restrict__ indices,
+                           size_t blockCount, size_t numBlocks, bool descending);
+
+// scan of `op` along the middle dim of `in` viewed as {outer, length, inner}, one thread per line
+// of `length` elements. Writes `out` contiguous, shifted by one with the identity first if
+// `exclusive`.
+__global__ void scanKernel(const float* __restrict__ in, const TensorLayout layout,
+                           float* __restrict__ out, size_t length, size_t inner, size_t numLines,
+                           ScanOp op, bool exclusive);
+
+// gather and scatter along `dim`, one thread per element of `indexLayout`. Indices outside
+// [0, layout.shape[dim]) gather 0 and are skipped by scatter. Scatter adds atomically if
+// `accumulate`, so repeated indices sum up.
+__global__ void gatherKernel(const float* __restrict__ in, const TensorLayout layout, size_t dim,
+                             const float* __restrict__ index, const TensorLayout indexLayout,
+                             float* __restrict__ out, size_t count);
+
+__global__ void scatterKernel(float* __restrict__ out, const TensorLayout layout, size_t dim,
+                              const float* __restrict__ index, const TensorLayout indexLayout,
+                              const float* __restrict__ src, const TensorLayout srcLayout,
+                              bool accumulate, size_t count);
+
+// softmax kernels, one thread per block of `blockCount` elements
+enum class SoftmaxMode { Softmax, LogSoftmax, LogSumExp };
+
+// contiguous output, one element per input element or one per block for LogSumExp
+__global__ void softmaxKernel(const float* __restrict__ in, const TensorLayout layout,
+                              float* __restrict__ out, size_t blockCount, size_t numBlocks,
+                              SoftmaxMode mode);
+
+
+// elementwise functions, see `UnaryOp` for `alpha` and `beta`
+__global__ void unaryKernel(const float* __restrict__ in, const TensorLayout inLayout, float* out,
+                            const TensorLayout outLayout, size_t count, UnaryOp op, float alpha,
+                            float beta);
 
 __global__ void matmulKernel(const float* __restrict__ lhs, const TensorLayout lhsLayout,
                              const float* __restrict__ rhs, const TensorLayout rhsLayout,
                              float* __restrict__ out, const TensorLayout outLayout, size_t batch,
                              size_t m, size_t k, size_t p);
 
+// quantization kernels, quantized values are produced as floats in [low, high]
+__global__ void quantizeKernel(const float* __restrict__ in, const TensorLayout inLayout,
+                               const float* __restrict__ scale, const TensorLayout scaleLayout,
+                               const float* __restrict__ zeroPoint,
+                               const TensorLayout zeroPointLayout, float* __restrict__ out,
+                               const TensorLayout outLayout, size_t count, float low, float high);
+
+__global__ void dequantizeKernel(const float* __restrict__ in, const TensorLayout inLayout,
+                                 const float* __restrict__ scale, const TensorLayout scaleLayout,
+                                 const float* __restrict__ zeroPoint,
+                                 const TensorLayout zeroPointLayout, float* __restrict__ out,
+                                 const TensorLayout outLayout, size_t count);
+
+// int32 accumulation of (lhs - lhsZeroPoint) * (rhs - rhsZeroPoint), contiguous output
+// direct 2D convolution, one thread per element of the contiguous (batch, outChannels,
+// outHeight, outWidth) output, see Tensor::Impl::Convolution
+__global__ void convKernel(const float* __restrict__ in, const TensorLayout layout,
+                           const float* __restrict__ weight, const TensorLayout weightLayout,
+                           float* __restrict__ out, const Tensor::Impl::Convolution conv,
+                           size_t count);
+
+__global__ void matmulInt8Kernel(const int8_t* __restrict__ lhs, const TensorLayout lhsLayout,
+                                 const int8_t* __restrict__ rhs, const TensorLayout rhsLayout,
+                                 int32_t* __restrict__ out, size_t batch, size_t m, size_t k,
+                                 size_t p, int32_t lhsZeroPoint, int32_t rhsZeroPoint);
+
+__global__ void matmulInt8Kernel(const uint8_t* __restrict__ lhs, const TensorLayout lhsLayout,
+                                 const int8_t* __restrict__ rhs, const TensorLayout rhsLayout,
+                                 int32_t* __restrict__ out, size_t batch, size_t m, size_t k,
+                                 size_t p, int32_t lhsZeroPoint, int32_t rhsZeroPoint);
+
+// round(acc * multiplier[col * multiplierStride]) + zeroPoint clamped to [low, high], for a
+// contiguous (..., p) accumulator
+__global__ void requantizeKernel(const int32_t* __restrict__ acc, float* __restrict__ out,
+                                 size_t count, size_t p, const float* __restrict__ multiplier,
+                                 size_t multiplierStride, float zeroPoint, float low, float high);
+
 #endif  // KERNELS_CUH
\ No newline at end of file
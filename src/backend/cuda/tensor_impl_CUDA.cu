@@ -1,31 +1,71 @@
 #include <cuda_runtime.h>
 
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
 #include "backend/cuda/kernels/kernels.cuh"
 #include "backend/cuda/utils/cuda_context.h"
+#include "backend/dtype_dispatch.h"
+#include "profiling/op_scope.h"
 #include "tensor_impl_CUDA.h"
 
-Tensor::CUDAImpl::CUDAImpl(const Tensor::Shape& shape) : m_shape(shape) {
-	size_t numElements = shape.getNumElements();
-	CUDA_CHECK(cudaMalloc((void**)&d_data, numElements * sizeof(float)));
-	CUDA_CHECK(cudaMemset((void**)d_data, 0, numElements * sizeof(float)));
+/// Converts `count` elements of `src` into `dst`.
+static void convert(void* dst, DType dstType, const void* src, DType srcType, size_t count) {
+	dispatchDType(dstType, [&](auto* dstTag) {
+		dispatchDType(srcType, [&](auto* srcTag) {
+			using Dst = std::remove_pointer_t<decltype(dstTag)>;
+			using Src = std::remove_pointer_t<decltype(srcTag)>;
+
+			convertKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0,
+			                CudaContext::get().stream()>>>(static_cast<Dst*>(dst),
+			                                               static_cast<const Src*>(src), count);
+		});
+	});
+	CUDA_CHECK(cudaGetLastError());
+}
+
+Tensor::CUDAImpl::CUDAImpl(const Tensor::Shape& shape, DType dtype)
+    : m_shape(shape),
+      m_dtype(dtype),
+      m_allocation(Backend::CUDA, shape.getNumElements() * getDTypeSize(dtype)) {
+	size_t bytes = shape.getNumElements() * getDTypeSize(dtype);
+	CUDA_CHECK(cudaMalloc(&d_data, bytes));
+	CUDA_CHECK(cudaMemset(d_data, 0, bytes));
 	CUDA_CHECK(cudaGetLastError());
 }
 
 Tensor::CUDAImpl::~CUDAImpl() { cudaFree(d_data); }
 
 void Tensor::CUDAImpl::fillAll(float value) {
-	fillKernel<<<getNumCUDABlocks(m_shape.getNumElements()), BLOCK_SIZE, 0,
-	             CudaContext::get().stream()>>>(d_data, value, m_shape.getNumElements());
+	NFORGE_OP_SCOPE(FillAll, m_shape.getNumElements());
+
+	writeAsFloat32([&](float* data) {
+		fillKernel<<<getNumCUDABlocks(m_shape.getNumElements()), BLOCK_SIZE, 0,
+		             CudaContext::get().stream()>>>(data, value, m_shape.getNumElements());
+	});
 }
 
-void Tensor::CUDAImpl::fillRand() {
+void Tensor::CUDAImpl::fillRandom(const rng::Distribution& dist, const rng::Stream& stream) {
+	NFORGE_OP_SCOPE(FillRandom, m_shape.getNumElements());
+
 	size_t numElements = m_shape.getNumElements();
-	CURAND_CHECK(curandGenerateUniform(CudaContext::get().rng(), d_data, numElements));
+	size_t blocks = rng::numBlocks(numElements);
+
+	writeAsFloat32([&](float* data) {
+		fillRandomKernel<<<getNumCUDABlocks(blocks), BLOCK_SIZE, 0,
+		                   CudaContext::get().stream()>>>(data, numElements, dist, stream);
+		CUDA_CHECK(cudaGetLastError());
+	});
 }
 
-void Tensor::CUDAImpl::print() const { std::cout << toString() << "\n"; }
+void Tensor::CUDAImpl::print() const {
+	NFORGE_OP_SCOPE(Print, m_shape.getNumElements());
+	std::cout << toString() << "\n";
+}
 
 void Tensor::CUDAImpl::print(const std::vector<size_t>& position) const {
+	NFORGE_OP_SCOPE(Print, 0);
 	std::cout << "Not implemented\n";
 }
 
@@ -33,9 +73,20 @@ size_t Tensor::CUDAImpl::getNumElements() const { return m_shape.getNumElements(
 
 Tensor::Shape Tensor::CUDAImpl::getShape() const { return m_shape; }
 
-float* Tensor::CUDAImpl::dataPtr() const { return d_data; }
+DType Tensor::CUDAImpl::getDType() const { return m_dtype; }
+
+float* Tensor::CUDAImpl::dataPtr() const {
+	assert(m_dtype == DType::Float32);
+	return static_cast<float*>(d_data);
+}
 
 std::vector<float> Tensor::CUDAImpl::toVector() const {
+	NFORGE_OP_SCOPE(ToVector, m_shape.getNumElements());
+
+	if (m_dtype != DType::Float32) {
+		return convertTo(DType::Float32)->toVector();
+	}
+
 	std::vector<float> result(m_shape.getNumElements());
 
 	// sync all operations
@@ -47,19 +98,51 @@ std::vector<float> Tensor::CUDAImpl::toVector() const {
 	return result;
 }
 
+void Tensor::CUDAImpl::copyToHost(void* data) const {
+	NFORGE_OP_SCOPE(ToVector, m_shape.getNumElements());
+
+	CUDA_CHECK(cudaGetLastError());
+	CUDA_CHECK(cudaStreamSynchronize(CudaContext::get().stream()));
+	CUDA_CHECK(cudaMemcpy(data, d_data, m_shape.getNumElements() * getDTypeSize(m_dtype),
+	                      cudaMemcpyDeviceToHost));
+	CUDA_CHECK(cudaGetLastError());
+}
+
 void Tensor::CUDAImpl::copyFromHost(const float* data, size_t count) {
-	CUDA_CHECK(cudaMemcpy(d_data, data, count * sizeof(float), cudaMemcpyHostToDevice));
+	NFORGE_OP_SCOPE(CopyFromHost, count);
+
+	writeAsFloat32([&](float* target) {
+		CUDA_CHECK(cudaMemcpy(target, data, count * sizeof(float), cudaMemcpyHostToDevice));
+		CUDA_CHECK(cudaGetLastError());
+	});
+}
+
+void Tensor::CUDAImpl::copyFromHost(const void* data) {
+	NFORGE_OP_SCOPE(CopyFromHost, m_shape.getNumElements());
+
+	// kernels queued on the stream may still read the old data
+	CUDA_CHECK(cudaStreamSynchronize(CudaContext::get().stream()));
+	CUDA_CHECK(cudaMemcpy(d_data, data, m_shape.getNumElements() * getDTypeSize(m_dtype),
+	                      cudaMemcpyHostToDevice));
 	CUDA_CHECK(cudaGetLastError());
 }
 
 std::string Tensor::CUDAImpl::toString() const {
+	NFORGE_OP_SCOPE(ToString, m_shape.getNumElements());
+
 	std::vector<float> data = toVector();
 
 	std::string out;
 
 	out += "{ ";
 	for (float element : data) {
-		out += std::to_string(element) + " ";
+		if (m_dtype == DType::Bool) {
+			out += element != 0.0f ? "true " : "false ";
+		} else if (isIntegral(m_dtype)) {
+			out += std::to_string(static_cast<long long>(element)) + " ";
+		} else {
+			out += std::to_string(element) + " ";
+		}
 	}
 	out += "}";
 
@@ -67,13 +150,15 @@ std::string Tensor::CUDAImpl::toString() const {
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::clone() const {
-	CUDAImpl* copy = new CUDAImpl(m_shape);
+	NFORGE_OP_SCOPE(Clone, m_shape.getNumElements());
+
+	CUDAImpl* copy = new CUDAImpl(m_shape, m_dtype);
 
 	// sync
 	CUDA_CHECK(cudaGetLastError());
 	CUDA_CHECK(cudaStreamSynchronize(CudaContext::get().stream()));
 
-	CUDA_CHECK(cudaMemcpy(copy->d_data, d_data, m_shape.getNumElements() * sizeof(float),
+	CUDA_CHECK(cudaMemcpy(copy->d_data, d_data, m_shape.getNumElements() * getDTypeSize(m_dtype),
 	                      cudaMemcpyDeviceToDevice));
 	CUDA_CHECK(cudaGetLastError());
 	return std::unique_ptr<Tensor::Impl>(copy);
@@ -82,23 +167,32 @@ std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::clone() const {
 // Assignments and indexing
 void Tensor::CUDAImpl::set(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                            const TensorLayout& rhsLayout) {
-	const Tensor::CUDAImpl* o = cast(rhsImpl);
+	NFORGE_OP_SCOPE(Set, Tensor::Shape(rhsLayout).getNumElements());
 
-	float* a = dataPtr();
-	float* b = o->dataPtr();
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* b = asFloat32(rhsImpl, staging)->dataPtr();
 
 	size_t count = 1;
 	for (size_t d = 0; d < rhsLayout.rank; d++) count *= rhsLayout.shape[d];
 
-	setKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
-	    a, lhsLayout, b, rhsLayout, (int)count);
-	CUDA_CHECK(cudaGetLastError());
+	writeAsFloat32([&](float* a) {
+		setKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    a, lhsLayout, b, rhsLayout, (int)count);
+		CUDA_CHECK(cudaGetLastError());
+	});
+}
+
+void Tensor::CUDAImpl::setAll(const std::vector<SetCopy>& copies) {
+	// every copy is a kernel launch on the same stream, so they queue without waiting
+	for (const SetCopy& copy : copies) set(copy.targetLayout, copy.source, copy.sourceLayout);
 }
 
 // Comparisons
 bool Tensor::CUDAImpl::compare(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                                const TensorLayout& rhsLayout) const {
-	const Tensor::CUDAImpl* o = cast(rhsImpl);
+	NFORGE_OP_SCOPE(Compare, Tensor::Shape(lhsLayout).getNumElements());
+
+	std::unique_ptr<Tensor::CUDAImpl> lhsStaging, rhsStaging;
 
 	// init equal flag
 	int h_equalFlag = 1;
@@ -107,8 +201,8 @@ bool Tensor::CUDAImpl::compare(const TensorLayout& lhsLayout, const Tensor::Impl
 	cudaMemcpy(d_equalFlag, &h_equalFlag, sizeof(int), cudaMemcpyHostToDevice);
 
 	// get all data pointers
-	const float* lhsDataPtr = dataPtr();
-	const float* rhsDataPtr = o->dataPtr();
+	const float* lhsDataPtr = asFloat32(this, lhsStaging)->dataPtr();
+	const float* rhsDataPtr = asFloat32(rhsImpl, rhsStaging)->dataPtr();
 
 	size_t count = 1;
 	for (size_t d = 0; d < rhsLayout.rank; d++) count *= rhsLayout.shape[d];
@@ -128,21 +222,54 @@ const Tensor::CUDAImpl* Tensor::CUDAImpl::cast(const Tensor::Impl* p) const {
 	return static_cast<const Tensor::CUDAImpl*>(p);
 }
 
+std::unique_ptr<Tensor::CUDAImpl> Tensor::CUDAImpl::convertTo(DType dtype) const {
+	auto result = std::make_unique<Tensor::CUDAImpl>(m_shape, dtype);
+	convert(result->d_data, dtype, d_data, m_dtype, m_shape.getNumElements());
+	return result;
+}
+
+void Tensor::CUDAImpl::storeFrom(const Tensor::CUDAImpl& source) {
+	convert(d_data, m_dtype, source.d_data, source.m_dtype, m_shape.getNumElements());
+}
+
+const Tensor::CUDAImpl* Tensor::CUDAImpl::asFloat32(
+    const Tensor::Impl* impl, std::unique_ptr<Tensor::CUDAImpl>& staging) const {
+	const Tensor::CUDAImpl* cudaImpl = cast(impl);
+	if (cudaImpl->m_dtype == DType::Float32) {
+		return cudaImpl;
+	}
+
+	staging = cudaImpl->convertTo(DType::Float32);
+	return staging.get();
+}
+
+template <typename Write>
+void Tensor::CUDAImpl::writeAsFloat32(Write write) {
+	if (m_dtype == DType::Float32) {
+		write(dataPtr());
+		return;
+	}
+
+	auto staging = convertTo(DType::Float32);
+	write(staging->dataPtr());
+	storeFrom(*staging);
+}
+
 template <typename Kernel>
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::applyKernel(const TensorLayout& lhsLayout,
                                                             const Tensor::Impl* rhsImpl,
                                                             const TensorLayout& rhsLayout,
                                                             const TensorLayout& outLayout,
-                                                            Kernel kernel) const {
+                                                            Kernel kernel, DType outType) const {
 	// create output tensor
 	auto outShape = Tensor::Shape(outLayout);
 	auto* results = new Tensor::CUDAImpl(outLayout);
 
-	const Tensor::CUDAImpl* o = cast(rhsImpl);
+	std::unique_ptr<Tensor::CUDAImpl> lhsStaging, rhsStaging;
 
 	// get all data pointers
-	const float* lhs = dataPtr();
-	const float* rhs = o->dataPtr();
+	const float* lhs = asFloat32(this, lhsStaging)->dataPtr();
+	const float* rhs = asFloat32(rhsImpl, rhsStaging)->dataPtr();
 	float* out = results->dataPtr();
 
 	size_t count = 1;
@@ -153,85 +280,130 @@ std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::applyKernel(const TensorLayout&
 	    lhs, lhsLayout, rhs, rhsLayout, out, outLayout, count);
 	CUDA_CHECK(cudaGetLastError());
 
+	if (outType != DType::Float32) {
+		std::unique_ptr<Tensor::Impl> converted = results->convertTo(outType);
+		delete results;
+		return converted;
+	}
 	return std::unique_ptr<Tensor::Impl>(results);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::add(const TensorLayout& lhsLayout,
                                                     const Tensor::Impl* rhsImpl,
                                                     const TensorLayout& rhsLayout,
-                                                    const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, addKernel);
+                                                    const TensorLayout& outLayout,
+                                                    DType dtype) const {
+	NFORGE_OP_SCOPE(Add, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, addKernel, dtype);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::sub(const TensorLayout& lhsLayout,
                                                     const Tensor::Impl* rhsImpl,
                                                     const TensorLayout& rhsLayout,
-                                                    const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, subKernel);
+                                                    const TensorLayout& outLayout,
+                                                    DType dtype) const {
+	NFORGE_OP_SCOPE(Sub, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, subKernel, dtype);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::mul(const TensorLayout& lhsLayout,
                                                     const Tensor::Impl* rhsImpl,
                                                     const TensorLayout& rhsLayout,
-                                                    const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, mulKernel);
+                                                    const TensorLayout& outLayout,
+                                                    DType dtype) const {
+	NFORGE_OP_SCOPE(Mul, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, mulKernel, dtype);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::div(const TensorLayout& lhsLayout,
                                                     const Tensor::Impl* rhsImpl,
                                                     const TensorLayout& rhsLayout,
-                                                    const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, divKernel);
+                                                    const TensorLayout& outLayout,
+                                                    DType dtype) const {
+	NFORGE_OP_SCOPE(Div, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, divKernel, dtype);
 }
 
 template <typename Kernel>
 void Tensor::CUDAImpl::applyInplaceKernel(const TensorLayout& lhsLayout,
                                           const Tensor::Impl* rhsImpl,
                                           const TensorLayout& rhsLayout, Kernel kernel) {
-	const Tensor::CUDAImpl* o = cast(rhsImpl);
+	std::unique_ptr<Tensor::CUDAImpl> staging;
 
 	// get all data pointers
-	float* lhs = dataPtr();
-	const float* rhs = o->dataPtr();
+	const float* rhs = asFloat32(rhsImpl, staging)->dataPtr();
 
 	size_t count = 1;
 	for (size_t d = 0; d < lhsLayout.rank; d++) count *= lhsLayout.shape[d];
 
 	// launch kernel
-	kernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
-	    lhs, lhsLayout, rhs, rhsLayout, count);
-	CUDA_CHECK(cudaGetLastError());
+	writeAsFloat32([&](float* lhs) {
+		kernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    lhs, lhsLayout, rhs, rhsLayout, count);
+		CUDA_CHECK(cudaGetLastError());
+	});
 }
 
 void Tensor::CUDAImpl::iadd(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                             const TensorLayout& rhsLayout) {
+	NFORGE_OP_SCOPE(IAdd, Tensor::Shape(lhsLayout).getNumElements());
+
 	applyInplaceKernel(lhsLayout, rhsImpl, rhsLayout, iaddKernel);
 }
 
 void Tensor::CUDAImpl::isub(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                             const TensorLayout& rhsLayout) {
+	NFORGE_OP_SCOPE(ISub, Tensor::Shape(lhsLayout).getNumElements());
+
 	applyInplaceKernel(lhsLayout, rhsImpl, rhsLayout, isubKernel);
 }
 
 void Tensor::CUDAImpl::imul(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                             const TensorLayout& rhsLayout) {
+	NFORGE_OP_SCOPE(IMul, Tensor::Shape(lhsLayout).getNumElements());
+
 	applyInplaceKernel(lhsLayout, rhsImpl, rhsLayout, imulKernel);
 }
 
 void Tensor::CUDAImpl::idiv(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
                             const TensorLayout& rhsLayout) {
+	NFORGE_OP_SCOPE(IDiv, Tensor::Shape(lhsLayout).getNumElements());
+
 	applyInplaceKernel(lhsLayout, rhsImpl, rhsLayout, idivKernel);
 }
 
+void Tensor::CUDAImpl::maskedFill(const TensorLayout& lhsLayout, const Tensor::Impl* maskImpl,
+                                  const TensorLayout& maskLayout, float value) {
+	NFORGE_OP_SCOPE(MaskedFill, Tensor::Shape(lhsLayout).getNumElements());
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* mask = asFloat32(maskImpl, staging)->dataPtr();
+
+	size_t count = 1;
+	for (size_t d = 0; d < lhsLayout.rank; d++) count *= lhsLayout.shape[d];
+
+	writeAsFloat32([&](float* lhs) {
+		maskedFillKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0,
+		                   CudaContext::get().stream()>>>(lhs, lhsLayout, mask, maskLayout, value,
+		                                                  count);
+		CUDA_CHECK(cudaGetLastError());
+	});
+}
+
 template <typename Kernel>
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::applyReductionKernel(
     const TensorLayout& layout, const TensorLayout& blockLayout, const TensorLayout& outLayout,
-    float initValue, Kernel kernel) const {
+    float initValue, Kernel kernel, DType outType) const {
 	// create output tensor
 	auto outShape = Tensor::Shape(outLayout);
 	auto* results = new Tensor::CUDAImpl(outShape);
 
-	const float* lhs = dataPtr();
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* lhs = asFloat32(this, staging)->dataPtr();
 	float* out = results->dataPtr();
 
 	// number of elements in output tensor
@@ -252,67 +424,412 @@ std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::applyReductionKernel(
 	    lhs, out, layout, blockCount, outLayout, outCount);
 	CUDA_CHECK(cudaGetLastError());
 
+	if (outType != DType::Float32) {
+		std::unique_ptr<Tensor::Impl> converted = results->convertTo(outType);
+		delete results;
+		return converted;
+	}
 	return std::unique_ptr<Tensor::Impl>(results);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::sum(const TensorLayout& layout,
                                                     const TensorLayout& blockLayout,
                                                     const TensorLayout& outLayout) const {
-	return applyReductionKernel(layout, blockLayout, outLayout, 0.0f, sumReductionKernel);
+	NFORGE_OP_SCOPE(Sum, Tensor::Shape(layout).getNumElements());
+
+	return applyReductionKernel(layout, blockLayout, outLayout, 0.0f, sumReductionKernel,
+	                            getAccumulateType(m_dtype));
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::min(const TensorLayout& layout,
                                                     const TensorLayout& blockLayout,
                                                     const TensorLayout& outLayout) const {
-	return applyReductionKernel(layout, blockLayout, outLayout, FLT_MAX, minReductionKernel);
+	NFORGE_OP_SCOPE(Min, Tensor::Shape(layout).getNumElements());
+
+	return applyReductionKernel(layout, blockLayout, outLayout, FLT_MAX, minReductionKernel,
+	                            m_dtype);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::max(const TensorLayout& layout,
                                                     const TensorLayout& blockLayout,
                                                     const TensorLayout& outLayout) const {
-	return applyReductionKernel(layout, blockLayout, outLayout, -FLT_MAX, maxReductionKernel);
+	NFORGE_OP_SCOPE(Max, Tensor::Shape(layout).getNumElements());
+
+	return applyReductionKernel(layout, blockLayout, outLayout, -FLT_MAX, maxReductionKernel,
+	                            m_dtype);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::prod(const TensorLayout& layout,
                                                      const TensorLayout& blockLayout,
                                                      const TensorLayout& outLayout) const {
-	return applyReductionKernel(layout, blockLayout, outLayout, 1.0f, prodReductionKernel);
-}
+	NFORGE_OP_SCOPE(Prod, Tensor::Shape(layout).getNumElements());
 
-std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::norm(const TensorLayout& layout) const {
-	// create output tensor
-	auto outShape = Tensor::Shape({});
-	auto* results = new Tensor::CUDAImpl(outShape);
+	return applyReductionKernel(layout, blockLayout, outLayout, 1.0f, prodReductionKernel,
+	                            getAccumulateType(m_dtype));
+}
 
-	// get all data pointers
-	const float* lhs = dataPtr();
-	float* out = results->dataPtr();
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::norm(const TensorLayout& layout,
+                                                     const TensorLayout& blockLayout,
+                                                     const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(Norm, Tensor::Shape(layout).getNumElements());
 
-	size_t count = 1;
-	for (size_t d = 0; d < layout.rank; d++) count *= layout.shape[d];
+	// get sum of squares of each block
+	auto results =
+	    applyReductionKernel(layout, blockLayout, outLayout, 0.0f, squareSumReductionKernel);
 
-	// get sum of all elements squared
-	squareSumKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
-	    lhs, out, count);
-	CUDA_CHECK(cudaGetLastError());
+	size_t outCount = 1;
+	for (size_t d = 0; d < outLayout.rank; d++) outCount *= outLayout.shape[d];
 
 	// apply sqrt to out
-	isqrtKernel<<<1, 1, 0, CudaContext::get().stream()>>>(out, 1);
+	auto* squares = static_cast<Tensor::CUDAImpl*>(results.get());
+	isqrtKernel<<<getNumCUDABlocks(outCount), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    squares->dataPtr(), outCount);
 	CUDA_CHECK(cudaGetLastError());
 
-	return std::unique_ptr<Tensor::Impl>(results);
+	if (m_dtype == DType::Float64) {
+		return squares->convertTo(DType::Float64);
+	}
+	return results;
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::all(const TensorLayout& layout,
                                                     const TensorLayout& blockLayout,
                                                     const TensorLayout& outLayout) const {
-	return applyReductionKernel(layout, blockLayout, outLayout, 1.0f, allReductionKernel);
+	NFORGE_OP_SCOPE(All, Tensor::Shape(layout).getNumElements());
+
+	return applyReductionKernel(layout, blockLayout, outLayout, 1.0f, allReductionKernel,
+	                            DType::Bool);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::any(const TensorLayout& layout,
                                                     const TensorLayout& blockLayout,
                                                     const TensorLayout& outLayout) const {
-	return applyReductionKernel(layout, blockLayout, outLayout, 0.0f, anyReductionKernel);
+	NFORGE_OP_SCOPE(Any, Tensor::Shape(layout).getNumElements());
+
+	return applyReductionKernel(layout, blockLayout, outLayout, 0.0f, anyReductionKernel,
+	                            DType::Bool);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::countNonzero(const TensorLayout& layout,
+                                                             const TensorLayout& blockLayout,
+                                                             const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(CountNonzero, Tensor::Shape(layout).getNumElements());
+
+	// counts accumulate in float, exact up to 2^24 per block
+	return applyReductionKernel(layout, blockLayout, outLayout, 0.0f, countNonzeroReductionKernel,
+	                            DType::Int64);
+}
+
+/// Runs `argExtremeKernel` over the Float32 elements `in` into the Int64 `out`.
+static void launchArgExtremeKernel(const float* in, const TensorLayout& layout,
+                                   const TensorLayout& blockLayout, int64_t* out, bool max) {
+	size_t count = Tensor::Shape(layout).getNumElements();
+	size_t blockCount = Tensor::Shape(blockLayout).getNumElements();
+	size_t numBlocks = blockCount == 0 ? 0 : count / blockCount;
+	if (numBlocks == 0) {
+		return;
+	}
+
+	argExtremeKernel<<<getNumCUDABlocks(numBlocks), BLOCK_SIZE, 0,
+	                   CudaContext::get().stream()>>>(in, layout, out, blockCount, numBlocks, max);
+	CUDA_CHECK(cudaGetLastError());
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::argmin(const TensorLayout& layout,
+                                                       const TensorLayout& blockLayout,
+                                                       const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(ArgMin, Tensor::Shape(layout).getNumElements());
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+
+	auto result = std::make_unique<Tensor::CUDAImpl>(Tensor::Shape(outLayout), DType::Int64);
+	launchArgExtremeKernel(in, layout, blockLayout, static_cast<int64_t*>(result->d_data), false);
+	return result;
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::argmax(const TensorLayout& layout,
+                                                       const TensorLayout& blockLayout,
+                                                       const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(ArgMax, Tensor::Shape(layout).getNumElements());
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+
+	auto result = std::make_unique<Tensor::CUDAImpl>(Tensor::Shape(outLayout), DType::Int64);
+	launchArgExtremeKernel(in, layout, blockLayout, static_cast<int64_t*>(result->d_data), true);
+	return result;
+}
+
+void Tensor::CUDAImpl::topk(const TensorLayout& layout, const TensorLayout& blockLayout, size_t k,
+                            bool largest, Tensor::Impl* valuesImpl,
+                            Tensor::Impl* indicesImpl) const {
+	NFORGE_OP_SCOPE(TopK, Tensor::Shape(layout).getNumElements());
+
+	size_t count = Tensor::Shape(layout).getNumElements();
+	size_t blockCount = Tensor::Shape(blockLayout).getNumElements();
+	size_t numBlocks = blockCount == 0 ? 0 : count / blockCount;
+	if (numBlocks == 0 || k == 0) {
+		return;
+	}
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+
+	// selected in float, converted to the dtype of `valuesImpl` afterwards
+	auto* values = static_cast<Tensor::CUDAImpl*>(valuesImpl);
+	auto* indices = static_cast<Tensor::CUDAImpl*>(indicesImpl);
+	Tensor::CUDAImpl selected{values->getShape()};
+
+	topkKernel<<<getNumCUDABlocks(numBlocks), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    in, layout, selected.dataPtr(), static_cast<int64_t*>(indices->d_data), blockCount,
+	    numBlocks, k, largest);
+	CUDA_CHECK(cudaGetLastError());
+
+	values->storeFrom(selected);
+}
+
+void Tensor::CUDAImpl::sort(const TensorLayout& layout, const TensorLayout& blockLayout,
+                            bool descending, Tensor::Impl* valuesImpl,
+                            Tensor::Impl* indicesImpl) const {
+	NFORGE_OP_SCOPE(Sort, Tensor::Shape(layout).getNumElements());
+
+	size_t count = Tensor::Shape(layout).getNumElements();
+	size_t blockCount = Tensor::Shape(blockLayout).getNumElements();
+	size_t numBlocks = blockCount == 0 ? 0 : count / blockCount;
+	if (numBlocks == 0) {
+		return;
+	}
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+
+	// sorted in float, also needed as key storage when only indices are asked for
+	auto* indices = static_cast<Tensor::CUDAImpl*>(indicesImpl);
+	Tensor::CUDAImpl sorted{Tensor::Shape(layout)};
+
+	sortKernel<<<getNumCUDABlocks(numBlocks), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    in, layout, sorted.dataPtr(),
+	    indices == nullptr ? nullptr : static_cast<int64_t*>(indices->d_data), blockCount,
+	    numBlocks, descending);
+	CUDA_CHECK(cudaGetLastError());
+
+	if (valuesImpl != nullptr) {
+		static_cast<Tensor::CUDAImpl*>(valuesImpl)->storeFrom(sorted);
+	}
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::partition(const TensorLayout& layout,
+                                                          const TensorLayout& blockLayout,
+                                                          size_t kth) const {
+	NFORGE_OP_SCOPE(Partition, Tensor::Shape(layout).getNumElements());
+
+	// a full sort is a valid partition for every `kth`
+	auto result = std::make_unique<Tensor::CUDAImpl>(Tensor::Shape(layout), m_dtype);
+	sort(layout, blockLayout, false, result.get(), nullptr);
+	return result;
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::scan(const TensorLayout& layout, size_t dim,
+                                                     ScanOp op, bool exclusive) const {
+	NFORGE_OP_SCOPE(Scan, Tensor::Shape(layout).getNumElements());
+
+	size_t outer = 1;
+	for (size_t d = 0; d < dim; d++) outer *= layout.shape[d];
+	size_t inner = 1;
+	for (size_t d = dim + 1; d < layout.rank; d++) inner *= layout.shape[d];
+	size_t numLines = outer * inner;
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+
+	// scanned in float, converted to the result dtype afterwards
+	Tensor::CUDAImpl result{Tensor::Shape(layout)};
+	if (numLines > 0) {
+		scanKernel<<<getNumCUDABlocks(numLines), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    in, layout, result.dataPtr(), layout.shape[dim], inner, numLines, op, exclusive);
+		CUDA_CHECK(cudaGetLastError());
+	}
+
+	bool accumulates = op == ScanOp::Sum || op == ScanOp::Prod;
+	return result.convertTo(accumulates ? getAccumulateType(m_dtype) : m_dtype);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::gather(const TensorLayout& layout, size_t dim,
+                                                       const Tensor::Impl* indexImpl,
+                                                       const TensorLayout& indexLayout) const {
+	size_t count = Tensor::Shape(indexLayout).getNumElements();
+	NFORGE_OP_SCOPE(Gather, count);
+
+	std::unique_ptr<Tensor::CUDAImpl> staging, indexStaging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+	const float* index = asFloat32(indexImpl, indexStaging)->dataPtr();
+
+	Tensor::CUDAImpl result{Tensor::Shape(indexLayout)};
+	if (count > 0) {
+		gatherKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    in, layout, dim, index, indexLayout, result.dataPtr(), count);
+		CUDA_CHECK(cudaGetLastError());
+	}
+
+	return result.convertTo(m_dtype);
+}
+
+void Tensor::CUDAImpl::scatter(const TensorLayout& layout, size_t dim,
+                               const Tensor::Impl* indexImpl, const TensorLayout& indexLayout,
+                               const Tensor::Impl* srcImpl, const TensorLayout& srcLayout,
+                               bool accumulate) {
+	size_t count = Tensor::Shape(indexLayout).getNumElements();
+	NFORGE_OP_SCOPE(Scatter, count);
+
+	std::unique_ptr<Tensor::CUDAImpl> indexStaging, srcStaging;
+	const float* index = asFloat32(indexImpl, indexStaging)->dataPtr();
+	const float* src = asFloat32(srcImpl, srcStaging)->dataPtr();
+
+	if (count == 0) {
+		return;
+	}
+	writeAsFloat32([&](float* out) {
+		scatterKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    out, layout, dim, index, indexLayout, src, srcLayout, accumulate, count);
+		CUDA_CHECK(cudaGetLastError());
+	});
+}
+
+bool Tensor::CUDAImpl::reducePredicate(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
+                                       const TensorLayout& rhsLayout, Predicate predicate,
+                                       float tolerance, bool all, DType dtype) const {
+	NFORGE_OP_SCOPE(ReducePredicate, Tensor::Shape(lhsLayout).getNumElements());
+
+	// not fused, the mask is materialized and reduced on the device. Only the scalar result is
+	// copied back.
+	TensorLayout maskLayout{Tensor::Shape(lhsLayout)};
+	std::unique_ptr<Tensor::Impl> mask;
+	switch (predicate) {
+		case Predicate::Equal:
+			mask = equal(lhsLayout, rhsImpl, rhsLayout, maskLayout, dtype);
+			break;
+		case Predicate::NotEqual:
+			mask = notEqual(lhsLayout, rhsImpl, rhsLayout, maskLayout, dtype);
+			break;
+		case Predicate::Less:
+			mask = less(lhsLayout, rhsImpl, rhsLayout, maskLayout, dtype);
+			break;
+		case Predicate::LessEqual:
+			mask = lessEqual(lhsLayout, rhsImpl, rhsLayout, maskLayout, dtype);
+			break;
+		case Predicate::Greater:
+			mask = greater(lhsLayout, rhsImpl, rhsLayout, maskLayout, dtype);
+			break;
+		case Predicate::GreaterEqual:
+			mask = greaterEqual(lhsLayout, rhsImpl, rhsLayout, maskLayout, dtype);
+			break;
+		case Predicate::IsClose:
+			mask = isClose(lhsLayout, rhsImpl, rhsLayout, maskLayout, tolerance, dtype);
+			break;
+	}
+
+	TensorLayout scalarLayout{Tensor::Shape()};
+	auto reduced = all ? mask->all(maskLayout, maskLayout, scalarLayout)
+	                   : mask->any(maskLayout, maskLayout, scalarLayout);
+	return reduced->toVector()[0] != 0.0f;
+}
+
+/// Runs `softmaxKernel` over the Float32 elements `in`, writing the contiguous `out`.
+static void launchSoftmaxKernel(const float* in, const TensorLayout& layout,
+                                const TensorLayout& blockLayout, float* out, SoftmaxMode mode) {
+	size_t count = Tensor::Shape(layout).getNumElements();
+	size_t blockCount = Tensor::Shape(blockLayout).getNumElements();
+	size_t numBlocks = blockCount == 0 ? 0 : count / blockCount;
+	if (numBlocks == 0) {
+		return;
+	}
+
+	softmaxKernel<<<getNumCUDABlocks(numBlocks), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    in, layout, out, blockCount, numBlocks, mode);
+	CUDA_CHECK(cudaGetLastError());
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::softmax(const TensorLayout& layout,
+                                                        const TensorLayout& blockLayout,
+                                                        bool log) const {
+	// computed in float, floating dtypes are converted back
+	auto run = [&](SoftmaxMode mode) {
+		std::unique_ptr<Tensor::CUDAImpl> staging;
+		const float* in = asFloat32(this, staging)->dataPtr();
+
+		Tensor::CUDAImpl result{Tensor::Shape(layout)};
+		launchSoftmaxKernel(in, layout, blockLayout, result.dataPtr(), mode);
+		return result.convertTo(isFloatingPoint(m_dtype) ? m_dtype : DType::Float32);
+	};
+
+	if (log) {
+		NFORGE_OP_SCOPE(LogSoftmax, Tensor::Shape(layout).getNumElements());
+		return run(SoftmaxMode::LogSoftmax);
+	}
+
+	NFORGE_OP_SCOPE(Softmax, Tensor::Shape(layout).getNumElements());
+	return run(SoftmaxMode::Softmax);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::logSumExp(const TensorLayout& layout,
+                                                          const TensorLayout& blockLayout,
+                                                          const TensorLayout& outLayout) const {
+	NFORGE_OP_SCOPE(LogSumExp, Tensor::Shape(layout).getNumElements());
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+
+	Tensor::CUDAImpl result{Tensor::Shape(outLayout)};
+	launchSoftmaxKernel(in, layout, blockLayout, result.dataPtr(), SoftmaxMode::LogSumExp);
+
+	return result.convertTo(isFloatingPoint(m_dtype) ? m_dtype : DType::Float32);
+}
+
+/// Profiles and launches `unaryKernel` from the Float32 elements `in` into `out`. Integer
+/// dtypes round the clamp bounds inwards like the CPU backend.
+static void launchUnaryKernel(const float* in, const TensorLayout& inLayout, float* out,
+                              const TensorLayout& outLayout, UnaryOp op, float alpha, float beta,
+                              DType dtype) {
+	size_t count = Tensor::Shape(outLayout).getNumElements();
+	if (count == 0) {
+		return;
+	}
+	if (op == UnaryOp::Clamp && !isFloatingPoint(dtype)) {
+		alpha = std::ceil(alpha);
+		beta = std::floor(beta);
+	}
+
+	unaryKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    in, inLayout, out, outLayout, count, op, alpha, beta);
+	CUDA_CHECK(cudaGetLastError());
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::map(const TensorLayout& layout, UnaryOp op,
+                                                    float alpha, float beta, DType dtype) const {
+	NFORGE_UNARY_OP_SCOPE(op, Tensor::Shape(layout).getNumElements());
+
+	// computed in float, converted to `dtype` afterwards
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(this, staging)->dataPtr();
+
+	Tensor::CUDAImpl result{Tensor::Shape(layout)};
+	launchUnaryKernel(in, layout, result.dataPtr(), TensorLayout(Tensor::Shape(layout)), op, alpha,
+	                  beta, dtype);
+	return result.convertTo(dtype);
+}
+
+void Tensor::CUDAImpl::mapInto(const TensorLayout& layout, const Tensor::Impl* srcImpl,
+                               const TensorLayout& srcLayout, UnaryOp op, float alpha, float beta,
+                               DType dtype) {
+	NFORGE_UNARY_OP_SCOPE(op, Tensor::Shape(layout).getNumElements());
+
+	std::unique_ptr<Tensor::CUDAImpl> staging;
+	const float* in = asFloat32(srcImpl, staging)->dataPtr();
+
+	writeAsFloat32([&](float* out) {
+		launchUnaryKernel(in, srcLayout, out, layout, op, alpha, beta, dtype);
+	});
 }
 
 
@@ -320,16 +837,19 @@ std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::matmul(const TensorLayout& lhsLa
                                                        const Tensor::Impl* rhsImpl,
                                                        const TensorLayout& rhsLayout,
                                                        const TensorLayout& outLayout, size_t batch,
-                                                       size_t m, size_t k, size_t p) const {
+                                                       size_t m, size_t k, size_t p,
+                                                       DType dtype) const {
+	NFORGE_OP_SCOPE(Matmul, batch * m * k * p);
+
 	// create output tensor
 	auto outShape = Tensor::Shape(outLayout);
 	auto* results = new Tensor::CUDAImpl(outShape);
 
-	const Tensor::CUDAImpl* o = cast(rhsImpl);
+	std::unique_ptr<Tensor::CUDAImpl> lhsStaging, rhsStaging;
 
 	// get all data pointers
-	const float* lhs = dataPtr();
-	const float* rhs = o->dataPtr();
+	const float* lhs = asFloat32(this, lhsStaging)->dataPtr();
+	const float* rhs = asFloat32(rhsImpl, rhsStaging)->dataPtr();
 	float* out = results->dataPtr();
 
 	size_t total = batch * m * p;
@@ -339,66 +859,226 @@ std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::matmul(const TensorLayout& lhsLa
 	    lhs, lhsLayout, rhs, rhsLayout, out, outLayout, batch, m, k, p);
 	CUDA_CHECK(cudaGetLastError());
 
+	if (dtype != DType::Float32) {
+		std::unique_ptr<Tensor::Impl> converted = results->convertTo(dtype);
+		delete results;
+		return converted;
+	}
 	return std::unique_ptr<Tensor::Impl>(results);
 }
 
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::matmulInt8(
+    const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl, const TensorLayout& rhsLayout,
+    const TensorLayout& outLayout, size_t batch, size_t m, size_t k, size_t p,
+    int32_t lhsZeroPoint, int32_t rhsZeroPoint, const Requantize* requantize) const {
+	NFORGE_OP_SCOPE(MatmulInt8, batch * m * k * p);
+
+	auto outShape = Tensor::Shape(outLayout);
+	auto acc = std::make_unique<Tensor::CUDAImpl>(outShape, DType::Int32);
+
+	const auto* rhs = static_cast<const int8_t*>(cast(rhsImpl)->d_data);
+	auto* out = static_cast<int32_t*>(acc->d_data);
+	size_t total = batch * m * p;
+
+	if (m_dtype == DType::Int8) {
+		matmulInt8Kernel<<<getNumCUDABlocks(total), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    static_cast<const int8_t*>(d_data), lhsLayout, rhs, rhsLayout, out, batch, m, k, p,
+		    lhsZeroPoint, rhsZeroPoint);
+	} else {
+		matmulInt8Kernel<<<getNumCUDABlocks(total), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    static_cast<const uint8_t*>(d_data), lhsLayout, rhs, rhsLayout, out, batch, m, k, p,
+		    lhsZeroPoint, rhsZeroPoint);
+	}
+	CUDA_CHECK(cudaGetLastError());
+
+	if (requantize == nullptr) {
+		return acc;
+	}
+
+	// not fused on CUDA, the int32 result is requantized by a second kernel
+	const Tensor::CUDAImpl* multiplier = cast(requantize->multiplier);
+	size_t stride = multiplier->getNumElements() == 1 ? 0 : 1;
+	float low = requantize->dtype == DType::Int8 ? -128.0f : 0.0f;
+	float high = requantize->dtype == DType::Int8 ? 127.0f : 255.0f;
+
+	Tensor::CUDAImpl staging(outShape);
+	requantizeKernel<<<getNumCUDABlocks(total), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    out, staging.dataPtr(), total, p, multiplier->dataPtr(), stride,
+	    static_cast<float>(requantize->zeroPoint), low, high);
+	CUDA_CHECK(cudaGetLastError());
+
+	return staging.convertTo(requantize->dtype);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::conv(const TensorLayout& layout,
+                                                     const Tensor::Impl* weightImpl,
+                                                     const TensorLayout& weightLayout,
+                                                     const TensorLayout& outLayout,
+                                                     const Convolution& geometry,
+                                                     DType dtype) const {
+	size_t count = Tensor::Shape(outLayout).getNumElements();
+	NFORGE_OP_SCOPE(Conv, count * geometry.inChannels * geometry.kernelHeight *
+	                          geometry.kernelWidth);
+
+	std::unique_ptr<Tensor::CUDAImpl> inStaging, weightStaging;
+	const float* in = asFloat32(this, inStaging)->dataPtr();
+	const float* weight = asFloat32(weightImpl, weightStaging)->dataPtr();
+
+	Tensor::CUDAImpl result{Tensor::Shape(outLayout)};
+	if (count > 0) {
+		convKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+		    in, layout, weight, weightLayout, result.dataPtr(), geometry, count);
+		CUDA_CHECK(cudaGetLastError());
+	}
+
+	return result.convertTo(dtype);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::quantize(const TensorLayout& layout,
+                                                         const Tensor::Impl* scaleImpl,
+                                                         const TensorLayout& scaleLayout,
+                                                         const Tensor::Impl* zeroPointImpl,
+                                                         const TensorLayout& zeroPointLayout,
+                                                         const TensorLayout& outLayout,
+                                                         DType dtype) const {
+	size_t count = Tensor::Shape(outLayout).getNumElements();
+	NFORGE_OP_SCOPE(Quantize, count);
+
+	std::unique_ptr<Tensor::CUDAImpl> inStaging, scaleStaging, zeroPointStaging;
+	const float* in = asFloat32(this, inStaging)->dataPtr();
+	const float* scale = asFloat32(scaleImpl, scaleStaging)->dataPtr();
+	const float* zeroPoint = asFloat32(zeroPointImpl, zeroPointStaging)->dataPtr();
+
+	float low = dtype == DType::Int8 ? -128.0f : 0.0f;
+	float high = dtype == DType::Int8 ? 127.0f : 255.0f;
+
+	Tensor::CUDAImpl staging{Tensor::Shape(outLayout)};
+	quantizeKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    in, layout, scale, scaleLayout, zeroPoint, zeroPointLayout, staging.dataPtr(), outLayout,
+	    count, low, high);
+	CUDA_CHECK(cudaGetLastError());
+
+	return staging.convertTo(dtype);
+}
+
+std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::dequantize(const TensorLayout& layout,
+                                                           const Tensor::Impl* scaleImpl,
+                                                           const TensorLayout& scaleLayout,
+                                                           const Tensor::Impl* zeroPointImpl,
+                                                           const TensorLayout& zeroPointLayout,
+                                                           const TensorLayout& outLayout) const {
+	size_t count = Tensor::Shape(outLayout).getNumElements();
+	NFORGE_OP_SCOPE(Dequantize, count);
+
+	std::unique_ptr<Tensor::CUDAImpl> inStaging, scaleStaging, zeroPointStaging;
+	const float* in = asFloat32(this, inStaging)->dataPtr();
+	const float* scale = asFloat32(scaleImpl, scaleStaging)->dataPtr();
+	const float* zeroPoint = asFloat32(zeroPointImpl, zeroPointStaging)->dataPtr();
+
+	auto result = std::make_unique<Tensor::CUDAImpl>(Tensor::Shape(outLayout));
+	dequantizeKernel<<<getNumCUDABlocks(count), BLOCK_SIZE, 0, CudaContext::get().stream()>>>(
+	    in, layout, scale, scaleLayout, zeroPoint, zeroPointLayout, result->dataPtr(), outLayout,
+	    count);
+	CUDA_CHECK(cudaGetLastError());
+
+	return result;
+}
+
+// Tensor runs factorizations and solves of CUDA tensors on a host copy, see `Tensor::cholesky`
+
+bool Tensor::CUDAImpl::cholesky(size_t, size_t) {
+	throw std::runtime_error("cholesky() runs on the host");
+}
+
+void Tensor::CUDAImpl::lu(size_t, size_t, Tensor::Impl*) {
+	throw std::runtime_error("lu() runs on the host");
+}
+
+void Tensor::CUDAImpl::qr(size_t, size_t, size_t, Tensor::Impl*, Tensor::Impl*) {
+	throw std::runtime_error("qr() runs on the host");
+}
+
+bool Tensor::CUDAImpl::solveTriangular(size_t, size_t, size_t, Tensor::Impl*, bool, bool) const {
+	throw std::runtime_error("solveTriangular() runs on the host");
+}
+
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::equal(const TensorLayout& lhsLayout,
                                                       const Tensor::Impl* rhsImpl,
                                                       const TensorLayout& rhsLayout,
-                                                      const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, equalKernel);
+                                                      const TensorLayout& outLayout,
+                                                      DType dtype) const {
+	NFORGE_OP_SCOPE(Equal, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, equalKernel, DType::Bool);
 }
 
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::notEqual(const TensorLayout& lhsLayout,
                                                          const Tensor::Impl* rhsImpl,
                                                          const TensorLayout& rhsLayout,
-                                                         const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, notEqualKernel);
+                                                         const TensorLayout& outLayout,
+                                                         DType dtype) const {
+	NFORGE_OP_SCOPE(NotEqual, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, notEqualKernel, DType::Bool);
 }
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::less(const TensorLayout& lhsLayout,
                                                      const Tensor::Impl* rhsImpl,
                                                      const TensorLayout& rhsLayout,
-                                                     const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, lessKernel);
+                                                     const TensorLayout& outLayout,
+                                                     DType dtype) const {
+	NFORGE_OP_SCOPE(Less, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, lessKernel, DType::Bool);
 }
 
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::lessEqual(const TensorLayout& lhsLayout,
                                                           const Tensor::Impl* rhsImpl,
                                                           const TensorLayout& rhsLayout,
-                                                          const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, lessEqualKernel);
+                                                          const TensorLayout& outLayout,
+                                                          DType dtype) const {
+	NFORGE_OP_SCOPE(LessEqual, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, lessEqualKernel, DType::Bool);
 }
 
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::greater(const TensorLayout& lhsLayout,
                                                         const Tensor::Impl* rhsImpl,
                                                         const TensorLayout& rhsLayout,
-                                                        const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, greaterKernel);
+                                                        const TensorLayout& outLayout,
+                                                        DType dtype) const {
+	NFORGE_OP_SCOPE(Greater, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, greaterKernel, DType::Bool);
 }
 
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::greaterEqual(const TensorLayout& lhsLayout,
                                                              const Tensor::Impl* rhsImpl,
                                                              const TensorLayout& rhsLayout,
-                                                             const TensorLayout& outLayout) const {
-	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, greaterEqualKernel);
+                                                             const TensorLayout& outLayout,
+                                                             DType dtype) const {
+	NFORGE_OP_SCOPE(GreaterEqual, Tensor::Shape(outLayout).getNumElements());
+
+	return applyKernel(lhsLayout, rhsImpl, rhsLayout, outLayout, greaterEqualKernel, DType::Bool);
 }
 
 std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::isClose(const TensorLayout& lhsLayout,
                                                         const Tensor::Impl* rhsImpl,
                                                         const TensorLayout& rhsLayout,
                                                         const TensorLayout& outLayout,
-                                                        float tolerance) const {
+                                                        float tolerance, DType dtype) const {
+	NFORGE_OP_SCOPE(IsClose, Tensor::Shape(outLayout).getNumElements());
+
 	auto outShape = Tensor::Shape(outLayout);
 	auto* results = new Tensor::CUDAImpl(outShape);
 
-	const Tensor::CUDAImpl* o = cast(rhsImpl);
+	std::unique_ptr<Tensor::CUDAImpl> lhsStaging, rhsStaging;
 
-	const float* lhs = dataPtr();
-	const float* rhs = o->dataPtr();
+	const float* lhs = asFloat32(this, lhsStaging)->dataPtr();
+	const float* rhs = asFloat32(rhsImpl, rhsStaging)->dataPtr();
 	float* out = results->dataPtr();
 
 	size_t count = 1;
@@ -408,5 +1088,7 @@ std::unique_ptr<Tensor::Impl> Tensor::CUDAImpl::isClose(const TensorLayout& lhsL
 	    lhs, lhsLayout, rhs, rhsLayout, out, outLayout, count, tolerance);
 	CUDA_CHECK(cudaGetLastError());
 
-	return std::unique_ptr<Tensor::Impl>(results);
+	std::unique_ptr<Tensor::Impl> converted = results->convertTo(DType::Bool);
+	delete results;
+	return converted;
 }
\ No newline at end of file
@@ -3,57 +3,66 @@
 
 #include "../tensor_impl.h"
 #include "nforge/core/tensor_shape.h"
+#include "profiling/memory.h"
 
 /// CUDA implementation of Tensor::Impl, backed by device memory.
 ///
-/// All operations launch CUDA kernels using TensorLayout descriptors.
+/// All operations launch CUDA kernels using TensorLayout descriptors. Kernels compute on Float32
+/// data, operands of other dtypes are converted into a Float32 staging buffer first and results
+/// are converted to the output dtype afterwards. Integers beyond 2^24 and Float64 values lose
+/// precision on the way, see the CPU backend for exact results.
 /// The caller is responsible for layout validity, see Tensor::Impl.
 ///
 /// Overridden methods follow the same semantics documented in Tensor::Impl.
 class Tensor::CUDAImpl : public Tensor::Impl {
 public:
-	CUDAImpl(const Tensor::Shape& shape);
+	CUDAImpl(const Tensor::Shape& shape, DType dtype = DType::Float32);
 	~CUDAImpl();
 
 	void fillAll(float value) override;
-	void fillRand() override;
+	void fillRandom(const rng::Distribution& dist, const rng::Stream& stream) override;
 
 	void print() const override;
 	void print(const std::vector<size_t>& position) const override;
 
 	size_t getNumElements() const override;
 	Tensor::Shape getShape() const override;
+	DType getDType() const override;
 
 	/// Returns a raw pointer to the device data buffer.
+	/// @pre The dtype is Float32.
 	float* dataPtr() const;
 	std::vector<float> toVector() const override;
+	void copyToHost(void* data) const override;
 	std::string toString() const override;
 
 	std::unique_ptr<Tensor::Impl> clone() const override;
 
 	void copyFromHost(const float* data, size_t count) override;
+	void copyFromHost(const void* data) override;
 
 	void set(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	         const TensorLayout& rhsLayout) override;
+	void setAll(const std::vector<SetCopy>& copies) override;
 
 	bool compare(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	             const TensorLayout& rhsLayout) const override;
 
 	std::unique_ptr<Tensor::Impl> add(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> sub(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> mul(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> div(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                  const TensorLayout& rhsLayout,
-	                                  const TensorLayout& outLayout) const override;
+	                                  const TensorLayout& outLayout, DType dtype) const override;
 
 	void iadd(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	          const TensorLayout& rhsLayout) override;
@@ -67,6 +76,9 @@ public:
 	void idiv(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	          const TensorLayout& rhsLayout) override;
 
+	void maskedFill(const TensorLayout& lhsLayout, const Tensor::Impl* maskImpl,
+	                const TensorLayout& maskLayout, float value) override;
+
 	std::unique_ptr<Tensor::Impl> sum(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                  const TensorLayout& outLayout) const override;
 
@@ -79,7 +91,8 @@ public:
 	std::unique_ptr<Tensor::Impl> prod(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                   const TensorLayout& outLayout) const override;
 
-	std::unique_ptr<Tensor::Impl> norm(const TensorLayout& layout) const override;
+	std::unique_ptr<Tensor::Impl> norm(const TensorLayout& layout, const TensorLayout& blockLayout,
+	                                   const TensorLayout& outLayout) const override;
 
 	std::unique_ptr<Tensor::Impl> all(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                  const TensorLayout& outLayout) const override;
@@ -87,57 +100,168 @@ public:
 	std::unique_ptr<Tensor::Impl> any(const TensorLayout& layout, const TensorLayout& blockLayout,
 	                                  const TensorLayout& outLayout) const override;
 
+	std::unique_ptr<Tensor::Impl> countNonzero(const TensorLayout& layout,
+	                                           const TensorLayout& blockLayout,
+	                                           const TensorLayout& outLayout) const override;
+
+	std::unique_ptr<Tensor::Impl> argmin(const TensorLayout& layout,
+	                                     const TensorLayout& blockLayout,
+	                                     const TensorLayout& outLayout) const override;
+
+	std::unique_ptr<Tensor::Impl> argmax(const TensorLayout& layout,
+	                                     const TensorLayout& blockLayout,
+	                                     const TensorLayout& outLayout) const override;
+
+	void topk(const TensorLayout& layout, const TensorLayout& blockLayout, size_t k, bool largest,
+	          Tensor::Impl* valuesImpl, Tensor::Impl* indicesImpl) const override;
+
+	void sort(const TensorLayout& layout, const TensorLayout& blockLayout, bool descending,
+	          Tensor::Impl* valuesImpl, Tensor::Impl* indicesImpl) const override;
+
+	std::unique_ptr<Tensor::Impl> partition(const TensorLayout& layout,
+	                                        const TensorLayout& blockLayout,
+	                                        size_t kth) const override;
+
+	std::unique_ptr<Tensor::Impl> scan(const TensorLayout& layout, size_t dim, ScanOp op,
+	                                   bool exclusive) const override;
+
+	std::unique_ptr<Tensor::Impl> gather(const TensorLayout& layout, size_t dim,
+	                                     const Tensor::Impl* indexImpl,
+	                                     const TensorLayout& indexLayout) const override;
+
+	void scatter(const TensorLayout& layout, size_t dim, const Tensor::Impl* indexImpl,
+	             const TensorLayout& indexLayout, const Tensor::Impl* srcImpl,
+	             const TensorLayout& srcLayout, bool accumulate) override;
+
+	bool reducePredicate(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
+	                     const TensorLayout& rhsLayout, Predicate predicate, float tolerance,
+	                     bool all, DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> map(const TensorLayout& layout, UnaryOp op, float alpha,
+	                                  float beta, DType dtype) const override;
+
+	void mapInto(const TensorLayout& layout, const Tensor::Impl* srcImpl,
+	             const TensorLayout& srcLayout, UnaryOp op, float alpha, float beta,
+	             DType dtype) override;
+
+	std::unique_ptr<Tensor::Impl> softmax(const TensorLayout& layout,
+	                                      const TensorLayout& blockLayout,
+	                                      bool log) const override;
+
+	std::unique_ptr<Tensor::Impl> logSumExp(const TensorLayout& layout,
+	                                        const TensorLayout& blockLayout,
+	                                        const TensorLayout& outLayout) const override;
+
 	std::unique_ptr<Tensor::Impl> matmul(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                     const TensorLayout& rhsLayout,
 	                                     const TensorLayout& outLayout, size_t batch, size_t m,
-	                                     size_t k, size_t p) const override;
+	                                     size_t k, size_t p, DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> matmulInt8(const TensorLayout& lhsLayout,
+	                                         const Tensor::Impl* rhsImpl,
+	                                         const TensorLayout& rhsLayout,
+	                                         const TensorLayout& outLayout, size_t batch, size_t m,
+	                                         size_t k, size_t p, int32_t lhsZeroPoint,
+	                                         int32_t rhsZeroPoint,
+	                                         const Requantize* requantize) const override;
+
+	std::unique_ptr<Tensor::Impl> conv(const TensorLayout& layout, const Tensor::Impl* weightImpl,
+	                                   const TensorLayout& weightLayout,
+	                                   const TensorLayout& outLayout, const Convolution& geometry,
+	                                   DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> quantize(const TensorLayout& layout,
+	                                       const Tensor::Impl* scaleImpl,
+	                                       const TensorLayout& scaleLayout,
+	                                       const Tensor::Impl* zeroPointImpl,
+	                                       const TensorLayout& zeroPointLayout,
+	                                       const TensorLayout& outLayout,
+	                                       DType dtype) const override;
+
+	std::unique_ptr<Tensor::Impl> dequantize(const TensorLayout& layout,
+	                                         const Tensor::Impl* scaleImpl,
+	                                         const TensorLayout& scaleLayout,
+	                                         const Tensor::Impl* zeroPointImpl,
+	                                         const TensorLayout& zeroPointLayout,
+	                                         const TensorLayout& outLayout) const override;
+
+	bool cholesky(size_t batch, size_t n) override;
+
+	void lu(size_t batch, size_t n, Tensor::Impl* permutationImpl) override;
+
+	void qr(size_t batch, size_t m, size_t n, Tensor::Impl* qImpl, Tensor::Impl* rImpl) override;
+
+	bool solveTriangular(size_t batch, size_t n, size_t k, Tensor::Impl* rhsImpl, bool lower,
+	                     bool unitDiagonal) const override;
 
 	std::unique_ptr<Tensor::Impl> equal(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                    const TensorLayout& rhsLayout,
-	                                    const TensorLayout& outLayout) const override;
+	                                    const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> notEqual(const TensorLayout& lhsLayout,
 	                                       const Tensor::Impl* rhsImpl,
 	                                       const TensorLayout& rhsLayout,
-	                                       const TensorLayout& outLayout) const override;
+	                                       const TensorLayout& outLayout,
+	                                       DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> less(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                                   const TensorLayout& rhsLayout,
-	                                   const TensorLayout& outLayout) const override;
+	                                   const TensorLayout& outLayout, DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> lessEqual(const TensorLayout& lhsLayout,
 	                                        const Tensor::Impl* rhsImpl,
 	                                        const TensorLayout& rhsLayout,
-	                                        const TensorLayout& outLayout) const override;
+	                                        const TensorLayout& outLayout,
+	                                        DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> greater(const TensorLayout& lhsLayout,
 	                                      const Tensor::Impl* rhsImpl,
 	                                      const TensorLayout& rhsLayout,
-	                                      const TensorLayout& outLayout) const override;
+	                                      const TensorLayout& outLayout,
+	                                      DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> greaterEqual(const TensorLayout& lhsLayout,
 	                                           const Tensor::Impl* rhsImpl,
 	                                           const TensorLayout& rhsLayout,
-	                                           const TensorLayout& outLayout) const override;
+	                                           const TensorLayout& outLayout,
+	                                           DType dtype) const override;
 
 	std::unique_ptr<Tensor::Impl> isClose(const TensorLayout& lhsLayout,
 	                                      const Tensor::Impl* rhsImpl,
 	                                      const TensorLayout& rhsLayout,
 	                                      const TensorLayout& outLayout,
-	                                      float tolerance) const override;
+	                                      float tolerance, DType dtype) const override;
 
 private:
 	Tensor::Shape m_shape;
-	float* d_data;
+	DType m_dtype;
+	profiling::detail::TrackedAllocation m_allocation;
+	void* d_data;
 
 	/// Downcasts a generic Impl pointer to CUDAImpl. Asserts the type matches.
 	const Tensor::CUDAImpl* cast(const Tensor::Impl* p) const;
 
+	/// Returns a copy with elements converted to `dtype`.
+	std::unique_ptr<Tensor::CUDAImpl> convertTo(DType dtype) const;
+
+	/// Overwrites every element with the elements of `source`, converted to the dtype of `this`.
+	void storeFrom(const Tensor::CUDAImpl& source);
+
+	/// Returns `impl` if it is Float32, else a Float32 copy owned by `staging`.
+	const Tensor::CUDAImpl* asFloat32(const Tensor::Impl* impl,
+	                                  std::unique_ptr<Tensor::CUDAImpl>& staging) const;
+
+	/// Calls `write(float* data)` on the storage of `this`, staged through Float32 if needed.
+	template <typename Write>
+	void writeAsFloat32(Write write);
+
+	/// Result has dtype `outType`.
 	template <typename Kernel>
 	std::unique_ptr<Tensor::Impl> applyKernel(const TensorLayout& lhsLayout,
 	                                          const Tensor::Impl* rhsImpl,
 	                                          const TensorLayout& rhsLayout,
-	                                          const TensorLayout& outLayout, Kernel kernel) const;
+	                                          const TensorLayout& outLayout, Kernel kernel,
+	                                          DType outType = DType::Float32) const;
 
 	template <typename Kernel>
 	void applyInplaceKernel(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
@@ -145,11 +269,13 @@ private:
 
 
 	// kernel must be associative
+	// result has dtype `outType`
 	template <typename Kernel>
 	std::unique_ptr<Tensor::Impl> applyReductionKernel(const TensorLayout& layout,
 	                                                   const TensorLayout& blockLayout,
 	                                                   const TensorLayout& outLayout,
-	                                                   float initValue, Kernel kernel) const;
+	                                                   float initValue, Kernel kernel,
+	                                                   DType outType = DType::Float32) const;
 };
 
 #endif  // TENSOR_IMPL_CUDA_H
\ No newline at end of file
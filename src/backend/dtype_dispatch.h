@@ -0,0 +1,140 @@
+#ifndef DTYPE_DISPATCH_H
+#define DTYPE_DISPATCH_H
+
+#include <cstdint>
+#include <type_traits>
+
+#include "backend/half.h"
+#include "nforge/core/dtype.h"
+
+/// C++ type of one element of a `DType`.
+template <DType D>
+struct ElementType;
+
+template <>
+struct ElementType<DType::Float32> {
+	using type = float;
+};
+
+template <>
+struct ElementType<DType::Float64> {
+	using type = double;
+};
+
+template <>
+struct ElementType<DType::Float16> {
+	using type = Float16;
+};
+
+template <>
+struct ElementType<DType::BFloat16> {
+	using type = BFloat16;
+};
+
+template <>
+struct ElementType<DType::Int64> {
+	using type = int64_t;
+};
+
+template <>
+struct ElementType<DType::Int32> {
+	using type = int32_t;
+};
+
+template <>
+struct ElementType<DType::Int8> {
+	using type = int8_t;
+};
+
+template <>
+struct ElementType<DType::UInt8> {
+	using type = uint8_t;
+};
+
+template <>
+struct ElementType<DType::Bool> {
+	using type = bool;
+};
+
+/// `DType` of a C++ element type.
+template <typename T>
+constexpr DType dtypeOf();
+
+template <>
+constexpr DType dtypeOf<float>() {
+	return DType::Float32;
+}
+
+template <>
+constexpr DType dtypeOf<double>() {
+	return DType::Float64;
+}
+
+template <>
+constexpr DType dtypeOf<Float16>() {
+	return DType::Float16;
+}
+
+template <>
+constexpr DType dtypeOf<BFloat16>() {
+	return DType::BFloat16;
+}
+
+template <>
+constexpr DType dtypeOf<int64_t>() {
+	return DType::Int64;
+}
+
+template <>
+constexpr DType dtypeOf<int32_t>() {
+	return DType::Int32;
+}
+
+template <>
+constexpr DType dtypeOf<int8_t>() {
+	return DType::Int8;
+}
+
+template <>
+constexpr DType dtypeOf<uint8_t>() {
+	return DType::UInt8;
+}
+
+template <>
+constexpr DType dtypeOf<bool>() {
+	return DType::Bool;
+}
+
+/// Calls `f` with a null pointer to the element type of `dtype`, so kernels can be instantiated
+/// per element type:
+///
+///     dispatchDType(dtype, [&](auto* tag) {
+///         using T = std::remove_pointer_t<decltype(tag)>;
+///         ...
+///     });
+template <typename F>
+decltype(auto) dispatchDType(DType dtype, F&& f) {
+	switch (dtype) {
+		case DType::Float64:
+			return f(static_cast<double*>(nullptr));
+		case DType::Float16:
+			return f(static_cast<Float16*>(nullptr));
+		case DType::BFloat16:
+			return f(static_cast<BFloat16*>(nullptr));
+		case DType::Int64:
+			return f(static_cast<int64_t*>(nullptr));
+		case DType::Int32:
+			return f(static_cast<int32_t*>(nullptr));
+		case DType::Int8:
+			return f(static_cast<int8_t*>(nullptr));
+		case DType::UInt8:
+			return f(static_cast<uint8_t*>(nullptr));
+		case DType::Bool:
+			return f(static_cast<bool*>(nullptr));
+		case DType::Float32:
+		default:
+			return f(static_cast<float*>(nullptr));
+	}
+}
+
+#endif  // DTYPE_DISPATCH_H
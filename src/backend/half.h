@@ -0,0 +1,124 @@
+#ifndef BACKEND_HALF_H
+#define BACKEND_HALF_H
+
+#include <cstdint>
+#include <cstring>
+
+#ifndef NFORGE_HOST_DEVICE
+#ifdef __CUDACC__
+#define NFORGE_HOST_DEVICE __host__ __device__
+#else
+#define NFORGE_HOST_DEVICE
+#endif
+#endif
+
+/// 16 bit storage types. Neither has arithmetic of its own: values convert implicitly to float,
+/// kernels compute in float and round back on store. Conversions from float round to nearest
+/// even, overflow becomes infinity and NaN stays NaN.
+
+namespace detail {
+
+NFORGE_HOST_DEVICE inline uint32_t floatBits(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+NFORGE_HOST_DEVICE inline float bitsFloat(uint32_t bits) {
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+}  // namespace detail
+
+/// IEEE 754 binary16: 1 sign, 5 exponent and 10 mantissa bits.
+struct Float16 {
+	uint16_t bits = 0;
+
+	Float16() = default;
+
+	NFORGE_HOST_DEVICE explicit Float16(float value) : bits(fromFloat(value)) {}
+
+	/// Any arithmetic type, through float.
+	template <typename T>
+	NFORGE_HOST_DEVICE explicit Float16(T value) : Float16(static_cast<float>(value)) {}
+
+	NFORGE_HOST_DEVICE operator float() const { return toFloat(bits); }
+
+	NFORGE_HOST_DEVICE static uint16_t fromFloat(float value) {
+		constexpr uint32_t INFINITY_BITS = 255u << 23;
+		// smallest float that rounds to infinity in half precision, 65520
+		constexpr uint32_t OVERFLOW_BITS = (127u + 16u) << 23;
+		// values below 2^-14 are subnormal in half precision
+		constexpr uint32_t SUBNORMAL_BITS = 113u << 23;
+		// 0.5, adding it aligns the subnormal mantissa with the low bits and rounds to even
+		constexpr uint32_t DENORMAL_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+		uint32_t x = detail::floatBits(value);
+		uint32_t sign = x & 0x80000000u;
+		x ^= sign;
+
+		// all three cases are computed and selected without branches, so loops over
+		// conversions vectorize
+		uint32_t overflow = x > INFINITY_BITS ? 0x7e00u : 0x7c00u;
+
+		float shifted = detail::bitsFloat(x) + detail::bitsFloat(DENORMAL_MAGIC);
+		uint32_t subnormal = detail::floatBits(shifted) - DENORMAL_MAGIC;
+
+		uint32_t odd = (x >> 13) & 1u;
+		uint32_t normal = (x + ((15u - 127u) << 23) + 0xfffu + odd) >> 13;
+
+		uint32_t result = x >= OVERFLOW_BITS ? overflow : x < SUBNORMAL_BITS ? subnormal : normal;
+		return static_cast<uint16_t>(result | (sign >> 16));
+	}
+
+	NFORGE_HOST_DEVICE static float toFloat(uint16_t bits) {
+		constexpr uint32_t EXPONENT_BITS = 0x7c00u << 13;
+		constexpr uint32_t MAGIC = 113u << 23;
+
+		uint32_t x = (bits & 0x7fffu) << 13;
+		uint32_t exponent = x & EXPONENT_BITS;
+		x += (127u - 15u) << 23;
+
+		// infinity and NaN keep the maximum exponent
+		x += exponent == EXPONENT_BITS ? (128u - 16u) << 23 : 0u;
+
+		// zero and subnormals are renormalized through float arithmetic
+		float renormalized = detail::bitsFloat(x + (1u << 23)) - detail::bitsFloat(MAGIC);
+		x = exponent == 0 ? detail::floatBits(renormalized) : x;
+
+		return detail::bitsFloat(x | (static_cast<uint32_t>(bits & 0x8000u) << 16));
+	}
+};
+
+/// bfloat16: the upper 16 bits of a float, 8 exponent and 7 mantissa bits. Same range as float.
+struct BFloat16 {
+	uint16_t bits = 0;
+
+	BFloat16() = default;
+
+	NFORGE_HOST_DEVICE explicit BFloat16(float value) : bits(fromFloat(value)) {}
+
+	/// Any arithmetic type, through float.
+	template <typename T>
+	NFORGE_HOST_DEVICE explicit BFloat16(T value) : BFloat16(static_cast<float>(value)) {}
+
+	NFORGE_HOST_DEVICE operator float() const { return toFloat(bits); }
+
+	NFORGE_HOST_DEVICE static uint16_t fromFloat(float value) {
+		uint32_t x = detail::floatBits(value);
+		if ((x & 0x7fffffffu) > 0x7f800000u) {
+			// keep NaN quiet, rounding could carry it into infinity
+			return static_cast<uint16_t>((x >> 16) | 0x40u);
+		}
+		x += 0x7fffu + ((x >> 16) & 1u);
+		return static_cast<uint16_t>(x >> 16);
+	}
+
+	NFORGE_HOST_DEVICE static float toFloat(uint16_t bits) {
+		return detail::bitsFloat(static_cast<uint32_t>(bits) << 16);
+	}
+};
+
+#endif  // BACKEND_HALF_H
@@ -3,6 +3,7 @@
 
 #include "nforge/core/tensor.h"
 #include "nforge/core/tensor_layout.h"
+#include "rng/philox.h"
 
 /// Abstract interface for backend specific tensor storage and operations.
 ///
@@ -12,16 +13,57 @@
 /// correct for `rhsImpl` and `lhsLayout` is correct for its own memory.
 ///
 /// The caller is responsible for broadcasting.
+///
+/// Operands may have any `DType`. Binary operations and matmul get the `dtype` both operands are
+/// promoted to, see `promoteTypes`: arithmetic and matmul produce it, comparisons compare in it and
+/// produce Bool. Sums and products produce `getAccumulateType`, min and max keep the dtype, norms
+/// are Float64 for Float64 and Float32 otherwise, `all` and `any` produce Bool. In-place
+/// operations and `set` convert to the dtype of `this`.
 class Tensor::Impl {
 public:
+	/// Requantize epilogue of `matmulInt8`.
+	struct Requantize {
+		/// Float32 with one element, or one per output column.
+		const Tensor::Impl* multiplier;
+		int32_t zeroPoint;
+		/// Int8 or UInt8.
+		DType dtype;
+	};
+
+	/// One copy of `setAll`, from `source` with `sourceLayout` into `targetLayout` of `this`.
+	struct SetCopy {
+		const Tensor::Impl* source;
+		TensorLayout sourceLayout;
+		TensorLayout targetLayout;
+	};
+
+	/// Geometry of `conv`, a 2D convolution of a (batch, inChannels, height, width) input with
+	/// (outChannels, inChannels, kernelHeight, kernelWidth) weights. 1D convolutions have height
+	/// and kernel height 1.
+	struct Convolution {
+		size_t batch;
+		size_t inChannels;
+		size_t outChannels;
+		size_t height;
+		size_t width;
+		size_t kernelHeight;
+		size_t kernelWidth;
+		size_t outHeight;
+		size_t outWidth;
+		/// Per spatial dim, height first. Padding is zero on both sides.
+		std::array<size_t, 2> stride;
+		std::array<size_t, 2> padding;
+		std::array<size_t, 2> dilation;
+	};
+
 	Impl() = default;
 	virtual ~Impl() = default;
 
 	/// Fills all elements with `value`.
 	virtual void fillAll(float value) = 0;
 
-	/// Fills all elements with random values in [-1, 1].
-	virtual void fillRand() = 0;
+	/// Fills element `i` with element `i` of `stream` drawn from `dist`.
+	virtual void fillRandom(const rng::Distribution& dist, const rng::Stream& stream) = 0;
 
 	/// Prints the entire tensor to stdout.
 	virtual void print() const = 0;
@@ -35,24 +77,39 @@ public:
 	/// Returns the tensor shape.
 	virtual Tensor::Shape getShape() const = 0;
 
-	/// Copies all elements into a flat vector (row-major order).
+	/// Returns the element type.
+	virtual DType getDType() const = 0;
+
+	/// Copies all elements into a flat vector (row-major order), converted to float.
 	virtual std::vector<float> toVector() const = 0;
 
+	/// Copies all elements into `data` in their own dtype, without conversion.
+	/// @param data  Host array of at least getNumElements() * getDTypeSize(getDType()) bytes.
+	virtual void copyToHost(void* data) const = 0;
+
 	/// Returns a string representation of the data.
 	virtual std::string toString() const = 0;
 
 	/// Deep copies this implementation.
 	virtual std::unique_ptr<Tensor::Impl> clone() const = 0;
 
-	/// Copies data from a host float array into this backend's storage.
+	/// Copies data from a host float array into this backend's storage, converted to the dtype.
 	/// @param data  Source array (must have at least `count` elements).
 	/// @param count  Number of elements to copy.
 	virtual void copyFromHost(const float* data, size_t count) = 0;
 
+	/// Copies all elements from `data` in their own dtype, without conversion.
+	/// @param data  Host array of getNumElements() * getDTypeSize(getDType()) bytes.
+	virtual void copyFromHost(const void* data) = 0;
+
 	/// Copies data from `rhsImpl` with `rhsLayout` into `this` with `lhsLayout`.
 	virtual void set(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                 const TensorLayout& rhsLayout) = 0;
 
+	/// `set` for every copy of `copies`. The targets do not overlap, so the copies may run in
+	/// any order.
+	virtual void setAll(const std::vector<SetCopy>& copies) = 0;
+
 	/// Returns true if the data with `lhsLayout` matches `rhsImpl` with `rhsLayout`.
 	virtual bool compare(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                     const TensorLayout& rhsLayout) const = 0;
@@ -61,25 +118,25 @@ public:
 	virtual std::unique_ptr<Tensor::Impl> add(const TensorLayout& lhsLayout,
 	                                          const Tensor::Impl* rhsImpl,
 	                                          const TensorLayout& rhsLayout,
-	                                          const TensorLayout& outLayout) const = 0;
+	                                          const TensorLayout& outLayout, DType dtype) const = 0;
 
 	/// Elementwise subtraction. Returns a new Impl with the result with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> sub(const TensorLayout& lhsLayout,
 	                                          const Tensor::Impl* rhsImpl,
 	                                          const TensorLayout& rhsLayout,
-	                                          const TensorLayout& outLayout) const = 0;
+	                                          const TensorLayout& outLayout, DType dtype) const = 0;
 
 	/// Elementwise multiplication. Returns a new Impl with the result with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> mul(const TensorLayout& lhsLayout,
 	                                          const Tensor::Impl* rhsImpl,
 	                                          const TensorLayout& rhsLayout,
-	                                          const TensorLayout& outLayout) const = 0;
+	                                          const TensorLayout& outLayout, DType dtype) const = 0;
 
 	/// Elementwise division. Returns a new Impl with the result with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> div(const TensorLayout& lhsLayout,
 	                                          const Tensor::Impl* rhsImpl,
 	                                          const TensorLayout& rhsLayout,
-	                                          const TensorLayout& outLayout) const = 0;
+	                                          const TensorLayout& outLayout, DType dtype) const = 0;
 
 	/// In-place elementwise addition. Modifies `lhsLayout` in place.
 	virtual void iadd(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
@@ -97,6 +154,10 @@ public:
 	virtual void idiv(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
 	                  const TensorLayout& rhsLayout) = 0;
 
+	/// Sets the elements of `lhsLayout` where `maskImpl` with `maskLayout` is non-zero to `value`.
+	virtual void maskedFill(const TensorLayout& lhsLayout, const Tensor::Impl* maskImpl,
+	                        const TensorLayout& maskLayout, float value) = 0;
+
 	/// Reduces dimensions [dim, rank) by summation. Output with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> sum(const TensorLayout& layout,
 	                                          const TensorLayout& blockLayout,
@@ -117,23 +178,111 @@ public:
 	                                           const TensorLayout& blockLayout,
 	                                           const TensorLayout& outLayout) const = 0;
 
-	/// L2 norm of the tensor described by `layout`.
-	virtual std::unique_ptr<Tensor::Impl> norm(const TensorLayout& layout) const = 0;
+	/// Reduces dimensions [dim, rank) by taking the L2 norm. Output with `outLayout`.
+	virtual std::unique_ptr<Tensor::Impl> norm(const TensorLayout& layout,
+	                                           const TensorLayout& blockLayout,
+	                                           const TensorLayout& outLayout) const = 0;
 
 	/// For each block, tests whether all element evaluate to True (non-zero).
 	/// Reduces dimensions [dim, rank) by applying logical AND.
-	/// Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> all(const TensorLayout& layout,
 	                                          const TensorLayout& blockLayout,
 	                                          const TensorLayout& outLayout) const = 0;
 
 	/// For each block, tests whether any element evaluate to True (non-zero).
 	/// Reduces dimensions [dim, rank) by applying logical OR.
-	/// Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> any(const TensorLayout& layout,
 	                                          const TensorLayout& blockLayout,
 	                                          const TensorLayout& outLayout) const = 0;
 
+	/// Applies `op` elementwise in `dtype`, see `UnaryOp` for `alpha` and `beta`. Returns a
+	/// contiguous tensor of `dtype` with the shape of `layout`.
+	virtual std::unique_ptr<Tensor::Impl> map(const TensorLayout& layout, UnaryOp op, float alpha,
+	                                          float beta, DType dtype) const = 0;
+
+	/// Writes `op` of `srcImpl` computed in `dtype` into the elements of `layout`, converting to
+	/// the dtype of `this`. `srcImpl` may be `this`.
+	virtual void mapInto(const TensorLayout& layout, const Tensor::Impl* srcImpl,
+	                     const TensorLayout& srcLayout, UnaryOp op, float alpha, float beta,
+	                     DType dtype) = 0;
+
+	/// Softmax of each block, or log softmax if `log`. Returns a contiguous tensor with the shape
+	/// of `layout`, of the same dtype for floating dtypes and Float32 otherwise.
+	virtual std::unique_ptr<Tensor::Impl> softmax(const TensorLayout& layout,
+	                                              const TensorLayout& blockLayout,
+	                                              bool log) const = 0;
+
+	/// log(sum(exp(x))) of each block. Returns a tensor with `outLayout`, dtypes as in `softmax`.
+	virtual std::unique_ptr<Tensor::Impl> logSumExp(const TensorLayout& layout,
+	                                                const TensorLayout& blockLayout,
+	                                                const TensorLayout& outLayout) const = 0;
+
+	/// Counts the non-zero elements of each block. Returns an Int64 tensor with `outLayout`.
+	virtual std::unique_ptr<Tensor::Impl> countNonzero(const TensorLayout& layout,
+	                                                   const TensorLayout& blockLayout,
+	                                                   const TensorLayout& outLayout) const = 0;
+
+	/// Index of the first smallest element of each block, counted in the block. Returns an Int64
+	/// tensor with `outLayout`.
+	virtual std::unique_ptr<Tensor::Impl> argmin(const TensorLayout& layout,
+	                                             const TensorLayout& blockLayout,
+	                                             const TensorLayout& outLayout) const = 0;
+
+	/// Index of the first largest element of each block, see `argmin`.
+	virtual std::unique_ptr<Tensor::Impl> argmax(const TensorLayout& layout,
+	                                             const TensorLayout& blockLayout,
+	                                             const TensorLayout& outLayout) const = 0;
+
+	/// Writes the `k` largest elements of each block, or the `k` smallest if not `largest`, into
+	/// `valuesImpl` and their indices in the block into the Int64 `indicesImpl`. Both outputs are
+	/// contiguous with `k` elements per block, `valuesImpl` has the dtype of `this`.
+	virtual void topk(const TensorLayout& layout, const TensorLayout& blockLayout, size_t k,
+	                  bool largest, Tensor::Impl* valuesImpl, Tensor::Impl* indicesImpl) const = 0;
+
+	/// Sorts each block ascending, or descending if `descending`, writing the sorted values into
+	/// `valuesImpl` and their indices in the block into the Int64 `indicesImpl`. Either output may
+	/// be null, both are contiguous in the shape of `layout` and `valuesImpl` has the dtype of
+	/// `this`. The sort is stable and NaN order above every number.
+	virtual void sort(const TensorLayout& layout, const TensorLayout& blockLayout, bool descending,
+	                  Tensor::Impl* valuesImpl, Tensor::Impl* indicesImpl) const = 0;
+
+	/// Each block reordered so the element at `kth` is the one `sort` puts there, with no larger
+	/// element before it and no smaller one after. Returns a contiguous tensor of the dtype of
+	/// `this` in the shape of `layout`.
+	virtual std::unique_ptr<Tensor::Impl> partition(const TensorLayout& layout,
+	                                                const TensorLayout& blockLayout,
+	                                                size_t kth) const = 0;
+
+	/// Scan of `op` along dim `dim` of `layout`, inclusive or shifted by one if `exclusive`.
+	/// Returns a contiguous tensor in the shape of `layout`, of `getAccumulateType` for Sum and
+	/// Prod and of the dtype of `this` for Max and Min.
+	virtual std::unique_ptr<Tensor::Impl> scan(const TensorLayout& layout, size_t dim, ScanOp op,
+	                                           bool exclusive) const = 0;
+
+	/// Reads `this` through the integer `indexImpl` along dim `dim`: the element at position p of
+	/// `indexLayout` is the one of `layout` at p with coordinate `dim` replaced by the index at p.
+	/// `indexLayout` has the rank of `layout` and no other dim longer than it. Returns a
+	/// contiguous tensor of the dtype of `this` in the shape of `indexLayout`.
+	virtual std::unique_ptr<Tensor::Impl> gather(const TensorLayout& layout, size_t dim,
+	                                             const Tensor::Impl* indexImpl,
+	                                             const TensorLayout& indexLayout) const = 0;
+
+	/// Inverse of `gather`, writes the element of `srcImpl` at each position of `indexLayout` to
+	/// the element of `layout` `gather` would read there, converting to the dtype of `this`. Adds
+	/// to it instead if `accumulate`, so repeated indices sum up. `srcLayout` has the shape of
+	/// `indexLayout`.
+	virtual void scatter(const TensorLayout& layout, size_t dim, const Tensor::Impl* indexImpl,
+	                     const TensorLayout& indexLayout, const Tensor::Impl* srcImpl,
+	                     const TensorLayout& srcLayout, bool accumulate) = 0;
+
+	/// Evaluates `predicate` in `dtype` over all element pairs and reduces with AND if `all`,
+	/// else with OR. `tolerance` is used by Predicate::IsClose.
+	virtual bool reducePredicate(const TensorLayout& lhsLayout, const Tensor::Impl* rhsImpl,
+	                             const TensorLayout& rhsLayout, Predicate predicate,
+	                             float tolerance, bool all, DType dtype) const = 0;
+
 	/// Matrix multiplication. The last two dims of each layout are the matrix dims.
 	/// `batch`, `m`, `k`, `p` describe the decomposition of the matmul problem.
 	///
@@ -144,51 +293,117 @@ public:
 	                                             const Tensor::Impl* rhsImpl,
 	                                             const TensorLayout& rhsLayout,
 	                                             const TensorLayout& outLayout, size_t batch,
-	                                             size_t m, size_t k, size_t p) const = 0;
-
-
-	/// Elementwise equal. Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	                                             size_t m, size_t k, size_t p,
+	                                             DType dtype) const = 0;
+
+
+	/// Int8 matrix multiplication, (lhs - lhsZeroPoint) @ (rhs - rhsZeroPoint) with int32
+	/// accumulation. `this` is Int8 or UInt8, `rhsImpl` Int8, shapes as for `matmul`.
+	/// Returns Int32, or `requantize->dtype` if `requantize` is set.
+	virtual std::unique_ptr<Tensor::Impl> matmulInt8(const TensorLayout& lhsLayout,
+	                                                 const Tensor::Impl* rhsImpl,
+	                                                 const TensorLayout& rhsLayout,
+	                                                 const TensorLayout& outLayout, size_t batch,
+	                                                 size_t m, size_t k, size_t p,
+	                                                 int32_t lhsZeroPoint, int32_t rhsZeroPoint,
+	                                                 const Requantize* requantize) const = 0;
+
+	/// Convolution (cross-correlation) of `this`, the input with 4D `layout`, with `weightImpl`,
+	/// both promoted to `dtype`. See `Convolution` for the shapes. Returns a contiguous tensor of
+	/// `dtype` with `outLayout`, which holds (batch, outChannels, outHeight, outWidth) elements.
+	virtual std::unique_ptr<Tensor::Impl> conv(const TensorLayout& layout,
+	                                           const Tensor::Impl* weightImpl,
+	                                           const TensorLayout& weightLayout,
+	                                           const TensorLayout& outLayout,
+	                                           const Convolution& geometry, DType dtype) const = 0;
+
+	/// Quantizes to `dtype`, Int8 or UInt8. All layouts have the shape of `outLayout`.
+	virtual std::unique_ptr<Tensor::Impl> quantize(const TensorLayout& layout,
+	                                               const Tensor::Impl* scaleImpl,
+	                                               const TensorLayout& scaleLayout,
+	                                               const Tensor::Impl* zeroPointImpl,
+	                                               const TensorLayout& zeroPointLayout,
+	                                               const TensorLayout& outLayout,
+	                                               DType dtype) const = 0;
+
+	/// Dequantizes to Float32. All layouts have the shape of `outLayout`.
+	virtual std::unique_ptr<Tensor::Impl> dequantize(const TensorLayout& layout,
+	                                                 const Tensor::Impl* scaleImpl,
+	                                                 const TensorLayout& scaleLayout,
+	                                                 const Tensor::Impl* zeroPointImpl,
+	                                                 const TensorLayout& zeroPointLayout,
+	                                                 const TensorLayout& outLayout) const = 0;
+
+	// Factorizations and solves below work on `batch` contiguous row-major matrices, in place.
+	// `this` and every other impl are Float32 or Float64, all of the same dtype.
+
+	/// Cholesky factors of (n, n) symmetric positive definite matrices, see `Tensor::cholesky`.
+	/// Returns false if a matrix is not positive definite, leaving `this` partly factorized.
+	virtual bool cholesky(size_t batch, size_t n) = 0;
+
+	/// LU factorizations with partial pivoting of (n, n) matrices, see `Tensor::lu`. Writes n
+	/// Int64 row indices per matrix to `permutationImpl`.
+	virtual void lu(size_t batch, size_t n, Tensor::Impl* permutationImpl) = 0;
+
+	/// Reduced QR factorizations of (m, n) matrices, m >= n, see `Tensor::qr`. Writes the (m, n)
+	/// Q to `qImpl` and the (n, n) R to `rImpl`, `this` is left holding the reflectors.
+	virtual void qr(size_t batch, size_t m, size_t n, Tensor::Impl* qImpl,
+	                Tensor::Impl* rImpl) = 0;
+
+	/// Solves `this` @ x = rhs for the (n, k) x of each triangular (n, n) matrix of `this`,
+	/// overwriting `rhsImpl`. See `Tensor::solveTriangular`. Returns false, solving nothing, if
+	/// a diagonal element is zero and not `unitDiagonal`.
+	virtual bool solveTriangular(size_t batch, size_t n, size_t k, Tensor::Impl* rhsImpl,
+	                             bool lower, bool unitDiagonal) const = 0;
+
+	/// Elementwise equal. Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> equal(const TensorLayout& lhsLayout,
 	                                            const Tensor::Impl* rhsImpl,
 	                                            const TensorLayout& rhsLayout,
-	                                            const TensorLayout& outLayout) const = 0;
+	                                            const TensorLayout& outLayout,
+	                                            DType dtype) const = 0;
 
-	/// Elementwise not equal. Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Elementwise not equal. Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> notEqual(const TensorLayout& lhsLayout,
 	                                               const Tensor::Impl* rhsImpl,
 	                                               const TensorLayout& rhsLayout,
-	                                               const TensorLayout& outLayout) const = 0;
+	                                               const TensorLayout& outLayout,
+	                                               DType dtype) const = 0;
 
-	/// Elementwise less than. Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Elementwise less than. Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> less(const TensorLayout& lhsLayout,
 	                                           const Tensor::Impl* rhsImpl,
 	                                           const TensorLayout& rhsLayout,
-	                                           const TensorLayout& outLayout) const = 0;
+	                                           const TensorLayout& outLayout,
+	                                           DType dtype) const = 0;
 
-	/// Elementwise less or equal. Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Elementwise less or equal. Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> lessEqual(const TensorLayout& lhsLayout,
 	                                                const Tensor::Impl* rhsImpl,
 	                                                const TensorLayout& rhsLayout,
-	                                                const TensorLayout& outLayout) const = 0;
+	                                                const TensorLayout& outLayout,
+	                                                DType dtype) const = 0;
 
-	/// Elementwise greater than. Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Elementwise greater than. Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> greater(const TensorLayout& lhsLayout,
 	                                              const Tensor::Impl* rhsImpl,
 	                                              const TensorLayout& rhsLayout,
-	                                              const TensorLayout& outLayout) const = 0;
+	                                              const TensorLayout& outLayout,
+	                                              DType dtype) const = 0;
 
-	/// Elementwise greater or equal. Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Elementwise greater or equal. Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> greaterEqual(const TensorLayout& lhsLayout,
 	                                                   const Tensor::Impl* rhsImpl,
 	                                                   const TensorLayout& rhsLayout,
-	                                                   const TensorLayout& outLayout) const = 0;
+	                                                   const TensorLayout& outLayout,
+	                                                   DType dtype) const = 0;
 
-	/// Elementwise closeness within `tolerance`. Returns a tensor of 0.0 / 1.0 with `outLayout`.
+	/// Elementwise closeness within `tolerance`. Returns a Bool tensor with `outLayout`.
 	virtual std::unique_ptr<Tensor::Impl> isClose(const TensorLayout& lhsLayout,
 	                                              const Tensor::Impl* rhsImpl,
 	                                              const TensorLayout& rhsLayout,
 	                                              const TensorLayout& outLayout,
-	                                              float tolerance) const = 0;
+	                                              float tolerance, DType dtype) const = 0;
 };
 
 #endif  // TENSOR_IMPL_H
\ No newline at end of file
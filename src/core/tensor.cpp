@@ -1,9 +1,13 @@
 #include "nforge/core/tensor.h"
 
+#include "autograd/recorder.h"
 #include "backend/cpu/tensor_impl_CPU.h"
 #include "backend/cuda/tensor_impl_CUDA.h"
+#include "backend/dtype_dispatch.h"
+#include "graph/recorder.h"
 #include "nforge/core/tensor_view.h"
 #include "ops/semantic/semantic.h"
+#include "rng/philox.h"
 
 #ifdef NFORGE_WITH_CUDA
 constexpr bool cudaEnabled = true;
@@ -11,28 +15,34 @@ constexpr bool cudaEnabled = true;
 constexpr bool cudaEnabled = false;
 #endif
 
-Tensor::Tensor(const Tensor::Shape& shape, Backend backend) : m_backend(backend) {
+Tensor::Tensor(const Tensor::Shape& shape, Backend backend)
+    : Tensor(shape, DType::Float32, backend) {}
+
+Tensor::Tensor(const std::initializer_list<size_t>& shape, Backend backend)
+    : Tensor(Tensor::Shape(shape), backend) {}
+
+Tensor::Tensor(const Tensor::Shape& shape, DType dtype, Backend backend) : m_backend(backend) {
 	switch (backend) {
 		case (Backend::CPU):
-			m_impl = std::make_unique<Tensor::CPUImpl>(shape);
+			m_impl = std::make_unique<Tensor::CPUImpl>(shape, dtype);
 			break;
 		case (Backend::CUDA):
 			if constexpr (cudaEnabled) {
-				m_impl = std::make_unique<Tensor::CUDAImpl>(shape);
+				m_impl = std::make_unique<Tensor::CUDAImpl>(shape, dtype);
 			} else {
 				std::cout << "CUDA backend not built!";
-				m_impl = std::make_unique<Tensor::CPUImpl>(shape);
+				m_impl = std::make_unique<Tensor::CPUImpl>(shape, dtype);
 			}
 			break;
 		default:
 			std::cout << "backend not implemented! defaulting to cpu\n";
-			m_impl = std::make_unique<Tensor::CPUImpl>(shape);
+			m_impl = std::make_unique<Tensor::CPUImpl>(shape, dtype);
 			break;
 	}
 }
 
-Tensor::Tensor(const std::initializer_list<size_t>& shape, Backend backend)
-    : Tensor(Tensor::Shape(shape), backend) {}
+Tensor::Tensor(const std::initializer_list<size_t>& shape, DType dtype, Backend backend)
+    : Tensor(Tensor::Shape(shape), dtype, backend) {}
 
 Tensor::Tensor(const Tensor::Shape& shape, float value, Backend backend) : Tensor(shape, backend) {
 	m_impl->fillAll(value);
@@ -43,27 +53,53 @@ Tensor::Tensor(const std::initializer_list<size_t>& shape, float value, Backend
 
 Tensor::Tensor(float value, Backend backend) : Tensor(Tensor::Shape(), value, backend) {}
 
-Tensor::Tensor(const Tensor& rhs) : m_backend(rhs.m_backend), m_impl(rhs.m_impl->clone()) {}
+Tensor::Tensor(const Tensor& rhs) : m_backend(rhs.m_backend), m_impl(rhs.m_impl->clone()) {
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordCopy(rhs.m_impl.get(), m_impl.get());
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordCopy(rhs.m_impl.get(), m_impl.get());
+	}
+}
 
 Tensor::Tensor(std::unique_ptr<Tensor::Impl> impl, Backend backend)
     : m_impl(std::move(impl)), m_backend(backend) {}
 
-Tensor::~Tensor() {}
+Tensor::~Tensor() {
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->release(m_impl.get());
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->release(m_impl);
+	}
+}
 
 void Tensor::to(Backend newBackend) {
 	if (m_backend == newBackend)
 		return;
 
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("to() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_impl.get(), "to");
+
 	auto shape = m_impl->getShape();
-	auto data = m_impl->toVector();
+	auto dtype = m_impl->getDType();
+	// raw bytes, a float round trip would round wide integers and Float64
+	std::vector<uint8_t> data(shape.getNumElements() * getDTypeSize(dtype));
+	m_impl->copyToHost(data.data());
+
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->release(m_impl);
+	}
 
 	switch (newBackend) {
 		case Backend::CPU:
-			m_impl = std::make_unique<Tensor::CPUImpl>(shape);
+			m_impl = std::make_unique<Tensor::CPUImpl>(shape, dtype);
 			break;
 		case Backend::CUDA:
 			if constexpr (cudaEnabled) {
-				m_impl = std::make_unique<Tensor::CUDAImpl>(shape);
+				m_impl = std::make_unique<Tensor::CUDAImpl>(shape, dtype);
 			} else {
 				throw std::runtime_error("CUDA backend not available");
 			}
@@ -72,13 +108,56 @@ void Tensor::to(Backend newBackend) {
 			throw std::runtime_error("Unknown backend");
 	}
 
-	m_impl->copyFromHost(data.data(), data.size());
+	m_impl->copyFromHost(static_cast<const void*>(data.data()));
 	m_backend = newBackend;
 }
 
-void Tensor::fillAll(float value) { m_impl->fillAll(value); }
+void Tensor::fillAll(float value) {
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordOpaqueWrite(m_impl.get(), "fillAll()");
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordOpaqueWrite(m_impl.get());
+	}
+	m_impl->fillAll(value);
+}
 
-void Tensor::fillRand() { m_impl->fillRand(); }
+void Tensor::fillRand() {
+	rng::Distribution dist{rng::DistributionKind::Uniform, -1.0f, 1.0f};
+	applyRandomFill(dist, std::nullopt, "fillRand()");
+}
+
+void Tensor::fillUniform(float low, float high, std::optional<uint64_t> seed) {
+	rng::Distribution dist{rng::DistributionKind::Uniform, low, high};
+	applyRandomFill(dist, seed, "fillUniform()");
+}
+
+void Tensor::fillNormal(float mean, float stddev, std::optional<uint64_t> seed) {
+	rng::Distribution dist{rng::DistributionKind::Normal, mean, stddev};
+	applyRandomFill(dist, seed, "fillNormal()");
+}
+
+void Tensor::fillBernoulli(float p, std::optional<uint64_t> seed) {
+	rng::Distribution dist{rng::DistributionKind::Bernoulli, p, 0.0f};
+	applyRandomFill(dist, seed, "fillBernoulli()");
+}
+
+void Tensor::setRandomSeed(uint64_t seed) { rng::setGlobalSeed(seed); }
+
+void Tensor::applyRandomFill(const rng::Distribution& dist, std::optional<uint64_t> seed,
+                             const char* what) {
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordOpaqueWrite(m_impl.get(), what);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordOpaqueWrite(m_impl.get());
+	}
+
+	size_t blocks = rng::numBlocks(m_impl->getNumElements());
+	rng::Stream stream = seed ? rng::Stream{*seed, 0} : rng::reserveGlobal(blocks);
+
+	m_impl->fillRandom(dist, stream);
+}
 
 void Tensor::print() const { m_impl->print(); }
 
@@ -97,16 +176,52 @@ std::string Tensor::getBackendString() const {
 	}
 }
 
+DType Tensor::getDType() const { return m_impl->getDType(); }
+
+Tensor Tensor::asType(DType dtype) const {
+	Tensor result(getShape(), dtype, m_backend);
+	result.set({}, *this);
+	return result;
+}
+
 std::string Tensor::getDataString() const { return m_impl->toString(); }
 
 size_t Tensor::getNumElements() const { return m_impl->getNumElements(); }
 
 std::vector<float> Tensor::toVector() const { return m_impl->toVector(); }
 
+template <typename T>
+std::vector<T> Tensor::toVector() const {
+	if (getDType() != dtypeOf<T>()) {
+		throw std::runtime_error(std::string("toVector: expected ") +
+		                         getDTypeName(dtypeOf<T>()) + " elements, got " +
+		                         getDTypeName(getDType()));
+	}
+
+	std::vector<T> values(getNumElements());
+	if constexpr (std::is_same_v<T, bool>) {
+		// std::vector<bool> packs its bits, go through bytes
+		std::vector<uint8_t> bytes(values.size());
+		m_impl->copyToHost(bytes.data());
+		std::copy(bytes.begin(), bytes.end(), values.begin());
+	} else {
+		m_impl->copyToHost(values.data());
+	}
+	return values;
+}
+
+template std::vector<float> Tensor::toVector<float>() const;
+template std::vector<double> Tensor::toVector<double>() const;
+template std::vector<int64_t> Tensor::toVector<int64_t>() const;
+template std::vector<int32_t> Tensor::toVector<int32_t>() const;
+template std::vector<int8_t> Tensor::toVector<int8_t>() const;
+template std::vector<uint8_t> Tensor::toVector<uint8_t>() const;
+template std::vector<bool> Tensor::toVector<bool>() const;
+
 void Tensor::set(const std::vector<size_t>& position, const Tensor::View& rhs) {
 	Tensor::View lhs = Tensor::View((Tensor&)*this, position);
 
-	auto ctx = semantic::BinaryOpContext::build(lhs, rhs);
+	auto ctx = semantic::BinaryOpContext::lookup(lhs, rhs);
 
 	auto outShape = Tensor::Shape(ctx.out);
 
@@ -114,7 +229,15 @@ void Tensor::set(const std::vector<size_t>& position, const Tensor::View& rhs) {
 		throw std::invalid_argument("set(): rhs shape does not broadcast to lhs shape");
 	}
 
-	m_impl->set(ctx.lhs, rhs.getParent().m_impl.get(), ctx.rhs);
+	Tensor::Impl* rhsImpl = rhs.getParent().m_impl.get();
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::Set, m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::Set, m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
+
+	m_impl->set(ctx.lhs, rhsImpl, ctx.rhs);
 }
 
 bool Tensor::compare(const Tensor::View& rhs) const {
@@ -122,7 +245,7 @@ bool Tensor::compare(const Tensor::View& rhs) const {
 		return false;
 	}
 
-	auto ctx = semantic::BinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhs);
 	return m_impl->compare(ctx.lhs, rhs.getParent().m_impl.get(), ctx.rhs);
 }
 
@@ -133,34 +256,48 @@ bool Tensor::compare(const std::vector<size_t>& position, const Tensor::View& rh
 		return false;
 	}
 
-	auto ctx = semantic::BinaryOpContext::build(lhs, rhs);
+	auto ctx = semantic::BinaryOpContext::lookup(lhs, rhs);
 	return m_impl->compare(ctx.lhs, rhs.getParent().m_impl.get(), ctx.rhs);
 }
 
 template <typename BinaryOp>
-Tensor Tensor::applyBinaryOp(const Tensor::View& rhs, BinaryOp op) const {
-	auto ctx = semantic::BinaryOpContext::build(*this, rhs);
+Tensor Tensor::applyBinaryOp(const Tensor::View& rhs, BinaryOp op, graph::OpType type) const {
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhs);
+
+	// division is true division, integer and Bool operands divide as Float32
+	DType dtype = ctx.dtype;
+	if (type == graph::OpType::Div && !isFloatingPoint(dtype)) {
+		dtype = DType::Float32;
+	}
 
 	Tensor::Impl* rhsImpl = rhs.getParent().m_impl.get();
-	auto result = (m_impl.get()->*op)(ctx.lhs, rhsImpl, ctx.rhs, ctx.out);
+	auto result = (m_impl.get()->*op)(ctx.lhs, rhsImpl, ctx.rhs, ctx.out, dtype);
+
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordBinary(type, m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs, result.get(),
+		                       ctx.out);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordBinary(type, m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs, result.get(), ctx.out);
+	}
 
 	return Tensor(std::move(result), m_backend);
 }
 
 Tensor Tensor::operator+(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::add);
+	return applyBinaryOp(rhs, &Tensor::Impl::add, graph::OpType::Add);
 }
 
 Tensor Tensor::operator-(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::sub);
+	return applyBinaryOp(rhs, &Tensor::Impl::sub, graph::OpType::Sub);
 }
 
 Tensor Tensor::operator*(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::mul);
+	return applyBinaryOp(rhs, &Tensor::Impl::mul, graph::OpType::Mul);
 }
 
 Tensor Tensor::operator/(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::div);
+	return applyBinaryOp(rhs, &Tensor::Impl::div, graph::OpType::Div);
 }
 
 Tensor Tensor::operator+(float scalar) const { return *this + Tensor(scalar, m_backend); }
@@ -180,28 +317,70 @@ Tensor operator*(float scalar, const Tensor& rhs) { return Tensor(scalar, rhs.m_
 Tensor operator/(float scalar, const Tensor& rhs) { return Tensor(scalar, rhs.m_backend) / rhs; }
 
 template <typename BinaryOp>
-void Tensor::applyInplaceBinaryOp(const Tensor::View& rhs, BinaryOp op) {
-	auto ctx = semantic::InplaceBinaryOpContext::build(*this, rhs);
+void Tensor::applyInplaceBinaryOp(const Tensor::View& rhs, BinaryOp op, graph::OpType type) {
+	auto ctx = semantic::InplaceBinaryOpContext::lookup(*this, rhs);
 
 	Tensor::Impl* rhsImpl = rhs.getParent().m_impl.get();
 
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(type, m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(type, m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
+
 	(m_impl.get()->*op)(ctx.lhs, rhsImpl, ctx.rhs);
 }
 
-void Tensor::operator+=(const Tensor::View& rhs) { applyInplaceBinaryOp(rhs, &Tensor::Impl::iadd); }
+void Tensor::operator+=(const Tensor::View& rhs) {
+	applyInplaceBinaryOp(rhs, &Tensor::Impl::iadd, graph::OpType::IAdd);
+}
 
-void Tensor::operator-=(const Tensor::View& rhs) { applyInplaceBinaryOp(rhs, &Tensor::Impl::isub); }
+void Tensor::operator-=(const Tensor::View& rhs) {
+	applyInplaceBinaryOp(rhs, &Tensor::Impl::isub, graph::OpType::ISub);
+}
 
-void Tensor::operator*=(const Tensor::View& rhs) { applyInplaceBinaryOp(rhs, &Tensor::Impl::imul); }
+void Tensor::operator*=(const Tensor::View& rhs) {
+	applyInplaceBinaryOp(rhs, &Tensor::Impl::imul, graph::OpType::IMul);
+}
+
+void Tensor::operator/=(const Tensor::View& rhs) {
+	if (!isFloatingPoint(getDType())) {
+		throw std::runtime_error(std::string("Can not divide a ") + getDTypeName(getDType()) +
+		                         " tensor in place, division produces floating point values");
+	}
+	applyInplaceBinaryOp(rhs, &Tensor::Impl::idiv, graph::OpType::IDiv);
+}
 
-void Tensor::operator/=(const Tensor::View& rhs) { applyInplaceBinaryOp(rhs, &Tensor::Impl::idiv); }
+void Tensor::maskedFill(const Tensor::View& mask, float value) {
+	auto ctx = semantic::InplaceBinaryOpContext::lookup(*this, mask);
+
+	Tensor::Impl* maskImpl = mask.getParent().m_impl.get();
+
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::MaskedFill, m_impl.get(), ctx.lhs, maskImpl,
+		                        ctx.rhs, value);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::MaskedFill, m_impl.get(), ctx.lhs, maskImpl, ctx.rhs);
+	}
+
+	m_impl->maskedFill(ctx.lhs, maskImpl, ctx.rhs, value);
+}
 
 template <typename ReductionOp>
-Tensor Tensor::applyReduction(size_t dim, ReductionOp op) const {
-	auto ctx = semantic::ReductionContext::build(*this, dim);
+Tensor Tensor::applyReduction(size_t dim, ReductionOp op, graph::OpType type) const {
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
 
 	auto result = (m_impl.get()->*op)(ctx.lhs, ctx.block, ctx.out);
 
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordReduction(type, m_impl.get(), ctx.lhs, ctx.block, result.get(), ctx.out);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordReduction(type, m_impl.get(), ctx.lhs, ctx.block, result.get(), ctx.out);
+	}
+
 	return Tensor(std::move(result), m_backend);
 }
 
@@ -212,36 +391,489 @@ Tensor Tensor::mean(size_t dim) const {
 	return res / block.getNumElements();
 }
 
-Tensor Tensor::sum(size_t dim) const { return applyReduction(dim, &Tensor::Impl::sum); }
+Tensor Tensor::sum(size_t dim) const {
+	return applyReduction(dim, &Tensor::Impl::sum, graph::OpType::Sum);
+}
 
-Tensor Tensor::min(size_t dim) const { return applyReduction(dim, &Tensor::Impl::min); }
+Tensor Tensor::min(size_t dim) const {
+	return applyReduction(dim, &Tensor::Impl::min, graph::OpType::Min);
+}
 
-Tensor Tensor::max(size_t dim) const { return applyReduction(dim, &Tensor::Impl::max); }
+Tensor Tensor::max(size_t dim) const {
+	return applyReduction(dim, &Tensor::Impl::max, graph::OpType::Max);
+}
 
-Tensor Tensor::prod(size_t dim) const { return applyReduction(dim, &Tensor::Impl::prod); }
+Tensor Tensor::prod(size_t dim) const {
+	return applyReduction(dim, &Tensor::Impl::prod, graph::OpType::Prod);
+}
 
-Tensor Tensor::norm() const {
-	Tensor::View view(*this);
-	TensorLayout layout = view.getLayout();
+Tensor Tensor::norm(size_t dim) const {
+	return applyReduction(dim, &Tensor::Impl::norm, graph::OpType::Norm);
+}
 
-	auto result = m_impl->norm(layout);
-	return Tensor(std::move(result), m_backend);
+Tensor Tensor::all(size_t dim) const {
+	return applyReduction(dim, &Tensor::Impl::all, graph::OpType::All);
+}
+
+Tensor Tensor::any(size_t dim) const {
+	return applyReduction(dim, &Tensor::Impl::any, graph::OpType::Any);
+}
+
+Tensor Tensor::countNonzero(size_t dim) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("countNonzero() can not be recorded in a graph capture");
+	}
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	return Tensor(m_impl->countNonzero(ctx.lhs, ctx.block, ctx.out), m_backend);
+}
+
+/// Throws if the blocks of `ctx` are empty while there are blocks to reduce, `what` has no
+/// index to return for them.
+static void ensureNonEmptyBlocks(const semantic::ReductionContext& ctx, const char* what) {
+	if (Tensor::Shape(ctx.block).getNumElements() == 0 &&
+	    Tensor::Shape(ctx.out).getNumElements() > 0) {
+		throw std::runtime_error(std::string(what) + "() of an empty block");
+	}
+}
+
+Tensor Tensor::argmin(size_t dim) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("argmin() can not be recorded in a graph capture");
+	}
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	ensureNonEmptyBlocks(ctx, "argmin");
+	return Tensor(m_impl->argmin(ctx.lhs, ctx.block, ctx.out), m_backend);
+}
+
+Tensor Tensor::argmax(size_t dim) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("argmax() can not be recorded in a graph capture");
+	}
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	ensureNonEmptyBlocks(ctx, "argmax");
+	return Tensor(m_impl->argmax(ctx.lhs, ctx.block, ctx.out), m_backend);
+}
+
+std::pair<Tensor, Tensor> Tensor::topk(size_t k, size_t dim, bool largest) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("topk() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_impl.get(), "topk");
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	size_t blockCount = Tensor::Shape(ctx.block).getNumElements();
+	if (k > blockCount) {
+		throw std::runtime_error("topk() can not select " + std::to_string(k) +
+		                         " elements from blocks of " + std::to_string(blockCount));
+	}
+
+	std::vector<size_t> dims;
+	for (size_t d = 0; d < ctx.out.rank; d++) dims.push_back(ctx.out.shape[d]);
+	dims.push_back(k);
+
+	Tensor values(Tensor::Shape(dims), getDType(), m_backend);
+	Tensor indices(Tensor::Shape(dims), DType::Int64, m_backend);
+	m_impl->topk(ctx.lhs, ctx.block, k, largest, values.m_impl.get(), indices.m_impl.get());
+	return {std::piecewise_construct, std::forward_as_tuple(std::move(values.m_impl), m_backend),
+	        std::forward_as_tuple(std::move(indices.m_impl), m_backend)};
+}
+
+Tensor Tensor::sort(size_t dim, bool descending) const {
+	return Tensor::View(*this).sort(dim, descending);
+}
+
+Tensor Tensor::argsort(size_t dim, bool descending) const {
+	return Tensor::View(*this).argsort(dim, descending);
+}
+
+Tensor Tensor::partition(size_t kth, size_t dim) const {
+	return Tensor::View(*this).partition(kth, dim);
+}
+
+bool Tensor::all(Predicate predicate, const Tensor::View& rhs, float tolerance) const {
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhs);
+	return m_impl->reducePredicate(ctx.lhs, rhs.getParent().m_impl.get(), ctx.rhs, predicate,
+	                               tolerance, true, ctx.dtype);
+}
+
+bool Tensor::any(Predicate predicate, const Tensor::View& rhs, float tolerance) const {
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhs);
+	return m_impl->reducePredicate(ctx.lhs, rhs.getParent().m_impl.get(), ctx.rhs, predicate,
+	                               tolerance, false, ctx.dtype);
+}
+
+bool Tensor::allClose(const Tensor::View& rhs, float tolerance) const {
+	return all(Predicate::IsClose, rhs, tolerance);
+}
+
+Tensor Tensor::softmax(size_t dim) const { return Tensor::View(*this).softmax(dim); }
+
+Tensor Tensor::logSoftmax(size_t dim) const { return Tensor::View(*this).logSoftmax(dim); }
+
+Tensor Tensor::logSumExp(size_t dim) const { return Tensor::View(*this).logSumExp(dim); }
+
+Tensor Tensor::scan(ScanOp op, size_t dim, bool exclusive) const {
+	return Tensor::View(*this).scan(op, dim, exclusive);
+}
+
+Tensor Tensor::cumsum(size_t dim, bool exclusive) const {
+	return scan(ScanOp::Sum, dim, exclusive);
+}
+
+Tensor Tensor::cumprod(size_t dim, bool exclusive) const {
+	return scan(ScanOp::Prod, dim, exclusive);
+}
+
+Tensor Tensor::cummax(size_t dim, bool exclusive) const {
+	return scan(ScanOp::Max, dim, exclusive);
+}
+
+Tensor Tensor::cummin(size_t dim, bool exclusive) const {
+	return scan(ScanOp::Min, dim, exclusive);
+}
+
+Tensor Tensor::gather(size_t dim, const Tensor::View& index) const {
+	return Tensor::View(*this).gather(dim, index);
+}
+
+Tensor Tensor::indexSelect(size_t dim, const Tensor::View& index) const {
+	return Tensor::View(*this).indexSelect(dim, index);
+}
+
+void Tensor::scatter(size_t dim, const Tensor::View& index, const Tensor::View& src) {
+	Tensor::View(*this).scatter(dim, index, src);
+}
+
+void Tensor::scatterAdd(size_t dim, const Tensor::View& index, const Tensor::View& src) {
+	Tensor::View(*this).scatterAdd(dim, index, src);
+}
+
+Tensor Tensor::map(UnaryOp op, float alpha, float beta) const {
+	return Tensor::View(*this).map(op, alpha, beta);
+}
+
+void Tensor::mapInplace(UnaryOp op, float alpha, float beta) {
+	Tensor::View(*this).mapInplace(op, alpha, beta);
 }
 
-Tensor Tensor::all(size_t dim) const { return applyReduction(dim, &Tensor::Impl::all); }
+void Tensor::mapInto(const Tensor::View& out, UnaryOp op, float alpha, float beta) const {
+	Tensor::View(*this).mapInto(out, op, alpha, beta);
+}
+
+Tensor Tensor::exp() const { return map(UnaryOp::Exp); }
+
+Tensor Tensor::log() const { return map(UnaryOp::Log); }
+
+Tensor Tensor::sqrt() const { return map(UnaryOp::Sqrt); }
+
+Tensor Tensor::rsqrt() const { return map(UnaryOp::Rsqrt); }
+
+Tensor Tensor::abs() const { return map(UnaryOp::Abs); }
+
+Tensor Tensor::tanh() const { return map(UnaryOp::Tanh); }
+
+Tensor Tensor::sigmoid() const { return map(UnaryOp::Sigmoid); }
+
+Tensor Tensor::sin() const { return map(UnaryOp::Sin); }
 
-Tensor Tensor::any(size_t dim) const { return applyReduction(dim, &Tensor::Impl::any); }
+Tensor Tensor::cos() const { return map(UnaryOp::Cos); }
+
+Tensor Tensor::pow(float exponent) const { return map(UnaryOp::Pow, exponent); }
+
+Tensor Tensor::clamp(float low, float high) const { return map(UnaryOp::Clamp, low, high); }
 
 Tensor Tensor::matmul(const Tensor::View& rhs) const {
-	auto ctx = semantic::MatmulContext::build(*this, rhs);
+	auto ctx = semantic::MatmulContext::lookup(*this, rhs);
 
 	Tensor::Impl* rhsImpl = rhs.getParent().m_impl.get();
+	auto result = m_impl->matmul(ctx.lhs, rhsImpl, ctx.rhs, ctx.out, ctx.batch, ctx.m, ctx.k, ctx.p,
+	                             ctx.dtype);
+
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordMatmul(m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs, result.get(), ctx.out,
+		                       ctx.batch, ctx.m, ctx.k, ctx.p);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordMatmul(m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs, result.get(), ctx.out,
+		                   ctx.batch, ctx.m, ctx.k, ctx.p);
+	}
+
+	return Tensor(std::move(result), m_backend);
+}
+
+/// Throws unless `lhs` is Int8 or UInt8 and `rhs` Int8.
+static void ensureInt8Operands(const Tensor& lhs, const Tensor::View& rhs) {
+	DType lhsType = lhs.getDType();
+	if ((lhsType != DType::Int8 && lhsType != DType::UInt8) || rhs.getDType() != DType::Int8) {
+		throw std::runtime_error(std::string("matmulInt8: expected int8 or uint8 @ int8, got ") +
+		                         getDTypeName(lhsType) + " @ " + getDTypeName(rhs.getDType()));
+	}
+}
+
+/// Longest inner dim whose int32 dot products of packed bytes can not overflow, 255 * 128 * k
+/// must fit int32.
+static constexpr size_t MATMUL_INT8_MAX_INNER = 65793;
+
+/// Throws if the inner dim `k` of an int8 matmul is longer than `MATMUL_INT8_MAX_INNER`.
+static void ensureInt8InnerDim(size_t k) {
+	if (k > MATMUL_INT8_MAX_INNER) {
+		throw std::runtime_error("matmulInt8: inner dim " + std::to_string(k) +
+		                         " exceeds the largest exact one, " +
+		                         std::to_string(MATMUL_INT8_MAX_INNER));
+	}
+}
+
+/// Throws unless `dtype` is a quantized dtype, Int8 or UInt8.
+static void ensureQuantizedType(DType dtype, const char* what) {
+	if (dtype != DType::Int8 && dtype != DType::UInt8) {
+		throw std::runtime_error(std::string(what) + ": expected int8 or uint8, got " +
+		                         getDTypeName(dtype));
+	}
+}
+
+Tensor Tensor::matmulInt8(const Tensor::View& rhs, int32_t lhsZeroPoint,
+                          int32_t rhsZeroPoint) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("matmulInt8() can not be recorded in a graph capture");
+	}
+	ensureInt8Operands(*this, rhs);
+
+	auto ctx = semantic::MatmulContext::lookup(*this, rhs);
+	ensureInt8InnerDim(ctx.k);
+
+	Tensor::Impl* rhsImpl = rhs.getParent().m_impl.get();
+	auto result = m_impl->matmulInt8(ctx.lhs, rhsImpl, ctx.rhs, ctx.out, ctx.batch, ctx.m, ctx.k,
+	                                  ctx.p, lhsZeroPoint, rhsZeroPoint, nullptr);
+
+	return Tensor(std::move(result), m_backend);
+}
+
+Tensor Tensor::matmulInt8(const Tensor::View& rhs, int32_t lhsZeroPoint, int32_t rhsZeroPoint,
+                          const Tensor::View& multiplier, int32_t outZeroPoint,
+                          DType dtype) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("matmulInt8() can not be recorded in a graph capture");
+	}
+	ensureInt8Operands(*this, rhs);
+	ensureQuantizedType(dtype, "matmulInt8");
+
+	auto ctx = semantic::MatmulContext::lookup(*this, rhs);
+	ensureInt8InnerDim(ctx.k);
+
+	// the epilogue reads multipliers by output column, so they must be dense Float32
+	Tensor multipliers = multiplier.copy();
+	if (multipliers.getDType() != DType::Float32) {
+		multipliers = multipliers.asType(DType::Float32);
+	}
+	size_t count = multipliers.getNumElements();
+	if (count != 1 && count != ctx.p) {
+		throw std::runtime_error("matmulInt8: expected 1 or " + std::to_string(ctx.p) +
+		                         " multipliers, got " + std::to_string(count));
+	}
+
+	Tensor::Impl::Requantize requantize{multipliers.m_impl.get(), outZeroPoint, dtype};
+
+	Tensor::Impl* rhsImpl = rhs.getParent().m_impl.get();
+	auto result = m_impl->matmulInt8(ctx.lhs, rhsImpl, ctx.rhs, ctx.out, ctx.batch, ctx.m, ctx.k,
+	                                  ctx.p, lhsZeroPoint, rhsZeroPoint, &requantize);
+
+	return Tensor(std::move(result), m_backend);
+}
+
+Tensor Tensor::conv1d(const Tensor::View& weight, size_t stride, size_t padding,
+                      size_t dilation) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("conv1d() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_impl.get(), "conv1d");
+	autograd::Recorder::ensureUntracked(weight.getParent().m_impl.get(), "conv1d");
+
+	auto ctx = semantic::ConvContext::build(*this, weight, 1, stride, padding, dilation);
+
+	Tensor::Impl* weightImpl = weight.getParent().m_impl.get();
+	auto result =
+	    m_impl->conv(ctx.lhs, weightImpl, ctx.weight, ctx.out, ctx.geometry, ctx.dtype);
+	return Tensor(std::move(result), m_backend);
+}
+
+Tensor Tensor::conv2d(const Tensor::View& weight, size_t stride, size_t padding,
+                      size_t dilation) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("conv2d() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_impl.get(), "conv2d");
+	autograd::Recorder::ensureUntracked(weight.getParent().m_impl.get(), "conv2d");
+
+	auto ctx = semantic::ConvContext::build(*this, weight, 2, stride, padding, dilation);
+
+	Tensor::Impl* weightImpl = weight.getParent().m_impl.get();
 	auto result =
-	    m_impl->matmul(ctx.lhs, rhsImpl, ctx.rhs, ctx.out, ctx.batch, ctx.m, ctx.k, ctx.p);
+	    m_impl->conv(ctx.lhs, weightImpl, ctx.weight, ctx.out, ctx.geometry, ctx.dtype);
+	return Tensor(std::move(result), m_backend);
+}
+
+Tensor Tensor::quantize(const Tensor::View& scale, const Tensor::View& zeroPoint,
+                        DType dtype) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("quantize() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_impl.get(), "quantize");
+	ensureQuantizedType(dtype, "quantize");
+
+	auto scaleCtx = semantic::BinaryOpContext::lookup(*this, scale);
+	auto zeroPointCtx = semantic::BinaryOpContext::lookup(*this, zeroPoint);
+	if (Tensor::Shape(scaleCtx.out) != getShape() ||
+	    Tensor::Shape(zeroPointCtx.out) != getShape()) {
+		throw std::runtime_error("quantize: scale and zero point must broadcast to " +
+		                         getShape().toString());
+	}
+
+	auto result = m_impl->quantize(scaleCtx.lhs, scale.getParent().m_impl.get(), scaleCtx.rhs,
+	                               zeroPoint.getParent().m_impl.get(), zeroPointCtx.rhs,
+	                               scaleCtx.out, dtype);
+
+	return Tensor(std::move(result), m_backend);
+}
+
+Tensor Tensor::dequantize(const Tensor::View& scale, const Tensor::View& zeroPoint) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("dequantize() can not be recorded in a graph capture");
+	}
+
+	auto scaleCtx = semantic::BinaryOpContext::lookup(*this, scale);
+	auto zeroPointCtx = semantic::BinaryOpContext::lookup(*this, zeroPoint);
+	if (Tensor::Shape(scaleCtx.out) != getShape() ||
+	    Tensor::Shape(zeroPointCtx.out) != getShape()) {
+		throw std::runtime_error("dequantize: scale and zero point must broadcast to " +
+		                         getShape().toString());
+	}
+
+	auto result = m_impl->dequantize(scaleCtx.lhs, scale.getParent().m_impl.get(), scaleCtx.rhs,
+	                                 zeroPoint.getParent().m_impl.get(), zeroPointCtx.rhs,
+	                                 scaleCtx.out);
 
 	return Tensor(std::move(result), m_backend);
 }
 
+/// Contiguous host copy of `src` in `dtype`, which factorizations and solves run on.
+static Tensor hostCopy(const Tensor::View& src, DType dtype) {
+	Tensor result(src.getShape(), dtype, src.getBackend());
+	result.set({}, src);
+	result.to(Backend::CPU);
+	return result;
+}
+
+/// Throws unless the linear algebra op `what` can read `impl`.
+static void ensureLinalgOperand(const Tensor::Impl* impl, const char* what) {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error(std::string(what) + "() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(impl, what);
+}
+
+/// Shape of `shape` without its last dim.
+static Tensor::Shape dropLastDim(const Tensor::Shape& shape) {
+	std::vector<size_t> dims = shape.toVector();
+	dims.pop_back();
+	return Tensor::Shape(dims);
+}
+
+Tensor Tensor::cholesky() const {
+	ensureLinalgOperand(m_impl.get(), "cholesky");
+	auto ctx = semantic::LinalgContext::build(*this, "cholesky", true);
+
+	Tensor factor = hostCopy(*this, ctx.dtype);
+	if (!factor.m_impl->cholesky(ctx.batch, ctx.n)) {
+		throw std::runtime_error("cholesky(): matrix is not positive definite");
+	}
+
+	factor.to(m_backend);
+	return factor;
+}
+
+std::pair<Tensor, Tensor> Tensor::lu() const {
+	ensureLinalgOperand(m_impl.get(), "lu");
+	auto ctx = semantic::LinalgContext::build(*this, "lu", true);
+
+	Tensor factors = hostCopy(*this, ctx.dtype);
+	Tensor permutation(dropLastDim(getShape()), DType::Int64);
+	factors.m_impl->lu(ctx.batch, ctx.n, permutation.m_impl.get());
+
+	factors.to(m_backend);
+	permutation.to(m_backend);
+	return {std::piecewise_construct, std::forward_as_tuple(std::move(factors.m_impl), m_backend),
+	        std::forward_as_tuple(std::move(permutation.m_impl), m_backend)};
+}
+
+std::pair<Tensor, Tensor> Tensor::qr() const {
+	ensureLinalgOperand(m_impl.get(), "qr");
+	auto ctx = semantic::LinalgContext::build(*this, "qr", false);
+
+	std::vector<size_t> dims = getShape().toVector();
+	Tensor q(Tensor::Shape(dims), ctx.dtype);
+	dims[dims.size() - 2] = ctx.n;
+	Tensor r(Tensor::Shape(dims), ctx.dtype);
+
+	Tensor reflectors = hostCopy(*this, ctx.dtype);
+	reflectors.m_impl->qr(ctx.batch, ctx.m, ctx.n, q.m_impl.get(), r.m_impl.get());
+
+	q.to(m_backend);
+	r.to(m_backend);
+	return {std::piecewise_construct, std::forward_as_tuple(std::move(q.m_impl), m_backend),
+	        std::forward_as_tuple(std::move(r.m_impl), m_backend)};
+}
+
+Tensor Tensor::solveTriangular(const Tensor::View& rhs, bool lower, bool unitDiagonal) const {
+	ensureLinalgOperand(m_impl.get(), "solveTriangular");
+	ensureLinalgOperand(rhs.getParent().m_impl.get(), "solveTriangular");
+	auto ctx = semantic::LinalgContext::buildSolve(*this, rhs, "solveTriangular");
+
+	// the matrices are only read, so a host tensor of the right dtype is used as it is
+	std::optional<Tensor> staging;
+	const Tensor::Impl* matrices = m_impl.get();
+	if (m_backend != Backend::CPU || getDType() != ctx.dtype) {
+		staging.emplace(hostCopy(*this, ctx.dtype));
+		matrices = staging->m_impl.get();
+	}
+
+	Tensor solution = hostCopy(rhs, ctx.dtype);
+	if (!matrices->solveTriangular(ctx.batch, ctx.n, ctx.k, solution.m_impl.get(), lower,
+	                               unitDiagonal)) {
+		throw std::runtime_error("solveTriangular(): matrix is singular");
+	}
+
+	solution.to(m_backend);
+	return solution;
+}
+
+Tensor Tensor::solve(const Tensor::View& rhs) const {
+	ensureLinalgOperand(m_impl.get(), "solve");
+	ensureLinalgOperand(rhs.getParent().m_impl.get(), "solve");
+	auto ctx = semantic::LinalgContext::buildSolve(*this, rhs, "solve");
+
+	Tensor factors = hostCopy(*this, ctx.dtype);
+	Tensor permutation(dropLastDim(getShape()), DType::Int64);
+	factors.m_impl->lu(ctx.batch, ctx.n, permutation.m_impl.get());
+
+	// P A = L U, so A X = B is L U X = P B
+	Tensor permuted = hostCopy(rhs, ctx.dtype);
+	size_t rank = getShape().getNumDims();
+	Tensor solution =
+	    permuted.gather(rank - 2, permutation.unsqueeze(rank - 1).expand(permuted.getShape()));
+
+	factors.m_impl->solveTriangular(ctx.batch, ctx.n, ctx.k, solution.m_impl.get(), true, true);
+	if (!factors.m_impl->solveTriangular(ctx.batch, ctx.n, ctx.k, solution.m_impl.get(), false,
+	                                     false)) {
+		throw std::runtime_error("solve(): matrix is singular");
+	}
+
+	solution.to(m_backend);
+	return solution;
+}
+
 Tensor::View Tensor::operator[](size_t idx) const {
 	auto ctx = semantic::IndexContext::build(*this, idx);
 
@@ -257,8 +889,92 @@ Tensor::View Tensor::subsample(std::vector<size_t> strides) const {
 	return view.subsample(strides);
 }
 
+Tensor::View Tensor::reshape(const Tensor::Shape& shape) const {
+	return Tensor::View(*this).reshape(shape);
+}
+
+Tensor::View Tensor::permute(const std::vector<size_t>& dims) const {
+	return Tensor::View(*this).permute(dims);
+}
+
+Tensor::View Tensor::transpose(size_t dim0, size_t dim1) const {
+	return Tensor::View(*this).transpose(dim0, dim1);
+}
+
+Tensor::View Tensor::squeeze() const { return Tensor::View(*this).squeeze(); }
+
+Tensor::View Tensor::squeeze(size_t dim) const { return Tensor::View(*this).squeeze(dim); }
+
+template <typename Copies>
+void Tensor::applyCopies(const std::vector<Tensor::View>& tensors, const Copies& copies) {
+	std::vector<Tensor::Impl::SetCopy> sets;
+	sets.reserve(copies.size());
+
+	auto* tape = autograd::Recorder::active();
+	for (const auto& copy : copies) {
+		const Tensor& input = tensors[copy.input].getParent();
+		if (tape != nullptr) {
+			tape->recordInplace(graph::OpType::Set, m_impl.get(), copy.target,
+			                    input.m_impl.get(), copy.source);
+		}
+		sets.push_back({input.m_impl.get(), copy.source, copy.target});
+	}
+	m_impl->setAll(sets);
+}
+
+Tensor Tensor::concat(const std::vector<Tensor::View>& tensors, size_t dim) {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("concat() can not be recorded in a graph capture");
+	}
+
+	auto ctx = semantic::ConcatContext::build(tensors, dim);
+	Tensor result(Tensor::Shape(ctx.out), ctx.dtype, tensors[0].getBackend());
+	result.applyCopies(tensors, ctx.copies);
+	return result;
+}
+
+Tensor Tensor::stack(const std::vector<Tensor::View>& tensors, size_t dim) {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("stack() can not be recorded in a graph capture");
+	}
+
+	// each input is copied as if unsqueezed at `dim`, without building the unsqueezed views
+	auto ctx = semantic::ConcatContext::buildStack(tensors, dim);
+	Tensor result(Tensor::Shape(ctx.out), ctx.dtype, tensors[0].getBackend());
+	result.applyCopies(tensors, ctx.copies);
+	return result;
+}
+
+Tensor::View Tensor::slice(const std::vector<Slice>& ranges) const {
+	return Tensor::View(*this).slice(ranges);
+}
+
+Tensor::View Tensor::slice(size_t dim, const Slice& range) const {
+	return Tensor::View(*this).slice(dim, range);
+}
+
+Tensor::View Tensor::unfold(size_t dim, size_t size, size_t step) const {
+	return Tensor::View(*this).unfold(dim, size, step);
+}
+
+Tensor::View Tensor::unsqueeze(size_t dim) const { return Tensor::View(*this).unsqueeze(dim); }
+
+Tensor::View Tensor::expand(const Tensor::Shape& shape) const {
+	return Tensor::View(*this).expand(shape);
+}
+
 Tensor& Tensor::operator=(const Tensor& rhs) {
-	this->m_impl = rhs.m_impl->clone();
+	auto impl = rhs.m_impl->clone();
+
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordAssign(m_impl.get(), rhs.m_impl.get(), impl.get());
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordCopy(rhs.m_impl.get(), impl.get());
+		tape->release(m_impl);
+	}
+
+	this->m_impl = std::move(impl);
 	this->m_backend = rhs.m_backend;
 
 	return *this;
@@ -285,34 +1001,39 @@ bool Tensor::isNotEqual(const Tensor::View& rhs) const { return !compare(rhs); }
 
 
 Tensor Tensor::operator==(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::equal);
+	return applyBinaryOp(rhs, &Tensor::Impl::equal, graph::OpType::Equal);
 }
 
 Tensor Tensor::operator!=(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::notEqual);
+	return applyBinaryOp(rhs, &Tensor::Impl::notEqual, graph::OpType::NotEqual);
 }
 
 Tensor Tensor::operator<(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::less);
+	return applyBinaryOp(rhs, &Tensor::Impl::less, graph::OpType::Less);
 }
 
 Tensor Tensor::operator<=(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::lessEqual);
+	return applyBinaryOp(rhs, &Tensor::Impl::lessEqual, graph::OpType::LessEqual);
 }
 
 Tensor Tensor::operator>(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::greater);
+	return applyBinaryOp(rhs, &Tensor::Impl::greater, graph::OpType::Greater);
 }
 
 Tensor Tensor::operator>=(const Tensor::View& rhs) const {
-	return applyBinaryOp(rhs, &Tensor::Impl::greaterEqual);
+	return applyBinaryOp(rhs, &Tensor::Impl::greaterEqual, graph::OpType::GreaterEqual);
 }
 
 Tensor Tensor::isClose(const Tensor::View& rhs, float tolerance) const {
-	auto ctx = semantic::BinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhs);
 
 	Tensor::Impl* rhsImpl = rhs.getParent().m_impl.get();
-	auto result = m_impl->isClose(ctx.lhs, rhsImpl, ctx.rhs, ctx.out, tolerance);
+	auto result = m_impl->isClose(ctx.lhs, rhsImpl, ctx.rhs, ctx.out, tolerance, ctx.dtype);
+
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordBinary(graph::OpType::IsClose, m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs,
+		                       result.get(), ctx.out, tolerance);
+	}
 
 	return Tensor(std::move(result), m_backend);
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "nforge/core/tensor_graph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "autograd/recorder.h"
+#include "backend/cpu/tensor_impl_CPU.h"
+#include "graph/program.h"
+#include "graph/recorder.h"
+
+Tensor::Graph::Graph(std::vector<Tensor*> bindings, std::unique_ptr<graph::Program> program)
+    : m_bindings(std::move(bindings)),
+      m_bindingData(m_bindings.size(), nullptr),
+      m_program(std::move(program)) {}
+
+Tensor::Graph::Graph(Graph&& other) noexcept = default;
+
+Tensor::Graph& Tensor::Graph::operator=(Graph&& other) noexcept = default;
+
+Tensor::Graph::~Graph() = default;
+
+Tensor::Graph Tensor::Graph::capture(const std::vector<std::reference_wrapper<Tensor>>& bindings,
+                                     const std::function<void()>& body) {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("Graph capture can not be nested");
+	}
+	if (autograd::Recorder::active() != nullptr) {
+		throw std::runtime_error("Graph capture can not run while a tape is recording");
+	}
+
+	std::vector<Tensor*> tensors;
+	std::vector<const Tensor::Impl*> impls;
+	std::vector<std::vector<float>> snapshots;
+
+	for (Tensor& tensor : bindings) {
+		if (tensor.m_backend != Backend::CPU) {
+			throw std::runtime_error("Graph capture only supports CPU tensors");
+		}
+		if (std::find(tensors.begin(), tensors.end(), &tensor) != tensors.end()) {
+			throw std::runtime_error("Graph capture can not bind the same tensor twice");
+		}
+
+		tensors.push_back(&tensor);
+		impls.push_back(tensor.m_impl.get());
+		snapshots.push_back(tensor.toVector());
+	}
+
+	graph::Recorder recorder(impls);
+
+	auto restore = [&]() {
+		graph::Recorder::active() = nullptr;
+		for (size_t i = 0; i < tensors.size(); i++) {
+			tensors[i]->m_impl->copyFromHost(snapshots[i].data(), snapshots[i].size());
+		}
+	};
+
+	graph::Recorder::active() = &recorder;
+	try {
+		body();
+	} catch (...) {
+		restore();
+		throw;
+	}
+	restore();
+
+	auto program = std::make_unique<graph::Program>(recorder.finish());
+	return Tensor::Graph(std::move(tensors), std::move(program));
+}
+
+void Tensor::Graph::replay() {
+	for (size_t i = 0; i < m_bindings.size(); i++) {
+		auto* impl = dynamic_cast<Tensor::CPUImpl*>(m_bindings[i]->m_impl.get());
+
+		if (impl == nullptr) {
+			throw std::runtime_error("Graph replay requires bound tensors on the CPU");
+		}
+		if (impl->getNumElements() != m_program->values[i].numElements) {
+			throw std::runtime_error("Graph replay: bound tensor " + std::to_string(i) +
+			                         " changed its number of elements since capture");
+		}
+		if (impl->getDType() != DType::Float32) {
+			throw std::runtime_error("Graph replay: bound tensor " + std::to_string(i) +
+			                         " is no longer Float32");
+		}
+
+		m_bindingData[i] = impl->dataPtr();
+	}
+
+	// replayed kernels are opaque to a tape, so they may only touch untracked data
+	if (auto* tape = autograd::Recorder::active()) {
+		for (const Tensor* binding : m_bindings) {
+			autograd::Recorder::ensureUntracked(binding->m_impl.get(), "replay");
+		}
+		for (const Tensor* binding : m_bindings) tape->recordOpaqueWrite(binding->m_impl.get());
+	}
+
+	m_program->run(m_bindingData);
+}
+
+size_t Tensor::Graph::getNumNodes() const { return m_program->nodes.size(); }
+
+size_t Tensor::Graph::getNumSlots() const { return m_program->numSlots; }
+
+size_t Tensor::Graph::getArenaBytes() const { return m_program->arena.size() * sizeof(float); }
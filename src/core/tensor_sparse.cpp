@@ -0,0 +1,356 @@
+#include "nforge/core/tensor_sparse.h"
+
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "autograd/recorder.h"
+#include "backend/cpu/kernels_CPU.h"
+#include "backend/cpu/tensor_impl_CPU.h"
+#include "backend/dtype_dispatch.h"
+#include "graph/recorder.h"
+#include "profiling/op_scope.h"
+
+/// Elements of the CPU implementation `impl` as `T`.
+template <typename T>
+static T* cpuData(const Tensor::Impl* impl) {
+	return static_cast<const Tensor::CPUImpl*>(impl)->data<T>();
+}
+
+/// Throws unless `shape` is 2D with column indices that fit Int32, `what` names the caller.
+static void ensureMatrixShape(const Tensor::Shape& shape, const char* what) {
+	if (shape.getNumDims() != 2) {
+		throw std::runtime_error(std::string(what) + "(): expected a 2D shape, got " +
+		                         shape.toString());
+	}
+	if (shape.getDim(1) > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+		throw std::runtime_error(std::string(what) + "(): " + shape.toString() +
+		                         " has too many columns for Int32 column indices");
+	}
+}
+
+/// Dtype of an op on sparse values of `dtype` and the dense `rhs`, see `semantic::resultType`.
+static DType resultType(DType dtype, const Tensor::View& rhs) {
+	if (rhs.getShape().getNumDims() == 0 && canCast(rhs.getDType(), dtype)) {
+		return dtype;
+	}
+	return promoteTypes(dtype, rhs.getDType());
+}
+
+/// Copies `operand` into `staging` as a contiguous CPU tensor of `dtype`, unless it already is on
+/// the CPU with elements of `dtype`. Callers read `staging` if it holds a value, `operand` if not.
+static void stageOnHost(const Tensor::View& operand, DType dtype, std::optional<Tensor>& staging) {
+	if (operand.getBackend() == Backend::CPU && operand.getDType() == dtype) {
+		return;
+	}
+	staging.emplace(operand.getShape(), dtype, operand.getBackend());
+	staging->set({}, operand);
+	staging->to(Backend::CPU);
+}
+
+/// Contiguous CPU copy of `src` with elements of `dtype`.
+static Tensor hostCopy(const Tensor::View& src, DType dtype) {
+	Tensor result(src.getShape(), dtype, src.getBackend());
+	result.set({}, src);
+	result.to(Backend::CPU);
+	return result;
+}
+
+/// Throws std::out_of_range unless every one of the `count` indices is in [0, size).
+static void ensureInRange(const int64_t* index, size_t count, size_t size, const char* what) {
+	int64_t position = cpu::findIndexOutOfRange(index, TensorLayout(Tensor::Shape({count})), size);
+	if (position >= 0) {
+		throw std::out_of_range(std::string("fromCOO(): ") + what + " index " +
+		                        std::to_string(index[position]) + " is out of range for " +
+		                        std::to_string(size) + " " + what + "s");
+	}
+}
+
+Tensor::Sparse::Sparse(size_t rows, size_t cols, std::unique_ptr<Tensor::Impl> offsets,
+                       std::unique_ptr<Tensor::Impl> columns, std::unique_ptr<Tensor::Impl> values)
+    : m_rows(rows),
+      m_cols(cols),
+      m_offsets(std::make_unique<Tensor>(std::move(offsets))),
+      m_columns(std::make_unique<Tensor>(std::move(columns))),
+      m_values(std::make_unique<Tensor>(std::move(values))) {}
+
+Tensor::Sparse::Sparse(const Sparse& other)
+    : m_rows(other.m_rows),
+      m_cols(other.m_cols),
+      m_offsets(std::make_unique<Tensor>(*other.m_offsets)),
+      m_columns(std::make_unique<Tensor>(*other.m_columns)),
+      m_values(std::make_unique<Tensor>(*other.m_values)) {}
+
+Tensor::Sparse::Sparse(Sparse&& other) noexcept = default;
+
+Tensor::Sparse& Tensor::Sparse::operator=(const Sparse& other) {
+	if (this != &other) {
+		*this = Sparse(other);
+	}
+	return *this;
+}
+
+Tensor::Sparse& Tensor::Sparse::operator=(Sparse&& other) noexcept = default;
+
+Tensor::Sparse::~Sparse() = default;
+
+void Tensor::Sparse::ensureOperand(const Tensor::View& operand, const char* what) {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error(std::string(what) + "() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(operand.getParent().m_impl.get(), what);
+}
+
+Tensor::Sparse Tensor::Sparse::fromCOO(const Tensor::Shape& shape,
+                                       const Tensor::View& rowIndices,
+                                       const Tensor::View& colIndices,
+                                       const Tensor::View& values) {
+	for (const Tensor::View* operand : {&rowIndices, &colIndices, &values}) {
+		ensureOperand(*operand, "fromCOO");
+	}
+	ensureMatrixShape(shape, "fromCOO");
+	for (const Tensor::View* index : {&rowIndices, &colIndices}) {
+		if (!isIntegral(index->getDType())) {
+			throw std::runtime_error(std::string("fromCOO(): indices must have an integer ") +
+			                         "dtype, got " + getDTypeName(index->getDType()));
+		}
+	}
+	const Tensor::Shape& length = values.getShape();
+	if (length.getNumDims() != 1 || rowIndices.getShape() != length ||
+	    colIndices.getShape() != length) {
+		throw std::runtime_error("fromCOO(): expected 1D indices and values of one length, got " +
+		                         rowIndices.getShape().toString() + ", " +
+		                         colIndices.getShape().toString() + " and " + length.toString());
+	}
+	NFORGE_OP_SCOPE(SparseConvert, length.getNumElements());
+
+	size_t rows = shape.getDim(0), cols = shape.getDim(1);
+	size_t count = length.getNumElements();
+	DType dtype = values.getDType();
+
+	Tensor rowData = hostCopy(rowIndices, DType::Int64);
+	Tensor colData = hostCopy(colIndices, DType::Int64);
+	Tensor entries = hostCopy(values, dtype);
+	const int64_t* rowIndex = cpuData<int64_t>(rowData.m_impl.get());
+	const int64_t* colIndex = cpuData<int64_t>(colData.m_impl.get());
+	ensureInRange(rowIndex, count, rows, "row");
+	ensureInRange(colIndex, count, cols, "column");
+
+	Tensor offsets({rows + 1}, DType::Int64);
+	Tensor columns({count}, DType::Int32);
+	Tensor sorted({count}, dtype);
+	size_t stored = dispatchDType(dtype, [&](auto* tag) {
+		using T = std::remove_pointer_t<decltype(tag)>;
+		return cpu::sparseFromCOO(rowIndex, colIndex, cpuData<T>(entries.m_impl.get()), count,
+		                          rows, cpuData<int64_t>(offsets.m_impl.get()),
+		                          cpuData<int32_t>(columns.m_impl.get()),
+		                          cpuData<T>(sorted.m_impl.get()));
+	});
+
+	// duplicates were merged, keep only the stored elements
+	if (stored < count) {
+		Tensor storedColumns({stored}, DType::Int32);
+		Tensor storedValues({stored}, dtype);
+		storedColumns.set({}, columns.slice(0, {0, stored}));
+		storedValues.set({}, sorted.slice(0, {0, stored}));
+		return Sparse(rows, cols, std::move(offsets.m_impl), std::move(storedColumns.m_impl),
+		              std::move(storedValues.m_impl));
+	}
+	return Sparse(rows, cols, std::move(offsets.m_impl), std::move(columns.m_impl),
+	              std::move(sorted.m_impl));
+}
+
+Tensor::Sparse Tensor::Sparse::fromDense(const Tensor::View& dense) {
+	ensureOperand(dense, "fromDense");
+	ensureMatrixShape(dense.getShape(), "fromDense");
+	NFORGE_OP_SCOPE(SparseConvert, dense.getShape().getNumElements());
+
+	size_t rows = dense.getShape().getDim(0), cols = dense.getShape().getDim(1);
+	DType dtype = dense.getDType();
+
+	std::optional<Tensor> staging;
+	stageOnHost(dense, dtype, staging);
+	const Tensor::Impl* sourceImpl = (staging ? *staging : dense.getParent()).m_impl.get();
+	TensorLayout layout = staging ? TensorLayout(staging->getShape()) : dense.getLayout();
+
+	Tensor offsets({rows + 1}, DType::Int64);
+	int64_t* offsetData = cpuData<int64_t>(offsets.m_impl.get());
+	dispatchDType(dtype, [&](auto* tag) {
+		using T = std::remove_pointer_t<decltype(tag)>;
+		cpu::sparseRowOffsets(cpuData<T>(sourceImpl), layout, offsetData);
+	});
+
+	size_t stored = static_cast<size_t>(offsetData[rows]);
+	Tensor columns({stored}, DType::Int32);
+	Tensor values({stored}, dtype);
+	dispatchDType(dtype, [&](auto* tag) {
+		using T = std::remove_pointer_t<decltype(tag)>;
+		cpu::sparseFromDense(cpuData<T>(sourceImpl), layout, offsetData,
+		                     cpuData<int32_t>(columns.m_impl.get()),
+		                     cpuData<T>(values.m_impl.get()));
+	});
+
+	return Sparse(rows, cols, std::move(offsets.m_impl), std::move(columns.m_impl),
+	              std::move(values.m_impl));
+}
+
+Tensor Tensor::Sparse::toDense() const {
+	NFORGE_OP_SCOPE(SparseConvert, m_rows * m_cols);
+
+	Tensor result(getShape(), getDType());
+	dispatchDType(getDType(), [&](auto* tag) {
+		using T = std::remove_pointer_t<decltype(tag)>;
+		cpu::sparseAddTo(cpuData<int64_t>(m_offsets->m_impl.get()),
+		                 cpuData<int32_t>(m_columns->m_impl.get()),
+		                 cpuData<T>(m_values->m_impl.get()), cpuData<T>(result.m_impl.get()),
+		                 m_rows, m_cols, false);
+	});
+	return result;
+}
+
+std::tuple<Tensor, Tensor, Tensor> Tensor::Sparse::toCOO() const {
+	NFORGE_OP_SCOPE(SparseConvert, getNumNonzero());
+
+	Tensor rowIndices({getNumNonzero()}, DType::Int64);
+	Tensor colIndices({getNumNonzero()}, DType::Int64);
+	cpu::sparseToCOO(cpuData<int64_t>(m_offsets->m_impl.get()),
+	                 cpuData<int32_t>(m_columns->m_impl.get()), m_rows,
+	                 cpuData<int64_t>(rowIndices.m_impl.get()),
+	                 cpuData<int64_t>(colIndices.m_impl.get()));
+
+	return std::tuple<Tensor, Tensor, Tensor>(std::move(rowIndices.m_impl),
+	                                          std::move(colIndices.m_impl),
+	                                          m_values->m_impl->clone());
+}
+
+Tensor Tensor::Sparse::matmul(const Tensor::View& rhs) const {
+	ensureOperand(rhs, "Sparse::matmul");
+
+	const Tensor::Shape& rhsShape = rhs.getShape();
+	size_t rank = rhsShape.getNumDims();
+	if (rank < 1 || rank > 2 || rhsShape.getDim(0) != m_cols) {
+		throw std::runtime_error("Sparse::matmul(): can not multiply " + getShape().toString() +
+		                         " with " + rhsShape.toString());
+	}
+	size_t k = rank == 2 ? rhsShape.getDim(1) : 1;
+	NFORGE_OP_SCOPE(SparseMatmul, getNumNonzero() * k);
+
+	DType dtype = promoteTypes(getDType(), rhs.getDType());
+	std::optional<Tensor> values;
+	stageOnHost(*m_values, dtype, values);
+	const Tensor::Impl* valueImpl = (values ? *values : *m_values).m_impl.get();
+
+	std::optional<Tensor> staging;
+	stageOnHost(rhs, dtype, staging);
+	const Tensor::Impl* denseImpl = (staging ? *staging : rhs.getParent()).m_impl.get();
+	TensorLayout layout = staging ? TensorLayout(staging->getShape()) : rhs.getLayout();
+
+	// a vector is a matrix of one column
+	if (rank == 1) {
+		layout = TensorLayout({m_cols, 1}, {layout.strides[0], 0}, layout.offset);
+	}
+
+	Tensor result(rank == 2 ? Tensor::Shape({m_rows, k}) : Tensor::Shape({m_rows}), dtype);
+	dispatchDType(dtype, [&](auto* tag) {
+		using T = std::remove_pointer_t<decltype(tag)>;
+		cpu::sparseMatmul(cpuData<int64_t>(m_offsets->m_impl.get()),
+		                  cpuData<int32_t>(m_columns->m_impl.get()), cpuData<T>(valueImpl),
+		                  cpuData<T>(denseImpl), layout, cpuData<T>(result.m_impl.get()), m_rows,
+		                  k);
+	});
+
+	result.to(rhs.getBackend());
+	return result;
+}
+
+template <typename Op>
+Tensor::Sparse Tensor::Sparse::applyElementwise(const Tensor::View& rhs, DType dtype, Op op,
+                                                const char* what) const {
+	ensureOperand(rhs, what);
+	NFORGE_OP_SCOPE(SparseElementwise, getNumNonzero());
+
+	std::optional<Tensor> values;
+	stageOnHost(*m_values, dtype, values);
+	const Tensor::Impl* valueImpl = (values ? *values : *m_values).m_impl.get();
+
+	// broadcast after staging, so only the elements of rhs are copied
+	std::optional<Tensor> staging;
+	stageOnHost(rhs, dtype, staging);
+	Tensor::View dense = staging ? staging->expand(getShape()) : rhs.expand(getShape());
+	const Tensor::Impl* denseImpl = dense.getParent().m_impl.get();
+
+	Tensor result({getNumNonzero()}, dtype);
+	dispatchDType(dtype, [&](auto* tag) {
+		using T = std::remove_pointer_t<decltype(tag)>;
+		cpu::sparseElementwise(cpuData<int64_t>(m_offsets->m_impl.get()),
+		                       cpuData<int32_t>(m_columns->m_impl.get()), cpuData<T>(valueImpl),
+		                       cpuData<T>(denseImpl), dense.getLayout(),
+		                       cpuData<T>(result.m_impl.get()), m_rows, op);
+	});
+
+	return Sparse(m_rows, m_cols, m_offsets->m_impl->clone(), m_columns->m_impl->clone(),
+	              std::move(result.m_impl));
+}
+
+Tensor::Sparse Tensor::Sparse::operator*(const Tensor::View& rhs) const {
+	return applyElementwise(rhs, resultType(getDType(), rhs), cpu::Mul{}, "Sparse::operator*");
+}
+
+Tensor::Sparse Tensor::Sparse::operator/(const Tensor::View& rhs) const {
+	// division is true division, integer and Bool operands divide as Float32
+	DType dtype = resultType(getDType(), rhs);
+	if (!isFloatingPoint(dtype)) {
+		dtype = DType::Float32;
+	}
+	return applyElementwise(rhs, dtype, cpu::Div{}, "Sparse::operator/");
+}
+
+Tensor Tensor::Sparse::applyDense(const Tensor::View& rhs, bool subtract, const char* what) const {
+	ensureOperand(rhs, what);
+	NFORGE_OP_SCOPE(SparseElementwise, m_rows * m_cols);
+
+	DType dtype = resultType(getDType(), rhs);
+	std::optional<Tensor> values;
+	stageOnHost(*m_values, dtype, values);
+	const Tensor::Impl* valueImpl = (values ? *values : *m_values).m_impl.get();
+
+	// the broadcast rhs is copied into the result, the stored elements are added to it
+	std::optional<Tensor> staging;
+	stageOnHost(rhs, dtype, staging);
+	Tensor::View dense = staging ? staging->expand(getShape()) : rhs.expand(getShape());
+	Tensor result(getShape(), dtype);
+	result.set({}, dense);
+
+	dispatchDType(dtype, [&](auto* tag) {
+		using T = std::remove_pointer_t<decltype(tag)>;
+		cpu::sparseAddTo(cpuData<int64_t>(m_offsets->m_impl.get()),
+		                 cpuData<int32_t>(m_columns->m_impl.get()), cpuData<T>(valueImpl),
+		                 cpuData<T>(result.m_impl.get()), m_rows, m_cols, subtract);
+	});
+
+	result.to(rhs.getBackend());
+	return result;
+}
+
+Tensor Tensor::Sparse::operator+(const Tensor::View& rhs) const {
+	return applyDense(rhs, false, "Sparse::operator+");
+}
+
+Tensor Tensor::Sparse::operator-(const Tensor::View& rhs) const {
+	return applyDense(rhs, true, "Sparse::operator-");
+}
+
+Tensor::Shape Tensor::Sparse::getShape() const { return Tensor::Shape({m_rows, m_cols}); }
+
+DType Tensor::Sparse::getDType() const { return m_values->getDType(); }
+
+size_t Tensor::Sparse::getNumNonzero() const { return m_values->getNumElements(); }
+
+size_t Tensor::Sparse::getNumBytes() const {
+	size_t bytes = 0;
+	for (const Tensor* tensor : {m_offsets.get(), m_columns.get(), m_values.get()}) {
+		bytes += tensor->getNumElements() * getDTypeSize(tensor->getDType());
+	}
+	return bytes;
+}
@@ -0,0 +1,94 @@
+#include "nforge/core/tensor_tape.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "autograd/recorder.h"
+#include "backend/tensor_impl.h"
+#include "graph/recorder.h"
+
+Tensor::Tape::Tape(const std::vector<std::reference_wrapper<Tensor>>& params) {
+	if (autograd::Recorder::active() != nullptr) {
+		throw std::runtime_error("A tape is already recording on this thread");
+	}
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("A tape can not record during a graph capture");
+	}
+
+	std::vector<const Tensor::Impl*> impls;
+	for (const Tensor& param : params) {
+		if (!isFloatingPoint(param.getDType())) {
+			throw std::runtime_error(std::string("Tape parameters must be floating point, got ") +
+			                         getDTypeName(param.getDType()));
+		}
+		if (std::find(impls.begin(), impls.end(), param.m_impl.get()) != impls.end()) {
+			throw std::runtime_error("A tape can not take the same parameter twice");
+		}
+
+		impls.push_back(param.m_impl.get());
+		m_shapes.push_back(param.getShape());
+		m_backend = param.m_backend;
+	}
+
+	m_recorder = std::make_unique<autograd::Recorder>(impls, m_backend);
+	autograd::Recorder::active() = m_recorder.get();
+}
+
+Tensor::Tape::Tape(Tape&& other) noexcept = default;
+
+Tensor::Tape::~Tape() {
+	if (m_recorder != nullptr && autograd::Recorder::active() == m_recorder.get()) {
+		autograd::Recorder::active() = nullptr;
+	}
+}
+
+void Tensor::Tape::checkpoint(const std::vector<std::reference_wrapper<Tensor>>& state,
+                              const std::function<void()>& body) {
+	// inside a checkpoint the innermost segment records
+	autograd::Recorder* recorder = autograd::Recorder::active();
+	if (m_recorder == nullptr || recorder == nullptr) {
+		throw std::runtime_error("checkpoint() requires a recording tape");
+	}
+
+	std::vector<Tensor*> tensors;
+	for (Tensor& tensor : state) {
+		if (std::find(tensors.begin(), tensors.end(), &tensor) != tensors.end()) {
+			throw std::runtime_error("checkpoint() can not take the same tensor twice");
+		}
+		tensors.push_back(&tensor);
+	}
+
+	recorder->checkpoint(tensors, body);
+}
+
+std::vector<Tensor> Tensor::Tape::gradient(const Tensor& output) {
+	if (m_recorder == nullptr || autograd::Recorder::active() != m_recorder.get()) {
+		throw std::runtime_error("gradient() requires a recording tape, it runs only once");
+	}
+	autograd::Recorder::active() = nullptr;
+
+	Tensor seed(output.getShape(), 1.0f, output.m_backend);
+	std::vector<std::unique_ptr<Tensor::Impl>> seeds;
+	seeds.push_back(std::move(seed.m_impl));
+
+	auto grads = m_recorder->backward({output.m_impl.get()}, std::move(seeds));
+
+	std::vector<Tensor> result;
+	result.reserve(grads.size());
+	for (size_t i = 0; i < grads.size(); i++) {
+		if (grads[i] != nullptr) {
+			result.emplace_back(std::move(grads[i]), m_backend);
+		} else {
+			result.emplace_back(m_shapes[i], m_backend);
+		}
+	}
+	return result;
+}
+
+size_t Tensor::Tape::getNumNodes() const {
+	return m_recorder != nullptr ? m_recorder->getNumNodes() : 0;
+}
+
+size_t Tensor::Tape::getSavedBytes() const {
+	return m_recorder != nullptr ? m_recorder->getSavedBytes() : 0;
+}
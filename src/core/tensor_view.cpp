@@ -1,6 +1,8 @@
 #include "nforge/core/tensor_view.h"
 
+#include "autograd/recorder.h"
 #include "backend/tensor_impl.h"
+#include "graph/recorder.h"
 #include "ops/semantic/semantic.h"
 
 Tensor::View::View(Tensor& parent)
@@ -90,7 +92,14 @@ std::vector<size_t> Tensor::View::getStride() const {
 Tensor Tensor::View::copy() const {
 	auto shape = getShape();
 	auto backend = getParent().getBackend();
-	Tensor result(shape, backend);
+	Tensor result(shape, getDType(), backend);
+
+	// kernels walk one innermost row at a time, so a contiguous view is copied as a single row
+	if (isContiguous() && shape.getNumDims() > 1) {
+		Tensor::Shape flat({shape.getNumElements()});
+		Tensor::View(result).reshape(flat) = reshape(flat);
+		return result;
+	}
 
 	std::vector<size_t> position = {};
 	result.set(position, *this);
@@ -122,27 +131,63 @@ Tensor Tensor::View::operator/(const Tensor::View& rhs) const {
 }
 
 void Tensor::View::operator+=(const Tensor::View& rhs) {
-	auto ctx = semantic::InplaceBinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::InplaceBinaryOpContext::lookup(*this, rhs);
+
+	Tensor::Impl* rhsImpl = rhs.m_parent.m_impl.get();
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::IAdd, m_parent.m_impl.get(), ctx.lhs, rhsImpl,
+		                        ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::IAdd, m_parent.m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
 
-	m_parent.m_impl->iadd(ctx.lhs, rhs.m_parent.m_impl.get(), ctx.rhs);
+	m_parent.m_impl->iadd(ctx.lhs, rhsImpl, ctx.rhs);
 }
 
 void Tensor::View::operator-=(const Tensor::View& rhs) {
-	auto ctx = semantic::InplaceBinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::InplaceBinaryOpContext::lookup(*this, rhs);
+
+	Tensor::Impl* rhsImpl = rhs.m_parent.m_impl.get();
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::ISub, m_parent.m_impl.get(), ctx.lhs, rhsImpl,
+		                        ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::ISub, m_parent.m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
 
-	m_parent.m_impl->isub(ctx.lhs, rhs.m_parent.m_impl.get(), ctx.rhs);
+	m_parent.m_impl->isub(ctx.lhs, rhsImpl, ctx.rhs);
 }
 
 void Tensor::View::operator*=(const Tensor::View& rhs) {
-	auto ctx = semantic::InplaceBinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::InplaceBinaryOpContext::lookup(*this, rhs);
 
-	m_parent.m_impl->imul(ctx.lhs, rhs.m_parent.m_impl.get(), ctx.rhs);
+	Tensor::Impl* rhsImpl = rhs.m_parent.m_impl.get();
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::IMul, m_parent.m_impl.get(), ctx.lhs, rhsImpl,
+		                        ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::IMul, m_parent.m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
+
+	m_parent.m_impl->imul(ctx.lhs, rhsImpl, ctx.rhs);
 }
 
 void Tensor::View::operator/=(const Tensor::View& rhs) {
-	auto ctx = semantic::InplaceBinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::InplaceBinaryOpContext::lookup(*this, rhs);
+
+	Tensor::Impl* rhsImpl = rhs.m_parent.m_impl.get();
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::IDiv, m_parent.m_impl.get(), ctx.lhs, rhsImpl,
+		                        ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::IDiv, m_parent.m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
 
-	m_parent.m_impl->idiv(ctx.lhs, rhs.m_parent.m_impl.get(), ctx.rhs);
+	m_parent.m_impl->idiv(ctx.lhs, rhsImpl, ctx.rhs);
 }
 
 
@@ -171,30 +216,241 @@ Tensor Tensor::View::prod(size_t dim) const {
 	return current.prod(dim);
 }
 
-Tensor Tensor::View::norm() const {
+Tensor Tensor::View::norm(size_t dim) const {
 	Tensor current = this->copy();
-	return current.norm();
+	return current.norm(dim);
+}
+
+Tensor Tensor::View::softmax(size_t dim) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("softmax() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "softmax");
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	return Tensor(m_parent.m_impl->softmax(m_layout, ctx.block, false), m_parent.getBackend());
+}
+
+Tensor Tensor::View::logSoftmax(size_t dim) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("logSoftmax() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "logSoftmax");
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	return Tensor(m_parent.m_impl->softmax(m_layout, ctx.block, true), m_parent.getBackend());
+}
+
+Tensor Tensor::View::logSumExp(size_t dim) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("logSumExp() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "logSumExp");
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	auto result = m_parent.m_impl->logSumExp(m_layout, ctx.block, ctx.out);
+	return Tensor(std::move(result), m_parent.getBackend());
+}
+
+Tensor Tensor::View::sort(size_t dim, bool descending) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("sort() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "sort");
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	Tensor values(getShape(), getDType(), m_parent.getBackend());
+	m_parent.m_impl->sort(m_layout, ctx.block, descending, values.m_impl.get(), nullptr);
+	return values;
+}
+
+Tensor Tensor::View::argsort(size_t dim, bool descending) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("argsort() can not be recorded in a graph capture");
+	}
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	Tensor indices(getShape(), DType::Int64, m_parent.getBackend());
+	m_parent.m_impl->sort(m_layout, ctx.block, descending, nullptr, indices.m_impl.get());
+	return indices;
+}
+
+Tensor Tensor::View::partition(size_t kth, size_t dim) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("partition() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "partition");
+
+	auto ctx = semantic::ReductionContext::lookup(*this, dim);
+	size_t blockCount = Tensor::Shape(ctx.block).getNumElements();
+	if (kth >= blockCount && Tensor::Shape(ctx.out).getNumElements() > 0) {
+		throw std::runtime_error("partition() index " + std::to_string(kth) +
+		                         " is out of range for blocks of " + std::to_string(blockCount));
+	}
+
+	auto result = m_parent.m_impl->partition(m_layout, ctx.block, kth);
+	return Tensor(std::move(result), m_parent.getBackend());
+}
+
+Tensor Tensor::View::scan(ScanOp op, size_t dim, bool exclusive) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("scan() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "scan");
+
+	size_t rank = getShape().getNumDims();
+	if (dim >= rank) {
+		throw std::runtime_error("scan() dimension " + std::to_string(dim) +
+		                         " is out of range for rank " + std::to_string(rank));
+	}
+
+	auto result = m_parent.m_impl->scan(m_layout, dim, op, exclusive);
+	return Tensor(std::move(result), m_parent.getBackend());
+}
+
+Tensor Tensor::View::gather(size_t dim, const Tensor::View& index) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("gather() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "gather");
+
+	auto ctx = semantic::GatherContext::build(*this, dim, index);
+	auto result = m_parent.m_impl->gather(ctx.lhs, dim, index.m_parent.m_impl.get(), ctx.index);
+	return Tensor(std::move(result), m_parent.getBackend());
+}
+
+Tensor Tensor::View::indexSelect(size_t dim, const Tensor::View& index) const {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error("indexSelect() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "indexSelect");
+
+	auto ctx = semantic::GatherContext::buildSelect(*this, dim, index);
+	auto result = m_parent.m_impl->gather(ctx.lhs, dim, index.m_parent.m_impl.get(), ctx.index);
+	return Tensor(std::move(result), m_parent.getBackend());
+}
+
+void Tensor::View::scatter(size_t dim, const Tensor::View& index, const Tensor::View& src,
+                           bool accumulate, const char* what) {
+	if (graph::Recorder::active() != nullptr) {
+		throw std::runtime_error(std::string(what) + "() can not be recorded in a graph capture");
+	}
+	autograd::Recorder::ensureUntracked(src.m_parent.m_impl.get(), what);
+
+	auto ctx = semantic::GatherContext::build(*this, dim, index);
+	if (!canCast(src.getDType(), getDType())) {
+		throw std::runtime_error(std::string("Can not store a ") + getDTypeName(src.getDType()) +
+		                         " result in place into a " + getDTypeName(getDType()) +
+		                         " tensor");
+	}
+
+	// src is broadcast to the shape of the index
+	auto srcCtx = semantic::BinaryOpContext::lookup(index, src);
+	if (Tensor::Shape(srcCtx.out) != index.getShape()) {
+		throw std::runtime_error(std::string(what) + "() source of shape " +
+		                         src.getShape().toString() +
+		                         " does not broadcast to the index shape " +
+		                         index.getShape().toString());
+	}
+
+	autograd::Recorder::ensureUntrackedWrite(m_parent.m_impl.get(), what);
+	m_parent.m_impl->scatter(ctx.lhs, dim, index.m_parent.m_impl.get(), ctx.index,
+	                         src.m_parent.m_impl.get(), srcCtx.rhs, accumulate);
+}
+
+void Tensor::View::scatter(size_t dim, const Tensor::View& index, const Tensor::View& src) {
+	scatter(dim, index, src, false, "scatter");
+}
+
+void Tensor::View::scatterAdd(size_t dim, const Tensor::View& index, const Tensor::View& src) {
+	scatter(dim, index, src, true, "scatterAdd");
+}
+
+/// Dtype `op` computes in for `dtype`, see `Tensor::map`.
+static DType mapType(UnaryOp op, DType dtype) {
+	if (isFloatingPoint(dtype)) {
+		return dtype;
+	}
+	bool exact = op == UnaryOp::Abs || op == UnaryOp::Clamp;
+	return exact && isIntegral(dtype) ? dtype : DType::Float32;
+}
+
+Tensor Tensor::View::map(UnaryOp op, float alpha, float beta) const {
+	DType dtype = mapType(op, getDType());
+	auto result = m_parent.m_impl->map(m_layout, op, alpha, beta, dtype);
+
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordMap(op, alpha, beta, m_parent.m_impl.get(), m_layout, result.get(),
+		                    TensorLayout(result->getShape()));
+	}
+
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordMap(op, alpha, beta, m_parent.m_impl.get(), m_layout, result.get());
+	}
+
+	return Tensor(std::move(result), m_parent.getBackend());
+}
+
+void Tensor::View::mapInplace(UnaryOp op, float alpha, float beta) {
+	mapInto(*this, op, alpha, beta);
+}
+
+void Tensor::View::mapInto(const Tensor::View& out, UnaryOp op, float alpha, float beta) const {
+	autograd::Recorder::ensureUntracked(m_parent.m_impl.get(), "mapInto");
+
+	DType dtype = mapType(op, getDType());
+	if (!canCast(dtype, out.getDType())) {
+		throw std::runtime_error(std::string("Can not store a ") + getDTypeName(dtype) +
+		                         " result in place into a " + getDTypeName(out.getDType()) +
+		                         " tensor");
+	}
+
+	auto ctx = semantic::InplaceBinaryOpContext::lookup(out, *this);
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordMapInto(op, alpha, beta, out.m_parent.m_impl.get(), ctx.lhs,
+		                        m_parent.m_impl.get(), ctx.rhs);
+	}
+	autograd::Recorder::ensureUntrackedWrite(out.m_parent.m_impl.get(), "mapInto");
+	out.m_parent.m_impl->mapInto(ctx.lhs, m_parent.m_impl.get(), ctx.rhs, op, alpha, beta, dtype);
 }
 
 Tensor::View Tensor::View::operator=(const Tensor& rhs) {
 	Tensor::View rhsView(rhs);
 
-	auto ctx = semantic::BinaryOpContext::build(*this, rhsView);
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhsView);
 	if (Tensor::Shape(ctx.out) != getShape()) {
 		throw std::invalid_argument("set(): rhs shape does not broadcast to target shape");
 	}
 
-	m_parent.m_impl->set(ctx.lhs, rhs.m_impl.get(), ctx.rhs);
+	Tensor::Impl* rhsImpl = rhs.m_impl.get();
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::Set, m_parent.m_impl.get(), ctx.lhs, rhsImpl,
+		                        ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::Set, m_parent.m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
+
+	m_parent.m_impl->set(ctx.lhs, rhsImpl, ctx.rhs);
 	return *this;
 }
 
 Tensor::View Tensor::View::operator=(const Tensor::View& rhs) {
-	auto ctx = semantic::BinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhs);
 	if (Tensor::Shape(ctx.out) != getShape()) {
 		throw std::invalid_argument("set(): rhs shape does not broadcast to target shape");
 	}
 
-	m_parent.m_impl->set(ctx.lhs, rhs.m_parent.m_impl.get(), ctx.rhs);
+	Tensor::Impl* rhsImpl = rhs.m_parent.m_impl.get();
+	if (auto* recorder = graph::Recorder::active()) {
+		recorder->recordInplace(graph::OpType::Set, m_parent.m_impl.get(), ctx.lhs, rhsImpl,
+		                        ctx.rhs);
+	}
+	if (auto* tape = autograd::Recorder::active()) {
+		tape->recordInplace(graph::OpType::Set, m_parent.m_impl.get(), ctx.lhs, rhsImpl, ctx.rhs);
+	}
+
+	m_parent.m_impl->set(ctx.lhs, rhsImpl, ctx.rhs);
 	return *this;
 }
 
@@ -267,18 +523,109 @@ Tensor::View Tensor::View::subsample(std::vector<size_t> strides) const {
 	return Tensor::View::subsample(*this, strides);
 }
 
+Tensor::View Tensor::View::reshape(const Tensor::Shape& shape) const {
+	auto ctx = semantic::ViewContext::buildReshape(*this, shape);
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+Tensor::View Tensor::View::permute(const std::vector<size_t>& dims) const {
+	auto ctx = semantic::ViewContext::buildPermute(*this, dims);
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+Tensor::View Tensor::View::transpose(size_t dim0, size_t dim1) const {
+	std::vector<size_t> dims(m_layout.rank);
+	for (size_t d = 0; d < dims.size(); d++) dims[d] = d;
+
+	if (dim0 >= dims.size() || dim1 >= dims.size()) {
+		throw std::runtime_error("transpose: dims " + std::to_string(dim0) + " and " +
+		                         std::to_string(dim1) + " are not both dims of shape " +
+		                         getShape().toString());
+	}
+	std::swap(dims[dim0], dims[dim1]);
+
+	return permute(dims);
+}
+
+Tensor::View Tensor::View::squeeze() const {
+	std::vector<size_t> dims;
+	for (size_t d = 0; d < m_layout.rank; d++) {
+		if (m_layout.shape[d] == 1) {
+			dims.push_back(d);
+		}
+	}
+
+	auto ctx = semantic::ViewContext::buildSqueeze(*this, dims);
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+Tensor::View Tensor::View::squeeze(size_t dim) const {
+	auto ctx = semantic::ViewContext::buildSqueeze(*this, {dim});
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+Tensor::View Tensor::View::slice(const std::vector<Slice>& ranges) const {
+	auto ctx = semantic::ViewContext::buildSlice(*this, ranges);
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+Tensor::View Tensor::View::slice(size_t dim, const Slice& range) const {
+	if (dim >= m_layout.rank) {
+		throw std::runtime_error("slice: dim " + std::to_string(dim) + " is not a dim of shape " +
+		                         getShape().toString());
+	}
+
+	std::vector<Slice> ranges(dim + 1);
+	ranges[dim] = range;
+	return slice(ranges);
+}
+
+Tensor::View Tensor::View::unfold(size_t dim, size_t size, size_t step) const {
+	auto ctx = semantic::ViewContext::buildUnfold(*this, dim, size, step);
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+Tensor::View Tensor::View::unsqueeze(size_t dim) const {
+	auto ctx = semantic::ViewContext::buildUnsqueeze(*this, dim);
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+Tensor::View Tensor::View::expand(const Tensor::Shape& shape) const {
+	auto ctx = semantic::ViewContext::buildExpand(*this, shape);
+	return Tensor::View(m_parent, m_position, ctx.out);
+}
+
+bool Tensor::View::isContiguous() const {
+	size_t expected = 1;
+	for (size_t d = m_layout.rank; d-- > 0;) {
+		if (m_layout.shape[d] == 1) {
+			continue;
+		}
+		if (m_layout.shape[d] == 0) {
+			return true;
+		}
+		if (m_layout.strides[d] != expected) {
+			return false;
+		}
+		expected *= m_layout.shape[d];
+	}
+	return true;
+}
+
+Tensor Tensor::View::contiguous() const { return copy(); }
+
 bool Tensor::View::isEqual(const Tensor& rhs) const {
 	Tensor::View rhsView(rhs);
 	if (getShape() != rhsView.getShape())
 		return false;
-	auto ctx = semantic::BinaryOpContext::build(*this, rhsView);
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhsView);
 	return m_parent.m_impl->compare(ctx.lhs, rhs.m_impl.get(), ctx.rhs);
 }
 
 bool Tensor::View::isEqual(const Tensor::View& rhs) const {
 	if (getShape() != rhs.getShape())
 		return false;
-	auto ctx = semantic::BinaryOpContext::build(*this, rhs);
+	auto ctx = semantic::BinaryOpContext::lookup(*this, rhs);
 	return m_parent.m_impl->compare(ctx.lhs, rhs.m_parent.m_impl.get(), ctx.rhs);
 }
 
@@ -0,0 +1,285 @@
+#include "graph/program.h"
+
+#include <algorithm>
+
+#include "backend/cpu/kernels_CPU.h"
+
+namespace graph {
+
+static bool readsOutput(OpType type) {
+	switch (type) {
+		case OpType::IAdd:
+		case OpType::ISub:
+		case OpType::IMul:
+		case OpType::IDiv:
+		case OpType::Set:
+		case OpType::MaskedFill:
+		case OpType::MapInto:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/// Runs `cpu::unary` with the function of a Map or MapInto `node`, as `Tensor::map` does.
+static void applyMap(const Node& node, const float* in, const TensorLayout& inLayout, float* out,
+                     const TensorLayout& outLayout) {
+	auto run = [&](auto functor) { cpu::unary(in, inLayout, out, outLayout, functor); };
+
+	switch (node.unary) {
+		case UnaryOp::Exp:
+			run(cpu::Exp{});
+			break;
+		case UnaryOp::Log:
+			run(cpu::Log{});
+			break;
+		case UnaryOp::Sqrt:
+			run(cpu::Sqrt{});
+			break;
+		case UnaryOp::Rsqrt:
+			run(cpu::Rsqrt{});
+			break;
+		case UnaryOp::Abs:
+			run(cpu::Abs{});
+			break;
+		case UnaryOp::Tanh:
+			run(cpu::Tanh{});
+			break;
+		case UnaryOp::Sigmoid:
+			run(cpu::Sigmoid{});
+			break;
+		case UnaryOp::Sin:
+			run(cpu::Sin{});
+			break;
+		case UnaryOp::Cos:
+			run(cpu::Cos{});
+			break;
+		case UnaryOp::Pow:
+			if (node.param == 2.0f) {
+				run(cpu::Square{});
+			} else {
+				run(cpu::Pow{node.param});
+			}
+			break;
+		case UnaryOp::Clamp:
+			run(cpu::Clamp{node.param, node.param2});
+			break;
+	}
+}
+
+void Program::plan() {
+	// Dead node elimination. A node is live if it writes a bound tensor, or writes a value that a
+	// later live node reads.
+	std::vector<bool> needed(values.size(), false);
+	std::vector<Node> live;
+
+	for (size_t i = nodes.size(); i-- > 0;) {
+		const Node& node = nodes[i];
+
+		bool writesBinding = values[node.out].kind == ValueKind::Binding;
+		if (!writesBinding && !needed[node.out]) {
+			continue;
+		}
+
+		// a full write defines the value, so earlier writers are only needed by earlier readers
+		needed[node.out] = readsOutput(node.type);
+		if (node.lhs != NO_VALUE)
+			needed[node.lhs] = true;
+		if (node.rhs != NO_VALUE)
+			needed[node.rhs] = true;
+
+		live.push_back(node);
+	}
+
+	std::reverse(live.begin(), live.end());
+	nodes = std::move(live);
+
+	// Liveness interval [first, last] of every slot value, in node indices.
+	std::vector<size_t> first(values.size(), NO_VALUE);
+	std::vector<size_t> last(values.size(), 0);
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		for (size_t id : {nodes[i].out, nodes[i].lhs, nodes[i].rhs}) {
+			if (id == NO_VALUE || values[id].kind != ValueKind::Slot)
+				continue;
+
+			if (first[id] == NO_VALUE)
+				first[id] = i;
+			last[id] = i;
+		}
+	}
+
+	std::vector<std::vector<size_t>> starts(nodes.size()), ends(nodes.size());
+	for (size_t id = 0; id < values.size(); id++) {
+		if (first[id] != NO_VALUE) {
+			starts[first[id]].push_back(id);
+			ends[last[id]].push_back(id);
+		}
+	}
+
+	// Greedy region assignment. Regions are released after the node that last uses them, so an
+	// output never shares a region with an input of the same node.
+	struct Region {
+		size_t offset;
+		size_t size;
+	};
+	std::vector<Region> regions;
+	std::vector<size_t> freeRegions;
+	std::vector<size_t> regionOf(values.size(), NO_VALUE);
+	size_t arenaSize = 0;
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		for (size_t id : starts[i]) {
+			size_t need = values[id].numElements;
+
+			// best fit among the free regions
+			auto best = freeRegions.end();
+			for (auto it = freeRegions.begin(); it != freeRegions.end(); it++) {
+				if (regions[*it].size >= need &&
+				    (best == freeRegions.end() || regions[*it].size < regions[*best].size)) {
+					best = it;
+				}
+			}
+
+			size_t region;
+			if (best != freeRegions.end()) {
+				region = *best;
+				freeRegions.erase(best);
+			} else {
+				region = regions.size();
+				regions.push_back({arenaSize, need});
+				arenaSize += need;
+			}
+
+			regionOf[id] = region;
+			values[id].index = regions[region].offset;
+		}
+
+		for (size_t id : ends[i]) {
+			freeRegions.push_back(regionOf[id]);
+		}
+	}
+
+	arena.assign(arenaSize, 0.0f);
+	numSlots = regions.size();
+}
+
+void Program::run(const std::vector<float*>& bindings) {
+	auto data = [&](size_t id) -> float* {
+		const Value& value = values[id];
+		switch (value.kind) {
+			case ValueKind::Binding:
+				return bindings[value.index];
+			case ValueKind::Constant:
+				return constants[value.index].data();
+			case ValueKind::Slot:
+			default:
+				return arena.data() + value.index;
+		}
+	};
+
+	for (const Node& node : nodes) {
+		float* out = data(node.out);
+		const float* lhs = node.lhs != NO_VALUE ? data(node.lhs) : nullptr;
+		const float* rhs = node.rhs != NO_VALUE ? data(node.rhs) : nullptr;
+
+		const TensorLayout& oL = node.outLayout;
+		const TensorLayout& lL = node.lhsLayout;
+		const TensorLayout& rL = node.rhsLayout;
+		const TensorLayout& bL = node.blockLayout;
+
+		switch (node.type) {
+			case OpType::Add:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::Add{});
+				break;
+			case OpType::Sub:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::Sub{});
+				break;
+			case OpType::Mul:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::Mul{});
+				break;
+			case OpType::Div:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::Div{});
+				break;
+			case OpType::Equal:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::Equal{});
+				break;
+			case OpType::NotEqual:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::NotEqual{});
+				break;
+			case OpType::Less:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::Less{});
+				break;
+			case OpType::LessEqual:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::LessEqual{});
+				break;
+			case OpType::Greater:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::Greater{});
+				break;
+			case OpType::GreaterEqual:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::GreaterEqual{});
+				break;
+			case OpType::IsClose:
+				cpu::binary(lhs, lL, rhs, rL, out, oL, cpu::IsClose{node.param});
+				break;
+
+			case OpType::IAdd:
+				cpu::inplaceBinary(out, oL, rhs, rL, cpu::Add{});
+				break;
+			case OpType::ISub:
+				cpu::inplaceBinary(out, oL, rhs, rL, cpu::Sub{});
+				break;
+			case OpType::IMul:
+				cpu::inplaceBinary(out, oL, rhs, rL, cpu::Mul{});
+				break;
+			case OpType::IDiv:
+				cpu::inplaceBinary(out, oL, rhs, rL, cpu::Div{});
+				break;
+			case OpType::Set:
+				cpu::inplaceBinary(out, oL, rhs, rL, cpu::Assign{});
+				break;
+			case OpType::MaskedFill:
+				cpu::inplaceBinary(out, oL, rhs, rL, cpu::MaskedFill{node.param});
+				break;
+
+			case OpType::Sum:
+				cpu::reduce(lhs, lL, bL, out, oL, cpu::Add{});
+				break;
+			case OpType::Min:
+				cpu::reduce(lhs, lL, bL, out, oL, cpu::Min{});
+				break;
+			case OpType::Max:
+				cpu::reduce(lhs, lL, bL, out, oL, cpu::Max{});
+				break;
+			case OpType::Prod:
+				cpu::reduce(lhs, lL, bL, out, oL, cpu::Mul{});
+				break;
+			case OpType::All:
+				cpu::reduce(lhs, lL, bL, out, oL, cpu::LogicalAnd{}, cpu::NonZero{});
+				break;
+			case OpType::Any:
+				cpu::reduce(lhs, lL, bL, out, oL, cpu::LogicalOr{}, cpu::NonZero{});
+				break;
+			case OpType::Norm:
+				cpu::norm(lhs, lL, bL, out, oL);
+				break;
+
+			case OpType::Matmul:
+				cpu::matmul(lhs, lL, rhs, rL, out, oL, node.batch, node.m, node.k, node.p);
+				break;
+
+			case OpType::Map:
+				applyMap(node, lhs, lL, out, oL);
+				break;
+			case OpType::MapInto:
+				applyMap(node, rhs, rL, out, oL);
+				break;
+
+			case OpType::Copy:
+				std::copy(lhs, lhs + values[node.out].numElements, out);
+				break;
+		}
+	}
+}
+
+}  // namespace graph
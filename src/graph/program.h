@@ -0,0 +1,125 @@
+#ifndef GRAPH_PROGRAM_H
+#define GRAPH_PROGRAM_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "nforge/core/tensor.h"
+#include "nforge/core/tensor_layout.h"
+
+namespace graph {
+
+/// Operations a captured graph can replay.
+enum class OpType : uint8_t {
+	// out = lhs op rhs
+	Add,
+	Sub,
+	Mul,
+	Div,
+	Equal,
+	NotEqual,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual,
+	IsClose,
+
+	// out = out op rhs
+	IAdd,
+	ISub,
+	IMul,
+	IDiv,
+	Set,
+	MaskedFill,
+
+	// out = reduce(lhs)
+	Sum,
+	Min,
+	Max,
+	Prod,
+	All,
+	Any,
+	Norm,
+
+	// out = lhs @ rhs
+	Matmul,
+
+	// out = f(lhs), see `Tensor::map`
+	Map,
+	// out = f(rhs), in place
+	MapInto,
+
+	// out = lhs, both contiguous with the same element count
+	Copy,
+};
+
+/// Where the data of a value lives during replay.
+enum class ValueKind : uint8_t {
+	/// Storage of a bound tensor, resolved at the start of every replay.
+	Binding,
+	/// Data snapshotted during capture, owned by the program.
+	Constant,
+	/// Intermediate, assigned to a region of the arena by `Program::plan`.
+	Slot,
+};
+
+/// A buffer read or written by nodes.
+struct Value {
+	ValueKind kind;
+	/// Binding index, constant index, or arena offset (after planning).
+	size_t index;
+	size_t numElements;
+};
+
+constexpr size_t NO_VALUE = std::numeric_limits<size_t>::max();
+
+/// One recorded operation. Value ids index into `Program::values`.
+struct Node {
+	OpType type;
+	size_t out = NO_VALUE;
+	size_t lhs = NO_VALUE;
+	size_t rhs = NO_VALUE;
+
+	TensorLayout outLayout;
+	TensorLayout lhsLayout;
+	TensorLayout rhsLayout;
+	TensorLayout blockLayout;
+
+	size_t batch = 0;
+	size_t m = 0;
+	size_t k = 0;
+	size_t p = 0;
+
+	/// Op specific scalar, e.g. the `isClose` tolerance or the `maskedFill` value.
+	float param = 0.0f;
+
+	/// Function of Map and MapInto nodes, `param` and `param2` are its alpha and beta.
+	UnaryOp unary = UnaryOp::Exp;
+	float param2 = 0.0f;
+};
+
+/// A recorded operation sequence plus the memory plan used to replay it.
+///
+/// `plan` removes nodes whose results are never observed, then runs a liveness analysis over the
+/// remaining nodes and assigns every `Slot` value to a region of a single arena. Values whose
+/// lifetimes do not overlap share a region.
+struct Program {
+	std::vector<Value> values;
+	std::vector<Node> nodes;
+	std::vector<std::vector<float>> constants;
+	size_t numBindings = 0;
+
+	std::vector<float> arena;
+	size_t numSlots = 0;
+
+	/// Dead node elimination and slot assignment. Call once after recording.
+	void plan();
+
+	/// Executes every node. `bindings[i]` is the storage of bound tensor `i`.
+	void run(const std::vector<float*>& bindings);
+};
+
+}  // namespace graph
+
+#endif  // GRAPH_PROGRAM_H
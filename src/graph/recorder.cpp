@@ -0,0 +1,302 @@
+#include "graph/recorder.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "backend/cpu/tensor_impl_CPU.h"
+
+namespace graph {
+
+static const Tensor::CPUImpl* asCPU(const Tensor::Impl* impl) {
+	const auto* cpuImpl = dynamic_cast<const Tensor::CPUImpl*>(impl);
+	if (cpuImpl == nullptr) {
+		throw std::runtime_error("Graph capture only supports CPU tensors");
+	}
+	return cpuImpl;
+}
+
+/// Throws unless `impl` holds float data, values written by the program are float.
+static void requireFloat32(const Tensor::Impl* impl, const char* what) {
+	if (asCPU(impl)->getDType() != DType::Float32) {
+		throw std::runtime_error(std::string("Graph capture only supports Float32 ") + what);
+	}
+}
+
+/// Throws unless `impl` holds data the program can represent as float without changing results.
+static void requireFloatValues(const Tensor::Impl* impl) {
+	DType dtype = asCPU(impl)->getDType();
+	if (dtype != DType::Float32 && dtype != DType::Bool) {
+		throw std::runtime_error(std::string("Graph capture only supports Float32 and Bool "
+		                                     "results, got ") +
+		                         getDTypeName(dtype));
+	}
+}
+
+/// True if `layout` is contiguous from offset 0 and covers all `numElements`.
+static bool coversAll(const TensorLayout& layout, size_t numElements) {
+	if (layout.offset != 0 || cpu::getNumElements(layout) != numElements) {
+		return false;
+	}
+
+	size_t expected = 1;
+	for (size_t d = layout.rank; d-- > 0;) {
+		if (layout.shape[d] != 1 && layout.strides[d] != expected) {
+			return false;
+		}
+		expected *= layout.shape[d];
+	}
+	return true;
+}
+
+Recorder::Recorder(const std::vector<const Tensor::Impl*>& bindings) {
+	for (size_t i = 0; i < bindings.size(); i++) {
+		requireFloat32(bindings[i], "bound tensors");
+		size_t id = addValue(ValueKind::Binding, i, asCPU(bindings[i])->getNumElements());
+		m_valueOf[bindings[i]] = id;
+	}
+	m_program.numBindings = bindings.size();
+}
+
+void Recorder::recordBinary(OpType type, const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+                            const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+                            const Tensor::Impl* out, const TensorLayout& outLayout, float param) {
+	if (isConstant(lhs) && isConstant(rhs)) {
+		return;
+	}
+
+	Node node;
+	node.type = type;
+	node.lhs = read(lhs);
+	node.rhs = read(rhs);
+	node.out = define(out);
+	node.lhsLayout = lhsLayout;
+	node.rhsLayout = rhsLayout;
+	node.outLayout = outLayout;
+	node.param = param;
+
+	m_program.nodes.push_back(node);
+}
+
+void Recorder::recordInplace(OpType type, const Tensor::Impl* target,
+                             const TensorLayout& targetLayout, const Tensor::Impl* rhs,
+                             const TensorLayout& rhsLayout, float param) {
+	if (isConstant(target) && isConstant(rhs)) {
+		// folded, the target is snapshotted again on its next read
+		m_valueOf.erase(target);
+		return;
+	}
+
+	requireFloat32(target, "in-place targets");
+
+	bool overwritten =
+	    type == OpType::Set && coversAll(targetLayout, target->getNumElements());
+
+	Node node;
+	node.type = type;
+	node.rhs = read(rhs);
+	node.out = write(target, overwritten);
+	node.outLayout = targetLayout;
+	node.rhsLayout = rhsLayout;
+	node.param = param;
+
+	m_program.nodes.push_back(node);
+}
+
+void Recorder::recordReduction(OpType type, const Tensor::Impl* in, const TensorLayout& layout,
+                               const TensorLayout& blockLayout, const Tensor::Impl* out,
+                               const TensorLayout& outLayout) {
+	if (isConstant(in)) {
+		return;
+	}
+
+	Node node;
+	node.type = type;
+	node.lhs = read(in);
+	node.out = define(out);
+	node.lhsLayout = layout;
+	node.blockLayout = blockLayout;
+	node.outLayout = outLayout;
+
+	m_program.nodes.push_back(node);
+}
+
+void Recorder::recordMap(UnaryOp op, float alpha, float beta, const Tensor::Impl* in,
+                         const TensorLayout& inLayout, const Tensor::Impl* out,
+                         const TensorLayout& outLayout) {
+	if (isConstant(in)) {
+		return;
+	}
+
+	Node node;
+	node.type = OpType::Map;
+	node.lhs = read(in);
+	node.out = define(out);
+	node.lhsLayout = inLayout;
+	node.outLayout = outLayout;
+	node.unary = op;
+	node.param = alpha;
+	node.param2 = beta;
+
+	m_program.nodes.push_back(node);
+}
+
+void Recorder::recordMapInto(UnaryOp op, float alpha, float beta, const Tensor::Impl* target,
+                             const TensorLayout& targetLayout, const Tensor::Impl* in,
+                             const TensorLayout& inLayout) {
+	if (isConstant(target) && isConstant(in)) {
+		m_valueOf.erase(target);
+		return;
+	}
+
+	requireFloat32(target, "in-place targets");
+
+	Node node;
+	node.type = OpType::MapInto;
+	node.rhs = read(in);
+	node.out = write(target, coversAll(targetLayout, target->getNumElements()));
+	node.outLayout = targetLayout;
+	node.rhsLayout = inLayout;
+	node.unary = op;
+	node.param = alpha;
+	node.param2 = beta;
+
+	m_program.nodes.push_back(node);
+}
+
+void Recorder::recordMatmul(const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+                            const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+                            const Tensor::Impl* out, const TensorLayout& outLayout, size_t batch,
+                            size_t m, size_t k, size_t p) {
+	if (isConstant(lhs) && isConstant(rhs)) {
+		return;
+	}
+
+	Node node;
+	node.type = OpType::Matmul;
+	node.lhs = read(lhs);
+	node.rhs = read(rhs);
+	node.out = define(out);
+	node.lhsLayout = lhsLayout;
+	node.rhsLayout = rhsLayout;
+	node.outLayout = outLayout;
+	node.batch = batch;
+	node.m = m;
+	node.k = k;
+	node.p = p;
+
+	m_program.nodes.push_back(node);
+}
+
+void Recorder::recordCopy(const Tensor::Impl* src, const Tensor::Impl* copy) {
+	if (isConstant(src)) {
+		return;
+	}
+
+	Node node;
+	node.type = OpType::Copy;
+	node.lhs = read(src);
+	node.out = define(copy);
+
+	m_program.nodes.push_back(node);
+}
+
+void Recorder::recordAssign(const Tensor::Impl* oldImpl, const Tensor::Impl* src,
+                            const Tensor::Impl* newImpl) {
+	auto it = m_valueOf.find(oldImpl);
+	if (it == m_valueOf.end() || m_program.values[it->second].kind != ValueKind::Binding) {
+		recordCopy(src, newImpl);
+		release(oldImpl);
+		return;
+	}
+
+	size_t binding = it->second;
+	if (newImpl->getNumElements() != m_program.values[binding].numElements) {
+		throw std::runtime_error(
+		    "Graph capture can not change the number of elements of a bound tensor");
+	}
+	requireFloat32(newImpl, "bound tensors");
+
+	size_t source = read(src);
+	if (source != binding) {
+		Node node;
+		node.type = OpType::Copy;
+		node.lhs = source;
+		node.out = binding;
+
+		m_program.nodes.push_back(node);
+	}
+
+	m_valueOf.erase(oldImpl);
+	m_valueOf[newImpl] = binding;
+}
+
+void Recorder::recordOpaqueWrite(const Tensor::Impl* impl, const char* what) {
+	if (!isConstant(impl)) {
+		throw std::runtime_error(std::string(what) +
+		                         " can not be recorded on a tensor written by the graph");
+	}
+	m_valueOf.erase(impl);
+}
+
+void Recorder::release(const Tensor::Impl* impl) { m_valueOf.erase(impl); }
+
+Program Recorder::finish() {
+	m_valueOf.clear();
+	m_program.plan();
+	return std::move(m_program);
+}
+
+size_t Recorder::read(const Tensor::Impl* impl) {
+	auto it = m_valueOf.find(impl);
+	if (it != m_valueOf.end()) {
+		return it->second;
+	}
+
+	const auto* cpuImpl = asCPU(impl);
+	m_program.constants.push_back(cpuImpl->toVector());
+
+	size_t id = addValue(ValueKind::Constant, m_program.constants.size() - 1,
+	                     cpuImpl->getNumElements());
+	m_valueOf[impl] = id;
+	return id;
+}
+
+size_t Recorder::write(const Tensor::Impl* impl, bool overwritten) {
+	auto it = m_valueOf.find(impl);
+	if (it != m_valueOf.end() && m_program.values[it->second].kind != ValueKind::Constant) {
+		return it->second;
+	}
+
+	size_t source = overwritten ? NO_VALUE : read(impl);
+	size_t slot = define(impl);
+
+	if (source != NO_VALUE) {
+		Node node;
+		node.type = OpType::Copy;
+		node.lhs = source;
+		node.out = slot;
+
+		m_program.nodes.push_back(node);
+	}
+	return slot;
+}
+
+size_t Recorder::define(const Tensor::Impl* impl) {
+	requireFloatValues(impl);
+
+	size_t id = addValue(ValueKind::Slot, 0, asCPU(impl)->getNumElements());
+	m_valueOf[impl] = id;
+	return id;
+}
+
+bool Recorder::isConstant(const Tensor::Impl* impl) const {
+	auto it = m_valueOf.find(impl);
+	return it == m_valueOf.end() || m_program.values[it->second].kind == ValueKind::Constant;
+}
+
+size_t Recorder::addValue(ValueKind kind, size_t index, size_t numElements) {
+	m_program.values.push_back({kind, index, numElements});
+	return m_program.values.size() - 1;
+}
+
+}  // namespace graph
@@ -0,0 +1,110 @@
+#ifndef GRAPH_RECORDER_H
+#define GRAPH_RECORDER_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "graph/program.h"
+#include "nforge/core/tensor.h"
+#include "nforge/core/tensor_layout.h"
+
+namespace graph {
+
+/// Records Tensor operations into a `Program` while a graph capture is active.
+///
+/// Data is tracked per `Tensor::Impl`. An impl is either mapped to a value of the program, or
+/// unknown. Unknown impls are not produced by any recorded node, so their data is snapshotted as a
+/// constant the first time they are read. Operations whose inputs are all constant are not
+/// recorded at all: their output stays unknown and is snapshotted when read, which folds them.
+///
+/// Program values are float. Bool results of comparisons live in the program as 0.0 / 1.0, which
+/// every consumer reads the same way, but bound tensors and in-place targets must be Float32.
+/// Recorded operations producing any other dtype throw, their float replay would round and wrap
+/// differently.
+///
+/// Hooks that write in place must be called before the operation executes, everything else after.
+/// Only CPU tensors can be recorded, every hook throws std::runtime_error otherwise.
+class Recorder {
+public:
+	/// `bindings[i]` becomes value `i` of the program.
+	explicit Recorder(const std::vector<const Tensor::Impl*>& bindings);
+
+	/// Returns the recorder of the calling thread, or nullptr if no capture is active.
+	static Recorder*& active() {
+		thread_local Recorder* recorder = nullptr;
+		return recorder;
+	}
+
+	/// out = lhs op rhs.
+	void recordBinary(OpType type, const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+	                  const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+	                  const Tensor::Impl* out, const TensorLayout& outLayout, float param = 0.0f);
+
+	/// target = target op rhs, `type` is one of the in-place ops, Set or MaskedFill.
+	/// The target must be Float32.
+	void recordInplace(OpType type, const Tensor::Impl* target, const TensorLayout& targetLayout,
+	                   const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+	                   float param = 0.0f);
+
+	/// out = reduce(in).
+	void recordReduction(OpType type, const Tensor::Impl* in, const TensorLayout& layout,
+	                     const TensorLayout& blockLayout, const Tensor::Impl* out,
+	                     const TensorLayout& outLayout);
+
+	/// out = op(in) elementwise, see `Tensor::map`.
+	void recordMap(UnaryOp op, float alpha, float beta, const Tensor::Impl* in,
+	               const TensorLayout& inLayout, const Tensor::Impl* out,
+	               const TensorLayout& outLayout);
+
+	/// target = op(in) elementwise, see `Tensor::mapInto`. The target must be Float32.
+	void recordMapInto(UnaryOp op, float alpha, float beta, const Tensor::Impl* target,
+	                   const TensorLayout& targetLayout, const Tensor::Impl* in,
+	                   const TensorLayout& inLayout);
+
+	/// out = lhs @ rhs.
+	void recordMatmul(const Tensor::Impl* lhs, const TensorLayout& lhsLayout,
+	                  const Tensor::Impl* rhs, const TensorLayout& rhsLayout,
+	                  const Tensor::Impl* out, const TensorLayout& outLayout, size_t batch,
+	                  size_t m, size_t k, size_t p);
+
+	/// `copy` is a fresh deep copy of `src`.
+	void recordCopy(const Tensor::Impl* src, const Tensor::Impl* copy);
+
+	/// A tensor holding `oldImpl` is assigned a deep copy `newImpl` of `src`.
+	/// Bound tensors keep their binding, so their element count must not change.
+	void recordAssign(const Tensor::Impl* oldImpl, const Tensor::Impl* src,
+	                  const Tensor::Impl* newImpl);
+
+	/// `impl` is overwritten by an operation that can not be recorded, e.g. `fillAll`.
+	/// Allowed for unknown and constant impls only.
+	void recordOpaqueWrite(const Tensor::Impl* impl, const char* what);
+
+	/// `impl` is about to be destroyed, its address may be reused.
+	void release(const Tensor::Impl* impl);
+
+	/// Returns the planned program. The recorder must not be used afterwards.
+	Program finish();
+
+private:
+	Program m_program;
+	std::unordered_map<const Tensor::Impl*, size_t> m_valueOf;
+
+	/// Value read through `impl`, snapshotting unknown impls as constants.
+	size_t read(const Tensor::Impl* impl);
+
+	/// Value written in place through `impl`. Unknown and constant impls are materialized into a
+	/// new slot, initialized by a copy unless `overwritten` is true.
+	size_t write(const Tensor::Impl* impl, bool overwritten);
+
+	/// Maps `impl` to a new slot value.
+	size_t define(const Tensor::Impl* impl);
+
+	/// True if `impl` is unknown or mapped to a constant.
+	bool isConstant(const Tensor::Impl* impl) const;
+
+	size_t addValue(ValueKind kind, size_t index, size_t numElements);
+};
+
+}  // namespace graph
+
+#endif  // GRAPH_RECORDER_H
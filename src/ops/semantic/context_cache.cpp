@@ -0,0 +1,37 @@
+#include "ops/semantic/context_cache.h"
+
+#include "ops/semantic/semantic.h"
+
+namespace semantic {
+
+ContextCacheStats getContextCacheStats() {
+	const ContextCacheStats stats[] = {
+	    detail::getThreadCache<BinaryOpContext>().getStats(),
+	    detail::getThreadCache<InplaceBinaryOpContext>().getStats(),
+	    detail::getThreadCache<ReductionContext>().getStats(),
+	    detail::getThreadCache<MatmulContext>().getStats(),
+	};
+
+	ContextCacheStats total;
+	for (const auto& s : stats) {
+		total.hits += s.hits;
+		total.misses += s.misses;
+	}
+	return total;
+}
+
+void resetContextCacheStats() {
+	detail::getThreadCache<BinaryOpContext>().resetStats();
+	detail::getThreadCache<InplaceBinaryOpContext>().resetStats();
+	detail::getThreadCache<ReductionContext>().resetStats();
+	detail::getThreadCache<MatmulContext>().resetStats();
+}
+
+void clearContextCache() {
+	detail::getThreadCache<BinaryOpContext>().clear();
+	detail::getThreadCache<InplaceBinaryOpContext>().clear();
+	detail::getThreadCache<ReductionContext>().clear();
+	detail::getThreadCache<MatmulContext>().clear();
+}
+
+}  // namespace semantic
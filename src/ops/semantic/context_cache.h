@@ -0,0 +1,122 @@
+#ifndef CONTEXT_CACHE_H
+#define CONTEXT_CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "nforge/core/tensor_layout.h"
+
+namespace semantic {
+
+/// Hit and miss counters of the calling thread's context caches.
+struct ContextCacheStats {
+	size_t hits = 0;
+	size_t misses = 0;
+};
+
+/// Returns the counters of the calling thread, summed over all context kinds.
+ContextCacheStats getContextCacheStats();
+
+/// Resets the counters of the calling thread.
+void resetContextCacheStats();
+
+/// Drops every cached context of the calling thread. Counters are kept.
+void clearContextCache();
+
+namespace detail {
+
+enum class OpKind : uint8_t { Binary, InplaceBinary, Reduction, Matmul };
+
+/// Identifies a context by operation kind, operand layouts and an op specific parameter
+/// (the reduction dim). Layouts fully determine the result of every cached `build`, dtypes are
+/// filled in by `lookup` after the cache.
+struct ContextKey {
+	OpKind kind = OpKind::Binary;
+	size_t param = 0;
+	TensorLayout lhs;
+	TensorLayout rhs;
+
+	bool operator==(const ContextKey& other) const {
+		return kind == other.kind && param == other.param && lhs == other.lhs && rhs == other.rhs;
+	}
+};
+
+inline size_t hashCombine(size_t seed, size_t value) {
+	return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+inline size_t hashLayout(size_t seed, const TensorLayout& layout) {
+	seed = hashCombine(seed, layout.rank);
+	seed = hashCombine(seed, layout.offset);
+	for (size_t d = 0; d < layout.rank; d++) {
+		seed = hashCombine(seed, layout.shape[d]);
+		seed = hashCombine(seed, layout.strides[d]);
+	}
+	return seed;
+}
+
+inline size_t hashKey(const ContextKey& key) {
+	size_t seed = hashCombine((size_t)key.kind, key.param);
+	seed = hashLayout(seed, key.lhs);
+	return hashLayout(seed, key.rhs);
+}
+
+/// Small direct-mapped cache from `ContextKey` to a built context.
+///
+/// A miss overwrites whatever entry shares the slot, so the cache never grows beyond
+/// `Capacity` entries. Storage is allocated on first use.
+template <typename Context, size_t Capacity = 32>
+class ContextCache {
+public:
+	/// Returns the cached context for `key`, or calls `build()` and caches its result.
+	/// Nothing is cached if `build()` throws.
+	template <typename Build>
+	Context lookup(const ContextKey& key, Build build) {
+		if (m_entries.empty()) {
+			m_entries.resize(Capacity);
+		}
+
+		Entry& entry = m_entries[hashKey(key) % Capacity];
+		if (entry.valid && entry.key == key) {
+			m_stats.hits++;
+			return entry.context;
+		}
+
+		m_stats.misses++;
+		Context context = build();
+
+		entry.key = key;
+		entry.context = context;
+		entry.valid = true;
+		return context;
+	}
+
+	void clear() { m_entries.clear(); }
+
+	const ContextCacheStats& getStats() const { return m_stats; }
+
+	void resetStats() { m_stats = {}; }
+
+private:
+	struct Entry {
+		bool valid = false;
+		ContextKey key;
+		Context context;
+	};
+
+	std::vector<Entry> m_entries;
+	ContextCacheStats m_stats;
+};
+
+/// Returns the calling thread's cache for `Context`.
+template <typename Context>
+ContextCache<Context>& getThreadCache() {
+	thread_local ContextCache<Context> cache;
+	return cache;
+}
+
+}  // namespace detail
+
+}  // namespace semantic
+
+#endif  // CONTEXT_CACHE_H
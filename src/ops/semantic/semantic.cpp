@@ -1,5 +1,7 @@
 #include "ops/semantic/semantic.h"
 
+#include "ops/semantic/context_cache.h"
+
 namespace semantic {
 
 void ensureSameBackend(const Tensor::View& lhs, const Tensor::View& rhs) {
@@ -16,6 +18,31 @@ void ensureSameBackend(const Tensor::View& lhs, const Tensor::View& rhs) {
 	}
 }
 
+DType resultType(const Tensor::View& lhs, const Tensor::View& rhs) {
+	DType lhsType = lhs.getDType();
+	DType rhsType = rhs.getDType();
+
+	bool lhsScalar = lhs.getShape().getNumDims() == 0;
+	bool rhsScalar = rhs.getShape().getNumDims() == 0;
+
+	if (rhsScalar && !lhsScalar && canCast(rhsType, lhsType)) {
+		return lhsType;
+	}
+	if (lhsScalar && !rhsScalar && canCast(lhsType, rhsType)) {
+		return rhsType;
+	}
+	return promoteTypes(lhsType, rhsType);
+}
+
+void ensureCastable(const Tensor::View& lhs, const Tensor::View& rhs) {
+	DType dtype = resultType(lhs, rhs);
+	if (!canCast(dtype, lhs.getDType())) {
+		throw std::runtime_error(std::string("Can not store a ") + getDTypeName(dtype) +
+		                         " result in place into a " + getDTypeName(lhs.getDType()) +
+		                         " tensor");
+	}
+}
+
 inline Tensor::Shape broadcastShapes(const Tensor::Shape& lhs, const Tensor::Shape& rhs) {
 	size_t rankLhs = lhs.getNumDims();
 	size_t rankRhs = rhs.getNumDims();
@@ -72,6 +99,7 @@ BinaryOpContext BinaryOpContext::build(const Tensor::View& lhs, const Tensor::Vi
 	ctx.lhs = broadcastTo(lhs.getLayout(), outShape);
 	ctx.rhs = broadcastTo(rhs.getLayout(), outShape);
 	ctx.out = outShape.toContiguousLayout();
+	ctx.dtype = resultType(lhs, rhs);
 	return ctx;
 }
 
@@ -119,6 +147,298 @@ IndexContext IndexContext::build(const Tensor::View& src, size_t idx) {
 	return ctx;
 }
 
+/// Throws unless a view of rank `rank` fits in a `TensorLayout`.
+inline void validateViewRank(size_t rank, const char* what) {
+	if (rank > MAX_DIMS) {
+		throw std::runtime_error(std::string(what) + ": a view can have at most " +
+		                         std::to_string(MAX_DIMS) + " dims, got " + std::to_string(rank));
+	}
+}
+
+ViewContext ViewContext::buildReshape(const Tensor::View& src, const Tensor::Shape& shape) {
+	const Tensor::Shape& srcShape = src.getShape();
+	size_t numElements = srcShape.getNumElements();
+	if (shape.getNumElements() != numElements) {
+		throw std::runtime_error("reshape: can not view " + srcShape.toString() + " as " +
+		                         shape.toString() + ", the element counts differ");
+	}
+	validateViewRank(shape.getNumDims(), "reshape");
+
+	const TensorLayout& layout = src.getLayout();
+	std::vector<size_t> dims = shape.toVector();
+	std::vector<size_t> strides = shape.getContiguousStrides();
+
+	// without elements, or with the single one of a rank 0 source, any strides are valid
+	ViewContext ctx;
+	if (numElements == 0 || layout.rank == 0) {
+		ctx.out = TensorLayout(shape, strides, layout.offset);
+		return ctx;
+	}
+
+	// Walks the source dims from the back in chunks that are contiguous in memory, each chunk
+	// must be covered by a run of new dims, which get strides inside that chunk. Size 1 dims
+	// never break a chunk, their stride is free.
+	int newDim = (int)dims.size() - 1;
+	size_t chunkStride = layout.strides[layout.rank - 1];
+	size_t chunkElements = 1;
+	size_t viewElements = 1;
+	for (int d = (int)layout.rank - 1; d >= 0; d--) {
+		chunkElements *= layout.shape[d];
+
+		bool chunkEnds = d == 0 || (layout.shape[d - 1] != 1 &&
+		                            layout.strides[d - 1] != chunkElements * chunkStride);
+		if (!chunkEnds) {
+			continue;
+		}
+
+		while (newDim >= 0 && (viewElements < chunkElements || dims[newDim] == 1)) {
+			strides[newDim] = viewElements * chunkStride;
+			viewElements *= dims[newDim];
+			newDim--;
+		}
+		if (viewElements != chunkElements) {
+			throw std::runtime_error("reshape: the strides of " + srcShape.toString() +
+			                         " can not be viewed as " + shape.toString() +
+			                         ", call contiguous() first");
+		}
+		if (d > 0) {
+			chunkStride = layout.strides[d - 1];
+			chunkElements = 1;
+			viewElements = 1;
+		}
+	}
+
+	ctx.out = TensorLayout(shape, strides, layout.offset);
+	return ctx;
+}
+
+ViewContext ViewContext::buildPermute(const Tensor::View& src, const std::vector<size_t>& dims) {
+	const TensorLayout& layout = src.getLayout();
+	if (dims.size() != layout.rank) {
+		throw std::runtime_error("permute: expected " + std::to_string(layout.rank) +
+		                         " dims for a view of shape " + src.getShape().toString() +
+		                         ", got " + std::to_string(dims.size()));
+	}
+
+	ViewContext ctx;
+	ctx.out = layout;
+
+	std::array<bool, MAX_DIMS> seen{};
+	for (size_t d = 0; d < dims.size(); d++) {
+		if (dims[d] >= layout.rank || seen[dims[d]]) {
+			throw std::runtime_error("permute: dims must be a permutation of 0.." +
+			                         std::to_string(layout.rank - 1));
+		}
+		seen[dims[d]] = true;
+		ctx.out.shape[d] = layout.shape[dims[d]];
+		ctx.out.strides[d] = layout.strides[dims[d]];
+	}
+	return ctx;
+}
+
+ViewContext ViewContext::buildSqueeze(const Tensor::View& src, const std::vector<size_t>& dims) {
+	const TensorLayout& layout = src.getLayout();
+
+	std::array<bool, MAX_DIMS> drop{};
+	for (size_t dim : dims) {
+		if (dim >= layout.rank || layout.shape[dim] != 1) {
+			throw std::runtime_error("squeeze: dim " + std::to_string(dim) + " of shape " +
+			                         src.getShape().toString() + " does not have size 1");
+		}
+		drop[dim] = true;
+	}
+
+	ViewContext ctx;
+	ctx.out = TensorLayout();
+	ctx.out.offset = layout.offset;
+	for (size_t d = 0; d < layout.rank; d++) {
+		if (!drop[d]) {
+			ctx.out.shape[ctx.out.rank] = layout.shape[d];
+			ctx.out.strides[ctx.out.rank] = layout.strides[d];
+			ctx.out.rank++;
+		}
+	}
+
+	// ensure rank > 0, as indexing does
+	if (ctx.out.rank == 0) {
+		ctx.out.shape[0] = 1;
+		ctx.out.strides[0] = 1;
+		ctx.out.rank = 1;
+	}
+	return ctx;
+}
+
+/// Clamps `bound` of a slice along a dim of `size` into [-1, size] like Python's `slice.indices`.
+inline int64_t clampSliceBound(int64_t bound, int64_t size, int64_t step) {
+	if (bound < 0) {
+		bound += size;
+	}
+	int64_t low = step > 0 ? 0 : -1;
+	int64_t high = step > 0 ? size : size - 1;
+	return std::min(std::max(bound, low), high);
+}
+
+ViewContext ViewContext::buildSlice(const Tensor::View& src, const std::vector<Slice>& ranges) {
+	const TensorLayout& layout = src.getLayout();
+	if (ranges.size() > layout.rank) {
+		throw std::runtime_error("slice: " + std::to_string(ranges.size()) +
+		                         " ranges for a view of shape " + src.getShape().toString());
+	}
+
+	ViewContext ctx;
+	ctx.out = layout;
+	for (size_t d = 0; d < ranges.size(); d++) {
+		const Slice& range = ranges[d];
+		if (range.step == 0) {
+			throw std::runtime_error("slice: the step along dim " + std::to_string(d) +
+			                         " is 0");
+		}
+
+		int64_t size = (int64_t)layout.shape[d];
+		int64_t step = range.step;
+		int64_t start = range.start ? clampSliceBound(*range.start, size, step)
+		                            : (step > 0 ? 0 : size - 1);
+		int64_t stop = range.stop ? clampSliceBound(*range.stop, size, step)
+		                          : (step > 0 ? size : -1);
+
+		int64_t span = step > 0 ? stop - start : start - stop;
+		int64_t magnitude = step > 0 ? step : -step;
+		size_t count = span > 0 ? (size_t)((span + magnitude - 1) / magnitude) : 0;
+
+		// an empty range keeps the offset, its start may be one past the end
+		if (count > 0) {
+			ctx.out.offset += (size_t)start * layout.strides[d];
+		}
+		ctx.out.shape[d] = count;
+		ctx.out.strides[d] = (size_t)step * layout.strides[d];
+	}
+	return ctx;
+}
+
+ViewContext ViewContext::buildUnfold(const Tensor::View& src, size_t dim, size_t size,
+                                     size_t step) {
+	const TensorLayout& layout = src.getLayout();
+	if (dim >= layout.rank) {
+		throw std::runtime_error("unfold: dim " + std::to_string(dim) + " is not a dim of shape " +
+		                         src.getShape().toString());
+	}
+	if (size == 0 || size > layout.shape[dim] || step == 0) {
+		throw std::runtime_error("unfold: can not take windows of " + std::to_string(size) +
+		                         " every " + std::to_string(step) + " along a dim of size " +
+		                         std::to_string(layout.shape[dim]));
+	}
+	validateViewRank(layout.rank + 1, "unfold");
+
+	ViewContext ctx;
+	ctx.out = layout;
+	ctx.out.shape[dim] = (layout.shape[dim] - size) / step + 1;
+	ctx.out.strides[dim] = layout.strides[dim] * step;
+	ctx.out.shape[layout.rank] = size;
+	ctx.out.strides[layout.rank] = layout.strides[dim];
+	ctx.out.rank++;
+	return ctx;
+}
+
+ViewContext ViewContext::buildUnsqueeze(const Tensor::View& src, size_t dim) {
+	const TensorLayout& layout = src.getLayout();
+	if (dim > layout.rank) {
+		throw std::runtime_error("unsqueeze: dim " + std::to_string(dim) +
+		                         " is past the end of shape " + src.getShape().toString());
+	}
+	validateViewRank(layout.rank + 1, "unsqueeze");
+
+	ViewContext ctx;
+	ctx.out = layout;
+	ctx.out.rank++;
+	for (size_t d = layout.rank; d > dim; d--) {
+		ctx.out.shape[d] = layout.shape[d - 1];
+		ctx.out.strides[d] = layout.strides[d - 1];
+	}
+
+	// any stride works for a size 1 dim, this one keeps contiguous views contiguous
+	ctx.out.shape[dim] = 1;
+	ctx.out.strides[dim] = dim < layout.rank ? layout.shape[dim] * layout.strides[dim] : 1;
+	return ctx;
+}
+
+ViewContext ViewContext::buildExpand(const Tensor::View& src, const Tensor::Shape& shape) {
+	const Tensor::Shape& srcShape = src.getShape();
+	size_t rank = shape.getNumDims();
+	size_t srcRank = srcShape.getNumDims();
+	validateViewRank(rank, "expand");
+
+	bool fits = srcRank <= rank;
+	for (size_t d = 0; fits && d < srcRank; d++) {
+		size_t srcDim = srcShape.getDim(d);
+		fits = srcDim == 1 || srcDim == shape.getDim(d + rank - srcRank);
+	}
+	if (!fits) {
+		throw std::runtime_error("expand: can not expand shape " + srcShape.toString() + " to " +
+		                         shape.toString());
+	}
+
+	ViewContext ctx;
+	ctx.out = broadcastTo(src.getLayout(), shape);
+	return ctx;
+}
+
+
+/// Throws unless `index` is an integer tensor on the backend of `lhs` and `dim` is a dim of it.
+inline void validateIndex(const Tensor::View& lhs, size_t dim, const Tensor::View& index) {
+	ensureSameBackend(lhs, index);
+
+	size_t rank = lhs.getShape().getNumDims();
+	if (dim >= rank) {
+		throw std::runtime_error("Can not index along dim " + std::to_string(dim) +
+		                         " of a tensor of shape " + lhs.getShape().toString());
+	}
+	if (!isIntegral(index.getDType())) {
+		throw std::runtime_error(std::string("Indices must have an integer dtype, got ") +
+		                         getDTypeName(index.getDType()));
+	}
+}
+
+GatherContext GatherContext::build(const Tensor::View& lhs, size_t dim,
+                                   const Tensor::View& index) {
+	validateIndex(lhs, dim, index);
+
+	const Tensor::Shape& lhsShape = lhs.getShape();
+	const Tensor::Shape& indexShape = index.getShape();
+	bool fits = indexShape.getNumDims() == lhsShape.getNumDims();
+	for (size_t d = 0; fits && d < lhsShape.getNumDims(); d++) {
+		fits = d == dim || indexShape.getDim(d) <= lhsShape.getDim(d);
+	}
+	if (!fits) {
+		throw std::runtime_error("Index of shape " + indexShape.toString() +
+		                         " does not fit a tensor of shape " + lhsShape.toString() +
+		                         " along dim " + std::to_string(dim));
+	}
+
+	GatherContext ctx;
+	ctx.lhs = lhs.getLayout();
+	ctx.index = index.getLayout();
+	return ctx;
+}
+
+GatherContext GatherContext::buildSelect(const Tensor::View& lhs, size_t dim,
+                                         const Tensor::View& index) {
+	validateIndex(lhs, dim, index);
+
+	if (index.getShape().getNumDims() != 1) {
+		throw std::runtime_error("Can not select with an index of shape " +
+		                         index.getShape().toString() + ", it must be 1D");
+	}
+
+	GatherContext ctx;
+	ctx.lhs = lhs.getLayout();
+	ctx.index = lhs.getLayout();
+	ctx.index.offset = index.getLayout().offset;
+	ctx.index.strides.fill(0);
+	ctx.index.shape[dim] = index.getLayout().shape[0];
+	ctx.index.strides[dim] = index.getLayout().strides[0];
+	return ctx;
+}
+
 
 inline void validateRanksMatmul(size_t lhsRank, size_t rhsRank) {
 	if (lhsRank < 2 || lhsRank > 3 || rhsRank < 2 || rhsRank > 3) {
@@ -178,15 +498,150 @@ MatmulContext MatmulContext::build(const Tensor::View& lhs, const Tensor::View&
 	ctx.lhs = lhs.getLayout();
 	ctx.rhs = rhs.getLayout();
 	ctx.out = computeOutputLayoutMatmul(ctx.batch, ctx.m, ctx.p);
+	ctx.dtype = promoteTypes(lhs.getDType(), rhs.getDType());
 
 	return ctx;
 }
 
 
+/// 4D layout of a 1D or 2D convolution operand, a 3D layout gets a height dim of size 1.
+inline TensorLayout toConvLayout(const TensorLayout& layout) {
+	if (layout.rank == 4) {
+		return layout;
+	}
+
+	TensorLayout result = layout;
+	result.rank = 4;
+	result.shape[3] = layout.shape[2];
+	result.strides[3] = layout.strides[2];
+	result.shape[2] = 1;
+	result.strides[2] = 0;
+	return result;
+}
+
+ConvContext ConvContext::build(const Tensor::View& lhs, const Tensor::View& weight,
+                               size_t spatialDims, size_t stride, size_t padding,
+                               size_t dilation) {
+	ensureSameBackend(lhs, weight);
+
+	const Tensor::Shape& lhsShape = lhs.getShape();
+	const Tensor::Shape& weightShape = weight.getShape();
+	size_t rank = spatialDims + 2;
+	std::string name = "conv" + std::to_string(spatialDims) + "d";
+
+	if (lhsShape.getNumDims() != rank || weightShape.getNumDims() != rank) {
+		throw std::runtime_error(name + ": expected " + std::to_string(rank) +
+		                         "D input and weights, got " + lhsShape.toString() + " and " +
+		                         weightShape.toString());
+	}
+	if (lhsShape.getDim(1) != weightShape.getDim(1)) {
+		throw std::runtime_error(name + ": input channels must match, got " +
+		                         lhsShape.toString() + " and " + weightShape.toString());
+	}
+	if (stride == 0 || dilation == 0) {
+		throw std::runtime_error(name + ": stride and dilation must be positive");
+	}
+
+	ConvContext ctx;
+	ctx.lhs = toConvLayout(lhs.getLayout());
+	ctx.weight = toConvLayout(weight.getLayout());
+	ctx.dtype = promoteTypes(lhs.getDType(), weight.getDType());
+
+	Tensor::Impl::Convolution& conv = ctx.geometry;
+	conv.batch = ctx.lhs.shape[0];
+	conv.inChannels = ctx.lhs.shape[1];
+	conv.outChannels = ctx.weight.shape[0];
+	conv.height = ctx.lhs.shape[2];
+	conv.width = ctx.lhs.shape[3];
+	conv.kernelHeight = ctx.weight.shape[2];
+	conv.kernelWidth = ctx.weight.shape[3];
+	// 1D convolutions are not padded along the height of 1
+	conv.stride = {spatialDims == 2 ? stride : 1, stride};
+	conv.padding = {spatialDims == 2 ? padding : 0, padding};
+	conv.dilation = {spatialDims == 2 ? dilation : 1, dilation};
+
+	std::array<size_t, 2> input = {conv.height, conv.width};
+	std::array<size_t, 2> kernel = {conv.kernelHeight, conv.kernelWidth};
+	std::array<size_t, 2> output;
+	for (size_t d = 0; d < 2; d++) {
+		size_t padded = input[d] + 2 * conv.padding[d];
+		size_t span = conv.dilation[d] * (kernel[d] - 1) + 1;
+		if (kernel[d] == 0 || span > padded) {
+			throw std::runtime_error(name + ": kernel " + weightShape.toString() +
+			                         " does not fit the padded input " + lhsShape.toString());
+		}
+		output[d] = (padded - span) / conv.stride[d] + 1;
+	}
+	conv.outHeight = output[0];
+	conv.outWidth = output[1];
+
+	std::vector<size_t> outDims = {conv.batch, conv.outChannels};
+	if (spatialDims == 2) {
+		outDims.push_back(conv.outHeight);
+	}
+	outDims.push_back(conv.outWidth);
+	ctx.out = Tensor::Shape(outDims).toContiguousLayout();
+	return ctx;
+}
+
+
+LinalgContext LinalgContext::build(const Tensor::View& lhs, const char* what, bool square) {
+	const Tensor::Shape& shape = lhs.getShape();
+	size_t rank = shape.getNumDims();
+	if (rank < 2) {
+		throw std::runtime_error(std::string(what) + ": expected matrices in the last two dims, " +
+		                         "got " + shape.toString());
+	}
+
+	LinalgContext ctx;
+	ctx.m = shape.getDim(rank - 2);
+	ctx.n = shape.getDim(rank - 1);
+	ctx.k = 0;
+	ctx.batch = ctx.m * ctx.n > 0 ? shape.getNumElements() / (ctx.m * ctx.n) : 0;
+	ctx.dtype = lhs.getDType() == DType::Float64 ? DType::Float64 : DType::Float32;
+
+	if (square ? ctx.m != ctx.n : ctx.m < ctx.n) {
+		throw std::runtime_error(std::string(what) + ": expected " +
+		                         (square ? "square matrices" : "matrices with rows >= columns") +
+		                         ", got " + shape.toString());
+	}
+	return ctx;
+}
+
+LinalgContext LinalgContext::buildSolve(const Tensor::View& lhs, const Tensor::View& rhs,
+                                        const char* what) {
+	ensureSameBackend(lhs, rhs);
+	LinalgContext ctx = build(lhs, what, true);
+
+	const Tensor::Shape& lhsShape = lhs.getShape();
+	const Tensor::Shape& rhsShape = rhs.getShape();
+	size_t rank = lhsShape.getNumDims();
+
+	bool match = rhsShape.getNumDims() == rank && rhsShape.getDim(rank - 2) == ctx.n;
+	for (size_t d = 0; match && d + 2 < rank; d++) {
+		match = rhsShape.getDim(d) == lhsShape.getDim(d);
+	}
+	if (!match) {
+		throw std::runtime_error(std::string(what) + ": rhs needs the leading dims and rows of " +
+		                         lhsShape.toString() + ", got " + rhsShape.toString());
+	}
+
+	ctx.k = rhsShape.getDim(rank - 1);
+	if (rhs.getDType() == DType::Float64) {
+		ctx.dtype = DType::Float64;
+	}
+	return ctx;
+}
+
+
 InplaceBinaryOpContext InplaceBinaryOpContext::build(const Tensor::View& lhs,
                                                      const Tensor::View& rhs) {
+	ensureCastable(lhs, rhs);
+
 	const BinaryOpContext& ctx = BinaryOpContext::build(lhs, rhs);
-	const TensorLayout& lhsLayout = lhs.getLayout();
+
+	// size-1 dims get stride 0 when broadcast, normalize lhs the same way before comparing
+	const TensorLayout& lhsLayout = broadcastTo(lhs.getLayout(), lhs.getShape());
 
 	if (lhsLayout != ctx.lhs) {
 		throw std::runtime_error(
@@ -201,4 +656,147 @@ InplaceBinaryOpContext InplaceBinaryOpContext::build(const Tensor::View& lhs,
 }
 
 
+BinaryOpContext BinaryOpContext::lookup(const Tensor::View& lhs, const Tensor::View& rhs) {
+	// backends are not part of the key, so check them on every call
+	ensureSameBackend(lhs, rhs);
+
+	detail::ContextKey key{detail::OpKind::Binary, 0, lhs.getLayout(), rhs.getLayout()};
+	BinaryOpContext ctx =
+	    detail::getThreadCache<BinaryOpContext>().lookup(key, [&] { return build(lhs, rhs); });
+
+	// dtypes are not part of the key either
+	ctx.dtype = resultType(lhs, rhs);
+	return ctx;
+}
+
+InplaceBinaryOpContext InplaceBinaryOpContext::lookup(const Tensor::View& lhs,
+                                                      const Tensor::View& rhs) {
+	ensureSameBackend(lhs, rhs);
+	ensureCastable(lhs, rhs);
+
+	detail::ContextKey key{detail::OpKind::InplaceBinary, 0, lhs.getLayout(), rhs.getLayout()};
+	return detail::getThreadCache<InplaceBinaryOpContext>().lookup(key,
+	                                                               [&] { return build(lhs, rhs); });
+}
+
+ReductionContext ReductionContext::lookup(const Tensor::View& lhs, size_t dim) {
+	detail::ContextKey key{detail::OpKind::Reduction, dim, lhs.getLayout(), TensorLayout()};
+	return detail::getThreadCache<ReductionContext>().lookup(key, [&] { return build(lhs, dim); });
+}
+
+MatmulContext MatmulContext::lookup(const Tensor::View& lhs, const Tensor::View& rhs) {
+	ensureSameBackend(lhs, rhs);
+
+	detail::ContextKey key{detail::OpKind::Matmul, 0, lhs.getLayout(), rhs.getLayout()};
+	MatmulContext ctx =
+	    detail::getThreadCache<MatmulContext>().lookup(key, [&] { return build(lhs, rhs); });
+
+	ctx.dtype = promoteTypes(lhs.getDType(), rhs.getDType());
+	return ctx;
+}
+
+
+/// Shared by `ConcatContext::build` and `buildStack`, a stacked input is viewed with a size 1
+/// dim inserted before `dim`. Works on the layouts alone, so no shape is allocated per input.
+inline ConcatContext buildConcat(const std::vector<Tensor::View>& inputs, size_t dim, bool stack) {
+	const char* what = stack ? "stack" : "concat";
+	if (inputs.empty()) {
+		throw std::runtime_error(std::string(what) + ": expected at least one tensor");
+	}
+
+	const TensorLayout& first = inputs[0].getLayout();
+	size_t rank = first.rank + (stack ? 1 : 0);
+	if (dim >= rank || rank > MAX_DIMS) {
+		throw std::runtime_error(std::string(what) + ": dim " + std::to_string(dim) +
+		                         " is out of range for shape " + inputs[0].getShape().toString());
+	}
+
+	// dims of the output, the inputs have them except along `dim`
+	std::array<size_t, MAX_DIMS> dims{};
+	for (size_t d = 0, src = 0; d < rank; d++) {
+		dims[d] = stack && d == dim ? 1 : first.shape[src++];
+	}
+
+	ConcatContext ctx;
+	ctx.dtype = inputs[0].getDType();
+	ctx.copies.reserve(inputs.size());
+	dims[dim] = 0;
+
+	for (const Tensor::View& input : inputs) {
+		ensureSameBackend(inputs[0], input);
+
+		const TensorLayout& layout = input.getLayout();
+		bool fits = layout.rank == first.rank;
+		for (size_t d = 0; fits && d < layout.rank; d++) {
+			fits = (!stack && d == dim) || layout.shape[d] == first.shape[d];
+		}
+		if (!fits) {
+			throw std::runtime_error(std::string(what) + ": can not join shapes " +
+			                         inputs[0].getShape().toString() + " and " +
+			                         input.getShape().toString() + " along dim " +
+			                         std::to_string(dim));
+		}
+
+		dims[dim] += stack ? 1 : layout.shape[dim];
+		ctx.dtype = promoteTypes(ctx.dtype, input.getDType());
+	}
+
+	ctx.out = TensorLayout(dims, {}, 0, rank);
+	size_t outer = 1;
+	size_t inner = 1;
+	for (size_t d = rank; d-- > 0;) {
+		ctx.out.strides[d] = inner;
+		inner *= dims[d];
+	}
+	for (size_t d = 0; d < dim; d++) outer *= dims[d];
+	inner = ctx.out.strides[dim];
+
+	size_t start = 0;
+	for (size_t i = 0; i < inputs.size(); i++) {
+		const TensorLayout& layout = inputs[i].getLayout();
+		size_t length = stack ? 1 : layout.shape[dim];
+		size_t run = length * inner;
+		if (outer * run == 0) {
+			start += length;
+			continue;
+		}
+
+		ConcatContext::Copy copy;
+		copy.input = i;
+		if (inputs[i].isContiguous()) {
+			// the dims from `dim` on are one run in both, so each row is a single flat copy
+			copy.source = TensorLayout({outer, run}, {run, 1}, layout.offset, 2);
+			copy.target = TensorLayout({outer, run}, {dims[dim] * inner, 1}, start * inner, 2);
+		} else {
+			copy.source = layout;
+			if (stack) {
+				copy.source.rank++;
+				for (size_t d = layout.rank; d > dim; d--) {
+					copy.source.shape[d] = layout.shape[d - 1];
+					copy.source.strides[d] = layout.strides[d - 1];
+				}
+				copy.source.shape[dim] = 1;
+				copy.source.strides[dim] = 0;
+			}
+			copy.target = ctx.out;
+			copy.target.shape[dim] = length;
+			copy.target.offset = start * inner;
+		}
+
+		ctx.copies.push_back(copy);
+		start += length;
+	}
+
+	return ctx;
+}
+
+ConcatContext ConcatContext::build(const std::vector<Tensor::View>& inputs, size_t dim) {
+	return buildConcat(inputs, dim, false);
+}
+
+ConcatContext ConcatContext::buildStack(const std::vector<Tensor::View>& inputs, size_t dim) {
+	return buildConcat(inputs, dim, true);
+}
+
+
 }  // namespace semantic
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef SEMANTIC_H
 #define SEMANTIC_H
 
+#include "backend/tensor_impl.h"
 #include "nforge/core/tensor.h"
 #include "nforge/core/tensor_layout.h"
 #include "nforge/core/tensor_shape.h"
@@ -17,21 +18,36 @@ protected:
 }  // namespace detail
 
 
+/// Result dtype of a binary operation, see `promoteTypes`. A rank 0 operand next to an operand of
+/// higher rank only promotes it into a higher category, so a Float16 tensor times a Float32
+/// scalar stays Float16 while an Int32 tensor times a Float32 scalar becomes Float32.
+DType resultType(const Tensor::View& lhs, const Tensor::View& rhs);
+
+
 class BinaryOpContext : detail::OperationContext {
 public:
 	TensorLayout lhs;
 	TensorLayout rhs;
 	TensorLayout out;
+	/// Dtype both operands are promoted to, see `resultType`.
+	DType dtype;
 
 	static BinaryOpContext build(const Tensor::View& lhs, const Tensor::View& rhs);
+
+	/// Same as `build`, but served from the calling thread's context cache when possible.
+	static BinaryOpContext lookup(const Tensor::View& lhs, const Tensor::View& rhs);
 };
 
+/// Requires the result dtype of lhs and rhs to be castable into the lhs, see `canCast`.
 class InplaceBinaryOpContext : detail::OperationContext {
 public:
 	TensorLayout lhs;
 	TensorLayout rhs;
 
 	static InplaceBinaryOpContext build(const Tensor::View& lhs, const Tensor::View& rhs);
+
+	/// Same as `build`, but served from the calling thread's context cache when possible.
+	static InplaceBinaryOpContext lookup(const Tensor::View& lhs, const Tensor::View& rhs);
 };
 
 
@@ -42,6 +58,9 @@ public:
 	TensorLayout block;
 
 	static ReductionContext build(const Tensor::View& lhs, size_t dim);
+
+	/// Same as `build`, but served from the calling thread's context cache when possible.
+	static ReductionContext lookup(const Tensor::View& lhs, size_t dim);
 };
 
 
@@ -53,6 +72,52 @@ public:
 };
 
 
+/// Layout of the elements of `src` under a new shape or dim order, nothing is copied. Throws if
+/// the layout can not express the result.
+class ViewContext : detail::OperationContext {
+public:
+	TensorLayout out;
+
+	/// `src` read in row-major order as `shape`, with the same element count.
+	static ViewContext buildReshape(const Tensor::View& src, const Tensor::Shape& shape);
+
+	/// Dim `d` of the result is dim `dims[d]` of `src`.
+	static ViewContext buildPermute(const Tensor::View& src, const std::vector<size_t>& dims);
+
+	/// Drops the size 1 `dims` of `src`, keeping at least one dim.
+	static ViewContext buildSqueeze(const Tensor::View& src, const std::vector<size_t>& dims);
+
+	/// Restricts each dim `d` of `src` to `ranges[d]`. A negative step is stored as its two's
+	/// complement stride, see `TensorLayout`.
+	static ViewContext buildSlice(const Tensor::View& src, const std::vector<Slice>& ranges);
+
+	/// Windows of `size` along `dim`, `step` apart, as a new trailing dim.
+	static ViewContext buildUnfold(const Tensor::View& src, size_t dim, size_t size, size_t step);
+
+	/// Inserts a size 1 dim before dim `dim`, which is at most the rank of `src`.
+	static ViewContext buildUnsqueeze(const Tensor::View& src, size_t dim);
+
+	/// Repeats the size 1 dims of `src` to `shape` with stride 0, see `Tensor::View::broadcast`.
+	static ViewContext buildExpand(const Tensor::View& src, const Tensor::Shape& shape);
+};
+
+
+/// Layouts of a gather or scatter along `dim`. The index is an integer tensor on the same
+/// backend, with the rank of lhs and no dim longer than lhs except along `dim`.
+class GatherContext : detail::OperationContext {
+public:
+	TensorLayout lhs;
+	TensorLayout index;
+
+	static GatherContext build(const Tensor::View& lhs, size_t dim, const Tensor::View& index);
+
+	/// Same as `build` for a 1D index selecting whole slices along `dim`. The index layout is
+	/// broadcast over the other dims of lhs, with stride 0.
+	static GatherContext buildSelect(const Tensor::View& lhs, size_t dim,
+	                                 const Tensor::View& index);
+};
+
+
 class MatmulContext : detail::OperationContext {
 public:
 	TensorLayout lhs;
@@ -62,8 +127,75 @@ public:
 	size_t m;
 	size_t k;
 	size_t p;
+	/// Dtype both operands are promoted to and the result has, see `promoteTypes`.
+	DType dtype;
 
 	static MatmulContext build(const Tensor::View& lhs, const Tensor::View& rhs);
+
+	/// Same as `build`, but served from the calling thread's context cache when possible.
+	static MatmulContext lookup(const Tensor::View& lhs, const Tensor::View& rhs);
+};
+
+/// Shapes of a 1D or 2D convolution. Layouts of 1D operands get a height dim of size 1, so the
+/// backends only see 4D layouts.
+class ConvContext : detail::OperationContext {
+public:
+	TensorLayout lhs;
+	TensorLayout weight;
+	TensorLayout out;
+	Tensor::Impl::Convolution geometry;
+	/// Dtype both operands are promoted to and the result has, see `promoteTypes`.
+	DType dtype;
+
+	/// `spatialDims` is 1 or 2, `stride`, `padding` and `dilation` apply to every spatial dim.
+	static ConvContext build(const Tensor::View& lhs, const Tensor::View& weight,
+	                         size_t spatialDims, size_t stride, size_t padding, size_t dilation);
+};
+
+/// Shapes of a factorization or solve of the matrices in the last two dims of lhs, every
+/// combination of the leading dims is one of `batch` independent problems.
+class LinalgContext : detail::OperationContext {
+public:
+	size_t batch;
+	/// Rows and columns of each lhs matrix.
+	size_t m;
+	size_t n;
+	/// Columns of each rhs matrix of a solve.
+	size_t k;
+	/// Float64 if an operand is Float64, else Float32.
+	DType dtype;
+
+	/// `what` names the op in errors. Requires m == n if `square`, else m >= n.
+	static LinalgContext build(const Tensor::View& lhs, const char* what, bool square);
+
+	/// Square lhs matrices against (..., n, k) rhs matrices with the same leading dims.
+	static LinalgContext buildSolve(const Tensor::View& lhs, const Tensor::View& rhs,
+	                                const char* what);
+};
+
+/// Copies that concatenate `inputs` along `dim`, each into its own range of `out`. Inputs have
+/// the same rank and backend and only differ in length along `dim`. Only layouts are read, so
+/// building stays cheap for thousands of small inputs.
+class ConcatContext : detail::OperationContext {
+public:
+	/// Copy of input `input` from `source` to `target` in the output. A contiguous input is
+	/// copied as rows of whole runs, one per index of the dims before `dim`.
+	struct Copy {
+		size_t input;
+		TensorLayout source;
+		TensorLayout target;
+	};
+
+	TensorLayout out;
+	/// Empty inputs have no copy.
+	std::vector<Copy> copies;
+	/// Dtype every input is promoted to and the result has, see `promoteTypes`.
+	DType dtype;
+
+	static ConcatContext build(const std::vector<Tensor::View>& inputs, size_t dim);
+
+	/// Same as `build` for inputs of one shape joined along a new dim inserted before `dim`.
+	static ConcatContext buildStack(const std::vector<Tensor::View>& inputs, size_t dim);
 };
 
 }  // namespace semantic
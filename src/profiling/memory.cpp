@@ -0,0 +1,153 @@
+#include "profiling/memory.h"
+
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace profiling {
+
+namespace {
+
+struct BackendCounters {
+	std::atomic<uint64_t> liveBytes{0};
+	std::atomic<uint64_t> peakBytes{0};
+	std::atomic<uint64_t> numAllocations{0};
+	std::atomic<uint64_t> limit{0};
+
+	/// Peaks of the live `PeakMemoryScope`s. Allocations only take the mutex while there are any.
+	std::atomic<size_t> numScopes{0};
+	std::mutex scopeMutex;
+	std::vector<std::atomic<uint64_t>*> scopePeaks;
+};
+
+std::array<BackendCounters, 2> g_backends;
+
+BackendCounters& countersOf(Backend backend) { return g_backends[static_cast<size_t>(backend)]; }
+
+const char* nameOf(Backend backend) { return backend == Backend::CPU ? "CPU" : "CUDA"; }
+
+void raisePeak(std::atomic<uint64_t>& peak, uint64_t value) {
+	uint64_t current = peak.load(std::memory_order_relaxed);
+	while (current < value &&
+	       !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+}
+
+void reserve(Backend backend, size_t bytes) {
+	BackendCounters& counters = countersOf(backend);
+	uint64_t limit = counters.limit.load(std::memory_order_relaxed);
+
+	uint64_t live = counters.liveBytes.load(std::memory_order_relaxed);
+	uint64_t newLive;
+	do {
+		newLive = live + bytes;
+		if (limit != 0 && newLive > limit) {
+			throw std::runtime_error("NForge memory limit exceeded on " +
+			                         std::string(nameOf(backend)) + ": allocating " +
+			                         std::to_string(bytes) + " bytes with " +
+			                         std::to_string(live) + " bytes live, limit is " +
+			                         std::to_string(limit) + " bytes");
+		}
+	} while (!counters.liveBytes.compare_exchange_weak(live, newLive, std::memory_order_relaxed));
+
+	counters.numAllocations.fetch_add(1, std::memory_order_relaxed);
+	raisePeak(counters.peakBytes, newLive);
+
+	if (counters.numScopes.load(std::memory_order_acquire) > 0) {
+		std::lock_guard<std::mutex> lock(counters.scopeMutex);
+		for (std::atomic<uint64_t>* peak : counters.scopePeaks) raisePeak(*peak, newLive);
+	}
+}
+
+}  // namespace
+
+namespace detail {
+
+TrackedAllocation::TrackedAllocation(Backend backend, size_t bytes)
+    : m_backend(backend), m_bytes(bytes) {
+	reserve(m_backend, m_bytes);
+
+#ifdef NFORGE_WITH_STATS
+	m_opTracked = recordAllocation(m_bytes, m_op);
+#endif
+}
+
+TrackedAllocation::TrackedAllocation(const TrackedAllocation& other)
+    : TrackedAllocation(other.m_backend, other.m_bytes) {}
+
+TrackedAllocation::~TrackedAllocation() {
+	countersOf(m_backend).liveBytes.fetch_sub(m_bytes, std::memory_order_relaxed);
+
+#ifdef NFORGE_WITH_STATS
+	if (m_opTracked) {
+		recordFree(m_op, m_bytes);
+	}
+#endif
+}
+
+}  // namespace detail
+
+MemoryStats getMemoryStats(Backend backend) {
+	const BackendCounters& counters = countersOf(backend);
+
+	MemoryStats stats;
+	stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	stats.numAllocations = counters.numAllocations.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void resetPeakMemory(Backend backend) {
+	BackendCounters& counters = countersOf(backend);
+	counters.peakBytes.store(counters.liveBytes.load(std::memory_order_relaxed),
+	                         std::memory_order_relaxed);
+}
+
+void setMemoryLimit(Backend backend, uint64_t bytes) {
+	countersOf(backend).limit.store(bytes, std::memory_order_relaxed);
+}
+
+uint64_t getMemoryLimit(Backend backend) {
+	return countersOf(backend).limit.load(std::memory_order_relaxed);
+}
+
+PeakMemoryScope::PeakMemoryScope(Backend backend) : m_backend(backend) {
+	BackendCounters& counters = countersOf(m_backend);
+	std::lock_guard<std::mutex> lock(counters.scopeMutex);
+
+	m_startLive = counters.liveBytes.load(std::memory_order_relaxed);
+	m_startAllocations = counters.numAllocations.load(std::memory_order_relaxed);
+	m_peakBytes.store(m_startLive, std::memory_order_relaxed);
+
+	counters.scopePeaks.push_back(&m_peakBytes);
+	counters.numScopes.fetch_add(1, std::memory_order_release);
+}
+
+PeakMemoryScope::~PeakMemoryScope() {
+	BackendCounters& counters = countersOf(m_backend);
+	std::lock_guard<std::mutex> lock(counters.scopeMutex);
+
+	auto& peaks = counters.scopePeaks;
+	peaks.erase(std::find(peaks.begin(), peaks.end(), &m_peakBytes));
+	counters.numScopes.fetch_sub(1, std::memory_order_release);
+}
+
+uint64_t PeakMemoryScope::getPeakBytes() const {
+	return m_peakBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t PeakMemoryScope::getPeakIncrease() const {
+	uint64_t peak = getPeakBytes();
+	return peak > m_startLive ? peak - m_startLive : 0;
+}
+
+uint64_t PeakMemoryScope::getNumAllocations() const {
+	return countersOf(m_backend).numAllocations.load(std::memory_order_relaxed) -
+	       m_startAllocations;
+}
+
+}  // namespace profiling
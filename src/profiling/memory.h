@@ -0,0 +1,38 @@
+#ifndef PROFILING_MEMORY_H
+#define PROFILING_MEMORY_H
+
+#include <cstddef>
+
+#include "nforge/core/tensor.h"
+#include "nforge/profiling/memory_stats.h"
+#include "profiling/op_scope.h"
+
+namespace profiling {
+namespace detail {
+
+/// Accounts for one tensor buffer of `bytes` held by `backend` for its lifetime.
+///
+/// Construct it before allocating the buffer: the constructor throws std::runtime_error if the
+/// buffer would exceed the memory limit of the backend. Copies account for a buffer of their
+/// own. With NFORGE_WITH_STATS the bytes are also attributed to the running op.
+class TrackedAllocation {
+public:
+	TrackedAllocation(Backend backend, size_t bytes);
+	TrackedAllocation(const TrackedAllocation& other);
+	TrackedAllocation& operator=(const TrackedAllocation& other) = delete;
+	~TrackedAllocation();
+
+private:
+	Backend m_backend;
+	size_t m_bytes;
+
+#ifdef NFORGE_WITH_STATS
+	bool m_opTracked = false;
+	OpId m_op = OpId::Construct;
+#endif
+};
+
+}  // namespace detail
+}  // namespace profiling
+
+#endif  // PROFILING_MEMORY_H
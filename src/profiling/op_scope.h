@@ -0,0 +1,155 @@
+#ifndef PROFILING_OP_SCOPE_H
+#define PROFILING_OP_SCOPE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "nforge/profiling/op_stats.h"
+
+enum class UnaryOp;
+
+namespace profiling {
+namespace detail {
+
+/// One id per instrumented `Tensor::Impl` virtual. `Construct` collects allocations made outside
+/// of any op. Keep in sync with the name table in op_stats.cpp.
+enum class OpId : uint8_t {
+	Construct,
+	FillAll,
+	FillRandom,
+	Print,
+	ToVector,
+	ToString,
+	Clone,
+	CopyFromHost,
+	Set,
+	Compare,
+	Add,
+	Sub,
+	Mul,
+	Div,
+	IAdd,
+	ISub,
+	IMul,
+	IDiv,
+	MaskedFill,
+	Sum,
+	Min,
+	Max,
+	Prod,
+	Norm,
+	All,
+	Any,
+	CountNonzero,
+	ArgMin,
+	ArgMax,
+	TopK,
+	Sort,
+	Partition,
+	Scan,
+	Gather,
+	Scatter,
+	ReducePredicate,
+	Softmax,
+	LogSoftmax,
+	LogSumExp,
+	Exp,
+	Log,
+	Sqrt,
+	Rsqrt,
+	Abs,
+	Tanh,
+	Sigmoid,
+	Sin,
+	Cos,
+	Pow,
+	Clamp,
+	Matmul,
+	MatmulInt8,
+	Conv,
+	Equal,
+	NotEqual,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual,
+	IsClose,
+	Quantize,
+	Dequantize,
+	Cholesky,
+	LU,
+	QR,
+	SolveTriangular,
+	SparseConvert,
+	SparseElementwise,
+	SparseMatmul,
+	Count
+};
+
+extern std::atomic<bool> g_enabled;
+
+/// Id of the elementwise op `op`, e.g. `OpId::Exp` for `UnaryOp::Exp`.
+OpId getUnaryOpId(UnaryOp op);
+
+/// Counts one call of `op` and times it until destruction. Does nothing beyond one relaxed load
+/// when recording is disabled at runtime.
+class OpScope {
+public:
+	explicit OpScope(OpId op) {
+		if (g_enabled.load(std::memory_order_relaxed)) {
+			begin(op);
+		}
+	}
+
+	~OpScope() {
+		if (m_active) {
+			end();
+		}
+	}
+
+	OpScope(const OpScope&) = delete;
+	OpScope& operator=(const OpScope&) = delete;
+
+	bool isActive() const { return m_active; }
+
+	void addElements(uint64_t count);
+
+private:
+	bool m_active = false;
+	OpId m_op = OpId::Construct;
+	OpId m_previous = OpId::Construct;
+	std::chrono::steady_clock::time_point m_start;
+
+	void begin(OpId op);
+	void end();
+};
+
+/// Counts `bytes` as allocated by the op running on the calling thread and stores that op in
+/// `op`. Returns false without recording anything if recording is disabled.
+bool recordAllocation(size_t bytes, OpId& op);
+
+/// Counts `bytes` as freed by `op`, for allocations `recordAllocation` accepted.
+void recordFree(OpId op, size_t bytes);
+
+}  // namespace detail
+}  // namespace profiling
+
+#ifdef NFORGE_WITH_STATS
+/// Instruments the enclosing `Tensor::Impl` method as `op`. `elements` is only evaluated while
+/// recording.
+#define NFORGE_OP_SCOPE(op, elements)                                       \
+	profiling::detail::OpScope nforgeOpScope(profiling::detail::OpId::op); \
+	if (nforgeOpScope.isActive()) nforgeOpScope.addElements(elements)
+
+/// Instruments the enclosing method as the elementwise op `unaryOp`, see `NFORGE_OP_SCOPE`.
+#define NFORGE_UNARY_OP_SCOPE(unaryOp, elements)                                           \
+	profiling::detail::OpScope nforgeOpScope(profiling::detail::getUnaryOpId(unaryOp)); \
+	if (nforgeOpScope.isActive()) nforgeOpScope.addElements(elements)
+#else
+#define NFORGE_OP_SCOPE(op, elements) ((void)0)
+#define NFORGE_UNARY_OP_SCOPE(unaryOp, elements) ((void)0)
+#endif
+
+#endif  // PROFILING_OP_SCOPE_H
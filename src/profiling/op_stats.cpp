@@ -0,0 +1,182 @@
+#include "nforge/profiling/op_stats.h"
+
+#include <array>
+
+#include "nforge/core/tensor.h"
+#include "profiling/op_scope.h"
+
+namespace profiling {
+namespace detail {
+
+namespace {
+
+constexpr size_t NUM_OPS = static_cast<size_t>(OpId::Count);
+
+constexpr std::array<const char*, NUM_OPS> OP_NAMES = {
+    "construct", "fillAll", "fillRandom", "print", "toVector", "toString", "clone", "copyFromHost",
+    "set", "compare", "add", "sub", "mul", "div", "iadd", "isub", "imul", "idiv", "maskedFill",
+    "sum", "min", "max", "prod", "norm", "all", "any", "countNonzero", "argmin", "argmax", "topk",
+    "sort", "partition", "scan", "gather", "scatter", "reducePredicate", "softmax", "logSoftmax",
+    "logSumExp", "exp", "log", "sqrt", "rsqrt", "abs", "tanh", "sigmoid", "sin", "cos", "pow",
+    "clamp", "matmul", "matmulInt8", "conv", "equal", "notEqual", "less", "lessEqual", "greater",
+    "greaterEqual", "isClose", "quantize", "dequantize", "cholesky", "lu", "qr",
+    "solveTriangular", "sparseConvert", "sparseElementwise", "sparseMatmul"};
+
+static_assert(OP_NAMES[NUM_OPS - 1] != nullptr, "every OpId needs a name");
+
+struct OpCounters {
+	std::atomic<uint64_t> calls{0};
+	std::atomic<uint64_t> elements{0};
+	std::atomic<uint64_t> bytesAllocated{0};
+	std::atomic<uint64_t> bytesFreed{0};
+	std::atomic<uint64_t> nanoseconds{0};
+};
+
+std::array<OpCounters, NUM_OPS> g_counters;
+
+/// Innermost op running on this thread, allocations are attributed to it.
+thread_local OpId t_currentOp = OpId::Construct;
+
+OpCounters& countersOf(OpId op) { return g_counters[static_cast<size_t>(op)]; }
+
+void add(std::atomic<uint64_t>& counter, uint64_t value) {
+	counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+#ifdef NFORGE_WITH_STATS
+std::atomic<bool> g_enabled{true};
+#else
+std::atomic<bool> g_enabled{false};
+#endif
+
+OpId getUnaryOpId(UnaryOp op) {
+	switch (op) {
+		case UnaryOp::Exp:
+			return OpId::Exp;
+		case UnaryOp::Log:
+			return OpId::Log;
+		case UnaryOp::Sqrt:
+			return OpId::Sqrt;
+		case UnaryOp::Rsqrt:
+			return OpId::Rsqrt;
+		case UnaryOp::Abs:
+			return OpId::Abs;
+		case UnaryOp::Tanh:
+			return OpId::Tanh;
+		case UnaryOp::Sigmoid:
+			return OpId::Sigmoid;
+		case UnaryOp::Sin:
+			return OpId::Sin;
+		case UnaryOp::Cos:
+			return OpId::Cos;
+		case UnaryOp::Pow:
+			return OpId::Pow;
+		case UnaryOp::Clamp:
+			return OpId::Clamp;
+	}
+	return OpId::Construct;
+}
+
+void OpScope::begin(OpId op) {
+	m_active = true;
+	m_op = op;
+	m_previous = t_currentOp;
+	t_currentOp = op;
+
+	add(countersOf(op).calls, 1);
+	m_start = std::chrono::steady_clock::now();
+}
+
+void OpScope::end() {
+	auto elapsed = std::chrono::steady_clock::now() - m_start;
+	add(countersOf(m_op).nanoseconds,
+	    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+	t_currentOp = m_previous;
+}
+
+void OpScope::addElements(uint64_t count) { add(countersOf(m_op).elements, count); }
+
+bool recordAllocation(size_t bytes, OpId& op) {
+	if (!g_enabled.load(std::memory_order_relaxed)) {
+		return false;
+	}
+
+	op = t_currentOp;
+	add(countersOf(op).bytesAllocated, bytes);
+	return true;
+}
+
+void recordFree(OpId op, size_t bytes) { add(countersOf(op).bytesFreed, bytes); }
+
+}  // namespace detail
+
+bool isOpStatsAvailable() {
+#ifdef NFORGE_WITH_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void setOpStatsEnabled(bool enabled) {
+	detail::g_enabled.store(enabled && isOpStatsAvailable(), std::memory_order_relaxed);
+}
+
+bool isOpStatsEnabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+
+OpStatsSnapshot getOpStats() {
+	OpStatsSnapshot snapshot;
+
+	for (size_t i = 0; i < detail::NUM_OPS; i++) {
+		const detail::OpCounters& counters = detail::g_counters[i];
+
+		OpStats stats;
+		stats.calls = counters.calls.load(std::memory_order_relaxed);
+		stats.elements = counters.elements.load(std::memory_order_relaxed);
+		stats.bytesAllocated = counters.bytesAllocated.load(std::memory_order_relaxed);
+		stats.bytesFreed = counters.bytesFreed.load(std::memory_order_relaxed);
+		stats.nanoseconds = counters.nanoseconds.load(std::memory_order_relaxed);
+
+		if (stats.calls != 0 || stats.bytesAllocated != 0 || stats.bytesFreed != 0) {
+			snapshot[detail::OP_NAMES[i]] = stats;
+		}
+	}
+
+	return snapshot;
+}
+
+void resetOpStats() {
+	for (detail::OpCounters& counters : detail::g_counters) {
+		counters.calls.store(0, std::memory_order_relaxed);
+		counters.elements.store(0, std::memory_order_relaxed);
+		counters.bytesAllocated.store(0, std::memory_order_relaxed);
+		counters.bytesFreed.store(0, std::memory_order_relaxed);
+		counters.nanoseconds.store(0, std::memory_order_relaxed);
+	}
+}
+
+std::string toJson(const OpStatsSnapshot& stats) {
+	std::string out = "{";
+
+	bool first = true;
+	for (const auto& [name, op] : stats) {
+		out += first ? "\n" : ",\n";
+		first = false;
+
+		out += "  \"" + name + "\": {";
+		out += "\"calls\": " + std::to_string(op.calls);
+		out += ", \"elements\": " + std::to_string(op.elements);
+		out += ", \"bytesAllocated\": " + std::to_string(op.bytesAllocated);
+		out += ", \"bytesFreed\": " + std::to_string(op.bytesFreed);
+		out += ", \"nanoseconds\": " + std::to_string(op.nanoseconds);
+		out += "}";
+	}
+
+	out += first ? "}" : "\n}";
+	return out;
+}
+
+}  // namespace profiling
@@ -0,0 +1,31 @@
+#include "rng/philox.h"
+
+#include <atomic>
+
+namespace rng {
+
+namespace {
+
+/// Seed used until `setGlobalSeed` is called, fills are reproducible across runs by default.
+constexpr uint64_t DEFAULT_SEED = 0x4E466F726765ull;
+
+std::atomic<uint64_t> g_seed{DEFAULT_SEED};
+std::atomic<uint64_t> g_offset{0};
+
+}  // namespace
+
+void setGlobalSeed(uint64_t seed) {
+	g_seed.store(seed, std::memory_order_relaxed);
+	g_offset.store(0, std::memory_order_relaxed);
+}
+
+uint64_t getGlobalSeed() { return g_seed.load(std::memory_order_relaxed); }
+
+Stream reserveGlobal(uint64_t blocks) {
+	Stream stream;
+	stream.seed = g_seed.load(std::memory_order_relaxed);
+	stream.offset = g_offset.fetch_add(blocks, std::memory_order_relaxed);
+	return stream;
+}
+
+}  // namespace rng
@@ -0,0 +1,260 @@
+#ifndef RNG_PHILOX_H
+#define RNG_PHILOX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef NFORGE_HOST_DEVICE
+#ifdef __CUDACC__
+#define NFORGE_HOST_DEVICE __host__ __device__
+#else
+#define NFORGE_HOST_DEVICE
+#endif
+#endif
+
+/// Counter based random number generation.
+///
+/// Philox4x32-10 maps a 128 bit counter and a 64 bit key to 128 random bits without any state.
+/// Element `i` of a fill is generated from block `offset + i / 4` of a stream, so every element
+/// can be computed independently of all others: output does not depend on how a fill is split
+/// across threads or SIMD lanes. Backends produce the same bits, normal values may still differ in
+/// the last place since the CUDA math functions round differently.
+namespace rng {
+
+/// A stream of 128 bit blocks, `seed` is the Philox key and `offset` the first block counter.
+struct Stream {
+	uint64_t seed = 0;
+	uint64_t offset = 0;
+};
+
+enum class DistributionKind : uint8_t {
+	/// Uniform in [a, b).
+	Uniform,
+	/// Normal with mean a and standard deviation b.
+	Normal,
+	/// 1 with probability a, else 0.
+	Bernoulli
+};
+
+struct Distribution {
+	DistributionKind kind = DistributionKind::Uniform;
+	float a = 0.0f;
+	float b = 1.0f;
+};
+
+/// Every distribution turns one block into this many elements.
+constexpr size_t ELEMENTS_PER_BLOCK = 4;
+
+/// Number of blocks a fill of `count` elements consumes.
+constexpr uint64_t numBlocks(size_t count) {
+	return (count + ELEMENTS_PER_BLOCK - 1) / ELEMENTS_PER_BLOCK;
+}
+
+/// 128 random bits.
+struct Block {
+	uint32_t words[4];
+
+	NFORGE_HOST_DEVICE uint32_t operator[](int i) const { return words[i]; }
+};
+
+/// Philox4x32 with 10 rounds, as specified by Salmon et al., "Parallel Random Numbers: As Easy as
+/// 1, 2, 3" (SC11).
+NFORGE_HOST_DEVICE inline Block philox4x32(Block counter, uint32_t key0, uint32_t key1) {
+	constexpr uint64_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+	constexpr uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+
+	uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+
+	for (int round = 0; round < 10; round++) {
+		uint64_t p0 = M0 * c0;
+		uint64_t p1 = M1 * c2;
+
+		c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ key0;
+		c1 = static_cast<uint32_t>(p1);
+		c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ key1;
+		c3 = static_cast<uint32_t>(p0);
+
+		key0 += W0;
+		key1 += W1;
+	}
+
+	return {{c0, c1, c2, c3}};
+}
+
+/// Random bits of block `index` of `stream`.
+NFORGE_HOST_DEVICE inline Block generateBits(const Stream& stream, uint64_t index) {
+	uint64_t counter = stream.offset + index;
+	Block block = {{static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32), 0, 0}};
+	return philox4x32(block, static_cast<uint32_t>(stream.seed),
+	                  static_cast<uint32_t>(stream.seed >> 32));
+}
+
+/// Uniform in [0, 1) from the upper 24 bits, every value is exactly representable.
+NFORGE_HOST_DEVICE inline float toUnit(uint32_t bits) {
+	return (bits >> 8) * (1.0f / 16777216.0f);
+}
+
+/// Largest uniform value below `b`. `a + (b - a) * toUnit(bits)` can round up to `b` itself, so
+/// uniform values are clamped to this bound to stay in [a, b).
+NFORGE_HOST_DEVICE inline float uniformUpper(const Distribution& dist) {
+	return nextafterf(dist.b, dist.a);
+}
+
+/// Writes the `ELEMENTS_PER_BLOCK` elements of block `index` to `out`.
+NFORGE_HOST_DEVICE inline void generateBlock(const Stream& stream, const Distribution& dist,
+                                             uint64_t index, float* out) {
+	Block bits = generateBits(stream, index);
+
+	switch (dist.kind) {
+		case DistributionKind::Uniform: {
+			float upper = uniformUpper(dist);
+			for (int i = 0; i < 4; i++) {
+				float value = dist.a + (dist.b - dist.a) * toUnit(bits[i]);
+				out[i] = value < upper ? value : upper;
+			}
+			break;
+		}
+
+		case DistributionKind::Bernoulli:
+			for (int i = 0; i < 4; i++) out[i] = toUnit(bits[i]) < dist.a ? 1.0f : 0.0f;
+			break;
+
+		case DistributionKind::Normal:
+			// Box-Muller, every pair of uniforms gives two normals. u1 is in (0, 1] for the log.
+			for (int i = 0; i < 4; i += 2) {
+				float u1 = 1.0f - toUnit(bits[i]);
+				float u2 = toUnit(bits[i + 1]);
+
+				float radius = std::sqrt(-2.0f * std::log(u1));
+				float angle = 6.2831853071795864f * u2;
+
+				out[i] = dist.a + dist.b * radius * std::cos(angle);
+				out[i + 1] = dist.a + dist.b * radius * std::sin(angle);
+			}
+			break;
+	}
+}
+
+/// Blocks generated together by `fill`, lane `l` works on block `first + l`. Large enough for the
+/// compiler to vectorize across lanes instead of unrolling them.
+constexpr size_t FILL_LANES = 64;
+
+/// Writes blocks [first, first + FILL_LANES) to `out`. Same bits as `generateBlock` per block,
+/// but the rounds are interleaved across blocks so the compiler can vectorize them.
+inline void generateLanes(const Stream& stream, const Distribution& dist, uint64_t first,
+                          float* out) {
+	constexpr uint64_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+	constexpr uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+
+	uint32_t c0[FILL_LANES], c1[FILL_LANES], c2[FILL_LANES], c3[FILL_LANES];
+	for (size_t l = 0; l < FILL_LANES; l++) {
+		uint64_t counter = stream.offset + first + l;
+		c0[l] = static_cast<uint32_t>(counter);
+		c1[l] = static_cast<uint32_t>(counter >> 32);
+		c2[l] = 0;
+		c3[l] = 0;
+	}
+
+	uint32_t key0 = static_cast<uint32_t>(stream.seed);
+	uint32_t key1 = static_cast<uint32_t>(stream.seed >> 32);
+
+	for (int round = 0; round < 10; round++) {
+		for (size_t l = 0; l < FILL_LANES; l++) {
+			uint64_t p0 = M0 * c0[l];
+			uint64_t p1 = M1 * c2[l];
+
+			c0[l] = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ key0;
+			c1[l] = static_cast<uint32_t>(p1);
+			c2[l] = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ key1;
+			c3[l] = static_cast<uint32_t>(p0);
+		}
+		key0 += W0;
+		key1 += W1;
+	}
+
+	// transform word by word, then interleave into block order
+	float f0[FILL_LANES], f1[FILL_LANES], f2[FILL_LANES], f3[FILL_LANES];
+
+	switch (dist.kind) {
+		case DistributionKind::Uniform: {
+			float scale = dist.b - dist.a;
+			float upper = uniformUpper(dist);
+			for (size_t l = 0; l < FILL_LANES; l++) {
+				f0[l] = std::min(dist.a + scale * toUnit(c0[l]), upper);
+				f1[l] = std::min(dist.a + scale * toUnit(c1[l]), upper);
+				f2[l] = std::min(dist.a + scale * toUnit(c2[l]), upper);
+				f3[l] = std::min(dist.a + scale * toUnit(c3[l]), upper);
+			}
+			break;
+		}
+
+		case DistributionKind::Bernoulli:
+			for (size_t l = 0; l < FILL_LANES; l++) {
+				f0[l] = toUnit(c0[l]) < dist.a ? 1.0f : 0.0f;
+				f1[l] = toUnit(c1[l]) < dist.a ? 1.0f : 0.0f;
+				f2[l] = toUnit(c2[l]) < dist.a ? 1.0f : 0.0f;
+				f3[l] = toUnit(c3[l]) < dist.a ? 1.0f : 0.0f;
+			}
+			break;
+
+		case DistributionKind::Normal: {
+			// Box-Muller as in `generateBlock`. cos and sin get separate loops, otherwise they are
+			// merged into a sincos call that does not vectorize.
+			float r0[FILL_LANES], r1[FILL_LANES], a0[FILL_LANES], a1[FILL_LANES];
+			for (size_t l = 0; l < FILL_LANES; l++) {
+				r0[l] = dist.b * std::sqrt(-2.0f * std::log(1.0f - toUnit(c0[l])));
+				r1[l] = dist.b * std::sqrt(-2.0f * std::log(1.0f - toUnit(c2[l])));
+				a0[l] = 6.2831853071795864f * toUnit(c1[l]);
+				a1[l] = 6.2831853071795864f * toUnit(c3[l]);
+			}
+			for (size_t l = 0; l < FILL_LANES; l++) {
+				f0[l] = dist.a + r0[l] * std::cos(a0[l]);
+				f2[l] = dist.a + r1[l] * std::cos(a1[l]);
+			}
+			for (size_t l = 0; l < FILL_LANES; l++) {
+				f1[l] = dist.a + r0[l] * std::sin(a0[l]);
+				f3[l] = dist.a + r1[l] * std::sin(a1[l]);
+			}
+			break;
+		}
+	}
+
+	for (size_t l = 0; l < FILL_LANES; l++) {
+		out[4 * l + 0] = f0[l];
+		out[4 * l + 1] = f1[l];
+		out[4 * l + 2] = f2[l];
+		out[4 * l + 3] = f3[l];
+	}
+}
+
+/// Fills `data[0, count)` with the first `count` elements of `stream`.
+inline void fill(float* data, size_t count, const Distribution& dist, const Stream& stream) {
+	constexpr size_t CHUNK = FILL_LANES * ELEMENTS_PER_BLOCK;
+
+	size_t i = 0;
+	for (; i + CHUNK <= count; i += CHUNK) {
+		generateLanes(stream, dist, i / ELEMENTS_PER_BLOCK, data + i);
+	}
+
+	// the tail goes through the same path, vectorized math may round differently than scalar
+	if (i < count) {
+		float chunk[CHUNK];
+		generateLanes(stream, dist, i / ELEMENTS_PER_BLOCK, chunk);
+		std::copy(chunk, chunk + (count - i), data + i);
+	}
+}
+
+/// Seeds the global generator and restarts its stream at block 0.
+void setGlobalSeed(uint64_t seed);
+
+/// Returns the global seed.
+uint64_t getGlobalSeed();
+
+/// Reserves `blocks` consecutive blocks of the global stream, safe to call from any thread.
+Stream reserveGlobal(uint64_t blocks);
+
+}  // namespace rng
+
+#endif  // RNG_PHILOX_H
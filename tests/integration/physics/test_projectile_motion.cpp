@@ -35,4 +35,78 @@ TEST_CASE("Vertical throw", "[Physics]") {
 	REQUIRE(res.position.isClose(create2dVector(0, 0)).toVector()[0]);
 	REQUIRE(res.speed.isClose(create2dVector(0, 10)).toVector()[0]);
 	REQUIRE(res.t == 2.038034677505493);
-}
\ No newline at end of file
+}
+TEST_CASE("Diagonal throw, captured", "[Physics]") {
+	ProjectileMotionParams params;
+	params.angle = 45;  // degrees
+
+	ProjectileMotionResults eager = simulateProjectileMotion(params);
+	ProjectileMotionResults res = simulateProjectileMotionCaptured(params);
+
+	INFO(res.position.getDataString());
+	INFO(res.speed.getDataString());
+	INFO(res.t);
+
+	REQUIRE(res.position.isEqual(eager.position));
+	REQUIRE(res.speed.isEqual(eager.speed));
+	REQUIRE(res.t == eager.t);
+}
+
+TEST_CASE("Batched throws match single throws", "[Physics]") {
+	std::vector<float> angles = {10, 30, 45, 90};
+	std::vector<float> speeds = {10, 5, 10, 20};
+
+	ProjectileMotionBatchParams batchParams(angles.size());
+	batchParams.angle = makeLaneTensor(angles);
+	batchParams.initialSpeed = makeLaneTensor(speeds);
+
+	ProjectileMotionBatchResults res = simulateProjectileMotionBatch(batchParams);
+
+	REQUIRE(res.position.getShape() == Tensor::Shape({angles.size(), 2}));
+	REQUIRE(res.t.getShape() == Tensor::Shape({angles.size()}));
+
+	std::vector<float> t = res.t.toVector();
+	for (size_t i = 0; i < angles.size(); i++) {
+		ProjectileMotionParams params;
+		params.angle = angles[i];
+		params.initialSpeed = speeds[i];
+
+		ProjectileMotionResults single = simulateProjectileMotion(params);
+
+		INFO("lane " << i);
+		REQUIRE(res.position[i].isEqual(single.position));
+		REQUIRE(res.speed[i].isEqual(single.speed));
+		REQUIRE(t[i] == single.t);
+	}
+}
+
+TEST_CASE("Throw gradient matches finite differences", "[Physics]") {
+	ProjectileMotionParams params;
+	params.angle = 30;  // degrees
+
+	ProjectileMotionGradient res = simulateProjectileMotionGradient(params);
+
+	INFO("distance: " << res.distance);
+	INFO("d/dangle: " << res.dAngle << ", d/dspeed: " << res.dInitialSpeed
+	                  << ", d/dgrav: " << res.dGrav);
+
+	// central differences of the distance itself
+	auto distance = [](ProjectileMotionParams p) {
+		return simulateProjectileMotionGradient(p).distance;
+	};
+	auto difference = [&](float ProjectileMotionParams::*field, float eps) {
+		ProjectileMotionParams up = params, down = params;
+		up.*field += eps;
+		down.*field -= eps;
+		return (distance(up) - distance(down)) / (2 * eps);
+	};
+
+	REQUIRE(std::abs(res.distance - 8.83f) < 0.05f);
+	REQUIRE(std::abs(res.dAngle - difference(&ProjectileMotionParams::angle, 0.5f)) < 2e-3f);
+	REQUIRE(std::abs(res.dInitialSpeed -
+	                 difference(&ProjectileMotionParams::initialSpeed, 0.05f)) < 2e-2f);
+	REQUIRE(std::abs(res.dGrav - difference(&ProjectileMotionParams::grav, 0.05f)) < 2e-2f);
+
+	// the tape keeps the state between checkpoints, not every step
+	REQUIRE(res.savedBytes < 1024 * sizeof(float));
+}
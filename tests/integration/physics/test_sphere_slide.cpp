@@ -15,4 +15,44 @@ TEST_CASE("Cube slide of sphere", "[Physics]") {
 	REQUIRE(res.speed.isClose(create2dVector(1.20329, -1.30045)).toVector()[0]);
 
 	REQUIRE(res.t == 3.712913275f);
-}
\ No newline at end of file
+}
+TEST_CASE("Cube slide of sphere, captured", "[Physics]") {
+	SphereSlideResults eager = simulateSphereSlide(SphereSlideParams{});
+	SphereSlideResults res = simulateSphereSlideCaptured(SphereSlideParams{});
+
+	INFO(res.position.getDataString());
+	INFO(res.speed.getDataString());
+	INFO(res.t);
+
+	REQUIRE(res.position.isEqual(eager.position));
+	REQUIRE(res.speed.isEqual(eager.speed));
+	REQUIRE(res.t == eager.t);
+}
+
+TEST_CASE("Batched sphere slides match single slides", "[Physics]") {
+	std::vector<float> radii = {1, 2, 0.5};
+	std::vector<float> masses = {1, 3, 1};
+	std::vector<float> speeds = {0.001, 0.01, 0.1};
+
+	SphereSlideBatchParams batchParams(radii.size());
+	batchParams.radius = makeLaneTensor(radii);
+	batchParams.mass = makeLaneTensor(masses);
+	batchParams.initalXSpeed = makeLaneTensor(speeds);
+
+	SphereSlideBatchResults res = simulateSphereSlideBatch(batchParams);
+
+	std::vector<float> t = res.t.toVector();
+	for (size_t i = 0; i < radii.size(); i++) {
+		SphereSlideParams params;
+		params.radius = radii[i];
+		params.mass = masses[i];
+		params.initalXSpeed = speeds[i];
+
+		SphereSlideResults single = simulateSphereSlide(params);
+
+		INFO("lane " << i);
+		REQUIRE(res.position[i].isEqual(single.position));
+		REQUIRE(res.speed[i].isEqual(single.speed));
+		REQUIRE(t[i] == single.t);
+	}
+}
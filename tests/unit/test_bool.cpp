@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+TEST_CASE("Comparisons produce Bool tensors", "[Bool]") {
+	Tensor a({2, 3}, 1.0f);
+	a[1] = Tensor({3}, -1.0f);
+	Tensor b({3}, 0.0f);
+
+	uint64_t live = profiling::getMemoryStats(Backend::CPU).liveBytes;
+	Tensor mask = a > b;
+
+	REQUIRE(mask.getDType() == DType::Bool);
+	REQUIRE(profiling::getMemoryStats(Backend::CPU).liveBytes == live + 6);
+
+	Tensor expected({2, 3}, 0.0f);
+	expected[0] = Tensor({3}, 1.0f);
+	REQUIRE(tensor_equal(mask, expected));
+
+	REQUIRE((a == a).getDType() == DType::Bool);
+	REQUIRE(a.isClose(a).getDType() == DType::Bool);
+	REQUIRE(mask.getDataString() == "{ true true true false false false }");
+}
+
+TEST_CASE("Logical reductions over Bool masks", "[Bool]") {
+	// long enough to scan whole words, the odd element is placed in the tail or in a word
+	size_t length = GENERATE(1, 31, 32, 100);
+	size_t position = GENERATE(0, 1, 2);
+
+	Tensor x({3, length}, 1.0f);
+	size_t odd = (position * (length - 1)) / 2;
+	x.set({position, odd}, Tensor(0.0f));
+
+	Tensor mask = x != Tensor(0.0f);
+	REQUIRE(mask.getDType() == DType::Bool);
+
+	Tensor all = mask.all(1);
+	Tensor any = (x == Tensor(0.0f)).any(1);
+	REQUIRE(all.getDType() == DType::Bool);
+
+	for (size_t row = 0; row < 3; row++) {
+		bool hasZero = row == position;
+		REQUIRE(all.toVector()[row] == (hasZero ? 0.0f : 1.0f));
+		REQUIRE(any.toVector()[row] == (hasZero ? 1.0f : 0.0f));
+	}
+
+	REQUIRE(mask.all().toVector()[0] == 0.0f);
+	REQUIRE(mask.any().toVector()[0] == 1.0f);
+}
+
+TEST_CASE("Bool masks feed arithmetic and masked fills", "[Bool]") {
+	Tensor x({2, 4}, 3.0f);
+	x[0] = Tensor({4}, -2.0f);
+	Tensor mask = x > Tensor(0.0f);
+
+	SECTION("arithmetic reads masks as 0 / 1") {
+		Tensor scaled = mask * x;
+		REQUIRE(scaled.getDType() == DType::Float32);
+
+		Tensor expected({2, 4}, 3.0f);
+		expected[0] = Tensor({4}, 0.0f);
+		REQUIRE(tensor_equal(scaled, expected));
+
+		x *= mask;
+		REQUIRE(tensor_equal(x, expected));
+		REQUIRE(mask.sum().toVector()[0] == 4.0f);
+	}
+
+	SECTION("maskedFill") {
+		x.maskedFill(mask, 0.5f);
+
+		Tensor expected({2, 4}, 0.5f);
+		expected[0] = Tensor({4}, -2.0f);
+		REQUIRE(tensor_equal(x, expected));
+	}
+
+	SECTION("maskedFill broadcasts the mask") {
+		Tensor column({4}, DType::Bool);
+		column.set({2}, Tensor(1.0f));
+
+		x.maskedFill(column, 7.0f);
+		REQUIRE(x.toVector()[2] == 7.0f);
+		REQUIRE(x.toVector()[6] == 7.0f);
+		REQUIRE(x.sum().toVector()[0] == -6.0f + 9.0f + 14.0f);
+	}
+
+	SECTION("conversion") {
+		Tensor values({3}, 0.0f);
+		values.set({0}, Tensor(2.5f));
+
+		Tensor converted = values.asType(DType::Bool);
+		REQUIRE(converted.getDType() == DType::Bool);
+		REQUIRE(tensor_equal(converted, values != Tensor(0.0f)));
+
+		Tensor back = converted.asType(DType::Float32);
+		REQUIRE(back.getDType() == DType::Float32);
+		REQUIRE(back.toVector() == std::vector<float>{1.0f, 0.0f, 0.0f});
+	}
+}
+
+TEST_CASE("Graph capture of masks", "[Bool][Graph]") {
+	Tensor x({4}, 0.0f), y({4}, 0.0f);
+
+	Tensor::Graph graph = Tensor::Graph::capture({x, y}, [&]() {
+		y = x * (x > Tensor(0.0f));
+		y.maskedFill(x > Tensor(2.0f), 2.0f);
+	});
+
+	x.set({1}, Tensor(1.0f));
+	x.set({2}, Tensor(3.0f));
+	x.set({3}, Tensor(-1.0f));
+	graph.replay();
+
+	REQUIRE(y.toVector() == std::vector<float>{0.0f, 1.0f, 2.0f, 0.0f});
+
+	Tensor flag({4}, DType::Bool);
+	REQUIRE_THROWS_AS(Tensor::Graph::capture({flag}, []() {}), std::runtime_error);
+}
@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include <stdexcept>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+TEST_CASE("concat matches assigning slices", "[Concat]") {
+	auto backend = GENERATE(from_range(backends));
+	size_t dim = GENERATE(0, 1, 2);
+
+	DYNAMIC_SECTION(getBackendString(backend) << " dim " << dim) {
+		std::vector<size_t> dims = {3, 4, 5};
+		std::vector<Tensor> parts;
+		std::vector<Tensor::View> views;
+		for (size_t length : {2, 1, 3}) {
+			dims[dim] = length;
+			parts.push_back(iota(Tensor::Shape(dims), backend, 100.0f * parts.size()));
+		}
+		views.assign(parts.begin(), parts.end());
+
+		Tensor joined = Tensor::concat(views, dim);
+		dims[dim] = 6;
+		REQUIRE(joined.getShape() == Tensor::Shape(dims));
+
+		int64_t start = 0;
+		for (const Tensor& part : parts) {
+			int64_t length = (int64_t)part.getShape().getDim(dim);
+			REQUIRE(tensor_equal(joined.slice(dim, {start, start + length}).copy(), part));
+			start += length;
+		}
+	}
+}
+
+TEST_CASE("concat of views and dtypes", "[Concat]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a = iota({4, 6}, backend);
+
+		// a transposed view is copied through its layout, the contiguous row in one run
+		Tensor column = a.slice(1, {1, 2}).transpose(0, 1).copy();
+		Tensor joined = Tensor::concat({a.transpose(0, 1), column}, 0);
+		REQUIRE(joined.getShape() == Tensor::Shape({7, 4}));
+		REQUIRE(tensor_equal(joined.slice(0, {0, 6}).copy(), a.transpose(0, 1).copy()));
+		REQUIRE(joined[6].toVector() == joined[1].toVector());
+
+		// a reversed view and an empty one
+		Tensor::View reversed = a.slice(1, {std::nullopt, std::nullopt, -1});
+		Tensor::View empty = a.slice(1, {0, 0});
+		Tensor wide = Tensor::concat({a, empty, reversed}, 1);
+		REQUIRE(wide.getShape() == Tensor::Shape({4, 12}));
+		REQUIRE(wide[2].slice(0, {6, 12}).toVector() == reversed[2].toVector());
+
+		// dtypes promote like binary ops
+		Tensor ints = Tensor({2, 6}, 3.0f, backend).asType(DType::Int32);
+		Tensor mixed = Tensor::concat({ints, a}, 0);
+		REQUIRE(mixed.getDType() == DType::Float32);
+		REQUIRE(mixed[1].toVector() == std::vector<float>(6, 3.0f));
+		REQUIRE(Tensor::concat({ints, ints}, 1).getDType() == DType::Int32);
+	}
+}
+
+TEST_CASE("stack builds a batch from rows", "[Concat]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor table = iota({100, 16}, backend);
+
+		std::vector<Tensor::View> rows;
+		for (size_t i = 0; i < 100; i += 7) rows.push_back(table[i]);
+
+		Tensor batch = Tensor::stack(rows);
+		REQUIRE(batch.getShape() == Tensor::Shape({15, 16}));
+		for (size_t r = 0; r < rows.size(); r++) {
+			REQUIRE(batch[r].toVector() == table[r * 7].toVector());
+		}
+
+		// along the last dim the rows become columns
+		Tensor columns = Tensor::stack(rows, 1);
+		REQUIRE(columns.getShape() == Tensor::Shape({16, 15}));
+		REQUIRE(tensor_equal(columns, batch.transpose(0, 1).copy()));
+	}
+}
+
+TEST_CASE("concat splits inputs and long runs over threads", "[Concat]") {
+	// thousands of short rows group into few ranges
+	Tensor table = iota({3000, 64});
+	std::vector<Tensor::View> rows;
+	for (size_t i = 3000; i-- > 0;) rows.push_back(table[i]);
+
+	Tensor batch = Tensor::stack(rows);
+	for (size_t r : {size_t{0}, size_t{1234}, size_t{2999}}) {
+		REQUIRE(batch[r].toVector() == table[2999 - r].toVector());
+	}
+
+	// long runs split into chunks, also through a strided view and a conversion
+	Tensor line = iota({100000});
+	Tensor::View strided = line.subsample({2});
+	Tensor ints = line.asType(DType::Int32);
+
+	Tensor joined = Tensor::concat({line, strided, ints}, 0);
+	REQUIRE(joined.getShape() == Tensor::Shape({250000}));
+	REQUIRE(tensor_equal(joined.slice(0, {0, 100000}).copy(), line));
+	REQUIRE(tensor_equal(joined.slice(0, {100000, 150000}).copy(), strided.copy()));
+	REQUIRE(tensor_equal(joined.slice(0, {150000, 250000}).copy(), line));
+}
+
+TEST_CASE("concat and stack errors", "[Concat]") {
+	Tensor a({2, 3});
+	Tensor b({2, 4});
+
+	REQUIRE_THROWS_AS(Tensor::concat({}, 0), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::concat({a, b}, 0), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::concat({a, b}, 2), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::concat({a, Tensor({2, 3, 1})}, 1), std::runtime_error);
+	REQUIRE(Tensor::concat({a, b}, 1).getShape() == Tensor::Shape({2, 7}));
+
+	REQUIRE_THROWS_AS(Tensor::stack({a, b}), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::stack({a, a}, 3), std::runtime_error);
+	REQUIRE(Tensor::stack({a, a}, 2).getShape() == Tensor::Shape({2, 3, 2}));
+}
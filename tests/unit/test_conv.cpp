@@ -0,0 +1,158 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Geometry of a reference convolution, 1D ones have height and kernel height 1.
+struct ConvCase {
+	size_t batch, inChannels, outChannels, height, width, kernelHeight, kernelWidth;
+	size_t stride, padding, dilation;
+};
+
+/// Output extent of a convolution along one dim.
+static size_t outExtent(size_t input, size_t kernel, size_t stride, size_t padding,
+                        size_t dilation) {
+	return (input + 2 * padding - dilation * (kernel - 1) - 1) / stride + 1;
+}
+
+/// Direct convolution in double of row-major `input` and `weight`, padding only the width if
+/// `is1d`.
+static std::vector<double> referenceConv(const std::vector<float>& input,
+                                         const std::vector<float>& weight, const ConvCase& c,
+                                         bool is1d) {
+	size_t padY = is1d ? 0 : c.padding;
+	size_t strideY = is1d ? 1 : c.stride;
+	size_t dilationY = is1d ? 1 : c.dilation;
+	size_t outHeight = outExtent(c.height, c.kernelHeight, strideY, padY, dilationY);
+	size_t outWidth = outExtent(c.width, c.kernelWidth, c.stride, c.padding, c.dilation);
+
+	std::vector<double> out(c.batch * c.outChannels * outHeight * outWidth, 0.0);
+	size_t p = 0;
+	for (size_t n = 0; n < c.batch; n++) {
+		for (size_t o = 0; o < c.outChannels; o++) {
+			for (size_t oy = 0; oy < outHeight; oy++) {
+				for (size_t ox = 0; ox < outWidth; ox++, p++) {
+					double acc = 0.0;
+					for (size_t ci = 0; ci < c.inChannels; ci++) {
+						for (size_t ky = 0; ky < c.kernelHeight; ky++) {
+							for (size_t kx = 0; kx < c.kernelWidth; kx++) {
+								long y = (long)(oy * strideY + ky * dilationY) - (long)padY;
+								long x = (long)(ox * c.stride + kx * c.dilation) - (long)c.padding;
+								if (y < 0 || y >= (long)c.height || x < 0 || x >= (long)c.width) {
+									continue;
+								}
+								size_t in = ((n * c.inChannels + ci) * c.height + y) * c.width + x;
+								size_t w = ((o * c.inChannels + ci) * c.kernelHeight + ky) *
+								               c.kernelWidth +
+								           kx;
+								acc += (double)input[in] * weight[w];
+							}
+						}
+					}
+					out[p] = acc;
+				}
+			}
+		}
+	}
+	return out;
+}
+
+/// True if every element of `actual` is within `tolerance` of `expected`.
+static bool allWithin(const std::vector<float>& actual, const std::vector<double>& expected,
+                      double tolerance) {
+	if (actual.size() != expected.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < actual.size(); i++) {
+		if (std::abs(actual[i] - expected[i]) > tolerance) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("conv1d matches a reference", "[Conv]") {
+	// 5 taps on one channel take the direct path, 16 channels times 5 taps the matmul
+	size_t inChannels = GENERATE(1, 3, 16);
+	size_t stride = GENERATE(1, 2);
+	size_t padding = GENERATE(0, 2);
+	size_t dilation = GENERATE(1, 3);
+	ConvCase c{2, inChannels, 4, 1, 700, 1, 5, stride, padding, dilation};
+
+	Tensor x({c.batch, c.inChannels, c.width});
+	x.fillUniform(-1.0f, 1.0f, 1);
+	Tensor w({c.outChannels, c.inChannels, c.kernelWidth});
+	w.fillUniform(-1.0f, 1.0f, 2);
+
+	Tensor y = x.conv1d(w, stride, padding, dilation);
+	size_t outWidth = outExtent(c.width, c.kernelWidth, stride, padding, dilation);
+	REQUIRE(y.getShape() == Tensor::Shape({c.batch, c.outChannels, outWidth}));
+	REQUIRE(allWithin(y.toVector(), referenceConv(x.toVector(), w.toVector(), c, true), 1e-4));
+}
+
+TEST_CASE("conv2d matches a reference", "[Conv]") {
+	// 3x3 on 2 channels is direct, on 8 channels it lowers to im2col and matmul
+	size_t inChannels = GENERATE(2, 8);
+	size_t kernel = GENERATE(1, 3, 5);
+	size_t stride = GENERATE(1, 2);
+	size_t padding = GENERATE(0, 1);
+	size_t dilation = GENERATE(1, 2);
+	ConvCase c{2, inChannels, 5, 19, 23, kernel, kernel, stride, padding, dilation};
+
+	Tensor x({c.batch, c.inChannels, c.height, c.width});
+	x.fillUniform(-1.0f, 1.0f, 3);
+	Tensor w({c.outChannels, c.inChannels, kernel, kernel});
+	w.fillUniform(-1.0f, 1.0f, 4);
+
+	Tensor y = x.conv2d(w, stride, padding, dilation);
+	REQUIRE(y.getShape() == Tensor::Shape({c.batch, c.outChannels,
+	                                       outExtent(c.height, kernel, stride, padding, dilation),
+	                                       outExtent(c.width, kernel, stride, padding, dilation)}));
+	REQUIRE(allWithin(y.toVector(), referenceConv(x.toVector(), w.toVector(), c, false), 1e-4));
+}
+
+TEST_CASE("conv dtypes and views", "[Conv]") {
+	SECTION("integers convolve exactly") {
+		Tensor x({1, 1, 6}, 2.0f);
+		x.set({0, 0, 3}, Tensor(-5.0f));
+		Tensor w({1, 1, 3}, 1.0f);
+
+		Tensor y = x.asType(DType::Int32).conv1d(w.asType(DType::Int32), 1, 1);
+		REQUIRE(y.getDType() == DType::Int32);
+		REQUIRE(y.toVector() == std::vector<float>{4.0f, 6.0f, -1.0f, -1.0f, -1.0f, 4.0f});
+	}
+
+	SECTION("16 bit floats keep their dtype") {
+		Tensor x({1, 2, 8, 8}, 0.5f);
+		Tensor w({3, 2, 3, 3}, 0.25f);
+		Tensor y = x.asType(DType::Float16).conv2d(w.asType(DType::Float16));
+		REQUIRE(y.getDType() == DType::Float16);
+		REQUIRE(y.toVector() == std::vector<float>(3 * 6 * 6, 2.25f));
+	}
+
+	SECTION("strided inputs and weights") {
+		Tensor parent({2, 4, 12, 12});
+		parent.fillUniform(-1.0f, 1.0f, 5);
+		Tensor weightParent({6, 4, 3, 6});
+		weightParent.fillUniform(-1.0f, 1.0f, 6);
+
+		Tensor::View x = parent.subsample({1, 1, 2, 1});
+		Tensor::View w = weightParent.subsample({2, 1, 1, 2});
+		Tensor expected = x.copy().conv2d(w.copy(), 1, 1);
+		REQUIRE(x.copy().conv2d(w, 1, 1).allClose(expected));
+		REQUIRE(parent.conv2d(w, 2).getShape() == Tensor::Shape({2, 3, 5, 5}));
+	}
+}
+
+TEST_CASE("conv errors", "[Conv]") {
+	Tensor x({1, 2, 10});
+	REQUIRE_THROWS_AS(x.conv1d(Tensor({4, 3, 3})), std::runtime_error);
+	REQUIRE_THROWS_AS(x.conv1d(Tensor({4, 2, 11})), std::runtime_error);
+	REQUIRE_THROWS_AS(x.conv1d(Tensor({4, 2, 3}), 0), std::runtime_error);
+	REQUIRE_THROWS_AS(x.conv2d(Tensor({4, 2, 3})), std::runtime_error);
+	REQUIRE(x.conv1d(Tensor({4, 2, 11}), 1, 1).getShape() == Tensor::Shape({1, 4, 2}));
+}
@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+TEST_CASE("Type promotion", "[DType]") {
+	REQUIRE(promoteTypes(DType::Float32, DType::Float64) == DType::Float64);
+	REQUIRE(promoteTypes(DType::Float16, DType::BFloat16) == DType::Float32);
+	REQUIRE(promoteTypes(DType::Int64, DType::Float16) == DType::Float16);
+	REQUIRE(promoteTypes(DType::Int8, DType::Int32) == DType::Int32);
+	REQUIRE(promoteTypes(DType::Int8, DType::UInt8) == DType::Int32);
+	REQUIRE(promoteTypes(DType::Bool, DType::UInt8) == DType::UInt8);
+
+	Tensor half({4}, DType::Float16);
+	Tensor ints({4}, DType::Int32);
+	Tensor doubles({4}, DType::Float64);
+
+	SECTION("tensors") {
+		REQUIRE((half + Tensor({4}, 1.0f)).getDType() == DType::Float32);
+		REQUIRE((ints + doubles).getDType() == DType::Float64);
+		REQUIRE((ints * Tensor({4}, DType::Int64)).getDType() == DType::Int64);
+		REQUIRE((ints < doubles).getDType() == DType::Bool);
+		Tensor matrix({2, 4}, DType::Int32);
+		REQUIRE(matrix.matmul(Tensor({4, 2}, DType::Int8)).getDType() == DType::Int32);
+	}
+
+	SECTION("scalars only promote into a higher category") {
+		REQUIRE((half * 0.5f).getDType() == DType::Float16);
+		REQUIRE((2.0f * doubles).getDType() == DType::Float64);
+		REQUIRE((ints + 1.0f).getDType() == DType::Float32);
+		REQUIRE((ints + Tensor(Tensor::Shape(), DType::Int64)).getDType() == DType::Int32);
+	}
+
+	SECTION("division is true division") {
+		REQUIRE((ints / ints).getDType() == DType::Float32);
+		REQUIRE_THROWS_AS(ints /= ints, std::runtime_error);
+	}
+
+	SECTION("in-place results must fit the target") {
+		REQUIRE_THROWS_AS(ints += Tensor({4}, 1.0f), std::runtime_error);
+		REQUIRE_NOTHROW(half += doubles);
+		REQUIRE(half.getDType() == DType::Float16);
+	}
+
+	SECTION("reductions") {
+		REQUIRE(ints.sum().getDType() == DType::Int64);
+		REQUIRE(half.sum().getDType() == DType::Float32);
+		REQUIRE(half.max().getDType() == DType::Float16);
+		REQUIRE(doubles.norm().getDType() == DType::Float64);
+		REQUIRE(ints.mean().getDType() == DType::Float32);
+	}
+}
+
+TEST_CASE("Integer arithmetic is exact", "[DType]") {
+	// 2^40 + 1 is not representable as a float
+	Tensor big({3}, DType::Int64);
+	big.fillAll(1099511627776.0f);
+	big += Tensor(1.0f).asType(DType::Int64);
+
+	Tensor ones({3}, DType::Int64);
+	ones.fillAll(1.0f);
+	Tensor base = Tensor({3}, 1099511627776.0f).asType(DType::Int64);
+	REQUIRE((big - base == ones).all().toVector()[0] == 1.0f);
+
+	SECTION("narrow types wrap") {
+		Tensor bytes({2}, DType::UInt8);
+		bytes.fillAll(200.0f);
+		REQUIRE((bytes + bytes).toVector() == std::vector<float>{144.0f, 144.0f});
+		REQUIRE((bytes + bytes).getDataString() == "{ 144 144 }");
+	}
+
+	SECTION("sums widen") {
+		Tensor bytes({100}, DType::Int8);
+		bytes.fillAll(100.0f);
+		REQUIRE(bytes.sum().toVector()[0] == 10000.0f);
+	}
+}
+
+TEST_CASE("Typed toVector keeps every bit", "[DType]") {
+	// 2^24 + 1 and 2^40 + 1 round away as floats
+	Tensor ints = Tensor({2}, 16777216.0f).asType(DType::Int64);
+	ints[1] = Tensor(1099511627776.0f).asType(DType::Int64);
+	ints += Tensor(1.0f).asType(DType::Int64);
+	REQUIRE(ints.toVector<int64_t>() == std::vector<int64_t>{16777217, 1099511627777});
+	REQUIRE(ints.toVector()[0] == 16777216.0f);
+
+	// a third in double precision comes back unchanged, through a view as well
+	Tensor thirds = Tensor({2, 2}, 1.0f).asType(DType::Float64) / Tensor(3.0f);
+	REQUIRE(thirds.getDType() == DType::Float64);
+	REQUIRE(thirds.toVector<double>() == std::vector<double>(4, 1.0 / 3.0));
+	REQUIRE(thirds[1].toVector<double>() == std::vector<double>(2, 1.0 / 3.0));
+
+	Tensor flags = Tensor({3}, 1.0f).asType(DType::Bool);
+	flags[1] = Tensor(0.0f).asType(DType::Bool);
+	REQUIRE(flags.toVector<bool>() == std::vector<bool>{true, false, true});
+
+	REQUIRE_THROWS_AS(ints.toVector<int32_t>(), std::runtime_error);
+	REQUIRE_THROWS_AS(thirds.toVector<float>(), std::runtime_error);
+}
+
+TEST_CASE("16 bit floats round to nearest even", "[DType]") {
+	DType dtype = GENERATE(DType::Float16, DType::BFloat16);
+
+	Tensor third({1}, 1.0f / 3.0f);
+	Tensor stored = third.asType(dtype);
+	REQUIRE(stored.getDType() == dtype);
+
+	float expected = dtype == DType::Float16 ? 0.333251953125f : 0.333984375f;
+	REQUIRE(stored.toVector()[0] == expected);
+
+	// one past halfway between 1 and the next value rounds up, halfway rounds to the even 1
+	float ulp = dtype == DType::Float16 ? 1.0f / 1024.0f : 1.0f / 128.0f;
+	Tensor halfway({2}, 1.0f);
+	halfway.set({0}, Tensor(1.0f + ulp / 2.0f));
+	halfway.set({1}, Tensor(1.0f + ulp * 1.5f));
+	REQUIRE(halfway.asType(dtype).toVector() == std::vector<float>{1.0f, 1.0f + 2.0f * ulp});
+
+	// values keep their category through arithmetic
+	Tensor sum = stored + stored;
+	REQUIRE(sum.getDType() == dtype);
+	REQUIRE(sum.toVector()[0] == 2.0f * expected);
+
+	// sums past 2^8 are not representable step by step in bfloat16, so both accumulate in float
+	Tensor ones = Tensor({1, 1024}, 1.0f).asType(dtype);
+	REQUIRE(ones.sum().toVector()[0] == 1024.0f);
+	Tensor column = Tensor({1024, 3}, 1.0f).asType(dtype);
+	REQUIRE(ones.matmul(column).toVector() == std::vector<float>{1024.0f, 1024.0f, 1024.0f});
+
+	Tensor large({1}, 1.0e6f);
+	float converted = large.asType(dtype).toVector()[0];
+	if (dtype == DType::Float16) {
+		REQUIRE(std::isinf(converted));
+	} else {
+		REQUIRE(converted == 999424.0f);
+	}
+
+	Tensor tiny({1}, 1.0e-7f);
+	float subnormal = tiny.asType(DType::Float16).toVector()[0];
+	REQUIRE(subnormal == std::ldexp(2.0f, -24));
+}
+
+TEST_CASE("Dtypes set storage size", "[DType]") {
+	DType dtype = GENERATE(DType::Float64, DType::Float16, DType::BFloat16, DType::Int64,
+	                       DType::Int32, DType::Int8, DType::UInt8);
+
+	uint64_t live = profiling::getMemoryStats(Backend::CPU).liveBytes;
+	Tensor t({4, 8}, dtype);
+	REQUIRE(profiling::getMemoryStats(Backend::CPU).liveBytes == live + 32 * getDTypeSize(dtype));
+
+	// small integers survive every dtype
+	t.fillAll(3.0f);
+	t[1] = Tensor({8}, -1.0f).asType(dtype == DType::UInt8 ? DType::Bool : dtype);
+
+	float second = dtype == DType::UInt8 ? 1.0f : -1.0f;
+	REQUIRE(t.sum().toVector()[0] == 24.0f * 3.0f + 8.0f * second);
+	REQUIRE(t.max().getDType() == dtype);
+	REQUIRE(t.max().toVector()[0] == 3.0f);
+	REQUIRE(tensor_equal(t.asType(DType::Float32).asType(dtype), t));
+}
@@ -0,0 +1,212 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Uniform integers in [0, high) of dtype `dtype`.
+static Tensor randomIndices(const Tensor::Shape& shape, size_t high, DType dtype, uint64_t seed) {
+	Tensor values(shape);
+	values.fillUniform(0.0f, static_cast<float>(high) - 0.01f, seed);
+	return values.asType(dtype);
+}
+
+/// Element of the row-major `values` of shape `shape` at `coords`.
+static float at(const std::vector<float>& values, const Tensor::Shape& shape,
+                const std::vector<size_t>& coords) {
+	size_t linear = 0;
+	for (size_t d = 0; d < coords.size(); d++) linear = linear * shape.getDim(d) + coords[d];
+	return values[linear];
+}
+
+TEST_CASE("gather matches a reference", "[Gather]") {
+	size_t dim = GENERATE(0, 1, 2);
+	DType indexType = GENERATE(DType::Int64, DType::Int32, DType::UInt8);
+
+	Tensor x({4, 5, 6});
+	x.fillUniform(-1.0f, 1.0f, 3);
+	std::vector<float> values = x.toVector();
+
+	// shorter than x along every dim, longer along the gathered one
+	std::vector<size_t> dims = {3, 4, 5};
+	dims[dim] = 9;
+	Tensor::Shape indexShape(dims);
+	Tensor index = randomIndices(indexShape, x.getShape().getDim(dim), indexType, 17);
+
+	Tensor out = x.gather(dim, index);
+	REQUIRE(out.getShape() == indexShape);
+	REQUIRE(out.getDType() == DType::Float32);
+
+	std::vector<float> indices = index.toVector();
+	std::vector<float> result = out.toVector();
+	size_t p = 0;
+	for (size_t i = 0; i < dims[0]; i++) {
+		for (size_t j = 0; j < dims[1]; j++) {
+			for (size_t k = 0; k < dims[2]; k++, p++) {
+				std::vector<size_t> coords = {i, j, k};
+				coords[dim] = static_cast<size_t>(indices[p]);
+				REQUIRE(result[p] == at(values, x.getShape(), coords));
+			}
+		}
+	}
+}
+
+TEST_CASE("indexSelect copies slices", "[Gather]") {
+	Tensor table({10, 16});
+	table.fillUniform(-1.0f, 1.0f, 5);
+
+	Tensor ids({4}, DType::Int64);
+	ids.set({0}, Tensor(7.0f));
+	ids.set({1}, Tensor(2.0f));
+	ids.set({2}, Tensor(7.0f));
+	ids.set({3}, Tensor(0.0f));
+
+	Tensor rows = table.indexSelect(0, ids);
+	REQUIRE(rows.getShape() == Tensor::Shape({4, 16}));
+	REQUIRE(tensor_equal(rows[0].copy(), table[7].copy()));
+	REQUIRE(tensor_equal(rows[1].copy(), table[2].copy()));
+	REQUIRE(tensor_equal(rows[2].copy(), table[7].copy()));
+	REQUIRE(tensor_equal(rows[3].copy(), table[0].copy()));
+
+	// columns of a strided view, the index read through a view as well
+	Tensor::View even = table.subsample({1, 2});
+	Tensor cols = even.indexSelect(1, ids.subsample({2}));
+	REQUIRE(cols.getShape() == Tensor::Shape({10, 2}));
+	std::vector<float> values = table.toVector();
+	std::vector<float> picked = cols.toVector();
+	for (size_t r = 0; r < 10; r++) {
+		REQUIRE(picked[r * 2] == values[r * 16 + 14]);
+		REQUIRE(picked[r * 2 + 1] == values[r * 16 + 14]);
+	}
+
+	REQUIRE(table.indexSelect(0, Tensor({0}, DType::Int64)).getShape() ==
+	        Tensor::Shape({0, 16}));
+}
+
+TEST_CASE("scatter inverts gather", "[Gather]") {
+	Tensor x({3, 8}, 0.0f);
+	Tensor src({3, 8});
+	src.fillUniform(1.0f, 2.0f, 9);
+
+	// a permutation of each row, so every element is written once
+	Tensor keys({3, 8});
+	keys.fillUniform(0.0f, 1.0f, 4);
+	Tensor perm = keys.argsort(1);
+
+	x.scatter(1, perm, src);
+	REQUIRE(tensor_equal(x.gather(1, perm), src));
+
+	SECTION("repeated indices keep the last write") {
+		Tensor row({1, 5}, 0.0f);
+		Tensor index({1, 3}, DType::Int32);
+		index.set({0, 0}, Tensor(4.0f));
+		index.set({0, 1}, Tensor(1.0f));
+		index.set({0, 2}, Tensor(4.0f));
+		Tensor values({1, 3});
+		values.set({0, 0}, Tensor(1.0f));
+		values.set({0, 1}, Tensor(2.0f));
+		values.set({0, 2}, Tensor(3.0f));
+
+		row.scatter(1, index, values);
+		REQUIRE(row.toVector() == std::vector<float>{0.0f, 2.0f, 0.0f, 0.0f, 3.0f});
+
+		// a scalar source broadcasts
+		row.scatter(1, index, Tensor(-1.0f));
+		REQUIRE(row.toVector() == std::vector<float>{0.0f, -1.0f, 0.0f, 0.0f, -1.0f});
+	}
+}
+
+TEST_CASE("scatterAdd sums repeated indices", "[Gather]") {
+	// particles deposited on the cells of a grid
+	size_t particles = 1000;
+	size_t cells = 37;
+	Tensor cell = randomIndices({particles}, cells, DType::Int64, 2);
+	Tensor mass({particles});
+	mass.fillUniform(0.0f, 1.0f, 8);
+
+	Tensor grid({cells}, 0.0f);
+	grid.scatterAdd(0, cell, mass);
+
+	std::vector<double> expected(cells, 0.0);
+	std::vector<float> cellValues = cell.toVector();
+	std::vector<float> massValues = mass.toVector();
+	for (size_t i = 0; i < particles; i++) expected[(size_t)cellValues[i]] += massValues[i];
+
+	std::vector<float> result = grid.toVector();
+	for (size_t c = 0; c < cells; c++) REQUIRE(std::abs(result[c] - expected[c]) < 1e-4);
+	REQUIRE(std::abs(grid.sum().toVector()[0] - mass.sum().toVector()[0]) < 1e-3f);
+
+	SECTION("integer counts into a view") {
+		Tensor counts({2, cells}, DType::Int32);
+		Tensor::View second = counts[1];
+		second.scatterAdd(0, cell, Tensor(1.0f).asType(DType::Int32));
+
+		std::vector<float> histogram = counts.toVector();
+		float total = 0.0f;
+		for (size_t c = 0; c < cells; c++) {
+			REQUIRE(histogram[c] == 0.0f);
+			total += histogram[cells + c];
+		}
+		REQUIRE(total == static_cast<float>(particles));
+	}
+}
+
+TEST_CASE("scatterAdd splits many updates over threads", "[Gather]") {
+	// a histogram per row, and one long index into a strided view
+	auto [indexShape, cells] = GENERATE(std::make_pair(Tensor::Shape({6, 20000}), size_t{37}),
+	                                    std::make_pair(Tensor::Shape({100000}), size_t{5}));
+	size_t rows = indexShape.getNumDims() == 2 ? indexShape.getDim(0) : 1;
+	size_t length = indexShape.getDim(indexShape.getNumDims() - 1);
+
+	Tensor cell = randomIndices(indexShape, cells, DType::Int64, 3);
+	Tensor weight = randomIndices(indexShape, 10, DType::Int32, 4);
+
+	// integer sums are exact in any order
+	std::vector<int64_t> expected(rows * cells, 0);
+	std::vector<int64_t> cellValues = cell.toVector<int64_t>();
+	std::vector<int32_t> weightValues = weight.toVector<int32_t>();
+	for (size_t r = 0; r < rows; r++) {
+		for (size_t i = 0; i < length; i++) {
+			expected[r * cells + cellValues[r * length + i]] += weightValues[r * length + i];
+		}
+	}
+
+	if (rows > 1) {
+		Tensor counts({rows, cells}, DType::Int64);
+		counts.scatterAdd(1, cell, weight);
+		REQUIRE(counts.toVector<int64_t>() == expected);
+	} else {
+		Tensor counts({cells, 2}, DType::Int64);
+		counts.transpose(0, 1)[1].scatterAdd(0, cell, weight);
+		std::vector<int64_t> values = counts.toVector<int64_t>();
+		for (size_t c = 0; c < cells; c++) {
+			REQUIRE(values[2 * c] == 0);
+			REQUIRE(values[2 * c + 1] == expected[c]);
+		}
+	}
+}
+
+TEST_CASE("gather and scatter errors", "[Gather]") {
+	Tensor x({3, 4}, 1.0f);
+	Tensor index({3, 2}, DType::Int64);
+	index.set({1, 1}, Tensor(4.0f));
+
+	REQUIRE_THROWS_AS(x.gather(1, index), std::out_of_range);
+	REQUIRE_THROWS_AS(x.gather(2, index), std::runtime_error);
+	REQUIRE_THROWS_AS(x.gather(1, Tensor({3, 2})), std::runtime_error);
+	REQUIRE_THROWS_AS(x.gather(1, Tensor({4, 2}, DType::Int64)), std::runtime_error);
+	REQUIRE_THROWS_AS(x.indexSelect(0, Tensor({3, 2}, DType::Int64)), std::runtime_error);
+
+	// nothing is written when an index is out of range
+	REQUIRE_THROWS_AS(x.scatter(1, index, Tensor(5.0f)), std::out_of_range);
+	REQUIRE(x.toVector() == std::vector<float>(12, 1.0f));
+
+	Tensor ints({3, 4}, DType::Int32);
+	Tensor valid({3, 2}, DType::Int64);
+	REQUIRE_THROWS_AS(ints.scatterAdd(1, valid, Tensor(0.5f)), std::runtime_error);
+	REQUIRE_THROWS_AS(x.scatter(1, valid, Tensor({3, 3})), std::runtime_error);
+}
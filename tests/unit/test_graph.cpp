@@ -0,0 +1,157 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+TEST_CASE("Graph replay matches eager execution", "[Graph]") {
+	Tensor x({2, 3}, 2.0f), y({2, 3}, 0.0f);
+	x[1] = Tensor({3}, -1.0f);
+
+	Tensor::Graph graph = Tensor::Graph::capture({x, y}, [&]() { y = (x + 1.0f) * x - x / 2.0f; });
+
+	Tensor expected = (x + 1.0f) * x - x / 2.0f;
+
+	SECTION("capture leaves bindings untouched") {
+		REQUIRE(tensor_equal(y, Tensor({2, 3}, 0.0f)));
+	}
+
+	SECTION("replay") {
+		graph.replay();
+		REQUIRE(tensor_equal(y, expected));
+	}
+
+	SECTION("replay reads the current binding data") {
+		x.fillAll(3.0f);
+		graph.replay();
+		REQUIRE(tensor_equal(y, Tensor({2, 3}, 10.5f)));
+	}
+}
+
+TEST_CASE("Graph in-place updates accumulate across replays", "[Graph]") {
+	Tensor s({2}, 0.0f), v({2}, 1.0f);
+
+	Tensor::Graph step = Tensor::Graph::capture({s, v}, [&]() {
+		v += Tensor({2}, 0.5f);
+		s += v * 2.0f;
+	});
+
+	step.replay();
+	step.replay();
+
+	REQUIRE(tensor_equal(v, Tensor({2}, 2.0f)));
+	REQUIRE(tensor_equal(s, Tensor({2}, 7.0f)));
+}
+
+TEST_CASE("Graph views, reductions and matmul", "[Graph]") {
+	Tensor a({2, 2}, 1.0f), out({2}, 0.0f), total(0.0f);
+
+	Tensor::Graph graph = Tensor::Graph::capture({a, out, total}, [&]() {
+		Tensor product = a.matmul(a);
+		out[0] = product.sum(1)[1];
+		out[1] = a[0][1];
+		total = product.norm() + a.max();
+	});
+
+	a[0][1] = Tensor(3.0f);
+	graph.replay();
+
+	// a = [[1, 3], [1, 1]], a @ a = [[4, 6], [2, 4]]
+	Tensor expected({2}, 6.0f);
+	expected[1] = Tensor(3.0f);
+
+	REQUIRE(tensor_equal(out, expected));
+	REQUIRE(total.isClose(Tensor(std::sqrt(72.0f) + 3.0f)).toVector()[0]);
+}
+
+TEST_CASE("Graph elementwise functions", "[Graph]") {
+	Tensor x({4}, 0.5f), y({4}, 0.0f);
+
+	Tensor::Graph graph = Tensor::Graph::capture({x, y}, [&]() {
+		y = x.exp() + x.clamp(-1.0f, 1.0f).pow(2.0f);
+		y[0].mapInplace(UnaryOp::Sqrt);
+	});
+
+	REQUIRE(tensor_equal(y, Tensor({4}, 0.0f)));
+
+	x.fillAll(2.0f);
+	x[1] = Tensor(-3.0f);
+	graph.replay();
+
+	Tensor expected = x.exp() + x.clamp(-1.0f, 1.0f).pow(2.0f);
+	expected[0] = expected[0].map(UnaryOp::Sqrt);
+	REQUIRE(tensor_equal(y, expected));
+}
+
+TEST_CASE("Graph constants and dead operations", "[Graph]") {
+	Tensor x({4}, 1.0f), y({4}, 0.0f);
+	Tensor scale({4}, 2.0f);
+
+	Tensor::Graph graph = Tensor::Graph::capture({x, y}, [&]() {
+		Tensor unused = x * 100.0f;
+		y = x * (scale * 3.0f + 1.0f);
+	});
+
+	// scale * 3 + 1 is folded, unused is dropped: one mul and one copy remain
+	REQUIRE(graph.getNumNodes() == 2);
+
+	scale.fillAll(0.0f);
+	graph.replay();
+	REQUIRE(tensor_equal(y, Tensor({4}, 7.0f)));
+}
+
+TEST_CASE("Graph intermediates share arena slots", "[Graph]") {
+	Tensor x({64}, 1.0f), y({64}, 0.0f);
+
+	Tensor::Graph graph = Tensor::Graph::capture({x, y}, [&]() {
+		Tensor t = x + 1.0f;
+		for (int i = 0; i < 8; i++) {
+			t = t * 2.0f + 1.0f;
+		}
+		y = t;
+	});
+
+	REQUIRE(graph.getNumSlots() <= 3);
+	REQUIRE(graph.getArenaBytes() <= 3 * 64 * sizeof(float));
+
+	graph.replay();
+	REQUIRE(tensor_equal(y, Tensor({64}, 767.0f)));
+}
+
+TEST_CASE("Graph capture errors", "[Graph]") {
+	Tensor x({2}, 1.0f), y({2}, 0.0f);
+
+	SECTION("changing the size of a binding") {
+		REQUIRE_THROWS_AS(Tensor::Graph::capture({x}, [&]() { x = Tensor({3}, 1.0f); }),
+		                  std::runtime_error);
+		REQUIRE(tensor_equal(x, Tensor({2}, 1.0f)));
+	}
+
+	SECTION("binding the same tensor twice") {
+		REQUIRE_THROWS_AS(Tensor::Graph::capture({x, x}, [&]() {}), std::runtime_error);
+	}
+
+	SECTION("nested capture") {
+		REQUIRE_THROWS_AS(Tensor::Graph::capture(
+		                      {x}, [&]() { Tensor::Graph::capture({y}, [&]() { y += x; }); }),
+		                  std::runtime_error);
+	}
+
+	SECTION("exceptions restore bindings") {
+		REQUIRE_THROWS(Tensor::Graph::capture({x}, [&]() {
+			x += x;
+			throw std::runtime_error("body failed");
+		}));
+		REQUIRE(tensor_equal(x, Tensor({2}, 1.0f)));
+
+		// recording stopped, eager ops work as usual
+		x += x;
+		REQUIRE(tensor_equal(x, Tensor({2}, 2.0f)));
+	}
+
+	SECTION("replay after a binding changed size") {
+		Tensor::Graph graph = Tensor::Graph::capture({x, y}, [&]() { y = x * 2.0f; });
+		x = Tensor({3}, 1.0f);
+		REQUIRE_THROWS_AS(graph.replay(), std::runtime_error);
+	}
+}
@@ -0,0 +1,223 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Batch of `batch` random (n, n) symmetric positive definite matrices, B @ B^T + n I.
+static Tensor randomSPD(size_t batch, size_t n, uint64_t seed) {
+	Tensor b({batch, n, n});
+	b.fillUniform(-1.0f, 1.0f, seed);
+	Tensor spd = b.matmul(b.transpose(1, 2));
+
+	Tensor identity({n, n});
+	for (size_t i = 0; i < n; i++) identity[i][i] = (float)n;
+	spd += identity;
+	return spd;
+}
+
+/// Largest absolute difference between two tensors of one shape, on the host.
+static float maxError(const Tensor& actual, const Tensor& expected) {
+	REQUIRE(actual.getShape() == expected.getShape());
+	std::vector<float> a = actual.toVector();
+	std::vector<float> e = expected.toVector();
+
+	float error = 0.0f;
+	for (size_t i = 0; i < a.size(); i++) error = std::max(error, std::abs(a[i] - e[i]));
+	return error;
+}
+
+/// True if every element of the (batch, n, n) `t` above the diagonal, or below if `lower`, is
+/// zero.
+static bool isTriangular(const Tensor& t, bool lower) {
+	size_t n = t.getShape().getDim(2);
+	std::vector<float> values = t.toVector();
+	for (size_t i = 0; i < values.size(); i++) {
+		size_t row = (i / n) % n, col = i % n;
+		if ((lower ? col > row : col < row) && values[i] != 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("cholesky reconstructs symmetric positive definite matrices", "[Linalg]") {
+	// one partial block, then sizes across the block boundary
+	size_t n = GENERATE(5, 64, 150);
+	Tensor a = randomSPD(3, n, 1);
+
+	Tensor l = a.cholesky();
+	REQUIRE(l.getDType() == DType::Float32);
+	REQUIRE(isTriangular(l, true));
+	REQUIRE(maxError(l.matmul(l.transpose(1, 2)), a) <= 1e-3f * n);
+
+	// only the lower triangle is read
+	Tensor upper = a * 1.0f;
+	upper[0][0].slice(0, {1, std::nullopt}) = Tensor({n - 1}, 1e6f);
+	REQUIRE(tensor_equal(upper.cholesky()[0], l[0]));
+}
+
+TEST_CASE("lu with partial pivoting reconstructs the permuted matrix", "[Linalg]") {
+	size_t n = GENERATE(7, 150);
+	Tensor a({2, n, n});
+	a.fillUniform(-1.0f, 1.0f, 2);
+
+	auto [factors, perm] = a.lu();
+	REQUIRE(perm.getDType() == DType::Int64);
+	REQUIRE(perm.getShape() == Tensor::Shape({2, n}));
+
+	// unpack the unit lower L and U
+	std::vector<float> packed = factors.toVector();
+	Tensor l({2, n, n}), u({2, n, n});
+	for (size_t b = 0; b < 2; b++) {
+		for (size_t i = 0; i < n; i++) {
+			l[b][i][i] = 1.0f;
+			for (size_t j = 0; j < n; j++) {
+				float value = packed[(b * n + i) * n + j];
+				if (j < i) {
+					l[b][i][j] = value;
+				} else {
+					u[b][i][j] = value;
+				}
+			}
+		}
+	}
+
+	// every pivot is the largest entry left in its column
+	std::vector<float> lower = l.toVector();
+	REQUIRE(std::all_of(lower.begin(), lower.end(), [](float x) { return std::abs(x) <= 1.0f; }));
+
+	std::vector<float> order = perm.toVector();
+	Tensor permuted({2, n, n});
+	for (size_t b = 0; b < 2; b++) {
+		std::vector<float> sorted(order.begin() + b * n, order.begin() + (b + 1) * n);
+		std::sort(sorted.begin(), sorted.end());
+		for (size_t i = 0; i < n; i++) {
+			REQUIRE(sorted[i] == (float)i);
+			permuted[b][i] = a[b][(size_t)order[b * n + i]];
+		}
+	}
+	REQUIRE(maxError(l.matmul(u), permuted) <= 1e-4f * n);
+}
+
+TEST_CASE("qr gives orthonormal Q and upper triangular R", "[Linalg]") {
+	auto [m, n] = GENERATE(std::pair<size_t, size_t>{10, 4}, std::pair<size_t, size_t>{200, 70},
+	                       std::pair<size_t, size_t>{130, 130});
+	Tensor a({2, m, n});
+	a.fillUniform(-1.0f, 1.0f, 3);
+
+	auto [q, r] = a.qr();
+	REQUIRE(q.getShape() == Tensor::Shape({2, m, n}));
+	REQUIRE(r.getShape() == Tensor::Shape({2, n, n}));
+	REQUIRE(isTriangular(r, false));
+
+	Tensor identity({2, n, n});
+	for (size_t b = 0; b < 2; b++) {
+		for (size_t i = 0; i < n; i++) identity[b][i][i] = 1.0f;
+	}
+	REQUIRE(maxError(q.transpose(1, 2).matmul(q), identity) <= 1e-4f * m);
+	REQUIRE(maxError(q.matmul(r), a) <= 1e-4f * m);
+}
+
+TEST_CASE("solveTriangular solves lower, upper and unit triangular systems", "[Linalg]") {
+	size_t n = GENERATE(3, 130);
+	Tensor a = randomSPD(2, n, 4).cholesky();
+	Tensor b({2, n, 3});
+	b.fillUniform(-1.0f, 1.0f, 5);
+
+	Tensor x = a.solveTriangular(b, true);
+	REQUIRE(maxError(a.matmul(x), b) <= 1e-4f * n);
+
+	// the upper factor read through a transposed view
+	Tensor upper = a.transpose(1, 2).copy();
+	Tensor y = upper.solveTriangular(b, false);
+	REQUIRE(maxError(upper.matmul(y), b) <= 1e-4f * n);
+
+	// a unit diagonal is not read
+	Tensor unit = a * 1.0f;
+	Tensor ones({2, n, n});
+	for (size_t k = 0; k < 2; k++) {
+		for (size_t i = 0; i < n; i++) {
+			unit[k][i][i] = 0.0f;
+			ones[k][i][i] = 1.0f;
+		}
+	}
+	Tensor z = unit.solveTriangular(b, true, true);
+	REQUIRE(maxError((unit + ones).matmul(z), b) <= 1e-4f * n);
+}
+
+TEST_CASE("solve matches the system it solves", "[Linalg]") {
+	size_t n = GENERATE(4, 100);
+	Tensor a({3, n, n});
+	a.fillUniform(-1.0f, 1.0f, 6);
+	Tensor b({3, n, 2});
+	b.fillUniform(-1.0f, 1.0f, 7);
+
+	Tensor x = a.solve(b);
+	REQUIRE(x.getShape() == b.getShape());
+	REQUIRE(maxError(a.matmul(x), b) <= 1e-3f * n);
+
+	// Float64 stays Float64 and is far more accurate
+	Tensor x64 = a.asType(DType::Float64).solve(b);
+	REQUIRE(x64.getDType() == DType::Float64);
+	REQUIRE(maxError(a.asType(DType::Float64).matmul(x64).asType(DType::Float32), b) <= 1e-5f);
+}
+
+TEST_CASE("least squares regression through qr", "[Linalg]") {
+	// y = 2 x0 - 3 x1 + 0.5 with small noise
+	size_t samples = 500;
+	Tensor inputs({samples, 2});
+	inputs.fillUniform(-1.0f, 1.0f, 8);
+	Tensor features({samples, 3}, 1.0f);
+	features.slice(1, {0, 2}) = inputs;
+	Tensor noise({samples, 1});
+	noise.fillUniform(-1e-3f, 1e-3f, 9);
+
+	Tensor weights({3, 1});
+	weights[0] = 2.0f;
+	weights[1] = -3.0f;
+	weights[2] = 0.5f;
+	Tensor targets = features.matmul(weights) + noise;
+
+	auto [q, r] = features.qr();
+	Tensor fitted = r.solveTriangular(q.transpose(0, 1).matmul(targets), false);
+	REQUIRE(maxError(fitted, weights) <= 1e-3f);
+}
+
+TEST_CASE("linear algebra dtypes and errors", "[Linalg]") {
+	Tensor ints({2, 2}, DType::Int32);
+	ints[0][0] = 2.0f;
+	ints[1][1] = 3.0f;
+	REQUIRE(ints.cholesky().getDType() == DType::Float32);
+	REQUIRE(ints.asType(DType::Float64).cholesky().getDType() == DType::Float64);
+
+	// empty matrices and batches are fine
+	REQUIRE(Tensor({0, 3, 3}).cholesky().getShape() == Tensor::Shape({0, 3, 3}));
+	REQUIRE(Tensor({2, 0, 0}).solve(Tensor({2, 0, 4})).getShape() == Tensor::Shape({2, 0, 4}));
+
+	Tensor square({3, 3}, 1.0f);
+	REQUIRE_THROWS_AS(square.cholesky(), std::runtime_error);
+	REQUIRE_THROWS_AS(square.solve(Tensor({3, 1})), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor({3, 3}).solveTriangular(Tensor({3, 1}), true), std::runtime_error);
+
+	// a singular matrix still factorizes, with a zero pivot
+	auto [factors, perm] = square.lu();
+	REQUIRE(factors.toVector()[8] == 0.0f);
+
+	REQUIRE_THROWS_AS(Tensor({3}).cholesky(), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor({3, 4}).lu(), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor({3, 4}).qr(), std::runtime_error);
+	REQUIRE_THROWS_AS(square.solve(Tensor({2, 1})), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor({2, 3, 3}).solve(Tensor({3, 3, 1})), std::runtime_error);
+
+	REQUIRE_THROWS_AS(Tensor::Graph::capture({square}, [&]() { square.qr(); }),
+	                  std::runtime_error);
+
+	Tensor x({2, 2}, 1.0f);
+	Tensor::Tape tape({x});
+	REQUIRE_THROWS_AS(x.cholesky(), std::runtime_error);
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <thread>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+TEST_CASE("Memory stats track live bytes and allocations", "[MemoryStats]") {
+	profiling::MemoryStats before = profiling::getMemoryStats(Backend::CPU);
+
+	{
+		Tensor a({4, 8}, 1.0f);
+		Tensor b = a;
+
+		profiling::MemoryStats during = profiling::getMemoryStats(Backend::CPU);
+		REQUIRE(during.liveBytes == before.liveBytes + 2 * 32 * sizeof(float));
+		REQUIRE(during.numAllocations == before.numAllocations + 2);
+		REQUIRE(during.peakBytes >= during.liveBytes);
+	}
+
+	profiling::MemoryStats after = profiling::getMemoryStats(Backend::CPU);
+	REQUIRE(after.liveBytes == before.liveBytes);
+	REQUIRE(after.numAllocations == before.numAllocations + 2);
+}
+
+TEST_CASE("Peak memory scope", "[MemoryStats]") {
+	Tensor a({64}, 1.0f);
+
+	profiling::PeakMemoryScope outer;
+	{
+		// the a + a temporary and its sum are live together, c comes later and stays below the peak
+		profiling::PeakMemoryScope inner;
+		Tensor b = (a + a).sum(0);
+
+		REQUIRE(inner.getPeakIncrease() == 65 * sizeof(float));
+		REQUIRE(inner.getNumAllocations() == 2);
+	}
+
+	Tensor c({16}, 0.0f);
+	REQUIRE(outer.getPeakIncrease() == 65 * sizeof(float));
+	REQUIRE(outer.getNumAllocations() == 3);
+
+	profiling::resetPeakMemory(Backend::CPU);
+	REQUIRE(profiling::getMemoryStats(Backend::CPU).peakBytes ==
+	        profiling::getMemoryStats(Backend::CPU).liveBytes);
+}
+
+TEST_CASE("Peak memory scopes keep their own mark", "[MemoryStats]") {
+	// a global peak above the current live bytes
+	{ Tensor large({1000}, 1.0f); }
+	uint64_t globalPeak = profiling::getMemoryStats(Backend::CPU).peakBytes;
+
+	auto first = std::make_unique<profiling::PeakMemoryScope>();
+	REQUIRE(profiling::getMemoryStats(Backend::CPU).peakBytes == globalPeak);
+
+	Tensor a({100}, 1.0f);
+	auto second = std::make_unique<profiling::PeakMemoryScope>();
+
+	// ended before the scope inside it
+	first.reset();
+	Tensor b({50}, 1.0f);
+	REQUIRE(second->getPeakIncrease() == 50 * sizeof(float));
+
+	// allocations of other threads count, their scopes do not touch this one
+	uint64_t threadIncrease = 0;
+	std::thread([&]() {
+		profiling::PeakMemoryScope scope;
+		Tensor c({25}, 1.0f);
+		threadIncrease = scope.getPeakIncrease();
+	}).join();
+	REQUIRE(threadIncrease == 25 * sizeof(float));
+	REQUIRE(second->getPeakIncrease() == 75 * sizeof(float));
+	REQUIRE(second->getNumAllocations() == 2);
+	REQUIRE(profiling::getMemoryStats(Backend::CPU).peakBytes >= globalPeak);
+}
+
+TEST_CASE("Memory limit", "[MemoryStats]") {
+	uint64_t live = profiling::getMemoryStats(Backend::CPU).liveBytes;
+	profiling::setMemoryLimit(Backend::CPU, live + 100 * sizeof(float));
+
+	Tensor a({60}, 1.0f);
+
+	REQUIRE_THROWS_AS(Tensor({60}, 1.0f), std::runtime_error);
+	REQUIRE_THROWS_AS(a + a, std::runtime_error);
+	REQUIRE(profiling::getMemoryStats(Backend::CPU).liveBytes == live + 60 * sizeof(float));
+
+	profiling::setMemoryLimit(Backend::CPU, 0);
+	REQUIRE(profiling::getMemoryLimit(Backend::CPU) == 0);
+	REQUIRE(tensor_equal(a + a, Tensor({60}, 2.0f)));
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "nforge/nforge.h"
+
+TEST_CASE("Op stats without NFORGE_ENABLE_STATS", "[OpStats]") {
+	if (profiling::isOpStatsAvailable()) {
+		return;
+	}
+
+	profiling::setOpStatsEnabled(true);
+	Tensor a({4}, 1.0f);
+	Tensor b = a + a;
+
+	REQUIRE_FALSE(profiling::isOpStatsEnabled());
+	REQUIRE(profiling::getOpStats().empty());
+	REQUIRE(profiling::toJson(profiling::getOpStats()) == "{}");
+}
+
+TEST_CASE("Op stats count calls, elements and allocations", "[OpStats]") {
+	if (!profiling::isOpStatsAvailable()) {
+		return;
+	}
+
+	profiling::setOpStatsEnabled(true);
+	Tensor a({2, 3}, 1.0f), b({3}, 2.0f);
+	profiling::resetOpStats();
+
+	{
+		Tensor c = a + b;
+		c += b;
+		Tensor total = c.sum();
+	}
+
+	profiling::OpStatsSnapshot stats = profiling::getOpStats();
+
+	REQUIRE(stats["add"].calls == 1);
+	REQUIRE(stats["add"].elements == 6);
+	REQUIRE(stats["add"].bytesAllocated == 6 * sizeof(float));
+	REQUIRE(stats["add"].bytesFreed == 6 * sizeof(float));
+
+	REQUIRE(stats["iadd"].calls == 1);
+	REQUIRE(stats["iadd"].bytesAllocated == 0);
+
+	REQUIRE(stats["sum"].calls == 1);
+	REQUIRE(stats["sum"].elements == 6);
+	REQUIRE(stats["sum"].bytesAllocated == sizeof(float));
+
+	REQUIRE(stats.count("matmul") == 0);
+
+	SECTION("elementwise math owns its result") {
+		profiling::resetOpStats();
+		Tensor e = a.exp();
+		a.mapInplace(UnaryOp::Sqrt);
+
+		profiling::OpStatsSnapshot math = profiling::getOpStats();
+		REQUIRE(math["exp"].calls == 1);
+		REQUIRE(math["exp"].elements == 6);
+		REQUIRE(math["exp"].bytesAllocated == 6 * sizeof(float));
+		REQUIRE(math["sqrt"].calls == 1);
+		REQUIRE(math["sqrt"].bytesAllocated == 0);
+		REQUIRE(math.count("construct") == 0);
+	}
+
+	SECTION("reset") {
+		profiling::resetOpStats();
+		REQUIRE(profiling::getOpStats().empty());
+	}
+
+	SECTION("disabled at runtime") {
+		profiling::resetOpStats();
+		profiling::setOpStatsEnabled(false);
+
+		Tensor c = a * b;
+
+		profiling::setOpStatsEnabled(true);
+		REQUIRE(profiling::getOpStats().empty());
+	}
+
+	SECTION("json") {
+		std::string json = profiling::toJson(stats);
+
+		REQUIRE(json.front() == '{');
+		REQUIRE(json.find("\"add\": {\"calls\": 1") != std::string::npos);
+		REQUIRE(json.find("\"bytesAllocated\": 24") != std::string::npos);
+	}
+}
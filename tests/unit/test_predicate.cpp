@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <limits>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+TEST_CASE("Fused predicates match reduced masks", "[Predicate]") {
+	DType dtype = GENERATE(DType::Float32, DType::Float64, DType::BFloat16, DType::Int32);
+
+	// longer than a chunk, so the early exit and the tail both run
+	Tensor lhs = randomValues({3, 700}, -4.0f, 4.0f, dtype, 11);
+	Tensor rhs = randomValues({3, 700}, -4.0f, 4.0f, dtype, 12);
+
+	Tensor masks[] = {lhs == rhs, lhs != rhs, lhs < rhs, lhs <= rhs, lhs > rhs, lhs >= rhs};
+	Predicate predicates[] = {Predicate::Equal, Predicate::NotEqual, Predicate::Less,
+	                          Predicate::LessEqual, Predicate::Greater, Predicate::GreaterEqual};
+	bool reflexive[] = {true, false, false, true, false, true};
+
+	for (size_t i = 0; i < 6; i++) {
+		bool all = masks[i].all().toVector()[0] == 1.0f;
+		bool any = masks[i].any().toVector()[0] == 1.0f;
+		REQUIRE(lhs.all(predicates[i], rhs) == all);
+		REQUIRE(lhs.any(predicates[i], rhs) == any);
+		REQUIRE(lhs.all(predicates[i], lhs) == reflexive[i]);
+	}
+
+	SECTION("a single element decides") {
+		Tensor copy = lhs.asType(dtype);
+		REQUIRE(lhs.all(Predicate::Equal, copy));
+		REQUIRE_FALSE(lhs.any(Predicate::NotEqual, copy));
+
+		copy.set({2, 699}, Tensor(100.0f).asType(dtype));
+		REQUIRE_FALSE(lhs.all(Predicate::Equal, copy));
+		REQUIRE(lhs.any(Predicate::NotEqual, copy));
+		REQUIRE(lhs.all(Predicate::LessEqual, copy));
+	}
+}
+
+TEST_CASE("Fused predicates split the search over threads", "[Predicate]") {
+	// one long row and many short strided ones, both split into several ranges
+	Tensor line = randomValues({200000}, -4.0f, 4.0f, DType::Float32, 13);
+	Tensor parent = randomValues({2000, 200}, -4.0f, 4.0f, DType::Float32, 14);
+	Tensor::View columns = parent.subsample({1, 2});
+
+	size_t position = GENERATE(0, 77777, 199999);
+	Tensor copy = line.asType(DType::Float32);
+	REQUIRE(line.all(Predicate::Equal, copy));
+	copy.set({position}, Tensor(100.0f));
+	REQUIRE_FALSE(line.all(Predicate::Equal, copy));
+	REQUIRE(line.any(Predicate::Less, copy));
+	REQUIRE(line.all(Predicate::LessEqual, copy));
+
+	Tensor strided = columns.copy();
+	REQUIRE(strided.all(Predicate::Equal, columns));
+	parent.set({position % 2000, 198}, Tensor(100.0f));
+	REQUIRE_FALSE(strided.all(Predicate::Equal, columns));
+	REQUIRE(strided.any(Predicate::Less, columns));
+}
+
+TEST_CASE("Fused predicates broadcast and read views", "[Predicate]") {
+	Tensor x({4, 6}, 2.0f);
+	Tensor row({6}, 2.0f);
+	REQUIRE(x.all(Predicate::Equal, row));
+	REQUIRE(x.all(Predicate::Less, Tensor(3.0f)));
+	REQUIRE_FALSE(x.any(Predicate::Greater, Tensor(3.0f)));
+
+	Tensor parent({4, 12}, 2.0f);
+	parent.set({3, 11}, Tensor(-1.0f));
+	REQUIRE(x.all(Predicate::Equal, parent.subsample({1, 2})));
+
+	Tensor::View odd = parent.subsample({1, 2});
+	Tensor shifted({4, 12}, 2.0f);
+	shifted.set({3, 10}, Tensor(-1.0f));
+	REQUIRE_FALSE(x.all(Predicate::Equal, shifted.subsample({1, 2})));
+	REQUIRE(x.any(Predicate::Greater, shifted.subsample({1, 2})));
+	REQUIRE(x.all(Predicate::GreaterEqual, odd));
+
+	// mixed dtypes compare in the promoted dtype
+	Tensor ints = Tensor({4, 6}, 2.0f).asType(DType::Int64);
+	REQUIRE(x.all(Predicate::Equal, ints));
+	REQUIRE((x < Tensor(3.0f)).all(Predicate::Equal, Tensor(1.0f)));
+}
+
+TEST_CASE("allClose", "[Predicate]") {
+	Tensor a({2, 300});
+	a.fillUniform(-1.0f, 1.0f, 3);
+	Tensor b = a + 1e-6f;
+
+	REQUIRE(a.allClose(b));
+	REQUIRE(a.allClose(b) == (a.isClose(b).all().toVector()[0] == 1.0f));
+	REQUIRE_FALSE(a.allClose(b, 1e-8f));
+	REQUIRE_FALSE(a.allClose(a + 0.1f));
+	REQUIRE(a.asType(DType::Float16).allClose(a, 1e-3f));
+}
+
+TEST_CASE("countNonzero", "[Predicate]") {
+	Tensor x({3, 5}, 1.0f);
+	x.set({0, 1}, Tensor(0.0f));
+	x.set({2}, Tensor({5}, 0.0f));
+
+	Tensor total = x.countNonzero();
+	REQUIRE(total.getDType() == DType::Int64);
+	REQUIRE(total.toVector()[0] == 9.0f);
+	REQUIRE(x.countNonzero(1).toVector() == std::vector<float>{4.0f, 5.0f, 0.0f});
+
+	// Bool masks count through the byte path, strided masks element by element
+	Tensor mask({40, 33}, 1.0f);
+	mask.fillUniform(-1.0f, 1.0f, 5);
+	Tensor positive = mask > Tensor(0.0f);
+	Tensor expected = positive.asType(DType::Int64).sum(1);
+	REQUIRE(positive.countNonzero(1).toVector() == expected.toVector());
+	REQUIRE(positive.countNonzero().toVector() == expected.sum().toVector());
+
+	Tensor::View columns = positive.subsample({1, 3});
+	Tensor strided = columns.copy();
+	REQUIRE(strided.countNonzero(1).toVector() ==
+	        strided.asType(DType::Int64).sum(1).toVector());
+
+	Tensor bytes = Tensor({7}, 2.0f).asType(DType::Int8);
+	bytes.set({3}, Tensor(0.0f).asType(DType::Int8));
+	REQUIRE(bytes.countNonzero().toVector()[0] == 6.0f);
+}
+
+TEST_CASE("countNonzero of special values", "[Predicate]") {
+	DType dtype = GENERATE(DType::Float32, DType::Float64, DType::Float16);
+
+	// NaN and infinity are nonzero, negative zero is zero
+	Tensor special({2, 3}, 0.0f);
+	special.set({0, 0}, Tensor(std::numeric_limits<float>::quiet_NaN()));
+	special.set({0, 2}, Tensor(-0.0f));
+	special.set({1, 1}, Tensor(std::numeric_limits<float>::infinity()));
+	special = special.asType(dtype);
+
+	REQUIRE(special.countNonzero().toVector()[0] == 2.0f);
+	REQUIRE(special.countNonzero(1).toVector() == std::vector<float>{1.0f, 1.0f});
+	REQUIRE(Tensor::Sparse::fromDense(special).getNumNonzero() == 2);
+}
@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Integer valued tensor in [-100, 100) of dtype `dtype`, shifted into [0, 200) for UInt8.
+static Tensor randomInts(const Tensor::Shape& shape, DType dtype, uint64_t seed) {
+	Tensor values(shape);
+	values.fillUniform(-100.0f, 100.0f, seed);
+	float zeroPoint = dtype == DType::UInt8 ? 100.0f : 0.0f;
+	return values.quantize(Tensor(1.0f), Tensor(zeroPoint), dtype);
+}
+
+TEST_CASE("Quantize rounds and saturates", "[Quantize]") {
+	std::vector<float> values = {0.5f, 1.5f, -2.5f, 3.2f, 1000.0f, -1000.0f};
+	Tensor x({6});
+	for (size_t i = 0; i < values.size(); i++) x.set({i}, Tensor(values[i]));
+
+	Tensor q = x.quantize(Tensor(1.0f), Tensor(0.0f));
+	REQUIRE(q.getDType() == DType::Int8);
+	REQUIRE(q.toVector() == std::vector<float>{0.0f, 2.0f, -2.0f, 3.0f, 127.0f, -128.0f});
+
+	Tensor u = x.quantize(Tensor(0.5f), Tensor(128.0f), DType::UInt8);
+	REQUIRE(u.getDType() == DType::UInt8);
+	REQUIRE(u.toVector() == std::vector<float>{129.0f, 131.0f, 123.0f, 134.0f, 255.0f, 0.0f});
+
+	Tensor back = u.dequantize(Tensor(0.5f), Tensor(128.0f));
+	REQUIRE(back.getDType() == DType::Float32);
+	REQUIRE(back.toVector() == std::vector<float>{0.5f, 1.5f, -2.5f, 3.0f, 63.5f, -64.0f});
+
+	REQUIRE_THROWS_AS(x.quantize(Tensor(1.0f), Tensor(0.0f), DType::Int32), std::runtime_error);
+	REQUIRE_THROWS_AS(x.quantize(Tensor({2}, 1.0f), Tensor(0.0f)), std::runtime_error);
+}
+
+TEST_CASE("Quantize per channel", "[Quantize]") {
+	Tensor x({2, 3});
+	x.fillUniform(-1.0f, 1.0f, 7);
+
+	Tensor rowScales({2, 1}, 0.01f);
+	rowScales.set({1}, Tensor({1}, 0.02f));
+	Tensor columnScales({3}, 0.01f);
+	columnScales.set({2}, Tensor(0.04f));
+
+	for (const Tensor& scales : {rowScales, columnScales}) {
+		Tensor zeroPoints = Tensor(scales.getShape(), 3.0f).asType(DType::Int32);
+		Tensor back = x.quantize(scales, zeroPoints).dequantize(scales, zeroPoints);
+
+		// every element is within half a step of its channel
+		Tensor error = back - x;
+		Tensor limit = scales * 0.5f + 1e-6f;
+		REQUIRE((error <= limit).all().toVector()[0] == 1.0f);
+		REQUIRE((error >= limit * -1.0f).all().toVector()[0] == 1.0f);
+	}
+}
+
+TEST_CASE("Int8 matmul matches float matmul", "[Quantize]") {
+	DType lhsType = GENERATE(DType::Int8, DType::UInt8);
+	int32_t lhsZeroPoint = lhsType == DType::UInt8 ? 100 : -3;
+	int32_t rhsZeroPoint = GENERATE(0, 5);
+
+	// p is not a multiple of the column block, the lhs batch broadcasts over a 2D rhs
+	Tensor lhs = randomInts({2, 5, 70}, lhsType, 1);
+	Tensor rhs = randomInts({70, 7}, DType::Int8, 2);
+
+	Tensor result = lhs.matmulInt8(rhs, lhsZeroPoint, rhsZeroPoint);
+	REQUIRE(result.getDType() == DType::Int32);
+	REQUIRE(result.getShape() == Tensor::Shape({2, 5, 7}));
+
+	Tensor a = lhs.asType(DType::Float32) - static_cast<float>(lhsZeroPoint);
+	Tensor b = rhs.asType(DType::Float32) - static_cast<float>(rhsZeroPoint);
+	REQUIRE(result.toVector() == a.matmul(b).toVector());
+
+	SECTION("strided views") {
+		Tensor wide = randomInts({70, 14}, DType::Int8, 3);
+		Tensor::View columns = wide.subsample({1, 2});
+		Tensor expected = a.matmul(columns.copy().asType(DType::Float32));
+		REQUIRE(lhs.matmulInt8(columns, lhsZeroPoint).toVector() == expected.toVector());
+	}
+
+	SECTION("requantize epilogue") {
+		// powers of two keep the reference exact
+		Tensor multipliers({7}, 1.0f / 64.0f);
+		multipliers.set({0}, Tensor(1.0f / 512.0f));
+
+		Tensor fused =
+		    lhs.matmulInt8(rhs, lhsZeroPoint, rhsZeroPoint, multipliers, 10, DType::UInt8);
+		REQUIRE(fused.getDType() == DType::UInt8);
+
+		Tensor scaled = result.asType(DType::Float32) * multipliers;
+		Tensor expected = scaled.quantize(Tensor(1.0f), Tensor(10.0f), DType::UInt8);
+		REQUIRE(fused.toVector() == expected.toVector());
+	}
+}
+
+TEST_CASE("Int8 matmul checks its operands", "[Quantize]") {
+	Tensor lhs({2, 4}, DType::Int8);
+	Tensor rhs({4, 3}, DType::Int8);
+
+	REQUIRE_THROWS_AS(lhs.matmulInt8(Tensor({4, 3})), std::runtime_error);
+	REQUIRE_THROWS_AS(lhs.matmulInt8(rhs.asType(DType::UInt8)), std::runtime_error);
+	REQUIRE_THROWS_AS(lhs.matmulInt8(Tensor({3, 3}, DType::Int8)), std::runtime_error);
+	REQUIRE_THROWS_AS(lhs.matmulInt8(rhs, 0, 0, Tensor({2}, 1.0f), 0), std::runtime_error);
+	REQUIRE_THROWS_AS(lhs.matmulInt8(rhs, 0, 0, Tensor(1.0f), 0, DType::Int32),
+	                  std::runtime_error);
+	REQUIRE_NOTHROW(lhs.matmulInt8(rhs, 0, 0, Tensor(1.0f), 0));
+}
+
+TEST_CASE("Int8 matmul is exact up to the longest inner dim", "[Quantize]") {
+	// the largest products, 255 * -128 summed 65793 times, is -2^31 + 128
+	size_t k = 65793;
+	Tensor lhs = Tensor({1, k}, 255.0f).asType(DType::UInt8);
+	Tensor rhs = Tensor({k, 1}, -128.0f).asType(DType::Int8);
+	REQUIRE(lhs.matmulInt8(rhs).toVector()[0] == -2147483520.0f);
+
+	// int8 lhs take the shifted path, 127 + 128 packs to 255
+	Tensor signedLhs = Tensor({1, k}, 127.0f).asType(DType::Int8);
+	REQUIRE(signedLhs.matmulInt8(rhs).toVector()[0] == -1069531008.0f);
+
+	// zero points push the result past int32, it saturates
+	REQUIRE(lhs.matmulInt8(rhs, -255, 0).toVector()[0] == -2147483648.0f);
+
+	Tensor longer({1, k + 1}, DType::Int8);
+	REQUIRE_THROWS_AS(longer.matmulInt8(Tensor({k + 1, 1}, DType::Int8)), std::runtime_error);
+	REQUIRE_THROWS_AS(longer.matmulInt8(Tensor({k + 1, 1}, DType::Int8), 0, 0, Tensor(1.0f), 0),
+	                  std::runtime_error);
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <utility>
+
+#include "backend/cpu/thread_pool.h"
+#include "nforge/nforge.h"
+#include "rng/philox.h"
+#include "utils.h"
+
+TEST_CASE("Philox4x32-10 known answers", "[Random]") {
+	// from the Random123 known answer tests
+	rng::Block zero = rng::philox4x32({{0, 0, 0, 0}}, 0, 0);
+	REQUIRE(zero[0] == 0x6627e8d5);
+	REQUIRE(zero[1] == 0xe169c58d);
+	REQUIRE(zero[2] == 0xbc57ac4c);
+	REQUIRE(zero[3] == 0x9b00dbd8);
+
+	rng::Block pi = rng::philox4x32({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+	                                0xa4093822, 0x299f31d0);
+	REQUIRE(pi[0] == 0xd16cfe09);
+	REQUIRE(pi[1] == 0x94fdcceb);
+	REQUIRE(pi[2] == 0x5001e420);
+	REQUIRE(pi[3] == 0x24126ea1);
+}
+
+TEST_CASE("Seeded fills are reproducible", "[Random]") {
+	Tensor a({3, 7}), b({3, 7});
+
+	SECTION("per call seed") {
+		a.fillUniform(0.0f, 1.0f, 42);
+		b.fillRand();
+		b.fillUniform(0.0f, 1.0f, 42);
+		REQUIRE(tensor_equal(a, b));
+
+		b.fillUniform(0.0f, 1.0f, 43);
+		REQUIRE_FALSE(tensor_equal(a, b));
+	}
+
+	SECTION("global seed") {
+		Tensor::setRandomSeed(7);
+		a.fillRand();
+		b.fillRand();
+		REQUIRE_FALSE(tensor_equal(a, b));
+
+		Tensor c({3, 7}), d({3, 7});
+		Tensor::setRandomSeed(7);
+		c.fillRand();
+		d.fillRand();
+		REQUIRE(tensor_equal(a, c));
+		REQUIRE(tensor_equal(b, d));
+	}
+
+	SECTION("a prefix of a larger fill") {
+		Tensor large({100});
+		a.fillNormal(0.0f, 1.0f, 5);
+		large.fillNormal(0.0f, 1.0f, 5);
+
+		std::vector<float> small = a.toVector(), big = large.toVector();
+		REQUIRE(std::equal(small.begin(), small.end(), big.begin()));
+	}
+}
+
+TEST_CASE("Fills do not depend on the number of threads", "[Random]") {
+	// an odd length ends inside a chunk and a block
+	auto fill = [](DType dtype) {
+		Tensor x({1000003}, dtype);
+		x.fillNormal(0.0f, 1.0f, 11);
+		Tensor::setRandomSeed(3);
+		Tensor y({70001}, dtype);
+		y.fillBernoulli(0.3f);
+		return std::make_pair(x.toVector(), y.toVector());
+	};
+
+	for (DType dtype : {DType::Float32, DType::Float16, DType::Float64}) {
+		cpu::setNumThreads(1);
+		auto serial = fill(dtype);
+		cpu::setNumThreads(8);
+		auto parallel = fill(dtype);
+		cpu::setNumThreads(0);
+
+		REQUIRE(serial.first == parallel.first);
+		REQUIRE(serial.second == parallel.second);
+	}
+}
+
+TEST_CASE("Random distributions", "[Random]") {
+	const size_t n = 1 << 16;
+	Tensor t({n});
+
+	SECTION("uniform") {
+		t.fillUniform(-2.0f, 6.0f, 1);
+		std::vector<float> values = t.toVector();
+
+		double mean = 0.0;
+		for (float v : values) {
+			REQUIRE(v >= -2.0f);
+			REQUIRE(v < 6.0f);
+			mean += v;
+		}
+		mean /= n;
+
+		REQUIRE(std::abs(mean - 2.0) < 0.05);
+	}
+
+	SECTION("uniform never rounds up to high") {
+		// floats are 2 apart here, half the values would round up to `high` unclamped
+		t.fillUniform(16777216.0f, 16777218.0f, 4);
+		std::vector<float> values = t.toVector();
+
+		for (float v : values) REQUIRE(v == 16777216.0f);
+	}
+
+	SECTION("normal") {
+		t.fillNormal(3.0f, 0.5f, 2);
+		std::vector<float> values = t.toVector();
+
+		double mean = 0.0, var = 0.0;
+		for (float v : values) mean += v;
+		mean /= n;
+		for (float v : values) var += (v - mean) * (v - mean);
+		var /= n;
+
+		REQUIRE(std::abs(mean - 3.0) < 0.01);
+		REQUIRE(std::abs(std::sqrt(var) - 0.5) < 0.01);
+	}
+
+	SECTION("bernoulli") {
+		t.fillBernoulli(0.25f, 3);
+		std::vector<float> values = t.toVector();
+
+		double ones = 0.0;
+		for (float v : values) {
+			REQUIRE((v == 0.0f || v == 1.0f));
+			ones += v;
+		}
+
+		REQUIRE(std::abs(ones / n - 0.25) < 0.01);
+	}
+}
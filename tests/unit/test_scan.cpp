@@ -0,0 +1,178 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Inclusive scan of `op` along the middle dim of `values` viewed as {outer, length, inner},
+/// computed in double.
+static std::vector<double> referenceScan(const std::vector<float>& values, size_t length,
+                                         size_t inner,
+                                         const std::function<double(double, double)>& op) {
+	std::vector<double> result(values.begin(), values.end());
+	for (size_t base = 0; base < values.size(); base += length * inner) {
+		for (size_t t = 1; t < length; t++) {
+			for (size_t j = 0; j < inner; j++) {
+				size_t pos = base + t * inner + j;
+				result[pos] = op(result[pos - inner], result[pos]);
+			}
+		}
+	}
+	return result;
+}
+
+TEST_CASE("Scans match a double reference", "[Scan]") {
+	// the long axis takes the blocked path, with a remainder after the last full chunk
+	Tensor::Shape shape = GENERATE(Tensor::Shape({3, 5}), Tensor::Shape({2, 5003}),
+	                               Tensor::Shape({4, 37, 6}));
+	size_t dim = shape.getNumDims() - 1;
+
+	Tensor x(shape);
+	x.fillUniform(0.5f, 1.5f, 21);
+	std::vector<float> values = x.toVector();
+
+	auto add = [](double a, double b) { return a + b; };
+	auto mul = [](double a, double b) { return a * b; };
+	auto max = [](double a, double b) { return std::max(a, b); };
+	auto min = [](double a, double b) { return std::min(a, b); };
+
+	for (size_t axis = 0; axis <= dim; axis++) {
+		size_t length = shape.getDim(axis);
+		size_t inner = 1;
+		for (size_t d = axis + 1; d <= dim; d++) inner *= shape.getDim(d);
+
+		REQUIRE(x.cumsum(axis).getShape() == shape);
+		REQUIRE(allNear(x.cumsum(axis).toVector(), referenceScan(values, length, inner, add),
+		                1e-4));
+		REQUIRE(allNear(x.cummax(axis).toVector(), referenceScan(values, length, inner, max), 0.0));
+		REQUIRE(allNear(x.cummin(axis).toVector(), referenceScan(values, length, inner, min), 0.0));
+
+		// products of long lines leave the float range, compare the short ones
+		if (length < 100) {
+			REQUIRE(allNear(x.cumprod(axis).toVector(), referenceScan(values, length, inner, mul),
+			                1e-5));
+		}
+	}
+}
+
+TEST_CASE("Exclusive scans shift by one", "[Scan]") {
+	Tensor x({2, 4}, 2.0f);
+	x.set({1, 2}, Tensor(-3.0f));
+
+	REQUIRE(x.cumsum(1).toVector() ==
+	        std::vector<float>{2.0f, 4.0f, 6.0f, 8.0f, 2.0f, 4.0f, 1.0f, 3.0f});
+	REQUIRE(x.cumsum(1, true).toVector() ==
+	        std::vector<float>{0.0f, 2.0f, 4.0f, 6.0f, 0.0f, 2.0f, 4.0f, 1.0f});
+	REQUIRE(x.cumprod(1, true).toVector() ==
+	        std::vector<float>{1.0f, 2.0f, 4.0f, 8.0f, 1.0f, 2.0f, 4.0f, -12.0f});
+	REQUIRE(x.cumsum(0, true).toVector() ==
+	        std::vector<float>{0.0f, 0.0f, 0.0f, 0.0f, 2.0f, 2.0f, 2.0f, 2.0f});
+
+	const float inf = std::numeric_limits<float>::infinity();
+	std::vector<float> maxes = x.cummax(1, true).toVector();
+	REQUIRE(maxes[0] == -inf);
+	REQUIRE(maxes[7] == 2.0f);
+	REQUIRE(x.cummin(1, true).toVector()[4] == inf);
+	REQUIRE(x.cummin(1).toVector()[7] == -3.0f);
+}
+
+TEST_CASE("Scan dtypes", "[Scan]") {
+	SECTION("integers sum exactly in Int64") {
+		Tensor ints = Tensor({3000}, 1000000.0f).asType(DType::Int32);
+		Tensor sums = ints.cumsum(0);
+		REQUIRE(sums.getDType() == DType::Int64);
+		REQUIRE(sums.toVector()[2999] == 3.0e9f);
+		REQUIRE(ints.cummax(0).getDType() == DType::Int32);
+
+		Tensor bytes = Tensor({4}, 5.0f).asType(DType::Int8);
+		REQUIRE(bytes.cummin(0, true).toVector()[0] == 127.0f);
+	}
+
+	SECTION("masks count") {
+		Tensor x({2, 6});
+		x.fillUniform(-1.0f, 1.0f, 3);
+		Tensor mask = x > Tensor(0.0f);
+		Tensor counts = mask.cumsum(1);
+		REQUIRE(counts.getDType() == DType::Int64);
+
+		std::vector<float> total = mask.countNonzero(1).toVector();
+		std::vector<float> values = counts.toVector();
+		REQUIRE(values[5] == total[0]);
+		REQUIRE(values[11] == total[1]);
+		REQUIRE(mask.cummax(1).getDType() == DType::Bool);
+	}
+
+	SECTION("16 bit floats") {
+		Tensor half = Tensor({8}, 0.5f).asType(DType::Float16);
+		REQUIRE(half.cumsum(0).getDType() == DType::Float32);
+		REQUIRE(half.cumsum(0).toVector()[7] == 4.0f);
+		REQUIRE(half.cummax(0).getDType() == DType::Float16);
+	}
+
+	REQUIRE_THROWS_AS(Tensor({3}).cumsum(1), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor(1.0f).cumsum(0), std::runtime_error);
+}
+
+TEST_CASE("Scans read views", "[Scan]") {
+	Tensor parent({6, 5000});
+	parent.fillUniform(-1.0f, 1.0f, 8);
+
+	Tensor::View view = parent.subsample({2, 2});
+	Tensor copy = view.copy();
+
+	REQUIRE(tensor_equal(view.scan(ScanOp::Sum, 1), copy.cumsum(1)));
+	REQUIRE(tensor_equal(view.scan(ScanOp::Max, 0, true), copy.cummax(0, true)));
+
+	Tensor::View row = parent[3];
+	REQUIRE(tensor_equal(row.scan(ScanOp::Min, 0), parent.cummin(1)[3].copy()));
+	REQUIRE(tensor_equal(Tensor({2, 0}).cumsum(1), Tensor({2, 0})));
+}
+
+TEST_CASE("Long scans split over threads", "[Scan]") {
+	// one long line, fewer long rows than threads, and an outer dim with several column ranges
+	auto [shape, axis] = GENERATE(std::make_pair(Tensor::Shape({300000}), size_t{0}),
+	                              std::make_pair(Tensor::Shape({3, 100000}), size_t{1}),
+	                              std::make_pair(Tensor::Shape({2, 50, 3000}), size_t{1}));
+	bool exclusive = GENERATE(false, true);
+
+	Tensor x(shape);
+	x.fillUniform(-100.0f, 100.0f, 31);
+	Tensor ints = x.asType(DType::Int32);
+	std::vector<int32_t> values = ints.toVector<int32_t>();
+
+	size_t length = shape.getDim(axis);
+	size_t inner = 1;
+	for (size_t d = axis + 1; d < shape.getNumDims(); d++) inner *= shape.getDim(d);
+
+	// sums of integers are exact in any order
+	std::vector<int64_t> sums(values.begin(), values.end());
+	std::vector<int32_t> maxes = values;
+	for (size_t base = 0; base < values.size(); base += length * inner) {
+		for (size_t t = length - 1; t > 0 && exclusive; t--) {
+			for (size_t j = 0; j < inner; j++) {
+				sums[base + t * inner + j] = values[base + (t - 1) * inner + j];
+				maxes[base + t * inner + j] = values[base + (t - 1) * inner + j];
+			}
+		}
+		for (size_t j = 0; j < inner && exclusive; j++) {
+			sums[base + j] = 0;
+			maxes[base + j] = std::numeric_limits<int32_t>::lowest();
+		}
+		for (size_t t = 1; t < length; t++) {
+			for (size_t j = 0; j < inner; j++) {
+				size_t pos = base + t * inner + j;
+				sums[pos] += sums[pos - inner];
+				maxes[pos] = std::max(maxes[pos], maxes[pos - inner]);
+			}
+		}
+	}
+
+	REQUIRE(ints.cumsum(axis, exclusive).toVector<int64_t>() == sums);
+	REQUIRE(ints.cummax(axis, exclusive).toVector<int32_t>() == maxes);
+}
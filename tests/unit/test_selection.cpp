@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Indices of the `k` best of `values[begin, begin + count)`, ordered from the best and equal
+/// values by index.
+static std::vector<size_t> referenceTopk(const std::vector<float>& values, size_t begin,
+                                         size_t count, size_t k, bool largest) {
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return largest ? values[begin + a] > values[begin + b]
+		               : values[begin + a] < values[begin + b];
+	});
+	order.resize(k);
+	return order;
+}
+
+TEST_CASE("argmin and argmax", "[Selection]") {
+	DType dtype = GENERATE(DType::Float32, DType::Float64, DType::Float16, DType::Int32,
+	                       DType::UInt8);
+
+	// small integers repeat, so ties resolve to the first index
+	Tensor x = randomValues({5, 300}, 0.0f, 50.0f, dtype, 7);
+	std::vector<float> values = x.toVector();
+
+	Tensor argmax = x.argmax(1);
+	Tensor argmin = x.argmin(1);
+	REQUIRE(argmax.getDType() == DType::Int64);
+	REQUIRE(argmax.getShape() == Tensor::Shape({5}));
+
+	std::vector<float> maxIndices = argmax.toVector();
+	std::vector<float> minIndices = argmin.toVector();
+	for (size_t row = 0; row < 5; row++) {
+		auto begin = values.begin() + row * 300;
+		REQUIRE(maxIndices[row] == std::max_element(begin, begin + 300) - begin);
+		REQUIRE(minIndices[row] == std::min_element(begin, begin + 300) - begin);
+	}
+
+	SECTION("whole tensor") {
+		REQUIRE(x.argmax().toVector()[0] == std::max_element(values.begin(), values.end()) -
+		                                        values.begin());
+		REQUIRE(x.argmin().getShape() == Tensor::Shape());
+	}
+}
+
+TEST_CASE("argmax of special values", "[Selection]") {
+	Tensor x({2, 4}, 1.0f);
+	x.set({0, 2}, Tensor(std::numeric_limits<float>::quiet_NaN()));
+	x.set({0, 3}, Tensor(5.0f));
+	x.set({1, 1}, Tensor(-std::numeric_limits<float>::infinity()));
+
+	REQUIRE(x.argmax(1).toVector() == std::vector<float>{2.0f, 0.0f});
+	REQUIRE(x.argmin(1).toVector() == std::vector<float>{2.0f, 1.0f});
+
+	// the mask of an argmax over strided columns
+	Tensor parent({3, 8}, 0.0f);
+	parent.set({1, 6}, Tensor(3.0f));
+	Tensor mask = parent.subsample({1, 2}).copy() > Tensor(1.0f);
+	REQUIRE(mask.argmax(1).toVector() == std::vector<float>{0.0f, 3.0f, 0.0f});
+
+	// the first NaN wins wherever it is, and the rest of the block is not scanned past it
+	DType dtype = GENERATE(DType::Float32, DType::Float64, DType::Float16);
+	for (size_t length : {9, 100}) {
+		for (size_t position : {size_t{0}, size_t{1}, length / 2, length - 1}) {
+			Tensor line = Tensor({length}, 1.0f).cumsum(0).asType(dtype);
+			line.set({position}, Tensor(std::numeric_limits<float>::quiet_NaN()));
+			if (position + 3 < length) {
+				line.set({position + 2}, Tensor(std::numeric_limits<float>::quiet_NaN()));
+			}
+
+			REQUIRE(line.argmax(0).toVector()[0] == static_cast<float>(position));
+			REQUIRE(line.argmin(0).toVector()[0] == static_cast<float>(position));
+		}
+	}
+
+	Tensor empty({3, 0});
+	REQUIRE_THROWS_AS(empty.argmax(1), std::runtime_error);
+	REQUIRE(Tensor({0, 4}).argmin(1).getShape() == Tensor::Shape({0}));
+}
+
+TEST_CASE("topk", "[Selection]") {
+	size_t k = GENERATE(1, 7, 300);
+	bool largest = GENERATE(true, false);
+	DType dtype = GENERATE(DType::Float32, DType::Int32, DType::BFloat16);
+
+	Tensor x = randomValues({4, 300}, -20.0f, 20.0f, dtype, 3);
+	std::vector<float> values = x.toVector();
+
+	auto [top, indices] = x.topk(k, 1, largest);
+	REQUIRE(top.getShape() == Tensor::Shape({4, k}));
+	REQUIRE(top.getDType() == dtype);
+	REQUIRE(indices.getDType() == DType::Int64);
+
+	std::vector<float> topValues = top.toVector();
+	std::vector<float> topIndices = indices.toVector();
+	for (size_t row = 0; row < 4; row++) {
+		std::vector<size_t> expected = referenceTopk(values, row * 300, 300, k, largest);
+		for (size_t i = 0; i < k; i++) {
+			REQUIRE(topIndices[row * k + i] == expected[i]);
+			REQUIRE(topValues[row * k + i] == values[row * 300 + expected[i]]);
+		}
+	}
+
+	SECTION("the first of topk is argmax") {
+		std::vector<float> best = (largest ? x.argmax(1) : x.argmin(1)).toVector();
+		for (size_t row = 0; row < 4; row++) {
+			REQUIRE(topIndices[row * k] == best[row]);
+		}
+	}
+}
+
+TEST_CASE("topk over trailing blocks", "[Selection]") {
+	Tensor x = randomValues({2, 3, 5}, 0.0f, 1.0f, DType::Float32, 11);
+
+	auto [top, indices] = x.topk(4, 1);
+	REQUIRE(top.getShape() == Tensor::Shape({2, 4}));
+
+	// indices count within the {3, 5} block in row-major order
+	std::vector<float> values = x.toVector();
+	std::vector<float> topValues = top.toVector();
+	std::vector<float> topIndices = indices.toVector();
+	for (size_t i = 0; i < 8; i++) {
+		size_t block = i / 4;
+		REQUIRE(values[block * 15 + (size_t)topIndices[i]] == topValues[i]);
+	}
+
+	auto [all, allIndices] = x.topk(30);
+	REQUIRE(all.getShape() == Tensor::Shape({30}));
+	REQUIRE(allIndices.toVector()[0] == x.argmax().toVector()[0]);
+
+	REQUIRE(x.topk(0, 1).first.getShape() == Tensor::Shape({2, 0}));
+	REQUIRE_THROWS_AS(x.topk(16, 1), std::runtime_error);
+}
+
+TEST_CASE("topk splits blocks over threads", "[Selection]") {
+	// 3000 blocks of 20, several ranges of blocks
+	Tensor x = randomValues({3000, 20}, -1.0f, 1.0f, DType::Float32, 12);
+	auto [top, indices] = x.topk(3, 1);
+	REQUIRE(top.getShape() == Tensor::Shape({3000, 3}));
+
+	std::vector<float> values = x.toVector();
+	std::vector<float> topIndices = indices.toVector();
+	for (size_t block = 0; block < 3000; block++) {
+		std::vector<size_t> reference = referenceTopk(values, block * 20, 20, 3, true);
+		for (size_t i = 0; i < 3; i++) REQUIRE(topIndices[block * 3 + i] == reference[i]);
+	}
+
+	// Float16 blocks are converted through a buffer per range
+	auto [half, halfIndices] = x.asType(DType::Float16).topk(3, 1);
+	REQUIRE(half.getDType() == DType::Float16);
+	REQUIRE(halfIndices.getShape() == Tensor::Shape({3000, 3}));
+	REQUIRE(tensor_equal(half.asType(DType::Float32),
+	                     x.asType(DType::Float16).asType(DType::Float32).topk(3, 1).first));
+}
@@ -2,6 +2,7 @@
 #include <catch2/matchers/catch_matchers_string.hpp>
 
 #include "nforge/nforge.h"
+#include "ops/semantic/context_cache.h"
 #include "ops/semantic/semantic.h"
 
 TEST_CASE("Binary operation Tensor vs Tensor", "[Semantic]") {
@@ -159,3 +160,90 @@ TEST_CASE("Throw on invalid dim in reduction operation", "[Semantic]") {
 	REQUIRE_THROWS(semantic::ReductionContext::build(a, -1));
 	REQUIRE_THROWS(semantic::ReductionContext::build(a, 4));
 }
+
+TEST_CASE("In-place operation on size-1 dims", "[Semantic]") {
+	Tensor a({1, 2}, 1.0f, Backend::CPU);
+	Tensor b({1, 1}, 2.0f, Backend::CPU);
+
+	auto ctx = semantic::InplaceBinaryOpContext::build(a, b);
+	REQUIRE(ctx.lhs.shape[0] == 1);
+	REQUIRE(ctx.lhs.shape[1] == 2);
+
+	REQUIRE_THROWS(semantic::InplaceBinaryOpContext::build(b, a));
+
+	a += b;
+	REQUIRE(a.isEqual(Tensor({1, 2}, 3.0f, Backend::CPU)));
+}
+
+
+TEST_CASE("Context cache hits on repeated layouts", "[Semantic]") {
+	Tensor a({4, 3}, 1.0f, Backend::CPU), b({3}, 2.0f, Backend::CPU);
+
+	semantic::clearContextCache();
+	semantic::resetContextCacheStats();
+
+	auto first = semantic::BinaryOpContext::lookup(a, b);
+	auto second = semantic::BinaryOpContext::lookup(a, b);
+	auto built = semantic::BinaryOpContext::build(a, b);
+
+	REQUIRE(first.lhs == built.lhs);
+	REQUIRE(first.rhs == built.rhs);
+	REQUIRE(first.out == built.out);
+	REQUIRE(second.out == built.out);
+
+	auto stats = semantic::getContextCacheStats();
+	REQUIRE(stats.misses == 1);
+	REQUIRE(stats.hits == 1);
+}
+
+TEST_CASE("Context cache separates kinds and layouts", "[Semantic]") {
+	Tensor a({4, 3}, 1.0f, Backend::CPU), b({4, 3}, 2.0f, Backend::CPU);
+	Tensor c({3, 5}, 1.0f, Backend::CPU);
+
+	semantic::clearContextCache();
+	semantic::resetContextCacheStats();
+
+	semantic::BinaryOpContext::lookup(a, b);
+	semantic::InplaceBinaryOpContext::lookup(a, b);
+	semantic::BinaryOpContext::lookup(a[1], b[2]);
+	semantic::MatmulContext::lookup(a, c);
+
+	auto red0 = semantic::ReductionContext::lookup(a, 0);
+	auto red1 = semantic::ReductionContext::lookup(a, 1);
+
+	REQUIRE(red0.out.rank == 0);
+	REQUIRE(red1.out.rank == 1);
+
+	auto stats = semantic::getContextCacheStats();
+	REQUIRE(stats.misses == 6);
+	REQUIRE(stats.hits == 0);
+
+	semantic::clearContextCache();
+	semantic::MatmulContext::lookup(a, c);
+	REQUIRE(semantic::getContextCacheStats().misses == 7);
+}
+
+TEST_CASE("Context cache does not cache failed builds", "[Semantic]") {
+	Tensor a({4, 3}, 1.0f, Backend::CPU), b({2, 3}, 2.0f, Backend::CPU);
+
+	semantic::clearContextCache();
+	semantic::resetContextCacheStats();
+
+	REQUIRE_THROWS(semantic::BinaryOpContext::lookup(a, b));
+	REQUIRE_THROWS(semantic::BinaryOpContext::lookup(a, b));
+
+	REQUIRE(semantic::getContextCacheStats().hits == 0);
+}
+
+TEST_CASE("Context cache serves tensor operations", "[Semantic]") {
+	Tensor a({8}, 1.0f, Backend::CPU), b({8}, 2.0f, Backend::CPU);
+
+	semantic::resetContextCacheStats();
+
+	for (int i = 0; i < 10; i++) {
+		a += b;
+	}
+
+	REQUIRE(semantic::getContextCacheStats().hits >= 9);
+	REQUIRE(a.isEqual(Tensor({8}, 21.0f, Backend::CPU)));
+}
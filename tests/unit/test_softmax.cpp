@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// log(sum(exp(x))) of each run of `blockCount` values, computed in double.
+static std::vector<double> referenceLogSumExp(const std::vector<float>& values,
+                                              size_t blockCount) {
+	std::vector<double> result;
+	for (size_t begin = 0; begin < values.size(); begin += blockCount) {
+		double max = values[begin];
+		for (size_t t = 0; t < blockCount; t++) max = std::max(max, (double)values[begin + t]);
+
+		double sum = 0.0;
+		for (size_t t = 0; t < blockCount; t++) sum += std::exp(values[begin + t] - max);
+		result.push_back(max + std::log(sum));
+	}
+	return result;
+}
+
+TEST_CASE("Softmax matches a double reference", "[Softmax]") {
+	// rows longer than a chunk, ramps make the running max grow inside a row
+	size_t cols = GENERATE(5, 64, 300);
+	Tensor x({4, cols});
+	x.fillUniform(-20.0f, 20.0f, 17);
+	for (size_t j = 0; j < cols; j++) x.set({2, j}, Tensor(0.25f * j));
+
+	std::vector<float> values = x.toVector();
+	std::vector<double> lse = referenceLogSumExp(values, cols);
+
+	std::vector<double> softmax, logSoftmax;
+	for (size_t i = 0; i < values.size(); i++) {
+		logSoftmax.push_back(values[i] - lse[i / cols]);
+		softmax.push_back(std::exp(logSoftmax.back()));
+	}
+
+	REQUIRE(x.logSumExp(1).getShape() == Tensor::Shape({4}));
+	REQUIRE(allNear(x.logSumExp(1).toVector(), lse, 1e-5));
+	REQUIRE(x.softmax(1).getShape() == x.getShape());
+	REQUIRE(allNear(x.softmax(1).toVector(), softmax, 1e-5));
+	REQUIRE(allNear(x.logSoftmax(1).toVector(), logSoftmax, 1e-5));
+
+	// rows sum to one
+	Tensor ones({4}, 1.0f);
+	REQUIRE(x.softmax(1).sum(1).isClose(ones, 1e-5f).all().toVector()[0] == 1.0f);
+
+	SECTION("whole tensor") {
+		std::vector<double> total = referenceLogSumExp(values, values.size());
+		REQUIRE(allNear(x.logSumExp().toVector(), total, 1e-5));
+		REQUIRE(x.softmax().sum().isClose(Tensor(1.0f), 1e-5f).all().toVector()[0] == 1.0f);
+	}
+}
+
+TEST_CASE("Softmax does not overflow", "[Softmax]") {
+	Tensor x({3}, 1000.0f);
+	x.set({1}, Tensor(1001.0f));
+	x.set({2}, Tensor(-1000.0f));
+
+	double expected = 1001.0 + std::log(1.0 + std::exp(-1.0));
+	REQUIRE(allNear(x.logSumExp().toVector(), {expected}, 1e-6));
+
+	double low = 1.0 / (1.0 + std::exp(1.0));
+	REQUIRE(allNear(x.softmax().toVector(), {low, 1.0 - low, 0.0}, 1e-6));
+	// the shift is rounded to float at 1001, one ulp there is 6e-5
+	std::vector<double> logSoftmax = {1000.0 - expected, 1001.0 - expected, -1000.0 - expected};
+	REQUIRE(allNear(x.logSoftmax().toVector(), logSoftmax, 1e-4));
+}
+
+TEST_CASE("Softmax reads strided views", "[Softmax]") {
+	Tensor parent({6, 40});
+	parent.fillUniform(-3.0f, 3.0f, 5);
+
+	Tensor::View view = parent.subsample({2, 3});
+	Tensor copy = view.copy();
+
+	REQUIRE(tensor_equal(view.softmax(1), copy.softmax(1)));
+	REQUIRE(tensor_equal(view.logSoftmax(1), copy.logSoftmax(1)));
+	REQUIRE(tensor_equal(view.logSumExp(1), copy.logSumExp(1)));
+
+	Tensor::View row = parent[4];
+	REQUIRE(tensor_equal(row.softmax(), parent.softmax(1)[4].copy()));
+}
+
+TEST_CASE("Softmax splits strided blocks over threads", "[Softmax]") {
+	// 1200 blocks of 50, enough for several ranges that start inside the outer dims
+	Tensor parent({50, 40, 30});
+	parent.fillUniform(-3.0f, 3.0f, 6);
+
+	Tensor::View view = parent.transpose(0, 2);
+	Tensor copy = view.copy();
+
+	REQUIRE(tensor_equal(view.softmax(2), copy.softmax(2)));
+	REQUIRE(tensor_equal(view.logSoftmax(2), copy.logSoftmax(2)));
+	REQUIRE(tensor_equal(view.logSumExp(2), copy.logSumExp(2)));
+}
+
+TEST_CASE("Softmax dtypes", "[Softmax]") {
+	Tensor x({2, 8});
+	x.fillUniform(-2.0f, 2.0f, 9);
+	std::vector<double> lse = referenceLogSumExp(x.toVector(), 8);
+
+	SECTION("floating dtypes are kept") {
+		DType dtype = GENERATE(DType::Float64, DType::Float16, DType::BFloat16);
+		double tolerance = dtype == DType::Float64 ? 1e-6 : 1e-2;
+
+		Tensor result = x.asType(dtype).logSumExp(1);
+		REQUIRE(result.getDType() == dtype);
+		REQUIRE(allNear(result.toVector(), lse, tolerance));
+		REQUIRE(x.asType(dtype).softmax(1).getDType() == dtype);
+	}
+
+	SECTION("integers compute as Float32") {
+		Tensor ints = Tensor({2, 3}, 1.0f).asType(DType::Int32);
+		Tensor result = ints.softmax(1);
+		REQUIRE(result.getDType() == DType::Float32);
+		REQUIRE(allNear(result.toVector(), std::vector<double>(6, 1.0 / 3.0), 1e-6));
+	}
+
+	REQUIRE_THROWS_AS(x.softmax(3), std::runtime_error);
+}
@@ -0,0 +1,181 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+#include "backend/cpu/thread_pool.h"
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Stable order of `values[begin, begin + count)`, ascending or descending.
+static std::vector<size_t> referenceOrder(const std::vector<float>& values, size_t begin,
+                                          size_t count, bool descending) {
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return descending ? values[begin + a] > values[begin + b]
+		                  : values[begin + a] < values[begin + b];
+	});
+	return order;
+}
+
+TEST_CASE("sort and argsort", "[Sort]") {
+	// below and above the radix sort threshold
+	size_t cols = GENERATE(5, 100, 1000);
+	bool descending = GENERATE(false, true);
+	DType dtype = GENERATE(DType::Float32, DType::Float64, DType::BFloat16, DType::Int32,
+	                       DType::Int64, DType::Int8);
+
+	// negative values exercise the sign handling, few distinct integers the ties
+	Tensor x = randomValues({3, cols}, -60.0f, 60.0f, dtype, 5);
+	std::vector<float> values = x.toVector();
+
+	Tensor sorted = x.sort(1, descending);
+	Tensor indices = x.argsort(1, descending);
+	REQUIRE(sorted.getDType() == dtype);
+	REQUIRE(sorted.getShape() == x.getShape());
+	REQUIRE(indices.getDType() == DType::Int64);
+
+	std::vector<float> sortedValues = sorted.toVector();
+	std::vector<float> sortedIndices = indices.toVector();
+	for (size_t row = 0; row < 3; row++) {
+		std::vector<size_t> expected = referenceOrder(values, row * cols, cols, descending);
+		for (size_t i = 0; i < cols; i++) {
+			REQUIRE(sortedIndices[row * cols + i] == expected[i]);
+			REQUIRE(sortedValues[row * cols + i] == values[row * cols + expected[i]]);
+		}
+	}
+
+	SECTION("whole tensor") {
+		std::vector<float> all = x.sort(0, descending).toVector();
+		std::vector<float> expected = values;
+		std::stable_sort(expected.begin(), expected.end());
+		if (descending) {
+			std::reverse(expected.begin(), expected.end());
+		}
+		REQUIRE(all == expected);
+	}
+}
+
+TEST_CASE("long sorts split over threads", "[Sort]") {
+	// one block long enough to split inside the radix passes, then a batch split by block
+	Tensor::Shape shape = GENERATE(Tensor::Shape({300000}), Tensor::Shape({64, 3000}));
+	bool descending = GENERATE(false, true);
+
+	// few distinct values, so stability decides most of the order
+	Tensor x = randomValues(shape, -1000.0f, 1000.0f, DType::Int32, 7);
+	std::vector<float> values = x.toVector();
+
+	size_t cols = shape.getDim(shape.getNumDims() - 1);
+	size_t rows = values.size() / cols;
+	std::vector<float> expectedValues, expectedIndices;
+	for (size_t row = 0; row < rows; row++) {
+		for (size_t index : referenceOrder(values, row * cols, cols, descending)) {
+			expectedIndices.push_back(static_cast<float>(index));
+			expectedValues.push_back(values[row * cols + index]);
+		}
+	}
+
+	size_t dim = shape.getNumDims() - 1;
+	REQUIRE(x.argsort(dim, descending).toVector() == expectedIndices);
+	REQUIRE(x.sort(dim, descending).toVector() == expectedValues);
+}
+
+TEST_CASE("sort of special values", "[Sort]") {
+	const float inf = std::numeric_limits<float>::infinity();
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+
+	// long enough for the radix path, the specials sit in the middle
+	size_t count = GENERATE(8, 400);
+	Tensor x = randomValues({count}, -1.0f, 1.0f, DType::Float32, 2);
+	x.set({1}, Tensor(nan));
+	x.set({3}, Tensor(inf));
+	x.set({4}, Tensor(-inf));
+	x.set({5}, Tensor(-0.0f));
+
+	std::vector<float> ascending = x.sort().toVector();
+	REQUIRE(ascending[0] == -inf);
+	REQUIRE(ascending[count - 2] == inf);
+	REQUIRE(std::isnan(ascending[count - 1]));
+	REQUIRE(std::is_sorted(ascending.begin(), ascending.end() - 1));
+
+	std::vector<float> order = x.argsort(0, true).toVector();
+	REQUIRE(order[0] == 1.0f);
+	REQUIRE(order[1] == 3.0f);
+	REQUIRE(order[count - 1] == 4.0f);
+}
+
+TEST_CASE("sort reads views and other dtypes", "[Sort]") {
+	Tensor parent = randomValues({4, 600}, -5.0f, 5.0f, DType::Float32, 9);
+	Tensor::View even = parent.subsample({1, 2});
+	Tensor copy = even.copy();
+
+	REQUIRE(tensor_equal(even.sort(1), copy.sort(1)));
+	REQUIRE(tensor_equal(even.argsort(1, true), copy.argsort(1, true)));
+	REQUIRE(tensor_equal(even.partition(7, 1).sort(1), copy.sort(1)));
+
+	// trailing dims sort as one block
+	Tensor cube = randomValues({2, 3, 100}, 0.0f, 1.0f, DType::Float16, 4);
+	std::vector<float> flat = cube.sort(1).toVector();
+	REQUIRE(std::is_sorted(flat.begin(), flat.begin() + 300));
+	REQUIRE(std::is_sorted(flat.begin() + 300, flat.end()));
+
+	Tensor mask = parent > Tensor(0.0f);
+	std::vector<float> bits = mask.sort(1, true).toVector();
+	REQUIRE(std::is_sorted(bits.begin(), bits.begin() + 600, std::greater<float>()));
+
+	Tensor bytes = randomValues({300}, 0.0f, 250.0f, DType::UInt8, 6);
+	std::vector<float> sortedBytes = bytes.sort().toVector();
+	REQUIRE(std::is_sorted(sortedBytes.begin(), sortedBytes.end()));
+
+	REQUIRE(Tensor({3, 0}).sort(1).getShape() == Tensor::Shape({3, 0}));
+}
+
+TEST_CASE("partition", "[Sort]") {
+	size_t kth = GENERATE(0, 17, 499);
+	DType dtype = GENERATE(DType::Float32, DType::Int32, DType::Float16);
+
+	Tensor x = randomValues({3, 500}, -100.0f, 100.0f, dtype, 12);
+	std::vector<float> sorted = x.sort(1).toVector();
+	std::vector<float> parted = x.partition(kth, 1).toVector();
+	REQUIRE(x.partition(kth, 1).getDType() == dtype);
+
+	for (size_t row = 0; row < 3; row++) {
+		auto begin = parted.begin() + row * 500;
+		float pivot = begin[kth];
+		REQUIRE(pivot == sorted[row * 500 + kth]);
+		REQUIRE(std::all_of(begin, begin + kth, [&](float v) { return v <= pivot; }));
+		REQUIRE(std::all_of(begin + kth, begin + 500, [&](float v) { return v >= pivot; }));
+
+		// a permutation of the row
+		std::vector<float> rowValues(begin, begin + 500);
+		std::sort(rowValues.begin(), rowValues.end());
+		REQUIRE(std::equal(rowValues.begin(), rowValues.end(), sorted.begin() + row * 500));
+	}
+
+	REQUIRE_THROWS_AS(x.partition(500, 1), std::runtime_error);
+}
+
+TEST_CASE("partitions of many rows split over threads", "[Sort]") {
+	size_t threads = GENERATE(1, 4);
+	const size_t rows = 256, cols = 300, kth = 150;
+
+	Tensor x = randomValues({rows, cols}, -1000.0f, 1000.0f, DType::Float32, 13);
+	std::vector<float> sorted = x.sort(1).toVector();
+
+	cpu::setNumThreads(threads);
+	std::vector<float> parted = x.partition(kth, 1).toVector();
+	cpu::setNumThreads(0);
+
+	for (size_t row = 0; row < rows; row++) {
+		auto begin = parted.begin() + row * cols;
+		float pivot = begin[kth];
+		REQUIRE(pivot == sorted[row * cols + kth]);
+		REQUIRE(std::all_of(begin, begin + kth, [&](float v) { return v <= pivot; }));
+		REQUIRE(std::all_of(begin + kth, begin + cols, [&](float v) { return v >= pivot; }));
+	}
+}
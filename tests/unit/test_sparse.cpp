@@ -0,0 +1,206 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Random (rows, cols) matrix with about `density` of its elements nonzero.
+static Tensor randomSparseDense(size_t rows, size_t cols, float density, uint64_t seed) {
+	Tensor values({rows, cols});
+	values.fillUniform(-1.0f, 1.0f, seed);
+	Tensor keep({rows, cols});
+	keep.fillUniform(0.0f, 1.0f, seed + 1);
+	return values * (keep < Tensor(density));
+}
+
+/// Largest absolute difference between two tensors of one shape, on the host.
+static float maxError(const Tensor& actual, const Tensor& expected) {
+	REQUIRE(actual.getShape() == expected.getShape());
+	std::vector<float> a = actual.toVector();
+	std::vector<float> e = expected.toVector();
+
+	float error = 0.0f;
+	for (size_t i = 0; i < a.size(); i++) error = std::max(error, std::abs(a[i] - e[i]));
+	return error;
+}
+
+TEST_CASE("sparse matrices round trip through dense and COO", "[Sparse]") {
+	Tensor dense = randomSparseDense(50, 70, 0.05f, 1);
+	// a row with every element stored and an empty last row
+	dense[3] = Tensor({70}, 2.0f);
+	dense[49] = Tensor({70});
+
+	Tensor::Sparse sparse = Tensor::Sparse::fromDense(dense);
+	REQUIRE(sparse.getShape() == Tensor::Shape({50, 70}));
+	REQUIRE(sparse.getDType() == DType::Float32);
+	REQUIRE(sparse.getNumNonzero() == dense.countNonzero().toVector()[0]);
+	REQUIRE(tensor_equal(sparse.toDense(), dense));
+
+	auto [rows, cols, values] = sparse.toCOO();
+	REQUIRE(rows.getDType() == DType::Int64);
+	REQUIRE(cols.getDType() == DType::Int64);
+
+	// row-major order without duplicates
+	std::vector<float> r = rows.toVector(), c = cols.toVector();
+	for (size_t e = 1; e < r.size(); e++) {
+		REQUIRE((r[e - 1] < r[e] || (r[e - 1] == r[e] && c[e - 1] < c[e])));
+	}
+
+	REQUIRE(tensor_equal(Tensor::Sparse::fromCOO({50, 70}, rows, cols, values).toDense(), dense));
+
+	// a strided view converts like its copy
+	Tensor::View columns = dense.transpose(0, 1);
+	REQUIRE(tensor_equal(Tensor::Sparse::fromDense(columns).toDense(), columns.copy()));
+}
+
+TEST_CASE("fromCOO sorts entries and sums duplicates", "[Sparse]") {
+	Tensor rows({5}, DType::Int32), cols({5}, DType::Int64), values({5});
+	std::vector<std::array<float, 3>> entries = {
+	    {2, 1, 1.0f}, {0, 3, 2.0f}, {2, 1, 3.0f}, {0, 0, 4.0f}, {2, 0, 5.0f}};
+	for (size_t e = 0; e < entries.size(); e++) {
+		rows[e] = entries[e][0];
+		cols[e] = entries[e][1];
+		values[e] = entries[e][2];
+	}
+
+	Tensor::Sparse sparse = Tensor::Sparse::fromCOO({3, 4}, rows, cols, values);
+	REQUIRE(sparse.getNumNonzero() == 4);
+
+	Tensor expected({3, 4});
+	expected[0][0] = 4.0f;
+	expected[0][3] = 2.0f;
+	expected[2][0] = 5.0f;
+	expected[2][1] = 4.0f;
+	REQUIRE(tensor_equal(sparse.toDense(), expected));
+
+	// no entries at all
+	Tensor none({0}, DType::Int64);
+	REQUIRE(Tensor::Sparse::fromCOO({2, 2}, none, none, Tensor({0})).getNumNonzero() == 0);
+}
+
+TEST_CASE("sparse matmul matches dense matmul", "[Sparse]") {
+	// small enough to stay on one thread, then large enough to split the rows
+	size_t rows = GENERATE(9, 1500);
+	Tensor dense = randomSparseDense(rows, 300, 0.02f, 2);
+	// a few dense rows the partition has to balance
+	dense[rows / 2] = Tensor({300}, 0.5f);
+	dense[rows - 1] = Tensor({300}, -0.5f);
+	Tensor::Sparse sparse = Tensor::Sparse::fromDense(dense);
+
+	// SpMV
+	Tensor vector({300});
+	vector.fillUniform(-1.0f, 1.0f, 3);
+	Tensor y = sparse.matmul(vector);
+	REQUIRE(y.getShape() == Tensor::Shape({rows}));
+	REQUIRE(maxError(y, dense.matmul(vector.unsqueeze(1)).reshape({rows}).copy()) <= 1e-4f);
+
+	// SpMM, also through a transposed view
+	Tensor matrix({300, 17});
+	matrix.fillUniform(-1.0f, 1.0f, 4);
+	REQUIRE(maxError(sparse.matmul(matrix), dense.matmul(matrix)) <= 1e-4f);
+
+	Tensor transposed({17, 300});
+	transposed.fillUniform(-1.0f, 1.0f, 5);
+	REQUIRE(maxError(sparse.matmul(transposed.transpose(0, 1)),
+	                 dense.matmul(transposed.transpose(0, 1).copy())) <= 1e-4f);
+
+	// the dtypes promote
+	Tensor doubles = matrix.asType(DType::Float64);
+	Tensor product = sparse.matmul(doubles);
+	REQUIRE(product.getDType() == DType::Float64);
+	REQUIRE(maxError(product.asType(DType::Float32), dense.matmul(matrix)) <= 1e-4f);
+}
+
+TEST_CASE("elementwise ops with dense operands", "[Sparse]") {
+	Tensor dense = randomSparseDense(40, 30, 0.1f, 6);
+	Tensor::Sparse sparse = Tensor::Sparse::fromDense(dense);
+	Tensor other({40, 30});
+	other.fillUniform(1.0f, 2.0f, 7);
+
+	REQUIRE(maxError(sparse + other, dense + other) <= 1e-6f);
+	REQUIRE(maxError(sparse - other, dense - other) <= 1e-6f);
+
+	Tensor::Sparse product = sparse * other;
+	REQUIRE(product.getNumNonzero() == sparse.getNumNonzero());
+	REQUIRE(maxError(product.toDense(), dense * other) <= 1e-6f);
+	REQUIRE(maxError((sparse / other).toDense(), dense / other) <= 1e-6f);
+
+	// operands broadcast, a scalar keeps the dtype
+	Tensor row({30});
+	row.fillUniform(1.0f, 2.0f, 8);
+	REQUIRE(maxError((sparse * row).toDense(), dense * row) <= 1e-6f);
+	REQUIRE(maxError(sparse + Tensor(1.0f), dense + 1.0f) <= 1e-6f);
+	REQUIRE((sparse * Tensor(2.0f)).getDType() == DType::Float32);
+
+	// elements that are not stored stay zero
+	Tensor zeros({40, 30});
+	Tensor quotient = (sparse / zeros).toDense();
+	REQUIRE(tensor_equal(quotient == Tensor(0.0f), dense == Tensor(0.0f)));
+
+	// integers divide as Float32
+	Tensor::Sparse ints = Tensor::Sparse::fromDense(Tensor({2, 2}, 3.0f).asType(DType::Int32));
+	REQUIRE((ints * Tensor({2, 2}, 2.0f).asType(DType::Int32)).getDType() == DType::Int32);
+	Tensor half = (ints / Tensor({2, 2}, 2.0f).asType(DType::Int32)).toDense();
+	REQUIRE(half.getDType() == DType::Float32);
+	REQUIRE(half.toVector()[0] == 1.5f);
+}
+
+TEST_CASE("sparse storage is a fraction of the dense memory", "[Sparse]") {
+	// 0.5% nonzeros, the dense Float32 matrix takes 4 MB
+	Tensor dense = randomSparseDense(1000, 1000, 0.005f, 9);
+
+	uint64_t before = profiling::getMemoryStats(Backend::CPU).liveBytes;
+	Tensor::Sparse sparse = Tensor::Sparse::fromDense(dense);
+	uint64_t held = profiling::getMemoryStats(Backend::CPU).liveBytes - before;
+
+	REQUIRE(held == sparse.getNumBytes());
+	REQUIRE(sparse.getNumBytes() == 1001 * 8 + sparse.getNumNonzero() * 8);
+	REQUIRE(sparse.getNumBytes() * 80 < dense.getNumElements() * 4);
+
+	// copies are deep
+	Tensor::Sparse copy = sparse;
+	REQUIRE(profiling::getMemoryStats(Backend::CPU).liveBytes - before == 2 * held);
+	REQUIRE(tensor_equal(copy.toDense(), dense));
+}
+
+TEST_CASE("sparse dtypes and errors", "[Sparse]") {
+	Tensor doubles({3, 3}, DType::Float64);
+	doubles[1][2] = 4.0f;
+	Tensor::Sparse sparse = Tensor::Sparse::fromDense(doubles);
+	REQUIRE(sparse.getDType() == DType::Float64);
+	REQUIRE(sparse.toDense().getDType() == DType::Float64);
+	REQUIRE(sparse.matmul(Tensor({3}, 1.0f)).getDType() == DType::Float64);
+
+	// empty matrices are fine
+	Tensor::Sparse empty = Tensor::Sparse::fromDense(Tensor({0, 4}));
+	REQUIRE(empty.matmul(Tensor({4, 2})).getShape() == Tensor::Shape({0, 2}));
+
+	Tensor index({2}, DType::Int64), values({2});
+	index[1] = 3.0f;
+	REQUIRE_THROWS_AS(Tensor::Sparse::fromCOO({3, 3}, index, Tensor({2}, DType::Int64), values),
+	                  std::out_of_range);
+	REQUIRE_THROWS_AS(Tensor::Sparse::fromCOO({3, 3}, Tensor({2}), index, values),
+	                  std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::Sparse::fromCOO({3, 3}, index, index, Tensor({3})),
+	                  std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::Sparse::fromCOO({3, 3, 3}, index, index, values),
+	                  std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::Sparse::fromDense(Tensor({3})), std::runtime_error);
+
+	REQUIRE_THROWS_AS(sparse.matmul(Tensor({4})), std::runtime_error);
+	REQUIRE_THROWS_AS(sparse.matmul(Tensor({3, 3, 3})), std::runtime_error);
+	REQUIRE_THROWS_AS(sparse + Tensor({2, 3}), std::runtime_error);
+	REQUIRE_THROWS_AS(sparse * Tensor({4}), std::runtime_error);
+
+	Tensor x({3}, 1.0f);
+	REQUIRE_THROWS_AS(Tensor::Graph::capture({x}, [&]() { sparse.matmul(x); }),
+	                  std::runtime_error);
+
+	Tensor::Tape tape({x});
+	REQUIRE_THROWS_AS(sparse.matmul(x), std::runtime_error);
+}
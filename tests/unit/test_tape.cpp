@@ -0,0 +1,261 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Sum of all elements of `t`, on the host.
+static float total(const Tensor& t) {
+	double sum = 0;
+	for (float value : t.toVector()) sum += value;
+	return (float)sum;
+}
+
+/// Central differences of the sum of `f()` with respect to every element of `param`.
+static std::vector<float> numericGradient(Tensor& param, const std::function<Tensor()>& f,
+                                          float eps = 1e-2f) {
+	std::vector<float> values = param.toVector();
+	std::vector<float> grad(values.size());
+	Tensor::View flat = param.reshape({values.size()});
+
+	for (size_t i = 0; i < values.size(); i++) {
+		flat[i] = Tensor(values[i] + eps);
+		float up = total(f());
+		flat[i] = Tensor(values[i] - eps);
+		float down = total(f());
+		flat[i] = Tensor(values[i]);
+		grad[i] = (up - down) / (2 * eps);
+	}
+	return grad;
+}
+
+/// Gradients of the sum of `f()` from a tape over `params`.
+static std::vector<Tensor> tapeGradient(const std::vector<std::reference_wrapper<Tensor>>& params,
+                                        const std::function<Tensor()>& f) {
+	Tensor::Tape tape(params);
+	Tensor output = f();
+	return tape.gradient(output);
+}
+
+static void requireClose(const std::vector<float>& actual, const std::vector<float>& expected,
+                         float tolerance = 2e-2f) {
+	REQUIRE(actual.size() == expected.size());
+	for (size_t i = 0; i < actual.size(); i++) {
+		INFO("element " << i << ": " << actual[i] << " vs " << expected[i]);
+		REQUIRE(std::abs(actual[i] - expected[i]) <= tolerance * (1 + std::abs(expected[i])));
+	}
+}
+
+/// Compares the tape gradient of `f` with central differences for every param.
+static void checkGradient(const std::vector<std::reference_wrapper<Tensor>>& params,
+                          const std::function<Tensor()>& f, float eps = 1e-2f) {
+	std::vector<Tensor> grads = tapeGradient(params, f);
+	REQUIRE(grads.size() == params.size());
+
+	for (size_t i = 0; i < params.size(); i++) {
+		INFO("param " << i);
+		REQUIRE(grads[i].getShape() == params[i].get().getShape());
+		requireClose(grads[i].toVector(), numericGradient(params[i], f, eps));
+	}
+}
+
+TEST_CASE("tape differentiates broadcast arithmetic", "[Tape]") {
+	Tensor a({3, 4}), b({4}), c(0.5f);
+	a.fillUniform(0.5f, 2.0f, 1);
+	b.fillUniform(0.5f, 2.0f, 2);
+
+	checkGradient({a, b, c}, [&]() { return (a * b + a / (b + 3.0f)) * c - b - 2.0f / a; });
+
+	// an operand read twice sums both uses
+	checkGradient({a}, [&]() { return a * a - a; });
+
+	// a parameter the output does not depend on gets zeros
+	std::vector<Tensor> grads = tapeGradient({a, b}, [&]() { return b * 2.0f; });
+	REQUIRE(tensor_equal(grads[0], Tensor({3, 4}, 0.0f)));
+	REQUIRE(tensor_equal(grads[1], Tensor({4}, 2.0f)));
+}
+
+TEST_CASE("tape follows in place updates and view writes", "[Tape]") {
+	Tensor x({2, 3}), w({3});
+	x.fillUniform(0.5f, 2.0f, 3);
+	w.fillUniform(0.5f, 2.0f, 4);
+
+	checkGradient({x, w}, [&]() {
+		Tensor y = x * 1.0f;
+		y += w;
+		y *= x;
+		y.slice(1, {0, 2}) -= w.slice(0, {1, 3});
+		y[1] = w * 2.0f;
+		y /= w + 4.0f;
+		y[0] *= y[0];
+		return y;
+	});
+
+	// masked elements lose their gradient, assignments and copies pass it on
+	checkGradient({x}, [&]() {
+		Tensor y = x;
+		y.maskedFill(x > Tensor(1.2f), 0.0f);
+		Tensor z({2, 3}, 1.0f);
+		z = y * x;
+		return z.transpose(0, 1).copy();
+	});
+}
+
+TEST_CASE("tape differentiates reductions", "[Tape]") {
+	Tensor x({3, 5});
+	x.fillUniform(0.5f, 2.0f, 5);
+
+	checkGradient({x}, [&]() { return x.sum(1) * Tensor({3}, 2.0f) + x.mean(); }, 1e-3f);
+	checkGradient({x}, [&]() { return x.max(1) - x.min(0); }, 1e-3f);
+	checkGradient({x}, [&]() { return x.norm(1) + x.norm(); }, 1e-3f);
+
+	// ties all get the gradient of their block
+	Tensor y({2, 2}, 1.0f);
+	std::vector<Tensor> grads = tapeGradient({y}, [&]() { return y.max(1); });
+	REQUIRE(tensor_equal(grads[0], Tensor({2, 2}, 1.0f)));
+}
+
+TEST_CASE("tape differentiates matmul", "[Tape]") {
+	Tensor a({3, 4}), b({4, 2}), batch({2, 3, 4});
+	a.fillUniform(-1.0f, 1.0f, 6);
+	b.fillUniform(-1.0f, 1.0f, 7);
+	batch.fillUniform(-1.0f, 1.0f, 8);
+
+	checkGradient({a, b}, [&]() { return a.matmul(b) * a.matmul(b); });
+	checkGradient({a, b}, [&]() { return b.transpose(0, 1).matmul(a.transpose(0, 1)); });
+
+	// the rhs is broadcast over the batch, its gradient sums over it
+	checkGradient({batch, b}, [&]() { return batch.matmul(b).sum(1).pow(2.0f); });
+}
+
+TEST_CASE("tape differentiates map", "[Tape]") {
+	Tensor x({2, 3});
+	x.fillUniform(0.3f, 1.5f, 9);
+
+	checkGradient({x}, [&]() { return x.exp() + x.log() + x.sqrt() + x.rsqrt(); }, 1e-3f);
+	checkGradient({x}, [&]() { return x.tanh() + x.sigmoid() + x.sin() * x.cos(); }, 1e-3f);
+	checkGradient({x}, [&]() { return (x - 1.0f).abs() + x.pow(3.0f); }, 1e-3f);
+	checkGradient({x}, [&]() { return x.clamp(0.6f, 1.2f) * x; }, 1e-3f);
+	checkGradient({x}, [&]() { return x.transpose(0, 1).map(UnaryOp::Exp); }, 1e-3f);
+}
+
+TEST_CASE("tape differentiates concat and stack", "[Tape]") {
+	Tensor a({2, 3}), b({2, 3});
+	a.fillUniform(-1.0f, 1.0f, 10);
+	b.fillUniform(-1.0f, 1.0f, 11);
+
+	checkGradient({a, b}, [&]() {
+		Tensor joined = Tensor::concat({a, b.transpose(0, 1).transpose(0, 1)}, 1);
+		return Tensor::stack({joined, joined * joined}, 1) * a.sum(1).sum();
+	});
+}
+
+TEST_CASE("checkpoints match plain recording with less memory", "[Tape]") {
+	Tensor force({2}, 0.0f);
+	force[1] = -2.0f;
+	Tensor drag(0.1f);
+
+	auto step = [](Tensor& s, Tensor& v, const Tensor& f, const Tensor& d) {
+		v += (f - v * d) * 0.01f;
+		s += v * 0.01f;
+	};
+
+	// 200 steps recorded one operation at a time
+	std::vector<Tensor> expected;
+	size_t plainBytes = 0;
+	{
+		Tensor::Tape tape({force, drag});
+		Tensor s({2}, 0.0f), v({2}, 1.0f);
+		for (size_t i = 0; i < 200; i++) step(s, v, force, drag);
+
+		plainBytes = tape.getSavedBytes();
+		expected = tape.gradient(s.sum() + v[1]);
+	}
+
+	// the same steps in 4 checkpoints, the parameters enter the body through its state
+	Tensor::Tape tape({force, drag});
+	Tensor s({2}, 0.0f), v({2}, 1.0f), f = force, d = drag;
+	for (size_t k = 0; k < 4; k++) {
+		tape.checkpoint({s, v, f, d}, [&]() {
+			for (size_t i = 0; i < 50; i++) step(s, v, f, d);
+		});
+	}
+	REQUIRE(tape.getNumNodes() == 4);
+
+	size_t checkpointBytes = tape.getSavedBytes();
+	std::vector<Tensor> grads = tape.gradient(s.sum() + v[1]);
+
+	REQUIRE(grads[0].allClose(expected[0], 1e-4f));
+	REQUIRE(grads[1].allClose(expected[1], 1e-4f));
+	REQUIRE(checkpointBytes * 4 < plainBytes);
+}
+
+TEST_CASE("checkpoints nest and reject reads outside their state", "[Tape]") {
+	Tensor x({3});
+	x.fillUniform(0.5f, 1.0f, 12);
+
+	auto steps = [](Tensor& z) {
+		for (size_t k = 0; k < 3; k++) z = z * z.sin() + 0.5f;
+	};
+
+	std::vector<Tensor> grads;
+	{
+		Tensor::Tape tape({x});
+		Tensor y = x * 1.0f;
+		tape.checkpoint({y}, [&]() {
+			for (size_t k = 0; k < 3; k++) {
+				tape.checkpoint({y}, [&]() { y = y * y.sin() + 0.5f; });
+			}
+		});
+		grads = tape.gradient(y);
+	}
+
+	requireClose(grads[0].toVector(), numericGradient(x, [&]() {
+		             Tensor z = x * 1.0f;
+		             steps(z);
+		             return z;
+	             }, 1e-3f));
+
+	// `x` is tracked but not part of the state
+	Tensor::Tape tape({x});
+	Tensor y({3}, 1.0f);
+	REQUIRE_THROWS_AS(tape.checkpoint({y}, [&]() { y += x; }), std::runtime_error);
+}
+
+TEST_CASE("tape errors", "[Tape]") {
+	Tensor x({2, 3}, 1.0f);
+	Tensor ints({2}, DType::Int32);
+
+	REQUIRE_THROWS_AS(Tensor::Tape({ints}), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::Tape({x, x}), std::runtime_error);
+
+	Tensor::Tape tape({x});
+	REQUIRE_THROWS_AS(Tensor::Tape({x}), std::runtime_error);
+	REQUIRE_THROWS_AS(Tensor::Graph::capture({x}, [&]() {}), std::runtime_error);
+
+	// no backward rule
+	REQUIRE_THROWS_AS(x.softmax(1), std::runtime_error);
+	REQUIRE_THROWS_AS(x.prod(1), std::runtime_error);
+	REQUIRE_THROWS_AS(x.cumsum(1), std::runtime_error);
+	REQUIRE_THROWS_AS(x.scatterAdd(1, Tensor({2, 1}, DType::Int64), Tensor(1.0f)),
+	                  std::runtime_error);
+
+	// untracked data and index results are fine
+	REQUIRE(Tensor({3}, 1.0f).softmax(0).getShape() == Tensor::Shape({3}));
+	REQUIRE(x.argmax(1).getDType() == DType::Int64);
+
+	// a tracked value left outside the state of a checkpoint
+	Tensor y = x * 2.0f;
+	Tensor leaked({2, 3});
+	REQUIRE_THROWS_AS(tape.checkpoint({y}, [&]() { leaked = y * 2.0f; }), std::runtime_error);
+
+	Tensor output = x.sum();
+	tape.gradient(output);
+	REQUIRE_THROWS_AS(tape.gradient(output), std::runtime_error);
+
+	// recording stopped, so untracked ops work again
+	REQUIRE(x.softmax(1).getShape() == Tensor::Shape({2, 3}));
+}
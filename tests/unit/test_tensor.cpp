@@ -331,6 +331,39 @@ TEST_CASE("Frobenius norm of 4-rank tensor", "[Tensor]") {
 	}
 }
 
+TEST_CASE("Norm along dims", "[Tensor]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		// rows are (3, 4), (6, 8), (0, 0)
+		Tensor a({3, 2}, 0.0f, backend);
+		a[0][0] = 3.0f;
+		a[0][1] = 4.0f;
+		a[1][0] = 6.0f;
+		a[1][1] = 8.0f;
+
+		SECTION("Row norms") {
+			Tensor expected({3}, 0.0f, backend);
+			expected[0] = 5.0f;
+			expected[1] = 10.0f;
+
+			Tensor norms = a.norm(1);
+			REQUIRE(norms.getShape() == Tensor::Shape({3}));
+			REQUIRE(tensor_equal(norms, expected));
+		}
+
+		SECTION("Full rank keeps the elements absolute") {
+			Tensor b = a * -1.0f;
+			REQUIRE(tensor_equal(b.norm(2), a));
+		}
+
+		SECTION("View") {
+			REQUIRE(tensor_equal(a[1].norm(), Tensor(10.0f, backend)));
+			REQUIRE(tensor_equal(a.subsample({1, 0}).norm(), Tensor(std::sqrt(45.0f), backend)));
+		}
+	}
+}
+
 TEST_CASE("Assign View to Tensor", "[Tensor]") {
 	auto backend = GENERATE(from_range(backends));
 
@@ -0,0 +1,43 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "backend/cpu/thread_pool.h"
+
+/// Distinct threads that run the ranges of one `parallelFor` of many slow ranges.
+static size_t countJobThreads() {
+	std::mutex mutex;
+	std::set<std::thread::id> ids;
+	cpu::parallelFor(64, 1, [&](size_t, size_t) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		std::lock_guard<std::mutex> lock(mutex);
+		ids.insert(std::this_thread::get_id());
+	});
+	return ids.size();
+}
+
+TEST_CASE("parallelFor runs on at most getNumThreads threads", "[ThreadPool]") {
+	size_t threads = cpu::getNumThreads();
+
+	for (size_t limit : {size_t{1}, size_t{2}, threads}) {
+		cpu::setNumThreads(limit);
+		REQUIRE(cpu::getNumThreads() == limit);
+		REQUIRE(countJobThreads() <= limit);
+	}
+
+	cpu::setNumThreads(0);
+	REQUIRE(cpu::getNumThreads() == threads);
+}
+
+TEST_CASE("parallelFor covers every item once", "[ThreadPool]") {
+	std::vector<int> hits(100003, 0);
+	cpu::parallelFor(hits.size(), 7, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) hits[i]++;
+	});
+	REQUIRE(std::all_of(hits.begin(), hits.end(), [](int hit) { return hit == 1; }));
+}
@@ -22,6 +22,26 @@ TEST_CASE("transfer preserves data", "[Tensor][transfer]") {
 	}
 }
 
+TEST_CASE("transfer keeps every bit of wide types", "[Tensor][transfer]") {
+	auto srcBackend = GENERATE(from_range(backends));
+	auto tgtBackend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(srcBackend) + " -> " + getBackendString(tgtBackend)) {
+		// 2^24 + 1 and 2^40 + 1 round away as floats
+		Tensor ints = Tensor({2}, 16777216.0f, srcBackend).asType(DType::Int64);
+		ints[1] = Tensor(1099511627776.0f, srcBackend).asType(DType::Int64);
+		ints += Tensor(1.0f, srcBackend).asType(DType::Int64);
+		Tensor thirds = Tensor({3}, 1.0f, srcBackend).asType(DType::Float64) / 3.0f;
+
+		ints.to(tgtBackend);
+		thirds.to(tgtBackend);
+
+		REQUIRE(ints.getDType() == DType::Int64);
+		REQUIRE(ints.toVector<int64_t>() == std::vector<int64_t>{16777217, 1099511627777});
+		REQUIRE(thirds.toVector<double>() == std::vector<double>(3, 1.0 / 3.0));
+	}
+}
+
 TEST_CASE("views update after transfer", "[View][transfer]") {
 	auto src = GENERATE(from_range(backends));
 	auto tgt = GENERATE(from_range(backends));
@@ -0,0 +1,204 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Distance between two floats in units in the last place.
+static int64_t ulpDistance(float a, float b) {
+	int32_t ia, ib;
+	std::memcpy(&ia, &a, sizeof(float));
+	std::memcpy(&ib, &b, sizeof(float));
+	// map the sign-magnitude bit patterns onto a monotonic integer line
+	int64_t la = ia < 0 ? int64_t(INT32_MIN) - ia : ia;
+	int64_t lb = ib < 0 ? int64_t(INT32_MIN) - ib : ib;
+	return la > lb ? la - lb : lb - la;
+}
+
+/// Largest ulp distance between `actual` and `reference` applied in double to `x`.
+static int64_t maxUlp(const Tensor& x, const Tensor& actual,
+                      const std::function<double(double)>& reference) {
+	std::vector<float> values = x.toVector();
+	std::vector<float> results = actual.toVector();
+
+	int64_t worst = 0;
+	for (size_t i = 0; i < values.size(); i++) {
+		float expected = static_cast<float>(reference(values[i]));
+		worst = std::max(worst, ulpDistance(results[i], expected));
+	}
+	return worst;
+}
+
+/// `count` values spread evenly over [low, high].
+static Tensor ramp(size_t count, float low, float high) {
+	Tensor result({count});
+	for (size_t i = 0; i < count; i++) {
+		float t = static_cast<float>(i) / static_cast<float>(count - 1);
+		result.set({i}, Tensor(low + (high - low) * t));
+	}
+	return result;
+}
+
+TEST_CASE("Unary functions stay within their documented error", "[Unary]") {
+	// longer than a vector and with a tail, to run the vector loop and the remainder
+	Tensor wide = ramp(4099, -80.0f, 80.0f);
+	Tensor positive = ramp(4099, 1e-30f, 1e30f);
+	Tensor unit = ramp(4099, 1e-3f, 4.0f);
+	Tensor angles = ramp(4099, -3.14159f, 3.14159f);
+
+	REQUIRE(maxUlp(wide, wide.exp(), [](double x) { return std::exp(x); }) <= 1);
+	REQUIRE(maxUlp(positive, positive.log(), [](double x) { return std::log(x); }) <= 2);
+	REQUIRE(maxUlp(unit, unit.log(), [](double x) { return std::log(x); }) <= 2);
+	REQUIRE(maxUlp(positive, positive.sqrt(), [](double x) { return std::sqrt(x); }) <= 3);
+	REQUIRE(maxUlp(unit, unit.rsqrt(), [](double x) { return 1.0 / std::sqrt(x); }) <= 4);
+	REQUIRE(maxUlp(wide, wide.tanh(), [](double x) { return std::tanh(x); }) <= 3);
+	REQUIRE(maxUlp(wide, wide.sigmoid(), [](double x) { return 1.0 / (1.0 + std::exp(-x)); }) <=
+	        4);
+	REQUIRE(maxUlp(angles, angles.sin(), [](double x) { return std::sin(x); }) <= 2);
+	REQUIRE(maxUlp(angles, angles.cos(), [](double x) { return std::cos(x); }) <= 2);
+	REQUIRE(maxUlp(unit, unit.pow(3.7f), [](double x) { return std::pow(x, 3.7f); }) <= 2);
+	REQUIRE(maxUlp(unit, unit.pow(-1.5f), [](double x) { return std::pow(x, -1.5); }) <= 2);
+	REQUIRE(maxUlp(wide, wide.abs(), [](double x) { return std::abs(x); }) == 0);
+
+	SECTION("large angles keep an absolute error") {
+		Tensor large = ramp(4099, -8192.0f, 8192.0f);
+		std::vector<float> values = large.toVector();
+		std::vector<float> sines = large.sin().toVector();
+		std::vector<float> cosines = large.cos().toVector();
+
+		double worst = 0.0;
+		for (size_t i = 0; i < values.size(); i++) {
+			worst = std::max(worst, std::abs(sines[i] - std::sin((double)values[i])));
+			worst = std::max(worst, std::abs(cosines[i] - std::cos((double)values[i])));
+		}
+		REQUIRE(worst <= 1e-7);
+	}
+}
+
+TEST_CASE("Unary special values", "[Unary]") {
+	const float inf = std::numeric_limits<float>::infinity();
+
+	Tensor x({4}, 0.0f);
+	x.set({1}, Tensor(-1.0f));
+	x.set({2}, Tensor(-8.0f));
+	x.set({3}, Tensor(100.0f));
+
+	std::vector<float> logs = x.log().toVector();
+	REQUIRE(logs[0] == -inf);
+	REQUIRE(std::isnan(logs[1]));
+
+	std::vector<float> exps = x.exp().toVector();
+	REQUIRE(exps[0] == 1.0f);
+	REQUIRE(exps[3] == inf);
+
+	// integer exponents take the sign of odd powers, fractional ones give NaN for negatives
+	REQUIRE(x.pow(3.0f).toVector() == std::vector<float>{0.0f, -1.0f, -512.0f, 1e6f});
+	REQUIRE(x.pow(2.0f).toVector() == std::vector<float>{0.0f, 1.0f, 64.0f, 1e4f});
+	REQUIRE(std::isnan(x.pow(0.5f).toVector()[1]));
+	REQUIRE(std::isnan(x.pow(1.5f).toVector()[2]));
+	REQUIRE(x.pow(-1.0f).toVector()[0] == inf);
+	REQUIRE(x.pow(0.0f).toVector() == std::vector<float>{1.0f, 1.0f, 1.0f, 1.0f});
+
+	std::vector<float> tanhs = x.tanh().toVector();
+	REQUIRE(tanhs[0] == 0.0f);
+	REQUIRE(tanhs[3] == 1.0f);
+	REQUIRE(std::abs(x.sigmoid().toVector()[0] - 0.5f) <= 1e-6f);
+	REQUIRE(std::abs(x.sigmoid().toVector()[3] - 1.0f) <= 1e-6f);
+	REQUIRE(x.clamp(-2.0f, 3.0f).toVector() == std::vector<float>{0.0f, -1.0f, -2.0f, 3.0f});
+}
+
+TEST_CASE("Unary dtypes", "[Unary]") {
+	Tensor x({6});
+	x.fillUniform(0.5f, 3.0f, 4);
+
+	SECTION("floating dtypes are kept") {
+		DType dtype = GENERATE(DType::Float64, DType::Float16, DType::BFloat16);
+		double tolerance = dtype == DType::Float64 ? 1e-6 : 1e-2;
+
+		Tensor result = x.asType(dtype).exp();
+		REQUIRE(result.getDType() == dtype);
+
+		std::vector<float> values = x.asType(dtype).toVector();
+		std::vector<float> exps = result.toVector();
+		for (size_t i = 0; i < values.size(); i++) {
+			REQUIRE(std::abs(exps[i] - std::exp(values[i])) <= tolerance * std::exp(values[i]));
+		}
+	}
+
+	SECTION("integers compute as Float32 except abs and clamp") {
+		Tensor ints = Tensor({4}, -3.0f).asType(DType::Int32);
+		ints.set({1}, Tensor(4.0f).asType(DType::Int32));
+
+		REQUIRE(ints.sqrt().getDType() == DType::Float32);
+		REQUIRE(ints.abs().getDType() == DType::Int32);
+		REQUIRE(ints.abs().toVector() == std::vector<float>{3.0f, 4.0f, 3.0f, 3.0f});
+
+		// bounds round inwards, so 2.5 clamps to 2
+		Tensor clamped = ints.clamp(-1.5f, 2.5f);
+		REQUIRE(clamped.getDType() == DType::Int32);
+		REQUIRE(clamped.toVector() == std::vector<float>{-1.0f, 2.0f, -1.0f, -1.0f});
+
+		Tensor bytes = Tensor({2}, 200.0f).asType(DType::UInt8);
+		REQUIRE(bytes.clamp(-1000.0f, 1000.0f).toVector() == std::vector<float>{200.0f, 200.0f});
+		REQUIRE(bytes.clamp(0.0f, 100.0f).toVector() == std::vector<float>{100.0f, 100.0f});
+
+		Tensor mask = x > Tensor(1.0f);
+		REQUIRE(mask.exp().getDType() == DType::Float32);
+	}
+}
+
+TEST_CASE("Unary in place and into outputs", "[Unary]") {
+	Tensor x({3, 50});
+	x.fillUniform(-2.0f, 2.0f, 8);
+	Tensor expected = x.tanh();
+
+	SECTION("in place") {
+		x.mapInplace(UnaryOp::Tanh);
+		REQUIRE(tensor_equal(x, expected));
+
+		Tensor ints = Tensor({3}, -2.0f).asType(DType::Int64);
+		ints.mapInplace(UnaryOp::Abs);
+		REQUIRE(ints.toVector() == std::vector<float>{2.0f, 2.0f, 2.0f});
+		REQUIRE_THROWS_AS(ints.mapInplace(UnaryOp::Exp), std::runtime_error);
+	}
+
+	SECTION("into an output") {
+		Tensor out({3, 50});
+		x.mapInto(out, UnaryOp::Tanh);
+		REQUIRE(tensor_equal(out, expected));
+
+		// a row broadcasts over the output, Float32 results convert into Float16
+		Tensor half = Tensor({3, 50}, 0.0f).asType(DType::Float16);
+		x[0].copy().mapInto(half, UnaryOp::Clamp, -1.0f, 1.0f);
+		Tensor row = x[0].copy().clamp(-1.0f, 1.0f);
+		REQUIRE(half[2].copy().allClose(row, 1e-3f));
+
+		Tensor ints({3, 50}, DType::Int32);
+		REQUIRE_THROWS_AS(x.mapInto(ints, UnaryOp::Sin), std::runtime_error);
+	}
+
+	SECTION("views") {
+		Tensor parent({3, 100});
+		parent.fillUniform(0.1f, 2.0f, 3);
+		std::vector<float> before = parent.toVector();
+		Tensor::View even = parent.subsample({1, 2});
+		Tensor copy = even.copy();
+
+		REQUIRE(tensor_equal(even.map(UnaryOp::Log), copy.log()));
+		REQUIRE(tensor_equal(even.map(UnaryOp::Pow, 1.5f), copy.pow(1.5f)));
+
+		even.mapInplace(UnaryOp::Sqrt);
+		REQUIRE(even.copy().allClose(copy.sqrt()));
+
+		// the skipped columns are untouched
+		std::vector<float> after = parent.toVector();
+		for (size_t i = 1; i < after.size(); i += 2) {
+			REQUIRE(after[i] == before[i]);
+		}
+	}
+}
@@ -0,0 +1,143 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include <stdexcept>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+TEST_CASE("reshape views the same storage", "[View][Reshape]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a = iota({2, 3, 4}, backend);
+
+		Tensor::View b = a.reshape({6, 4});
+		REQUIRE(b.getShape() == Tensor::Shape({6, 4}));
+		REQUIRE(b.getLayout().strides[0] == 4);
+		REQUIRE(b.isContiguous());
+		REQUIRE(b.toVector() == a.toVector());
+
+		// writes through the view land in the parent
+		b[5] = Tensor({4}, -1.0f, backend);
+		REQUIRE(a[1][2].toVector() == std::vector<float>(4, -1.0f));
+
+		REQUIRE(a.reshape({24}).reshape({4, 1, 6}).getShape() == Tensor::Shape({4, 1, 6}));
+		REQUIRE(Tensor(2.0f, backend).reshape({1, 1}).toVector() == std::vector<float>{2.0f});
+		REQUIRE_THROWS_AS(a.reshape({5, 5}), std::runtime_error);
+	}
+}
+
+TEST_CASE("reshape of strided views", "[View][Reshape]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a = iota({4, 6, 8}, backend);
+
+		// every other row keeps each row contiguous, so the rows can be split but not merged
+		Tensor::View rows = a.subsample({1, 2, 1});
+		Tensor::View split = rows.reshape({4, 3, 2, 4});
+		REQUIRE(split.toVector() == rows.copy().reshape({4, 3, 2, 4}).toVector());
+		REQUIRE(split.getLayout().strides[1] == 16);
+		REQUIRE_THROWS_AS(rows.reshape({4, 24}), std::runtime_error);
+
+		// the outer dims are still one strided run
+		REQUIRE(rows.reshape({12, 8}).toVector() == rows.toVector());
+
+		// a transposed view only reshapes after a copy
+		Tensor::View t = a.transpose(1, 2);
+		REQUIRE_FALSE(t.isContiguous());
+		REQUIRE_THROWS_AS(t.reshape({4, 48}), std::runtime_error);
+		Tensor dense = t.contiguous();
+		REQUIRE(dense.reshape({4, 48}).toVector() == t.toVector());
+		REQUIRE(t.reshape({2, 2, 8, 6}).getShape() == Tensor::Shape({2, 2, 8, 6}));
+
+		// size 1 dims of the view do not break a run
+		Tensor::View column = a.reshape({4, 48}).subsample({1, 48});
+		REQUIRE(column.reshape({2, 1, 2}).toVector() == std::vector<float>{0, 48, 96, 144});
+	}
+}
+
+TEST_CASE("permute and transpose", "[View][Permute]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a = iota({2, 3, 4}, backend);
+		std::vector<float> values = a.toVector();
+
+		Tensor::View p = a.permute({2, 0, 1});
+		REQUIRE(p.getShape() == Tensor::Shape({4, 2, 3}));
+
+		std::vector<float> permuted = p.toVector();
+		size_t i = 0;
+		for (size_t z = 0; z < 4; z++) {
+			for (size_t x = 0; x < 2; x++) {
+				for (size_t y = 0; y < 3; y++, i++) {
+					REQUIRE(permuted[i] == values[(x * 3 + y) * 4 + z]);
+				}
+			}
+		}
+
+		Tensor m = iota({3, 5}, backend);
+		Tensor::View mt = m.transpose(0, 1);
+		REQUIRE(mt.transpose(0, 1).isContiguous());
+		REQUIRE(tensor_equal(mt.transpose(1, 0).copy(), m));
+		REQUIRE(m.matmul(mt).getShape() == Tensor::Shape({3, 3}));
+		REQUIRE(tensor_equal(mt.matmul(m), mt.copy().matmul(m)));
+
+		REQUIRE_THROWS_AS(a.permute({0, 1}), std::runtime_error);
+		REQUIRE_THROWS_AS(a.permute({0, 1, 1}), std::runtime_error);
+		REQUIRE_THROWS_AS(a.transpose(0, 3), std::runtime_error);
+	}
+}
+
+TEST_CASE("squeeze and unsqueeze", "[View][Squeeze]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a = iota({3, 1, 4, 1}, backend);
+
+		REQUIRE(a.squeeze().getShape().toVector() == std::vector<size_t>{3, 4});
+		REQUIRE(a.squeeze(1).getShape().toVector() == std::vector<size_t>{3, 4, 1});
+		REQUIRE(a.squeeze().toVector() == a.toVector());
+		REQUIRE(Tensor({1, 1}, 2.0f, backend).squeeze().getShape().getNumDims() == 1);
+		REQUIRE_THROWS_AS(a.squeeze(0), std::runtime_error);
+
+		Tensor::View u = a.squeeze().unsqueeze(1);
+		REQUIRE(u.getShape().toVector() == std::vector<size_t>{3, 1, 4});
+		REQUIRE(u.isContiguous());
+		REQUIRE(u.unsqueeze(3).getShape().toVector() == std::vector<size_t>{3, 1, 4, 1});
+		REQUIRE_THROWS_AS(u.unsqueeze(4), std::runtime_error);
+
+		// a column of a transposed view stays strided
+		Tensor m = iota({3, 5}, backend);
+		Tensor::View col = m.transpose(0, 1)[2].unsqueeze(0);
+		REQUIRE(col.getShape().toVector() == std::vector<size_t>{1, 3});
+		REQUIRE(col.toVector() == std::vector<float>{2, 7, 12});
+	}
+}
+
+TEST_CASE("expand repeats size 1 dims", "[View][Expand]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor bias = iota({3, 1}, backend);
+
+		Tensor::View e = bias.expand({2, 3, 4});
+		REQUIRE(e.getShape() == Tensor::Shape({2, 3, 4}));
+		REQUIRE(e.getStride() == std::vector<size_t>({0, 1, 0}));
+		REQUIRE_FALSE(e.isContiguous());
+
+		std::vector<float> values = e.toVector();
+		for (size_t i = 0; i < values.size(); i++) {
+			REQUIRE(values[i] == static_cast<float>((i / 4) % 3));
+		}
+
+		Tensor x({2, 3, 4}, 1.0f, backend);
+		REQUIRE(tensor_equal(x + e, e.copy() + x));
+
+		REQUIRE_THROWS_AS(bias.expand({2, 3}), std::runtime_error);
+		REQUIRE_THROWS_AS(bias.expand({4}), std::runtime_error);
+	}
+}
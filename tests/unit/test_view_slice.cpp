@@ -0,0 +1,133 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include <stdexcept>
+
+#include "nforge/nforge.h"
+#include "utils.h"
+
+/// Indices of Python's `range(start, stop, step)`.
+static std::vector<float> pyRange(long start, long stop, long step) {
+	std::vector<float> values;
+	for (long i = start; step > 0 ? i < stop : i > stop; i += step) values.push_back((float)i);
+	return values;
+}
+
+TEST_CASE("slice matches Python ranges", "[View][Slice]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a = iota({10}, backend);
+
+		REQUIRE(a.slice(0, {2, 7}).toVector() == pyRange(2, 7, 1));
+		REQUIRE(a.slice(0, {5, std::nullopt, 3}).toVector() == pyRange(5, 10, 3));
+		REQUIRE(a.slice(0, {-3, std::nullopt}).toVector() == pyRange(7, 10, 1));
+		REQUIRE(a.slice(0, {std::nullopt, -8}).toVector() == pyRange(0, 2, 1));
+		REQUIRE(a.slice(0, {-100, 100, 4}).toVector() == pyRange(0, 10, 4));
+
+		// negative steps
+		REQUIRE(a.slice(0, {std::nullopt, std::nullopt, -1}).toVector() == pyRange(9, -1, -1));
+		REQUIRE(a.slice(0, {8, 2, -2}).toVector() == pyRange(8, 2, -2));
+		REQUIRE(a.slice(0, {-2, std::nullopt, -3}).toVector() == pyRange(8, -1, -3));
+		REQUIRE(a.slice(0, {100, -100, -5}).toVector() == pyRange(9, -1, -5));
+
+		// empty ranges
+		REQUIRE(a.slice(0, {7, 2}).getShape().getDim(0) == 0);
+		REQUIRE(a.slice(0, {2, 7, -1}).getShape().getDim(0) == 0);
+		REQUIRE(a.slice(0, {10, std::nullopt}).getShape().getDim(0) == 0);
+
+		REQUIRE_THROWS_AS(a.slice(0, {0, 5, 0}), std::runtime_error);
+		REQUIRE_THROWS_AS(a.slice(1, {0, 5}), std::runtime_error);
+		REQUIRE_THROWS_AS(a.slice({{}, {}}), std::runtime_error);
+	}
+}
+
+TEST_CASE("slice of several dims", "[View][Slice]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a = iota({6, 300}, backend);
+		std::vector<float> values = a.toVector();
+
+		// x[:, 100:200]
+		Tensor::View window = a.slice({{}, {100, 200}});
+		REQUIRE(window.getShape() == Tensor::Shape({6, 100}));
+		REQUIRE(window[4].toVector() == pyRange(4 * 300 + 100, 4 * 300 + 200, 1));
+
+		// x[5::-2, ::-100]
+		Tensor::View flipped = a.slice({{5, std::nullopt, -2}, {std::nullopt, std::nullopt, -100}});
+		REQUIRE(flipped.getShape() == Tensor::Shape({3, 3}));
+		REQUIRE(flipped.toVector() ==
+		        std::vector<float>{1799, 1699, 1599, 1199, 1099, 999, 599, 499, 399});
+
+		// writes go through to the parent
+		a.slice({{1, 2}, {-1, std::nullopt, -1}}) = Tensor({1, 300}, -1.0f, backend);
+		REQUIRE(a[1].toVector() == std::vector<float>(300, -1.0f));
+		REQUIRE(a[2].toVector() == pyRange(600, 900, 1));
+	}
+}
+
+TEST_CASE("ops read reversed views", "[View][Slice]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor a({7, 33}, backend);
+		a.fillUniform(-1.0f, 1.0f, 3);
+
+		Slice backwards{std::nullopt, std::nullopt, -1};
+		Tensor::View r = a.slice({backwards, backwards});
+		Tensor dense = r.copy();
+		REQUIRE_FALSE(r.isContiguous());
+
+		std::vector<float> values = a.toVector();
+		std::vector<float> reversed = dense.toVector();
+		for (size_t i = 0; i < values.size(); i++) {
+			REQUIRE(reversed[i] == values[values.size() - 1 - i]);
+		}
+
+		REQUIRE(tensor_equal(a + r, a + dense));
+		REQUIRE(r.map(UnaryOp::Exp).allClose(dense.exp()));
+		REQUIRE(r.softmax(1).allClose(dense.softmax(1)));
+		REQUIRE(tensor_equal(r.sort(1), dense.sort(1)));
+		REQUIRE(tensor_equal(r.scan(ScanOp::Sum, 1), dense.cumsum(1)));
+		REQUIRE(a.matmul(r.transpose(0, 1)).allClose(a.matmul(dense.transpose(0, 1))));
+		REQUIRE(tensor_equal(r.sum(1), dense.sum(1)));
+		REQUIRE(r.isEqual(dense));
+
+		Tensor index({7, 5}, DType::Int64);
+		REQUIRE(tensor_equal(r.gather(1, index), dense.gather(1, index)));
+
+		// in place through the reversed view
+		Tensor b = a;
+		b.slice(0, backwards) += a;
+		REQUIRE(tensor_equal(b.slice(0, backwards), a.slice(0, backwards) + a));
+	}
+}
+
+TEST_CASE("unfold views sliding windows", "[View][Unfold]") {
+	auto backend = GENERATE(from_range(backends));
+
+	DYNAMIC_SECTION(getBackendString(backend)) {
+		Tensor series = iota({2, 50}, backend);
+
+		Tensor::View windows = series.unfold(1, 8, 3);
+		REQUIRE(windows.getShape() == Tensor::Shape({2, 15, 8}));
+		REQUIRE(windows[1][4].toVector() == pyRange(50 + 12, 50 + 20, 1));
+
+		// mean of every window, the first one is the mean of 0..7
+		Tensor means = windows.mean(2);
+		REQUIRE(means.getShape() == Tensor::Shape({2, 15}));
+		REQUIRE(means.toVector()[0] == 3.5f);
+		REQUIRE(means.toVector()[15 + 14] == 50.0f + 42.0f + 3.5f);
+
+		// windows of a sliced series
+		Tensor::View tail = series.slice(1, {20, std::nullopt}).unfold(1, 10, 10);
+		REQUIRE(tail.getShape() == Tensor::Shape({2, 3, 10}));
+		REQUIRE(tail[0][2].toVector() == pyRange(40, 50, 1));
+
+		REQUIRE_THROWS_AS(series.unfold(1, 51, 1), std::runtime_error);
+		REQUIRE_THROWS_AS(series.unfold(1, 4, 0), std::runtime_error);
+		REQUIRE_THROWS_AS(series.unfold(2, 4, 1), std::runtime_error);
+	}
+}
@@ -1,6 +1,11 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
 #include "nforge/nforge.h"
 
 static constexpr Backend backends[] = {Backend::CPU,
@@ -32,4 +37,35 @@ static std::string getBackendString(Backend backend) {
 	}
 }
 
+/// Tensor of `shape` holding `first`, `first + 1`, ... in row-major order.
+static Tensor iota(const Tensor::Shape& shape, Backend backend = Backend::CPU,
+                   float first = 0.0f) {
+	Tensor ones({shape.getNumElements()}, 1.0f, backend);
+	return (ones.cumsum(0, true) + Tensor(first, backend)).reshape(shape).copy();
+}
+
+/// Uniform values in [low, high) of dtype `dtype`.
+static Tensor randomValues(const Tensor::Shape& shape, float low, float high, DType dtype,
+                           uint64_t seed) {
+	Tensor values(shape);
+	values.fillUniform(low, high, seed);
+	return values.asType(dtype);
+}
+
+/// True if every element of `actual` is within `tolerance` of `expected`, relative to
+/// max(1, |expected|).
+static bool allNear(const std::vector<float>& actual, const std::vector<double>& expected,
+                    double tolerance) {
+	if (actual.size() != expected.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < actual.size(); i++) {
+		double scale = std::max(1.0, std::abs(expected[i]));
+		if (std::abs(actual[i] - expected[i]) > tolerance * scale) {
+			return false;
+		}
+	}
+	return true;
+}
+
 #endif  // UTILS_H
\ No newline at end of file